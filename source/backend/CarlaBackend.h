@@ -948,7 +948,64 @@ typedef enum {
     /*!
      * The engine has crashed or malfunctioned and will no longer work.
      */
-    ENGINE_CALLBACK_QUIT = 39
+    ENGINE_CALLBACK_QUIT = 39,
+
+    /*!
+     * Several parameter values have changed since the last engine idle, only the latest value of each is kept.
+     * Only sent instead of ENGINE_CALLBACK_PARAMETER_VALUE_CHANGED when ENGINE_OPTION_BATCH_PARAMETER_CHANGES is set.
+     * @a pluginId Plugin Id
+     * @a value1   Number of parameters changed during this idle
+     * @see carla_get_plugin_parameter_changes()
+     */
+    ENGINE_CALLBACK_PARAMETER_VALUES_CHANGED = 40,
+
+    /*!
+     * A bridged plugin missed its processing deadline too many times in a row and is now silenced,
+     * or it has caught up again.
+     * @a pluginId Plugin Id
+     * @a value1   1 if degraded, 0 if recovered
+     * @a value2   Number of consecutive missed blocks
+     * @see ENGINE_OPTION_PLUGIN_BRIDGES_DEADLINE
+     */
+    ENGINE_CALLBACK_PLUGIN_DEGRADED = 41,
+
+    /*!
+     * A plugin of a project was loaded, sent once all project plugins are added.
+     * Only sent when ENGINE_OPTION_PROJECT_LOAD_THREADS is set.
+     * @a pluginId Plugin Id
+     * @a value1   Time spent creating the plugin, in microseconds
+     * @a value2   Time spent restoring its state, in microseconds
+     * @see ENGINE_CALLBACK_PROJECT_PLUGINS_LOADED
+     */
+    ENGINE_CALLBACK_PROJECT_PLUGIN_LOADED = 42,
+
+    /*!
+     * All plugins of a project were loaded, sent after ENGINE_CALLBACK_PROJECT_PLUGIN_LOADED.
+     * Only sent when ENGINE_OPTION_PROJECT_LOAD_THREADS is set.
+     * @a value1 Number of plugins loaded
+     * @a value2 Number of plugins in the project
+     * @a value3 Time spent loading the plugins, in milliseconds
+     */
+    ENGINE_CALLBACK_PROJECT_PLUGINS_LOADED = 43,
+
+    /*!
+     * The offline driver finished rendering, sent from its render thread.
+     * @a value1 Number of blocks rendered
+     * @a value2 Number of blocks that took longer than the buffer period
+     * @a value3 Average DSP load, in percent of the buffer period
+     * @see ENGINE_OPTION_OFFLINE_RENDER_FRAMES
+     */
+    ENGINE_CALLBACK_OFFLINE_RENDER_FINISHED = 44,
+
+    /*!
+     * Process round-trip times of a bridged plugin since it was activated, sent when it is deactivated.
+     * @a pluginId Plugin Id
+     * @a value1   Number of replies measured
+     * @a value2   Number of replies taken while spinning, without sleeping
+     * @a value3   Average round-trip time, in microseconds
+     * @see ENGINE_OPTION_PLUGIN_BRIDGES_SPIN_TIME
+     */
+    ENGINE_CALLBACK_PLUGIN_BRIDGE_LATENCY = 45
 
 } EngineCallbackOpcode;
 
@@ -1072,7 +1129,74 @@ typedef enum {
     /*!
      * Set frontend winId, used to define as parent window for plugin UIs.
      */
-    ENGINE_OPTION_FRONTEND_WIN_ID = 17
+    ENGINE_OPTION_FRONTEND_WIN_ID = 17,
+
+    /*!
+     * Number of extra real-time worker threads used for parallel processing.
+     * Only used in patchbay mode, independent plugins will run concurrently on these threads.
+     * Default is 0 (everything is processed in the audio thread).
+     */
+    ENGINE_OPTION_PROCESS_WORKERS = 18,
+
+    /*!
+     * Number of pipeline stages used in rack mode.
+     * Each extra stage runs a part of the rack on its own real-time thread, adding one block of latency.
+     * Default is 1 (no pipelining).
+     */
+    ENGINE_OPTION_RACK_PIPELINE_STAGES = 19,
+
+    /*!
+     * Time in microseconds to busy-wait for a bridged plugin to finish processing before sleeping on a semaphore.
+     * Saves a kernel wakeup per block when the bridge replies quickly, at the cost of CPU time.
+     * Default is 0 (always sleep).
+     */
+    ENGINE_OPTION_PLUGIN_BRIDGES_SPIN_TIME = 20,
+
+    /*!
+     * Maximum number of bridged plugins of the same binary type to host inside a single bridge process.
+     * Grouped plugins share one real-time channel, and contiguous rack chains run in a single round-trip.
+     * Default is 1 (one process per plugin).
+     */
+    ENGINE_OPTION_PLUGIN_BRIDGES_GROUP_SIZE = 21,
+
+    /*!
+     * Report parameter changes coming from plugins with a single ENGINE_CALLBACK_PARAMETER_VALUES_CHANGED per plugin and idle.
+     * Changes made through the host API are still reported one by one.
+     * Default is false.
+     */
+    ENGINE_OPTION_BATCH_PARAMETER_CHANGES = 22,
+
+    /*!
+     * Number of threads used to load bridged plugins and restore their state when loading a project.
+     * Plugins are still added in project order and activated together once all are loaded.
+     * Default is 0 (load one plugin at a time).
+     * @see ENGINE_CALLBACK_PROJECT_PLUGINS_LOADED
+     */
+    ENGINE_OPTION_PROJECT_LOAD_THREADS = 23,
+
+    /*!
+     * Minimum size in bytes of plugin chunks and custom data values stored in the project sidecar file ('<project>.data').
+     * The sidecar keeps them raw and compressed instead of base64 text inside the project.
+     * Default is 0 (no sidecar, everything is stored in the project).
+     */
+    ENGINE_OPTION_PROJECT_SIDECAR_MIN_SIZE = 24,
+
+    /*!
+     * Time a bridged plugin has to process a block, as a percentage of the block duration.
+     * A bridge that misses it plays a fade-out of its previous output, then silence, instead of stalling the engine.
+     * Its late reply is skipped, and after several misses in a row it is reported as degraded.
+     * Default is 0 (no deadline, wait up to 1 second and then stop using the bridge).
+     * @see ENGINE_CALLBACK_PLUGIN_DEGRADED
+     */
+    ENGINE_OPTION_PLUGIN_BRIDGES_DEADLINE = 25,
+
+    /*!
+     * Number of frames the offline driver renders once transport starts playing, transport is paused afterwards.
+     * Nothing is rendered nor measured while transport is stopped, so a project can be loaded first.
+     * Default is 0 (render until the engine is closed).
+     * @see ENGINE_CALLBACK_OFFLINE_RENDER_FINISHED
+     */
+    ENGINE_OPTION_OFFLINE_RENDER_FRAMES = 26
 
 } EngineOption;
 
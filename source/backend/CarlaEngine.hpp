@@ -25,12 +25,13 @@ struct CarlaOscData;
 #endif
 
 namespace juce {
-class MemoryOutputStream;
-class XmlDocument;
+class OutputStream;
 }
 
 CARLA_BACKEND_START_NAMESPACE
 
+class CarlaStateSidecarWriter;
+
 // -----------------------------------------------------------------------
 
 /*!
@@ -73,7 +74,13 @@ enum EngineType {
     /*!
      * Bridge engine type, used in BridgePlugin class.
      */
-    kEngineTypeBridge = 5
+    kEngineTypeBridge = 5,
+
+    /*!
+     * Dummy engine type, renders offline as fast as possible.
+     * Used for benchmarks and headless rendering.
+     */
+    kEngineTypeDummy = 6
 };
 
 /*!
@@ -182,10 +189,11 @@ struct CARLA_API EngineControlEvent {
  * Engine MIDI event.
  */
 struct CARLA_API EngineMidiEvent {
-    static const uint8_t kDataSize = 4; //!< Size of internal data
+    static const uint8_t  kDataSize = 4;      //!< Size of internal data
+    static const uint16_t kMaxSize  = 0xFFFF; //!< Maximum size of a message
 
-    uint8_t port; //!< Port offset (usually 0)
-    uint8_t size; //!< Number of bytes used
+    uint8_t  port; //!< Port offset (usually 0)
+    uint16_t size; //!< Number of bytes used, 16 bits wide (was 8 bits before long messages, ABI change)
 
     /*!
      * MIDI data, without channel bit.
@@ -214,7 +222,7 @@ struct CARLA_API EngineEvent {
     /*!
      * Fill this event from MIDI data.
      */
-    void fillFromMidiData(const uint8_t size, const uint8_t* const data, const uint8_t midiPortOffset) noexcept;
+    void fillFromMidiData(const uint16_t size, const uint8_t* const data, const uint8_t midiPortOffset) noexcept;
 };
 
 // -----------------------------------------------------------------------
@@ -253,6 +261,16 @@ struct CARLA_API EngineOptions {
     bool preventBadBehaviour;
     uintptr_t frontendWinId;
 
+    uint processWorkers;
+    uint rackPipelineStages;
+    uint bridgesSpinTime;
+    uint bridgesGroupSize;
+    bool batchParameterChanges;
+    uint projectLoadThreads;
+    uint sidecarMinSize;
+    uint bridgesDeadline;
+    uint offlineRenderFrames;
+
 #ifndef DOXYGEN
     EngineOptions() noexcept;
     ~EngineOptions() noexcept;
@@ -306,6 +324,52 @@ struct CARLA_API EngineTimeInfo {
 #endif
 };
 
+/*!
+ * Engine plugin processing time statistics, over the last processed blocks.
+ * Times are in microseconds.
+ */
+struct CARLA_API EnginePluginDspStats {
+    uint32_t count;
+    float minTime;
+    float avgTime;
+    float maxTime;
+    float p99Time;
+    float load; // average time relative to the buffer period, in percent
+
+    /*!
+     * Clear.
+     */
+    void clear() noexcept;
+
+#ifndef DOXYGEN
+    EnginePluginDspStats() noexcept;
+#endif
+};
+
+/*!
+ * Engine plugin worker statistics, since the worker client was created.
+ * Times are in microseconds.
+ */
+struct CARLA_API EngineWorkerStats {
+    uint32_t jobs;          // number of jobs run
+    uint32_t dropped;       // number of jobs and responses that did not fit their queue
+    uint32_t queueDepth;    // number of jobs waiting to run
+    uint32_t maxQueueDepth;
+    float avgLatency;       // time between scheduling a job and running it
+    float maxLatency;
+    float avgJobTime;
+    float maxJobTime;
+
+    /*!
+     * Clear.
+     */
+    void clear() noexcept;
+
+#ifndef DOXYGEN
+    EngineWorkerStats() noexcept;
+#endif
+};
+
 // -----------------------------------------------------------------------
 
 /*!
@@ -521,7 +585,7 @@ public:
      * Write a MIDI event into the buffer.
      * @note You must only call this for output ports.
      */
-    bool writeMidiEvent(const uint32_t time, const uint8_t size, const uint8_t* const data) noexcept;
+    bool writeMidiEvent(const uint32_t time, const uint16_t size, const uint8_t* const data) noexcept;
 
     /*!
      * Write a MIDI event into the buffer.
@@ -534,11 +598,14 @@ public:
      * Arguments are the same as in the EngineMidiEvent struct.
      * @note You must only call this for output ports.
      */
-    virtual bool writeMidiEvent(const uint32_t time, const uint8_t channel, const uint8_t size, const uint8_t* const data) noexcept;
+    virtual bool writeMidiEvent(const uint32_t time, const uint8_t channel, const uint16_t size, const uint8_t* const data) noexcept;
 
 #ifndef DOXYGEN
 protected:
     EngineEvent* fBuffer;
+    mutable uint32_t fEventCount; // input: cached event count
+    uint32_t fWriteCount;         // output: events written since initBuffer()
+    uint32_t fWritePos;           // output: slot after our last written event
     const EngineProcessMode kProcessMode;
     friend class CarlaPluginInstance;
 
@@ -653,6 +720,88 @@ protected:
 
 // -----------------------------------------------------------------------
 
+/*!
+ * Carla Engine worker client.
+ * Runs non-RT jobs scheduled from the audio thread on one of the engine's worker threads,
+ * and hands their responses back to the audio thread.
+ * Jobs of the same client never run concurrently and always run in the order they were scheduled.
+ * @note This is a virtual class, plugins subclass it for their job and response handlers.
+ */
+class CARLA_API CarlaEngineWorkerClient
+{
+public:
+    /*!
+     * The constructor.
+     * The client is bound to one of the engine's worker threads for its lifetime.
+     */
+    CarlaEngineWorkerClient(CarlaEngine* const engine, CarlaPlugin* const plugin);
+
+    /*!
+     * The destructor.
+     */
+    virtual ~CarlaEngineWorkerClient() noexcept;
+
+    /*!
+     * Schedule a job.
+     * When the engine is offline the job is run right away instead.
+     * Returns false if the job queue is full.
+     * @note RT call
+     */
+    bool scheduleWork(const uint32_t size, const void* const data) noexcept;
+
+    /*!
+     * Queue a response for the next processResponses() call.
+     * Must only be called from within work().
+     */
+    bool writeResponse(const uint32_t size, const void* const data) noexcept;
+
+    /*!
+     * Hand all pending responses to workResponse().
+     * @note RT call
+     */
+    void processResponses() noexcept;
+
+    /*!
+     * Stop running jobs, waiting for the current one to finish.
+     * Pending jobs are discarded.
+     * Subclasses must call this in their destructor, before their job handler becomes invalid.
+     */
+    void stopWork() noexcept;
+
+    /*!
+     * Get the plugin this client belongs to.
+     */
+    CarlaPlugin* getPlugin() const noexcept;
+
+    /*!
+     * Get the queue and timing statistics of this client.
+     */
+    void getStats(EngineWorkerStats& stats) const noexcept;
+
+protected:
+    /*!
+     * Run a job, called from a worker thread (or the caller of scheduleWork() when offline).
+     */
+    virtual void work(const uint32_t size, const void* const data) = 0;
+
+    /*!
+     * Handle a job response.
+     * @note RT call
+     */
+    virtual void workResponse(const uint32_t size, const void* const data) = 0;
+
+#ifndef DOXYGEN
+    struct ProtectedData;
+    ProtectedData* const pData;
+
+    friend class EngineWorkerThread;
+
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaEngineWorkerClient)
+#endif
+};
+
+// -----------------------------------------------------------------------
+
 /*!
  * Carla Engine.
  * @note This is a virtual class for all available engine types available in Carla.
@@ -920,6 +1069,17 @@ public:
      */
     float getOutputPeak(const uint pluginId, const bool isLeft) const noexcept;
 
+    /*!
+     * Get the processing time statistics of a plugin.
+     */
+    void getPluginDspStats(const uint pluginId, EnginePluginDspStats& stats) const noexcept;
+
+    /*!
+     * Get the worker statistics of a plugin.
+     * Stats are left cleared if the plugin does not use worker jobs.
+     */
+    void getPluginWorkerStats(const uint pluginId, EngineWorkerStats& stats) const noexcept;
+
     // -------------------------------------------------------------------
     // Callback
 
@@ -966,6 +1126,12 @@ public:
      * Force the engine to resend all patchbay clients, ports and connections again.
      */
     virtual bool patchbayRefresh(const bool external);
+
+    /*!
+     * Recompute the internal patchbay delay compensation.
+     * Called when the latency of a plugin changes.
+     */
+    virtual void patchbayLatencyChanged();
 #endif
 
     // -------------------------------------------------------------------
@@ -1008,6 +1174,13 @@ public:
      */
     void setAboutToClose() noexcept;
 
+    /*!
+     * Check if the calling thread is loading a plugin in the background, as part of a project load.
+     * Such plugins are not part of the engine yet, so they must not call idle(),
+     * and their callbacks and errors do not reach the frontend.
+     */
+    bool isProjectLoaderThread() const noexcept;
+
     // -------------------------------------------------------------------
     // Options
 
@@ -1050,6 +1223,13 @@ public:
      */
     EngineEvent* getInternalEventBuffer(const bool isInput) const noexcept;
 
+    /*!
+     * Copy a MIDI message bigger than EngineMidiEvent::kDataSize into pre-allocated memory, valid until the end of the current cycle.
+     * Returns null if there's no space left, which also limits the size of a single message.
+     * @note RT call
+     */
+    const uint8_t* copyInternalEventData(const uint8_t* const data, const uint16_t size) const noexcept;
+
 #ifndef BUILD_BRIDGE
     /*!
      * Virtual functions for handling external graph ports.
@@ -1070,14 +1250,17 @@ protected:
     /*!
      * Some internal classes read directly from pData or call protected functions.
      */
+    friend class CarlaEngineWorkerClient;
     friend class CarlaPluginInstance;
     friend class EngineInternalGraph;
     friend class PendingRtEventsRunner;
+    friend class ProjectLoaderThread;
     friend class ScopedActionLock;
     friend class ScopedEngineEnvironmentLocker;
     friend class ScopedThreadStopper;
     friend struct PatchbayGraph;
     friend struct RackGraph;
+    friend struct RackGraphPipeline;
 
     // -------------------------------------------------------------------
     // Internal stuff
@@ -1104,15 +1287,34 @@ protected:
      */
     void setPluginPeaks(const uint pluginId, float const inPeaks[2], float const outPeaks[2]) noexcept;
 
+    /*!
+     * Add a plugin processing time, measured from @a startTicks (as in juce::Time::getHighResolutionTicks()).
+     * If the time was spent processing @a shareCount plugins at once, only this plugin's share is added.
+     * @note RT call
+     */
+    void addPluginDspTime(const uint pluginId, const int64_t startTicks, const uint shareCount = 1) noexcept;
+
+    /*!
+     * Create a new plugin with id @a id, without adding it to the engine.
+     * Returns null and sets the last error on failure.
+     * Called by addPlugin() and by the project loader threads.
+     */
+    CarlaPlugin* createPlugin(const uint id, const BinaryType btype, const PluginType ptype,
+                              const char* const filename, const char* const name, const char* const label, const int64_t uniqueId,
+                              const void* const extra, const uint options);
+
     /*!
      * Common save project function for main engine and plugin.
+     * Plugin chunks and big custom data go into @a sidecar if not null.
      */
-    void saveProjectInternal(juce::MemoryOutputStream& outStrm) const;
+    void saveProjectInternal(juce::OutputStream& outStrm, CarlaStateSidecarWriter* const sidecar = nullptr) const;
 
     /*!
      * Common load project function for main engine and plugin.
+     * @a xmlData is read in a single pass, without building a document tree.
+     * @a projectFilename is used to find the sidecar data file, it can be null.
      */
-    bool loadProjectInternal(juce::XmlDocument& xmlDoc);
+    bool loadProjectInternal(const char* const xmlData, const std::size_t xmlSize, const char* const projectFilename);
 
 #ifndef BUILD_BRIDGE
     // -------------------------------------------------------------------
@@ -1172,6 +1374,8 @@ public:
     static const char* const* getRtAudioApiDeviceNames(const uint index);
     static const EngineDriverDeviceInfo* getRtAudioDeviceInfo(const uint index, const char* const deviceName);
 # endif
+    // Dummy/Offline
+    static CarlaEngine*       newDummy();
 #endif
 
 #ifndef BUILD_BRIDGE
@@ -1202,6 +1406,7 @@ public:
     void oscSend_control_note_on(const uint pluginId, const uint8_t channel, const uint8_t note, const uint8_t velo) const noexcept;
     void oscSend_control_note_off(const uint pluginId, const uint8_t channel, const uint8_t note) const noexcept;
     void oscSend_control_set_peaks(const uint pluginId) const noexcept;
+    void oscSend_control_set_dsp_stats(const uint pluginId) const noexcept;
     void oscSend_control_exit() const noexcept;
 #endif
 
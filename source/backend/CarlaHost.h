@@ -268,6 +268,135 @@ typedef struct _CarlaTransportInfo {
 
 } CarlaTransportInfo;
 
+/*!
+ * Plugin processing time statistics, over its last processed blocks.
+ * Times are in microseconds.
+ * @see carla_get_plugin_dsp_stats()
+ */
+typedef struct _CarlaPluginDspStats {
+    /*!
+     * Number of measured blocks.
+     */
+    uint32_t count;
+
+    /*!
+     * Minimum processing time.
+     */
+    float minTime;
+
+    /*!
+     * Average processing time.
+     */
+    float avgTime;
+
+    /*!
+     * Maximum processing time.
+     */
+    float maxTime;
+
+    /*!
+     * 99th percentile processing time.
+     */
+    float p99Time;
+
+    /*!
+     * Average processing time relative to the buffer period, in percent.
+     */
+    float load;
+
+#ifdef __cplusplus
+    /*!
+     * C++ constructor.
+     */
+    CARLA_API _CarlaPluginDspStats() noexcept;
+#endif
+
+} CarlaPluginDspStats;
+
+/*!
+ * Plugin worker statistics, for plugins that run non-realtime jobs (LV2 worker extension).
+ * Times are in microseconds.
+ * @see carla_get_plugin_worker_stats()
+ */
+typedef struct _CarlaPluginWorkerStats {
+    /*!
+     * Number of jobs run.
+     */
+    uint32_t jobs;
+
+    /*!
+     * Number of jobs and responses that did not fit their queue.
+     */
+    uint32_t dropped;
+
+    /*!
+     * Number of jobs waiting to run.
+     */
+    uint32_t queueDepth;
+
+    /*!
+     * Maximum number of jobs waiting to run.
+     */
+    uint32_t maxQueueDepth;
+
+    /*!
+     * Average time between scheduling a job and running it.
+     */
+    float avgLatency;
+
+    /*!
+     * Maximum time between scheduling a job and running it.
+     */
+    float maxLatency;
+
+    /*!
+     * Average job run time.
+     */
+    float avgJobTime;
+
+    /*!
+     * Maximum job run time.
+     */
+    float maxJobTime;
+
+#ifdef __cplusplus
+    /*!
+     * C++ constructor.
+     */
+    CARLA_API _CarlaPluginWorkerStats() noexcept;
+#endif
+
+} CarlaPluginWorkerStats;
+
+/*!
+ * Parameter changes of a plugin, coalesced so that only the latest value of each parameter is kept.
+ * @see carla_get_plugin_parameter_changes()
+ */
+typedef struct _CarlaParameterChanges {
+    /*!
+     * Number of changed parameters.
+     */
+    uint32_t count;
+
+    /*!
+     * Changed parameter indexes, in ascending order.
+     */
+    const uint32_t* indexes;
+
+    /*!
+     * New parameter values, matching indexes.
+     */
+    const float* values;
+
+#ifdef __cplusplus
+    /*!
+     * C++ constructor.
+     */
+    CARLA_API _CarlaParameterChanges() noexcept;
+#endif
+
+} CarlaParameterChanges;
+
 /* ------------------------------------------------------------------------------------------------------------
  * Carla Host API (C functions) */
 
@@ -708,6 +837,40 @@ CARLA_EXPORT float carla_get_input_peak_value(uint pluginId, bool isLeft);
  */
 CARLA_EXPORT float carla_get_output_peak_value(uint pluginId, bool isLeft);
 
+/*!
+ * Get all peak values of a plugin in one call.
+ * Returns 4 values: input left, input right, output left and output right.
+ * @param pluginId Plugin
+ */
+CARLA_EXPORT const float* carla_get_peak_values(uint pluginId);
+
+/*!
+ * Get a plugin's average DSP load, relative to the buffer period in percent.
+ * @param pluginId Plugin
+ */
+CARLA_EXPORT float carla_get_plugin_cpu_load(uint pluginId);
+
+/*!
+ * Get a plugin's processing time statistics.
+ * @param pluginId Plugin
+ */
+CARLA_EXPORT const CarlaPluginDspStats* carla_get_plugin_dsp_stats(uint pluginId);
+
+/*!
+ * Get a plugin's worker statistics.
+ * All values are 0 for plugins that do not use worker jobs.
+ * @param pluginId Plugin
+ */
+CARLA_EXPORT const CarlaPluginWorkerStats* carla_get_plugin_worker_stats(uint pluginId);
+
+/*!
+ * Take the parameter changes of a plugin since the last call.
+ * Only used when ENGINE_OPTION_BATCH_PARAMETER_CHANGES is enabled, call it after receiving ENGINE_CALLBACK_PARAMETER_VALUES_CHANGED.
+ * The returned data is valid until the next call.
+ * @param pluginId Plugin
+ */
+CARLA_EXPORT const CarlaParameterChanges* carla_get_plugin_parameter_changes(uint pluginId);
+
 /*!
  * Enable or disable a plugin.
  * @param pluginId Plugin
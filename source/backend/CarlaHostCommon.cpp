@@ -96,6 +96,29 @@ _CarlaTransportInfo::_CarlaTransportInfo() noexcept
       tick(0),
       bpm(0.0) {}
 
+_CarlaPluginDspStats::_CarlaPluginDspStats() noexcept
+    : count(0),
+      minTime(0.0f),
+      avgTime(0.0f),
+      maxTime(0.0f),
+      p99Time(0.0f),
+      load(0.0f) {}
+
+_CarlaPluginWorkerStats::_CarlaPluginWorkerStats() noexcept
+    : jobs(0),
+      dropped(0),
+      queueDepth(0),
+      maxQueueDepth(0),
+      avgLatency(0.0f),
+      maxLatency(0.0f),
+      avgJobTime(0.0f),
+      maxJobTime(0.0f) {}
+
+_CarlaParameterChanges::_CarlaParameterChanges() noexcept
+    : count(0),
+      indexes(nullptr),
+      values(nullptr) {}
+
 // -------------------------------------------------------------------------------------------------------------------
 
 const char* carla_get_library_filename()
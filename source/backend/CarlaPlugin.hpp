@@ -646,6 +646,30 @@ public:
     virtual void process(const float** const audioIn, float** const audioOut,
                          const float** const cvIn, float** const cvOut, const uint32_t frames) = 0;
 
+    /*!
+     * Process this plugin together with the ones that follow it in a rack chain, in a single call.
+     * The master mutex of this plugin must already be locked, the following plugins are locked internally.
+     * Each processed plugin writes its input and output peaks (left and right) into 4 consecutive values of @a peaks.
+     * Returns the number of processed plugins, or 0 if the chain cannot be processed this way (the default).
+     */
+    virtual uint processRackChain(const uint maxCount, const float** const audioIn, float** const audioOut,
+                                  float* const peaks, const uint32_t frames);
+
+    /*!
+     * Start processing this plugin without waiting for the result, so other plugins can run meanwhile.
+     * Only bridges can do this, as they compute in a separate process.
+     * Returns false if nothing was done (the default), in which case process() must be used instead.
+     * Otherwise processCollect() must be called from the same thread, with the same arguments, before the end of the cycle.
+     */
+    virtual bool processKick(const float** const audioIn, float** const audioOut,
+                             const float** const cvIn, float** const cvOut, const uint32_t frames);
+
+    /*!
+     * Wait for and write the result of a previous successful processKick() call.
+     */
+    virtual void processCollect(const float** const audioIn, float** const audioOut,
+                                const float** const cvIn, float** const cvOut, const uint32_t frames);
+
     /*!
      * Tell the plugin the current buffer size changed.
      */
@@ -670,6 +694,19 @@ public:
      */
     virtual void idle();
 
+    /*!
+     * Take the parameter changes coalesced by idle() since the last call, when batching is enabled.
+     * Only the latest value of each parameter is kept.
+     * Returns the number of changes written into @a indexes and @a values.
+     * @see ENGINE_OPTION_BATCH_PARAMETER_CHANGES
+     */
+    uint32_t takeParameterChanges(uint32_t* const indexes, float* const values, const uint32_t maxCount) noexcept;
+
+    /*!
+     * Store a new output parameter value, returning false if it did not change since the last call.
+     */
+    bool checkParameterOutputChanged(const uint32_t parameterId, const float value) noexcept;
+
     /*!
      * Try to lock the plugin's master mutex.
      * @param forcedOffline When true, always locks and returns true
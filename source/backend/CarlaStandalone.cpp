@@ -216,6 +216,15 @@ static void carla_engine_init_common()
     gStandalone.engine->setOption(CB::ENGINE_OPTION_AUDIO_NUM_PERIODS,     static_cast<int>(gStandalone.engineOptions.audioNumPeriods),  nullptr);
     gStandalone.engine->setOption(CB::ENGINE_OPTION_AUDIO_BUFFER_SIZE,     static_cast<int>(gStandalone.engineOptions.audioBufferSize),  nullptr);
     gStandalone.engine->setOption(CB::ENGINE_OPTION_AUDIO_SAMPLE_RATE,     static_cast<int>(gStandalone.engineOptions.audioSampleRate),  nullptr);
+    gStandalone.engine->setOption(CB::ENGINE_OPTION_PROCESS_WORKERS,       static_cast<int>(gStandalone.engineOptions.processWorkers),   nullptr);
+    gStandalone.engine->setOption(CB::ENGINE_OPTION_RACK_PIPELINE_STAGES,  static_cast<int>(gStandalone.engineOptions.rackPipelineStages), nullptr);
+    gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_BRIDGES_SPIN_TIME, static_cast<int>(gStandalone.engineOptions.bridgesSpinTime), nullptr);
+    gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_BRIDGES_GROUP_SIZE, static_cast<int>(gStandalone.engineOptions.bridgesGroupSize), nullptr);
+    gStandalone.engine->setOption(CB::ENGINE_OPTION_BATCH_PARAMETER_CHANGES, gStandalone.engineOptions.batchParameterChanges ? 1 : 0, nullptr);
+    gStandalone.engine->setOption(CB::ENGINE_OPTION_PROJECT_LOAD_THREADS,  static_cast<int>(gStandalone.engineOptions.projectLoadThreads), nullptr);
+    gStandalone.engine->setOption(CB::ENGINE_OPTION_PROJECT_SIDECAR_MIN_SIZE, static_cast<int>(gStandalone.engineOptions.sidecarMinSize), nullptr);
+    gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_BRIDGES_DEADLINE, static_cast<int>(gStandalone.engineOptions.bridgesDeadline), nullptr);
+    gStandalone.engine->setOption(CB::ENGINE_OPTION_OFFLINE_RENDER_FRAMES,   static_cast<int>(gStandalone.engineOptions.offlineRenderFrames), nullptr);
 
     if (gStandalone.engineOptions.audioDevice != nullptr)
         gStandalone.engine->setOption(CB::ENGINE_OPTION_AUDIO_DEVICE,      0, gStandalone.engineOptions.audioDevice);
@@ -584,6 +593,51 @@ void carla_set_engine_option(EngineOption option, int value, const char* valueSt
         gStandalone.engineOptions.preventBadBehaviour = (value != 0);
         break;
 
+    case CB::ENGINE_OPTION_PROCESS_WORKERS:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        gStandalone.engineOptions.processWorkers = static_cast<uint>(value);
+        break;
+
+    case CB::ENGINE_OPTION_RACK_PIPELINE_STAGES:
+        CARLA_SAFE_ASSERT_RETURN(value >= 1,);
+        gStandalone.engineOptions.rackPipelineStages = static_cast<uint>(value);
+        break;
+
+    case CB::ENGINE_OPTION_PLUGIN_BRIDGES_SPIN_TIME:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        gStandalone.engineOptions.bridgesSpinTime = static_cast<uint>(value);
+        break;
+
+    case CB::ENGINE_OPTION_PLUGIN_BRIDGES_GROUP_SIZE:
+        CARLA_SAFE_ASSERT_RETURN(value >= 1,);
+        gStandalone.engineOptions.bridgesGroupSize = static_cast<uint>(value);
+        break;
+
+    case CB::ENGINE_OPTION_BATCH_PARAMETER_CHANGES:
+        CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
+        gStandalone.engineOptions.batchParameterChanges = (value != 0);
+        break;
+
+    case CB::ENGINE_OPTION_PROJECT_LOAD_THREADS:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        gStandalone.engineOptions.projectLoadThreads = static_cast<uint>(value);
+        break;
+
+    case CB::ENGINE_OPTION_PROJECT_SIDECAR_MIN_SIZE:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        gStandalone.engineOptions.sidecarMinSize = static_cast<uint>(value);
+        break;
+
+    case CB::ENGINE_OPTION_PLUGIN_BRIDGES_DEADLINE:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        gStandalone.engineOptions.bridgesDeadline = static_cast<uint>(value);
+        break;
+
+    case CB::ENGINE_OPTION_OFFLINE_RENDER_FRAMES:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        gStandalone.engineOptions.offlineRenderFrames = static_cast<uint>(value);
+        break;
+
     case CB::ENGINE_OPTION_FRONTEND_WIN_ID:
         CARLA_SAFE_ASSERT_RETURN(valueStr != nullptr && valueStr[0] != '\0',);
         const long long winId(std::strtoll(valueStr, nullptr, 16));
@@ -1550,6 +1604,126 @@ float carla_get_output_peak_value(uint pluginId, bool isLeft)
     return gStandalone.engine->getOutputPeak(pluginId, isLeft);
 }
 
+const float* carla_get_peak_values(uint pluginId)
+{
+    static float peaks[4];
+
+    if (gStandalone.engine == nullptr)
+    {
+        carla_zeroFloats(peaks, 4);
+        return peaks;
+    }
+
+    peaks[0] = gStandalone.engine->getInputPeak(pluginId, true);
+    peaks[1] = gStandalone.engine->getInputPeak(pluginId, false);
+    peaks[2] = gStandalone.engine->getOutputPeak(pluginId, true);
+    peaks[3] = gStandalone.engine->getOutputPeak(pluginId, false);
+
+    return peaks;
+}
+
+float carla_get_plugin_cpu_load(uint pluginId)
+{
+    CARLA_SAFE_ASSERT_RETURN(gStandalone.engine != nullptr, 0.0f);
+
+    CB::EnginePluginDspStats stats;
+    gStandalone.engine->getPluginDspStats(pluginId, stats);
+
+    return stats.load;
+}
+
+const CarlaPluginDspStats* carla_get_plugin_dsp_stats(uint pluginId)
+{
+    static CarlaPluginDspStats retStats;
+
+    // reset
+    retStats.count   = 0;
+    retStats.minTime = 0.0f;
+    retStats.avgTime = 0.0f;
+    retStats.maxTime = 0.0f;
+    retStats.p99Time = 0.0f;
+    retStats.load    = 0.0f;
+
+    CARLA_SAFE_ASSERT_RETURN(gStandalone.engine != nullptr, &retStats);
+
+    CB::EnginePluginDspStats stats;
+    gStandalone.engine->getPluginDspStats(pluginId, stats);
+
+    retStats.count   = stats.count;
+    retStats.minTime = stats.minTime;
+    retStats.avgTime = stats.avgTime;
+    retStats.maxTime = stats.maxTime;
+    retStats.p99Time = stats.p99Time;
+    retStats.load    = stats.load;
+
+    return &retStats;
+}
+
+const CarlaPluginWorkerStats* carla_get_plugin_worker_stats(uint pluginId)
+{
+    static CarlaPluginWorkerStats retStats;
+
+    // reset
+    retStats.jobs          = 0;
+    retStats.dropped       = 0;
+    retStats.queueDepth    = 0;
+    retStats.maxQueueDepth = 0;
+    retStats.avgLatency    = 0.0f;
+    retStats.maxLatency    = 0.0f;
+    retStats.avgJobTime    = 0.0f;
+    retStats.maxJobTime    = 0.0f;
+
+    CARLA_SAFE_ASSERT_RETURN(gStandalone.engine != nullptr, &retStats);
+
+    CB::EngineWorkerStats stats;
+    gStandalone.engine->getPluginWorkerStats(pluginId, stats);
+
+    retStats.jobs          = stats.jobs;
+    retStats.dropped       = stats.dropped;
+    retStats.queueDepth    = stats.queueDepth;
+    retStats.maxQueueDepth = stats.maxQueueDepth;
+    retStats.avgLatency    = stats.avgLatency;
+    retStats.maxLatency    = stats.maxLatency;
+    retStats.avgJobTime    = stats.avgJobTime;
+    retStats.maxJobTime    = stats.maxJobTime;
+
+    return &retStats;
+}
+
+const CarlaParameterChanges* carla_get_plugin_parameter_changes(uint pluginId)
+{
+    static CarlaParameterChanges retChanges;
+    static std::vector<uint32_t> indexes;
+    static std::vector<float> values;
+
+    // reset
+    retChanges.count   = 0;
+    retChanges.indexes = nullptr;
+    retChanges.values  = nullptr;
+
+    CARLA_SAFE_ASSERT_RETURN(gStandalone.engine != nullptr, &retChanges);
+
+    CarlaPlugin* const plugin(gStandalone.engine->getPlugin(pluginId));
+    CARLA_SAFE_ASSERT_RETURN(plugin != nullptr, &retChanges);
+
+    const uint32_t paramCount(plugin->getParameterCount());
+
+    if (paramCount == 0)
+        return &retChanges;
+
+    if (indexes.size() < paramCount)
+    {
+        indexes.resize(paramCount);
+        values.resize(paramCount);
+    }
+
+    retChanges.count   = plugin->takeParameterChanges(indexes.data(), values.data(), paramCount);
+    retChanges.indexes = indexes.data();
+    retChanges.values  = values.data();
+
+    return &retChanges;
+}
+
 // -------------------------------------------------------------------------------------------------------------------
 
 void carla_set_active(uint pluginId, bool onOff)
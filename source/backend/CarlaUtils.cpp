@@ -20,17 +20,30 @@
 #include "CarlaNative.h"
 
 #include "CarlaBackendUtils.hpp"
-#include "CarlaLv2Utils.hpp"
+#include "CarlaLv2RdfCache.hpp"
 #include "CarlaPipeUtils.hpp"
 #include "CarlaThread.hpp"
 #include "LinkedList.hpp"
 
 #include "juce_audio_formats.h"
 
+#include <map>
+#include <set>
+#include <vector>
+
 #ifdef CARLA_OS_MAC
 # include "juce_audio_processors.h"
 #endif
 
+#ifndef CARLA_OS_WIN
+# include <cerrno>
+# include <fcntl.h>
+# include <signal.h>
+# include <spawn.h>
+# include <sys/wait.h>
+extern char** environ;
+#endif
+
 #include "../native-plugins/_data.cpp"
 
 namespace CB = CarlaBackend;
@@ -55,7 +68,9 @@ _CarlaCachedPluginInfo::_CarlaCachedPluginInfo() noexcept
       name(gNullCharPtr),
       label(gNullCharPtr),
       maker(gNullCharPtr),
-      copyright(gNullCharPtr) {}
+      copyright(gNullCharPtr),
+      filename(gNullCharPtr),
+      uniqueId(0) {}
 
 // -------------------------------------------------------------------------------------------------------------------
 
@@ -212,15 +227,847 @@ const char* carla_get_supported_file_extensions()
     return retText;
 }
 
+// -------------------------------------------------------------------------------------------------------------------
+// Binary plugin cache, for formats that need carla-discovery (LADSPA, DSSI, VST2 and VST3)
+//
+// Results are stored per binary, keyed by filename and validated by modification time and size.
+// On refresh only new or changed binaries are scanned, by a pool of workers running one discovery process each.
+
+static CarlaString gDiscoveryTool;
+static uint gDiscoveryMaxWorkers = 0;
+static bool gDiscoveryCancelled = false;
+
+static const uint32_t kBinaryCacheMagic   = 0x43504331; // "CPC1"
+static const uint32_t kBinaryCacheVersion = 1;
+static const uint32_t kDiscoveryTimeout   = 30000; // ms, per binary
+
+struct BinaryPluginInfo {
+    uint hints;
+    int64_t uniqueId;
+    uint32_t audioIns, audioOuts;
+    uint32_t midiIns, midiOuts;
+    uint32_t parameterIns, parameterOuts;
+    juce::String name, label, maker;
+
+    BinaryPluginInfo() noexcept
+        : hints(0x0),
+          uniqueId(0),
+          audioIns(0),
+          audioOuts(0),
+          midiIns(0),
+          midiOuts(0),
+          parameterIns(0),
+          parameterOuts(0),
+          name(),
+          label(),
+          maker() {}
+};
+
+struct BinaryCacheEntry {
+    int64_t modTime;
+    int64_t size;
+    std::vector<BinaryPluginInfo> plugins;
+
+    BinaryCacheEntry() noexcept
+        : modTime(0),
+          size(0),
+          plugins() {}
+};
+
+typedef std::map<juce::String, BinaryCacheEntry> BinaryCacheMap;
+
+// -------------------------------------------------------------------------------------------------------------------
+// Parse the output of a carla-discovery run, broken plugins (crash or timeout) simply produce less results
+
+static void parseDiscoveryOutput(const juce::String& output, const juce::String& filename, std::vector<BinaryPluginInfo>& plugins)
+{
+    const juce::String fakeLabel(juce::File(filename).getFileNameWithoutExtension());
+
+    juce::StringArray lines;
+    lines.addLines(output);
+
+    BinaryPluginInfo pinfo;
+    bool inPlugin = false;
+
+    for (juce::String *it=lines.begin(), *end=lines.end(); it != end; ++it)
+    {
+        const juce::String line(it->trim());
+
+        if (line == "carla-discovery::init::-----------")
+        {
+            pinfo    = BinaryPluginInfo();
+            inPlugin = true;
+            continue;
+        }
+
+        if (line == "carla-discovery::end::------------")
+        {
+            if (inPlugin)
+                plugins.push_back(pinfo);
+            inPlugin = false;
+            continue;
+        }
+
+        if (! line.startsWith("carla-discovery::"))
+            continue;
+
+        const juce::String prop(line.fromFirstOccurrenceOf("carla-discovery::", false, false).upToFirstOccurrenceOf("::", false, false));
+        const juce::String value(line.fromFirstOccurrenceOf("carla-discovery::", false, false).fromFirstOccurrenceOf("::", false, false));
+
+        if (prop == "info" || prop == "warning" || prop == "error")
+        {
+            carla_stdout("%s - %s", line.toRawUTF8(), filename.toRawUTF8());
+            continue;
+        }
+
+        if (! inPlugin)
+            continue;
+
+        /**/ if (prop == "name")
+            pinfo.name = value.isNotEmpty() ? value : fakeLabel;
+        else if (prop == "label")
+            pinfo.label = value.isNotEmpty() ? value : fakeLabel;
+        else if (prop == "maker")
+            pinfo.maker = value;
+        else if (prop == "uniqueId")
+            pinfo.uniqueId = value.getLargeIntValue();
+        else if (prop == "hints")
+            pinfo.hints = static_cast<uint>(value.getIntValue());
+        else if (prop == "audio.ins")
+            pinfo.audioIns = static_cast<uint32_t>(value.getIntValue());
+        else if (prop == "audio.outs")
+            pinfo.audioOuts = static_cast<uint32_t>(value.getIntValue());
+        else if (prop == "midi.ins")
+            pinfo.midiIns = static_cast<uint32_t>(value.getIntValue());
+        else if (prop == "midi.outs")
+            pinfo.midiOuts = static_cast<uint32_t>(value.getIntValue());
+        else if (prop == "parameters.ins")
+            pinfo.parameterIns = static_cast<uint32_t>(value.getIntValue());
+        else if (prop == "parameters.outs")
+            pinfo.parameterOuts = static_cast<uint32_t>(value.getIntValue());
+    }
+}
+
+// -------------------------------------------------------------------------------------------------------------------
+// Work shared by all discovery workers of a scan
+
+struct DiscoveryJobs {
+    CarlaMutex mutex;
+    juce::StringArray args;
+    juce::StringArray files;
+    int next;
+    int stored;
+    BinaryCacheMap& cache;
+
+    DiscoveryJobs(const char* const stype, BinaryCacheMap& c)
+        : mutex(),
+          args(),
+          files(),
+          next(0),
+          stored(0),
+          cache(c)
+    {
+#if defined(CARLA_OS_LINUX) || defined(CARLA_OS_MAC)
+        args.add("env");
+        args.add("LANG=C");
+        args.add("LD_PRELOAD=");
+#endif
+        args.add(gDiscoveryTool.buffer());
+        args.add(stype);
+    }
+
+    bool takeNext(juce::String& filename)
+    {
+        const CarlaMutexLocker cml(mutex);
+
+        if (next >= files.size() || __atomic_load_n(&gDiscoveryCancelled, __ATOMIC_ACQUIRE))
+            return false;
+
+        filename = files[next++];
+        return true;
+    }
+
+    // only called for completed scans, entries of failed or cancelled ones are kept as they were
+    void store(const juce::String& filename, const int64_t modTime, const int64_t size, const std::vector<BinaryPluginInfo>& plugins)
+    {
+        const CarlaMutexLocker cml(mutex);
+
+        // the process might have been killed halfway, scan again next time
+        if (__atomic_load_n(&gDiscoveryCancelled, __ATOMIC_ACQUIRE))
+            return;
+
+        BinaryCacheEntry& entry(cache[filename]);
+        entry.modTime = modTime;
+        entry.size    = size;
+        entry.plugins = plugins;
+        ++stored;
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(DiscoveryJobs)
+};
+
+// -------------------------------------------------------------------------------------------------------------------
+// A single discovery process with its stdout captured.
+// juce::ChildProcess is built with vfork and cannot redirect output on non-Windows systems, so use posix_spawn there.
+
+class DiscoveryProcess
+{
+public:
+    DiscoveryProcess() noexcept
+#ifdef CARLA_OS_WIN
+        : fProcess() {}
+#else
+        : fPid(-1),
+          fPipe(-1) {}
+#endif
+
+    ~DiscoveryProcess()
+    {
+        wait();
+    }
+
+    bool start(const juce::StringArray& args)
+    {
+#ifdef CARLA_OS_WIN
+        return fProcess.start(args, juce::ChildProcess::wantStdOut);
+#else
+        std::vector<juce::String> strings(args.begin(), args.end());
+        std::vector<char*> argv;
+
+        for (std::vector<juce::String>::iterator it=strings.begin(), end=strings.end(); it != end; ++it)
+            argv.push_back(const_cast<char*>(it->toRawUTF8()));
+        argv.push_back(nullptr);
+
+        // spawn one process at a time, so pipe write ends never leak into another worker's child
+        static CarlaMutex sSpawnMutex;
+        const CarlaMutexLocker cml(sSpawnMutex);
+
+        int fds[2];
+        CARLA_SAFE_ASSERT_RETURN(::pipe(fds) == 0, false);
+
+        ::fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+        ::fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+        posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+        // own process group, so that kill() also takes down anything the tool started
+        posix_spawnattr_t attr;
+        posix_spawnattr_init(&attr);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+        posix_spawnattr_setpgroup(&attr, 0);
+
+        const int ret(posix_spawnp(&fPid, argv[0], &actions, &attr, argv.data(), environ));
+
+        posix_spawnattr_destroy(&attr);
+        posix_spawn_file_actions_destroy(&actions);
+        ::close(fds[1]);
+
+        if (ret != 0)
+        {
+            ::close(fds[0]);
+            fPid = -1;
+            return false;
+        }
+
+        fPipe = fds[0];
+        return true;
+#endif
+    }
+
+    // blocks until the process closes its output, which happens when it exits or gets killed
+    juce::String readOutput()
+    {
+#ifdef CARLA_OS_WIN
+        return fProcess.readAllProcessOutput();
+#else
+        CARLA_SAFE_ASSERT_RETURN(fPipe >= 0, juce::String());
+
+        juce::MemoryOutputStream out;
+        char buf[4096];
+
+        for (;;)
+        {
+            const ssize_t r(::read(fPipe, buf, sizeof(buf)));
+
+            if (r > 0)
+                out.write(buf, static_cast<size_t>(r));
+            else if (r < 0 && errno == EINTR)
+                continue;
+            else
+                break;
+        }
+
+        ::close(fPipe);
+        fPipe = -1;
+
+        return out.toUTF8();
+#endif
+    }
+
+    void kill()
+    {
+#ifdef CARLA_OS_WIN
+        fProcess.kill();
+#else
+        if (fPid > 0)
+            ::kill(-fPid, SIGKILL);
+#endif
+    }
+
+    void wait()
+    {
+#ifdef CARLA_OS_WIN
+        fProcess.waitForProcessToFinish(-1);
+#else
+        if (fPipe >= 0)
+        {
+            ::close(fPipe);
+            fPipe = -1;
+        }
+
+        if (fPid > 0)
+        {
+            int status;
+            while (::waitpid(fPid, &status, 0) < 0 && errno == EINTR) {}
+            fPid = -1;
+        }
+#endif
+    }
+
+private:
+#ifdef CARLA_OS_WIN
+    juce::ChildProcess fProcess;
+#else
+    pid_t fPid;
+    int fPipe;
+#endif
+
+    CARLA_DECLARE_NON_COPY_CLASS(DiscoveryProcess)
+};
+
+// -------------------------------------------------------------------------------------------------------------------
+// Discovery worker, runs one sandboxed discovery process at a time
+// The scanning thread kills processes that take longer than kDiscoveryTimeout.
+
+class DiscoveryWorker : public CarlaThread
+{
+public:
+    DiscoveryWorker(DiscoveryJobs& jobs)
+        : CarlaThread("DiscoveryWorker"),
+          fJobs(jobs),
+          fProcess(nullptr),
+          fProcessMutex(),
+          fStartTime(0) {}
+
+    void killIfStuck(const uint32_t now)
+    {
+        const CarlaMutexLocker cml(fProcessMutex);
+
+        if (fProcess == nullptr)
+            return;
+        if (! __atomic_load_n(&gDiscoveryCancelled, __ATOMIC_ACQUIRE) && now - fStartTime < kDiscoveryTimeout)
+            return;
+
+        fProcess->kill();
+    }
+
+protected:
+    void run() override
+    {
+        juce::String filename;
+
+        while (fJobs.takeNext(filename))
+        {
+            juce::StringArray args(fJobs.args);
+            args.add(filename);
+
+            // taken before scanning, a binary changing meanwhile is scanned again next time
+            const juce::File file(filename);
+            const int64_t modTime(file.getLastModificationTime().toMilliseconds());
+            const int64_t size(file.getSize());
+
+            DiscoveryProcess process;
+            std::vector<BinaryPluginInfo> plugins;
+
+            if (process.start(args))
+            {
+                {
+                    const CarlaMutexLocker cml(fProcessMutex);
+                    fProcess   = &process;
+                    fStartTime = juce::Time::getMillisecondCounter();
+                }
+
+                const juce::String output(process.readOutput());
+
+                {
+                    const CarlaMutexLocker cml(fProcessMutex);
+                    fProcess = nullptr;
+                }
+
+                process.wait();
+                parseDiscoveryOutput(output, filename, plugins);
+            }
+            else
+            {
+                carla_stderr("Failed to start discovery tool for '%s'", filename.toRawUTF8());
+                continue;
+            }
+
+            // binaries without plugins are cached too, so they are not scanned again until they change
+            fJobs.store(filename, modTime, size, plugins);
+        }
+    }
+
+private:
+    DiscoveryJobs& fJobs;
+
+    DiscoveryProcess* fProcess;
+    CarlaMutex fProcessMutex;
+    uint32_t fStartTime;
+
+    CARLA_DECLARE_NON_COPY_CLASS(DiscoveryWorker)
+};
+
+// -------------------------------------------------------------------------------------------------------------------
+// Persistent cache for a single plugin type
+
+class PluginBinaryCache
+{
+public:
+    PluginBinaryCache(const CB::PluginType ptype) noexcept
+        : fType(ptype),
+          fLoaded(false),
+          fEntries(),
+          fResults() {}
+
+    uint refresh(const char* const pluginPath)
+    {
+        if (! fLoaded)
+        {
+            fLoaded = true;
+            load();
+        }
+
+        fResults.clear();
+
+        // find all binaries in the requested paths
+        juce::Array<juce::File> binaries;
+
+        {
+#ifdef CARLA_OS_WIN
+            const juce::StringArray paths(juce::StringArray::fromTokens(pluginPath, ";", ""));
+#else
+            const juce::StringArray paths(juce::StringArray::fromTokens(pluginPath, ":", ""));
+#endif
+
+            for (const juce::String *it=paths.begin(), *end=paths.end(); it != end; ++it)
+            {
+                const juce::String path(it->trim());
+
+                if (juce::File::isAbsolutePath(path) && juce::File(path).isDirectory())
+                    findBinaries(juce::File(path), binaries);
+            }
+        }
+
+        std::set<juce::String> filenames;
+        juce::StringArray changed;
+
+        for (juce::File *it=binaries.begin(), *end=binaries.end(); it != end; ++it)
+        {
+            const juce::String filename(it->getFullPathName());
+
+            if (! filenames.insert(filename).second)
+                continue;
+
+            const int64_t modTime(it->getLastModificationTime().toMilliseconds());
+            const int64_t size(it->getSize());
+
+            BinaryCacheMap::iterator cit(fEntries.find(filename));
+
+            if (cit != fEntries.end() && cit->second.modTime == modTime && cit->second.size == size)
+                continue;
+
+            // entries are only updated once scanned
+            changed.add(filename);
+        }
+
+        bool modified = false;
+
+        // scan whatever is new or changed, without a tool the previous results are kept
+        if (changed.size() > 0 && gDiscoveryTool.isNotEmpty())
+        {
+            carla_stdout("Scanning %i new or changed %s binaries", changed.size(), CB::getPluginTypeAsString(fType));
+            modified = scan(changed) > 0;
+        }
+
+        // drop entries for binaries that no longer exist, they might belong to other search paths
+        for (BinaryCacheMap::iterator it=fEntries.begin(); it != fEntries.end();)
+        {
+            if (juce::File(it->first).exists())
+            {
+                ++it;
+            }
+            else
+            {
+                fEntries.erase(it++);
+                modified = true;
+            }
+        }
+
+        if (modified)
+            save();
+
+        // results are sorted by filename
+        for (std::set<juce::String>::const_iterator it=filenames.begin(), end=filenames.end(); it != end; ++it)
+        {
+            BinaryCacheMap::const_iterator cit(fEntries.find(*it));
+
+            // not scanned yet
+            if (cit == fEntries.end())
+                continue;
+
+            for (std::vector<BinaryPluginInfo>::const_iterator pit=cit->second.plugins.begin(), pend=cit->second.plugins.end(); pit != pend; ++pit)
+                fResults.push_back(std::make_pair(&cit->first, &(*pit)));
+        }
+
+        return static_cast<uint>(fResults.size());
+    }
+
+    bool fillInfo(const uint index, CarlaCachedPluginInfo& info) const
+    {
+        CARLA_SAFE_ASSERT_RETURN(index < fResults.size(), false);
+
+        const juce::String&     filename(*fResults[index].first);
+        const BinaryPluginInfo& pinfo(*fResults[index].second);
+
+        info.category      = CB::getPluginCategoryFromName(pinfo.name.toRawUTF8());
+        info.hints         = pinfo.hints;
+        info.audioIns      = pinfo.audioIns;
+        info.audioOuts     = pinfo.audioOuts;
+        info.midiIns       = pinfo.midiIns;
+        info.midiOuts      = pinfo.midiOuts;
+        info.parameterIns  = pinfo.parameterIns;
+        info.parameterOuts = pinfo.parameterOuts;
+        info.name          = pinfo.name.toRawUTF8();
+        info.label         = pinfo.label.toRawUTF8();
+        info.maker         = pinfo.maker.toRawUTF8();
+        info.copyright     = gNullCharPtr;
+        info.filename      = filename.toRawUTF8();
+        info.uniqueId      = pinfo.uniqueId;
+        return true;
+    }
+
+private:
+    const CB::PluginType fType;
+    bool fLoaded;
+
+    BinaryCacheMap fEntries;
+    std::vector<std::pair<const juce::String*, const BinaryPluginInfo*> > fResults;
+
+    void findBinaries(const juce::File& dir, juce::Array<juce::File>& binaries) const
+    {
+        if (fType == CB::PLUGIN_VST3)
+        {
+#ifdef CARLA_OS_MAC
+            dir.findChildFiles(binaries, juce::File::findDirectories, true, "*.vst3");
+#else
+            dir.findChildFiles(binaries, juce::File::findFiles, true, "*.vst3");
+#endif
+            return;
+        }
+
+#if defined(CARLA_OS_WIN)
+        dir.findChildFiles(binaries, juce::File::findFiles, true, "*.dll");
+#elif defined(CARLA_OS_MAC)
+        if (fType == CB::PLUGIN_VST2)
+        {
+            dir.findChildFiles(binaries, juce::File::findDirectories, true, "*.vst");
+            return;
+        }
+        dir.findChildFiles(binaries, juce::File::findFiles, true, "*.dylib;*.so");
+#else
+        dir.findChildFiles(binaries, juce::File::findFiles, true, "*.so");
+#endif
+    }
+
+    // returns how many binaries were scanned
+    int scan(const juce::StringArray& files)
+    {
+        __atomic_store_n(&gDiscoveryCancelled, false, __ATOMIC_RELEASE);
+
+        DiscoveryJobs jobs(CB::getPluginTypeAsString(fType), fEntries);
+        jobs.files = files;
+
+        uint numWorkers = gDiscoveryMaxWorkers != 0 ? gDiscoveryMaxWorkers : static_cast<uint>(juce::SystemStats::getNumCpus());
+
+        if (numWorkers > static_cast<uint>(files.size()))
+            numWorkers = static_cast<uint>(files.size());
+        if (numWorkers == 0)
+            numWorkers = 1;
+
+        juce::OwnedArray<DiscoveryWorker> workers;
+
+        for (uint i=0; i < numWorkers; ++i)
+        {
+            DiscoveryWorker* const worker(new DiscoveryWorker(jobs));
+            workers.add(worker);
+            worker->startThread();
+        }
+
+        for (bool running = true; running;)
+        {
+            carla_msleep(50);
+
+            const uint32_t now(juce::Time::getMillisecondCounter());
+            running = false;
+
+            for (DiscoveryWorker **it=workers.begin(), **end=workers.end(); it != end; ++it)
+            {
+                if (! (*it)->isThreadRunning())
+                    continue;
+
+                running = true;
+                (*it)->killIfStuck(now);
+            }
+        }
+
+        return jobs.stored;
+    }
+
+    juce::File getCacheFile() const
+    {
+#if defined(CARLA_OS_WIN) || defined(CARLA_OS_MAC)
+        const juce::File dir(juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory).getChildFile("falkTX"));
+#else
+        const char* const xdgConfig(std::getenv("XDG_CONFIG_HOME"));
+        const juce::File dir((xdgConfig != nullptr && xdgConfig[0] != '\0')
+                             ? juce::File(xdgConfig).getChildFile("falkTX")
+                             : juce::File::getSpecialLocation(juce::File::userHomeDirectory).getChildFile(".config/falkTX"));
+#endif
+        return dir.getChildFile(juce::String("CarlaPluginCache-") + CB::getPluginTypeAsString(fType) + ".bin");
+    }
+
+    void load()
+    {
+        const juce::File file(getCacheFile());
+
+        if (! file.existsAsFile())
+            return;
+
+        juce::FileInputStream stream(file);
+
+        if (stream.failedToOpen())
+            return;
+
+        if (static_cast<uint32_t>(stream.readInt()) != kBinaryCacheMagic)
+            return;
+        if (static_cast<uint32_t>(stream.readInt()) != kBinaryCacheVersion)
+            return;
+        if (stream.readInt() != static_cast<int>(fType))
+            return;
+
+        const int numEntries(stream.readInt());
+
+        for (int i=0; i < numEntries && ! stream.isExhausted(); ++i)
+        {
+            const juce::String filename(stream.readString());
+
+            BinaryCacheEntry& entry(fEntries[filename]);
+            entry.modTime = stream.readInt64();
+            entry.size    = stream.readInt64();
+
+            const int numPlugins(stream.readInt());
+            CARLA_SAFE_ASSERT_BREAK(numPlugins >= 0);
+
+            entry.plugins.resize(static_cast<size_t>(numPlugins));
+
+            for (std::vector<BinaryPluginInfo>::iterator it=entry.plugins.begin(), end=entry.plugins.end(); it != end; ++it)
+            {
+                BinaryPluginInfo& pinfo(*it);
+                pinfo.hints         = static_cast<uint>(stream.readInt());
+                pinfo.uniqueId      = stream.readInt64();
+                pinfo.audioIns      = static_cast<uint32_t>(stream.readInt());
+                pinfo.audioOuts     = static_cast<uint32_t>(stream.readInt());
+                pinfo.midiIns       = static_cast<uint32_t>(stream.readInt());
+                pinfo.midiOuts      = static_cast<uint32_t>(stream.readInt());
+                pinfo.parameterIns  = static_cast<uint32_t>(stream.readInt());
+                pinfo.parameterOuts = static_cast<uint32_t>(stream.readInt());
+                pinfo.name          = stream.readString();
+                pinfo.label         = stream.readString();
+                pinfo.maker         = stream.readString();
+            }
+        }
+
+        carla_debug("Loaded %i cached %s binaries", static_cast<int>(fEntries.size()), CB::getPluginTypeAsString(fType));
+    }
+
+    void save() const
+    {
+        const juce::File file(getCacheFile());
+        file.getParentDirectory().createDirectory();
+
+        const juce::TemporaryFile tmpFile(file);
+
+        {
+            juce::FileOutputStream stream(tmpFile.getFile());
+
+            if (stream.failedToOpen())
+            {
+                carla_stderr("Failed to write plugin cache '%s'", file.getFullPathName().toRawUTF8());
+                return;
+            }
+
+            stream.writeInt(static_cast<int>(kBinaryCacheMagic));
+            stream.writeInt(static_cast<int>(kBinaryCacheVersion));
+            stream.writeInt(static_cast<int>(fType));
+            stream.writeInt(static_cast<int>(fEntries.size()));
+
+            for (BinaryCacheMap::const_iterator it=fEntries.begin(), end=fEntries.end(); it != end; ++it)
+            {
+                const BinaryCacheEntry& entry(it->second);
+
+                stream.writeString(it->first);
+                stream.writeInt64(entry.modTime);
+                stream.writeInt64(entry.size);
+                stream.writeInt(static_cast<int>(entry.plugins.size()));
+
+                for (std::vector<BinaryPluginInfo>::const_iterator pit=entry.plugins.begin(), pend=entry.plugins.end(); pit != pend; ++pit)
+                {
+                    const BinaryPluginInfo& pinfo(*pit);
+                    stream.writeInt(static_cast<int>(pinfo.hints));
+                    stream.writeInt64(pinfo.uniqueId);
+                    stream.writeInt(static_cast<int>(pinfo.audioIns));
+                    stream.writeInt(static_cast<int>(pinfo.audioOuts));
+                    stream.writeInt(static_cast<int>(pinfo.midiIns));
+                    stream.writeInt(static_cast<int>(pinfo.midiOuts));
+                    stream.writeInt(static_cast<int>(pinfo.parameterIns));
+                    stream.writeInt(static_cast<int>(pinfo.parameterOuts));
+                    stream.writeString(pinfo.name);
+                    stream.writeString(pinfo.label);
+                    stream.writeString(pinfo.maker);
+                }
+            }
+
+            stream.flush();
+        }
+
+        tmpFile.overwriteTargetFileWithTemporary();
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(PluginBinaryCache)
+};
+
+static PluginBinaryCache* getPluginBinaryCache(const CB::PluginType ptype)
+{
+    static PluginBinaryCache sLADSPA(CB::PLUGIN_LADSPA);
+    static PluginBinaryCache sDSSI(CB::PLUGIN_DSSI);
+    static PluginBinaryCache sVST2(CB::PLUGIN_VST2);
+    static PluginBinaryCache sVST3(CB::PLUGIN_VST3);
+
+    switch (ptype)
+    {
+    case CB::PLUGIN_LADSPA:
+        return &sLADSPA;
+    case CB::PLUGIN_DSSI:
+        return &sDSSI;
+    case CB::PLUGIN_VST2:
+        return &sVST2;
+    case CB::PLUGIN_VST3:
+        return &sVST3;
+    default:
+        return nullptr;
+    }
+}
+
+// -------------------------------------------------------------------------------------------------------------------
+// LV2 category from lv2_rdf plugin types, the last matching entry wins
+
+struct Lv2CategoryMapping {
+    uint typeIndex;
+    LV2_Property type;
+    CB::PluginCategory category;
+};
+
+static const Lv2CategoryMapping kLv2CategoryMappings[] = {
+    { 0, LV2_PLUGIN_ALLPASS,    CB::PLUGIN_CATEGORY_FILTER     },
+    { 0, LV2_PLUGIN_AMPLIFIER,  CB::PLUGIN_CATEGORY_DYNAMICS   },
+    { 1, LV2_PLUGIN_ANALYSER,   CB::PLUGIN_CATEGORY_UTILITY    },
+    { 0, LV2_PLUGIN_BANDPASS,   CB::PLUGIN_CATEGORY_FILTER     },
+    { 1, LV2_PLUGIN_CHORUS,     CB::PLUGIN_CATEGORY_MODULATOR  },
+    { 0, LV2_PLUGIN_COMB,       CB::PLUGIN_CATEGORY_FILTER     },
+    { 0, LV2_PLUGIN_COMPRESSOR, CB::PLUGIN_CATEGORY_DYNAMICS   },
+    { 1, LV2_PLUGIN_CONSTANT,   CB::PLUGIN_CATEGORY_OTHER      },
+    { 1, LV2_PLUGIN_CONVERTER,  CB::PLUGIN_CATEGORY_UTILITY    },
+    { 0, LV2_PLUGIN_DELAY,      CB::PLUGIN_CATEGORY_DELAY      },
+    { 0, LV2_PLUGIN_DISTORTION, CB::PLUGIN_CATEGORY_DISTORTION },
+    { 0, LV2_PLUGIN_DYNAMICS,   CB::PLUGIN_CATEGORY_DYNAMICS   },
+    { 0, LV2_PLUGIN_EQ,         CB::PLUGIN_CATEGORY_EQ         },
+    { 0, LV2_PLUGIN_ENVELOPE,   CB::PLUGIN_CATEGORY_DYNAMICS   },
+    { 0, LV2_PLUGIN_EXPANDER,   CB::PLUGIN_CATEGORY_DYNAMICS   },
+    { 0, LV2_PLUGIN_FILTER,     CB::PLUGIN_CATEGORY_FILTER     },
+    { 1, LV2_PLUGIN_FLANGER,    CB::PLUGIN_CATEGORY_MODULATOR  },
+    { 1, LV2_PLUGIN_FUNCTION,   CB::PLUGIN_CATEGORY_UTILITY    },
+    { 0, LV2_PLUGIN_GATE,       CB::PLUGIN_CATEGORY_DYNAMICS   },
+    { 1, LV2_PLUGIN_GENERATOR,  CB::PLUGIN_CATEGORY_OTHER      },
+    { 0, LV2_PLUGIN_HIGHPASS,   CB::PLUGIN_CATEGORY_FILTER     },
+    { 0, LV2_PLUGIN_LIMITER,    CB::PLUGIN_CATEGORY_DYNAMICS   },
+    { 0, LV2_PLUGIN_LOWPASS,    CB::PLUGIN_CATEGORY_FILTER     },
+    { 1, LV2_PLUGIN_MIXER,      CB::PLUGIN_CATEGORY_UTILITY    },
+    { 1, LV2_PLUGIN_MODULATOR,  CB::PLUGIN_CATEGORY_MODULATOR  },
+    { 0, LV2_PLUGIN_MULTI_EQ,   CB::PLUGIN_CATEGORY_EQ         },
+    { 1, LV2_PLUGIN_OSCILLATOR, CB::PLUGIN_CATEGORY_OTHER      },
+    { 0, LV2_PLUGIN_PARA_EQ,    CB::PLUGIN_CATEGORY_EQ         },
+    { 1, LV2_PLUGIN_PHASER,     CB::PLUGIN_CATEGORY_MODULATOR  },
+    { 1, LV2_PLUGIN_PITCH,      CB::PLUGIN_CATEGORY_OTHER      },
+    { 0, LV2_PLUGIN_REVERB,     CB::PLUGIN_CATEGORY_DELAY      },
+    { 0, LV2_PLUGIN_SIMULATOR,  CB::PLUGIN_CATEGORY_OTHER      },
+    { 1, LV2_PLUGIN_SPATIAL,    CB::PLUGIN_CATEGORY_OTHER      },
+    { 1, LV2_PLUGIN_SPECTRAL,   CB::PLUGIN_CATEGORY_OTHER      },
+    { 1, LV2_PLUGIN_UTILITY,    CB::PLUGIN_CATEGORY_UTILITY    },
+    { 0, LV2_PLUGIN_WAVESHAPER, CB::PLUGIN_CATEGORY_DISTORTION },
+    { 1, LV2_PLUGIN_INSTRUMENT, CB::PLUGIN_CATEGORY_SYNTH      }
+};
+
+static CB::PluginCategory getLv2CategoryFromTypes(const LV2_Property types[2]) noexcept
+{
+    CB::PluginCategory category = CB::PLUGIN_CATEGORY_NONE;
+
+    for (uint i=0; i < sizeof(kLv2CategoryMappings)/sizeof(Lv2CategoryMapping); ++i)
+    {
+        const Lv2CategoryMapping& mapping(kLv2CategoryMappings[i]);
+
+        if (types[mapping.typeIndex] & mapping.type)
+            category = mapping.category;
+    }
+
+    return category;
+}
+
 // -------------------------------------------------------------------------------------------------------------------
 
 uint carla_get_cached_plugin_count(CB::PluginType ptype, const char* pluginPath)
 {
-    CARLA_SAFE_ASSERT_RETURN(ptype == CB::PLUGIN_INTERNAL || ptype == CB::PLUGIN_LV2 || ptype == CB::PLUGIN_AU, 0);
+    CARLA_SAFE_ASSERT_RETURN(ptype == CB::PLUGIN_INTERNAL || ptype == CB::PLUGIN_LV2 || ptype == CB::PLUGIN_AU ||
+                             ptype == CB::PLUGIN_LADSPA || ptype == CB::PLUGIN_DSSI || ptype == CB::PLUGIN_VST2 || ptype == CB::PLUGIN_VST3, 0);
     carla_debug("carla_get_cached_plugin_count(%i:%s)", ptype, CB::PluginType2Str(ptype));
 
     switch (ptype)
     {
+    case CB::PLUGIN_LADSPA:
+    case CB::PLUGIN_DSSI:
+    case CB::PLUGIN_VST2:
+    case CB::PLUGIN_VST3: {
+        CARLA_SAFE_ASSERT_RETURN(pluginPath != nullptr, 0);
+
+        PluginBinaryCache* const cache(getPluginBinaryCache(ptype));
+        CARLA_SAFE_ASSERT_RETURN(cache != nullptr, 0);
+
+        return cache->refresh(pluginPath);
+    }
+
     case CB::PLUGIN_INTERNAL: {
         uint32_t count = 0;
         carla_get_native_plugins_data(&count);
@@ -228,9 +1075,9 @@ uint carla_get_cached_plugin_count(CB::PluginType ptype, const char* pluginPath)
     }
 
     case CB::PLUGIN_LV2: {
-        Lv2WorldClass& lv2World(Lv2WorldClass::getInstance());
-        lv2World.initIfNeeded(pluginPath);
-        return lv2World.getPluginCount();
+        Lv2RdfCache& lv2Cache(Lv2RdfCache::getInstance());
+        lv2Cache.initIfNeeded(pluginPath);
+        return lv2Cache.getPluginCount();
     }
 
     case CB::PLUGIN_AU: {
@@ -263,8 +1110,23 @@ const CarlaCachedPluginInfo* carla_get_cached_plugin_info(CB::PluginType ptype,
 
     static CarlaCachedPluginInfo info;
 
+    info.filename = gNullCharPtr;
+    info.uniqueId = 0;
+
     switch (ptype)
     {
+    case CB::PLUGIN_LADSPA:
+    case CB::PLUGIN_DSSI:
+    case CB::PLUGIN_VST2:
+    case CB::PLUGIN_VST3: {
+        const PluginBinaryCache* const cache(getPluginBinaryCache(ptype));
+        CARLA_SAFE_ASSERT_BREAK(cache != nullptr);
+
+        if (cache->fillInfo(index, info))
+            return &info;
+        break;
+    }
+
     case CB::PLUGIN_INTERNAL: {
         uint32_t count = 0;
         const NativePluginDescriptor* const descs(carla_get_native_plugins_data(&count));
@@ -303,127 +1165,36 @@ const CarlaCachedPluginInfo* carla_get_cached_plugin_info(CB::PluginType ptype,
     }
 
     case CB::PLUGIN_LV2: {
-        Lv2WorldClass& lv2World(Lv2WorldClass::getInstance());
-
-        const LilvPlugin* const cPlugin(lv2World.getPluginFromIndex(index));
-        CARLA_SAFE_ASSERT_BREAK(cPlugin != nullptr);
+        Lv2RdfCache& lv2Cache(Lv2RdfCache::getInstance());
 
-        Lilv::Plugin lilvPlugin(cPlugin);
-        CARLA_SAFE_ASSERT_BREAK(lilvPlugin.get_uri().is_uri());
+        const char* const uri(lv2Cache.getPluginURI(index));
+        CARLA_SAFE_ASSERT_BREAK(uri != nullptr);
 
-        carla_stdout("Filling info for LV2 with URI '%s'", lilvPlugin.get_uri().as_uri());
+        // keeps strings valid until the next call
+        static juce::ScopedPointer<const LV2_RDF_Descriptor> rdfDescriptor;
+        rdfDescriptor = lv2Cache.getDescriptor(uri);
+        CARLA_SAFE_ASSERT_BREAK(rdfDescriptor != nullptr);
 
         // features
         info.hints = 0x0;
 
-        if (lilvPlugin.get_uis().size() > 0 || lilvPlugin.get_modgui_resources_directory().as_uri() != nullptr)
+        if (rdfDescriptor->UICount > 0)
             info.hints |= CB::PLUGIN_HAS_CUSTOM_UI;
 
+        for (uint32_t i=0; i < rdfDescriptor->FeatureCount; ++i)
         {
-            Lilv::Nodes lilvFeatureNodes(lilvPlugin.get_supported_features());
-
-            LILV_FOREACH(nodes, it, lilvFeatureNodes)
-            {
-                Lilv::Node lilvFeatureNode(lilvFeatureNodes.get(it));
-                const char* const featureURI(lilvFeatureNode.as_uri());
-                CARLA_SAFE_ASSERT_CONTINUE(featureURI != nullptr);
+            const char* const featureURI(rdfDescriptor->Features[i].URI);
+            CARLA_SAFE_ASSERT_CONTINUE(featureURI != nullptr);
 
-                if (std::strcmp(featureURI, LV2_CORE__hardRTCapable) == 0)
-                    info.hints |= CB::PLUGIN_IS_RTSAFE;
-            }
-
-            lilv_nodes_free(const_cast<LilvNodes*>(lilvFeatureNodes.me));
+            if (std::strcmp(featureURI, LV2_CORE__hardRTCapable) == 0)
+                info.hints |= CB::PLUGIN_IS_RTSAFE;
         }
 
         // category
-        info.category = CB::PLUGIN_CATEGORY_NONE;
-
-        {
-            Lilv::Nodes typeNodes(lilvPlugin.get_value(lv2World.rdf_type));
-
-            if (typeNodes.size() > 0)
-            {
-                if (typeNodes.contains(lv2World.class_allpass))
-                    info.category = CB::PLUGIN_CATEGORY_FILTER;
-                if (typeNodes.contains(lv2World.class_amplifier))
-                    info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
-                if (typeNodes.contains(lv2World.class_analyzer))
-                    info.category = CB::PLUGIN_CATEGORY_UTILITY;
-                if (typeNodes.contains(lv2World.class_bandpass))
-                    info.category = CB::PLUGIN_CATEGORY_FILTER;
-                if (typeNodes.contains(lv2World.class_chorus))
-                    info.category = CB::PLUGIN_CATEGORY_MODULATOR;
-                if (typeNodes.contains(lv2World.class_comb))
-                    info.category = CB::PLUGIN_CATEGORY_FILTER;
-                if (typeNodes.contains(lv2World.class_compressor))
-                    info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
-                if (typeNodes.contains(lv2World.class_constant))
-                    info.category = CB::PLUGIN_CATEGORY_OTHER;
-                if (typeNodes.contains(lv2World.class_converter))
-                    info.category = CB::PLUGIN_CATEGORY_UTILITY;
-                if (typeNodes.contains(lv2World.class_delay))
-                    info.category = CB::PLUGIN_CATEGORY_DELAY;
-                if (typeNodes.contains(lv2World.class_distortion))
-                    info.category = CB::PLUGIN_CATEGORY_DISTORTION;
-                if (typeNodes.contains(lv2World.class_dynamics))
-                    info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
-                if (typeNodes.contains(lv2World.class_eq))
-                    info.category = CB::PLUGIN_CATEGORY_EQ;
-                if (typeNodes.contains(lv2World.class_envelope))
-                    info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
-                if (typeNodes.contains(lv2World.class_expander))
-                    info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
-                if (typeNodes.contains(lv2World.class_filter))
-                    info.category = CB::PLUGIN_CATEGORY_FILTER;
-                if (typeNodes.contains(lv2World.class_flanger))
-                    info.category = CB::PLUGIN_CATEGORY_MODULATOR;
-                if (typeNodes.contains(lv2World.class_function))
-                    info.category = CB::PLUGIN_CATEGORY_UTILITY;
-                if (typeNodes.contains(lv2World.class_gate))
-                    info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
-                if (typeNodes.contains(lv2World.class_generator))
-                    info.category = CB::PLUGIN_CATEGORY_OTHER;
-                if (typeNodes.contains(lv2World.class_highpass))
-                    info.category = CB::PLUGIN_CATEGORY_FILTER;
-                if (typeNodes.contains(lv2World.class_limiter))
-                    info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
-                if (typeNodes.contains(lv2World.class_lowpass))
-                    info.category = CB::PLUGIN_CATEGORY_FILTER;
-                if (typeNodes.contains(lv2World.class_mixer))
-                    info.category = CB::PLUGIN_CATEGORY_UTILITY;
-                if (typeNodes.contains(lv2World.class_modulator))
-                    info.category = CB::PLUGIN_CATEGORY_MODULATOR;
-                if (typeNodes.contains(lv2World.class_multiEQ))
-                    info.category = CB::PLUGIN_CATEGORY_EQ;
-                if (typeNodes.contains(lv2World.class_oscillator))
-                    info.category = CB::PLUGIN_CATEGORY_OTHER;
-                if (typeNodes.contains(lv2World.class_paraEQ))
-                    info.category = CB::PLUGIN_CATEGORY_EQ;
-                if (typeNodes.contains(lv2World.class_phaser))
-                    info.category = CB::PLUGIN_CATEGORY_MODULATOR;
-                if (typeNodes.contains(lv2World.class_pitch))
-                    info.category = CB::PLUGIN_CATEGORY_OTHER;
-                if (typeNodes.contains(lv2World.class_reverb))
-                    info.category = CB::PLUGIN_CATEGORY_DELAY;
-                if (typeNodes.contains(lv2World.class_simulator))
-                    info.category = CB::PLUGIN_CATEGORY_OTHER;
-                if (typeNodes.contains(lv2World.class_spatial))
-                    info.category = CB::PLUGIN_CATEGORY_OTHER;
-                if (typeNodes.contains(lv2World.class_spectral))
-                    info.category = CB::PLUGIN_CATEGORY_OTHER;
-                if (typeNodes.contains(lv2World.class_utility))
-                    info.category = CB::PLUGIN_CATEGORY_UTILITY;
-                if (typeNodes.contains(lv2World.class_waveshaper))
-                    info.category = CB::PLUGIN_CATEGORY_DISTORTION;
-                if (typeNodes.contains(lv2World.class_instrument))
-                {
-                    info.category = CB::PLUGIN_CATEGORY_SYNTH;
-                    info.hints |= CB::PLUGIN_IS_SYNTH;
-                }
-            }
+        info.category = getLv2CategoryFromTypes(rdfDescriptor->Type);
 
-            lilv_nodes_free(const_cast<LilvNodes*>(typeNodes.me));
-        }
+        if (LV2_IS_INSTRUMENT(rdfDescriptor->Type[0], rdfDescriptor->Type[1]))
+            info.hints |= CB::PLUGIN_IS_SYNTH;
 
         // number data
         info.audioIns      = 0;
@@ -433,105 +1204,40 @@ const CarlaCachedPluginInfo* carla_get_cached_plugin_info(CB::PluginType ptype,
         info.parameterIns  = 0;
         info.parameterOuts = 0;
 
-        for (uint i=0, count=lilvPlugin.get_num_ports(); i<count; ++i)
+        for (uint32_t i=0; i < rdfDescriptor->PortCount; ++i)
         {
-            Lilv::Port lilvPort(lilvPlugin.get_port_by_index(i));
+            const LV2_RDF_Port& rdfPort(rdfDescriptor->Ports[i]);
 
             bool isInput;
 
-            /**/ if (lilvPort.is_a(lv2World.port_input))
+            /**/ if (LV2_IS_PORT_INPUT(rdfPort.Types))
                 isInput = true;
-            else if (lilvPort.is_a(lv2World.port_output))
+            else if (LV2_IS_PORT_OUTPUT(rdfPort.Types))
                 isInput = false;
             else
                 continue;
 
-            /**/ if (lilvPort.is_a(lv2World.port_control))
+            /**/ if (LV2_IS_PORT_CONTROL(rdfPort.Types))
             {
-                // skip some control ports
-                if (lilvPort.has_property(lv2World.reportsLatency))
+                // skip some control ports, latency is set as designation too
+                if (rdfPort.Designation != 0)
                     continue;
 
-                if (LilvNode* const designationNode = lilv_port_get(lilvPort.parent, lilvPort.me, lv2World.designation.me))
-                {
-                    bool skip = false;
-
-                    if (const char* const designation = lilv_node_as_string(designationNode))
-                    {
-                        /**/ if (std::strcmp(designation, LV2_CORE__control) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_CORE__freeWheeling) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_CORE__latency) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_PARAMETERS__sampleRate) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_TIME__bar) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_TIME__barBeat) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_TIME__beat) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_TIME__beatUnit) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_TIME__beatsPerBar) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_TIME__beatsPerMinute) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_TIME__frame) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_TIME__framesPerSecond) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_TIME__speed) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_KXSTUDIO_PROPERTIES__TimePositionTicksPerBeat) == 0)
-                            skip = true;
-                    }
-
-                    lilv_node_free(designationNode);
-
-                    if (skip)
-                        continue;
-                }
-
                 if (isInput)
                     ++(info.parameterIns);
                 else
                     ++(info.parameterOuts);
             }
-            else if (lilvPort.is_a(lv2World.port_audio))
+            else if (LV2_IS_PORT_AUDIO(rdfPort.Types))
             {
                 if (isInput)
                     ++(info.audioIns);
                 else
                     ++(info.audioOuts);
             }
-            else if (lilvPort.is_a(lv2World.port_cv))
-            {
-            }
-            else if (lilvPort.is_a(lv2World.port_atom))
+            else if (LV2_IS_PORT_ATOM_SEQUENCE(rdfPort.Types) || LV2_IS_PORT_EVENT(rdfPort.Types))
             {
-                Lilv::Nodes supportNodes(lilvPort.get_value(lv2World.atom_supports));
-
-                for (LilvIter *it = lilv_nodes_begin(supportNodes.me); ! lilv_nodes_is_end(supportNodes.me, it); it = lilv_nodes_next(supportNodes.me, it))
-                {
-                    const Lilv::Node node(lilv_nodes_get(supportNodes.me, it));
-                    CARLA_SAFE_ASSERT_CONTINUE(node.is_uri());
-
-                    if (node.equals(lv2World.midi_event))
-                    {
-                        if (isInput)
-                            ++(info.midiIns);
-                        else
-                            ++(info.midiOuts);
-                    }
-                }
-
-                lilv_nodes_free(const_cast<LilvNodes*>(supportNodes.me));
-            }
-            else if (lilvPort.is_a(lv2World.port_event))
-            {
-                if (lilvPort.supports_event(lv2World.midi_event))
+                if (LV2_PORT_SUPPORTS_MIDI_EVENT(rdfPort.Types))
                 {
                     if (isInput)
                         ++(info.midiIns);
@@ -539,7 +1245,7 @@ const CarlaCachedPluginInfo* carla_get_cached_plugin_info(CB::PluginType ptype,
                         ++(info.midiOuts);
                 }
             }
-            else if (lilvPort.is_a(lv2World.port_midi))
+            else if (LV2_IS_PORT_MIDI_LL(rdfPort.Types))
             {
                 if (isInput)
                     ++(info.midiIns);
@@ -549,35 +1255,10 @@ const CarlaCachedPluginInfo* carla_get_cached_plugin_info(CB::PluginType ptype,
         }
 
         // text data
-        static CarlaString suri, sname, smaker, slicense;
-        suri.clear(); sname.clear(); smaker.clear(); slicense.clear();
-
-        suri = lilvPlugin.get_uri().as_uri();
-
-        if (const char* const name = lilvPlugin.get_name().as_string())
-            sname = name;
-        else
-            sname.clear();
-
-        if (const char* const author = lilvPlugin.get_author_name().as_string())
-            smaker = author;
-        else
-            smaker.clear();
-
-        Lilv::Nodes licenseNodes(lilvPlugin.get_value(lv2World.doap_license));
-
-        if (licenseNodes.size() > 0)
-        {
-            if (const char* const license = licenseNodes.get_first().as_string())
-                slicense = license;
-        }
-
-        lilv_nodes_free(const_cast<LilvNodes*>(licenseNodes.me));
-
-        info.name      = sname;
-        info.label     = suri;
-        info.maker     = smaker;
-        info.copyright = slicense;
+        info.name      = (rdfDescriptor->Name    != nullptr) ? rdfDescriptor->Name    : gNullCharPtr;
+        info.label     = (rdfDescriptor->URI     != nullptr) ? rdfDescriptor->URI     : gNullCharPtr;
+        info.maker     = (rdfDescriptor->Author  != nullptr) ? rdfDescriptor->Author  : gNullCharPtr;
+        info.copyright = (rdfDescriptor->License != nullptr) ? rdfDescriptor->License : gNullCharPtr;
 
         return &info;
     }
@@ -653,6 +1334,24 @@ const CarlaCachedPluginInfo* carla_get_cached_plugin_info(CB::PluginType ptype,
 
 // -------------------------------------------------------------------------------------------------------------------
 
+void carla_set_discovery_tool(const char* tool, uint maxWorkers)
+{
+    carla_debug("carla_set_discovery_tool(\"%s\", %u)", tool != nullptr ? tool : "", maxWorkers);
+
+    // null or empty disables scanning
+    gDiscoveryTool       = tool != nullptr ? tool : "";
+    gDiscoveryMaxWorkers = maxWorkers;
+}
+
+void carla_cancel_plugin_discovery()
+{
+    carla_debug("carla_cancel_plugin_discovery()");
+
+    __atomic_store_n(&gDiscoveryCancelled, true, __ATOMIC_RELEASE);
+}
+
+// -------------------------------------------------------------------------------------------------------------------
+
 void carla_set_process_name(const char* name)
 {
     carla_debug("carla_set_process_name(\"%s\")", name);
@@ -110,6 +110,18 @@ typedef struct _CarlaCachedPluginInfo {
      */
     const char* copyright;
 
+    /*!
+     * Plugin binary filename.
+     * Only set for binary plugin formats (LADSPA, DSSI, VST2 and VST3).
+     */
+    const char* filename;
+
+    /*!
+     * Plugin unique Id.
+     * Only set for binary plugin formats (LADSPA, DSSI, VST2 and VST3).
+     */
+    int64_t uniqueId;
+
 #ifdef __cplusplus
     /*!
      * C++ constructor.
@@ -146,6 +158,9 @@ CARLA_EXPORT const char* carla_get_supported_file_extensions();
 /*!
  * Get how many cached plugins are available.
  * Internal, LV2 and AU plugin formats are cached and need to be discovered via this function.
+ * LADSPA, DSSI, VST2 and VST3 plugins are kept in a persistent cache keyed by binary path, modification time and size,
+ * only new or changed binaries inside @a pluginPath are scanned, using the tool set in carla_set_discovery_tool().
+ * For these formats @a pluginPath is a list of folders separated by ':' (';' on Windows).
  * Do not call this for any other plugin formats.
  */
 CARLA_EXPORT uint carla_get_cached_plugin_count(PluginType ptype, const char* pluginPath);
@@ -163,6 +178,20 @@ CARLA_EXPORT const CarlaCachedPluginInfo* carla_get_cached_plugin_info(PluginTyp
  */
 CARLA_EXPORT void carla_set_process_name(const char* name);
 
+/*!
+ * Set the discovery tool used to scan binary plugins in carla_get_cached_plugin_count().
+ * Up to @a maxWorkers binaries are scanned in parallel, each in its own discovery process.
+ * Passing 0 as @a maxWorkers uses one worker per CPU core.
+ * Passing null or an empty @a tool disables scanning, only the existing cache is used then.
+ */
+CARLA_EXPORT void carla_set_discovery_tool(const char* tool, uint maxWorkers);
+
+/*!
+ * Cancel a running binary plugin scan.
+ * Binaries already scanned are kept in the cache.
+ */
+CARLA_EXPORT void carla_cancel_plugin_discovery();
+
 /* ------------------------------------------------------------------------------------------------------------
  * pipes */
 
@@ -32,6 +32,7 @@
 #include "CarlaMathUtils.hpp"
 #include "CarlaPipeUtils.hpp"
 #include "CarlaStateUtils.hpp"
+#include "CarlaXmlUtils.hpp"
 #include "CarlaMIDI.h"
 
 #include "jackbridge/JackBridge.hpp"
@@ -39,14 +40,278 @@
 
 using juce::CharPointer_UTF8;
 using juce::File;
-using juce::MemoryOutputStream;
+using juce::FileOutputStream;
+using juce::MemoryMappedFile;
 using juce::ScopedPointer;
 using juce::String;
-using juce::XmlDocument;
-using juce::XmlElement;
+using juce::Time;
+using juce::TemporaryFile;
 
 CARLA_BACKEND_START_NAMESPACE
 
+// -----------------------------------------------------------------------
+// Engine helpers
+
+#ifndef BRIDGE_PLUGIN
+// full path of the bridge tool for a binary type, empty if not available
+static CarlaString getBridgeBinary(const char* const binaryDir, const BinaryType btype)
+{
+    CarlaString bridgeBinary(binaryDir);
+
+    if (bridgeBinary.isEmpty())
+        return bridgeBinary;
+
+    if (btype == BINARY_NATIVE)
+    {
+#ifdef CARLA_OS_WIN
+        bridgeBinary += CARLA_OS_SEP_STR "carla-bridge-native.exe";
+#else
+        bridgeBinary += CARLA_OS_SEP_STR "carla-bridge-native";
+#endif
+    }
+    else
+    {
+        switch (btype)
+        {
+        case BINARY_POSIX32:
+            bridgeBinary += CARLA_OS_SEP_STR "carla-bridge-posix32";
+            break;
+        case BINARY_POSIX64:
+            bridgeBinary += CARLA_OS_SEP_STR "carla-bridge-posix64";
+            break;
+        case BINARY_WIN32:
+            bridgeBinary += CARLA_OS_SEP_STR "carla-bridge-win32.exe";
+            break;
+        case BINARY_WIN64:
+            bridgeBinary += CARLA_OS_SEP_STR "carla-bridge-win64.exe";
+            break;
+        default:
+            bridgeBinary.clear();
+            break;
+        }
+    }
+
+    if (! File(bridgeBinary.buffer()).existsAsFile())
+        bridgeBinary.clear();
+
+    return bridgeBinary;
+}
+#endif
+
+static void setPluginData(EnginePluginData& pluginData, CarlaPlugin* const plugin) noexcept
+{
+    pluginData.plugin      = plugin;
+    pluginData.insPeak[0]  = 0.0f;
+    pluginData.insPeak[1]  = 0.0f;
+    pluginData.outsPeak[0] = 0.0f;
+    pluginData.outsPeak[1] = 0.0f;
+    carla_fill<float>(pluginData.oscPeaks, -1.0f, 4);
+    pluginData.dspTimes.clear();
+}
+
+// -----------------------------------------------------------------------
+// Project file helpers
+
+// GIG and SF2 plugins using 16 outputs have this in their label
+static const char kUse16OutsSuffix[] = " (16 outs)";
+
+// add a plugin and restore its state, used when not loading in parallel
+static void addProjectPlugin(CarlaEngine* const engine, const CarlaStateSave& stateSave, const bool isPreset)
+{
+    const void* extraStuff = nullptr;
+
+    const BinaryType btype(getBinaryTypeFromFile(stateSave.binary));
+    const PluginType ptype(getPluginTypeFromString(stateSave.type));
+
+    if (CarlaString(stateSave.label).endsWith(kUse16OutsSuffix))
+    {
+        if (ptype == PLUGIN_GIG || ptype == PLUGIN_SF2)
+            extraStuff = "true";
+    }
+
+    // TODO - proper find&load plugins
+
+    if (engine->addPlugin(btype, ptype, stateSave.binary, stateSave.name, stateSave.label, stateSave.uniqueId, extraStuff, stateSave.options))
+    {
+        if (CarlaPlugin* const plugin = engine->getPlugin(engine->getCurrentPluginCount()-1))
+        {
+#ifndef BUILD_BRIDGE
+            // deactivate bridge client-side ping check, since some plugins block during load
+            if ((plugin->getHints() & PLUGIN_IS_BRIDGE) != 0 && ! isPreset)
+                plugin->setCustomData(CUSTOM_DATA_TYPE_STRING, "__CarlaPingOnOff__", "false", false);
+#endif
+            plugin->loadStateSave(stateSave);
+        }
+        else
+            carla_stderr2("Failed to get new plugin, state will not be restored correctly\n");
+    }
+    else
+        carla_stderr2("Failed to load a plugin, error was:\n%s", engine->getLastError());
+
+#ifdef BUILD_BRIDGE
+    (void)isPreset;
+#endif
+}
+
+#ifndef BUILD_BRIDGE
+// read the connections of a patchbay element, stored as source and target pairs
+static void readProjectConnections(CarlaXmlReader& reader, juce::StringArray& connections)
+{
+    std::string text;
+
+    for (; reader.nextChild();)
+    {
+        if (! reader.isName("connection"))
+        {
+            reader.skipElement();
+            continue;
+        }
+
+        String sourcePort, targetPort;
+
+        for (; reader.nextChild();)
+        {
+            if (! reader.readText(text))
+                break;
+
+            /**/ if (reader.isName("source"))
+                sourcePort = String(CharPointer_UTF8(text.c_str()));
+            else if (reader.isName("target"))
+                targetPort = String(CharPointer_UTF8(text.c_str()));
+        }
+
+        if (sourcePort.isNotEmpty() && targetPort.isNotEmpty())
+        {
+            connections.add(sourcePort);
+            connections.add(targetPort);
+        }
+    }
+}
+#endif
+
+#ifndef BUILD_BRIDGE
+// -----------------------------------------------------------------------
+// Project loading
+//
+// Bridged plugins of a project are created and get their state restored on loader threads, since most of that time
+// is spent waiting for the bridge processes. In-process plugins are still loaded in the main thread, as most plugin
+// APIs do not allow instantiation from several threads at once.
+// The main thread adds all plugins to the engine in project order, and activates them once all are loaded.
+
+struct ProjectPluginLoad {
+    CarlaStateSave stateSave;
+    BinaryType btype;
+    PluginType ptype;
+    const void* extra;
+    bool active; // restored with the plugin inactive, this is applied at the end
+
+    uint id; // temporary for background loads if a previous plugin failed
+    bool inBackground;
+    int  done;
+
+    CarlaPlugin* plugin;
+    CarlaString error;
+    double createTime, restoreTime; // in ms
+
+    ProjectPluginLoad() noexcept
+        : stateSave(),
+          btype(BINARY_NONE),
+          ptype(PLUGIN_NONE),
+          extra(nullptr),
+          active(false),
+          id(0),
+          inBackground(false),
+          done(0),
+          plugin(nullptr),
+          error(),
+          createTime(0.0),
+          restoreTime(0.0) {}
+
+    CARLA_DECLARE_NON_COPY_STRUCT(ProjectPluginLoad)
+};
+
+// job of the current loader thread, if any
+static __thread ProjectPluginLoad* sProjectLoaderJob = nullptr;
+
+class ProjectLoaderThread : public CarlaThread
+{
+public:
+    ProjectLoaderThread(CarlaEngine* const engine, ProjectPluginLoad* const* const jobs, const uint jobCount, uint& nextJob) noexcept
+        : CarlaThread("ProjectLoader"),
+          kEngine(engine),
+          kJobs(jobs),
+          kJobCount(jobCount),
+          fNextJob(nextJob) {}
+
+    // creates the plugin and restores its state, used for both background and main thread loads
+    static void loadPlugin(CarlaEngine* const engine, ProjectPluginLoad& job)
+    {
+        const double startTime(Time::getMillisecondCounterHiRes());
+
+        job.plugin = engine->createPlugin(job.id, job.btype, job.ptype, job.stateSave.binary, job.stateSave.name, job.stateSave.label,
+                                          job.stateSave.uniqueId, job.extra, job.stateSave.options);
+
+        job.createTime = Time::getMillisecondCounterHiRes() - startTime;
+
+        if (job.plugin == nullptr && ! job.inBackground)
+            job.error = engine->getLastError();
+    }
+
+    static void restoreState(ProjectPluginLoad& job)
+    {
+        CARLA_SAFE_ASSERT_RETURN(job.plugin != nullptr,);
+
+        const double startTime(Time::getMillisecondCounterHiRes());
+
+        // deactivate bridge client-side ping check, since some plugins block during load
+        if ((job.plugin->getHints() & PLUGIN_IS_BRIDGE) != 0)
+            job.plugin->setCustomData(CUSTOM_DATA_TYPE_STRING, "__CarlaPingOnOff__", "false", false);
+
+        job.plugin->loadStateSave(job.stateSave);
+
+        job.restoreTime = Time::getMillisecondCounterHiRes() - startTime;
+    }
+
+protected:
+    void run() override
+    {
+        for (; ! shouldThreadExit();)
+        {
+            const uint index(__atomic_fetch_add(&fNextJob, 1, __ATOMIC_ACQ_REL));
+
+            if (index >= kJobCount)
+                break;
+
+            ProjectPluginLoad* const job(kJobs[index]);
+
+            if (! job->inBackground)
+                continue;
+
+            sProjectLoaderJob = job;
+
+            try {
+                loadPlugin(kEngine, *job);
+
+                if (job->plugin != nullptr)
+                    restoreState(*job);
+            } CARLA_SAFE_EXCEPTION("ProjectLoaderThread");
+
+            sProjectLoaderJob = nullptr;
+
+            __atomic_store_n(&job->done, 1, __ATOMIC_RELEASE);
+        }
+    }
+
+private:
+    CarlaEngine* const kEngine;
+    ProjectPluginLoad* const* const kJobs;
+    const uint kJobCount;
+    uint& fNextJob;
+
+    CARLA_DECLARE_NON_COPY_CLASS(ProjectLoaderThread)
+};
+#endif
+
 // -----------------------------------------------------------------------
 // Carla Engine
 
@@ -81,6 +346,7 @@ uint CarlaEngine::getDriverCount()
 # else
     count += getRtAudioApiCount();
 # endif
+    count += 1;
 #endif
 
     return count;
@@ -111,6 +377,9 @@ const char* CarlaEngine::getDriverName(const uint index2)
         index -= count;
     }
 # endif
+
+    if (index-- == 0)
+        return "Offline";
 #endif
 
     carla_stderr("CarlaEngine::getDriverName(%i) - invalid index", index2);
@@ -145,6 +414,13 @@ const char* const* CarlaEngine::getDriverDeviceNames(const uint index2)
         index -= count;
     }
 # endif
+
+    if (index-- == 0)
+    {
+        // the device name is used as output file, anything but a wav file discards the output
+        static const char* ret[2] = { "Discard Output", nullptr };
+        return ret;
+    }
 #endif
 
     carla_stderr("CarlaEngine::getDriverDeviceNames(%i) - invalid index", index2);
@@ -183,6 +459,17 @@ const EngineDriverDeviceInfo* CarlaEngine::getDriverDeviceInfo(const uint index2
         index -= count;
     }
 # endif
+
+    if (index-- == 0)
+    {
+        static uint32_t bufSizes[11] = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 0 };
+        static double   sampleRates[7] = { 22050.0, 32000.0, 44100.0, 48000.0, 88200.0, 96000.0, 0.0 };
+        static EngineDriverDeviceInfo devInfo;
+        devInfo.hints       = 0x0;
+        devInfo.bufferSizes = bufSizes;
+        devInfo.sampleRates = sampleRates;
+        return &devInfo;
+    }
 #endif
 
     carla_stderr("CarlaEngine::getDriverDeviceNames(%i, \"%s\") - invalid index", index2, deviceName);
@@ -229,6 +516,12 @@ CarlaEngine* CarlaEngine::newDriverByName(const char* const driverName)
     if (std::strcmp(driverName, "PulseAudio") == 0)
         return newRtAudio(AUDIO_API_PULSE);
 # endif
+
+    // -------------------------------------------------------------------
+    // offline
+
+    if (std::strcmp(driverName, "Offline") == 0)
+        return newDummy();
 #endif
 
     carla_stderr("CarlaEngine::newDriverByName(\"%s\") - invalid driver name", driverName);
@@ -305,6 +598,11 @@ void CarlaEngine::idle() noexcept
         }
     }
 
+#ifndef BUILD_BRIDGE
+    if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
+        pData->graph.idle();
+#endif
+
 #ifdef HAVE_LIBLO
     pData->osc.idle();
 #endif
@@ -359,6 +657,62 @@ bool CarlaEngine::addPlugin(const BinaryType btype, const PluginType ptype,
         CARLA_SAFE_ASSERT_RETURN_ERR(pData->plugins[id].plugin == nullptr, "Invalid engine internal data");
     }
 
+    CarlaPlugin* const plugin(createPlugin(id, btype, ptype, filename, name, label, uniqueId, extra, options));
+
+    if (plugin == nullptr)
+        return false;
+
+#if defined(HAVE_LIBLO) && ! defined(BUILD_BRIDGE)
+    plugin->registerToOscClient();
+#endif
+
+    setPluginData(pData->plugins[id], plugin);
+
+#ifndef BUILD_BRIDGE
+    if (oldPlugin != nullptr)
+    {
+        const ScopedThreadStopper sts(this);
+
+        if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
+            pData->graph.replacePlugin(oldPlugin, plugin);
+
+        const bool  wasActive = oldPlugin->getInternalParameterValue(PARAMETER_ACTIVE) >= 0.5f;
+        const float oldDryWet = oldPlugin->getInternalParameterValue(PARAMETER_DRYWET);
+        const float oldVolume = oldPlugin->getInternalParameterValue(PARAMETER_VOLUME);
+
+        delete oldPlugin;
+
+        if (plugin->getHints() & PLUGIN_CAN_DRYWET)
+            plugin->setDryWet(oldDryWet, true, true);
+
+        if (plugin->getHints() & PLUGIN_CAN_VOLUME)
+            plugin->setVolume(oldVolume, true, true);
+
+        plugin->setActive(wasActive, true, true);
+
+        callback(ENGINE_CALLBACK_RELOAD_ALL, id, 0, 0, 0.0f, nullptr);
+    }
+    else
+#endif
+    {
+        plugin->setActive(true, true, false);
+
+        ++pData->curPluginCount;
+        callback(ENGINE_CALLBACK_PLUGIN_ADDED, id, 0, 0, 0.0f, plugin->getName());
+
+#ifndef BUILD_BRIDGE
+        if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
+            pData->graph.addPlugin(plugin);
+#endif
+    }
+
+    return true;
+}
+
+CarlaPlugin* CarlaEngine::createPlugin(const uint id, const BinaryType btype, const PluginType ptype,
+                                       const char* const filename, const char* const name, const char* const label, const int64_t uniqueId,
+                                       const void* const extra, const uint options)
+{
     CarlaPlugin::Initializer initializer = {
         this,
         id,
@@ -372,43 +726,7 @@ bool CarlaEngine::addPlugin(const BinaryType btype, const PluginType ptype,
     CarlaPlugin* plugin = nullptr;
 
 #ifndef BRIDGE_PLUGIN
-    CarlaString bridgeBinary(pData->options.binaryDir);
-
-    if (bridgeBinary.isNotEmpty())
-    {
-        if (btype == BINARY_NATIVE)
-        {
-#ifdef CARLA_OS_WIN
-            bridgeBinary += CARLA_OS_SEP_STR "carla-bridge-native.exe";
-#else
-            bridgeBinary += CARLA_OS_SEP_STR "carla-bridge-native";
-#endif
-        }
-        else
-        {
-            switch (btype)
-            {
-            case BINARY_POSIX32:
-                bridgeBinary += CARLA_OS_SEP_STR "carla-bridge-posix32";
-                break;
-            case BINARY_POSIX64:
-                bridgeBinary += CARLA_OS_SEP_STR "carla-bridge-posix64";
-                break;
-            case BINARY_WIN32:
-                bridgeBinary += CARLA_OS_SEP_STR "carla-bridge-win32.exe";
-                break;
-            case BINARY_WIN64:
-                bridgeBinary += CARLA_OS_SEP_STR "carla-bridge-win64.exe";
-                break;
-            default:
-                bridgeBinary.clear();
-                break;
-            }
-        }
-
-        if (! File(bridgeBinary.buffer()).existsAsFile())
-            bridgeBinary.clear();
-    }
+    const CarlaString bridgeBinary(getBridgeBinary(pData->options.binaryDir, btype));
 
     if (ptype != PLUGIN_INTERNAL && (btype != BINARY_NATIVE || (pData->options.preferPluginBridges && bridgeBinary.isNotEmpty())))
     {
@@ -444,7 +762,7 @@ bool CarlaEngine::addPlugin(const BinaryType btype, const PluginType ptype,
         else
         {
             setLastError("This Carla build cannot handle this binary");
-            return false;
+            return nullptr;
         }
     }
     else
@@ -523,7 +841,7 @@ bool CarlaEngine::addPlugin(const BinaryType btype, const PluginType ptype,
     }
 
     if (plugin == nullptr)
-        return false;
+        return nullptr;
 
     plugin->reload();
 
@@ -559,59 +877,10 @@ bool CarlaEngine::addPlugin(const BinaryType btype, const PluginType ptype,
     if (! canRun)
     {
         delete plugin;
-        return false;
-    }
-
-#if defined(HAVE_LIBLO) && ! defined(BUILD_BRIDGE)
-    plugin->registerToOscClient();
-#endif
-
-    EnginePluginData& pluginData(pData->plugins[id]);
-    pluginData.plugin      = plugin;
-    pluginData.insPeak[0]  = 0.0f;
-    pluginData.insPeak[1]  = 0.0f;
-    pluginData.outsPeak[0] = 0.0f;
-    pluginData.outsPeak[1] = 0.0f;
-
-#ifndef BUILD_BRIDGE
-    if (oldPlugin != nullptr)
-    {
-        const ScopedThreadStopper sts(this);
-
-        if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
-            pData->graph.replacePlugin(oldPlugin, plugin);
-
-        const bool  wasActive = oldPlugin->getInternalParameterValue(PARAMETER_ACTIVE) >= 0.5f;
-        const float oldDryWet = oldPlugin->getInternalParameterValue(PARAMETER_DRYWET);
-        const float oldVolume = oldPlugin->getInternalParameterValue(PARAMETER_VOLUME);
-
-        delete oldPlugin;
-
-        if (plugin->getHints() & PLUGIN_CAN_DRYWET)
-            plugin->setDryWet(oldDryWet, true, true);
-
-        if (plugin->getHints() & PLUGIN_CAN_VOLUME)
-            plugin->setVolume(oldVolume, true, true);
-
-        plugin->setActive(wasActive, true, true);
-
-        callback(ENGINE_CALLBACK_RELOAD_ALL, id, 0, 0, 0.0f, nullptr);
-    }
-    else
-#endif
-    {
-        plugin->setActive(true, true, false);
-
-        ++pData->curPluginCount;
-        callback(ENGINE_CALLBACK_PLUGIN_ADDED, id, 0, 0, 0.0f, plugin->getName());
-
-#ifndef BUILD_BRIDGE
-        if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
-            pData->graph.addPlugin(plugin);
-#endif
+        return nullptr;
     }
 
-    return true;
+    return plugin;
 }
 
 bool CarlaEngine::addPlugin(const PluginType ptype, const char* const filename, const char* const name, const char* const label, const int64_t uniqueId, const void* const extra)
@@ -713,6 +982,8 @@ bool CarlaEngine::removeAllPlugins()
         pluginData.insPeak[1]  = 0.0f;
         pluginData.outsPeak[0] = 0.0f;
         pluginData.outsPeak[1] = 0.0f;
+        carla_fill<float>(pluginData.oscPeaks, -1.0f, 4);
+        pluginData.dspTimes.clear();
 
         callback(ENGINE_CALLBACK_IDLE, 0, 0, 0, 0.0f, nullptr);
     }
@@ -865,6 +1136,54 @@ CarlaPlugin* CarlaEngine::getPluginUnchecked(const uint id) const noexcept
     return pData->plugins[id].plugin;
 }
 
+// Add or increment the " (N)" suffix of a plugin name that is already taken
+static void bumpPluginName(CarlaString& sname)
+{
+    // Check if string has already been modified
+    const std::size_t len(sname.length());
+
+    // 1 digit, ex: " (2)"
+    if (sname[len-4] == ' ' && sname[len-3] == '(' && sname.isDigit(len-2) && sname[len-1] == ')')
+    {
+        const int number = sname[len-2] - '0';
+
+        if (number == 9)
+        {
+            // next number is 10, 2 digits
+            sname.truncate(len-4);
+            sname += " (10)";
+            //sname.replace(" (9)", " (10)");
+        }
+        else
+            sname[len-2] = char('0' + number + 1);
+
+        return;
+    }
+
+    // 2 digits, ex: " (11)"
+    if (sname[len-5] == ' ' && sname[len-4] == '(' && sname.isDigit(len-3) && sname.isDigit(len-2) && sname[len-1] == ')')
+    {
+        char n2 = sname[len-2];
+        char n3 = sname[len-3];
+
+        if (n2 == '9')
+        {
+            n2 = '0';
+            n3 = static_cast<char>(n3 + 1);
+        }
+        else
+            n2 = static_cast<char>(n2 + 1);
+
+        sname[len-2] = n2;
+        sname[len-3] = n3;
+
+        return;
+    }
+
+    // Modify string if not
+    sname += " (2)";
+}
+
 const char* CarlaEngine::getUniquePluginName(const char* const name) const
 {
     CARLA_SAFE_ASSERT_RETURN(pData->nextAction.opcode == kEnginePostActionNull, nullptr);
@@ -888,62 +1207,43 @@ const char* CarlaEngine::getUniquePluginName(const char* const name) const
     sname.truncate(maxNameSize);
     sname.replace(':', '.'); // ':' is used in JACK1 to split client/port names
 
-    for (uint i=0; i < pData->curPluginCount; ++i)
-    {
-        CARLA_SAFE_ASSERT_BREAK(pData->plugins[i].plugin != nullptr);
+#ifndef BUILD_BRIDGE
+    // loader threads use names reserved on the main thread, see loadProjectInternal()
+    if (sProjectLoaderJob != nullptr)
+        return sname.dup();
+#endif
 
-        // Check if unique name doesn't exist
-        if (const char* const pluginName = pData->plugins[i].plugin->getName())
-        {
-            if (sname != pluginName)
-                continue;
-        }
+    // a bumped name is checked against every other name again
+    for (bool taken = true; taken;)
+    {
+        taken = false;
 
-        // Check if string has already been modified
+        for (uint i=0; i < pData->curPluginCount; ++i)
         {
-            const std::size_t len(sname.length());
+            CARLA_SAFE_ASSERT_BREAK(pData->plugins[i].plugin != nullptr);
 
-            // 1 digit, ex: " (2)"
-            if (sname[len-4] == ' ' && sname[len-3] == '(' && sname.isDigit(len-2) && sname[len-1] == ')')
+            // Check if unique name doesn't exist
+            if (const char* const pluginName = pData->plugins[i].plugin->getName())
             {
-                const int number = sname[len-2] - '0';
-
-                if (number == 9)
-                {
-                    // next number is 10, 2 digits
-                    sname.truncate(len-4);
-                    sname += " (10)";
-                    //sname.replace(" (9)", " (10)");
-                }
-                else
-                    sname[len-2] = char('0' + number + 1);
-
-                continue;
+                if (sname != pluginName)
+                    continue;
             }
 
-            // 2 digits, ex: " (11)"
-            if (sname[len-5] == ' ' && sname[len-4] == '(' && sname.isDigit(len-3) && sname.isDigit(len-2) && sname[len-1] == ')')
-            {
-                char n2 = sname[len-2];
-                char n3 = sname[len-3];
-
-                if (n2 == '9')
-                {
-                    n2 = '0';
-                    n3 = static_cast<char>(n3 + 1);
-                }
-                else
-                    n2 = static_cast<char>(n2 + 1);
-
-                sname[len-2] = n2;
-                sname[len-3] = n3;
+            taken = true;
+            break;
+        }
 
-                continue;
-            }
+#ifndef BUILD_BRIDGE
+        // names kept for plugins of a project that are not added yet
+        for (LinkedList<const char*>::Itenerator it = pData->reservedPluginNames.begin2(); ! taken && it.valid(); it.next())
+        {
+            if (sname == it.getValue(nullptr))
+                taken = true;
         }
+#endif
 
-        // Modify string if not
-        sname += " (2)";
+        if (taken)
+            bumpPluginName(sname);
     }
 
     return sname.dup();
@@ -1056,8 +1356,10 @@ bool CarlaEngine::loadProject(const char* const filename)
     File file(jfilename);
     CARLA_SAFE_ASSERT_RETURN_ERR(file.existsAsFile(), "Requested file does not exist or is not a readable file");
 
-    XmlDocument xml(file);
-    return loadProjectInternal(xml);
+    MemoryMappedFile mappedFile(file, MemoryMappedFile::readOnly);
+    CARLA_SAFE_ASSERT_RETURN_ERR(mappedFile.getData() != nullptr, "Failed to open project file");
+
+    return loadProjectInternal(static_cast<const char*>(mappedFile.getData()), mappedFile.getSize(), filename);
 }
 
 bool CarlaEngine::saveProject(const char* const filename)
@@ -1065,17 +1367,53 @@ bool CarlaEngine::saveProject(const char* const filename)
     CARLA_SAFE_ASSERT_RETURN_ERR(filename != nullptr && filename[0] != '\0', "Invalid filename");
     carla_debug("CarlaEngine::saveProject(\"%s\")", filename);
 
-    MemoryOutputStream out;
-    saveProjectInternal(out);
-
     const String jfilename = String(CharPointer_UTF8(filename));
     File file(jfilename);
 
-    if (file.replaceWithData(out.getData(), out.getDataSize()))
-        return true;
+    // big data goes into the sidecar file, if enabled
+    ScopedPointer<CarlaStateSidecarWriter> sidecar;
 
-    setLastError("Failed to write file");
-    return false;
+    if (pData->options.sidecarMinSize > 0)
+        sidecar = new CarlaStateSidecarWriter(file, pData->options.sidecarMinSize);
+
+    TemporaryFile tempFile(file);
+    ScopedPointer<FileOutputStream> out(tempFile.getFile().createOutputStream());
+    CARLA_SAFE_ASSERT_RETURN_ERR(out != nullptr && ! out->failedToOpen(), "Failed to write file");
+
+    saveProjectInternal(*out, sidecar);
+    out->flush();
+
+    const bool failed(out->getStatus().failed());
+    out = nullptr;
+
+    if (failed)
+    {
+        setLastError("Failed to write file");
+        return false;
+    }
+
+    if (sidecar != nullptr && sidecar->isEmpty())
+        sidecar = nullptr;
+
+    // the new sidecar has its own name, the previous project stays valid until replaced below
+    if (sidecar != nullptr && ! sidecar->finish())
+    {
+        setLastError("Failed to write project data file");
+        return false;
+    }
+
+    if (! tempFile.overwriteTargetFileWithTemporary())
+    {
+        if (sidecar != nullptr)
+            sidecar->discard();
+
+        setLastError("Failed to write file");
+        return false;
+    }
+
+    // only now old data can go
+    removeOldStateSidecarFiles(file, sidecar != nullptr ? sidecar->getFile() : File());
+    return true;
 }
 
 // -----------------------------------------------------------------------
@@ -1133,6 +1471,27 @@ float CarlaEngine::getOutputPeak(const uint pluginId, const bool isLeft) const n
     return pData->plugins[pluginId].outsPeak[isLeft ? 0 : 1];
 }
 
+void CarlaEngine::getPluginDspStats(const uint pluginId, EnginePluginDspStats& stats) const noexcept
+{
+    stats.clear();
+
+    CARLA_SAFE_ASSERT_RETURN(pluginId < pData->curPluginCount,);
+    CARLA_SAFE_ASSERT_RETURN(pData->sampleRate > 0.0,);
+
+    const double bufferTime(double(pData->bufferSize) / pData->sampleRate * 1000000.0);
+
+    pData->plugins[pluginId].dspTimes.getStats(stats, bufferTime);
+}
+
+void CarlaEngine::getPluginWorkerStats(const uint pluginId, EngineWorkerStats& stats) const noexcept
+{
+    stats.clear();
+
+    CARLA_SAFE_ASSERT_RETURN(pluginId < pData->curPluginCount,);
+
+    pData->workers.getStats(pData->plugins[pluginId].plugin, stats);
+}
+
 // -----------------------------------------------------------------------
 // Callback
 
@@ -1143,6 +1502,12 @@ void CarlaEngine::callback(const EngineCallbackOpcode action, const uint pluginI
         carla_debug("CarlaEngine::callback(%i:%s, %i, %i, %i, %f, \"%s\")", action, EngineCallbackOpcode2Str(action), pluginId, value1, value2, value3, valueStr);
 #endif
 
+#ifndef BUILD_BRIDGE
+    // the frontend gets the plugin data once it is added
+    if (sProjectLoaderJob != nullptr)
+        return;
+#endif
+
 #ifdef BUILD_BRIDGE
     if (pData->isIdling)
 #else
@@ -1231,6 +1596,14 @@ const char* CarlaEngine::getLastError() const noexcept
 
 void CarlaEngine::setLastError(const char* const error) const noexcept
 {
+#ifndef BUILD_BRIDGE
+    if (sProjectLoaderJob != nullptr)
+    {
+        sProjectLoaderJob->error = error;
+        return;
+    }
+#endif
+
     pData->lastError = error;
 }
 
@@ -1241,6 +1614,15 @@ void CarlaEngine::setAboutToClose() noexcept
     pData->aboutToClose = true;
 }
 
+bool CarlaEngine::isProjectLoaderThread() const noexcept
+{
+#ifndef BUILD_BRIDGE
+    return (sProjectLoaderJob != nullptr);
+#else
+    return false;
+#endif
+}
+
 // -----------------------------------------------------------------------
 // Global options
 
@@ -1248,7 +1630,7 @@ void CarlaEngine::setOption(const EngineOption option, const int value, const ch
 {
     carla_debug("CarlaEngine::setOption(%i:%s, %i, \"%s\")", option, EngineOption2Str(option), value, valueStr);
 
-    if (isRunning() && (option == ENGINE_OPTION_PROCESS_MODE || option == ENGINE_OPTION_AUDIO_NUM_PERIODS || option == ENGINE_OPTION_AUDIO_DEVICE))
+    if (isRunning() && (option == ENGINE_OPTION_PROCESS_MODE || option == ENGINE_OPTION_AUDIO_NUM_PERIODS || option == ENGINE_OPTION_AUDIO_DEVICE || option == ENGINE_OPTION_PROCESS_WORKERS || option == ENGINE_OPTION_RACK_PIPELINE_STAGES))
         return carla_stderr("CarlaEngine::setOption(%i:%s, %i, \"%s\") - Cannot set this option while engine is running!", option, EngineOption2Str(option), value, valueStr);
 
     // do not un-force stereo for rack mode
@@ -1437,6 +1819,51 @@ void CarlaEngine::setOption(const EngineOption option, const int value, const ch
 #endif
         break;
 
+    case ENGINE_OPTION_PROCESS_WORKERS:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        pData->options.processWorkers = static_cast<uint>(value);
+        break;
+
+    case ENGINE_OPTION_RACK_PIPELINE_STAGES:
+        CARLA_SAFE_ASSERT_RETURN(value >= 1,);
+        pData->options.rackPipelineStages = static_cast<uint>(value);
+        break;
+
+    case ENGINE_OPTION_PLUGIN_BRIDGES_SPIN_TIME:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        pData->options.bridgesSpinTime = static_cast<uint>(value);
+        break;
+
+    case ENGINE_OPTION_PLUGIN_BRIDGES_GROUP_SIZE:
+        CARLA_SAFE_ASSERT_RETURN(value >= 1,);
+        pData->options.bridgesGroupSize = static_cast<uint>(value);
+        break;
+
+    case ENGINE_OPTION_BATCH_PARAMETER_CHANGES:
+        CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
+        pData->options.batchParameterChanges = (value != 0);
+        break;
+
+    case ENGINE_OPTION_PROJECT_LOAD_THREADS:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        pData->options.projectLoadThreads = static_cast<uint>(value);
+        break;
+
+    case ENGINE_OPTION_PROJECT_SIDECAR_MIN_SIZE:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        pData->options.sidecarMinSize = static_cast<uint>(value);
+        break;
+
+    case ENGINE_OPTION_PLUGIN_BRIDGES_DEADLINE:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        pData->options.bridgesDeadline = static_cast<uint>(value);
+        break;
+
+    case ENGINE_OPTION_OFFLINE_RENDER_FRAMES:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        pData->options.offlineRenderFrames = static_cast<uint>(value);
+        break;
+
     case ENGINE_OPTION_FRONTEND_WIN_ID:
         CARLA_SAFE_ASSERT_RETURN(valueStr != nullptr && valueStr[0] != '\0',);
         const long long winId(std::strtoll(valueStr, nullptr, 16));
@@ -1453,6 +1880,10 @@ void CarlaEngine::setOption(const EngineOption option, const int value, const ch
 # ifndef BUILD_BRIDGE
 bool CarlaEngine::isOscControlRegistered() const noexcept
 {
+    // plugins loading in the background are not known to the OSC client yet
+    if (sProjectLoaderJob != nullptr)
+        return false;
+
     return pData->osc.isControlRegistered();
 }
 # endif
@@ -1478,9 +1909,19 @@ const char* CarlaEngine::getOscServerPathUDP() const noexcept
 
 EngineEvent* CarlaEngine::getInternalEventBuffer(const bool isInput) const noexcept
 {
+#ifndef BUILD_BRIDGE
+    if (EngineInternalEvents::stageIn != nullptr)
+        return isInput ? EngineInternalEvents::stageIn : EngineInternalEvents::stageOut;
+#endif
+
     return isInput ? pData->events.in : pData->events.out;
 }
 
+const uint8_t* CarlaEngine::copyInternalEventData(const uint8_t* const data, const uint16_t size) const noexcept
+{
+    return pData->events.dataExt.copy(data, size);
+}
+
 // -----------------------------------------------------------------------
 // Internal stuff
 
@@ -1561,7 +2002,16 @@ void CarlaEngine::setPluginPeaks(const uint pluginId, float const inPeaks[2], fl
     pluginData.outsPeak[1] = outPeaks[1];
 }
 
-void CarlaEngine::saveProjectInternal(juce::MemoryOutputStream& outStream) const
+void CarlaEngine::addPluginDspTime(const uint pluginId, const int64_t startTicks, const uint shareCount) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(shareCount > 0,);
+
+    const int64_t ticks(Time::getHighResolutionTicks() - startTicks);
+
+    pData->plugins[pluginId].dspTimes.add(static_cast<float>(Time::highResolutionTicksToSeconds(ticks) * 1000000.0 / shareCount));
+}
+
+void CarlaEngine::saveProjectInternal(juce::OutputStream& outStream, CarlaStateSidecarWriter* const sidecar) const
 {
     // send initial prepareForSave first, giving time for bridges to act
     for (uint i=0; i < pData->curPluginCount; ++i)
@@ -1586,36 +2036,33 @@ void CarlaEngine::saveProjectInternal(juce::MemoryOutputStream& outStream) const
     const bool isPlugin(std::strcmp(getCurrentDriverName(), "Plugin") == 0);
     const EngineOptions& options(pData->options);
 
-    MemoryOutputStream outSettings(1024);
-
     // save appropriate engine settings
-    outSettings << " <EngineSettings>\n";
+    outStream << " <EngineSettings>\n";
 
     //processMode
     //transportMode
 
-    outSettings << "  <ForceStereo>"         << bool2str(options.forceStereo)         << "</ForceStereo>\n";
-    outSettings << "  <PreferPluginBridges>" << bool2str(options.preferPluginBridges) << "</PreferPluginBridges>\n";
-    outSettings << "  <PreferUiBridges>"     << bool2str(options.preferUiBridges)     << "</PreferUiBridges>\n";
-    outSettings << "  <UIsAlwaysOnTop>"      << bool2str(options.uisAlwaysOnTop)      << "</UIsAlwaysOnTop>\n";
+    outStream << "  <ForceStereo>"         << bool2str(options.forceStereo)         << "</ForceStereo>\n";
+    outStream << "  <PreferPluginBridges>" << bool2str(options.preferPluginBridges) << "</PreferPluginBridges>\n";
+    outStream << "  <PreferUiBridges>"     << bool2str(options.preferUiBridges)     << "</PreferUiBridges>\n";
+    outStream << "  <UIsAlwaysOnTop>"      << bool2str(options.uisAlwaysOnTop)      << "</UIsAlwaysOnTop>\n";
 
-    outSettings << "  <MaxParameters>"       << String(options.maxParameters)    << "</MaxParameters>\n";
-    outSettings << "  <UIBridgesTimeout>"    << String(options.uiBridgesTimeout) << "</UIBridgesTimeout>\n";
+    outStream << "  <MaxParameters>"       << String(options.maxParameters)    << "</MaxParameters>\n";
+    outStream << "  <UIBridgesTimeout>"    << String(options.uiBridgesTimeout) << "</UIBridgesTimeout>\n";
 
     if (isPlugin)
     {
-        outSettings << "  <LADSPA_PATH>" << xmlSafeString(options.pathLADSPA, true) << "</LADSPA_PATH>\n";
-        outSettings << "  <DSSI_PATH>"   << xmlSafeString(options.pathDSSI,   true) << "</DSSI_PATH>\n";
-        outSettings << "  <LV2_PATH>"    << xmlSafeString(options.pathLV2,    true) << "</LV2_PATH>\n";
-        outSettings << "  <VST2_PATH>"   << xmlSafeString(options.pathVST2,   true) << "</VST2_PATH>\n";
-        outSettings << "  <VST3_PATH>"   << xmlSafeString(options.pathVST3,   true) << "</VST3_PATH>\n";
-        outSettings << "  <GIG_PATH>"    << xmlSafeString(options.pathGIG,    true) << "</GIG_PATH>\n";
-        outSettings << "  <SF2_PATH>"    << xmlSafeString(options.pathSF2,    true) << "</SF2_PATH>\n";
-        outSettings << "  <SFZ_PATH>"    << xmlSafeString(options.pathSFZ,    true) << "</SFZ_PATH>\n";
+        carla_xmlWriteTag(outStream, "  ", "LADSPA_PATH", options.pathLADSPA);
+        carla_xmlWriteTag(outStream, "  ", "DSSI_PATH", options.pathDSSI);
+        carla_xmlWriteTag(outStream, "  ", "LV2_PATH", options.pathLV2);
+        carla_xmlWriteTag(outStream, "  ", "VST2_PATH", options.pathVST2);
+        carla_xmlWriteTag(outStream, "  ", "VST3_PATH", options.pathVST3);
+        carla_xmlWriteTag(outStream, "  ", "GIG_PATH", options.pathGIG);
+        carla_xmlWriteTag(outStream, "  ", "SF2_PATH", options.pathSF2);
+        carla_xmlWriteTag(outStream, "  ", "SFZ_PATH", options.pathSFZ);
     }
 
-    outSettings << " </EngineSettings>\n";
-    outStream << outSettings;
+    outStream << " </EngineSettings>\n";
 
     char strBuf[STR_MAX+1];
 
@@ -1625,21 +2072,21 @@ void CarlaEngine::saveProjectInternal(juce::MemoryOutputStream& outStream) const
 
         if (plugin != nullptr && plugin->isEnabled())
         {
-            MemoryOutputStream outPlugin(4096), streamPlugin;
-            plugin->getStateSave(false).dumpToMemoryStream(streamPlugin);
-
-            outPlugin << "\n";
+            outStream << "\n";
 
             strBuf[0] = '\0';
             plugin->getRealName(strBuf);
 
             if (strBuf[0] != '\0')
-                outPlugin << " <!-- " << xmlSafeString(strBuf, true) << " -->\n";
+            {
+                outStream << " <!-- ";
+                carla_xmlWriteEscaped(outStream, strBuf);
+                outStream << " -->\n";
+            }
 
-            outPlugin << " <Plugin>\n";
-            outPlugin << streamPlugin;
-            outPlugin << " </Plugin>\n";
-            outStream << outPlugin;
+            outStream << " <Plugin>\n";
+            plugin->getStateSave(false).dumpToStream(outStream, sidecar);
+            outStream << " </Plugin>\n";
         }
     }
 
@@ -1658,9 +2105,7 @@ void CarlaEngine::saveProjectInternal(juce::MemoryOutputStream& outStream) const
     {
         if (const char* const* const patchbayConns = getPatchbayConnections(false))
         {
-            MemoryOutputStream outPatchbay(2048);
-
-            outPatchbay << "\n <Patchbay>\n";
+            outStream << "\n <Patchbay>\n";
 
             for (int i=0; patchbayConns[i] != nullptr && patchbayConns[i+1] != nullptr; ++i, ++i )
             {
@@ -1670,14 +2115,13 @@ void CarlaEngine::saveProjectInternal(juce::MemoryOutputStream& outStream) const
                 CARLA_SAFE_ASSERT_CONTINUE(connSource != nullptr && connSource[0] != '\0');
                 CARLA_SAFE_ASSERT_CONTINUE(connTarget != nullptr && connTarget[0] != '\0');
 
-                outPatchbay << "  <Connection>\n";
-                outPatchbay << "   <Source>" << xmlSafeString(connSource, true) << "</Source>\n";
-                outPatchbay << "   <Target>" << xmlSafeString(connTarget, true) << "</Target>\n";
-                outPatchbay << "  </Connection>\n";
+                outStream << "  <Connection>\n";
+                carla_xmlWriteTag(outStream, "   ", "Source", connSource);
+                carla_xmlWriteTag(outStream, "   ", "Target", connTarget);
+                outStream << "  </Connection>\n";
             }
 
-            outPatchbay << " </Patchbay>\n";
-            outStream << outPatchbay;
+            outStream << " </Patchbay>\n";
         }
     }
 
@@ -1701,9 +2145,7 @@ void CarlaEngine::saveProjectInternal(juce::MemoryOutputStream& outStream) const
     {
         if (const char* const* const patchbayConns = getPatchbayConnections(true))
         {
-            MemoryOutputStream outPatchbay(2048);
-
-            outPatchbay << "\n <ExternalPatchbay>\n";
+            outStream << "\n <ExternalPatchbay>\n";
 
             for (int i=0; patchbayConns[i] != nullptr && patchbayConns[i+1] != nullptr; ++i, ++i )
             {
@@ -1713,202 +2155,464 @@ void CarlaEngine::saveProjectInternal(juce::MemoryOutputStream& outStream) const
                 CARLA_SAFE_ASSERT_CONTINUE(connSource != nullptr && connSource[0] != '\0');
                 CARLA_SAFE_ASSERT_CONTINUE(connTarget != nullptr && connTarget[0] != '\0');
 
-                outPatchbay << "  <Connection>\n";
-                outPatchbay << "   <Source>" << xmlSafeString(connSource, true) << "</Source>\n";
-                outPatchbay << "   <Target>" << xmlSafeString(connTarget, true) << "</Target>\n";
-                outPatchbay << "  </Connection>\n";
+                outStream << "  <Connection>\n";
+                carla_xmlWriteTag(outStream, "   ", "Source", connSource);
+                carla_xmlWriteTag(outStream, "   ", "Target", connTarget);
+                outStream << "  </Connection>\n";
             }
 
-            outPatchbay << " </ExternalPatchbay>\n";
-            outStream << outPatchbay;
+            outStream << " </ExternalPatchbay>\n";
         }
     }
 #endif
 
+    // the data file must match this save, checked before loading anything
+    if (sidecar != nullptr && ! sidecar->isEmpty())
+    {
+        outStream << "\n";
+        outStream << " <DataFile>\n";
+        carla_xmlWriteTag(outStream, "  ", "Name", sidecar->getFile().getFileName().toRawUTF8());
+        carla_xmlWriteTag(outStream, "  ", "Id",   sidecar->getId().toRawUTF8());
+        outStream << " </DataFile>\n";
+    }
+
     outStream << "</CARLA-PROJECT>\n";
 }
 
-bool CarlaEngine::loadProjectInternal(juce::XmlDocument& xmlDoc)
+bool CarlaEngine::loadProjectInternal(const char* const xmlData, const std::size_t xmlSize, const char* const projectFilename)
 {
-    ScopedPointer<XmlElement> xmlElement(xmlDoc.getDocumentElement(true));
-    CARLA_SAFE_ASSERT_RETURN_ERR(xmlElement != nullptr, "Failed to parse project file");
+    CARLA_SAFE_ASSERT_RETURN_ERR(xmlData != nullptr && xmlSize > 0, "Invalid project data");
+
+    CarlaXmlReader reader(xmlData, xmlSize);
+    CARLA_SAFE_ASSERT_RETURN_ERR(reader.nextChild(), "Failed to parse project file");
 
-    const String& xmlType(xmlElement->getTagName());
-    const bool isPreset(xmlType.equalsIgnoreCase("carla-preset"));
+    const bool isPreset(reader.isName("carla-preset"));
 
-    if (! (xmlType.equalsIgnoreCase("carla-project") || isPreset))
+    if (! (reader.isName("carla-project") || isPreset))
     {
         setLastError("Not a valid Carla project or preset file");
         return false;
     }
 
-    // completely load file
-    xmlElement = xmlDoc.getDocumentElement(false);
-    CARLA_SAFE_ASSERT_RETURN_ERR(xmlElement != nullptr, "Failed to completely parse project file");
+    // check the whole file first, plugins are loaded while reading.
+    // this also finds the sidecar file, where chunks and big custom data might be stored
+    String sidecarName, sidecarId;
 
-    const bool isPlugin(std::strcmp(getCurrentDriverName(), "Plugin") == 0);
+    {
+        CarlaXmlReader check(xmlData, xmlSize);
+        check.nextChild();
+
+        std::string xmlText;
+
+        for (; check.nextChild();)
+        {
+            if (isPreset || ! check.isName("datafile"))
+            {
+                check.skipElement();
+                continue;
+            }
+
+            for (; check.nextChild();)
+            {
+                if (! check.readText(xmlText))
+                    break;
+
+                /**/ if (check.isName("name"))
+                    sidecarName = String(CharPointer_UTF8(xmlText.c_str()));
+                else if (check.isName("id"))
+                    sidecarId = String(CharPointer_UTF8(xmlText.c_str()));
+            }
+        }
+
+        if (check.hasError())
+        {
+            carla_stderr2("Project file is malformed near line %u", check.getLine());
+            setLastError("Failed to parse project file");
+            return false;
+        }
+    }
+
+    ScopedPointer<CarlaStateSidecarReader> sidecar;
+
+    if (sidecarName.isNotEmpty())
+    {
+        // must be next to the project
+        if (projectFilename == nullptr || projectFilename[0] == '\0' ||
+            sidecarName.containsAnyOf("/\\") || ! sidecarName.endsWith(".data"))
+        {
+            setLastError("Project data file is missing or does not match the project");
+            return false;
+        }
 
-    // engine settings
-    for (XmlElement* elem = xmlElement->getFirstChildElement(); elem != nullptr; elem = elem->getNextElement())
+        const String jfilename = String(CharPointer_UTF8(projectFilename));
+        const File projectFile(jfilename);
+
+        sidecar = new CarlaStateSidecarReader(projectFile.getSiblingFile(sidecarName), sidecarId);
+
+        if (! sidecar->isValid())
+        {
+            setLastError("Project data file is missing or does not match the project");
+            return false;
+        }
+    }
+
+    if (isPreset)
     {
-        const String& tagName(elem->getTagName());
+        CarlaStateSave stateSave;
 
-        if (! tagName.equalsIgnoreCase("enginesettings"))
-            continue;
+        if (! stateSave.fillFromXmlReader(reader))
+        {
+            setLastError("Failed to parse preset file");
+            return false;
+        }
+
+        addProjectPlugin(this, stateSave, true);
+        return true;
+    }
 
-        for (XmlElement* settElem = elem->getFirstChildElement(); settElem != nullptr; settElem = settElem->getNextElement())
+    const bool isPlugin(std::strcmp(getCurrentDriverName(), "Plugin") == 0);
+
+#ifndef BUILD_BRIDGE
+    const bool loadInParallel(pData->options.projectLoadThreads > 0);
+
+    juce::OwnedArray<ProjectPluginLoad> jobs;
+    juce::StringArray internalConnections, externalConnections;
+#endif
+
+    // single pass through the file, plugins are loaded as soon as they are read unless using loader threads
+    std::string xmlText;
+    bool stateFailed = false;
+
+    for (; reader.nextChild();)
+    {
+        // engine settings
+        if (reader.isName("enginesettings"))
         {
-            const String& tag(settElem->getTagName());
-            const String  text(settElem->getAllSubText().trim());
+            for (; reader.nextChild();)
+            {
+                if (! reader.readText(xmlText))
+                    break;
+
+                const String text(CharPointer_UTF8(xmlText.c_str()));
 
-           /** some settings might be incorrect or require extra work,
-               so we call setOption rather than modifying them direly */
+               /** some settings might be incorrect or require extra work,
+                   so we call setOption rather than modifying them direly */
 
            int option = -1;
            int value  = 0;
            const char* valueStr = nullptr;
 
-            /**/ if (tag.equalsIgnoreCase("forcestereo"))
-            {
-                option = ENGINE_OPTION_FORCE_STEREO;
-                value  = text.equalsIgnoreCase("true") ? 1 : 0;
-            }
-            else if (tag.equalsIgnoreCase("preferpluginbridges"))
-            {
-                option = ENGINE_OPTION_PREFER_PLUGIN_BRIDGES;
-                value  = text.equalsIgnoreCase("true") ? 1 : 0;
-            }
-            else if (tag.equalsIgnoreCase("preferuibridges"))
-            {
-                option = ENGINE_OPTION_PREFER_UI_BRIDGES;
-                value  = text.equalsIgnoreCase("true") ? 1 : 0;
-            }
-            else if (tag.equalsIgnoreCase("uisalwaysontop"))
-            {
-                option = ENGINE_OPTION_UIS_ALWAYS_ON_TOP;
-                value  = text.equalsIgnoreCase("true") ? 1 : 0;
-            }
-            else if (tag.equalsIgnoreCase("maxparameters"))
-            {
-                option = ENGINE_OPTION_MAX_PARAMETERS;
-                value  = text.getIntValue();
-            }
-            else if (tag.equalsIgnoreCase("uibridgestimeout"))
-            {
-                option = ENGINE_OPTION_UI_BRIDGES_TIMEOUT;
-                value  = text.getIntValue();
-            }
-            else if (isPlugin)
-            {
-                /**/ if (tag.equalsIgnoreCase("LADSPA_PATH"))
+                    /**/ if (reader.isName("forcestereo"))
                 {
-                    option   = ENGINE_OPTION_PLUGIN_PATH;
-                    value    = PLUGIN_LADSPA;
-                    valueStr = text.toRawUTF8();
+                    option = ENGINE_OPTION_FORCE_STEREO;
+                    value  = text.equalsIgnoreCase("true") ? 1 : 0;
                 }
-                else if (tag.equalsIgnoreCase("DSSI_PATH"))
+                else if (reader.isName("preferpluginbridges"))
                 {
-                    option   = ENGINE_OPTION_PLUGIN_PATH;
-                    value    = PLUGIN_DSSI;
-                    valueStr = text.toRawUTF8();
+                    option = ENGINE_OPTION_PREFER_PLUGIN_BRIDGES;
+                    value  = text.equalsIgnoreCase("true") ? 1 : 0;
                 }
-                else if (tag.equalsIgnoreCase("LV2_PATH"))
+                else if (reader.isName("preferuibridges"))
                 {
-                    option   = ENGINE_OPTION_PLUGIN_PATH;
-                    value    = PLUGIN_LV2;
-                    valueStr = text.toRawUTF8();
+                    option = ENGINE_OPTION_PREFER_UI_BRIDGES;
+                    value  = text.equalsIgnoreCase("true") ? 1 : 0;
                 }
-                else if (tag.equalsIgnoreCase("VST2_PATH"))
+                else if (reader.isName("uisalwaysontop"))
                 {
-                    option   = ENGINE_OPTION_PLUGIN_PATH;
-                    value    = PLUGIN_VST2;
-                    valueStr = text.toRawUTF8();
+                    option = ENGINE_OPTION_UIS_ALWAYS_ON_TOP;
+                    value  = text.equalsIgnoreCase("true") ? 1 : 0;
                 }
-                else if (tag.equalsIgnoreCase("VST3_PATH"))
+                else if (reader.isName("maxparameters"))
                 {
-                    option   = ENGINE_OPTION_PLUGIN_PATH;
-                    value    = PLUGIN_VST3;
-                    valueStr = text.toRawUTF8();
+                    option = ENGINE_OPTION_MAX_PARAMETERS;
+                    value  = text.getIntValue();
                 }
-                else if (tag.equalsIgnoreCase("GIG_PATH"))
+                else if (reader.isName("uibridgestimeout"))
                 {
-                    option   = ENGINE_OPTION_PLUGIN_PATH;
-                    value    = PLUGIN_GIG;
-                    valueStr = text.toRawUTF8();
+                    option = ENGINE_OPTION_UI_BRIDGES_TIMEOUT;
+                    value  = text.getIntValue();
                 }
-                else if (tag.equalsIgnoreCase("SF2_PATH"))
+                else if (isPlugin)
                 {
-                    option   = ENGINE_OPTION_PLUGIN_PATH;
-                    value    = PLUGIN_SF2;
-                    valueStr = text.toRawUTF8();
-                }
-                else if (tag.equalsIgnoreCase("SFZ_PATH"))
-                {
-                    option   = ENGINE_OPTION_PLUGIN_PATH;
-                    value    = PLUGIN_SFZ;
-                    valueStr = text.toRawUTF8();
+                    /**/ if (reader.isName("LADSPA_PATH"))
+                    {
+                        option   = ENGINE_OPTION_PLUGIN_PATH;
+                        value    = PLUGIN_LADSPA;
+                        valueStr = text.toRawUTF8();
+                    }
+                    else if (reader.isName("DSSI_PATH"))
+                    {
+                        option   = ENGINE_OPTION_PLUGIN_PATH;
+                        value    = PLUGIN_DSSI;
+                        valueStr = text.toRawUTF8();
+                    }
+                    else if (reader.isName("LV2_PATH"))
+                    {
+                        option   = ENGINE_OPTION_PLUGIN_PATH;
+                        value    = PLUGIN_LV2;
+                        valueStr = text.toRawUTF8();
+                    }
+                    else if (reader.isName("VST2_PATH"))
+                    {
+                        option   = ENGINE_OPTION_PLUGIN_PATH;
+                        value    = PLUGIN_VST2;
+                        valueStr = text.toRawUTF8();
+                    }
+                    else if (reader.isName("VST3_PATH"))
+                    {
+                        option   = ENGINE_OPTION_PLUGIN_PATH;
+                        value    = PLUGIN_VST3;
+                        valueStr = text.toRawUTF8();
+                    }
+                    else if (reader.isName("GIG_PATH"))
+                    {
+                        option   = ENGINE_OPTION_PLUGIN_PATH;
+                        value    = PLUGIN_GIG;
+                        valueStr = text.toRawUTF8();
+                    }
+                    else if (reader.isName("SF2_PATH"))
+                    {
+                        option   = ENGINE_OPTION_PLUGIN_PATH;
+                        value    = PLUGIN_SF2;
+                        valueStr = text.toRawUTF8();
+                    }
+                    else if (reader.isName("SFZ_PATH"))
+                    {
+                        option   = ENGINE_OPTION_PLUGIN_PATH;
+                        value    = PLUGIN_SFZ;
+                        valueStr = text.toRawUTF8();
+                    }
                 }
+
+                CARLA_SAFE_ASSERT_CONTINUE(option != -1);
+
+                setOption(static_cast<EngineOption>(option), value, valueStr);
             }
+        }
+
+        // plugins
+        else if (reader.isName("plugin"))
+        {
+#ifndef BUILD_BRIDGE
+            if (loadInParallel)
+            {
+                ScopedPointer<ProjectPluginLoad> job(new ProjectPluginLoad());
+                if (! job->stateSave.fillFromXmlReader(reader, sidecar))
+                    stateFailed = true;
 
-            CARLA_SAFE_ASSERT_CONTINUE(option != -1);
+                callback(ENGINE_CALLBACK_IDLE, 0, 0, 0, 0.0f, nullptr);
 
-            setOption(static_cast<EngineOption>(option), value, valueStr);
+                CARLA_SAFE_ASSERT_CONTINUE(job->stateSave.type != nullptr);
+
+                jobs.add(job.release());
+                continue;
+            }
+#endif
+            CarlaStateSave stateSave;
+
+            if (! stateSave.fillFromXmlReader(reader, sidecar))
+                stateFailed = true;
+
+            callback(ENGINE_CALLBACK_IDLE, 0, 0, 0, 0.0f, nullptr);
+
+            CARLA_SAFE_ASSERT_CONTINUE(stateSave.type != nullptr);
+
+            addProjectPlugin(this, stateSave, false);
         }
 
-        break;
+#ifndef BUILD_BRIDGE
+        // connections, restored once all plugins are loaded
+        else if (reader.isName("patchbay"))
+        {
+            readProjectConnections(reader, internalConnections);
+        }
+        else if (reader.isName("externalpatchbay"))
+        {
+            readProjectConnections(reader, externalConnections);
+        }
+#endif
+
+        else
+        {
+            reader.skipElement();
+        }
     }
 
-    // handle plugins first
-    for (XmlElement* elem = xmlElement->getFirstChildElement(); elem != nullptr; elem = elem->getNextElement())
+    if (reader.hasError())
+        carla_stderr2("Project file is malformed near line %u, it was only partially loaded", reader.getLine());
+
+    // load plugins read by the single pass
+#ifndef BUILD_BRIDGE
+    if (loadInParallel)
     {
-        const String& tagName(elem->getTagName());
+        const double startTime(Time::getMillisecondCounterHiRes());
 
-        if (isPreset || tagName.equalsIgnoreCase("plugin"))
+        uint backgroundCount = 0;
+
+        for (int i=0; i < jobs.size(); ++i)
         {
-            CarlaStateSave stateSave;
-            stateSave.fillFromXmlElement(isPreset ? xmlElement.get() : elem);
+            ProjectPluginLoad* const job(jobs.getUnchecked(i));
 
-            callback(ENGINE_CALLBACK_IDLE, 0, 0, 0, 0.0f, nullptr);
+            job->btype = getBinaryTypeFromFile(job->stateSave.binary);
+            job->ptype = getPluginTypeFromString(job->stateSave.type);
 
-            CARLA_SAFE_ASSERT_CONTINUE(stateSave.type != nullptr);
+            if (CarlaString(job->stateSave.label).endsWith(kUse16OutsSuffix))
+            {
+                if (job->ptype == PLUGIN_GIG || job->ptype == PLUGIN_SF2)
+                    job->extra = "true";
+            }
 
-            const void* extraStuff = nullptr;
+            // plugins are restored while inactive
+            job->active = job->stateSave.active;
+            job->stateSave.active = false;
 
-            // check if using GIG or SF2 16outs
-            static const char kUse16OutsSuffix[] = " (16 outs)";
+            job->id = pData->curPluginCount + static_cast<uint>(i);
 
-            const BinaryType btype(getBinaryTypeFromFile(stateSave.binary));
-            const PluginType ptype(getPluginTypeFromString(stateSave.type));
+            // same bridge check as createPlugin()
+            job->inBackground = job->id < pData->maxPluginNumber && job->ptype != PLUGIN_INTERNAL
+                             && (job->btype != BINARY_NATIVE || pData->options.preferPluginBridges)
+                             && getBridgeBinary(pData->options.binaryDir, job->btype).isNotEmpty();
 
-            if (CarlaString(stateSave.label).endsWith(kUse16OutsSuffix))
+            // without a saved name the plugin picks its own, which cannot be reserved in advance
+            if (job->stateSave.name == nullptr || job->stateSave.name[0] == '\0')
+            {
+                job->inBackground = false;
+            }
+            // reserve unique names in project order, loader threads do not check them
+            else if (const char* const uniqueName = getUniquePluginName(job->stateSave.name))
             {
-                if (ptype == PLUGIN_GIG || ptype == PLUGIN_SF2)
-                    extraStuff = "true";
+                delete[] job->stateSave.name;
+                job->stateSave.name = uniqueName;
+                pData->reservedPluginNames.append(uniqueName);
             }
 
-            // TODO - proper find&load plugins
+            if (job->inBackground)
+                ++backgroundCount;
+        }
+
+        const uint jobCount(static_cast<uint>(jobs.size()));
+        const uint threadCount(std::min(pData->options.projectLoadThreads, backgroundCount));
+        uint nextJob = 0;
+        uint startedCount = 0;
+
+        juce::OwnedArray<ProjectLoaderThread> threads;
+
+        for (uint i=0; i < threadCount; ++i)
+        {
+            ProjectLoaderThread* const thread(new ProjectLoaderThread(this, jobs.getRawDataPointer(), jobCount, nextJob));
+            threads.add(thread);
+
+            if (thread->startThread())
+                ++startedCount;
+        }
+
+        // no threads, load everything from here
+        if (startedCount == 0)
+        {
+            for (uint i=0; i < jobCount; ++i)
+                jobs.getUnchecked(static_cast<int>(i))->inBackground = false;
+
+            backgroundCount = 0;
+        }
+
+        const bool needsEngineIdle(getType() != kEngineTypePlugin);
+
+        // add plugins in project order, in-process ones are loaded now
+        for (uint i=0; i < jobCount; ++i)
+        {
+            ProjectPluginLoad* const job(jobs.getUnchecked(static_cast<int>(i)));
+
+            // from now on the name is protected by the plugin itself, or free again if it fails to load
+            if (job->stateSave.name != nullptr)
+                pData->reservedPluginNames.removeOne(job->stateSave.name);
 
-            if (addPlugin(btype, ptype, stateSave.binary, stateSave.name, stateSave.label, stateSave.uniqueId, extraStuff, stateSave.options))
+            if (job->inBackground)
             {
-                if (CarlaPlugin* const plugin = getPlugin(pData->curPluginCount-1))
+                while (__atomic_load_n(&job->done, __ATOMIC_ACQUIRE) == 0)
                 {
-#ifndef BUILD_BRIDGE
-                    // deactivate bridge client-side ping check, since some plugins block during load
-                    if ((plugin->getHints() & PLUGIN_IS_BRIDGE) != 0 && ! isPreset)
-                        plugin->setCustomData(CUSTOM_DATA_TYPE_STRING, "__CarlaPingOnOff__", "false", false);
-#endif
-                    plugin->loadStateSave(stateSave);
+                    callback(ENGINE_CALLBACK_IDLE, 0, 0, 0, 0.0f, nullptr);
+
+                    if (needsEngineIdle)
+                        idle();
+
+                    carla_msleep(5);
                 }
-                else
-                    carla_stderr2("Failed to get new plugin, state will not be restored correctly\n");
+            }
+            else if (pData->curPluginCount == pData->maxPluginNumber)
+            {
+                job->error = "Maximum number of plugins reached";
             }
             else
-                carla_stderr2("Failed to load a plugin, error was:\n%s", getLastError());
+            {
+                job->id = pData->curPluginCount;
+                ProjectLoaderThread::loadPlugin(this, *job);
+            }
+
+            CarlaPlugin* const plugin(job->plugin);
+
+            if (plugin == nullptr)
+            {
+                carla_stderr2("Failed to load a plugin, error was:\n%s", job->error.buffer());
+                continue;
+            }
+
+            const uint id(pData->curPluginCount);
+
+            // previous plugins might have failed to load
+            if (plugin->getId() != id)
+                plugin->setId(id);
+
+# ifdef HAVE_LIBLO
+            plugin->registerToOscClient();
+# endif
+
+            setPluginData(pData->plugins[id], plugin);
+
+            ++pData->curPluginCount;
+            callback(ENGINE_CALLBACK_PLUGIN_ADDED, id, 0, 0, 0.0f, plugin->getName());
+
+            if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
+                pData->graph.addPlugin(plugin);
+
+            if (! job->inBackground)
+                ProjectLoaderThread::restoreState(*job);
         }
 
-        if (isPreset)
-            return true;
+        for (int i=0; i < threads.size(); ++i)
+            threads.getUnchecked(i)->stopThread(-1);
+
+        pData->reservedPluginNames.clear();
+
+        // activate all plugins at once, and report timings
+        uint loadedCount = 0;
+
+        for (uint i=0; i < jobCount; ++i)
+        {
+            const ProjectPluginLoad* const job(jobs.getUnchecked(static_cast<int>(i)));
+
+            if (job->plugin == nullptr)
+                continue;
+
+            job->plugin->setActive(job->active, true, true);
+            ++loadedCount;
+
+            carla_debug("Project plugin %u \"%s\": created in %.1f ms, state restored in %.1f ms%s",
+                        job->plugin->getId(), job->plugin->getName(), job->createTime, job->restoreTime,
+                        job->inBackground ? " (background)" : "");
+
+            callback(ENGINE_CALLBACK_PROJECT_PLUGIN_LOADED, job->plugin->getId(),
+                     static_cast<int>(job->createTime * 1000.0), static_cast<int>(job->restoreTime * 1000.0), 0.0f, nullptr);
+        }
+
+        const double loadTime(Time::getMillisecondCounterHiRes() - startTime);
+
+        carla_debug("Project plugins loaded in %.1f ms, %u of %u, %u in the background using %u threads",
+                    loadTime, loadedCount, jobCount, backgroundCount, startedCount);
+
+        callback(ENGINE_CALLBACK_PROJECT_PLUGINS_LOADED, 0, static_cast<int>(loadedCount), static_cast<int>(jobCount),
+                 static_cast<float>(loadTime), nullptr);
     }
+#endif
 
 #ifndef BUILD_BRIDGE
     // tell bridges we're done loading
@@ -1927,41 +2631,11 @@ bool CarlaEngine::loadProjectInternal(juce::XmlDocument& xmlDoc)
     {
         const bool isUsingExternal(pData->graph.isUsingExternal());
 
-        for (XmlElement* elem = xmlElement->getFirstChildElement(); elem != nullptr; elem = elem->getNextElement())
-        {
-            const String& tagName(elem->getTagName());
-
-            if (! tagName.equalsIgnoreCase("patchbay"))
-                continue;
-
-            CarlaString sourcePort, targetPort;
-
-            for (XmlElement* patchElem = elem->getFirstChildElement(); patchElem != nullptr; patchElem = patchElem->getNextElement())
-            {
-                const String& patchTag(patchElem->getTagName());
+        for (int i=0; i+1 < internalConnections.size(); i += 2)
+            restorePatchbayConnection(false, internalConnections[i].toRawUTF8(), internalConnections[i+1].toRawUTF8(), !isUsingExternal);
 
-                sourcePort.clear();
-                targetPort.clear();
-
-                if (! patchTag.equalsIgnoreCase("connection"))
-                    continue;
-
-                for (XmlElement* connElem = patchElem->getFirstChildElement(); connElem != nullptr; connElem = connElem->getNextElement())
-                {
-                    const String& tag(connElem->getTagName());
-                    const String  text(connElem->getAllSubText().trim());
-
-                    /**/ if (tag.equalsIgnoreCase("source"))
-                        sourcePort = xmlSafeString(text, false).toRawUTF8();
-                    else if (tag.equalsIgnoreCase("target"))
-                        targetPort = xmlSafeString(text, false).toRawUTF8();
-                }
-
-                if (sourcePort.isNotEmpty() && targetPort.isNotEmpty())
-                    restorePatchbayConnection(false, sourcePort, targetPort, !isUsingExternal);
-            }
-            break;
-        }
+        // build the render plan once for the whole project
+        pData->graph.idle();
     }
 
     callback(ENGINE_CALLBACK_IDLE, 0, 0, 0, 0.0f, nullptr);
@@ -1987,44 +2661,17 @@ bool CarlaEngine::loadProjectInternal(juce::XmlDocument& xmlDoc)
     {
         const bool isUsingExternal(pData->graph.isUsingExternal());
 
-        for (XmlElement* elem = xmlElement->getFirstChildElement(); elem != nullptr; elem = elem->getNextElement())
-        {
-            const String& tagName(elem->getTagName());
-
-            if (! tagName.equalsIgnoreCase("externalpatchbay"))
-                continue;
-
-            CarlaString sourcePort, targetPort;
-
-            for (XmlElement* patchElem = elem->getFirstChildElement(); patchElem != nullptr; patchElem = patchElem->getNextElement())
-            {
-                const String& patchTag(patchElem->getTagName());
-
-                sourcePort.clear();
-                targetPort.clear();
-
-                if (! patchTag.equalsIgnoreCase("connection"))
-                    continue;
-
-                for (XmlElement* connElem = patchElem->getFirstChildElement(); connElem != nullptr; connElem = connElem->getNextElement())
-                {
-                    const String& tag(connElem->getTagName());
-                    const String  text(connElem->getAllSubText().trim());
-
-                    /**/ if (tag.equalsIgnoreCase("source"))
-                        sourcePort = xmlSafeString(text, false).toRawUTF8();
-                    else if (tag.equalsIgnoreCase("target"))
-                        targetPort = xmlSafeString(text, false).toRawUTF8();
-                }
-
-                if (sourcePort.isNotEmpty() && targetPort.isNotEmpty())
-                    restorePatchbayConnection(true, sourcePort, targetPort, isUsingExternal);
-            }
-            break;
-        }
+        for (int i=0; i+1 < externalConnections.size(); i += 2)
+            restorePatchbayConnection(true, externalConnections[i].toRawUTF8(), externalConnections[i+1].toRawUTF8(), isUsingExternal);
     }
 #endif
 
+    if (stateFailed || reader.hasError())
+    {
+        setLastError("Some plugin states could not be restored, project data is corrupt");
+        return false;
+    }
+
     return true;
 }
 
@@ -23,15 +23,13 @@
 #include "CarlaPlugin.hpp"
 
 #include "CarlaBackendUtils.hpp"
-#include "CarlaBase64Utils.hpp"
 #include "CarlaBridgeUtils.hpp"
+#include "CarlaMathUtils.hpp"
 #include "CarlaMIDI.h"
 
 #include "jackbridge/JackBridge.hpp"
 
-using juce::File;
 using juce::MemoryBlock;
-using juce::String;
 using juce::Time;
 
 template<typename T>
@@ -95,6 +93,96 @@ struct BridgeAudioPool {
     CARLA_DECLARE_NON_COPY_STRUCT(BridgeAudioPool)
 };
 
+// -------------------------------------------------------------------
+// Created by the server, see kPluginBridgeNonRtClientSetChunkShm.
+// Only mapped while a chunk is being transferred.
+
+struct BridgeChunkPool {
+    CarlaString filename;
+    uint64_t size;
+    BridgeChunkHeader* data;
+    char shm[64];
+
+    BridgeChunkPool() noexcept
+        : filename(),
+          size(0),
+          data(nullptr)
+    {
+        carla_zeroChars(shm, 64);
+        jackbridge_shm_init(shm);
+    }
+
+    ~BridgeChunkPool() noexcept
+    {
+        clear();
+    }
+
+    void clear() noexcept
+    {
+        filename.clear();
+
+        if (! jackbridge_shm_is_valid(shm))
+        {
+            CARLA_SAFE_ASSERT(data == nullptr);
+            return;
+        }
+
+        unmap();
+        size = 0;
+
+        jackbridge_shm_close(shm);
+        jackbridge_shm_init(shm);
+    }
+
+    bool attach(const char* const newFilename, const uint64_t newSize) noexcept
+    {
+        clear();
+
+        filename = newFilename;
+        size     = newSize;
+
+        jackbridge_shm_attach(shm, filename);
+
+        return jackbridge_shm_is_valid(shm);
+    }
+
+    bool map() noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(jackbridge_shm_is_valid(shm), false);
+
+        if (data == nullptr)
+            data = (BridgeChunkHeader*)jackbridge_shm_map(shm, sizeof(BridgeChunkHeader)+size);
+
+        return (data != nullptr);
+    }
+
+    void unmap() noexcept
+    {
+        if (data == nullptr)
+            return;
+
+        jackbridge_shm_unmap(shm, data);
+        data = nullptr;
+    }
+
+    uint8_t* getData() const noexcept
+    {
+        return (uint8_t*)(data + 1);
+    }
+
+    bool isPieceReady() const noexcept
+    {
+        return __atomic_load_n(&data->pieceReady, __ATOMIC_ACQUIRE) != 0;
+    }
+
+    void setPieceReady(const bool ready) noexcept
+    {
+        __atomic_store_n(&data->pieceReady, ready ? 1U : 0U, __ATOMIC_RELEASE);
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(BridgeChunkPool)
+};
+
 // -------------------------------------------------------------------
 
 struct BridgeRtClientControl : public CarlaRingBufferControl<SmallStackBuffer> {
@@ -142,13 +230,16 @@ struct BridgeRtClientControl : public CarlaRingBufferControl<SmallStackBuffer> {
         return jackbridge_shm_is_valid(shm);
     }
 
-    bool mapData() noexcept
+    // the size depends on how many plugins the server lets this process host, it is sent with the initial values
+    bool mapData(const std::size_t size) noexcept
     {
         CARLA_SAFE_ASSERT(data == nullptr);
+        CARLA_SAFE_ASSERT_RETURN(size >= sizeof(BridgeRtClientData), false);
+
+        data = (BridgeRtClientData*)jackbridge_shm_map(shm, size);
 
-        if (jackbridge_shm_map2<BridgeRtClientData>(shm, data))
+        if (data != nullptr)
         {
-            CARLA_SAFE_ASSERT(data->midiOut[0] == 0);
             setRingBuffer(&data->ringBuffer, false);
             return true;
         }
@@ -166,7 +257,11 @@ struct BridgeRtClientControl : public CarlaRingBufferControl<SmallStackBuffer> {
     {
         CARLA_SAFE_ASSERT_RETURN(data != nullptr,);
 
-        jackbridge_sem_post(&data->sem.client);
+        __atomic_add_fetch(&data->handoff.clientSeq, 1, __ATOMIC_SEQ_CST);
+
+        // server might be busy-waiting on clientSeq, only wake it up if it went to sleep
+        if (__atomic_exchange_n(&data->handoff.serverWaiting, 0, __ATOMIC_SEQ_CST) != 0)
+            jackbridge_sem_post(&data->sem.client);
     }
 
     bool waitForServer(const uint secs) noexcept
@@ -366,17 +461,27 @@ class CarlaEngineBridge : public CarlaEngine,
                           public CarlaThread
 {
 public:
-    CarlaEngineBridge(const char* const audioPoolBaseName, const char* const rtClientBaseName, const char* const nonRtClientBaseName, const char* const nonRtServerBaseName)
+    CarlaEngineBridge(const char* const audioPoolBaseName, const char* const rtClientBaseName, const char* const nonRtClientBaseName, const char* const nonRtServerBaseName,
+                      CarlaEngineBridge* const groupOwner = nullptr, const uint groupSlot = 0)
         : CarlaEngine(),
           CarlaThread("CarlaEngineBridge"),
           fShmAudioPool(),
           fShmRtClientControl(),
           fShmNonRtClientControl(),
           fShmNonRtServerControl(),
+          fShmChunkPool(),
+          fChunkBuffer(),
           fIsOffline(false),
           fFirstIdle(true),
-          fLastPingTime(-1)
+          fLastPingTime(-1),
+          fNextInputEvent(0),
+          fGroupOwner(groupOwner),
+          fGroupSlot(groupSlot),
+          fGroupClosing(false),
+          fGroupMutex()
     {
+        carla_zeroPointers(fGroupMembers, kPluginBridgeGroupMaxPlugins);
+
         carla_stdout("CarlaEngineBridge::CarlaEngineBridge(\"%s\", \"%s\", \"%s\", \"%s\")", audioPoolBaseName, rtClientBaseName, nonRtClientBaseName, nonRtServerBaseName);
 
         fShmAudioPool.filename  = PLUGIN_BRIDGE_NAMEPREFIX_AUDIO_POOL;
@@ -425,13 +530,6 @@ public:
             return false;
         }
 
-        if (! fShmRtClientControl.mapData())
-        {
-            clear();
-            carla_stdout("Failed to map rt client control shared memory");
-            return false;
-        }
-
         if (! fShmNonRtClientControl.attach())
         {
             clear();
@@ -465,8 +563,13 @@ public:
         opcode = fShmNonRtClientControl.readOpcode();
         CARLA_SAFE_ASSERT_INT(opcode == kPluginBridgeNonRtClientNull, opcode);
 
+        // the rt channel has a midi output area per plugin slot
         const uint32_t shmRtClientDataSize = fShmNonRtClientControl.readUInt();
-        CARLA_SAFE_ASSERT_INT2(shmRtClientDataSize == sizeof(BridgeRtClientData), shmRtClientDataSize, sizeof(BridgeRtClientData));
+        const uint32_t shmRtClientSlots = shmRtClientDataSize >= sizeof(BridgeRtClientData)
+                                        ? 1U + static_cast<uint32_t>((shmRtClientDataSize - sizeof(BridgeRtClientData)) / kBridgeRtClientDataMidiOutSize)
+                                        : 0U;
+        CARLA_SAFE_ASSERT_INT2(shmRtClientDataSize == getBridgeRtClientDataSize(shmRtClientSlots), shmRtClientDataSize, sizeof(BridgeRtClientData));
+        CARLA_SAFE_ASSERT_INT2(fGroupSlot < shmRtClientSlots, fGroupSlot, shmRtClientSlots);
 
         const uint32_t shmNonRtClientDataSize = fShmNonRtClientControl.readUInt();
         CARLA_SAFE_ASSERT_INT2(shmNonRtClientDataSize == sizeof(BridgeNonRtClientData), shmNonRtClientDataSize, sizeof(BridgeNonRtClientData));
@@ -485,13 +588,28 @@ public:
         carla_stdout("Carla Client Info:");
         carla_stdout("  BufferSize: %i", pData->bufferSize);
         carla_stdout("  SampleRate: %g", pData->sampleRate);
-        carla_stdout("  sizeof(BridgeRtClientData):    %i/" P_SIZE, shmRtClientDataSize,    sizeof(BridgeRtClientData));
+        carla_stdout("  sizeof(BridgeRtClientData):    %i/" P_SIZE, shmRtClientDataSize,    getBridgeRtClientDataSize(shmRtClientSlots));
         carla_stdout("  sizeof(BridgeNonRtClientData): %i/" P_SIZE, shmNonRtClientDataSize, sizeof(BridgeNonRtClientData));
         carla_stdout("  sizeof(BridgeNonRtServerData): %i/" P_SIZE, shmNonRtServerDataSize, sizeof(BridgeNonRtServerData));
 
-        if (shmRtClientDataSize != sizeof(BridgeRtClientData) || shmNonRtClientDataSize != sizeof(BridgeNonRtClientData)  || shmNonRtServerDataSize != sizeof(BridgeNonRtServerData))
+        if (shmRtClientDataSize != getBridgeRtClientDataSize(shmRtClientSlots) || shmNonRtClientDataSize != sizeof(BridgeNonRtClientData)  || shmNonRtServerDataSize != sizeof(BridgeNonRtServerData))
+            return false;
+        if (fGroupSlot >= shmRtClientSlots)
             return false;
 
+        if (! fShmRtClientControl.mapData(shmRtClientDataSize))
+        {
+            clear();
+            carla_stdout("Failed to map rt client control shared memory");
+            return false;
+        }
+
+        // group members attach to a channel that is already in use
+        if (fGroupOwner == nullptr)
+        {
+            CARLA_SAFE_ASSERT(getBridgeRtClientMidiOut(fShmRtClientControl.data, 0)[0] == 0);
+        }
+
         // tell backend we're live
         {
             const CarlaMutexLocker _cml(fShmNonRtServerControl.mutex);
@@ -500,7 +618,9 @@ public:
             fShmNonRtServerControl.commitWrite();
         }
 
-        startThread();
+        // group members are processed from the owner's thread
+        if (fGroupOwner == nullptr)
+            startThread();
 
         return true;
     }
@@ -513,6 +633,16 @@ public:
         CarlaEngine::close();
 
         stopThread(5000);
+
+        for (uint i=0; i < kPluginBridgeGroupMaxPlugins; ++i)
+        {
+            if (CarlaEngineBridge* const member = fGroupMembers[i])
+            {
+                fGroupMembers[i] = nullptr;
+                deleteGroupMember(member);
+            }
+        }
+
         clear();
 
         return true;
@@ -520,6 +650,9 @@ public:
 
     bool isRunning() const noexcept override
     {
+        if (fGroupOwner != nullptr)
+            return fGroupOwner->isRunning();
+
         return isThreadRunning() || ! fFirstIdle;
     }
 
@@ -541,6 +674,11 @@ public:
     void idle() noexcept override
     {
         CarlaPlugin* const plugin(pData->plugins[0].plugin);
+
+        // a bridge without a plugin of its own is hosting a group
+        if (plugin == nullptr && fGroupOwner == nullptr)
+            return idleGroup();
+
         CARLA_SAFE_ASSERT_RETURN(plugin != nullptr,);
 
         const bool wasFirstIdle(fFirstIdle);
@@ -800,10 +938,73 @@ public:
         }
     }
 
+    void idleGroup() noexcept
+    {
+        const bool wasFirstIdle(fFirstIdle);
+
+        if (fFirstIdle)
+        {
+            fFirstIdle = false;
+            fLastPingTime = Time::currentTimeMillis();
+            CARLA_SAFE_ASSERT(fLastPingTime > 0);
+        }
+
+        CarlaEngine::idle();
+
+        // members go first, so a slot released by the server is free before it asks to reuse it
+        for (uint i=0; i < kPluginBridgeGroupMaxPlugins; ++i)
+        {
+            CarlaEngineBridge* const member(fGroupMembers[i]);
+
+            if (member == nullptr)
+                continue;
+
+            member->idle();
+
+            if (! member->fGroupClosing)
+                continue;
+
+            {
+                const CarlaMutexLocker cml(fGroupMutex);
+                fGroupMembers[i] = nullptr;
+            }
+
+            carla_stdout("Carla bridge group member %i closed", i);
+            deleteGroupMember(member);
+        }
+
+        try {
+            handleNonRtData();
+        } CARLA_SAFE_EXCEPTION("handleNonRtData");
+
+        if (fLastPingTime > 0 && Time::currentTimeMillis() > fLastPingTime + 30000 && ! wasFirstIdle)
+        {
+            carla_stderr("Did not receive ping message from server for 30 secs, closing...");
+            callback(ENGINE_CALLBACK_QUIT, 0, 0, 0, 0.0f, nullptr);
+        }
+    }
+
+    static void deleteGroupMember(CarlaEngineBridge* const member) noexcept
+    {
+        member->setAboutToClose();
+
+        try {
+            if (member->getCurrentPluginCount() != 0)
+                member->removePlugin(0);
+            member->close();
+        } CARLA_SAFE_EXCEPTION("deleteGroupMember");
+
+        delete member;
+    }
+
     void callback(const EngineCallbackOpcode action, const uint pluginId, const int value1, const int value2, const float value3, const char* const valueStr) noexcept override
     {
         CarlaEngine::callback(action, pluginId, value1, value2, value3, valueStr);
 
+        // group members cannot close the process, let the owner remove them on its next idle
+        if (fGroupOwner != nullptr && action == ENGINE_CALLBACK_QUIT)
+            fGroupClosing = true;
+
         if (fLastPingTime < 0)
             return;
 
@@ -869,6 +1070,62 @@ public:
         fShmRtClientControl.clear();
         fShmNonRtClientControl.clear();
         fShmNonRtServerControl.clear();
+        fShmChunkPool.clear();
+    }
+
+    // sends a chunk to the server through the chunk pool, in several pieces if it does not fit
+    void sendChunkData(const void* const data, const uint64_t dataSize) noexcept
+    {
+        if (! fShmChunkPool.map())
+        {
+            carla_stderr("CarlaEngineBridge::sendChunkData() - chunk pool is not available");
+            return;
+        }
+
+        const uint8_t* const bytes(static_cast<const uint8_t*>(data));
+
+        for (uint64_t offset=0; offset < dataSize;)
+        {
+            if (! waitForChunkPieceTaken())
+                break;
+
+            const uint32_t pieceSize(static_cast<uint32_t>(std::min<uint64_t>(dataSize-offset, fShmChunkPool.size)));
+
+            std::memcpy(fShmChunkPool.getData(), bytes+offset, pieceSize);
+            fShmChunkPool.setPieceReady(true);
+
+            {
+                const CarlaMutexLocker _cml(fShmNonRtServerControl.mutex);
+
+                fShmNonRtServerControl.writeOpcode(kPluginBridgeNonRtServerSetChunkData);
+                fShmNonRtServerControl.writeULong(dataSize);
+                fShmNonRtServerControl.writeULong(offset);
+                fShmNonRtServerControl.writeUInt(pieceSize);
+                fShmNonRtServerControl.commitWrite();
+            }
+
+            offset += pieceSize;
+        }
+
+        fShmChunkPool.unmap();
+    }
+
+    bool waitForChunkPieceTaken() noexcept
+    {
+        const uint32_t timeoutEnd(Time::getMillisecondCounter() + kPluginBridgeChunkPieceTimeout);
+
+        for (; fShmChunkPool.isPieceReady();)
+        {
+            if (Time::getMillisecondCounter() >= timeoutEnd)
+            {
+                carla_stderr("CarlaEngineBridge::waitForChunkPieceTaken() - Timeout while waiting for server");
+                return false;
+            }
+
+            carla_msleep(1);
+        }
+
+        return true;
     }
 
     void handleNonRtData()
@@ -1008,39 +1265,58 @@ public:
                 break;
             }
 
-            case kPluginBridgeNonRtClientSetChunkDataFile: {
+            case kPluginBridgeNonRtClientSetChunkShm: {
                 const uint32_t size(fShmNonRtClientControl.readUInt());
                 CARLA_SAFE_ASSERT_BREAK(size > 0);
 
-                char chunkFilePathTry[size+1];
-                carla_zeroChars(chunkFilePathTry, size+1);
-                fShmNonRtClientControl.readCustomData(chunkFilePathTry, size);
+                char filename[size+1];
+                carla_zeroChars(filename, size+1);
+                fShmNonRtClientControl.readCustomData(filename, size);
 
-                CARLA_SAFE_ASSERT_BREAK(chunkFilePathTry[0] != '\0');
-                if (plugin == nullptr || ! plugin->isEnabled()) break;
+                const uint64_t dataSize(fShmNonRtClientControl.readULong());
+                CARLA_SAFE_ASSERT_BREAK(dataSize > 0);
 
-                carla_stdout("Carla bridge client side setChunkData 001");
+                if (! fShmChunkPool.attach(filename, dataSize))
+                    carla_stderr("CarlaEngineBridge::handleNonRtData() - Failed to attach to chunk pool");
+                break;
+            }
 
-                String chunkFilePath(chunkFilePathTry);
+            case kPluginBridgeNonRtClientSetChunkData: {
+                const uint64_t total(fShmNonRtClientControl.readULong());
+                const uint64_t offset(fShmNonRtClientControl.readULong());
+                const uint32_t pieceSize(fShmNonRtClientControl.readUInt());
 
-#ifdef CARLA_OS_WIN
-                // check if running under Wine
-                if (chunkFilePath.startsWith("/"))
-                    chunkFilePath = chunkFilePath.replaceSection(0, 1, "Z:\\").replace("/", "\\");
-#endif
+                CARLA_SAFE_ASSERT_BREAK(pieceSize <= fShmChunkPool.size);
+                CARLA_SAFE_ASSERT_BREAK(offset+pieceSize <= total);
+                CARLA_SAFE_ASSERT_BREAK(fShmChunkPool.map());
+
+                const bool canSet(plugin != nullptr && plugin->isEnabled());
 
-                File chunkFile(chunkFilePath);
-                CARLA_SAFE_ASSERT_BREAK(chunkFile.existsAsFile());
+                if (offset == 0 && pieceSize == total)
+                {
+                    // all in one piece, use it in place
+                    if (canSet)
+                        plugin->setChunkData(fShmChunkPool.getData(), pieceSize);
+                }
+                else
+                {
+                    if (offset == 0)
+                        fChunkBuffer.resize(total);
 
-                String chunkDataBase64(chunkFile.loadFileAsString());
-                chunkFile.deleteFile();
-                CARLA_SAFE_ASSERT_BREAK(chunkDataBase64.isNotEmpty());
+                    if (fChunkBuffer.size() == total)
+                        std::memcpy(fChunkBuffer.data()+offset, fShmChunkPool.getData(), pieceSize);
+
+                    if (offset+pieceSize == total)
+                    {
+                        if (canSet && fChunkBuffer.size() == total)
+                            plugin->setChunkData(fChunkBuffer.data(), total);
 
-                std::vector<uint8_t> chunk(carla_getChunkFromBase64String(chunkDataBase64.toRawUTF8()));
-                carla_stdout("Carla bridge client side setChunkData 002");
+                        std::vector<uint8_t>().swap(fChunkBuffer);
+                    }
+                }
 
-                plugin->setChunkData(chunk.data(), chunk.size());
-                carla_stdout("Carla bridge client side setChunkData done");
+                fShmChunkPool.setPieceReady(false);
+                fShmChunkPool.unmap();
                 break;
             }
 
@@ -1104,26 +1380,7 @@ public:
                     {
                         CARLA_SAFE_ASSERT_BREAK(data != nullptr);
 
-                        CarlaString dataBase64 = CarlaString::asBase64(data, dataSize);
-                        CARLA_SAFE_ASSERT_BREAK(dataBase64.length() > 0);
-
-                        String filePath(File::getSpecialLocation(File::tempDirectory).getFullPathName());
-
-                        filePath += CARLA_OS_SEP_STR;
-                        filePath += ".CarlaChunk_";
-                        filePath += fShmNonRtClientControl.filename.buffer() + 24;
-
-                        if (File(filePath).replaceWithText(dataBase64.buffer()))
-                        {
-                            const uint32_t ulength(static_cast<uint32_t>(filePath.length()));
-
-                            const CarlaMutexLocker _cml(fShmNonRtServerControl.mutex);
-
-                            fShmNonRtServerControl.writeOpcode(kPluginBridgeNonRtServerSetChunkDataFile);
-                            fShmNonRtServerControl.writeUInt(ulength);
-                            fShmNonRtServerControl.writeCustomData(filePath.toRawUTF8(), ulength);
-                            fShmNonRtServerControl.commitWrite();
-                        }
+                        sendChunkData(data, dataSize);
                     }
                 }
 
@@ -1194,8 +1451,148 @@ public:
                 signalThreadShouldExit();
                 callback(ENGINE_CALLBACK_QUIT, 0, 0, 0, 0.0f, nullptr);
                 break;
+
+            case kPluginBridgeNonRtClientAddPlugin: {
+                const uint32_t index(fShmNonRtClientControl.readUInt());
+                const uint32_t ptype(fShmNonRtClientControl.readUInt());
+
+                // filename
+                const uint32_t filenameSize(fShmNonRtClientControl.readUInt());
+                char filenameStr[filenameSize+1];
+                carla_zeroChars(filenameStr, filenameSize+1);
+                if (filenameSize != 0)
+                    fShmNonRtClientControl.readCustomData(filenameStr, filenameSize);
+
+                // name
+                const uint32_t nameSize(fShmNonRtClientControl.readUInt());
+                char nameStr[nameSize+1];
+                carla_zeroChars(nameStr, nameSize+1);
+                if (nameSize != 0)
+                    fShmNonRtClientControl.readCustomData(nameStr, nameSize);
+
+                // label
+                const uint32_t labelSize(fShmNonRtClientControl.readUInt());
+                char labelStr[labelSize+1];
+                carla_zeroChars(labelStr, labelSize+1);
+                if (labelSize != 0)
+                    fShmNonRtClientControl.readCustomData(labelStr, labelSize);
+
+                const int64_t uniqueId(fShmNonRtClientControl.readLong());
+
+                char shmIds[6*4+1];
+                carla_zeroChars(shmIds, 6*4+1);
+                fShmNonRtClientControl.readCustomData(shmIds, 6*4);
+
+                CARLA_SAFE_ASSERT_BREAK(fGroupOwner == nullptr && pData->curPluginCount == 0);
+                CARLA_SAFE_ASSERT_BREAK(index < kPluginBridgeGroupMaxPlugins);
+                CARLA_SAFE_ASSERT_BREAK(fGroupMembers[index] == nullptr);
+
+                addGroupMember(index, static_cast<PluginType>(ptype),
+                               filenameStr[0] != '\0' ? filenameStr : nullptr,
+                               nameStr[0]     != '\0' ? nameStr     : nullptr,
+                               labelStr[0]    != '\0' ? labelStr    : nullptr,
+                               uniqueId, shmIds);
+                break;
+            }
+            }
+        }
+    }
+
+    void addGroupMember(const uint index, const PluginType ptype, const char* const filename, const char* const name, const char* const label,
+                        const int64_t uniqueId, const char shmIds[6*4+1])
+    {
+        char audioPoolBaseName[6+1];
+        char rtClientBaseName[6+1];
+        char nonRtClientBaseName[6+1];
+        char nonRtServerBaseName[6+1];
+
+        std::strncpy(audioPoolBaseName,   shmIds+6*0, 6);
+        std::strncpy(rtClientBaseName,    shmIds+6*1, 6);
+        std::strncpy(nonRtClientBaseName, shmIds+6*2, 6);
+        std::strncpy(nonRtServerBaseName, shmIds+6*3, 6);
+        audioPoolBaseName[6]   = '\0';
+        rtClientBaseName[6]    = '\0';
+        nonRtClientBaseName[6] = '\0';
+        nonRtServerBaseName[6] = '\0';
+
+        CarlaEngineBridge* const member(new CarlaEngineBridge(audioPoolBaseName, rtClientBaseName, nonRtClientBaseName, nonRtServerBaseName, this, index));
+
+        const EngineOptions& opts(pData->options);
+
+        member->setOption(ENGINE_OPTION_PROCESS_MODE,   ENGINE_PROCESS_MODE_BRIDGE,   nullptr);
+        member->setOption(ENGINE_OPTION_TRANSPORT_MODE, ENGINE_TRANSPORT_MODE_BRIDGE, nullptr);
+        member->setOption(ENGINE_OPTION_UIS_ALWAYS_ON_TOP,       opts.uisAlwaysOnTop ? 1 : 0,                nullptr);
+        member->setOption(ENGINE_OPTION_MAX_PARAMETERS,          static_cast<int>(opts.maxParameters),    nullptr);
+        member->setOption(ENGINE_OPTION_UI_BRIDGES_TIMEOUT,      static_cast<int>(opts.uiBridgesTimeout), nullptr);
+        member->setOption(ENGINE_OPTION_PREVENT_BAD_BEHAVIOUR,   opts.preventBadBehaviour ? 1 : 0,           nullptr);
+
+        if (opts.pathLADSPA != nullptr)
+            member->setOption(ENGINE_OPTION_PLUGIN_PATH, PLUGIN_LADSPA, opts.pathLADSPA);
+        if (opts.pathDSSI != nullptr)
+            member->setOption(ENGINE_OPTION_PLUGIN_PATH, PLUGIN_DSSI, opts.pathDSSI);
+        if (opts.pathLV2 != nullptr)
+            member->setOption(ENGINE_OPTION_PLUGIN_PATH, PLUGIN_LV2, opts.pathLV2);
+        if (opts.pathVST2 != nullptr)
+            member->setOption(ENGINE_OPTION_PLUGIN_PATH, PLUGIN_VST2, opts.pathVST2);
+        if (opts.pathVST3 != nullptr)
+            member->setOption(ENGINE_OPTION_PLUGIN_PATH, PLUGIN_VST3, opts.pathVST3);
+        if (opts.pathGIG != nullptr)
+            member->setOption(ENGINE_OPTION_PLUGIN_PATH, PLUGIN_GIG, opts.pathGIG);
+        if (opts.pathSF2 != nullptr)
+            member->setOption(ENGINE_OPTION_PLUGIN_PATH, PLUGIN_SF2, opts.pathSF2);
+        if (opts.pathSFZ != nullptr)
+            member->setOption(ENGINE_OPTION_PLUGIN_PATH, PLUGIN_SFZ, opts.pathSFZ);
+        if (opts.binaryDir != nullptr)
+            member->setOption(ENGINE_OPTION_PATH_BINARIES, 0, opts.binaryDir);
+        if (opts.resourceDir != nullptr)
+            member->setOption(ENGINE_OPTION_PATH_RESOURCES, 0, opts.resourceDir);
+
+        if (opts.frontendWinId != 0)
+        {
+            char strBuf[STR_MAX+1];
+            std::snprintf(strBuf, STR_MAX, P_UINTPTR, opts.frontendWinId);
+            strBuf[STR_MAX] = '\0';
+            member->setOption(ENGINE_OPTION_FRONTEND_WIN_ID, 0, strBuf);
+        }
+
+        CarlaString clientName(name != nullptr ? name : getName());
+        clientName += "-";
+        clientName += CarlaString(static_cast<int>(index));
+
+        if (! member->init(clientName))
+        {
+            carla_stderr("Failed to init bridge group member %i", index);
+            delete member;
+            return;
+        }
+
+        // same as the single plugin bridge
+        const void* extraStuff = nullptr;
+
+        if ((ptype == PLUGIN_GIG || ptype == PLUGIN_SF2) && label != nullptr && std::strstr(label, " (16 outs)") != nullptr)
+            extraStuff = "true";
+
+        if (! member->addPlugin(BINARY_NATIVE, ptype, filename, name, label, uniqueId, extraStuff, 0x0))
+        {
+            const char* const message(member->getLastError());
+            const std::size_t messageSize(std::strlen(message));
+
+            carla_stderr("Bridge group member %i failed to load, error was:\n%s", index, message);
+
+            {
+                const CarlaMutexLocker _cml(member->fShmNonRtServerControl.mutex);
+                member->fShmNonRtServerControl.writeOpcode(kPluginBridgeNonRtServerError);
+                member->fShmNonRtServerControl.writeUInt(messageSize);
+                member->fShmNonRtServerControl.writeCustomData(message, messageSize);
+                member->fShmNonRtServerControl.commitWrite();
             }
+
+            deleteGroupMember(member);
+            return;
         }
+
+        const CarlaMutexLocker cml(fGroupMutex);
+        fGroupMembers[index] = member;
     }
 
     // -------------------------------------------------------------------
@@ -1227,313 +1624,397 @@ protected:
 
             timedOut = false;
 
-            for (; fShmRtClientControl.isDataAvailableForReading();)
             {
-                const PluginBridgeRtClientOpcode opcode(fShmRtClientControl.readOpcode());
-                CarlaPlugin* const plugin(pData->plugins[0].plugin);
+                const CarlaMutexLocker cml(fGroupMutex);
 
-#ifdef DEBUG
-                if (opcode != kPluginBridgeRtClientProcess && opcode != kPluginBridgeRtClientMidiEvent) {
-                    carla_debug("CarlaEngineBridgeRtThread::run() - got opcode: %s", PluginBridgeRtClientOpcode2str(opcode));
-                }
-#endif
+                // opcodes go to our own plugin unless a group member has been selected
+                CarlaEngineBridge* target = this;
 
-                switch (opcode)
+                for (; fShmRtClientControl.isDataAvailableForReading();)
                 {
-                case kPluginBridgeRtClientNull:
-                    break;
+                    const PluginBridgeRtClientOpcode opcode(fShmRtClientControl.readOpcode());
 
-                case kPluginBridgeRtClientSetAudioPool: {
-                    const uint64_t poolSize(fShmRtClientControl.readULong());
-                    CARLA_SAFE_ASSERT_BREAK(poolSize > 0);
-                    fShmAudioPool.data = (float*)jackbridge_shm_map(fShmAudioPool.shm, static_cast<size_t>(poolSize));
-                    break;
-                }
-
-                case kPluginBridgeRtClientControlEventParameter: {
-                    const uint32_t time(fShmRtClientControl.readUInt());
-                    const uint8_t  channel(fShmRtClientControl.readByte());
-                    const uint16_t param(fShmRtClientControl.readUShort());
-                    const float    value(fShmRtClientControl.readFloat());
+#ifdef DEBUG
+                    if (opcode != kPluginBridgeRtClientProcess && opcode != kPluginBridgeRtClientMidiEvent) {
+                        carla_debug("CarlaEngineBridgeRtThread::run() - got opcode: %s", PluginBridgeRtClientOpcode2str(opcode));
+                    }
+#endif
 
-                    if (EngineEvent* const event = getNextFreeInputEvent())
+                    switch (opcode)
                     {
-                        event->type    = kEngineEventTypeControl;
-                        event->time    = time;
-                        event->channel = channel;
-                        event->ctrl.type  = kEngineControlEventTypeParameter;
-                        event->ctrl.param = param;
-                        event->ctrl.value = value;
+                    case kPluginBridgeRtClientSetPlugin: {
+                        const uint32_t index(fShmRtClientControl.readUInt());
+                        target = this;
+
+                        CARLA_SAFE_ASSERT_BREAK(index < kPluginBridgeGroupMaxPlugins);
+
+                        if (CarlaEngineBridge* const member = fGroupMembers[index])
+                            target = member;
+                        break;
                     }
-                    break;
-                }
 
-                case kPluginBridgeRtClientControlEventMidiBank: {
-                    const uint32_t time(fShmRtClientControl.readUInt());
-                    const uint8_t  channel(fShmRtClientControl.readByte());
-                    const uint16_t index(fShmRtClientControl.readUShort());
+                    case kPluginBridgeRtClientChainAudio: {
+                        const uint32_t index(fShmRtClientControl.readUInt());
+                        CARLA_SAFE_ASSERT_BREAK(index < kPluginBridgeGroupMaxPlugins);
 
-                    if (EngineEvent* const event = getNextFreeInputEvent())
-                    {
-                        event->type    = kEngineEventTypeControl;
-                        event->time    = time;
-                        event->channel = channel;
-                        event->ctrl.type  = kEngineControlEventTypeMidiBank;
-                        event->ctrl.param = index;
-                        event->ctrl.value = 0.0f;
+                        target->chainAudioFrom(fGroupMembers[index]);
+                        break;
                     }
-                    break;
-                }
 
-                case kPluginBridgeRtClientControlEventMidiProgram: {
-                    const uint32_t time(fShmRtClientControl.readUInt());
-                    const uint8_t  channel(fShmRtClientControl.readByte());
-                    const uint16_t index(fShmRtClientControl.readUShort());
+                    case kPluginBridgeRtClientQuit:
+                        quitReceived = true;
+                        signalThreadShouldExit();
+                        break;
 
-                    if (EngineEvent* const event = getNextFreeInputEvent())
-                    {
-                        event->type    = kEngineEventTypeControl;
-                        event->time    = time;
-                        event->channel = channel;
-                        event->ctrl.type  = kEngineControlEventTypeMidiProgram;
-                        event->ctrl.param = index;
-                        event->ctrl.value = 0.0f;
+                    default:
+                        target->handleRtData(opcode);
+                        break;
                     }
-                    break;
                 }
+            }
 
-                case kPluginBridgeRtClientControlEventAllSoundOff: {
-                    const uint32_t time(fShmRtClientControl.readUInt());
-                    const uint8_t  channel(fShmRtClientControl.readByte());
+            fShmRtClientControl.postClient();
+        }
 
-                    if (EngineEvent* const event = getNextFreeInputEvent())
-                    {
-                        event->type    = kEngineEventTypeControl;
-                        event->time    = time;
-                        event->channel = channel;
-                        event->ctrl.type  = kEngineControlEventTypeAllSoundOff;
-                        event->ctrl.param = 0;
-                        event->ctrl.value = 0.0f;
-                    }
-                }   break;
+        callback(ENGINE_CALLBACK_ENGINE_STOPPED, 0, 0, 0, 0.0f, nullptr);
 
-                case kPluginBridgeRtClientControlEventAllNotesOff: {
-                    const uint32_t time(fShmRtClientControl.readUInt());
-                    const uint8_t  channel(fShmRtClientControl.readByte());
+        if (! quitReceived)
+        {
+            const char* const message("Plugin bridge error, process thread has stopped");
+            const std::size_t messageSize(std::strlen(message));
 
-                    if (EngineEvent* const event = getNextFreeInputEvent())
-                    {
-                        event->type    = kEngineEventTypeControl;
-                        event->time    = time;
-                        event->channel = channel;
-                        event->ctrl.type  = kEngineControlEventTypeAllNotesOff;
-                        event->ctrl.param = 0;
-                        event->ctrl.value = 0.0f;
-                    }
-                }   break;
+            const CarlaMutexLocker _cml(fShmNonRtServerControl.mutex);
+            fShmNonRtServerControl.writeOpcode(kPluginBridgeNonRtServerError);
+            fShmNonRtServerControl.writeUInt(messageSize);
+            fShmNonRtServerControl.writeCustomData(message, messageSize);
+            fShmNonRtServerControl.commitWrite();
+        }
+    }
 
-                case kPluginBridgeRtClientMidiEvent: {
-                    const uint32_t time(fShmRtClientControl.readUInt());
-                    const uint8_t  port(fShmRtClientControl.readByte());
-                    const uint8_t  size(fShmRtClientControl.readByte());
-                    CARLA_SAFE_ASSERT_BREAK(size > 0);
+    // called from process thread above, reads the opcode payload from our own mapping of the shared channel
+    void handleRtData(const PluginBridgeRtClientOpcode opcode)
+    {
+        CarlaPlugin* const plugin(pData->plugins[0].plugin);
 
-                    uint8_t data[size];
+        switch (opcode)
+        {
+        case kPluginBridgeRtClientNull:
+            break;
 
-                    for (uint8_t i=0; i<size; ++i)
-                        data[i] = fShmRtClientControl.readByte();
+        case kPluginBridgeRtClientSetAudioPool: {
+            const uint64_t poolSize(fShmRtClientControl.readULong());
+            CARLA_SAFE_ASSERT_BREAK(poolSize > 0);
+            fShmAudioPool.data = (float*)jackbridge_shm_map(fShmAudioPool.shm, static_cast<size_t>(poolSize));
+            break;
+        }
 
-                    if (EngineEvent* const event = getNextFreeInputEvent())
-                    {
-                        event->type    = kEngineEventTypeMidi;
-                        event->time    = time;
-                        event->channel = MIDI_GET_CHANNEL_FROM_DATA(data);
-
-                        event->midi.port = port;
-                        event->midi.size = size;
-
-                        if (size > EngineMidiEvent::kDataSize)
-                        {
-                            event->midi.dataExt = data;
-                            std::memset(event->midi.data, 0, sizeof(uint8_t)*EngineMidiEvent::kDataSize);
-                        }
-                        else
-                        {
-                            event->midi.data[0] = MIDI_GET_STATUS_FROM_DATA(data);
-
-                            uint8_t i=1;
-                            for (; i < size; ++i)
-                                event->midi.data[i] = data[i];
-                            for (; i < EngineMidiEvent::kDataSize; ++i)
-                                event->midi.data[i] = 0;
-
-                            event->midi.dataExt = nullptr;
-                        }
-                    }
-                    break;
+        case kPluginBridgeRtClientControlEventParameter: {
+            const uint32_t time(fShmRtClientControl.readUInt());
+            const uint8_t  channel(fShmRtClientControl.readByte());
+            const uint16_t param(fShmRtClientControl.readUShort());
+            const float    value(fShmRtClientControl.readFloat());
+
+            if (EngineEvent* const event = getNextFreeInputEvent())
+            {
+                event->type    = kEngineEventTypeControl;
+                event->time    = time;
+                event->channel = channel;
+                event->ctrl.type  = kEngineControlEventTypeParameter;
+                event->ctrl.param = param;
+                event->ctrl.value = value;
+            }
+            break;
+        }
+
+        case kPluginBridgeRtClientControlEventMidiBank: {
+            const uint32_t time(fShmRtClientControl.readUInt());
+            const uint8_t  channel(fShmRtClientControl.readByte());
+            const uint16_t index(fShmRtClientControl.readUShort());
+
+            if (EngineEvent* const event = getNextFreeInputEvent())
+            {
+                event->type    = kEngineEventTypeControl;
+                event->time    = time;
+                event->channel = channel;
+                event->ctrl.type  = kEngineControlEventTypeMidiBank;
+                event->ctrl.param = index;
+                event->ctrl.value = 0.0f;
+            }
+            break;
+        }
+
+        case kPluginBridgeRtClientControlEventMidiProgram: {
+            const uint32_t time(fShmRtClientControl.readUInt());
+            const uint8_t  channel(fShmRtClientControl.readByte());
+            const uint16_t index(fShmRtClientControl.readUShort());
+
+            if (EngineEvent* const event = getNextFreeInputEvent())
+            {
+                event->type    = kEngineEventTypeControl;
+                event->time    = time;
+                event->channel = channel;
+                event->ctrl.type  = kEngineControlEventTypeMidiProgram;
+                event->ctrl.param = index;
+                event->ctrl.value = 0.0f;
+            }
+            break;
+        }
+
+        case kPluginBridgeRtClientControlEventAllSoundOff: {
+            const uint32_t time(fShmRtClientControl.readUInt());
+            const uint8_t  channel(fShmRtClientControl.readByte());
+
+            if (EngineEvent* const event = getNextFreeInputEvent())
+            {
+                event->type    = kEngineEventTypeControl;
+                event->time    = time;
+                event->channel = channel;
+                event->ctrl.type  = kEngineControlEventTypeAllSoundOff;
+                event->ctrl.param = 0;
+                event->ctrl.value = 0.0f;
+            }
+        }   break;
+
+        case kPluginBridgeRtClientControlEventAllNotesOff: {
+            const uint32_t time(fShmRtClientControl.readUInt());
+            const uint8_t  channel(fShmRtClientControl.readByte());
+
+            if (EngineEvent* const event = getNextFreeInputEvent())
+            {
+                event->type    = kEngineEventTypeControl;
+                event->time    = time;
+                event->channel = channel;
+                event->ctrl.type  = kEngineControlEventTypeAllNotesOff;
+                event->ctrl.param = 0;
+                event->ctrl.value = 0.0f;
+            }
+        }   break;
+
+        case kPluginBridgeRtClientMidiEvent: {
+            const uint32_t time(fShmRtClientControl.readUInt());
+            const uint8_t  port(fShmRtClientControl.readByte());
+            const uint8_t  size(fShmRtClientControl.readByte());
+            CARLA_SAFE_ASSERT_BREAK(size > 0);
+
+            uint8_t data[kBridgeMidiEventMaxSize];
+
+            for (uint8_t i=0; i<size; ++i)
+                data[i] = fShmRtClientControl.readByte();
+
+            // data is gone after this block, long messages need a copy that lasts until process
+            const uint8_t* dataExt = nullptr;
+
+            if (size > EngineMidiEvent::kDataSize)
+            {
+                dataExt = pData->events.dataExt.copy(data, size);
+                CARLA_SAFE_ASSERT_BREAK(dataExt != nullptr);
+            }
+
+            if (EngineEvent* const event = getNextFreeInputEvent())
+            {
+                event->type    = kEngineEventTypeMidi;
+                event->time    = time;
+                event->channel = MIDI_GET_CHANNEL_FROM_DATA(data);
+
+                event->midi.port = port;
+                event->midi.size = size;
+
+                if (dataExt != nullptr)
+                {
+                    event->midi.dataExt = dataExt;
+                    std::memset(event->midi.data, 0, sizeof(uint8_t)*EngineMidiEvent::kDataSize);
                 }
+                else
+                {
+                    event->midi.data[0] = MIDI_GET_STATUS_FROM_DATA(data);
 
-                case kPluginBridgeRtClientProcess: {
-                    CARLA_SAFE_ASSERT_BREAK(fShmAudioPool.data != nullptr);
+                    uint8_t i=1;
+                    for (; i < size; ++i)
+                        event->midi.data[i] = data[i];
+                    for (; i < EngineMidiEvent::kDataSize; ++i)
+                        event->midi.data[i] = 0;
 
-                    if (plugin != nullptr && plugin->isEnabled() && plugin->tryLock(false))
-                    {
-                        const BridgeTimeInfo& bridgeTimeInfo(fShmRtClientControl.data->timeInfo);
-
-                        const uint32_t audioInCount(plugin->getAudioInCount());
-                        const uint32_t audioOutCount(plugin->getAudioOutCount());
-                        const uint32_t cvInCount(plugin->getCVInCount());
-                        const uint32_t cvOutCount(plugin->getCVOutCount());
-
-                        const float* audioIn[audioInCount];
-                        /* */ float* audioOut[audioOutCount];
-                        const float* cvIn[cvInCount];
-                        /* */ float* cvOut[cvOutCount];
-
-                        float* fdata = fShmAudioPool.data;
-
-                        for (uint32_t i=0; i < audioInCount; ++i, fdata += pData->bufferSize)
-                            audioIn[i] = fdata;
-                        for (uint32_t i=0; i < audioOutCount; ++i, fdata += pData->bufferSize)
-                            audioOut[i] = fdata;
-
-                        for (uint32_t i=0; i < cvInCount; ++i, fdata += pData->bufferSize)
-                            cvIn[i] = fdata;
-                        for (uint32_t i=0; i < cvOutCount; ++i, fdata += pData->bufferSize)
-                            cvOut[i] = fdata;
-
-                        EngineTimeInfo& timeInfo(pData->timeInfo);
-
-                        timeInfo.playing = bridgeTimeInfo.playing;
-                        timeInfo.frame   = bridgeTimeInfo.frame;
-                        timeInfo.usecs   = bridgeTimeInfo.usecs;
-                        timeInfo.valid   = bridgeTimeInfo.valid;
-
-                        if (timeInfo.valid & EngineTimeInfo::kValidBBT)
-                        {
-                            timeInfo.bbt.bar  = bridgeTimeInfo.bar;
-                            timeInfo.bbt.beat = bridgeTimeInfo.beat;
-                            timeInfo.bbt.tick = bridgeTimeInfo.tick;
-
-                            timeInfo.bbt.beatsPerBar = bridgeTimeInfo.beatsPerBar;
-                            timeInfo.bbt.beatType    = bridgeTimeInfo.beatType;
-
-                            timeInfo.bbt.ticksPerBeat   = bridgeTimeInfo.ticksPerBeat;
-                            timeInfo.bbt.beatsPerMinute = bridgeTimeInfo.beatsPerMinute;
-                            timeInfo.bbt.barStartTick   = bridgeTimeInfo.barStartTick;
-                        }
-
-                        plugin->initBuffers();
-                        plugin->process(audioIn, audioOut, cvIn, cvOut, pData->bufferSize);
-                        plugin->unlock();
-                    }
+                    event->midi.dataExt = nullptr;
+                }
+            }
+            break;
+        }
 
-                    uint8_t* midiData(fShmRtClientControl.data->midiOut);
-                    carla_zeroBytes(midiData, kBridgeRtClientDataMidiOutSize);
-                    std::size_t curMidiDataPos = 0;
+        case kPluginBridgeRtClientProcess: {
+            CARLA_SAFE_ASSERT_BREAK(fShmAudioPool.data != nullptr);
 
-                    if (pData->events.in[0].type != kEngineEventTypeNull)
-                        carla_zeroStructs(pData->events.in,  kMaxEngineEventInternalCount);
+            if (plugin != nullptr && plugin->isEnabled() && plugin->tryLock(false))
+            {
+                const BridgeTimeInfo& bridgeTimeInfo(fShmRtClientControl.data->timeInfo);
 
-                    if (pData->events.out[0].type != kEngineEventTypeNull)
-                    {
-                        for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
-                        {
-                            const EngineEvent& event(pData->events.out[i]);
+                const uint32_t audioInCount(plugin->getAudioInCount());
+                const uint32_t audioOutCount(plugin->getAudioOutCount());
+                const uint32_t cvInCount(plugin->getCVInCount());
+                const uint32_t cvOutCount(plugin->getCVOutCount());
 
-                            if (event.type == kEngineEventTypeNull)
-                                break;
+                const float* audioIn[audioInCount];
+                /* */ float* audioOut[audioOutCount];
+                const float* cvIn[cvInCount];
+                /* */ float* cvOut[cvOutCount];
 
-                            if (event.type == kEngineEventTypeControl)
-                            {
-                                uint8_t size;
-                                uint8_t data[3];
-                                event.ctrl.convertToMidiData(event.channel, size, data);
-                                CARLA_SAFE_ASSERT_CONTINUE(size > 0 && size <= 3);
+                float* fdata = fShmAudioPool.data;
 
-                                if (curMidiDataPos + 1U /* size*/ + 4U /* time */ + size >= kBridgeRtClientDataMidiOutSize)
-                                    break;
+                for (uint32_t i=0; i < audioInCount; ++i, fdata += pData->bufferSize)
+                    audioIn[i] = fdata;
+                for (uint32_t i=0; i < audioOutCount; ++i, fdata += pData->bufferSize)
+                    audioOut[i] = fdata;
 
-                                // set size
-                                *midiData++ = size;
+                for (uint32_t i=0; i < cvInCount; ++i, fdata += pData->bufferSize)
+                    cvIn[i] = fdata;
+                for (uint32_t i=0; i < cvOutCount; ++i, fdata += pData->bufferSize)
+                    cvOut[i] = fdata;
 
-                                // set time
-                                *(uint32_t*)midiData = event.time;
-                                midiData = midiData + 4;
+                EngineTimeInfo& timeInfo(pData->timeInfo);
 
-                                // set data
-                                for (uint8_t j=0; j<size; ++j)
-                                    *midiData++ = data[j];
+                timeInfo.playing = bridgeTimeInfo.playing;
+                timeInfo.frame   = bridgeTimeInfo.frame;
+                timeInfo.usecs   = bridgeTimeInfo.usecs;
+                timeInfo.valid   = bridgeTimeInfo.valid;
 
-                                curMidiDataPos += 1U /* size*/ + 4U /* time */ + size;
-                            }
-                            else if (event.type == kEngineEventTypeMidi)
-                            {
-                                const EngineMidiEvent& _midiEvent(event.midi);
+                if (timeInfo.valid & EngineTimeInfo::kValidBBT)
+                {
+                    timeInfo.bbt.bar  = bridgeTimeInfo.bar;
+                    timeInfo.bbt.beat = bridgeTimeInfo.beat;
+                    timeInfo.bbt.tick = bridgeTimeInfo.tick;
 
-                                if (curMidiDataPos + 1 /* size*/ + 4 /* time */ + _midiEvent.size >= kBridgeRtClientDataMidiOutSize)
-                                    break;
+                    timeInfo.bbt.beatsPerBar = bridgeTimeInfo.beatsPerBar;
+                    timeInfo.bbt.beatType    = bridgeTimeInfo.beatType;
 
-                                const uint8_t* const _midiData(_midiEvent.dataExt != nullptr ? _midiEvent.dataExt : _midiEvent.data);
+                    timeInfo.bbt.ticksPerBeat   = bridgeTimeInfo.ticksPerBeat;
+                    timeInfo.bbt.beatsPerMinute = bridgeTimeInfo.beatsPerMinute;
+                    timeInfo.bbt.barStartTick   = bridgeTimeInfo.barStartTick;
+                }
 
-                                // set size
-                                *midiData++ = _midiEvent.size;
+                plugin->initBuffers();
+                plugin->process(audioIn, audioOut, cvIn, cvOut, pData->bufferSize);
+                plugin->unlock();
+            }
+
+            uint8_t* midiData(getBridgeRtClientMidiOut(fShmRtClientControl.data, fGroupSlot));
+            carla_zeroBytes(midiData, kBridgeRtClientDataMidiOutSize);
+            std::size_t curMidiDataPos = 0;
+
+            clearEngineEvents(pData->events.in);
+            fNextInputEvent = 0;
 
-                                // set time
-                                *(uint32_t*)midiData = event.time;
-                                midiData = midiData + 4;
+            if (pData->events.out[0].type != kEngineEventTypeNull)
+            {
+                for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
+                {
+                    const EngineEvent& event(pData->events.out[i]);
 
-                                // set data
-                                *midiData++ = uint8_t(_midiData[0] | (event.channel & MIDI_CHANNEL_BIT));
+                    if (event.type == kEngineEventTypeNull)
+                        break;
 
-                                for (uint8_t j=1; j<_midiEvent.size; ++j)
-                                    *midiData++ = _midiData[j];
+                    if (event.type == kEngineEventTypeControl)
+                    {
+                        uint8_t size;
+                        uint8_t data[3];
+                        event.ctrl.convertToMidiData(event.channel, size, data);
+                        CARLA_SAFE_ASSERT_CONTINUE(size > 0 && size <= 3);
 
-                                curMidiDataPos += 1U /* size*/ + 4U /* time */ + _midiEvent.size;
-                            }
-                        }
+                        if (curMidiDataPos + 1U /* size*/ + 4U /* time */ + size >= kBridgeRtClientDataMidiOutSize)
+                            break;
 
-                        carla_zeroStructs(pData->events.out, kMaxEngineEventInternalCount);
+                        // set size
+                        *midiData++ = size;
+
+                        // set time
+                        *(uint32_t*)midiData = event.time;
+                        midiData = midiData + 4;
+
+                        // set data
+                        for (uint8_t j=0; j<size; ++j)
+                            *midiData++ = data[j];
+
+                        curMidiDataPos += 1U /* size*/ + 4U /* time */ + size;
                     }
+                    else if (event.type == kEngineEventTypeMidi)
+                    {
+                        const EngineMidiEvent& _midiEvent(event.midi);
+
+                        // the size is sent as a single byte
+                        if (_midiEvent.size > 0xFF)
+                            continue;
 
-                }   break;
+                        if (curMidiDataPos + 1 /* size*/ + 4 /* time */ + _midiEvent.size >= kBridgeRtClientDataMidiOutSize)
+                            break;
 
-                case kPluginBridgeRtClientQuit: {
-                    quitReceived = true;
-                    signalThreadShouldExit();
-                }   break;
+                        const uint8_t* const _midiData(_midiEvent.dataExt != nullptr ? _midiEvent.dataExt : _midiEvent.data);
+
+                        // set size
+                        *midiData++ = static_cast<uint8_t>(_midiEvent.size);
+
+                        // set time
+                        *(uint32_t*)midiData = event.time;
+                        midiData = midiData + 4;
+
+                        // set data
+                        *midiData++ = uint8_t(_midiData[0] | (event.channel & MIDI_CHANNEL_BIT));
+
+                        for (uint8_t j=1; j<_midiEvent.size; ++j)
+                            *midiData++ = _midiData[j];
+
+                        curMidiDataPos += 1U /* size*/ + 4U /* time */ + _midiEvent.size;
+                    }
                 }
+
+                clearEngineEvents(pData->events.out);
             }
 
-            fShmRtClientControl.postClient();
+            pData->events.dataExt.reset();
+
+        }   break;
+
+        // handled by the process thread directly
+        case kPluginBridgeRtClientQuit:
+        case kPluginBridgeRtClientSetPlugin:
+        case kPluginBridgeRtClientChainAudio:
+            break;
         }
+    }
 
-        callback(ENGINE_CALLBACK_ENGINE_STOPPED, 0, 0, 0, 0.0f, nullptr);
+    // called from process thread above, copies the audio outputs of a group member into our inputs
+    void chainAudioFrom(CarlaEngineBridge* const source) noexcept
+    {
+        CarlaPlugin* const plugin(pData->plugins[0].plugin);
+        CARLA_SAFE_ASSERT_RETURN(plugin != nullptr,);
+        CARLA_SAFE_ASSERT_RETURN(fShmAudioPool.data != nullptr,);
 
-        if (! quitReceived)
+        const uint32_t bufferSize(pData->bufferSize);
+        const uint32_t audioInCount(plugin->getAudioInCount());
+        uint32_t i = 0;
+
+        if (source != nullptr && source->fShmAudioPool.data != nullptr && source->pData->bufferSize == bufferSize)
         {
-            const char* const message("Plugin bridge error, process thread has stopped");
-            const std::size_t messageSize(std::strlen(message));
+            if (CarlaPlugin* const sourcePlugin = source->pData->plugins[0].plugin)
+            {
+                const float* const sourceOut(source->fShmAudioPool.data + sourcePlugin->getAudioInCount()*bufferSize);
+                const uint32_t count(std::min(audioInCount, sourcePlugin->getAudioOutCount()));
 
-            const CarlaMutexLocker _cml(fShmNonRtServerControl.mutex);
-            fShmNonRtServerControl.writeOpcode(kPluginBridgeNonRtServerError);
-            fShmNonRtServerControl.writeUInt(messageSize);
-            fShmNonRtServerControl.writeCustomData(message, messageSize);
-            fShmNonRtServerControl.commitWrite();
+                for (; i < count; ++i)
+                    carla_copyFloats(fShmAudioPool.data + i*bufferSize, sourceOut + i*bufferSize, bufferSize);
+            }
         }
+
+        for (; i < audioInCount; ++i)
+            carla_zeroFloats(fShmAudioPool.data + i*bufferSize, bufferSize);
     }
 
     // called from process thread above
-    EngineEvent* getNextFreeInputEvent() const noexcept
+    EngineEvent* getNextFreeInputEvent() noexcept
     {
-        for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
-        {
-            EngineEvent* const event(&pData->events.in[i]);
+        if (fNextInputEvent >= kMaxEngineEventInternalCount)
+            return nullptr;
 
-            if (event->type == kEngineEventTypeNull)
-                return event;
-        }
-        return nullptr;
+        EngineEvent* const event(&pData->events.in[fNextInputEvent++]);
+        terminateEngineEvents(pData->events.in, fNextInputEvent);
+        return event;
     }
 
     // -------------------------------------------------------------------
@@ -1543,10 +2024,22 @@ private:
     BridgeRtClientControl    fShmRtClientControl;
     BridgeNonRtClientControl fShmNonRtClientControl;
     BridgeNonRtServerControl fShmNonRtServerControl;
+    BridgeChunkPool          fShmChunkPool;
+
+    // chunk being received in pieces
+    std::vector<uint8_t> fChunkBuffer;
 
     bool fIsOffline;
     bool fFirstIdle;
     int64_t fLastPingTime;
+    ushort fNextInputEvent;
+
+    // when hosting a group, the owner has no plugin and dispatches the shared rt channel to its members
+    CarlaEngineBridge* const fGroupOwner;
+    const uint fGroupSlot;
+    bool fGroupClosing;
+    CarlaMutex fGroupMutex;
+    CarlaEngineBridge* fGroupMembers[kPluginBridgeGroupMaxPlugins];
 
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaEngineBridge)
 };
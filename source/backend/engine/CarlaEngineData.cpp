@@ -19,6 +19,8 @@
 #include "CarlaMathUtils.hpp"
 #include "CarlaMIDI.h"
 
+#include <cstddef>
+
 CARLA_BACKEND_START_NAMESPACE
 
 // -----------------------------------------------------------------------
@@ -84,7 +86,14 @@ void EngineControlEvent::convertToMidiData(const uint8_t channel, uint8_t& size,
 // -----------------------------------------------------------------------
 // EngineEvent
 
-void EngineEvent::fillFromMidiData(const uint8_t size, const uint8_t* const data, const uint8_t midiPortOffset) noexcept
+// Built into the engine and the plugin bridges, so a layout change fails on both sides.
+// EngineMidiEvent::size is 16 bits wide since long MIDI messages are supported, which moved 'data' from offset 2 to 4;
+// code built against the older 8-bit layout reads wrong sizes and data.
+static_assert(offsetof(EngineMidiEvent, size) == 2, "EngineMidiEvent layout changed, this breaks the ABI");
+static_assert(offsetof(EngineMidiEvent, data) == 4, "EngineMidiEvent layout changed, this breaks the ABI");
+static_assert(sizeof(EngineEvent) == (sizeof(void*) == 8 ? 32 : 24), "EngineEvent size changed, this breaks the ABI");
+
+void EngineEvent::fillFromMidiData(const uint16_t size, const uint8_t* const data, const uint8_t midiPortOffset) noexcept
 {
     if (size == 0 || data == nullptr || data[0] < MIDI_STATUS_NOTE_OFF)
     {
@@ -93,6 +102,9 @@ void EngineEvent::fillFromMidiData(const uint8_t size, const uint8_t* const data
         return;
     }
 
+    // event buffers are not cleared between cycles, don't leave a stale type behind on error
+    type = kEngineEventTypeNull;
+
     // get channel
     channel = uint8_t(MIDI_GET_CHANNEL_FROM_DATA(data));
 
@@ -103,8 +115,6 @@ void EngineEvent::fillFromMidiData(const uint8_t size, const uint8_t* const data
     {
         CARLA_SAFE_ASSERT_RETURN(size >= 2,);
 
-        type = kEngineEventTypeControl;
-
         const uint8_t midiControl(data[1]);
 
         if (MIDI_IS_CONTROL_BANK_SELECT(midiControl))
@@ -113,18 +123,21 @@ void EngineEvent::fillFromMidiData(const uint8_t size, const uint8_t* const data
 
             const uint8_t midiBank(data[2]);
 
+            type       = kEngineEventTypeControl;
             ctrl.type  = kEngineControlEventTypeMidiBank;
             ctrl.param = midiBank;
             ctrl.value = 0.0f;
         }
         else if (midiControl == MIDI_CONTROL_ALL_SOUND_OFF)
         {
+            type       = kEngineEventTypeControl;
             ctrl.type  = kEngineControlEventTypeAllSoundOff;
             ctrl.param = 0;
             ctrl.value = 0.0f;
         }
         else if (midiControl == MIDI_CONTROL_ALL_NOTES_OFF)
         {
+            type       = kEngineEventTypeControl;
             ctrl.type  = kEngineControlEventTypeAllNotesOff;
             ctrl.param = 0;
             ctrl.value = 0.0f;
@@ -135,6 +148,7 @@ void EngineEvent::fillFromMidiData(const uint8_t size, const uint8_t* const data
 
             const uint8_t midiValue(carla_fixedValue<uint8_t>(0, 127, data[2])); // ensures 0.0<->1.0 value range
 
+            type       = kEngineEventTypeControl;
             ctrl.type  = kEngineControlEventTypeParameter;
             ctrl.param = midiControl;
             ctrl.value = float(midiValue)/127.0f;
@@ -215,7 +229,16 @@ EngineOptions::EngineOptions() noexcept
       binaryDir(nullptr),
       resourceDir(nullptr),
       preventBadBehaviour(false),
-      frontendWinId(0) {}
+      frontendWinId(0),
+      processWorkers(0),
+      rackPipelineStages(1),
+      bridgesSpinTime(0),
+      bridgesGroupSize(1),
+      batchParameterChanges(false),
+      projectLoadThreads(0),
+      sidecarMinSize(0),
+      bridgesDeadline(0),
+      offlineRenderFrames(0) {}
 
 EngineOptions::~EngineOptions() noexcept
 {
@@ -333,6 +356,52 @@ bool EngineTimeInfo::operator!=(const EngineTimeInfo& timeInfo) const noexcept
     return !operator==(timeInfo);
 }
 
+// -----------------------------------------------------------------------
+// EnginePluginDspStats
+
+EnginePluginDspStats::EnginePluginDspStats() noexcept
+    : count(0),
+      minTime(0.0f),
+      avgTime(0.0f),
+      maxTime(0.0f),
+      p99Time(0.0f),
+      load(0.0f) {}
+
+void EnginePluginDspStats::clear() noexcept
+{
+    count   = 0;
+    minTime = 0.0f;
+    avgTime = 0.0f;
+    maxTime = 0.0f;
+    p99Time = 0.0f;
+    load    = 0.0f;
+}
+
+// -----------------------------------------------------------------------
+// EngineWorkerStats
+
+EngineWorkerStats::EngineWorkerStats() noexcept
+    : jobs(0),
+      dropped(0),
+      queueDepth(0),
+      maxQueueDepth(0),
+      avgLatency(0.0f),
+      maxLatency(0.0f),
+      avgJobTime(0.0f),
+      maxJobTime(0.0f) {}
+
+void EngineWorkerStats::clear() noexcept
+{
+    jobs          = 0;
+    dropped       = 0;
+    queueDepth    = 0;
+    maxQueueDepth = 0;
+    avgLatency    = 0.0f;
+    maxLatency    = 0.0f;
+    avgJobTime    = 0.0f;
+    maxJobTime    = 0.0f;
+}
+
 // -----------------------------------------------------------------------
 
 CARLA_BACKEND_END_NAMESPACE
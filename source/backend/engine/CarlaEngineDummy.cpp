@@ -0,0 +1,353 @@
+/*
+ * Carla Plugin Host
+ * Copyright (C) 2011-2015 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#include "CarlaEngineGraph.hpp"
+#include "CarlaEngineInternal.hpp"
+#include "CarlaBackendUtils.hpp"
+#include "CarlaRtMemPool.hpp"
+#include "CarlaThread.hpp"
+
+#include "juce_audio_formats.h"
+
+using juce::AudioFormatWriter;
+using juce::AudioSampleBuffer;
+using juce::File;
+using juce::FileOutputStream;
+using juce::FloatVectorOperations;
+using juce::ScopedPointer;
+using juce::StringPairArray;
+using juce::Time;
+using juce::WavAudioFormat;
+
+CARLA_BACKEND_START_NAMESPACE
+
+// -------------------------------------------------------------------------------------------------------------------
+// Render statistics, block times are grouped in steps of 10% of the buffer period
+
+struct DummyRenderStats {
+    static const uint kHistogramSize = 11;
+
+    uint64_t blocks;
+    uint64_t frames;
+    uint64_t deadlineMisses;
+    uint64_t histogram[kHistogramSize];
+    double   deadline;
+    double   minTime;
+    double   maxTime;
+    double   totalTime;
+    double   wallTime;
+
+    DummyRenderStats() noexcept
+    {
+        clear(1.0);
+    }
+
+    void clear(const double bufferTime) noexcept
+    {
+        blocks         = 0;
+        frames         = 0;
+        deadlineMisses = 0;
+        deadline       = bufferTime;
+        minTime        = 0.0;
+        maxTime        = 0.0;
+        totalTime      = 0.0;
+        wallTime       = 0.0;
+        carla_zeroStructs(histogram, kHistogramSize);
+    }
+
+    void add(const double blockTime, const uint32_t blockFrames) noexcept
+    {
+        if (blocks == 0 || blockTime < minTime)
+            minTime = blockTime;
+        if (blockTime > maxTime)
+            maxTime = blockTime;
+
+        ++blocks;
+        frames    += blockFrames;
+        totalTime += blockTime;
+
+        if (blockTime > deadline)
+        {
+            ++deadlineMisses;
+            ++histogram[kHistogramSize-1];
+            return;
+        }
+
+        const uint index(static_cast<uint>(blockTime / deadline * 10.0));
+        ++histogram[index < kHistogramSize-1 ? index : kHistogramSize-2];
+    }
+
+    // average block time, in percent of the buffer period
+    double getAverageLoad() const noexcept
+    {
+        if (blocks == 0)
+            return 0.0;
+
+        return totalTime / static_cast<double>(blocks) / deadline * 100.0;
+    }
+
+    void print(const double sampleRate) const noexcept
+    {
+        if (blocks == 0 || wallTime <= 0.0)
+        {
+            carla_stdout("Offline render: no blocks processed");
+            return;
+        }
+
+        const double audioTime(static_cast<double>(frames) / sampleRate);
+
+        carla_stdout("Offline render: %llu blocks, %.3fs of audio in %.3fs, realtime factor %.2fx",
+                     static_cast<unsigned long long>(blocks), audioTime, wallTime, audioTime / wallTime);
+        carla_stdout("Block time (us): min %.1f, avg %.1f, max %.1f, deadline %.1f, missed %llu (%.2f%%)",
+                     minTime * 1000000.0, totalTime / static_cast<double>(blocks) * 1000000.0, maxTime * 1000000.0,
+                     deadline * 1000000.0, static_cast<unsigned long long>(deadlineMisses),
+                     static_cast<double>(deadlineMisses) * 100.0 / static_cast<double>(blocks));
+
+        for (uint i=0; i < kHistogramSize-1; ++i)
+            carla_stdout("  %3u-%3u%% : %llu", i*10, i*10+10, static_cast<unsigned long long>(histogram[i]));
+
+        carla_stdout("     >100%% : %llu", static_cast<unsigned long long>(histogram[kHistogramSize-1]));
+    }
+};
+
+// -------------------------------------------------------------------------------------------------------------------
+// Dummy/Offline Engine, renders the internal graph as fast as possible from its own thread while transport is playing
+
+class CarlaEngineDummy : public CarlaEngine,
+                         public CarlaThread
+{
+public:
+    CarlaEngineDummy()
+        : CarlaEngine(),
+          CarlaThread("CarlaEngineDummy"),
+          fAudioIns(),
+          fAudioOuts(),
+          fWriter(),
+          fStats()
+    {
+        carla_debug("CarlaEngineDummy::CarlaEngineDummy()");
+
+        // just to make sure
+        pData->options.transportMode = ENGINE_TRANSPORT_MODE_INTERNAL;
+    }
+
+    ~CarlaEngineDummy() override
+    {
+        CARLA_SAFE_ASSERT(! isThreadRunning());
+        carla_debug("CarlaEngineDummy::~CarlaEngineDummy()");
+    }
+
+    // -------------------------------------
+
+    bool init(const char* const clientName) override
+    {
+        CARLA_SAFE_ASSERT_RETURN(clientName != nullptr && clientName[0] != '\0', false);
+        carla_debug("CarlaEngineDummy::init(\"%s\")", clientName);
+
+        if (pData->options.processMode != ENGINE_PROCESS_MODE_CONTINUOUS_RACK && pData->options.processMode != ENGINE_PROCESS_MODE_PATCHBAY)
+        {
+            setLastError("Invalid process mode");
+            return false;
+        }
+
+        if (pData->options.audioBufferSize == 0 || pData->options.audioSampleRate <= 0)
+        {
+            setLastError("Invalid buffer size or sample rate");
+            return false;
+        }
+
+        if (! pData->init(clientName))
+        {
+            close();
+            setLastError("Failed to init internal data");
+            return false;
+        }
+
+        pData->bufferSize = pData->options.audioBufferSize;
+        pData->sampleRate = pData->options.audioSampleRate;
+
+        fAudioIns.setSize(2, static_cast<int>(pData->bufferSize));
+        fAudioOuts.setSize(2, static_cast<int>(pData->bufferSize));
+        fAudioIns.clear();
+
+        // the device name is the output file, render to nowhere if not a wav file
+        const char* const outputFile(pData->options.audioDevice);
+
+        if (outputFile != nullptr && File::isAbsolutePath(outputFile) && File(outputFile).hasFileExtension(".wav"))
+        {
+            File file(outputFile);
+            file.deleteFile();
+
+            if (FileOutputStream* const stream = file.createOutputStream())
+            {
+                WavAudioFormat wav;
+                fWriter = wav.createWriterFor(stream, pData->sampleRate, 2, 32, StringPairArray(), 0);
+
+                if (fWriter == nullptr)
+                    delete stream;
+            }
+
+            if (fWriter == nullptr)
+            {
+                close();
+                setLastError("Failed to open output file");
+                return false;
+            }
+        }
+
+        pData->graph.create(2, 2);
+        pData->graph.setOffline(true);
+
+        // the thread only serves plugin actions until transport starts
+        startThread();
+
+        callback(ENGINE_CALLBACK_ENGINE_STARTED, 0, pData->options.processMode, pData->options.transportMode, 0.0f, getCurrentDriverName());
+        return true;
+    }
+
+    bool close() override
+    {
+        carla_debug("CarlaEngineDummy::close()");
+
+        // stop render thread first
+        stopThread(-1);
+
+        // clear engine data
+        CarlaEngine::close();
+
+        pData->graph.destroy();
+
+        fWriter = nullptr;
+
+        return true;
+    }
+
+    bool isRunning() const noexcept override
+    {
+        return isThreadRunning();
+    }
+
+    bool isOffline() const noexcept override
+    {
+        return true;
+    }
+
+    EngineType getType() const noexcept override
+    {
+        return kEngineTypeDummy;
+    }
+
+    const char* getCurrentDriverName() const noexcept override
+    {
+        return "Offline";
+    }
+
+    // -------------------------------------------------------------------
+
+protected:
+    void run() override
+    {
+        for (; ! shouldThreadExit();)
+        {
+            if (! pData->time.playing)
+            {
+                pData->doNextPluginAction(true);
+                carla_msleep(1);
+                continue;
+            }
+
+            render(pData->options.offlineRenderFrames);
+        }
+
+        CarlaRtMemPool::releaseAllThreadCaches();
+    }
+
+    // render 'frames' frames, or until the thread is stopped if 0, then pause transport and report
+    void render(const uint32_t frames)
+    {
+        const uint32_t nframes(pData->bufferSize);
+
+        const float* inBuf[2] = { fAudioIns.getReadPointer(0), fAudioIns.getReadPointer(1) };
+        /* */ float* outBuf[2] = { fAudioOuts.getWritePointer(0), fAudioOuts.getWritePointer(1) };
+
+        fStats.clear(static_cast<double>(nframes) / pData->sampleRate);
+
+        const int64_t renderStart(Time::getHighResolutionTicks());
+
+        for (uint32_t framesLeft = frames; ! shouldThreadExit();)
+        {
+            const int64_t blockStart(Time::getHighResolutionTicks());
+
+            {
+                const PendingRtEventsRunner prt(this);
+
+                fAudioOuts.clear();
+
+                clearEngineEvents(pData->events.in);
+                clearEngineEvents(pData->events.out);
+                pData->events.dataExt.reset();
+
+                pData->graph.process(pData, inBuf, outBuf, nframes);
+            }
+
+            // whole blocks are processed, only the requested frames are kept
+            const uint32_t blockFrames((frames != 0 && framesLeft < nframes) ? framesLeft : nframes);
+
+            fStats.add(Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - blockStart), blockFrames);
+
+            if (fWriter != nullptr)
+                fWriter->writeFromFloatArrays(outBuf, 2, static_cast<int>(blockFrames));
+
+            if (frames != 0 && (framesLeft -= blockFrames) == 0)
+                break;
+        }
+
+        fStats.wallTime = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - renderStart);
+
+        if (fWriter != nullptr)
+            fWriter->flush();
+
+        pData->time.playing = false;
+
+        fStats.print(pData->sampleRate);
+        callback(ENGINE_CALLBACK_OFFLINE_RENDER_FINISHED, 0,
+                 static_cast<int>(fStats.blocks), static_cast<int>(fStats.deadlineMisses),
+                 static_cast<float>(fStats.getAverageLoad()), nullptr);
+    }
+
+    // -------------------------------------
+
+private:
+    AudioSampleBuffer fAudioIns;
+    AudioSampleBuffer fAudioOuts;
+
+    ScopedPointer<AudioFormatWriter> fWriter;
+    DummyRenderStats fStats;
+
+    CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaEngineDummy)
+};
+
+// -----------------------------------------
+
+CarlaEngine* CarlaEngine::newDummy()
+{
+    return new CarlaEngineDummy();
+}
+
+// -----------------------------------------
+
+CARLA_BACKEND_END_NAMESPACE
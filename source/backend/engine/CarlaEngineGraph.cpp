@@ -21,6 +21,9 @@
 
 #include "CarlaMathUtils.hpp"
 #include "CarlaMIDI.h"
+#include "CarlaRtMemPool.hpp"
+#include "CarlaSemUtils.hpp"
+#include "CarlaThread.hpp"
 
 using juce::AudioPluginInstance;
 using juce::AudioProcessor;
@@ -29,6 +32,7 @@ using juce::FloatVectorOperations;
 using juce::MemoryBlock;
 using juce::PluginDescription;
 using juce::String;
+using juce::Time;
 using juce::jmin;
 using juce::jmax;
 
@@ -552,6 +556,321 @@ bool ExternalGraph::getGroupAndPortIdFromFullName(const char* const fullPortName
     return false;
 }
 
+// -----------------------------------------------------------------------
+// Graph workers, real-time threads that help the audio thread
+
+// Spins done by the audio thread while waiting for workers, before going to sleep
+static const int kGraphWorkerJoinSpinCount = 2000;
+
+// Hint to the cpu that we are busy-waiting
+static inline void graphSpinPause() noexcept
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+struct GraphWorkerCallback {
+    virtual ~GraphWorkerCallback() {}
+    virtual void workerProcess(const int workerIndex) = 0;
+};
+
+class GraphWorker : public CarlaThread
+{
+public:
+    GraphWorker(GraphWorkerCallback* const callback, juce::Atomic<int>& active, carla_sem_t& doneSem, const int index, const int cpu)
+        : CarlaThread("GraphWorker"),
+          fCallback(callback),
+          fActive(active),
+          fDoneSem(doneSem),
+          fIndex(index),
+          fCpu(cpu),
+          fSem(),
+          fPolicy(SCHED_OTHER),
+          fPriority(0),
+          fWantedPolicy(SCHED_OTHER),
+          fWantedPriority(0)
+    {
+        carla_sem_create2(fSem);
+    }
+
+    ~GraphWorker() override
+    {
+        carla_sem_destroy2(fSem);
+    }
+
+    void wake(const int policy, const int priority) noexcept
+    {
+        fWantedPolicy   = policy;
+        fWantedPriority = priority;
+        carla_sem_post(fSem);
+    }
+
+    void stop() noexcept
+    {
+        signalThreadShouldExit();
+        carla_sem_post(fSem);
+        stopThread(-1);
+    }
+
+protected:
+    void run() override
+    {
+#ifdef CARLA_OS_LINUX
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(fCpu, &cpuset);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+#endif
+
+        for (; ! shouldThreadExit();)
+        {
+            if (! carla_sem_timedwait(fSem, 1))
+                continue;
+
+            if (shouldThreadExit())
+                break;
+
+            // follow the audio thread scheduling
+            if (fWantedPriority > 0 && (fWantedPolicy != fPolicy || fWantedPriority != fPriority))
+            {
+                sched_param param;
+                param.sched_priority = fWantedPriority;
+
+                if (pthread_setschedparam(pthread_self(), fWantedPolicy, &param) == 0)
+                {
+                    fPolicy   = fWantedPolicy;
+                    fPriority = fWantedPriority;
+                }
+            }
+
+            try {
+                fCallback->workerProcess(fIndex);
+            } CARLA_SAFE_EXCEPTION("GraphWorker::run");
+
+            // the last worker to finish wakes up the audio thread
+            if (--fActive == 0)
+                carla_sem_post(fDoneSem);
+        }
+
+        // plugins may have given us memory pool caches
+        CarlaRtMemPool::releaseAllThreadCaches();
+    }
+
+private:
+    GraphWorkerCallback* const fCallback;
+    juce::Atomic<int>& fActive;
+    carla_sem_t& fDoneSem;
+    const int fIndex;
+    const int fCpu;
+    carla_sem_t fSem;
+    int fPolicy;
+    int fPriority;
+    volatile int fWantedPolicy;
+    volatile int fWantedPriority;
+
+    CARLA_DECLARE_NON_COPY_CLASS(GraphWorker)
+};
+
+struct GraphWorkerPool {
+    GraphWorker** workers;
+    int count;
+    juce::Atomic<int> active;
+
+    // posted once per wake() when all woken workers are done
+    carla_sem_t doneSem;
+    bool doneSemValid;
+    bool joinPending;
+
+    // a join gave up on the workers, they are still running the block and can't be woken up yet
+    bool stalled;
+
+    // scheduling of the audio thread
+    int policy;
+    int priority;
+
+    GraphWorkerPool(GraphWorkerCallback* const callback, const int wantedCount)
+        : workers(nullptr),
+          count(0),
+          active(),
+          doneSem(),
+          doneSemValid(false),
+          joinPending(false),
+          stalled(false),
+          policy(SCHED_OTHER),
+          priority(-1)
+    {
+        // the audio thread takes part in processing, so leave one cpu for it
+        const int numCpus(juce::SystemStats::getNumCpus());
+        const int numWorkers(jmin(wantedCount, numCpus-1));
+
+        if (numWorkers <= 0)
+            return;
+
+        doneSemValid = carla_sem_create2(doneSem);
+
+        if (! doneSemValid)
+            return;
+
+        workers = new GraphWorker*[numWorkers];
+
+        for (; count < numWorkers; ++count)
+        {
+            workers[count] = new GraphWorker(callback, active, doneSem, count, (count+1) % numCpus);
+
+            if (! workers[count]->startThread())
+            {
+                delete workers[count];
+                break;
+            }
+        }
+    }
+
+    ~GraphWorkerPool()
+    {
+        for (int i=0; i<count; ++i)
+        {
+            workers[i]->stop();
+            delete workers[i];
+        }
+
+        delete[] workers;
+        workers = nullptr;
+        count = 0;
+
+        if (doneSemValid)
+        {
+            carla_sem_destroy2(doneSem);
+            doneSemValid = false;
+        }
+    }
+
+    // true unless workers from a block that was given up on are still running, must be called from the audio thread
+    bool isReady() noexcept
+    {
+        if (! stalled)
+            return true;
+
+        if (active.get() != 0)
+            return false;
+
+        // the last worker posts right after it is done, take it so it does not end the next join early
+        if (! carla_sem_timedwait_usecs(doneSem, 100))
+            return false;
+
+        stalled = false;
+        return true;
+    }
+
+    // returns false if the workers are not ready, nothing is woken up then. must be called from the audio thread
+    bool wake(const int numToWake) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(numToWake <= count, false);
+
+        if (! isReady())
+            return false;
+        if (numToWake <= 0)
+            return true;
+
+        if (priority == -1)
+        {
+            sched_param param;
+            int curPolicy;
+
+            if (pthread_getschedparam(pthread_self(), &curPolicy, &param) == 0)
+            {
+                policy   = curPolicy;
+                priority = param.sched_priority;
+            }
+            else
+            {
+                priority = 0;
+            }
+        }
+
+        active = numToWake;
+        joinPending = true;
+
+        for (int i=0; i<numToWake; ++i)
+            workers[i]->wake(policy, priority);
+
+        return true;
+    }
+
+    // waits for the workers woken by the last wake(), must be called from the audio thread.
+    // spins for a short while, since workers usually finish with the audio thread, then sleeps.
+    // gives up after timeoutUsecs (0 waits as long as needed) and returns false, the pool is stalled until they finish
+    bool join(const uint timeoutUsecs) noexcept
+    {
+        if (! joinPending)
+            return true;
+
+        joinPending = false;
+
+        for (int i=0; i < kGraphWorkerJoinSpinCount && active.get() != 0; ++i)
+            graphSpinPause();
+
+        // the post of the last worker is always taken, so it does not wake up the next join early
+        if (timeoutUsecs == 0)
+        {
+            while (! carla_sem_timedwait(doneSem, 1)) {}
+            return true;
+        }
+
+        if (carla_sem_timedwait_usecs(doneSem, timeoutUsecs))
+            return true;
+
+        stalled = true;
+        return false;
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(GraphWorkerPool)
+};
+
+// Locks the mutex the audio thread holds while processing, once no worker of a block that was given up on
+// is still running. Workers use the processing state without the mutex, so this must be used to change it.
+// non-RT, may sleep
+class GraphWorkerIdleLocker
+{
+public:
+    GraphWorkerIdleLocker(GraphWorkerPool& pool, CarlaMutex& mutex) noexcept
+        : fMutex(mutex)
+    {
+        for (;;)
+        {
+            fMutex.lock();
+
+            if (pool.active.get() == 0)
+                break;
+
+            fMutex.unlock();
+            carla_msleep(1);
+        }
+    }
+
+    ~GraphWorkerIdleLocker() noexcept
+    {
+        fMutex.unlock();
+    }
+
+private:
+    CarlaMutex& fMutex;
+
+    CARLA_PREVENT_HEAP_ALLOCATION
+    CARLA_DECLARE_NON_COPY_CLASS(GraphWorkerIdleLocker)
+};
+
+// How long the audio thread waits for workers after its own share of a block, 0 for no limit
+static inline uint getGraphWorkerTimeout(const uint32_t frames, const double sampleRate, const bool offline) noexcept
+{
+    if (offline || sampleRate <= 0.0)
+        return 0;
+
+    return jmax(1U, static_cast<uint>(static_cast<double>(frames) * 1000000.0 / sampleRate));
+}
+
 // -----------------------------------------------------------------------
 // RackGraph Buffers
 
@@ -643,6 +962,245 @@ void RackGraph::Buffers::setBufferSize(const uint32_t bufferSize, const bool cre
     }
 }
 
+// -----------------------------------------------------------------------
+// RackGraph pipeline
+
+struct RackGraphPipeline : public GraphWorkerCallback {
+    RackGraph& kRack;
+    CarlaMutex mutex;
+    GraphWorkerPool workers;
+    int numStages;
+    uint32_t bufferSize;
+
+    // 2 states per stage, one being written while the next stage reads the other
+    RackGraph::ChainState* states;
+    uint parity;
+
+    // long MIDI messages of each state, which outlive the engine's per-cycle storage
+    EngineEventDataArena* arenas;
+
+    // plugins of each stage are in the [stageFirst[stage], stageFirst[stage+1]) range,
+    // split for splitPluginCount plugins and only changed under 'mutex' while workers are idle
+    uint* stageFirst;
+    uint splitPluginCount;
+
+    // current cycle, valid while workers are active
+    CarlaEngine::ProtectedData* data;
+    const float** inBufReal;
+    uint32_t frames;
+
+    RackGraphPipeline(RackGraph& rack, const int extraStages)
+        : kRack(rack),
+          mutex(),
+          workers(this, extraStages),
+          numStages(workers.count+1),
+          bufferSize(0),
+          states(nullptr),
+          parity(0),
+          arenas(nullptr),
+          stageFirst(new uint[numStages+1]),
+          splitPluginCount(0),
+          data(nullptr),
+          inBufReal(nullptr),
+          frames(0)
+    {
+        carla_zeroStructs(stageFirst, static_cast<std::size_t>(numStages+1));
+    }
+
+    ~RackGraphPipeline() override
+    {
+        setBufferSize(0);
+
+        delete[] stageFirst;
+        stageFirst = nullptr;
+    }
+
+    uint32_t getLatency() const noexcept
+    {
+        return static_cast<uint32_t>(numStages-1)*bufferSize;
+    }
+
+    void setBufferSize(const uint32_t newBufferSize) noexcept
+    {
+        const GraphWorkerIdleLocker gwil(workers, mutex);
+
+        if (states != nullptr)
+        {
+            for (int i=0; i<numStages*2; ++i)
+            {
+                RackGraph::ChainState& state(states[i]);
+
+                delete[] state.inBuf[0];
+                delete[] state.inBuf[1];
+                delete[] state.outBuf[0];
+                delete[] state.outBuf[1];
+                delete[] state.eventsIn;
+                delete[] state.eventsOut;
+            }
+
+            delete[] states;
+            states = nullptr;
+        }
+
+        if (arenas != nullptr)
+        {
+            delete[] arenas;
+            arenas = nullptr;
+        }
+
+        bufferSize = 0;
+        parity = 0;
+
+        if (newBufferSize == 0)
+            return;
+
+        try {
+            states = new RackGraph::ChainState[numStages*2];
+            carla_zeroStructs(states, static_cast<std::size_t>(numStages*2));
+
+            arenas = new EngineEventDataArena[numStages*2];
+
+            for (int i=0; i<numStages*2; ++i)
+                arenas[i].create(kMaxEngineEventInternalDataSize);
+
+            for (int i=0; i<numStages*2; ++i)
+            {
+                RackGraph::ChainState& state(states[i]);
+
+                state.inBuf[0]  = new float[newBufferSize];
+                state.inBuf[1]  = new float[newBufferSize];
+                state.outBuf[0] = new float[newBufferSize];
+                state.outBuf[1] = new float[newBufferSize];
+                state.eventsIn  = new EngineEvent[kMaxEngineEventInternalCount];
+                state.eventsOut = new EngineEvent[kMaxEngineEventInternalCount];
+
+                FloatVectorOperations::clear(state.inBuf[0],  static_cast<int>(newBufferSize));
+                FloatVectorOperations::clear(state.inBuf[1],  static_cast<int>(newBufferSize));
+                FloatVectorOperations::clear(state.outBuf[0], static_cast<int>(newBufferSize));
+                FloatVectorOperations::clear(state.outBuf[1], static_cast<int>(newBufferSize));
+                carla_zeroStructs(state.eventsIn,  kMaxEngineEventInternalCount);
+                carla_zeroStructs(state.eventsOut, kMaxEngineEventInternalCount);
+            }
+        } CARLA_SAFE_EXCEPTION_RETURN("RackGraphPipeline::setBufferSize",);
+
+        bufferSize = newBufferSize;
+    }
+
+    // returns false if the pipeline is not available, the caller must process serially instead
+    bool process(CarlaEngine::ProtectedData* const engineData, const float* inBuf[2], float* outBuf[2], const uint32_t numFrames)
+    {
+        const CarlaMutexTryLocker cmtl(mutex);
+
+        if (cmtl.wasNotLocked() || numFrames > bufferSize)
+            return false;
+
+        // a stage given up on is still running, plugins are processed serially until it is done
+        if (! workers.isReady())
+            return false;
+
+        // plugins were added or removed since the last cycle
+        if (engineData->curPluginCount != splitPluginCount)
+            splitStages(engineData->curPluginCount);
+
+        data      = engineData;
+        inBufReal = inBuf;
+        frames    = numFrames;
+
+        workers.wake(numStages-1);
+
+        runStage(0);
+
+        const int iframes(static_cast<int>(numFrames));
+
+        if (! workers.join(getGraphWorkerTimeout(numFrames, engineData->sampleRate, kRack.isOffline)))
+        {
+            // the late stage output is dropped
+            FloatVectorOperations::clear(outBuf[0], iframes);
+            FloatVectorOperations::clear(outBuf[1], iframes);
+            clearEngineEvents(engineData->events.out);
+
+            parity = 1 - parity;
+            return true;
+        }
+
+        const RackGraph::ChainState& last(states[(numStages-1)*2 + static_cast<int>(parity)]);
+
+        FloatVectorOperations::copy(outBuf[0], last.outBuf[0], iframes);
+        FloatVectorOperations::copy(outBuf[1], last.outBuf[1], iframes);
+        copyEngineEvents(engineData->events.out, last.eventsOut);
+
+        parity = 1 - parity;
+        return true;
+    }
+
+    void workerProcess(const int workerIndex) override
+    {
+        runStage(workerIndex+1);
+    }
+
+    // spread plugins evenly over the stages, done once per plugin count change instead of every cycle
+    void splitStages(const uint pluginCount) noexcept
+    {
+        for (int i=0; i<=numStages; ++i)
+            stageFirst[i] = pluginCount * static_cast<uint>(i) / static_cast<uint>(numStages);
+
+        splitPluginCount = pluginCount;
+    }
+
+    void runStage(const int stage)
+    {
+        RackGraph::ChainState& state(states[stage*2 + static_cast<int>(parity)]);
+        EngineEventDataArena& arena(arenas[stage*2 + static_cast<int>(parity)]);
+        const int iframes(static_cast<int>(frames));
+
+        arena.reset();
+
+        if (stage == 0)
+        {
+            FloatVectorOperations::copy(state.inBuf[0], inBufReal[0], iframes);
+            FloatVectorOperations::copy(state.inBuf[1], inBufReal[1], iframes);
+            FloatVectorOperations::clear(state.outBuf[0], iframes);
+            FloatVectorOperations::clear(state.outBuf[1], iframes);
+            copyEngineEvents(state.eventsIn, data->events.in);
+            clearEngineEvents(state.eventsOut);
+            state.oldMidiOutCount = 0;
+            state.processed = false;
+        }
+        else
+        {
+            // continue from what the previous stage did in the last cycle
+            const RackGraph::ChainState& prev(states[(stage-1)*2 + static_cast<int>(1 - parity)]);
+
+            FloatVectorOperations::copy(state.inBuf[0],  prev.inBuf[0],  iframes);
+            FloatVectorOperations::copy(state.inBuf[1],  prev.inBuf[1],  iframes);
+            FloatVectorOperations::copy(state.outBuf[0], prev.outBuf[0], iframes);
+            FloatVectorOperations::copy(state.outBuf[1], prev.outBuf[1], iframes);
+            copyEngineEvents(state.eventsIn,  prev.eventsIn);
+            copyEngineEvents(state.eventsOut, prev.eventsOut);
+            state.oldMidiOutCount = prev.oldMidiOutCount;
+            state.processed = prev.processed;
+        }
+
+        const uint first(stageFirst[stage]);
+        const uint last(stageFirst[stage+1]);
+
+        // every event port of the stage plugins picks these up in initBuffer()
+        EngineInternalEvents::stageIn  = state.eventsIn;
+        EngineInternalEvents::stageOut = state.eventsOut;
+
+        kRack.processChain(data, state, first, last, frames);
+
+        EngineInternalEvents::stageIn  = nullptr;
+        EngineInternalEvents::stageOut = nullptr;
+
+        // the next stage reads these events during the next cycle, after the engine storage is reset
+        arena.takeEvents(state.eventsIn);
+        arena.takeEvents(state.eventsOut);
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(RackGraphPipeline)
+};
+
 // -----------------------------------------------------------------------
 // RackGraph
 
@@ -652,19 +1210,42 @@ RackGraph::RackGraph(CarlaEngine* const engine, const uint32_t ins, const uint32
       outputs(outs),
       isOffline(false),
       audioBuffers(),
+      pipeline(nullptr),
       kEngine(engine)
 {
+    if (engine->getOptions().rackPipelineStages > 1)
+    {
+        try {
+            pipeline = new RackGraphPipeline(*this, static_cast<int>(engine->getOptions().rackPipelineStages)-1);
+        } CARLA_SAFE_EXCEPTION("RackGraphPipeline");
+
+        if (pipeline != nullptr && pipeline->numStages == 1)
+        {
+            delete pipeline;
+            pipeline = nullptr;
+        }
+    }
+
     setBufferSize(engine->getBufferSize());
 }
 
 RackGraph::~RackGraph() noexcept
 {
+    if (pipeline != nullptr)
+    {
+        delete pipeline;
+        pipeline = nullptr;
+    }
+
     extGraph.clear();
 }
 
 void RackGraph::setBufferSize(const uint32_t bufferSize) noexcept
 {
     audioBuffers.setBufferSize(bufferSize, (inputs > 0 || outputs > 0));
+
+    if (pipeline != nullptr)
+        pipeline->setBufferSize(bufferSize);
 }
 
 void RackGraph::setOffline(const bool offline) noexcept
@@ -672,6 +1253,11 @@ void RackGraph::setOffline(const bool offline) noexcept
     isOffline = offline;
 }
 
+uint32_t RackGraph::getLatency() const noexcept
+{
+    return (pipeline != nullptr) ? pipeline->getLatency() : 0;
+}
+
 bool RackGraph::connect(const uint groupA, const uint portA, const uint groupB, const uint portB) noexcept
 {
     return extGraph.connect(groupA, portA, groupB, portB, true);
@@ -773,12 +1359,14 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
     CARLA_SAFE_ASSERT_RETURN(data->events.in != nullptr,);
     CARLA_SAFE_ASSERT_RETURN(data->events.out != nullptr,);
 
+    if (pipeline != nullptr && pipeline->process(data, inBufReal, outBuf, frames))
+        return;
+
     const int iframes(static_cast<int>(frames));
 
     // safe copy
     float inBuf0[frames];
     float inBuf1[frames];
-    const float* inBuf[2] = { inBuf0, inBuf1 };
 
     // initialize audio inputs
     FloatVectorOperations::copy(inBuf0, inBufReal[0], iframes);
@@ -788,24 +1376,44 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
     FloatVectorOperations::clear(outBuf[0], iframes);
     FloatVectorOperations::clear(outBuf[1], iframes);
 
-    // initialize event outputs (zero)
-    carla_zeroStructs(data->events.out, kMaxEngineEventInternalCount);
+    // initialize event outputs (empty)
+    clearEngineEvents(data->events.out);
+
+    ChainState state;
+    state.inBuf[0]  = inBuf0;
+    state.inBuf[1]  = inBuf1;
+    state.outBuf[0] = outBuf[0];
+    state.outBuf[1] = outBuf[1];
+    state.eventsIn  = data->events.in;
+    state.eventsOut = data->events.out;
+    state.oldMidiOutCount = 0;
+    state.processed = false;
+
+    processChain(data, state, 0, data->curPluginCount, frames);
+}
+
+void RackGraph::processChain(CarlaEngine::ProtectedData* const data, ChainState& state, const uint first, const uint last, const uint32_t frames)
+{
+    const int iframes(static_cast<int>(frames));
+
+    float* const inBuf0(state.inBuf[0]);
+    float* const inBuf1(state.inBuf[1]);
+    const float* inBuf[2] = { inBuf0, inBuf1 };
+    float** const outBuf(state.outBuf);
 
     uint32_t oldAudioInCount  = 0;
     uint32_t oldAudioOutCount = 0;
-    uint32_t oldMidiOutCount  = 0;
-    bool processed = false;
     juce::Range<float> range;
 
     // process plugins
-    for (uint i=0; i < data->curPluginCount; ++i)
+    for (uint i=first; i < last; ++i)
     {
         CarlaPlugin* const plugin = data->plugins[i].plugin;
 
         if (plugin == nullptr || ! plugin->isEnabled() || ! plugin->tryLock(isOffline))
             continue;
 
-        if (processed)
+        if (state.processed)
         {
             // initialize audio inputs (from previous outputs)
             FloatVectorOperations::copy(inBuf0, outBuf[0], iframes);
@@ -816,9 +1424,9 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
             FloatVectorOperations::clear(outBuf[1], iframes);
 
             // if plugin has no midi out, add previous events
-            if (oldMidiOutCount == 0 && data->events.in[0].type != kEngineEventTypeNull)
+            if (state.oldMidiOutCount == 0 && state.eventsIn[0].type != kEngineEventTypeNull)
             {
-                if (data->events.out[0].type != kEngineEventTypeNull)
+                if (state.eventsOut[0].type != kEngineEventTypeNull)
                 {
                     // TODO: carefully add to input, sorted events
                 }
@@ -827,20 +1435,54 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
             else
             {
                 // initialize event inputs from previous outputs
-                carla_copyStructs(data->events.in, data->events.out, kMaxEngineEventInternalCount);
+                copyEngineEvents(state.eventsIn, state.eventsOut);
 
-                // initialize event outputs (zero)
-                carla_zeroStructs(data->events.out, kMaxEngineEventInternalCount);
+                // initialize event outputs (empty)
+                clearEngineEvents(state.eventsOut);
             }
         }
 
-        oldAudioInCount  = plugin->getAudioInCount();
-        oldAudioOutCount = plugin->getAudioOutCount();
-        oldMidiOutCount  = plugin->getMidiOutCount();
+        oldAudioInCount       = plugin->getAudioInCount();
+        oldAudioOutCount      = plugin->getAudioOutCount();
+        state.oldMidiOutCount = plugin->getMidiOutCount();
 
         // process
         plugin->initBuffers();
+
+        // bridged plugins sharing a process can run several consecutive plugins in one go
+        if ((plugin->getHints() & PLUGIN_IS_BRIDGE) != 0 && i+1 < last && state.eventsIn == data->events.in)
+        {
+            float peaks[MAX_RACK_PLUGINS*4];
+
+            const int64_t dspStart(Time::getHighResolutionTicks());
+
+            if (const uint count = plugin->processRackChain(last-i, inBuf, outBuf, peaks, frames))
+            {
+                plugin->unlock();
+
+                for (uint j=0; j < count; ++j)
+                {
+                    EnginePluginData& pluginData(data->plugins[i+j]);
+
+                    pluginData.insPeak[0]  = peaks[j*4+0];
+                    pluginData.insPeak[1]  = peaks[j*4+1];
+                    pluginData.outsPeak[0] = peaks[j*4+2];
+                    pluginData.outsPeak[1] = peaks[j*4+3];
+
+                    // the chain is a single round-trip, split its time evenly
+                    kEngine->addPluginDspTime(i+j, dspStart, count);
+                }
+
+                i += count-1;
+                state.oldMidiOutCount = data->plugins[i].plugin->getMidiOutCount();
+                state.processed = true;
+                continue;
+            }
+        }
+
+        const int64_t dspStart(Time::getHighResolutionTicks());
         plugin->process(inBuf, outBuf, nullptr, nullptr, frames);
+        kEngine->addPluginDspTime(i, dspStart);
         plugin->unlock();
 
         // if plugin has no audio inputs, add input buffer
@@ -889,7 +1531,7 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
             }
         }
 
-        processed = true;
+        state.processed = true;
     }
 }
 
@@ -1113,222 +1755,1152 @@ void removeNodeFromPatchbay(CarlaEngine* const engine, const uint32_t groupId, c
                          0, 0.0f, nullptr);
     }
 
-    if (proc->acceptsMidi())
-    {
-        engine->callback(ENGINE_CALLBACK_PATCHBAY_PORT_REMOVED, groupId, static_cast<int>(kMidiInputPortOffset),
-                         0, 0.0f, nullptr);
+    if (proc->acceptsMidi())
+    {
+        engine->callback(ENGINE_CALLBACK_PATCHBAY_PORT_REMOVED, groupId, static_cast<int>(kMidiInputPortOffset),
+                         0, 0.0f, nullptr);
+    }
+
+    if (proc->producesMidi())
+    {
+        engine->callback(ENGINE_CALLBACK_PATCHBAY_PORT_REMOVED, groupId, static_cast<int>(kMidiOutputPortOffset),
+                         0, 0.0f, nullptr);
+    }
+
+    engine->callback(ENGINE_CALLBACK_PATCHBAY_CLIENT_REMOVED, groupId, 0, 0, 0.0f, nullptr);
+}
+
+// -----------------------------------------------------------------------
+
+class CarlaPluginInstance : public AudioPluginInstance
+{
+public:
+    CarlaPluginInstance(CarlaEngine* const engine, CarlaPlugin* const plugin)
+        : kEngine(engine),
+          fPlugin(plugin),
+          fKickTime(0)
+    {
+        setPlayConfigDetails(static_cast<int>(fPlugin->getAudioInCount()),
+                             static_cast<int>(fPlugin->getAudioOutCount()),
+                             getSampleRate(), getBlockSize());
+    }
+
+    ~CarlaPluginInstance() override
+    {
+    }
+
+    void invalidatePlugin() noexcept
+    {
+        fPlugin = nullptr;
+    }
+
+    // -------------------------------------------------------------------
+
+    void* getPlatformSpecificData() noexcept override
+    {
+        return fPlugin;
+    }
+
+    void fillInPluginDescription(PluginDescription& d) const override
+    {
+        d.pluginFormatName = "Carla";
+        d.category = "Carla Plugin";
+        d.version = "1.0";
+
+        CARLA_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
+
+        char strBuf[STR_MAX+1];
+        strBuf[STR_MAX] = '\0';
+
+        fPlugin->getRealName(strBuf);
+        d.name = strBuf;
+
+        fPlugin->getLabel(strBuf);
+        d.descriptiveName = strBuf;
+
+        fPlugin->getMaker(strBuf);
+        d.manufacturerName = strBuf;
+
+        d.uid = d.name.hashCode();
+        d.isInstrument = (fPlugin->getHints() & PLUGIN_IS_SYNTH);
+
+        d.numInputChannels  = static_cast<int>(fPlugin->getAudioInCount());
+        d.numOutputChannels = static_cast<int>(fPlugin->getAudioOutCount());
+        //d.hasSharedContainer = true;
+    }
+
+    // -------------------------------------------------------------------
+
+    const String getName() const override
+    {
+        return fPlugin->getName();
+    }
+
+    void processBlock(AudioSampleBuffer& audio, MidiBuffer& midi)
+    {
+        if (fPlugin == nullptr || ! fPlugin->isEnabled())
+        {
+            audio.clear();
+            midi.clear();
+            return;
+        }
+
+        if (! fPlugin->tryLock(kEngine->isOffline()))
+        {
+            audio.clear();
+            midi.clear();
+            return;
+        }
+
+        if (! startBlock(audio, midi))
+            return;
+
+        runBlock(audio, midi, false);
+    }
+
+    // Start a bridged plugin without waiting for it, returns false if processBlock must be used instead.
+    // Otherwise collectBlock must follow, from the same thread and with the same buffers.
+    bool kickBlock(AudioSampleBuffer& audio, MidiBuffer& midi)
+    {
+        if (fPlugin == nullptr || ! fPlugin->isEnabled() || ! isBridge())
+            return false;
+
+        if (! fPlugin->tryLock(kEngine->isOffline()))
+            return false;
+
+        // midi is kept until the kick is accepted, processBlock needs it otherwise
+        if (! startBlock(audio, midi))
+            return false;
+
+        fKickTime = Time::getHighResolutionTicks();
+
+        const int numChan(audio.getNumChannels());
+        float* audioBuffers[jmax(1, numChan)];
+
+        for (int i=0; i<numChan; ++i)
+            audioBuffers[i] = audio.getWritePointer(i);
+
+        if (! fPlugin->processKick(const_cast<const float**>(audioBuffers), audioBuffers, nullptr, nullptr,
+                                   static_cast<uint32_t>(audio.getNumSamples())))
+        {
+            fPlugin->unlock();
+            return false;
+        }
+
+        midi.clear();
+        return true;
+    }
+
+    void collectBlock(AudioSampleBuffer& audio, MidiBuffer& midi)
+    {
+        runBlock(audio, midi, true);
+    }
+
+    bool isBridge() const noexcept
+    {
+        return fPlugin != nullptr && (fPlugin->getHints() & PLUGIN_IS_BRIDGE) != 0;
+    }
+
+    const String getInputChannelName(int i)  const override
+    {
+        CARLA_SAFE_ASSERT_RETURN(i >= 0, String());
+        CarlaEngineClient* const client(fPlugin->getEngineClient());
+        return client->getAudioPortName(true, static_cast<uint>(i));
+    }
+
+    const String getOutputChannelName(int i) const override
+    {
+        CARLA_SAFE_ASSERT_RETURN(i >= 0, String());
+        CarlaEngineClient* const client(fPlugin->getEngineClient());
+        return client->getAudioPortName(false, static_cast<uint>(i));
+    }
+
+    void prepareToPlay(double, int) override {}
+    void releaseResources() override {}
+
+    const String getParameterName(int)         override { return String(); }
+          String getParameterName(int, int)    override { return String(); }
+    const String getParameterText(int)         override { return String(); }
+          String getParameterText(int, int)    override { return String(); }
+    const String getProgramName(int)           override { return String(); }
+
+    double getTailLengthSeconds()        const override { return 0.0;  }
+    float  getParameter(int)                   override { return 0.0f; }
+
+    bool isInputChannelStereoPair(int)   const override { return false; }
+    bool isOutputChannelStereoPair(int)  const override { return false; }
+    bool silenceInProducesSilenceOut()   const override { return true;  }
+    bool acceptsMidi()                   const override { return fPlugin->getDefaultEventInPort()  != nullptr; }
+    bool producesMidi()                  const override { return fPlugin->getDefaultEventOutPort() != nullptr; }
+
+    void setParameter(int, float)              override {}
+    void setCurrentProgram(int)                override {}
+    void changeProgramName(int, const String&) override {}
+    void getStateInformation(MemoryBlock&)     override {}
+    void setStateInformation(const void*, int) override {}
+
+    int getNumParameters()                     override { return 0; }
+    int getNumPrograms()                       override { return 0; }
+    int getCurrentProgram()                    override { return 0; }
+
+#ifndef JUCE_AUDIO_PROCESSOR_NO_GUI
+    bool hasEditor()                     const override { return false; }
+    AudioProcessorEditor* createEditor()       override { return nullptr; }
+#endif
+
+    // -------------------------------------------------------------------
+
+private:
+    CarlaEngine* const kEngine;
+    CarlaPlugin* fPlugin;
+    int64_t fKickTime;
+
+    // plugin must be locked, midi input is given to the plugin but not cleared
+    bool startBlock(AudioSampleBuffer& audio, const MidiBuffer& midi)
+    {
+        fPlugin->initBuffers();
+
+        if (CarlaEngineEventPort* const port = fPlugin->getDefaultEventInPort())
+        {
+            EngineEvent* const engineEvents(port->fBuffer);
+            CARLA_SAFE_ASSERT_RETURN(engineEvents != nullptr, false);
+
+            clearEngineEvents(engineEvents);
+            fillEngineEventsFromJuceMidiBuffer(engineEvents, midi, kEngine->pData->events.dataExt);
+        }
+
+        // TODO - CV support
+
+        if (audio.getNumChannels() > 0 && fPlugin->getAudioInCount() == 0)
+            audio.clear();
+
+        return true;
+    }
+
+    // process, or collect a kicked plugin, then unlock it
+    void runBlock(AudioSampleBuffer& audio, MidiBuffer& midi, const bool collect)
+    {
+        midi.clear();
+
+        const int numSamples(audio.getNumSamples());
+
+        if (const int numChan = audio.getNumChannels())
+        {
+            float* audioBuffers[numChan];
+
+            for (int i=0; i<numChan; ++i)
+                audioBuffers[i] = audio.getWritePointer(i);
+
+            float inPeaks[2] = { 0.0f };
+            float outPeaks[2] = { 0.0f };
+            juce::Range<float> range;
+
+            for (int i=jmin(fPlugin->getAudioInCount(), 2U); --i>=0;)
+            {
+                range = FloatVectorOperations::findMinAndMax(audioBuffers[i], numSamples);
+                inPeaks[i] = carla_maxLimited<float>(std::abs(range.getStart()), std::abs(range.getEnd()), 1.0f);
+            }
+
+            // kicked plugins are measured from the kick
+            const int64_t dspStart(collect ? fKickTime : Time::getHighResolutionTicks());
+            if (collect)
+                fPlugin->processCollect(const_cast<const float**>(audioBuffers), audioBuffers, nullptr, nullptr, static_cast<uint32_t>(numSamples));
+            else
+                fPlugin->process(const_cast<const float**>(audioBuffers), audioBuffers, nullptr, nullptr, static_cast<uint32_t>(numSamples));
+            kEngine->addPluginDspTime(fPlugin->getId(), dspStart);
+
+            for (int i=jmin(fPlugin->getAudioOutCount(), 2U); --i>=0;)
+            {
+                range = FloatVectorOperations::findMinAndMax(audioBuffers[i], numSamples);
+                outPeaks[i] = carla_maxLimited<float>(std::abs(range.getStart()), std::abs(range.getEnd()), 1.0f);
+            }
+
+            kEngine->setPluginPeaks(fPlugin->getId(), inPeaks, outPeaks);
+        }
+        else
+        {
+            const int64_t dspStart(collect ? fKickTime : Time::getHighResolutionTicks());
+            if (collect)
+                fPlugin->processCollect(nullptr, nullptr, nullptr, nullptr, static_cast<uint32_t>(numSamples));
+            else
+                fPlugin->process(nullptr, nullptr, nullptr, nullptr, static_cast<uint32_t>(numSamples));
+            kEngine->addPluginDspTime(fPlugin->getId(), dspStart);
+        }
+
+        midi.clear();
+
+        if (CarlaEngineEventPort* const port = fPlugin->getDefaultEventOutPort())
+        {
+            /*const*/ EngineEvent* const engineEvents(port->fBuffer);
+            CARLA_SAFE_ASSERT_RETURN(engineEvents != nullptr,);
+
+            fillJuceMidiBufferFromEngineEvents(midi, engineEvents);
+            clearEngineEvents(engineEvents);
+        }
+
+        fPlugin->unlock();
+    }
+
+    CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaPluginInstance)
+};
+
+// -----------------------------------------------------------------------
+// Patchbay render plan, processed in parallel when there are workers
+
+// fixed delay on a connection, so that paths with different latencies arrive aligned
+struct PatchbayDelayLine {
+    juce::HeapBlock<float> buffer;
+    const int size;
+    int pos;
+
+    PatchbayDelayLine(const uint32_t delay)
+        : buffer(delay, true),
+          size(static_cast<int>(delay)),
+          pos(0) {}
+
+    // add 'in', delayed by 'size' frames, into 'out'
+    void process(float* const out, const float* const in, const int frames) noexcept
+    {
+        for (int done=0, chunk; done < frames; done += chunk)
+        {
+            chunk = jmin(size - pos, frames - done);
+
+            FloatVectorOperations::add(out + done, buffer + pos, chunk);
+            FloatVectorOperations::copy(buffer + pos, in + done, chunk);
+
+            if ((pos += chunk) == size)
+                pos = 0;
+        }
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(PatchbayDelayLine)
+};
+
+struct PatchbayAudioSource {
+    int destChannel;
+    int node; // -1 for graph input
+    int srcChannel;
+    PatchbayDelayLine* delay; // owned by the plan, null if not needed
+};
+
+struct PatchbayRenderNode {
+    const uint32_t nodeId;
+    CarlaPluginInstance* const instance;
+    AudioSampleBuffer audio;
+    juce::HeapBlock<float*> channels;
+    MidiBuffer midi;
+
+    juce::Array<PatchbayAudioSource> audioSources;
+    juce::Array<int> midiSources; // -1 for graph input
+    juce::Array<int> dependents;
+    int numDependencies;
+    int level;
+
+    // plugin latency, and the latency of the audio arriving at this node
+    uint32_t latency;
+    uint32_t inputLatency;
+
+    juce::Atomic<int> pending;
+
+    PatchbayRenderNode(const uint32_t id, CarlaPluginInstance* const inst, const int bufferSize)
+        : nodeId(id),
+          instance(inst),
+          audio(jmax(inst->getNumInputChannels(), inst->getNumOutputChannels()), bufferSize),
+          channels(static_cast<size_t>(jmax(1, audio.getNumChannels()))),
+          midi(),
+          audioSources(),
+          midiSources(),
+          dependents(),
+          numDependencies(0),
+          level(0),
+          latency(0),
+          inputLatency(0),
+          pending()
+    {
+        for (int i=0, count=audio.getNumChannels(); i<count; ++i)
+            channels[i] = audio.getWritePointer(i);
+
+        midi.ensureSize(kMaxEngineEventInternalCount*2);
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(PatchbayRenderNode)
+};
+
+// New plugin latencies for a plan, with the delay lines they need allocated up front.
+struct PatchbayLatencyUpdate {
+    juce::Array<uint32_t> latencies;
+    juce::Array<uint32_t> inputLatencies;
+    juce::Array<PatchbayDelayLine*> sourceDelays; // one per audio source, in computeDelays() order
+    juce::Array<PatchbayDelayLine*> oldLines; // replaced, still owned by the plan
+    juce::OwnedArray<PatchbayDelayLine> newLines;
+    uint32_t latency;
+
+    PatchbayLatencyUpdate()
+        : latencies(),
+          inputLatencies(),
+          sourceDelays(),
+          oldLines(),
+          newLines(),
+          latency(0) {}
+
+    CARLA_DECLARE_NON_COPY_STRUCT(PatchbayLatencyUpdate)
+};
+
+struct PatchbayRenderPlan {
+    juce::OwnedArray<PatchbayRenderNode> nodes;
+    juce::Array<PatchbayAudioSource> outputSources;
+    juce::Array<int> midiOutputSources;
+    juce::Array<int> roots;
+    juce::Array<int> order; // topological
+    juce::OwnedArray<PatchbayDelayLine> delayLines;
+    AudioSampleBuffer outBuffer;
+    MidiBuffer midiOut;
+    int numLevels;
+    int maxLevelWidth;
+    int numBridges;
+    uint32_t latency;
+
+    // lock-free ready queue, each node is pushed exactly once per cycle
+    juce::HeapBlock<juce::Atomic<int> > ready;
+    juce::Atomic<int> readyHead;
+    juce::Atomic<int> readyTail;
+
+    PatchbayRenderPlan(const int outputs, const int bufferSize)
+        : nodes(),
+          outputSources(),
+          midiOutputSources(),
+          roots(),
+          order(),
+          delayLines(),
+          outBuffer(jmax(1, outputs), bufferSize),
+          midiOut(),
+          numLevels(0),
+          maxLevelWidth(0),
+          numBridges(0),
+          latency(0),
+          ready(),
+          readyHead(),
+          readyTail()
+    {
+        midiOut.ensureSize(kMaxEngineEventInternalCount*2);
+    }
+
+    int indexOf(const uint32_t nodeId) const noexcept
+    {
+        for (int i=0, count=nodes.size(); i<count; ++i)
+        {
+            if (nodes.getUnchecked(i)->nodeId == nodeId)
+                return i;
+        }
+        return -1;
+    }
+
+    // sort nodes into dependency levels, returns false if the graph has a cycle
+    bool sortIntoLevels()
+    {
+        const int count(nodes.size());
+        juce::Array<int> queue, widths;
+        queue.ensureStorageAllocated(count);
+
+        for (int i=0; i<count; ++i)
+        {
+            PatchbayRenderNode* const node(nodes.getUnchecked(i));
+            node->pending = node->numDependencies;
+
+            if (node->numDependencies == 0)
+            {
+                queue.add(i);
+                roots.add(i);
+            }
+        }
+
+        for (int i=0; i<queue.size(); ++i)
+        {
+            PatchbayRenderNode* const node(nodes.getUnchecked(queue.getUnchecked(i)));
+
+            while (widths.size() <= node->level)
+                widths.add(0);
+            widths.getReference(node->level) += 1;
+
+            for (int j=0, numDeps=node->dependents.size(); j<numDeps; ++j)
+            {
+                PatchbayRenderNode* const dep(nodes.getUnchecked(node->dependents.getUnchecked(j)));
+                dep->level = jmax(dep->level, node->level+1);
+
+                if (--dep->pending == 0)
+                    queue.add(node->dependents.getUnchecked(j));
+            }
+        }
+
+        if (queue.size() != count)
+            return false;
+
+        order.swapWith(queue);
+        numLevels = widths.size();
+
+        for (int i=0; i<numLevels; ++i)
+            maxLevelWidth = jmax(maxLevelWidth, widths.getUnchecked(i));
+
+        ready.allocate(static_cast<size_t>(jmax(1, count)), false);
+        return true;
+    }
+
+    void push(const int index) noexcept
+    {
+        const int slot((readyTail += 1) - 1);
+        ready[slot] = index;
+    }
+
+    // latency at the output of a node, 0 for graph input
+    uint32_t getOutputLatency(const int index, const juce::Array<uint32_t>& latencies, const juce::Array<uint32_t>& inputLatencies) const noexcept
+    {
+        return (index < 0) ? 0 : inputLatencies.getUnchecked(index) + latencies.getUnchecked(index);
+    }
+
+    // Compute the delay each audio source needs for the given plugin latencies, in topological order.
+    // Node sources come first, in node order, followed by the graph output sources.
+    // MIDI is not delayed, so it does not take part in this.
+    uint32_t computeDelays(const juce::Array<uint32_t>& latencies, juce::Array<uint32_t>& inputLatencies, juce::Array<uint32_t>& delays) const
+    {
+        const int count(nodes.size());
+
+        inputLatencies.insertMultiple(0, 0, count);
+
+        for (int i=0; i<count; ++i)
+        {
+            const int index(order.getUnchecked(i));
+            const PatchbayRenderNode* const node(nodes.getUnchecked(index));
+            uint32_t inputLatency = 0;
+
+            for (int j=0, numSources=node->audioSources.size(); j<numSources; ++j)
+                inputLatency = jmax(inputLatency, getOutputLatency(node->audioSources.getReference(j).node, latencies, inputLatencies));
+
+            inputLatencies.set(index, inputLatency);
+        }
+
+        for (int i=0; i<count; ++i)
+        {
+            const PatchbayRenderNode* const node(nodes.getUnchecked(i));
+
+            for (int j=0, numSources=node->audioSources.size(); j<numSources; ++j)
+                delays.add(inputLatencies.getUnchecked(i) - getOutputLatency(node->audioSources.getReference(j).node, latencies, inputLatencies));
+        }
+
+        uint32_t totalLatency = 0;
+
+        for (int i=0, numSources=outputSources.size(); i<numSources; ++i)
+            totalLatency = jmax(totalLatency, getOutputLatency(outputSources.getReference(i).node, latencies, inputLatencies));
+
+        for (int i=0, numSources=outputSources.size(); i<numSources; ++i)
+            delays.add(totalLatency - getOutputLatency(outputSources.getReference(i).node, latencies, inputLatencies));
+
+        return totalLatency;
+    }
+
+    void getPluginLatencies(juce::Array<uint32_t>& latencies) const
+    {
+        for (int i=0, count=nodes.size(); i<count; ++i)
+        {
+            CarlaPlugin* const plugin((CarlaPlugin*)nodes.getUnchecked(i)->instance->getPlatformSpecificData());
+            CarlaEngineClient* const client((plugin != nullptr) ? plugin->getEngineClient() : nullptr);
+
+            latencies.add((client != nullptr) ? client->getLatency() : 0);
+        }
+    }
+
+    // Delay line for a source that needs 'delay' frames, reusing the current one if it still fits.
+    // New lines are added to 'update', replaced ones are only deleted once the update is committed.
+    void prepareSourceDelay(const PatchbayAudioSource& source, const uint32_t delay, PatchbayLatencyUpdate& update) const
+    {
+        if (source.delay != nullptr)
+        {
+            if (static_cast<uint32_t>(source.delay->size) == delay)
+            {
+                update.sourceDelays.add(source.delay);
+                return;
+            }
+
+            update.oldLines.add(source.delay);
+        }
+
+        update.sourceDelays.add((delay > 0) ? update.newLines.add(new PatchbayDelayLine(delay)) : nullptr);
+    }
+
+    // Compute delays for new plugin latencies and allocate their delay lines, without changing the plan.
+    void prepareLatencies(const juce::Array<uint32_t>& latencies, PatchbayLatencyUpdate& update) const
+    {
+        juce::Array<uint32_t> delays;
+        update.latency = computeDelays(latencies, update.inputLatencies, delays);
+        update.latencies = latencies;
+
+        int d = 0;
+
+        for (int i=0, count=nodes.size(); i<count; ++i)
+        {
+            const PatchbayRenderNode* const node(nodes.getUnchecked(i));
+
+            for (int j=0, numSources=node->audioSources.size(); j<numSources; ++j)
+                prepareSourceDelay(node->audioSources.getReference(j), delays.getUnchecked(d++), update);
+        }
+
+        for (int i=0, numSources=outputSources.size(); i<numSources; ++i)
+            prepareSourceDelay(outputSources.getReference(i), delays.getUnchecked(d++), update);
+    }
+
+    // Switch to a prepared update, only pointers are changed so this is cheap enough to be done under lock.
+    // Returns true if the total latency changed.
+    bool applyLatencies(const PatchbayLatencyUpdate& update) noexcept
+    {
+        int d = 0;
+
+        for (int i=0, count=nodes.size(); i<count; ++i)
+        {
+            PatchbayRenderNode* const node(nodes.getUnchecked(i));
+            node->latency      = update.latencies.getUnchecked(i);
+            node->inputLatency = update.inputLatencies.getUnchecked(i);
+
+            for (int j=0, numSources=node->audioSources.size(); j<numSources; ++j)
+                node->audioSources.getReference(j).delay = update.sourceDelays.getUnchecked(d++);
+        }
+
+        for (int i=0, numSources=outputSources.size(); i<numSources; ++i)
+            outputSources.getReference(i).delay = update.sourceDelays.getUnchecked(d++);
+
+        if (latency == update.latency)
+            return false;
+
+        latency = update.latency;
+        return true;
+    }
+
+    // Take ownership of the new delay lines and delete the replaced ones.
+    // The plan must not be in use with the old delays anymore.
+    void commitLatencies(PatchbayLatencyUpdate& update)
+    {
+        for (int i=0, count=update.oldLines.size(); i<count; ++i)
+            delayLines.removeObject(update.oldLines.getUnchecked(i));
+
+        update.oldLines.clear();
+
+        while (update.newLines.size() > 0)
+            delayLines.add(update.newLines.removeAndReturn(update.newLines.size()-1));
+    }
+
+    // Set new plugin latencies and update delays to match, returns true if the total latency changed.
+    // The plan must not be in use while this is called.
+    bool setLatencies(const juce::Array<uint32_t>& latencies)
+    {
+        PatchbayLatencyUpdate update;
+        prepareLatencies(latencies, update);
+
+        const bool changed(applyLatencies(update));
+        commitLatencies(update);
+        return changed;
+    }
+
+    void reset() noexcept
+    {
+        for (int i=0, count=nodes.size(); i<count; ++i)
+        {
+            PatchbayRenderNode* const node(nodes.getUnchecked(i));
+            node->pending = node->numDependencies;
+            ready[i] = -1;
+        }
+
+        readyHead = 0;
+        readyTail = 0;
+
+        for (int i=0, count=roots.size(); i<count; ++i)
+            push(roots.getUnchecked(i));
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(PatchbayRenderPlan)
+};
+
+struct PatchbayParallelProcessor : public GraphWorkerCallback {
+    // bridges one thread can have running at once, the next ones are processed normally
+    static const int kMaxKickedNodes = 32;
+
+    CarlaMutex mutex;     // held by the audio thread while processing, only taken briefly to switch plans or delays
+    CarlaMutex planMutex; // serializes changes to the plan, which are prepared without 'mutex'
+    PatchbayRenderPlan* plan;
+    GraphWorkerPool workers;
+
+    // current cycle, valid while workers are active
+    const AudioSampleBuffer* graphAudio;
+    const MidiBuffer* graphMidi;
+    int frames;
+
+    // latency of the current plan, from graph inputs to outputs
+    volatile uint32_t latency;
+
+    // threads with nothing to take sleep on this, posted when nodes become ready or the last one is taken
+    carla_sem_t readySem;
+    bool readySemValid;
+    juce::Atomic<int> sleepers;
+
+    PatchbayParallelProcessor(const int workerCount)
+        : mutex(),
+          planMutex(),
+          plan(nullptr),
+          workers(this, workerCount),
+          graphAudio(nullptr),
+          graphMidi(nullptr),
+          frames(0),
+          latency(0),
+          readySem(),
+          readySemValid(false),
+          sleepers()
+    {
+        readySemValid = carla_sem_create2(readySem);
+    }
+
+    ~PatchbayParallelProcessor() override
+    {
+        invalidate();
+
+        if (readySemValid)
+        {
+            carla_sem_destroy2(readySem);
+            readySemValid = false;
+        }
+    }
+
+    void invalidate() noexcept
+    {
+        const CarlaMutexLocker cml(planMutex);
+        PatchbayRenderPlan* oldPlan;
+
+        {
+            const GraphWorkerIdleLocker gwil(workers, mutex);
+            oldPlan = plan;
+            plan = nullptr;
+        }
+
+        delete oldPlan;
+    }
+
+    void rebuild(AudioProcessorGraph& graph, const int outputs, const int bufferSize)
+    {
+        typedef AudioProcessorGraph::AudioGraphIOProcessor IOProcessor;
+
+        PatchbayRenderPlan* newPlan(new PatchbayRenderPlan(outputs, bufferSize));
+
+        for (int i=0, count=graph.getNumNodes(); i<count; ++i)
+        {
+            AudioProcessorGraph::Node* const node(graph.getNode(i));
+            CARLA_SAFE_ASSERT_CONTINUE(node != nullptr);
+
+            if (node->properties.getWithDefault("isPlugin", false) != juce::var(true))
+                continue;
+
+            CarlaPluginInstance* const instance(dynamic_cast<CarlaPluginInstance*>(node->getProcessor()));
+            CARLA_SAFE_ASSERT_CONTINUE(instance != nullptr);
+
+            if (instance->getPlatformSpecificData() == nullptr)
+                continue;
+
+            newPlan->nodes.add(new PatchbayRenderNode(node->nodeId, instance, bufferSize));
+
+            if (instance->isBridge())
+                ++newPlan->numBridges;
+        }
+
+        for (int i=0, count=graph.getNumConnections(); i<count; ++i)
+        {
+            const AudioProcessorGraph::Connection* const conn(graph.getConnection(i));
+            CARLA_SAFE_ASSERT_CONTINUE(conn != nullptr);
+
+            AudioProcessorGraph::Node* const nodeA(graph.getNodeForId(conn->sourceNodeId));
+            AudioProcessorGraph::Node* const nodeB(graph.getNodeForId(conn->destNodeId));
+            CARLA_SAFE_ASSERT_CONTINUE(nodeA != nullptr && nodeB != nullptr);
+
+            const IOProcessor* const ioA(dynamic_cast<IOProcessor*>(nodeA->getProcessor()));
+            const IOProcessor* const ioB(dynamic_cast<IOProcessor*>(nodeB->getProcessor()));
+
+            const int indexA(ioA != nullptr ? -1 : newPlan->indexOf(conn->sourceNodeId));
+            const int indexB(ioB != nullptr ? -1 : newPlan->indexOf(conn->destNodeId));
+
+            if ((ioA == nullptr && indexA < 0) || (ioB == nullptr && indexB < 0))
+                continue;
+
+            const bool isMidi(static_cast<uint>(conn->destChannelIndex) == kMidiChannelIndex);
+
+            if (ioB != nullptr)
+            {
+                if (isMidi)
+                {
+                    if (ioB->getType() == IOProcessor::midiOutputNode)
+                        newPlan->midiOutputSources.add(indexA);
+                }
+                else if (ioB->getType() == IOProcessor::audioOutputNode && conn->destChannelIndex < outputs)
+                {
+                    const PatchbayAudioSource source = { conn->destChannelIndex, indexA, conn->sourceChannelIndex, nullptr };
+                    newPlan->outputSources.add(source);
+                }
+                continue;
+            }
+
+            PatchbayRenderNode* const dest(newPlan->nodes.getUnchecked(indexB));
+
+            if (isMidi)
+            {
+                dest->midiSources.add(indexA);
+            }
+            else
+            {
+                CARLA_SAFE_ASSERT_CONTINUE(conn->destChannelIndex < dest->audio.getNumChannels());
+
+                const PatchbayAudioSource source = { conn->destChannelIndex, indexA, conn->sourceChannelIndex, nullptr };
+                dest->audioSources.add(source);
+            }
+
+            if (indexA >= 0 && ! newPlan->nodes.getUnchecked(indexA)->dependents.contains(indexB))
+            {
+                newPlan->nodes.getUnchecked(indexA)->dependents.add(indexB);
+                ++dest->numDependencies;
+            }
+        }
+
+        if (newPlan->sortIntoLevels())
+        {
+            juce::Array<uint32_t> latencies;
+            newPlan->getPluginLatencies(latencies);
+            newPlan->setLatencies(latencies);
+        }
+        else
+        {
+            carla_stderr2("Patchbay graph has a feedback loop, parallel processing and latency compensation disabled");
+            delete newPlan;
+            newPlan = nullptr;
+        }
+
+        const CarlaMutexLocker cml(planMutex);
+        PatchbayRenderPlan* oldPlan;
+
+        {
+            const GraphWorkerIdleLocker gwil(workers, mutex);
+            oldPlan = plan;
+            plan = newPlan;
+            latency = (newPlan != nullptr) ? newPlan->latency : 0;
+        }
+
+        delete oldPlan;
+    }
+
+    // recompute delays after plugin latencies changed, keeping the rest of the plan.
+    // the new delay lines are allocated before taking the lock, the audio thread only waits for the switch.
+    // returns true if the total latency changed
+    bool updateLatency()
+    {
+        const CarlaMutexLocker cml(planMutex);
+
+        if (plan == nullptr)
+            return false;
+
+        juce::Array<uint32_t> latencies;
+        plan->getPluginLatencies(latencies);
+
+        for (int i=0, count=plan->nodes.size(); i<count; ++i)
+        {
+            if (plan->nodes.getUnchecked(i)->latency == latencies.getUnchecked(i))
+                continue;
+
+            PatchbayLatencyUpdate update;
+            plan->prepareLatencies(latencies, update);
+
+            bool changed;
+
+            {
+                const GraphWorkerIdleLocker gwil(workers, mutex);
+                changed = plan->applyLatencies(update);
+                latency = plan->latency;
+            }
+
+            plan->commitLatencies(update);
+            return changed;
+        }
+
+        return false;
     }
 
-    if (proc->producesMidi())
+    // returns false if the plan is not needed, the caller must use the serial graph instead.
+    // workers still running after timeoutUsecs (0 for no limit) are given up on, the block is silent then
+    bool process(AudioSampleBuffer& audio, MidiBuffer& midi, const int numFrames, const uint timeoutUsecs)
     {
-        engine->callback(ENGINE_CALLBACK_PATCHBAY_PORT_REMOVED, groupId, static_cast<int>(kMidiOutputPortOffset),
-                         0, 0.0f, nullptr);
-    }
+        const CarlaMutexTryLocker cmtl(mutex);
 
-    engine->callback(ENGINE_CALLBACK_PATCHBAY_CLIENT_REMOVED, groupId, 0, 0, 0.0f, nullptr);
-}
+        const bool planAvailable(cmtl.wasLocked() && plan != nullptr && numFrames <= plan->outBuffer.getNumSamples());
+        const bool planParallel(planAvailable && (workers.count > 0 || plan->numBridges > 1));
 
-// -----------------------------------------------------------------------
+        switch (getPatchbayRenderMode(planAvailable, planParallel, latency))
+        {
+        case kPatchbayRenderGraph:
+            return false;
+        case kPatchbayRenderSilence:
+            clearPatchbayBlock(audio, midi, numFrames);
+            return true;
+        case kPatchbayRenderPlan:
+            break;
+        }
 
-class CarlaPluginInstance : public AudioPluginInstance
-{
-public:
-    CarlaPluginInstance(CarlaEngine* const engine, CarlaPlugin* const plugin)
-        : kEngine(engine),
-          fPlugin(plugin)
-    {
-        setPlayConfigDetails(static_cast<int>(fPlugin->getAudioInCount()),
-                             static_cast<int>(fPlugin->getAudioOutCount()),
-                             getSampleRate(), getBlockSize());
-    }
+        // nodes given up on are still running, they can't be processed again yet
+        if (! workers.isReady())
+        {
+            clearPatchbayBlock(audio, midi, numFrames);
+            return true;
+        }
 
-    ~CarlaPluginInstance() override
-    {
-    }
+        graphAudio = &audio;
+        graphMidi  = &midi;
+        frames     = numFrames;
 
-    void invalidatePlugin() noexcept
-    {
-        fPlugin = nullptr;
-    }
+        plan->reset();
 
-    // -------------------------------------------------------------------
+        workers.wake(jmin(workers.count, plan->maxLevelWidth-1));
 
-    void* getPlatformSpecificData() noexcept override
-    {
-        return fPlugin;
-    }
+        const bool finished(work(timeoutUsecs != 0
+                                 ? Time::getHighResolutionTicks() + Time::secondsToHighResolutionTicks(timeoutUsecs / 1000000.0)
+                                 : 0));
 
-    void fillInPluginDescription(PluginDescription& d) const override
-    {
-        d.pluginFormatName = "Carla";
-        d.category = "Carla Plugin";
-        d.version = "1.0";
+        // join, workers only leave once every node has been taken
+        if (! workers.join(finished ? timeoutUsecs : 1) || ! finished)
+        {
+            clearPatchbayBlock(audio, midi, numFrames);
+            return true;
+        }
 
-        CARLA_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
+        // mix graph outputs
+        AudioSampleBuffer& outBuffer(plan->outBuffer);
+        outBuffer.clear(0, numFrames);
 
-        char strBuf[STR_MAX+1];
-        strBuf[STR_MAX] = '\0';
+        for (int i=0, count=plan->outputSources.size(); i<count; ++i)
+        {
+            const PatchbayAudioSource& source(plan->outputSources.getReference(i));
+            const float* const srcData(getSourceBuffer(source.node).getReadPointer(source.srcChannel));
 
-        fPlugin->getRealName(strBuf);
-        d.name = strBuf;
+            if (source.delay != nullptr)
+                source.delay->process(outBuffer.getWritePointer(source.destChannel), srcData, numFrames);
+            else
+                outBuffer.addFrom(source.destChannel, 0, srcData, numFrames);
+        }
 
-        fPlugin->getLabel(strBuf);
-        d.descriptiveName = strBuf;
+        plan->midiOut.clear();
 
-        fPlugin->getMaker(strBuf);
-        d.manufacturerName = strBuf;
+        for (int i=0, count=plan->midiOutputSources.size(); i<count; ++i)
+            plan->midiOut.addEvents(getSourceMidi(plan->midiOutputSources.getUnchecked(i)), 0, numFrames, 0);
 
-        d.uid = d.name.hashCode();
-        d.isInstrument = (fPlugin->getHints() & PLUGIN_IS_SYNTH);
+        for (int i=0, count=jmin(audio.getNumChannels(), outBuffer.getNumChannels()); i<count; ++i)
+            audio.copyFrom(i, 0, outBuffer, i, 0, numFrames);
 
-        d.numInputChannels  = static_cast<int>(fPlugin->getAudioInCount());
-        d.numOutputChannels = static_cast<int>(fPlugin->getAudioOutCount());
-        //d.hasSharedContainer = true;
+        midi.swapWith(plan->midiOut);
+        return true;
     }
 
-    // -------------------------------------------------------------------
-
-    const String getName() const override
+    void workerProcess(const int) override
     {
-        return fPlugin->getName();
+        work(0);
     }
 
-    void processBlock(AudioSampleBuffer& audio, MidiBuffer& midi)
+    // Take ready nodes until all of them are taken.
+    // Bridged plugins are only started when taken, and collected once nothing else is ready,
+    // so independent bridges compute at the same time even without workers.
+    // Returns false if waiting for other threads went past deadline, in high resolution ticks (0 for none).
+    bool work(const int64_t deadline) noexcept
     {
-        if (fPlugin == nullptr || ! fPlugin->isEnabled())
-        {
-            audio.clear();
-            midi.clear();
-            return;
-        }
+        PatchbayRenderPlan& p(*plan);
+        const int total(p.nodes.size());
 
-        if (! fPlugin->tryLock(kEngine->isOffline()))
+        PatchbayRenderNode* kicked[kMaxKickedNodes];
+        int numKicked = 0;
+
+        for (int head;;)
         {
-            audio.clear();
-            midi.clear();
-            return;
-        }
+            head = p.readyHead.get();
 
-        fPlugin->initBuffers();
+            if (head >= total || head >= p.readyTail.get())
+            {
+                if (numKicked == 0)
+                {
+                    if (head >= total)
+                        break;
 
-        if (CarlaEngineEventPort* const port = fPlugin->getDefaultEventInPort())
-        {
-            EngineEvent* const engineEvents(port->fBuffer);
-            CARLA_SAFE_ASSERT_RETURN(engineEvents != nullptr,);
+                    if (! waitForReady(head, deadline))
+                        return false;
+                    continue;
+                }
 
-            carla_zeroStructs(engineEvents, kMaxEngineEventInternalCount);
-            fillEngineEventsFromJuceMidiBuffer(engineEvents, midi);
-        }
+                // nothing to do meanwhile, wait for the oldest bridge
+                PatchbayRenderNode* const node(kicked[0]);
 
-        midi.clear();
+                for (int i=1; i<numKicked; ++i)
+                    kicked[i-1] = kicked[i];
 
-        // TODO - CV support
+                --numKicked;
+                collectNode(*node);
+                continue;
+            }
 
-        const int numSamples(audio.getNumSamples());
+            if (! p.readyHead.compareAndSetBool(head+1, head))
+                continue;
 
-        if (const int numChan = audio.getNumChannels())
-        {
-            if (fPlugin->getAudioInCount() == 0)
-                audio.clear();
+            // nothing left to wait for, let the others leave
+            if (head+1 == total)
+                wakeSleepers(sleepers.get());
 
-            float* audioBuffers[numChan];
+            int index;
+            while ((index = p.ready[head].get()) == -1)
+                graphSpinPause();
 
-            for (int i=0; i<numChan; ++i)
-                audioBuffers[i] = audio.getWritePointer(i);
+            PatchbayRenderNode* const node(p.nodes.getUnchecked(index));
 
-            float inPeaks[2] = { 0.0f };
-            float outPeaks[2] = { 0.0f };
-            juce::Range<float> range;
+            try {
+                mixInputs(*node);
+            } CARLA_SAFE_EXCEPTION("PatchbayParallelProcessor::mixInputs");
 
-            for (int i=jmin(fPlugin->getAudioInCount(), 2U); --i>=0;)
+            if (numKicked < kMaxKickedNodes && kickNode(*node))
             {
-                range = FloatVectorOperations::findMinAndMax(audioBuffers[i], numSamples);
-                inPeaks[i] = carla_maxLimited<float>(std::abs(range.getStart()), std::abs(range.getEnd()), 1.0f);
+                kicked[numKicked++] = node;
+                continue;
             }
 
-            fPlugin->process(const_cast<const float**>(audioBuffers), audioBuffers, nullptr, nullptr, static_cast<uint32_t>(numSamples));
-
-            for (int i=jmin(fPlugin->getAudioOutCount(), 2U); --i>=0;)
+            // the bridge group of this node might be busy with one of ours, it would skip the block otherwise
+            if (numKicked > 0 && node->instance->isBridge())
             {
-                range = FloatVectorOperations::findMinAndMax(audioBuffers[i], numSamples);
-                outPeaks[i] = carla_maxLimited<float>(std::abs(range.getStart()), std::abs(range.getEnd()), 1.0f);
+                for (int i=0; i<numKicked; ++i)
+                    collectNode(*kicked[i]);
+
+                numKicked = 0;
             }
 
-            kEngine->setPluginPeaks(fPlugin->getId(), inPeaks, outPeaks);
+            try {
+                runNode(*node);
+            } CARLA_SAFE_EXCEPTION("PatchbayParallelProcessor::runNode");
+
+            releaseDependents(*node);
         }
-        else
+
+        return true;
+    }
+
+    // Spins for a short while, nodes usually become ready soon, then sleeps until one is pushed.
+    // returns false once the deadline has passed
+    bool waitForReady(const int head, const int64_t deadline) noexcept
+    {
+        PatchbayRenderPlan& p(*plan);
+
+        for (int i=0; i < kGraphWorkerJoinSpinCount; ++i)
         {
-            fPlugin->process(nullptr, nullptr, nullptr, nullptr, static_cast<uint32_t>(numSamples));
+            if (p.readyHead.get() != head || p.readyTail.get() > head)
+                return true;
+
+            graphSpinPause();
         }
 
-        midi.clear();
+        if (readySemValid)
+        {
+            ++sleepers;
 
-        if (CarlaEngineEventPort* const port = fPlugin->getDefaultEventOutPort())
+            // check again, a node pushed before we were counted does not post
+            if (p.readyHead.get() == head && p.readyTail.get() <= head)
+                carla_sem_timedwait_usecs(readySem, 1000);
+
+            --sleepers;
+        }
+
+        return deadline == 0 || Time::getHighResolutionTicks() < deadline;
+    }
+
+    void wakeSleepers(const int count) noexcept
+    {
+        for (int i=0; i<count; ++i)
+            carla_sem_post(readySem);
+    }
+
+    void releaseDependents(const PatchbayRenderNode& node) noexcept
+    {
+        PatchbayRenderPlan& p(*plan);
+        int numPushed = 0;
+
+        for (int i=0, count=node.dependents.size(); i<count; ++i)
         {
-            /*const*/ EngineEvent* const engineEvents(port->fBuffer);
-            CARLA_SAFE_ASSERT_RETURN(engineEvents != nullptr,);
+            const int depIndex(node.dependents.getUnchecked(i));
 
-            fillJuceMidiBufferFromEngineEvents(midi, engineEvents);
-            carla_zeroStructs(engineEvents, kMaxEngineEventInternalCount);
+            if (--p.nodes.getUnchecked(depIndex)->pending == 0)
+            {
+                p.push(depIndex);
+                ++numPushed;
+            }
         }
 
-        fPlugin->unlock();
+        if (numPushed > 0)
+            wakeSleepers(jmin(numPushed, sleepers.get()));
     }
 
-    const String getInputChannelName(int i)  const override
+    bool kickNode(PatchbayRenderNode& node) noexcept
     {
-        CARLA_SAFE_ASSERT_RETURN(i >= 0, String());
-        CarlaEngineClient* const client(fPlugin->getEngineClient());
-        return client->getAudioPortName(true, static_cast<uint>(i));
+        if (! node.instance->isBridge())
+            return false;
+
+        try {
+            AudioSampleBuffer buffer(node.channels, node.audio.getNumChannels(), frames);
+            return node.instance->kickBlock(buffer, node.midi);
+        } CARLA_SAFE_EXCEPTION_RETURN("PatchbayParallelProcessor::kickNode", false);
     }
 
-    const String getOutputChannelName(int i) const override
+    void collectNode(PatchbayRenderNode& node) noexcept
     {
-        CARLA_SAFE_ASSERT_RETURN(i >= 0, String());
-        CarlaEngineClient* const client(fPlugin->getEngineClient());
-        return client->getAudioPortName(false, static_cast<uint>(i));
+        try {
+            AudioSampleBuffer buffer(node.channels, node.audio.getNumChannels(), frames);
+            node.instance->collectBlock(buffer, node.midi);
+        } CARLA_SAFE_EXCEPTION("PatchbayParallelProcessor::collectNode");
+
+        releaseDependents(node);
     }
 
-    void prepareToPlay(double, int) override {}
-    void releaseResources() override {}
+    const AudioSampleBuffer& getSourceBuffer(const int index) const noexcept
+    {
+        return (index < 0) ? *graphAudio : plan->nodes.getUnchecked(index)->audio;
+    }
 
-    const String getParameterName(int)         override { return String(); }
-          String getParameterName(int, int)    override { return String(); }
-    const String getParameterText(int)         override { return String(); }
-          String getParameterText(int, int)    override { return String(); }
-    const String getProgramName(int)           override { return String(); }
+    const MidiBuffer& getSourceMidi(const int index) const noexcept
+    {
+        return (index < 0) ? *graphMidi : plan->nodes.getUnchecked(index)->midi;
+    }
 
-    double getTailLengthSeconds()        const override { return 0.0;  }
-    float  getParameter(int)                   override { return 0.0f; }
+    void runNode(PatchbayRenderNode& node)
+    {
+        AudioSampleBuffer buffer(node.channels, node.audio.getNumChannels(), frames);
+        node.instance->processBlock(buffer, node.midi);
+    }
 
-    bool isInputChannelStereoPair(int)   const override { return false; }
-    bool isOutputChannelStereoPair(int)  const override { return false; }
-    bool silenceInProducesSilenceOut()   const override { return true;  }
-    bool acceptsMidi()                   const override { return fPlugin->getDefaultEventInPort()  != nullptr; }
-    bool producesMidi()                  const override { return fPlugin->getDefaultEventOutPort() != nullptr; }
+    void mixInputs(PatchbayRenderNode& node)
+    {
+        const int numChannels(node.audio.getNumChannels());
 
-    void setParameter(int, float)              override {}
-    void setCurrentProgram(int)                override {}
-    void changeProgramName(int, const String&) override {}
-    void getStateInformation(MemoryBlock&)     override {}
-    void setStateInformation(const void*, int) override {}
+        // plugins write through the raw channel pointers, so don't rely on the buffer's clear flag
+        for (int i=0; i<numChannels; ++i)
+            FloatVectorOperations::clear(node.channels[i], frames);
 
-    int getNumParameters()                     override { return 0; }
-    int getNumPrograms()                       override { return 0; }
-    int getCurrentProgram()                    override { return 0; }
+        for (int i=0, count=node.audioSources.size(); i<count; ++i)
+        {
+            const PatchbayAudioSource& source(node.audioSources.getReference(i));
+            const AudioSampleBuffer& srcBuffer(getSourceBuffer(source.node));
+            CARLA_SAFE_ASSERT_CONTINUE(source.srcChannel < srcBuffer.getNumChannels());
 
-#ifndef JUCE_AUDIO_PROCESSOR_NO_GUI
-    bool hasEditor()                     const override { return false; }
-    AudioProcessorEditor* createEditor()       override { return nullptr; }
-#endif
+            if (source.delay != nullptr)
+                source.delay->process(node.channels[source.destChannel], srcBuffer.getReadPointer(source.srcChannel), frames);
+            else
+                FloatVectorOperations::add(node.channels[source.destChannel], srcBuffer.getReadPointer(source.srcChannel), frames);
+        }
 
-    // -------------------------------------------------------------------
+        node.midi.clear();
 
-private:
-    CarlaEngine* const kEngine;
-    CarlaPlugin* fPlugin;
+        for (int i=0, count=node.midiSources.size(); i<count; ++i)
+            node.midi.addEvents(getSourceMidi(node.midiSources.getUnchecked(i)), 0, frames, 0);
+    }
 
-    CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaPluginInstance)
+    CARLA_DECLARE_NON_COPY_CLASS(PatchbayParallelProcessor)
 };
 
 // -----------------------------------------------------------------------
@@ -1344,6 +2916,8 @@ PatchbayGraph::PatchbayGraph(CarlaEngine* const engine, const uint32_t ins, cons
       retCon(),
       usingExternal(false),
       extGraph(engine),
+      parallel(nullptr),
+      planDirty(false),
       kEngine(engine)
 {
     const int    bufferSize(static_cast<int>(engine->getBufferSize()));
@@ -1400,10 +2974,20 @@ PatchbayGraph::PatchbayGraph(CarlaEngine* const engine, const uint32_t ins, cons
         node->properties.set("isMIDI", true);
         node->properties.set("isOSC", false);
     }
+
+    // the render plan is built even without workers, it finds out if latency compensation is needed
+    parallel = new PatchbayParallelProcessor(static_cast<int>(engine->getOptions().processWorkers));
+    updateParallelPlan();
 }
 
 PatchbayGraph::~PatchbayGraph()
 {
+    if (parallel != nullptr)
+    {
+        delete parallel;
+        parallel = nullptr;
+    }
+
     connections.clear();
     extGraph.clear();
 
@@ -1419,6 +3003,8 @@ void PatchbayGraph::setBufferSize(const uint32_t bufferSize)
     graph.releaseResources();
     graph.prepareToPlay(kEngine->getSampleRate(), bufferSizei);
     audioBuffer.setSize(audioBuffer.getNumChannels(), bufferSizei);
+
+    updateParallelPlan();
 }
 
 void PatchbayGraph::setSampleRate(const double sampleRate)
@@ -1448,6 +3034,8 @@ void PatchbayGraph::addPlugin(CarlaPlugin* const plugin)
 
     if (! usingExternal)
         addNodeToPatchbay(plugin->getEngine(), node->nodeId, static_cast<int>(plugin->getId()), instance);
+
+    planDirty = true;
 }
 
 void PatchbayGraph::replacePlugin(CarlaPlugin* const oldPlugin, CarlaPlugin* const newPlugin)
@@ -1468,6 +3056,7 @@ void PatchbayGraph::replacePlugin(CarlaPlugin* const oldPlugin, CarlaPlugin* con
 
     ((CarlaPluginInstance*)oldNode->getProcessor())->invalidatePlugin();
 
+    invalidateParallelPlan();
     graph.removeNode(oldNode->nodeId);
 
     CarlaPluginInstance* const instance(new CarlaPluginInstance(kEngine, newPlugin));
@@ -1481,6 +3070,8 @@ void PatchbayGraph::replacePlugin(CarlaPlugin* const oldPlugin, CarlaPlugin* con
 
     if (! usingExternal)
         addNodeToPatchbay(newPlugin->getEngine(), node->nodeId, static_cast<int>(newPlugin->getId()), instance);
+
+    planDirty = true;
 }
 
 void PatchbayGraph::removePlugin(CarlaPlugin* const plugin)
@@ -1512,13 +3103,18 @@ void PatchbayGraph::removePlugin(CarlaPlugin* const plugin)
         }
     }
 
+    invalidateParallelPlan();
     CARLA_SAFE_ASSERT_RETURN(graph.removeNode(node->nodeId),);
+
+    planDirty = true;
 }
 
 void PatchbayGraph::removeAllPlugins()
 {
     carla_debug("PatchbayGraph::removeAllPlugins()");
 
+    invalidateParallelPlan();
+
     for (uint i=0, count=kEngine->getCurrentPluginCount(); i<count; ++i)
     {
         CarlaPlugin* const plugin(kEngine->getPlugin(i));
@@ -1537,6 +3133,8 @@ void PatchbayGraph::removeAllPlugins()
 
         graph.removeNode(node->nodeId);
     }
+
+    planDirty = true;
 }
 
 bool PatchbayGraph::connect(const bool external, const uint groupA, const uint portA, const uint groupB, const uint portB, const bool sendCallback)
@@ -1569,6 +3167,7 @@ bool PatchbayGraph::connect(const bool external, const uint groupA, const uint p
         kEngine->callback(ENGINE_CALLBACK_PATCHBAY_CONNECTION_ADDED, connectionToId.id, 0, 0, 0.0f, strBuf);
 
     connections.list.append(connectionToId);
+    planDirty = true;
     return true;
 }
 
@@ -1602,6 +3201,7 @@ bool PatchbayGraph::disconnect(const uint connectionId)
         kEngine->callback(ENGINE_CALLBACK_PATCHBAY_CONNECTION_REMOVED, connectionToId.id, 0, 0, 0.0f, nullptr);
 
         connections.list.remove(it);
+        planDirty = true;
         return true;
     }
 
@@ -1652,6 +3252,7 @@ void PatchbayGraph::refresh(const char* const deviceName)
 
     connections.clear();
     graph.removeIllegalConnections();
+    planDirty = true;
 
     for (int i=0, count=graph.getNumNodes(); i<count; ++i)
     {
@@ -1834,7 +3435,10 @@ void PatchbayGraph::process(CarlaEngine::ProtectedData* const data, const float*
             audioBuffer.clear(i, 0, frames);
     }
 
-    graph.processBlock(audioBuffer, midiBuffer);
+    const uint timeout(getGraphWorkerTimeout(static_cast<uint32_t>(frames), data->sampleRate, kEngine->isOffline()));
+
+    if (parallel == nullptr || ! parallel->process(audioBuffer, midiBuffer, frames, timeout))
+        graph.processBlock(audioBuffer, midiBuffer);
 
     // put juce audio in carla buffer
     {
@@ -1844,12 +3448,49 @@ void PatchbayGraph::process(CarlaEngine::ProtectedData* const data, const float*
 
     // put juce events in carla buffer
     {
-        carla_zeroStructs(data->events.out, kMaxEngineEventInternalCount);
-        fillEngineEventsFromJuceMidiBuffer(data->events.out, midiBuffer);
+        clearEngineEvents(data->events.out);
+        fillEngineEventsFromJuceMidiBuffer(data->events.out, midiBuffer, data->events.dataExt);
         midiBuffer.clear();
     }
 }
 
+void PatchbayGraph::updateParallelPlan()
+{
+    planDirty = false;
+
+    if (parallel == nullptr)
+        return;
+
+    parallel->rebuild(graph, static_cast<int>(outputs), static_cast<int>(kEngine->getBufferSize()));
+}
+
+void PatchbayGraph::idle()
+{
+    if (planDirty)
+        updateParallelPlan();
+}
+
+void PatchbayGraph::invalidateParallelPlan() noexcept
+{
+    if (parallel == nullptr)
+        return;
+
+    parallel->invalidate();
+}
+
+uint32_t PatchbayGraph::getLatency() const noexcept
+{
+    return (parallel != nullptr) ? parallel->latency : 0;
+}
+
+bool PatchbayGraph::updateLatency()
+{
+    if (parallel == nullptr)
+        return false;
+
+    return parallel->updateLatency();
+}
+
 // -----------------------------------------------------------------------
 // InternalGraph
 
@@ -1961,6 +3602,14 @@ bool EngineInternalGraph::isReady() const noexcept
     return fIsReady;
 }
 
+uint32_t EngineInternalGraph::getLatency() const noexcept
+{
+    if (fIsRack)
+        return (fRack != nullptr) ? fRack->getLatency() : 0;
+
+    return (fPatchbay != nullptr) ? fPatchbay->getLatency() : 0;
+}
+
 RackGraph* EngineInternalGraph::getRackGraph() const noexcept
 {
     CARLA_SAFE_ASSERT_RETURN(fIsRack, nullptr);
@@ -2024,6 +3673,18 @@ void EngineInternalGraph::removeAllPlugins()
     fPatchbay->removeAllPlugins();
 }
 
+void EngineInternalGraph::idle() noexcept
+{
+    if (fIsRack || ! fIsReady)
+        return;
+
+    CARLA_SAFE_ASSERT_RETURN(fPatchbay != nullptr,);
+
+    try {
+        fPatchbay->idle();
+    } CARLA_SAFE_EXCEPTION("PatchbayGraph::idle");
+}
+
 bool EngineInternalGraph::isUsingExternal() const noexcept
 {
     if (fIsRack)
@@ -2115,6 +3776,20 @@ bool CarlaEngine::patchbayRefresh(const bool external)
     return false;
 }
 
+void CarlaEngine::patchbayLatencyChanged()
+{
+    if (pData->options.processMode != ENGINE_PROCESS_MODE_PATCHBAY || ! pData->graph.isReady())
+        return;
+
+    PatchbayGraph* const graph = pData->graph.getPatchbayGraph();
+    CARLA_SAFE_ASSERT_RETURN(graph != nullptr,);
+
+    if (graph->updateLatency())
+    {
+        carla_debug("patchbay latency changed to %u", graph->getLatency());
+    }
+}
+
 // -----------------------------------------------------------------------
 
 const char* const* CarlaEngine::getPatchbayConnections(const bool external) const
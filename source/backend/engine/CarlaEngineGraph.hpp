@@ -96,6 +96,8 @@ struct ExternalGraph {
 // -----------------------------------------------------------------------
 // RackGraph
 
+struct RackGraphPipeline;
+
 struct RackGraph {
     ExternalGraph extGraph;
     const uint32_t inputs;
@@ -118,12 +120,28 @@ struct RackGraph {
         CARLA_DECLARE_NON_COPY_CLASS(Buffers)
     } audioBuffers;
 
+    // state carried along the plugin chain
+    struct ChainState {
+        float* inBuf[2];
+        float* outBuf[2];
+        EngineEvent* eventsIn;
+        EngineEvent* eventsOut;
+        uint32_t oldMidiOutCount;
+        bool processed;
+    };
+
+    // only used when there is more than 1 pipeline stage
+    RackGraphPipeline* pipeline;
+
     RackGraph(CarlaEngine* const engine, const uint32_t inputs, const uint32_t outputs) noexcept;
     ~RackGraph() noexcept;
 
     void setBufferSize(const uint32_t bufferSize) noexcept;
     void setOffline(const bool offline) noexcept;
 
+    // extra latency added by the pipeline, in frames
+    uint32_t getLatency() const noexcept;
+
     bool connect(const uint groupA, const uint portA, const uint groupB, const uint portB) noexcept;
     bool disconnect(const uint connectionId) noexcept;
     void refresh(const char* const deviceName);
@@ -134,6 +152,9 @@ struct RackGraph {
     // the base, where plugins run
     void process(CarlaEngine::ProtectedData* const data, const float* inBufReal[2], float* outBuf[2], const uint32_t frames);
 
+    // process plugins in the [first, last) range, continuing from a previous state
+    void processChain(CarlaEngine::ProtectedData* const data, ChainState& state, const uint first, const uint last, const uint32_t frames);
+
     // extended, will call process() in the middle
     void processHelper(CarlaEngine::ProtectedData* const data, const float* const* const inBuf, float* const* const outBuf, const uint32_t frames);
 
@@ -144,6 +165,8 @@ struct RackGraph {
 // -----------------------------------------------------------------------
 // PatchbayGraph
 
+struct PatchbayParallelProcessor;
+
 struct PatchbayGraph {
     PatchbayConnectionList connections;
     AudioProcessorGraph graph;
@@ -156,6 +179,12 @@ struct PatchbayGraph {
 
     ExternalGraph extGraph;
 
+    // render plan with latency compensation, runs in parallel when there are process workers
+    PatchbayParallelProcessor* parallel;
+
+    // the graph changed since the plan was built, it is rebuilt once from idle()
+    bool planDirty;
+
     PatchbayGraph(CarlaEngine* const engine, const uint32_t inputs, const uint32_t outputs);
     ~PatchbayGraph();
 
@@ -178,6 +207,19 @@ struct PatchbayGraph {
 
     void process(CarlaEngine::ProtectedData* const data, const float* const* const inBuf, float* const* const outBuf, const int frames);
 
+    // parallel render plan, must be invalidated before removing nodes
+    void updateParallelPlan();
+    void invalidateParallelPlan() noexcept;
+
+    // non-RT, rebuilds the plan if the graph changed
+    void idle();
+
+    // latency added by delay compensation, in frames
+    uint32_t getLatency() const noexcept;
+
+    // recompute delay compensation after plugin latencies changed, returns true if getLatency() changed
+    bool updateLatency();
+
     CarlaEngine* const kEngine;
     CARLA_DECLARE_NON_COPY_CLASS(PatchbayGraph)
 };
@@ -29,6 +29,11 @@ CARLA_BACKEND_START_NAMESPACE
 // -----------------------------------------------------------------------
 // InternalEvents
 
+#ifndef BUILD_BRIDGE
+__thread EngineEvent* EngineInternalEvents::stageIn  = nullptr;
+__thread EngineEvent* EngineInternalEvents::stageOut = nullptr;
+#endif
+
 EngineInternalEvents::EngineInternalEvents() noexcept
     : in(nullptr),
       out(nullptr) {}
@@ -52,6 +57,8 @@ void EngineInternalEvents::clear() noexcept
         delete[] out;
         out = nullptr;
     }
+
+    dataExt.destroy();
 }
 
 // -----------------------------------------------------------------------
@@ -90,6 +97,59 @@ void EngineNextAction::clearAndReset() noexcept
     mutex.unlock();
 }
 
+// -----------------------------------------------------------------------
+// PluginDspTimes
+
+void EnginePluginDspTimes::clear() noexcept
+{
+    carla_zeroFloats(times, kMaxCount);
+    __atomic_store_n(&counter, 0, __ATOMIC_RELEASE);
+}
+
+void EnginePluginDspTimes::add(const float time) noexcept
+{
+    const uint32_t index(__atomic_load_n(&counter, __ATOMIC_RELAXED));
+
+    times[index % kMaxCount] = time;
+    __atomic_store_n(&counter, index+1, __ATOMIC_RELEASE);
+}
+
+void EnginePluginDspTimes::getStats(EnginePluginDspStats& stats, const double bufferTime) const noexcept
+{
+    const uint32_t count(std::min(__atomic_load_n(&counter, __ATOMIC_ACQUIRE), kMaxCount));
+
+    if (count == 0)
+        return;
+
+    // the audio thread may keep writing meanwhile, a few values can be newer than others
+    float sorted[kMaxCount];
+    carla_copyFloats(sorted, times, count);
+
+    double total = 0.0;
+    float  min   = sorted[0];
+    float  max   = sorted[0];
+
+    for (uint32_t i=0; i < count; ++i)
+    {
+        total += sorted[i];
+
+        if (sorted[i] < min)
+            min = sorted[i];
+        if (sorted[i] > max)
+            max = sorted[i];
+    }
+
+    float* const p99(sorted + std::min(count*99/100, count-1));
+    std::nth_element(sorted, p99, sorted + count);
+
+    stats.count   = count;
+    stats.minTime = min;
+    stats.avgTime = static_cast<float>(total / count);
+    stats.maxTime = max;
+    stats.p99Time = *p99;
+    stats.load    = (bufferTime > 0.0) ? static_cast<float>(total / count / bufferTime * 100.0) : 0.0f;
+}
+
 // -----------------------------------------------------------------------
 // CarlaEngine::ProtectedData
 
@@ -122,9 +182,11 @@ CarlaEngine::ProtectedData::ProtectedData(CarlaEngine* const engine) noexcept
       events(),
 #ifndef BUILD_BRIDGE
       graph(engine),
+      reservedPluginNames(),
 #endif
       time(),
-      nextAction()
+      nextAction(),
+      workers()
 {
 #ifdef BUILD_BRIDGE
     carla_zeroStructs(plugins, 1);
@@ -185,6 +247,9 @@ bool CarlaEngine::ProtectedData::init(const char* const clientName)
     case ENGINE_PROCESS_MODE_BRIDGE:
         events.in  = new EngineEvent[kMaxEngineEventInternalCount];
         events.out = new EngineEvent[kMaxEngineEventInternalCount];
+        carla_zeroStructs(events.in,  kMaxEngineEventInternalCount);
+        carla_zeroStructs(events.out, kMaxEngineEventInternalCount);
+        events.dataExt.create(kMaxEngineEventInternalDataSize);
         break;
     default:
         break;
@@ -272,6 +337,7 @@ void CarlaEngine::ProtectedData::doPluginRemove() noexcept
         plugins[i].insPeak[1]  = 0.0f;
         plugins[i].outsPeak[0] = 0.0f;
         plugins[i].outsPeak[1] = 0.0f;
+        plugins[i].dspTimes.clear();
     }
 
     const uint id(curPluginCount);
@@ -282,6 +348,7 @@ void CarlaEngine::ProtectedData::doPluginRemove() noexcept
     plugins[id].insPeak[1]  = 0.0f;
     plugins[id].outsPeak[0] = 0.0f;
     plugins[id].outsPeak[1] = 0.0f;
+    plugins[id].dspTimes.clear();
 }
 
 void CarlaEngine::ProtectedData::doPluginsSwitch() noexcept
@@ -304,6 +371,9 @@ void CarlaEngine::ProtectedData::doPluginsSwitch() noexcept
     plugins[idA].plugin = plugins[idB].plugin;
     plugins[idB].plugin = tmp;
 #endif
+
+    plugins[idA].dspTimes.clear();
+    plugins[idB].dspTimes.clear();
 }
 #endif
 
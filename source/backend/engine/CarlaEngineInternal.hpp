@@ -22,6 +22,8 @@
 #include "CarlaEngineThread.hpp"
 #include "CarlaEngineUtils.hpp"
 
+#include "LinkedList.hpp"
+
 // FIXME only use CARLA_PREVENT_HEAP_ALLOCATION for structs
 // maybe separate macro
 
@@ -42,6 +44,14 @@ CARLA_BACKEND_START_NAMESPACE
 struct EngineInternalEvents {
     EngineEvent* in;
     EngineEvent* out;
+    EngineEventDataArena dataExt; // long MIDI messages of the current cycle
+
+#ifndef BUILD_BRIDGE
+    // buffers of the rack pipeline stage run by the current thread, null outside of one.
+    // ports take these in initBuffer() instead of the ones above, so stages never share event buffers
+    static __thread EngineEvent* stageIn;
+    static __thread EngineEvent* stageOut;
+#endif
 
     EngineInternalEvents() noexcept;
     ~EngineInternalEvents() noexcept;
@@ -71,6 +81,7 @@ public:
     void setOffline(const bool offline);
 
     bool isReady() const noexcept;
+    uint32_t getLatency() const noexcept;
 
     RackGraph*     getRackGraph() const noexcept;
     PatchbayGraph* getPatchbayGraph() const noexcept;
@@ -86,6 +97,9 @@ public:
     void removePlugin(CarlaPlugin* const plugin);
     void removeAllPlugins();
 
+    // rebuilds the patchbay render plan after changes, main thread only
+    void idle() noexcept;
+
     bool isUsingExternal() const noexcept;
     void setUsingExternal(const bool usingExternal) noexcept;
 
@@ -143,6 +157,51 @@ struct EngineNextAction {
     CARLA_DECLARE_NON_COPY_STRUCT(EngineNextAction)
 };
 
+// -----------------------------------------------------------------------
+// EnginePluginDspTimes
+
+// Process times of the last blocks of a plugin, in microseconds.
+// Only written by the thread processing the plugin, read without locking.
+struct EnginePluginDspTimes {
+    static const uint32_t kMaxCount = 512;
+
+    float    times[kMaxCount];
+    uint32_t counter;
+
+    void clear() noexcept;
+    void add(const float time) noexcept;
+    void getStats(EnginePluginDspStats& stats, const double bufferTime) const noexcept;
+};
+
+// -----------------------------------------------------------------------
+// EngineWorkerPool
+
+class EngineWorkerThread;
+
+// Non-RT threads running plugin worker jobs, see CarlaEngineWorkerClient.
+// Threads are only created once the first client is added, new clients go to the least used one.
+// The client list here is only for stats, each thread keeps its own list for running jobs.
+struct EngineWorkerPool {
+    static const uint kThreadCount = 2;
+
+    CarlaMutex mutex;
+    EngineWorkerThread* threads[kThreadCount];
+    LinkedList<CarlaEngineWorkerClient*> clients;
+
+    EngineWorkerPool() noexcept;
+    ~EngineWorkerPool() noexcept;
+
+    // returns the thread the client is bound to, null on failure
+    EngineWorkerThread* addClient(CarlaEngineWorkerClient* const client);
+
+    // waits for the client's running job, if any
+    void removeClient(EngineWorkerThread* const thread, CarlaEngineWorkerClient* const client) noexcept;
+
+    void getStats(const CarlaPlugin* const plugin, EngineWorkerStats& stats) const noexcept;
+
+    CARLA_DECLARE_NON_COPY_STRUCT(EngineWorkerPool)
+};
+
 // -----------------------------------------------------------------------
 // EnginePluginData
 
@@ -150,6 +209,8 @@ struct EnginePluginData {
     CarlaPlugin* plugin;
     float insPeak[2];
     float outsPeak[2];
+    float oscPeaks[4]; // last peaks sent to the OSC control client, negative means none
+    EnginePluginDspTimes dspTimes;
 };
 
 // -----------------------------------------------------------------------
@@ -198,9 +259,13 @@ struct CarlaEngine::ProtectedData {
     EngineInternalEvents events;
 #ifndef BUILD_BRIDGE
     EngineInternalGraph  graph;
+
+    // unique names of project plugins that are not added yet, taken into account by getUniquePluginName()
+    LinkedList<const char*> reservedPluginNames;
 #endif
     EngineInternalTime   time;
     EngineNextAction     nextAction;
+    EngineWorkerPool     workers;
 
     // -------------------------------------------------------------------
 
@@ -40,6 +40,7 @@
 using juce::FloatVectorOperations;
 using juce::String;
 using juce::StringArray;
+using juce::Time;
 
 CARLA_BACKEND_START_NAMESPACE
 
@@ -349,7 +350,7 @@ public:
         if (! test)
             return kFallbackJackEngineEvent;
 
-        CARLA_SAFE_ASSERT_RETURN(jackEvent.size < 0xFF /* uint8_t max */, kFallbackJackEngineEvent);
+        CARLA_SAFE_ASSERT_RETURN(jackEvent.size <= EngineMidiEvent::kMaxSize, kFallbackJackEngineEvent);
 
         uint8_t port;
 
@@ -364,7 +365,7 @@ public:
         }
 
         fRetEvent.time = jackEvent.time;
-        fRetEvent.fillFromMidiData(static_cast<uint8_t>(jackEvent.size), jackEvent.buffer, port);
+        fRetEvent.fillFromMidiData(static_cast<uint16_t>(jackEvent.size), jackEvent.buffer, port);
 
         return fRetEvent;
     }
@@ -399,7 +400,7 @@ public:
         } CARLA_SAFE_EXCEPTION_RETURN("jack_midi_event_write", false);
     }
 
-    bool writeMidiEvent(const uint32_t time, const uint8_t channel, const uint8_t size, const uint8_t* const data) noexcept override
+    bool writeMidiEvent(const uint32_t time, const uint8_t channel, const uint16_t size, const uint8_t* const data) noexcept override
     {
         if (fJackPort == nullptr)
             return CarlaEngineEventPort::writeMidiEvent(time, channel, size, data);
@@ -410,16 +411,19 @@ public:
         CARLA_SAFE_ASSERT_RETURN(size > 0, false);
         CARLA_SAFE_ASSERT_RETURN(data != nullptr, false);
 
-        jack_midi_data_t jdata[size];
+        // written in place, long messages would not fit on the stack
+        jack_midi_data_t* jdata;
 
-        jdata[0] = static_cast<jack_midi_data_t>(MIDI_GET_STATUS_FROM_DATA(data) + channel);
+        try {
+            jdata = jackbridge_midi_event_reserve(fJackBuffer, time, size);
+        } CARLA_SAFE_EXCEPTION_RETURN("jack_midi_event_reserve", false);
 
-        for (uint8_t i=1; i < size; ++i)
-            jdata[i] = data[i];
+        if (jdata == nullptr)
+            return false;
 
-        try {
-            return jackbridge_midi_event_write(fJackBuffer, time, jdata, size);
-        } CARLA_SAFE_EXCEPTION_RETURN("jack_midi_event_write", false);
+        jdata[0] = static_cast<jack_midi_data_t>(MIDI_GET_STATUS_FROM_DATA(data) + channel);
+        std::memcpy(jdata+1, data+1, static_cast<std::size_t>(size-1));
+        return true;
     }
 
     void invalidate() noexcept
@@ -671,6 +675,44 @@ public:
         fEventPorts.removeAll(port);
     }
 
+    void setLatency(const uint32_t samples) noexcept override
+    {
+        const bool changed(samples != getLatency());
+
+        CarlaEngineClient::setLatency(samples);
+
+        // have JACK call the latency callbacks again
+        if (changed && fUseClient && fJackClient != nullptr && isActive())
+        {
+            try {
+                jackbridge_recompute_total_latencies(fJackClient);
+            } CARLA_SAFE_EXCEPTION("jack_recompute_total_latencies");
+        }
+    }
+
+    // Capture latency goes from input to output ports, playback latency the other way around.
+    // Both get the plugin latency added on top.
+    void handleLatencyCallback(const jack_latency_callback_mode_t mode) noexcept
+    {
+        const bool fromInputs(mode == JackCaptureLatency);
+
+        jack_latency_range_t range;
+        range.min = 0;
+        range.max = 0;
+        bool found = false;
+
+        _getLatencyRange(fAudioPorts, fromInputs, mode, range, found);
+        _getLatencyRange(fCVPorts,    fromInputs, mode, range, found);
+        _getLatencyRange(fEventPorts, fromInputs, mode, range, found);
+
+        range.min += getLatency();
+        range.max += getLatency();
+
+        _setLatencyRange(fAudioPorts, ! fromInputs, mode, range);
+        _setLatencyRange(fCVPorts,    ! fromInputs, mode, range);
+        _setLatencyRange(fEventPorts, ! fromInputs, mode, range);
+    }
+
     bool renameInSingleClient(const CarlaString& newClientName)
     {
         const CarlaString clientNamePrefix(newClientName + ":");
@@ -756,6 +798,49 @@ private:
         return true;
     }
 
+    template<typename T>
+    void _getLatencyRange(const LinkedList<T*>& t, const bool isInput, const jack_latency_callback_mode_t mode, jack_latency_range_t& range, bool& found) const noexcept
+    {
+        jack_latency_range_t portRange;
+
+        for (typename LinkedList<T*>::Itenerator it = t.begin2(); it.valid(); it.next())
+        {
+            T* const port(it.getValue(nullptr));
+            CARLA_SAFE_ASSERT_CONTINUE(port != nullptr);
+
+            if (port->fJackPort == nullptr || port->isInput() != isInput)
+                continue;
+
+            jackbridge_port_get_latency_range(port->fJackPort, mode, &portRange);
+
+            if (found)
+            {
+                range.min = std::min(range.min, portRange.min);
+                range.max = std::max(range.max, portRange.max);
+            }
+            else
+            {
+                range = portRange;
+                found = true;
+            }
+        }
+    }
+
+    template<typename T>
+    void _setLatencyRange(const LinkedList<T*>& t, const bool isInput, const jack_latency_callback_mode_t mode, jack_latency_range_t& range) const noexcept
+    {
+        for (typename LinkedList<T*>::Itenerator it = t.begin2(); it.valid(); it.next())
+        {
+            T* const port(it.getValue(nullptr));
+            CARLA_SAFE_ASSERT_CONTINUE(port != nullptr);
+
+            if (port->fJackPort == nullptr || port->isInput() != isInput)
+                continue;
+
+            jackbridge_port_set_latency_range(port->fJackPort, mode, &range);
+        }
+    }
+
     template<typename T>
     void _savePortsConnections(const LinkedList<T*>& t, const CarlaString& clientNamePrefix)
     {
@@ -1325,6 +1410,21 @@ public:
         return true;
     }
 
+    void patchbayLatencyChanged() override
+    {
+        const uint32_t oldLatency(pData->graph.getLatency());
+
+        CarlaEngine::patchbayLatencyChanged();
+
+        // the compensated graph latency is reported through our ports
+        if (fClient != nullptr && oldLatency != pData->graph.getLatency())
+        {
+            try {
+                jackbridge_recompute_total_latencies(fClient);
+            } CARLA_SAFE_EXCEPTION("jack_recompute_total_latencies");
+        }
+    }
+
     // -------------------------------------------------------------------
     // Transport
 
@@ -1536,11 +1636,70 @@ protected:
 
         if (pData->options.processMode == ENGINE_PROCESS_MODE_SINGLE_CLIENT)
         {
-            for (uint i=0; i < pData->curPluginCount; ++i)
+            // Plugins do not feed each other within a cycle here, so bridges are started first and
+            // compute in their own processes while the in-process plugins run, then their results are collected.
+            // Bridges that cannot be started this way (like a busy group) are processed normally at the end.
+            const uint count(pData->curPluginCount);
+            bool bridges[count], kicked[count];
+            int64_t kickTimes[count];
+
+            for (uint i=0; i < count; ++i)
+            {
+                CarlaPlugin* const plugin(pData->plugins[i].plugin);
+
+                bridges[i] = kicked[i] = false;
+
+                if (plugin == nullptr || (plugin->getHints() & PLUGIN_IS_BRIDGE) == 0)
+                    continue;
+
+                bridges[i] = true;
+
+                if (plugin->isEnabled() && plugin->tryLock(fFreewheel))
+                {
+                    plugin->initBuffers();
+                    kickTimes[i] = Time::getHighResolutionTicks();
+
+                    if (processPlugin(plugin, nframes, kPluginProcessKick))
+                        kicked[i] = true;
+                    else
+                        plugin->unlock();
+                }
+            }
+
+            for (uint i=0; i < count; ++i)
             {
                 CarlaPlugin* const plugin(pData->plugins[i].plugin);
 
-                if (plugin != nullptr && plugin->isEnabled() && plugin->tryLock(fFreewheel))
+                if (bridges[i] || plugin == nullptr)
+                    continue;
+
+                if (plugin->isEnabled() && plugin->tryLock(fFreewheel))
+                {
+                    plugin->initBuffers();
+                    processPlugin(plugin, nframes);
+                    plugin->unlock();
+                }
+            }
+
+            for (uint i=0; i < count; ++i)
+            {
+                if (! kicked[i])
+                    continue;
+
+                CarlaPlugin* const plugin(pData->plugins[i].plugin);
+
+                processPlugin(plugin, nframes, kPluginProcessCollect, kickTimes[i]);
+                plugin->unlock();
+            }
+
+            for (uint i=0; i < count; ++i)
+            {
+                if (! bridges[i] || kicked[i])
+                    continue;
+
+                CarlaPlugin* const plugin(pData->plugins[i].plugin);
+
+                if (plugin->isEnabled() && plugin->tryLock(fFreewheel))
                 {
                     plugin->initBuffers();
                     processPlugin(plugin, nframes);
@@ -1577,8 +1736,9 @@ protected:
             /**/  float* outBuf[2] = { audioOut1, audioOut2 };
 
             // initialize events
-            carla_zeroStructs(pData->events.in,  kMaxEngineEventInternalCount);
-            carla_zeroStructs(pData->events.out, kMaxEngineEventInternalCount);
+            clearEngineEvents(pData->events.in);
+            clearEngineEvents(pData->events.out);
+            pData->events.dataExt.reset();
 
             {
                 ushort engineEventIndex = 0;
@@ -1591,16 +1751,18 @@ protected:
                     if (! jackbridge_midi_event_get(&jackEvent, eventIn, jackEventIndex))
                         continue;
 
-                    CARLA_SAFE_ASSERT_CONTINUE(jackEvent.size < 0xFF /* uint8_t max */);
+                    CARLA_SAFE_ASSERT_CONTINUE(jackEvent.size <= EngineMidiEvent::kMaxSize);
 
                     EngineEvent& engineEvent(pData->events.in[engineEventIndex++]);
 
                     engineEvent.time = jackEvent.time;
-                    engineEvent.fillFromMidiData(static_cast<uint8_t>(jackEvent.size), jackEvent.buffer, 0);
+                    engineEvent.fillFromMidiData(static_cast<uint16_t>(jackEvent.size), jackEvent.buffer, 0);
 
                     if (engineEventIndex >= kMaxEngineEventInternalCount)
                         break;
                 }
+
+                terminateEngineEvents(pData->events.in, engineEventIndex);
             }
 
             if (pData->options.processMode == ENGINE_PROCESS_MODE_CONTINUOUS_RACK)
@@ -1612,9 +1774,10 @@ protected:
             {
                 jackbridge_midi_clear_buffer(eventOut);
 
-                uint8_t        size    = 0;
-                uint8_t        data[3] = { 0, 0, 0 };
-                const uint8_t* dataPtr = data;
+                uint16_t       size     = 0;
+                uint8_t        ctrlSize = 0;
+                uint8_t        data[3]  = { 0, 0, 0 };
+                const uint8_t* dataPtr  = data;
 
                 for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
                 {
@@ -1626,7 +1789,8 @@ protected:
                     else if (engineEvent.type == kEngineEventTypeControl)
                     {
                         const EngineControlEvent& ctrlEvent(engineEvent.ctrl);
-                        ctrlEvent.convertToMidiData(engineEvent.channel, size, data);
+                        ctrlEvent.convertToMidiData(engineEvent.channel, ctrlSize, data);
+                        size    = ctrlSize;
                         dataPtr = data;
                     }
                     else if (engineEvent.type == kEngineEventTypeMidi)
@@ -1653,9 +1817,66 @@ protected:
 #endif // ! BUILD_BRIDGE
     }
 
-    void handleJackLatencyCallback(const jack_latency_callback_mode_t /*mode*/)
+    void handleJackLatencyCallback(const jack_latency_callback_mode_t mode)
     {
-        // TODO
+#ifndef BUILD_BRIDGE
+        if (pData->options.processMode == ENGINE_PROCESS_MODE_SINGLE_CLIENT)
+        {
+            for (uint i=0; i < pData->curPluginCount; ++i)
+            {
+                CarlaPlugin* const plugin(pData->plugins[i].plugin);
+
+                if (plugin == nullptr || ! plugin->isEnabled())
+                    continue;
+
+                if (CarlaEngineJackClient* const client = (CarlaEngineJackClient*)plugin->getEngineClient())
+                    client->handleLatencyCallback(mode);
+            }
+            return;
+        }
+
+        if (pData->options.processMode != ENGINE_PROCESS_MODE_CONTINUOUS_RACK &&
+            pData->options.processMode != ENGINE_PROCESS_MODE_PATCHBAY)
+            return;
+
+        // latency of the pipelined rack or patchbay delay compensation, added on top of what goes through it
+        const uint32_t latency(pData->graph.getLatency());
+
+        if (latency == 0)
+            return;
+
+        static const int kRackPortPairs[3][2] = {
+            { kRackPortAudioIn1, kRackPortAudioOut1 },
+            { kRackPortAudioIn2, kRackPortAudioOut2 },
+            { kRackPortEventIn,  kRackPortEventOut  }
+        };
+
+        jack_latency_range_t range;
+
+        for (int i=0; i<3; ++i)
+        {
+            jack_port_t* const inPort(fRackPorts[kRackPortPairs[i][0]]);
+            jack_port_t* const outPort(fRackPorts[kRackPortPairs[i][1]]);
+            CARLA_SAFE_ASSERT_CONTINUE(inPort != nullptr && outPort != nullptr);
+
+            if (mode == JackCaptureLatency)
+            {
+                jackbridge_port_get_latency_range(inPort, mode, &range);
+                range.min += latency;
+                range.max += latency;
+                jackbridge_port_set_latency_range(outPort, mode, &range);
+            }
+            else
+            {
+                jackbridge_port_get_latency_range(outPort, mode, &range);
+                range.min += latency;
+                range.max += latency;
+                jackbridge_port_set_latency_range(inPort, mode, &range);
+            }
+        }
+#else
+        (void)mode;
+#endif
     }
 
 #ifndef BUILD_BRIDGE
@@ -2127,7 +2348,15 @@ private:
 
     // -------------------------------------------------------------------
 
-    void processPlugin(CarlaPlugin* const plugin, const uint32_t nframes)
+    enum PluginProcessStep {
+        kPluginProcessFull,
+        kPluginProcessKick,   // processKick, only starts the plugin
+        kPluginProcessCollect // processCollect, finishes a kicked plugin
+    };
+
+    // returns false if a kick was refused, the plugin needs a full process then.
+    // kickTime is when a collected plugin was kicked, its dsp time goes from there
+    bool processPlugin(CarlaPlugin* const plugin, const uint32_t nframes, const PluginProcessStep step = kPluginProcessFull, const int64_t kickTime = 0)
     {
         const uint32_t audioInCount(plugin->getAudioInCount());
         const uint32_t audioOutCount(plugin->getAudioOutCount());
@@ -2163,6 +2392,9 @@ private:
             cvOut[i] = port->getBuffer();
         }
 
+        if (step == kPluginProcessKick)
+            return plugin->processKick(audioIn, audioOut, cvIn, cvOut, nframes);
+
         float inPeaks[2] = { 0.0f };
         float outPeaks[2] = { 0.0f };
 
@@ -2177,7 +2409,12 @@ private:
             }
         }
 
-        plugin->process(audioIn, audioOut, cvIn, cvOut, nframes);
+        const int64_t dspStart(step == kPluginProcessCollect ? kickTime : Time::getHighResolutionTicks());
+        if (step == kPluginProcessCollect)
+            plugin->processCollect(audioIn, audioOut, cvIn, cvOut, nframes);
+        else
+            plugin->process(audioIn, audioOut, cvIn, cvOut, nframes);
+        addPluginDspTime(plugin->getId(), dspStart);
 
         for (uint32_t i=0; i < audioOutCount && i < 2; ++i)
         {
@@ -2191,6 +2428,7 @@ private:
         }
 
         setPluginPeaks(plugin->getId(), inPeaks, outPeaks);
+        return true;
     }
 
     // -------------------------------------------------------------------
@@ -2284,9 +2522,13 @@ private:
         return 0;
     }
 
-    static void JACKBRIDGE_API carla_jack_latency_callback_plugin(jack_latency_callback_mode_t /*mode*/, void* /*arg*/)
+    static void JACKBRIDGE_API carla_jack_latency_callback_plugin(jack_latency_callback_mode_t mode, void* arg)
     {
-        // TODO
+        CarlaPlugin* const plugin((CarlaPlugin*)arg);
+        CARLA_SAFE_ASSERT_RETURN(plugin != nullptr,);
+
+        if (CarlaEngineJackClient* const client = (CarlaEngineJackClient*)plugin->getEngineClient())
+            client->handleLatencyCallback(mode);
     }
 
     static void JACKBRIDGE_API carla_jack_shutdown_callback_plugin(void* arg)
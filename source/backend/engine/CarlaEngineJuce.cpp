@@ -429,8 +429,9 @@ protected:
             FloatVectorOperations::clear(outputChannelData[i], numSamples);
 
         // initialize events
-        carla_zeroStructs(pData->events.in,  kMaxEngineEventInternalCount);
-        carla_zeroStructs(pData->events.out, kMaxEngineEventInternalCount);
+        clearEngineEvents(pData->events.in);
+        clearEngineEvents(pData->events.out);
+        pData->events.dataExt.reset();
 
         if (fMidiInEvents.mutex.tryLock())
         {
@@ -440,7 +441,13 @@ protected:
             for (LinkedList<RtMidiEvent>::Itenerator it = fMidiInEvents.data.begin2(); it.valid(); it.next())
             {
                 const RtMidiEvent& midiEvent(it.getValue());
-                EngineEvent&       engineEvent(pData->events.in[engineEventIndex++]);
+                EngineEvent&       engineEvent(pData->events.in[engineEventIndex]);
+
+                // event data goes back into the pool below, keep our own copy of long messages
+                if (! pData->events.dataExt.fillFromMidiData(engineEvent, midiEvent.size, midiEvent.data, 0))
+                    continue;
+
+                ++engineEventIndex;
 
                 if (midiEvent.time < pData->timeInfo.frame)
                 {
@@ -454,12 +461,12 @@ protected:
                 else
                     engineEvent.time = static_cast<uint32_t>(midiEvent.time - pData->timeInfo.frame);
 
-                engineEvent.fillFromMidiData(midiEvent.size, midiEvent.data, 0);
-
                 if (engineEventIndex >= kMaxEngineEventInternalCount)
                     break;
             }
 
+            terminateEngineEvents(pData->events.in, engineEventIndex);
+
             fMidiInEvents.data.clear();
             fMidiInEvents.mutex.unlock();
         }
@@ -470,9 +477,10 @@ protected:
 
         if (fMidiOuts.count() > 0)
         {
-            uint8_t        size    = 0;
-            uint8_t        data[3] = { 0, 0, 0 };
-            const uint8_t* dataPtr = data;
+            uint16_t       size     = 0;
+            uint8_t        ctrlSize = 0;
+            uint8_t        data[3]  = { 0, 0, 0 };
+            const uint8_t* dataPtr  = data;
 
             for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
             {
@@ -484,7 +492,8 @@ protected:
                 else if (engineEvent.type == kEngineEventTypeControl)
                 {
                     const EngineControlEvent& ctrlEvent(engineEvent.ctrl);
-                    ctrlEvent.convertToMidiData(engineEvent.channel, size, data);
+                    ctrlEvent.convertToMidiData(engineEvent.channel, ctrlSize, data);
+                    size    = ctrlSize;
                     dataPtr = data;
                 }
                 else if (engineEvent.type == kEngineEventTypeMidi)
@@ -540,7 +549,7 @@ protected:
     {
         const int messageSize(message.getRawDataSize());
 
-        if (messageSize <= 0 || messageSize > EngineMidiEvent::kDataSize)
+        if (messageSize <= 0 || messageSize > 0xFF /* uint8_t max */)
             return;
 
         const uint8_t* const messageData(message.getRawData());
@@ -690,7 +699,7 @@ private:
     struct RtMidiEvent {
         uint64_t time; // needs to compare to internal time
         uint8_t  size;
-        uint8_t  data[EngineMidiEvent::kDataSize];
+        uint8_t  data[0xFF]; // uint8_t max, longer input messages are dropped
     };
 
     struct RtMidiEvents {
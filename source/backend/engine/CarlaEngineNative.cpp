@@ -49,8 +49,6 @@ using juce::FloatVectorOperations;
 using juce::MemoryOutputStream;
 using juce::ScopedPointer;
 using juce::String;
-using juce::XmlDocument;
-using juce::XmlElement;
 
 static bool gNeedsJuceHandling = false;
 static int  gJuceReferenceCounter = 0;
@@ -1001,6 +999,25 @@ protected:
             }
             break;
 
+        case ENGINE_CALLBACK_PARAMETER_VALUES_CHANGED:
+            plugin = getPlugin(pluginId);
+
+            // the pipe protocol has no batch message, send each change on its own
+            if (plugin != nullptr && plugin->isEnabled())
+            {
+                uint32_t indexes[64];
+                float    values[64];
+
+                for (uint32_t count = 64; count == 64;)
+                {
+                    count = plugin->takeParameterChanges(indexes, values, 64);
+
+                    for (uint32_t i=0; i < count; ++i)
+                        uiServerCallback(ENGINE_CALLBACK_PARAMETER_VALUE_CHANGED, pluginId, static_cast<int>(indexes[i]), 0, values[i], nullptr);
+                }
+            }
+            return;
+
         default:
             break;
         }
@@ -1359,8 +1376,9 @@ protected:
         // ---------------------------------------------------------------
         // initialize events
 
-        carla_zeroStructs(pData->events.in,  kMaxEngineEventInternalCount);
-        carla_zeroStructs(pData->events.out, kMaxEngineEventInternalCount);
+        clearEngineEvents(pData->events.in);
+        clearEngineEvents(pData->events.out);
+        pData->events.dataExt.reset();
 
         // ---------------------------------------------------------------
         // events input (before processing)
@@ -1379,6 +1397,8 @@ protected:
                 if (engineEventIndex >= kMaxEngineEventInternalCount)
                     break;
             }
+
+            terminateEngineEvents(pData->events.in, engineEventIndex);
         }
 
         if (kIsPatchbay)
@@ -1405,7 +1425,7 @@ protected:
         // ---------------------------------------------------------------
         // events output (after processing)
 
-        carla_zeroStructs(pData->events.in, kMaxEngineEventInternalCount);
+        clearEngineEvents(pData->events.in);
 
         {
             NativeMidiEvent midiEvent;
@@ -1430,7 +1450,7 @@ protected:
                         continue;
 
                     midiEvent.port = engineEvent.midi.port;
-                    midiEvent.size = engineEvent.midi.size;
+                    midiEvent.size = static_cast<uint8_t>(engineEvent.midi.size);
 
                     midiEvent.data[0] = static_cast<uint8_t>(engineEvent.midi.data[0] + engineEvent.channel);
 
@@ -1523,6 +1543,9 @@ protected:
 
     void uiIdle()
     {
+        // patchbay changes from the UI are handled here
+        pData->graph.idle();
+
         for (uint i=0; i < pData->curPluginCount; ++i)
         {
             CarlaPlugin* const plugin(pData->plugins[i].plugin);
@@ -1617,7 +1640,8 @@ protected:
     {
         MemoryOutputStream out;
         saveProjectInternal(out);
-        return strdup(out.toString().toRawUTF8());
+        out.writeByte('\0');
+        return strdup(static_cast<const char*>(out.getData()));
     }
 
     void setState(const char* const data)
@@ -1636,9 +1660,7 @@ protected:
             pData->thread.startThread();
 
         fOptionsForced = true;
-        const String state(data);
-        XmlDocument xml(state);
-        loadProjectInternal(xml);
+        loadProjectInternal(data, std::strlen(data), nullptr);
     }
 
     // -------------------------------------------------------------------
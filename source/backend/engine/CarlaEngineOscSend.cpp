@@ -21,6 +21,7 @@
 
 #include "CarlaBackendUtils.hpp"
 #include "CarlaEngineInternal.hpp"
+#include "CarlaMathUtils.hpp"
 #include "CarlaMIDI.h"
 
 CARLA_BACKEND_START_NAMESPACE
@@ -379,8 +380,17 @@ void CarlaEngine::oscSend_control_set_peaks(const uint pluginId) const noexcept
     CARLA_SAFE_ASSERT_RETURN(pData->oscData->target != nullptr,);
     CARLA_SAFE_ASSERT_RETURN(pluginId < pData->curPluginCount,);
 
-    // TODO - try and see if we can get peaks[4] ref
-    const EnginePluginData& epData(pData->plugins[pluginId]);
+    EnginePluginData& epData(pData->plugins[pluginId]);
+
+    // nothing to do if the peaks did not change since the last send
+    if (carla_isEqual(epData.oscPeaks[0], epData.insPeak[0])  && carla_isEqual(epData.oscPeaks[1], epData.insPeak[1]) &&
+        carla_isEqual(epData.oscPeaks[2], epData.outsPeak[0]) && carla_isEqual(epData.oscPeaks[3], epData.outsPeak[1]))
+        return;
+
+    epData.oscPeaks[0] = epData.insPeak[0];
+    epData.oscPeaks[1] = epData.insPeak[1];
+    epData.oscPeaks[2] = epData.outsPeak[0];
+    epData.oscPeaks[3] = epData.outsPeak[1];
 
     char targetPath[std::strlen(pData->oscData->path)+11];
     std::strcpy(targetPath, pData->oscData->path);
@@ -388,6 +398,22 @@ void CarlaEngine::oscSend_control_set_peaks(const uint pluginId) const noexcept
     try_lo_send(pData->oscData->target, targetPath, "iffff", static_cast<int32_t>(pluginId), epData.insPeak[0], epData.insPeak[1], epData.outsPeak[0], epData.outsPeak[1]);
 }
 
+void CarlaEngine::oscSend_control_set_dsp_stats(const uint pluginId) const noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(pData->oscData != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(pData->oscData->path != nullptr && pData->oscData->path[0] != '\0',);
+    CARLA_SAFE_ASSERT_RETURN(pData->oscData->target != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(pluginId < pData->curPluginCount,);
+
+    EnginePluginDspStats stats;
+    getPluginDspStats(pluginId, stats);
+
+    char targetPath[std::strlen(pData->oscData->path)+15];
+    std::strcpy(targetPath, pData->oscData->path);
+    std::strcat(targetPath, "/set_dsp_stats");
+    try_lo_send(pData->oscData->target, targetPath, "ifffff", static_cast<int32_t>(pluginId), stats.minTime, stats.avgTime, stats.maxTime, stats.p99Time, stats.load);
+}
+
 void CarlaEngine::oscSend_control_exit() const noexcept
 {
     CARLA_SAFE_ASSERT_RETURN(pData->oscData != nullptr,);
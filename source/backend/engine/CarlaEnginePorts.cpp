@@ -83,15 +83,47 @@ void CarlaEngineCVPort::initBuffer() noexcept
 // -----------------------------------------------------------------------
 // Carla Engine Event port
 
+static const uint32_t kUnknownEventCount = 0xFFFFFFFF;
+
+// Find the next free event in @a buffer, starting at @a cursor.
+// @a writeCount is the number of events this port wrote since its last initBuffer(), when zero the search starts over.
+// The event after the returned one is set to null, so the buffer stays terminated.
+static EngineEvent* getNextFreeEngineEvent(EngineEvent* const buffer, uint32_t& writeCount, uint32_t& cursor) noexcept
+{
+    if (writeCount == 0)
+        cursor = 0;
+
+    // skip events written by other ports sharing this buffer
+    for (uint32_t i=cursor; i < kMaxEngineEventInternalCount; ++i)
+    {
+        if (buffer[i].type != kEngineEventTypeNull)
+            continue;
+
+        terminateEngineEvents(buffer, i+1);
+        cursor = i+1;
+        ++writeCount;
+        return &buffer[i];
+    }
+
+    cursor = kMaxEngineEventInternalCount;
+    return nullptr;
+}
+
 CarlaEngineEventPort::CarlaEngineEventPort(const CarlaEngineClient& client, const bool isInputPort, const uint32_t indexOffset) noexcept
     : CarlaEnginePort(client, isInputPort, indexOffset),
       fBuffer(nullptr),
+      fEventCount(isInputPort ? kUnknownEventCount : 0),
+      fWriteCount(0),
+      fWritePos(0),
       kProcessMode(client.getEngine().getProccessMode())
 {
     carla_debug("CarlaEngineEventPort::CarlaEngineEventPort(%s)", bool2str(isInputPort));
 
     if (kProcessMode == ENGINE_PROCESS_MODE_PATCHBAY)
+    {
         fBuffer = new EngineEvent[kMaxEngineEventInternalCount];
+        carla_zeroStructs(fBuffer, kMaxEngineEventInternalCount);
+    }
 }
 
 CarlaEngineEventPort::~CarlaEngineEventPort() noexcept
@@ -109,10 +141,14 @@ CarlaEngineEventPort::~CarlaEngineEventPort() noexcept
 
 void CarlaEngineEventPort::initBuffer() noexcept
 {
+    fEventCount = kIsInput ? kUnknownEventCount : 0;
+    fWriteCount = 0;
+    fWritePos   = 0;
+
     if (kProcessMode == ENGINE_PROCESS_MODE_CONTINUOUS_RACK || kProcessMode == ENGINE_PROCESS_MODE_BRIDGE)
         fBuffer = kClient.getEngine().getInternalEventBuffer(kIsInput);
     else if (kProcessMode == ENGINE_PROCESS_MODE_PATCHBAY && ! kIsInput)
-        carla_zeroStructs(fBuffer, kMaxEngineEventInternalCount);
+        clearEngineEvents(fBuffer);
 }
 
 uint32_t CarlaEngineEventPort::getEventCount() const noexcept
@@ -121,15 +157,11 @@ uint32_t CarlaEngineEventPort::getEventCount() const noexcept
     CARLA_SAFE_ASSERT_RETURN(fBuffer != nullptr, 0);
     CARLA_SAFE_ASSERT_RETURN(kProcessMode != ENGINE_PROCESS_MODE_SINGLE_CLIENT && kProcessMode != ENGINE_PROCESS_MODE_MULTIPLE_CLIENTS, 0);
 
-    uint32_t i=0;
+    // input events are filled by the engine after initBuffer(), count them once per cycle
+    if (fEventCount == kUnknownEventCount)
+        fEventCount = getEngineEventCount(fBuffer);
 
-    for (; i < kMaxEngineEventInternalCount; ++i)
-    {
-        if (fBuffer[i].type == kEngineEventTypeNull)
-            break;
-    }
-
-    return i;
+    return fEventCount;
 }
 
 const EngineEvent& CarlaEngineEventPort::getEvent(const uint32_t index) const noexcept
@@ -165,29 +197,26 @@ bool CarlaEngineEventPort::writeControlEvent(const uint32_t time, const uint8_t
         CARLA_SAFE_ASSERT(! MIDI_IS_CONTROL_BANK_SELECT(param));
     }
 
-    for (uint32_t i=0; i < kMaxEngineEventInternalCount; ++i)
-    {
-        EngineEvent& event(fBuffer[i]);
-
-        if (event.type != kEngineEventTypeNull)
-            continue;
+    EngineEvent* const event(getNextFreeEngineEvent(fBuffer, fWriteCount, fWritePos));
 
-        event.type    = kEngineEventTypeControl;
-        event.time    = time;
-        event.channel = channel;
+    if (event == nullptr)
+    {
+        carla_stderr2("CarlaEngineEventPort::writeControlEvent() - buffer full");
+        return false;
+    }
 
-        event.ctrl.type  = type;
-        event.ctrl.param = param;
-        event.ctrl.value = carla_fixedValue<float>(0.0f, 1.0f, value);
+    event->type    = kEngineEventTypeControl;
+    event->time    = time;
+    event->channel = channel;
 
-        return true;
-    }
+    event->ctrl.type  = type;
+    event->ctrl.param = param;
+    event->ctrl.value = carla_fixedValue<float>(0.0f, 1.0f, value);
 
-    carla_stderr2("CarlaEngineEventPort::writeControlEvent() - buffer full");
-    return false;
+    return true;
 }
 
-bool CarlaEngineEventPort::writeMidiEvent(const uint32_t time, const uint8_t size, const uint8_t* const data) noexcept
+bool CarlaEngineEventPort::writeMidiEvent(const uint32_t time, const uint16_t size, const uint8_t* const data) noexcept
 {
     return writeMidiEvent(time, uint8_t(MIDI_GET_CHANNEL_FROM_DATA(data)), size, data);
 }
@@ -198,94 +227,111 @@ bool CarlaEngineEventPort::writeMidiEvent(const uint32_t time, const uint8_t cha
     return writeMidiEvent(time, channel, midi.size, midi.data);
 }
 
-bool CarlaEngineEventPort::writeMidiEvent(const uint32_t time, const uint8_t channel, const uint8_t size, const uint8_t* const data) noexcept
+bool CarlaEngineEventPort::writeMidiEvent(const uint32_t time, const uint8_t channel, const uint16_t size, const uint8_t* const data) noexcept
 {
     CARLA_SAFE_ASSERT_RETURN(! kIsInput, false);
     CARLA_SAFE_ASSERT_RETURN(fBuffer != nullptr, false);
     CARLA_SAFE_ASSERT_RETURN(kProcessMode != ENGINE_PROCESS_MODE_SINGLE_CLIENT && kProcessMode != ENGINE_PROCESS_MODE_MULTIPLE_CLIENTS, false);
     CARLA_SAFE_ASSERT_RETURN(channel < MAX_MIDI_CHANNELS, false);
-    CARLA_SAFE_ASSERT_RETURN(size > 0 && size <= EngineMidiEvent::kDataSize, false);
+    CARLA_SAFE_ASSERT_RETURN(size > 0, false);
     CARLA_SAFE_ASSERT_RETURN(data != nullptr, false);
 
-    for (uint32_t i=0; i < kMaxEngineEventInternalCount; ++i)
+    const uint8_t status(uint8_t(MIDI_GET_STATUS_FROM_DATA(data)));
+    const uint8_t* dataExt = nullptr;
+
+    // long messages (sysex and such) are kept in the engine's per-cycle storage, which bounds their size
+    if (size > EngineMidiEvent::kDataSize)
     {
-        EngineEvent& event(fBuffer[i]);
+        dataExt = kClient.getEngine().copyInternalEventData(data, size);
 
-        if (event.type != kEngineEventTypeNull)
-            continue;
+        if (dataExt == nullptr)
+        {
+            carla_stderr2("CarlaEngineEventPort::writeMidiEvent() - no space left for long event");
+            return false;
+        }
+    }
 
-        event.time    = time;
-        event.channel = channel;
+    EngineControlEventType ctrlType = kEngineControlEventTypeNull;
+    uint16_t ctrlParam = 0;
 
-        const uint8_t status(uint8_t(MIDI_GET_STATUS_FROM_DATA(data)));
+    if (status == MIDI_STATUS_CONTROL_CHANGE)
+    {
+        CARLA_SAFE_ASSERT_RETURN(size >= 3, true);
 
-        if (status == MIDI_STATUS_CONTROL_CHANGE)
+        switch (data[1])
         {
-            CARLA_SAFE_ASSERT_RETURN(size >= 3, true);
-
-            switch (data[1])
-            {
-            case MIDI_CONTROL_BANK_SELECT:
-            case MIDI_CONTROL_BANK_SELECT__LSB:
-                event.type       = kEngineEventTypeControl;
-                event.ctrl.type  = kEngineControlEventTypeMidiBank;
-                event.ctrl.param = data[2];
-                event.ctrl.value = 0.0f;
-                return true;
-
-            case MIDI_CONTROL_ALL_SOUND_OFF:
-                event.type       = kEngineEventTypeControl;
-                event.ctrl.type  = kEngineControlEventTypeAllSoundOff;
-                event.ctrl.param = 0;
-                event.ctrl.value = 0.0f;
-                return true;
-
-            case MIDI_CONTROL_ALL_NOTES_OFF:
-                event.type       = kEngineEventTypeControl;
-                event.ctrl.type  = kEngineControlEventTypeAllNotesOff;
-                event.ctrl.param = 0;
-                event.ctrl.value = 0.0f;
-                return true;
-            }
+        case MIDI_CONTROL_BANK_SELECT:
+        case MIDI_CONTROL_BANK_SELECT__LSB:
+            ctrlType  = kEngineControlEventTypeMidiBank;
+            ctrlParam = data[2];
+            break;
+        case MIDI_CONTROL_ALL_SOUND_OFF:
+            ctrlType  = kEngineControlEventTypeAllSoundOff;
+            break;
+        case MIDI_CONTROL_ALL_NOTES_OFF:
+            ctrlType  = kEngineControlEventTypeAllNotesOff;
+            break;
         }
+    }
+    else if (status == MIDI_STATUS_PROGRAM_CHANGE)
+    {
+        CARLA_SAFE_ASSERT_RETURN(size == 2, true);
 
-        if (status == MIDI_STATUS_PROGRAM_CHANGE)
-        {
-            CARLA_SAFE_ASSERT_RETURN(size == 2, true);
+        ctrlType  = kEngineControlEventTypeMidiBank;
+        ctrlParam = data[1];
+    }
 
-            event.type       = kEngineEventTypeControl;
-            event.ctrl.type  = kEngineControlEventTypeMidiBank;
-            event.ctrl.param = data[1];
-            event.ctrl.value = 0.0f;
-            return true;
-        }
+    EngineEvent* const event(getNextFreeEngineEvent(fBuffer, fWriteCount, fWritePos));
 
-        event.type      = kEngineEventTypeMidi;
-        event.midi.size = size;
+    if (event == nullptr)
+    {
+        carla_stderr2("CarlaEngineEventPort::writeMidiEvent() - buffer full");
+        return false;
+    }
 
-        if (kIndexOffset < 0xFF /* uint8_t max */)
-        {
-            event.midi.port = kIndexOffset;
-        }
-        else
-        {
-            event.midi.port = 0;
-            carla_safe_assert_int("kIndexOffset < 0xFF", __FILE__, __LINE__, kIndexOffset);
-        }
+    event->time    = time;
+    event->channel = channel;
 
-        event.midi.data[0] = status;
+    if (ctrlType != kEngineControlEventTypeNull)
+    {
+        event->type       = kEngineEventTypeControl;
+        event->ctrl.type  = ctrlType;
+        event->ctrl.param = ctrlParam;
+        event->ctrl.value = 0.0f;
+        return true;
+    }
+
+    event->type      = kEngineEventTypeMidi;
+    event->midi.size = size;
 
-        uint8_t j=1;
-        for (; j < size; ++j)
-            event.midi.data[j] = data[j];
-        for (; j < EngineMidiEvent::kDataSize; ++j)
-            event.midi.data[j] = 0;
+    if (kIndexOffset < 0xFF /* uint8_t max */)
+    {
+        event->midi.port = kIndexOffset;
+    }
+    else
+    {
+        event->midi.port = 0;
+        carla_safe_assert_int("kIndexOffset < 0xFF", __FILE__, __LINE__, kIndexOffset);
+    }
 
+    if (dataExt != nullptr)
+    {
+        std::memset(event->midi.data, 0, sizeof(uint8_t)*EngineMidiEvent::kDataSize);
+        event->midi.dataExt = dataExt;
         return true;
     }
 
-    carla_stderr2("CarlaEngineEventPort::writeMidiEvent() - buffer full");
-    return false;
+    event->midi.data[0] = status;
+
+    uint8_t j=1;
+    for (; j < size; ++j)
+        event->midi.data[j] = data[j];
+    for (; j < EngineMidiEvent::kDataSize; ++j)
+        event->midi.data[j] = 0;
+
+    event->midi.dataExt = nullptr;
+
+    return true;
 }
 
 // -----------------------------------------------------------------------
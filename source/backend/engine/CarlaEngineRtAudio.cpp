@@ -176,6 +176,9 @@ public:
 
         // just to make sure
         pData->options.transportMode = ENGINE_TRANSPORT_MODE_INTERNAL;
+
+        // long messages must not allocate in the audio thread
+        fMidiOutVector.reserve(0xFF);
     }
 
     ~CarlaEngineRtAudio() override
@@ -598,8 +601,9 @@ protected:
         }
 
         // initialize events
-        carla_zeroStructs(pData->events.in,  kMaxEngineEventInternalCount);
-        carla_zeroStructs(pData->events.out, kMaxEngineEventInternalCount);
+        clearEngineEvents(pData->events.in);
+        clearEngineEvents(pData->events.out);
+        pData->events.dataExt.reset();
 
         if (fMidiInEvents.mutex.tryLock())
         {
@@ -608,12 +612,19 @@ protected:
 
             for (LinkedList<RtMidiEvent>::Itenerator it = fMidiInEvents.data.begin2(); it.valid(); it.next())
             {
-                static const RtMidiEvent fallback = { 0, 0, { 0 } };
+                static const RtMidiEvent fallback = { 0, 0, { 0 }, nullptr };
 
                 const RtMidiEvent& midiEvent(it.getValue(fallback));
                 CARLA_SAFE_ASSERT_CONTINUE(midiEvent.size > 0);
 
-                EngineEvent& engineEvent(pData->events.in[engineEventIndex++]);
+                EngineEvent& engineEvent(pData->events.in[engineEventIndex]);
+
+                // long message data is released below, keep our own copy for this cycle
+                if (! pData->events.dataExt.fillFromMidiData(engineEvent, midiEvent.size,
+                                                             midiEvent.dataExt != nullptr ? midiEvent.dataExt : midiEvent.data, 0))
+                    continue;
+
+                ++engineEventIndex;
 
                 if (midiEvent.time < pData->timeInfo.frame)
                 {
@@ -627,13 +638,14 @@ protected:
                 else
                     engineEvent.time = static_cast<uint32_t>(midiEvent.time - pData->timeInfo.frame);
 
-                engineEvent.fillFromMidiData(midiEvent.size, midiEvent.data, 0);
-
                 if (engineEventIndex >= kMaxEngineEventInternalCount)
                     break;
             }
 
+            terminateEngineEvents(pData->events.in, engineEventIndex);
+
             fMidiInEvents.data.clear();
+            fMidiInEvents.dataExt.reset();
             fMidiInEvents.mutex.unlock();
         }
 
@@ -643,9 +655,10 @@ protected:
 
         if (fMidiOuts.count() > 0)
         {
-            uint8_t        size    = 0;
-            uint8_t        data[3] = { 0, 0, 0 };
-            const uint8_t* dataPtr = data;
+            uint16_t       size     = 0;
+            uint8_t        ctrlSize = 0;
+            uint8_t        data[3]  = { 0, 0, 0 };
+            const uint8_t* dataPtr  = data;
 
             for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
             {
@@ -657,7 +670,8 @@ protected:
                 else if (engineEvent.type == kEngineEventTypeControl)
                 {
                     const EngineControlEvent& ctrlEvent(engineEvent.ctrl);
-                    ctrlEvent.convertToMidiData(engineEvent.channel, size, data);
+                    ctrlEvent.convertToMidiData(engineEvent.channel, ctrlSize, data);
+                    size    = ctrlSize;
                     dataPtr = data;
                 }
                 else if (engineEvent.type == kEngineEventTypeMidi)
@@ -710,7 +724,7 @@ protected:
     {
         const size_t messageSize(message->size());
 
-        if (messageSize == 0 || messageSize > EngineMidiEvent::kDataSize)
+        if (messageSize == 0 || messageSize > EngineMidiEvent::kMaxSize)
             return;
 
         timeStamp /= 2;
@@ -728,7 +742,15 @@ protected:
         else
             fLastEventTime = midiEvent.time;
 
-        midiEvent.size = static_cast<uint8_t>(messageSize);
+        midiEvent.size    = static_cast<uint16_t>(messageSize);
+        midiEvent.dataExt = nullptr;
+
+        if (messageSize > EngineMidiEvent::kDataSize)
+        {
+            carla_zeroBytes(midiEvent.data, EngineMidiEvent::kDataSize);
+            fMidiInEvents.append(midiEvent, &message->front());
+            return;
+        }
 
         size_t i=0;
         for (; i < messageSize; ++i)
@@ -736,7 +758,7 @@ protected:
         for (; i < EngineMidiEvent::kDataSize; ++i)
             midiEvent.data[i] = 0;
 
-        fMidiInEvents.append(midiEvent);
+        fMidiInEvents.append(midiEvent, nullptr);
     }
 
     // -------------------------------------------------------------------
@@ -761,7 +783,7 @@ protected:
             newRtMidiPortName += portName;
 
             RtMidiIn* const rtMidiIn(new RtMidiIn(getMatchedAudioMidiAPI(fAudio.getCurrentApi()), newRtMidiPortName.buffer(), 512));
-            rtMidiIn->ignoreTypes();
+            rtMidiIn->ignoreTypes(false /* sysex */, true /* time */, true /* sense */);
             rtMidiIn->setCallback(carla_rtmidi_callback, this);
 
             bool found = false;
@@ -940,8 +962,9 @@ private:
 
     struct RtMidiEvent {
         uint64_t time; // needs to compare to internal time
-        uint8_t  size;
+        uint16_t size;
         uint8_t  data[EngineMidiEvent::kDataSize];
+        const uint8_t* dataExt; // long messages, in RtMidiEvents::dataExt
     };
 
     struct RtMidiEvents {
@@ -950,22 +973,40 @@ private:
         RtLinkedList<RtMidiEvent> data;
         RtLinkedList<RtMidiEvent> dataPending;
 
+        // long messages until the audio thread takes them, released together with the events
+        EngineEventDataArena dataExt;
+
         RtMidiEvents()
             : mutex(),
               dataPool(512, 512),
               data(dataPool),
-              dataPending(dataPool) {}
+              dataPending(dataPool),
+              dataExt()
+        {
+            dataExt.create(kMaxEngineEventInternalDataSize);
+        }
 
         ~RtMidiEvents()
         {
             clear();
         }
 
-        void append(const RtMidiEvent& event)
+        // long message data is copied, messages that don't fit are dropped
+        void append(const RtMidiEvent& event, const uint8_t* const longData)
         {
-            mutex.lock();
-            dataPending.append(event);
-            mutex.unlock();
+            const CarlaMutexLocker cml(mutex);
+
+            if (longData == nullptr)
+            {
+                dataPending.append(event);
+                return;
+            }
+
+            RtMidiEvent longEvent(event);
+            longEvent.dataExt = dataExt.copy(longData, event.size);
+
+            if (longEvent.dataExt != nullptr)
+                dataPending.append(longEvent);
         }
 
         void clear()
@@ -973,6 +1014,7 @@ private:
             mutex.lock();
             data.clear();
             dataPending.clear();
+            dataExt.reset();
             mutex.unlock();
         }
 
@@ -48,6 +48,9 @@ void CarlaEngineThread::run() noexcept
 
 #ifdef HAVE_LIBLO
     const bool isPlugin(kEngine->getType() == kEngineTypePlugin);
+#endif
+#if defined(HAVE_LIBLO) && ! defined(BUILD_BRIDGE)
+    uint oscDspStatsCounter = 0;
 #endif
     float value;
 
@@ -59,6 +62,9 @@ void CarlaEngineThread::run() noexcept
     {
 #if defined(HAVE_LIBLO) && ! defined(BUILD_BRIDGE)
         const bool oscRegisted = kEngine->isOscControlRegistered();
+
+        // dsp stats change slowly, send them about 4 times per second
+        const bool oscSendDspStats = oscRegisted && ++oscDspStatsCounter % 10 == 0;
 #else
         const bool oscRegisted = false;
 #endif
@@ -100,6 +106,10 @@ void CarlaEngineThread::run() noexcept
 
                     value = plugin->getParameterValue(j);
 
+                    // skip values that did not change since the last tick
+                    if (! plugin->checkParameterOutputChanged(j, value))
+                        continue;
+
 #if defined(HAVE_LIBLO) && ! defined(BUILD_BRIDGE)
                     // Update OSC engine client
                     if (oscRegisted)
@@ -124,6 +134,9 @@ void CarlaEngineThread::run() noexcept
 
             if (oscRegisted)
                 kEngine->oscSend_control_set_peaks(i);
+
+            if (oscSendDspStats)
+                kEngine->oscSend_control_set_dsp_stats(i);
 #endif
         }
 
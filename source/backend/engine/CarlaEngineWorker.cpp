@@ -0,0 +1,514 @@
+/*
+ * Carla Plugin Host
+ * Copyright (C) 2015 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#include "CarlaEngineInternal.hpp"
+#include "CarlaSemUtils.hpp"
+
+#include "juce_core.h"
+
+using juce::Time;
+
+CARLA_BACKEND_START_NAMESPACE
+
+// -----------------------------------------------------------------------
+// Single producer, single consumer message queue.
+// Positions are free running byte counters, the buffer size is a power of 2 so they wrap cleanly.
+
+struct EngineWorkerQueue {
+    static const uint32_t kSize = 16384;
+
+    struct Header {
+        uint32_t size;
+        uint32_t reserved;
+        int64_t  ticks;
+    };
+
+    uint8_t  buf[kSize];
+    uint32_t head; // bytes written, only changed by the producer
+    uint32_t tail; // bytes read, only changed by the consumer
+
+    EngineWorkerQueue() noexcept
+        : head(0),
+          tail(0)
+    {
+        carla_zeroBytes(buf, kSize);
+    }
+
+    // writes nothing if the whole message does not fit
+    bool write(const void* const data, const uint32_t size, const int64_t ticks) noexcept
+    {
+        const uint32_t total(static_cast<uint32_t>(sizeof(Header)) + size);
+        const uint32_t wpos(head);
+        const uint32_t rpos(__atomic_load_n(&tail, __ATOMIC_ACQUIRE));
+
+        if (total > kSize - (wpos - rpos))
+            return false;
+
+        Header header;
+        header.size     = size;
+        header.reserved = 0;
+        header.ticks    = ticks;
+
+        _copyIn(wpos, &header, sizeof(Header));
+
+        if (size > 0)
+            _copyIn(wpos + sizeof(Header), data, size);
+
+        __atomic_store_n(&head, wpos + total, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    // data must be at least kSize bytes
+    bool read(uint32_t& size, int64_t& ticks, uint8_t* const data) noexcept
+    {
+        const uint32_t rpos(tail);
+        const uint32_t wpos(__atomic_load_n(&head, __ATOMIC_ACQUIRE));
+
+        if (wpos == rpos)
+            return false;
+
+        Header header;
+        _copyOut(rpos, &header, sizeof(Header));
+        CARLA_SAFE_ASSERT_RETURN(header.size + sizeof(Header) <= wpos - rpos, false);
+
+        if (header.size > 0)
+            _copyOut(rpos + sizeof(Header), data, header.size);
+
+        size  = header.size;
+        ticks = header.ticks;
+
+        __atomic_store_n(&tail, rpos + static_cast<uint32_t>(sizeof(Header)) + header.size, __ATOMIC_RELEASE);
+        return true;
+    }
+
+private:
+    void _copyIn(uint32_t pos, const void* const src, const uint32_t size) noexcept
+    {
+        pos &= kSize - 1;
+
+        const uint32_t firstpart(std::min(size, kSize - pos));
+        std::memcpy(buf + pos, src, firstpart);
+
+        if (firstpart < size)
+            std::memcpy(buf, static_cast<const uint8_t*>(src) + firstpart, size - firstpart);
+    }
+
+    void _copyOut(uint32_t pos, void* const dst, const uint32_t size) const noexcept
+    {
+        pos &= kSize - 1;
+
+        const uint32_t firstpart(std::min(size, kSize - pos));
+        std::memcpy(dst, buf + pos, firstpart);
+
+        if (firstpart < size)
+            std::memcpy(static_cast<uint8_t*>(dst) + firstpart, buf, size - firstpart);
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(EngineWorkerQueue)
+};
+
+// -----------------------------------------------------------------------
+// Carla Engine worker client data
+
+struct CarlaEngineWorkerClient::ProtectedData {
+    CarlaEngine* const engine;
+    CarlaPlugin* const plugin;
+    EngineWorkerThread* thread;
+
+    // audio thread -> worker thread
+    EngineWorkerQueue requests;
+    uint8_t requestData[EngineWorkerQueue::kSize];
+
+    // worker thread -> audio thread
+    EngineWorkerQueue responses;
+    uint8_t responseData[EngineWorkerQueue::kSize];
+
+    // stats, read without locking
+    uint32_t pending;
+    uint32_t maxPending;
+    uint32_t droppedJobs;
+    uint32_t droppedResponses;
+    uint32_t jobs;
+    double   totalLatency;
+    double   totalJobTime;
+    float    maxLatency;
+    float    maxJobTime;
+
+    ProtectedData(CarlaEngine* const eng, CarlaPlugin* const p) noexcept
+        : engine(eng),
+          plugin(p),
+          thread(nullptr),
+          requests(),
+          responses(),
+          pending(0),
+          maxPending(0),
+          droppedJobs(0),
+          droppedResponses(0),
+          jobs(0),
+          totalLatency(0.0),
+          totalJobTime(0.0),
+          maxLatency(0.0f),
+          maxJobTime(0.0f) {}
+
+#ifdef CARLA_PROPER_CPP11_SUPPORT
+    ProtectedData() = delete;
+    CARLA_DECLARE_NON_COPY_STRUCT(ProtectedData)
+#endif
+};
+
+// -----------------------------------------------------------------------
+// Engine worker thread
+
+class EngineWorkerThread : public CarlaThread
+{
+public:
+    EngineWorkerThread()
+        : CarlaThread("EngineWorker"),
+          fMutex(),
+          fClients(),
+          fSem()
+    {
+        carla_sem_create2(fSem);
+    }
+
+    ~EngineWorkerThread() override
+    {
+        CARLA_SAFE_ASSERT(fClients.count() == 0);
+        fClients.clear();
+
+        carla_sem_destroy2(fSem);
+    }
+
+    std::size_t getClientCount() const noexcept
+    {
+        return fClients.count();
+    }
+
+    void addClient(CarlaEngineWorkerClient* const client) noexcept
+    {
+        const CarlaMutexLocker cml(fMutex);
+
+        fClients.append(client);
+    }
+
+    void removeClient(CarlaEngineWorkerClient* const client) noexcept
+    {
+        const CarlaMutexLocker cml(fMutex);
+
+        fClients.removeOne(client);
+    }
+
+    // called from the audio thread
+    void wake() noexcept
+    {
+        carla_sem_post(fSem);
+    }
+
+    void stop() noexcept
+    {
+        signalThreadShouldExit();
+        carla_sem_post(fSem);
+        stopThread(-1);
+    }
+
+    // Runs the pending jobs of a client and then a new one, from the calling thread.
+    // Used when the engine is offline.
+    void runJobNow(CarlaEngineWorkerClient* const client, const uint32_t size, const void* const data) noexcept
+    {
+        const CarlaMutexLocker cml(fMutex);
+
+        runPendingJobs(client);
+        runJob(client, size, data, Time::getHighResolutionTicks());
+    }
+
+protected:
+    void run() override
+    {
+        for (; ! shouldThreadExit();)
+        {
+            if (! carla_sem_timedwait(fSem, 1))
+                continue;
+
+            if (shouldThreadExit())
+                break;
+
+            const CarlaMutexLocker cml(fMutex);
+
+            for (LinkedList<CarlaEngineWorkerClient*>::Itenerator it = fClients.begin2(); it.valid(); it.next())
+            {
+                CarlaEngineWorkerClient* const client(it.getValue(nullptr));
+                CARLA_SAFE_ASSERT_CONTINUE(client != nullptr);
+
+                runPendingJobs(client);
+            }
+        }
+    }
+
+private:
+    CarlaMutex fMutex; // held while running jobs
+    LinkedList<CarlaEngineWorkerClient*> fClients;
+    carla_sem_t fSem;
+
+    void runPendingJobs(CarlaEngineWorkerClient* const client) noexcept
+    {
+        CarlaEngineWorkerClient::ProtectedData* const cData(client->pData);
+
+        uint32_t size;
+        int64_t  ticks;
+
+        for (; cData->requests.read(size, ticks, cData->requestData);)
+        {
+            __atomic_sub_fetch(&cData->pending, 1, __ATOMIC_RELAXED);
+            runJob(client, size, cData->requestData, ticks);
+        }
+    }
+
+    void runJob(CarlaEngineWorkerClient* const client, const uint32_t size, const void* const data, const int64_t scheduledTicks) noexcept
+    {
+        CarlaEngineWorkerClient::ProtectedData* const cData(client->pData);
+
+        const int64_t startTicks(Time::getHighResolutionTicks());
+
+        try {
+            client->work(size, data);
+        } CARLA_SAFE_EXCEPTION("EngineWorkerThread::runJob");
+
+        const int64_t endTicks(Time::getHighResolutionTicks());
+
+        const float latency(static_cast<float>(Time::highResolutionTicksToSeconds(startTicks - scheduledTicks) * 1000000.0));
+        const float jobTime(static_cast<float>(Time::highResolutionTicksToSeconds(endTicks - startTicks) * 1000000.0));
+
+        cData->totalLatency += latency;
+        cData->totalJobTime += jobTime;
+
+        if (latency > cData->maxLatency)
+            cData->maxLatency = latency;
+        if (jobTime > cData->maxJobTime)
+            cData->maxJobTime = jobTime;
+
+        ++cData->jobs;
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(EngineWorkerThread)
+};
+
+// -----------------------------------------------------------------------
+// Engine worker pool
+
+EngineWorkerPool::EngineWorkerPool() noexcept
+    : mutex(),
+      clients()
+{
+    carla_zeroPointers(threads, kThreadCount);
+}
+
+EngineWorkerPool::~EngineWorkerPool() noexcept
+{
+    CARLA_SAFE_ASSERT(clients.count() == 0);
+    clients.clear();
+
+    for (uint i=0; i < kThreadCount; ++i)
+    {
+        if (threads[i] == nullptr)
+            continue;
+
+        threads[i]->stop();
+        delete threads[i];
+        threads[i] = nullptr;
+    }
+}
+
+EngineWorkerThread* EngineWorkerPool::addClient(CarlaEngineWorkerClient* const client)
+{
+    CARLA_SAFE_ASSERT_RETURN(client != nullptr, nullptr);
+
+    const CarlaMutexLocker cml(mutex);
+
+    EngineWorkerThread* thread(nullptr);
+
+    for (uint i=0; i < kThreadCount; ++i)
+    {
+        if (threads[i] == nullptr)
+        {
+            threads[i] = new EngineWorkerThread();
+            thread = threads[i];
+            break;
+        }
+
+        if (thread == nullptr || threads[i]->getClientCount() < thread->getClientCount())
+            thread = threads[i];
+    }
+
+    CARLA_SAFE_ASSERT_RETURN(thread != nullptr, nullptr);
+
+    if (! thread->isThreadRunning())
+    {
+        CARLA_SAFE_ASSERT_RETURN(thread->startThread(), nullptr);
+    }
+
+    thread->addClient(client);
+    clients.append(client);
+
+    return thread;
+}
+
+void EngineWorkerPool::removeClient(EngineWorkerThread* const thread, CarlaEngineWorkerClient* const client) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(thread != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(client != nullptr,);
+
+    const CarlaMutexLocker cml(mutex);
+
+    thread->removeClient(client);
+    clients.removeOne(client);
+}
+
+void EngineWorkerPool::getStats(const CarlaPlugin* const plugin, EngineWorkerStats& stats) const noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(plugin != nullptr,);
+
+    const CarlaMutexLocker cml(mutex);
+
+    for (LinkedList<CarlaEngineWorkerClient*>::Itenerator it = clients.begin2(); it.valid(); it.next())
+    {
+        const CarlaEngineWorkerClient* const client(it.getValue(nullptr));
+        CARLA_SAFE_ASSERT_CONTINUE(client != nullptr);
+
+        if (client->getPlugin() == plugin)
+            return client->getStats(stats);
+    }
+}
+
+// -----------------------------------------------------------------------
+// Carla Engine worker client
+
+CarlaEngineWorkerClient::CarlaEngineWorkerClient(CarlaEngine* const engine, CarlaPlugin* const plugin)
+    : pData(new ProtectedData(engine, plugin))
+{
+    CARLA_SAFE_ASSERT_RETURN(engine != nullptr,);
+    carla_debug("CarlaEngineWorkerClient::CarlaEngineWorkerClient(%p, %p)", engine, plugin);
+
+    pData->thread = engine->pData->workers.addClient(this);
+}
+
+CarlaEngineWorkerClient::~CarlaEngineWorkerClient() noexcept
+{
+    carla_debug("CarlaEngineWorkerClient::~CarlaEngineWorkerClient()");
+
+    // should have been stopped by the subclass already
+    CARLA_SAFE_ASSERT(pData->thread == nullptr);
+    stopWork();
+
+    delete pData;
+}
+
+bool CarlaEngineWorkerClient::scheduleWork(const uint32_t size, const void* const data) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(size == 0 || data != nullptr, false);
+
+    EngineWorkerThread* const thread(pData->thread);
+    CARLA_SAFE_ASSERT_RETURN(thread != nullptr, false);
+
+    if (pData->engine->isOffline())
+    {
+        thread->runJobNow(this, size, data);
+        return true;
+    }
+
+    if (! pData->requests.write(data, size, Time::getHighResolutionTicks()))
+    {
+        ++pData->droppedJobs;
+        return false;
+    }
+
+    const uint32_t pending(__atomic_add_fetch(&pData->pending, 1, __ATOMIC_RELAXED));
+
+    if (pending > pData->maxPending)
+        pData->maxPending = pending;
+
+    thread->wake();
+    return true;
+}
+
+bool CarlaEngineWorkerClient::writeResponse(const uint32_t size, const void* const data) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(size == 0 || data != nullptr, false);
+
+    if (! pData->responses.write(data, size, 0))
+    {
+        ++pData->droppedResponses;
+        return false;
+    }
+
+    return true;
+}
+
+void CarlaEngineWorkerClient::processResponses() noexcept
+{
+    uint32_t size;
+    int64_t  ticks;
+
+    for (; pData->responses.read(size, ticks, pData->responseData);)
+    {
+        try {
+            workResponse(size, pData->responseData);
+        } CARLA_SAFE_EXCEPTION("CarlaEngineWorkerClient::processResponses");
+    }
+}
+
+void CarlaEngineWorkerClient::stopWork() noexcept
+{
+    if (pData->thread == nullptr)
+        return;
+
+    carla_debug("CarlaEngineWorkerClient::stopWork()");
+
+    pData->engine->pData->workers.removeClient(pData->thread, this);
+    pData->thread = nullptr;
+}
+
+CarlaPlugin* CarlaEngineWorkerClient::getPlugin() const noexcept
+{
+    return pData->plugin;
+}
+
+void CarlaEngineWorkerClient::getStats(EngineWorkerStats& stats) const noexcept
+{
+    const uint32_t jobs(pData->jobs);
+
+    stats.jobs          = jobs;
+    stats.dropped       = pData->droppedJobs + pData->droppedResponses;
+    stats.queueDepth    = __atomic_load_n(&pData->pending, __ATOMIC_RELAXED);
+    stats.maxQueueDepth = pData->maxPending;
+    stats.maxLatency    = pData->maxLatency;
+    stats.maxJobTime    = pData->maxJobTime;
+
+    if (jobs > 0)
+    {
+        stats.avgLatency = static_cast<float>(pData->totalLatency / jobs);
+        stats.avgJobTime = static_cast<float>(pData->totalJobTime / jobs);
+    }
+    else
+    {
+        stats.avgLatency = 0.0f;
+        stats.avgJobTime = 0.0f;
+    }
+}
+
+// -----------------------------------------------------------------------
+
+CARLA_BACKEND_END_NAMESPACE
@@ -19,9 +19,9 @@
 #include "CarlaEngine.hpp"
 
 #include "CarlaBackendUtils.hpp"
-#include "CarlaBase64Utils.hpp"
 #include "CarlaMathUtils.hpp"
 #include "CarlaPluginUI.hpp"
+#include "CarlaXmlUtils.hpp"
 
 #include <ctime>
 
@@ -29,11 +29,11 @@
 
 using juce::CharPointer_UTF8;
 using juce::File;
-using juce::MemoryOutputStream;
+using juce::FileOutputStream;
+using juce::MemoryMappedFile;
 using juce::ScopedPointer;
 using juce::String;
-using juce::XmlDocument;
-using juce::XmlElement;
+using juce::TemporaryFile;
 
 CARLA_BACKEND_START_NAMESPACE
 
@@ -528,7 +528,9 @@ const CarlaStateSave& CarlaPlugin::getStateSave(const bool callPrepareForSave)
 
         if (data != nullptr && dataSize > 0)
         {
-            pData->stateSave.chunk = CarlaString::asBase64(data, dataSize).dup();
+            pData->stateSave.chunk = new uint8_t[dataSize];
+            pData->stateSave.chunkSize = dataSize;
+            std::memcpy(pData->stateSave.chunk, data, dataSize);
 
             if (pluginType != PLUGIN_INTERNAL)
                 usingChunk = true;
@@ -834,11 +836,8 @@ void CarlaPlugin::loadStateSave(const CarlaStateSave& stateSave)
     // ---------------------------------------------------------------
     // Part 6 - set chunk
 
-    if (stateSave.chunk != nullptr && (pData->options & PLUGIN_OPTION_USE_CHUNKS) != 0)
-    {
-        std::vector<uint8_t> chunk(carla_getChunkFromBase64String(stateSave.chunk));
-        setChunkData(chunk.data(), chunk.size());
-    }
+    if (stateSave.chunk != nullptr && stateSave.chunkSize > 0 && (pData->options & PLUGIN_OPTION_USE_CHUNKS) != 0)
+        setChunkData(stateSave.chunk, stateSave.chunkSize);
 
 #ifndef BUILD_BRIDGE
     // ---------------------------------------------------------------
@@ -871,20 +870,31 @@ bool CarlaPlugin::saveStateToFile(const char* const filename)
     CARLA_SAFE_ASSERT_RETURN(filename != nullptr && filename[0] != '\0', false);
     carla_debug("CarlaPlugin::saveStateToFile(\"%s\")", filename);
 
-    MemoryOutputStream out, streamState;
-    getStateSave().dumpToMemoryStream(streamState);
-
-    out << "<?xml version='1.0' encoding='UTF-8'?>\n";
-    out << "<!DOCTYPE CARLA-PRESET>\n";
-    out << "<CARLA-PRESET VERSION='2.0'>\n";
-    out << streamState;
-    out << "</CARLA-PRESET>\n";
-
     const String jfilename = String(CharPointer_UTF8(filename));
     File file(jfilename);
 
-    if (file.replaceWithData(out.getData(), out.getDataSize()))
-        return true;
+    const CarlaStateSave& stateSave(getStateSave());
+
+    {
+        TemporaryFile tempFile(file);
+        ScopedPointer<FileOutputStream> out(tempFile.getFile().createOutputStream());
+
+        if (out != nullptr && ! out->failedToOpen())
+        {
+            *out << "<?xml version='1.0' encoding='UTF-8'?>\n";
+            *out << "<!DOCTYPE CARLA-PRESET>\n";
+            *out << "<CARLA-PRESET VERSION='2.0'>\n";
+            stateSave.dumpToStream(*out);
+            *out << "</CARLA-PRESET>\n";
+            out->flush();
+
+            const bool failed(out->getStatus().failed());
+            out = nullptr;
+
+            if (! failed && tempFile.overwriteTargetFileWithTemporary())
+                return true;
+        }
+    }
 
     pData->engine->setLastError("Failed to write file");
     return false;
@@ -901,16 +911,14 @@ bool CarlaPlugin::loadStateFromFile(const char* const filename)
     File file(jfilename);
     CARLA_SAFE_ASSERT_RETURN(file.existsAsFile(), false);
 
-    XmlDocument xml(file);
-    ScopedPointer<XmlElement> xmlElement(xml.getDocumentElement(true));
-    CARLA_SAFE_ASSERT_RETURN(xmlElement != nullptr, false);
-    CARLA_SAFE_ASSERT_RETURN(xmlElement->getTagName().equalsIgnoreCase("carla-preset"), false);
+    MemoryMappedFile mappedFile(file, MemoryMappedFile::readOnly);
+    CARLA_SAFE_ASSERT_RETURN(mappedFile.getData() != nullptr, false);
 
-    // completely load file
-    xmlElement = xml.getDocumentElement(false);
-    CARLA_SAFE_ASSERT_RETURN(xmlElement != nullptr, false);
+    CarlaXmlReader reader(static_cast<const char*>(mappedFile.getData()), mappedFile.getSize());
+    CARLA_SAFE_ASSERT_RETURN(reader.nextChild(), false);
+    CARLA_SAFE_ASSERT_RETURN(reader.isName("carla-preset"), false);
 
-    if (pData->stateSave.fillFromXmlElement(xmlElement))
+    if (pData->stateSave.fillFromXmlReader(reader))
     {
         loadStateSave(pData->stateSave);
         return true;
@@ -1392,6 +1400,20 @@ void CarlaPlugin::deactivate() noexcept
     CARLA_SAFE_ASSERT(pData->active);
 }
 
+uint CarlaPlugin::processRackChain(const uint, const float** const, float** const, float* const, const uint32_t)
+{
+    return 0;
+}
+
+bool CarlaPlugin::processKick(const float** const, float** const, const float** const, float** const, const uint32_t)
+{
+    return false;
+}
+
+void CarlaPlugin::processCollect(const float** const, float** const, const float** const, float** const, const uint32_t)
+{
+}
+
 void CarlaPlugin::bufferSizeChanged(const uint32_t)
 {
 }
@@ -1423,12 +1445,28 @@ void CarlaPlugin::idle()
     {
         carla_stdout("latency changed to %i", latency);
 
-        const ScopedSingleProcessLocker sspl(this, true);
+        // new buffers are swapped in by the audio thread, the old ones are deleted here
+        ProtectedData::Latency newLatency;
+
+        if (pData->latency.channels > 0 || latency > 0)
+            newLatency.recreateBuffers(pData->latency.channels, latency);
+
+        if (! pData->runInAudioThread(kPluginRtCommandSwapLatency, 0, 0.0f, &newLatency))
+        {
+            const ScopedSingleProcessLocker sspl(this, true);
+            pData->latency.swapWith(newLatency);
+        }
 
         pData->client->setLatency(latency);
-        pData->latency.recreateBuffers(pData->latency.channels, latency);
+
+#ifndef BUILD_BRIDGE
+        pData->engine->patchbayLatencyChanged();
+#endif
     }
 
+    if (pData->paramChanges.count != pData->param.count)
+        pData->paramChanges.resize(pData->param.count);
+
     const CarlaMutexLocker sl(pData->postRtEvents.mutex);
 
     for (RtLinkedList<PluginPostRtEvent>::Itenerator it = pData->postRtEvents.data.begin2(); it.valid(); it.next())
@@ -1457,6 +1495,13 @@ void CarlaPlugin::idle()
 
             if (event.value2 != 1)
             {
+                // only keep the latest value, sent below
+                if (event.value1 >= 0 && static_cast<uint32_t>(event.value1) < pData->paramChanges.count)
+                {
+                    pData->paramChanges.set(static_cast<uint32_t>(event.value1), event.value3);
+                    break;
+                }
+
 #if defined(HAVE_LIBLO) && ! defined(BUILD_BRIDGE)
                 // Update OSC control client
                 if (sendOsc)
@@ -1468,6 +1513,10 @@ void CarlaPlugin::idle()
         } break;
 
         case kPluginPostRtEventProgramChange: {
+            // parameter changes from before the program change must not be sent after its values
+            if (pData->paramChanges.hasChanges)
+                pData->flushParameterChanges();
+
             // Update UI
             if (event.value1 >= 0 && hasUI)
             {
@@ -1505,6 +1554,10 @@ void CarlaPlugin::idle()
         } break;
 
         case kPluginPostRtEventMidiProgramChange: {
+            // parameter changes from before the program change must not be sent after its values
+            if (pData->paramChanges.hasChanges)
+                pData->flushParameterChanges();
+
             // Update UI
             if (event.value1 >= 0 && hasUI)
             {
@@ -1598,6 +1651,52 @@ void CarlaPlugin::idle()
     }
 
     pData->postRtEvents.data.clear();
+
+    if (pData->paramChanges.hasChanges)
+        pData->flushParameterChanges();
+}
+
+uint32_t CarlaPlugin::takeParameterChanges(uint32_t* const indexes, float* const values, const uint32_t maxCount) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(indexes != nullptr, 0);
+    CARLA_SAFE_ASSERT_RETURN(values != nullptr, 0);
+
+    ProtectedData::ParamChanges& changes(pData->paramChanges);
+    const CarlaMutexLocker cml(changes.mutex);
+
+    const uint32_t words(ProtectedData::ParamChanges::wordCount(changes.count));
+    uint32_t count = 0;
+
+    for (uint32_t w=0; w < words && count < maxCount; ++w)
+    {
+        uint32_t& bits(changes.pendingBits[w]);
+
+        for (; bits != 0 && count < maxCount; bits &= bits - 1)
+        {
+            const uint32_t index(w*32 + static_cast<uint32_t>(__builtin_ctz(bits)));
+
+            indexes[count] = index;
+            values[count]  = changes.pendingValues[index];
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+bool CarlaPlugin::checkParameterOutputChanged(const uint32_t parameterId, const float value) noexcept
+{
+    ProtectedData::ParamChanges& changes(pData->paramChanges);
+    const CarlaMutexLocker cml(changes.mutex);
+
+    if (parameterId >= changes.count)
+        return true;
+
+    if (carla_isEqual(changes.outputValues[parameterId], value))
+        return false;
+
+    changes.outputValues[parameterId] = value;
+    return true;
 }
 
 bool CarlaPlugin::tryLock(const bool forcedOffline) noexcept
@@ -22,10 +22,10 @@
 #include "CarlaPluginInternal.hpp"
 
 #include "CarlaBackendUtils.hpp"
-#include "CarlaBase64Utils.hpp"
 #include "CarlaBridgeUtils.hpp"
 #include "CarlaEngineUtils.hpp"
 #include "CarlaMathUtils.hpp"
+#include "CarlaPostProcUtils.hpp"
 #include "CarlaShmUtils.hpp"
 #include "CarlaThread.hpp"
 
@@ -36,7 +36,6 @@
 // -------------------------------------------------------------------------------------------------------------------
 
 using juce::ChildProcess;
-using juce::File;
 using juce::ScopedPointer;
 using juce::String;
 using juce::StringArray;
@@ -125,18 +124,149 @@ struct BridgeAudioPool {
     CARLA_DECLARE_NON_COPY_STRUCT(BridgeAudioPool)
 };
 
+// -------------------------------------------------------------------------------------------------------------------
+// Plugin chunks go through this one in binary form, see BridgeChunkHeader.
+// The segment is never resized in place, a bigger one replaces it and the bridge is told the new name.
+
+struct BridgeChunkPool {
+    CarlaString filename;
+    uint64_t size;
+    BridgeChunkHeader* data;
+    carla_shm_t shm;
+
+    BridgeChunkPool() noexcept
+        : filename(),
+          size(0),
+          data(nullptr)
+#ifdef CARLA_PROPER_CPP11_SUPPORT
+        , shm(carla_shm_t_INIT) {}
+#else
+    {
+        carla_shm_init(shm);
+    }
+#endif
+
+    ~BridgeChunkPool() noexcept
+    {
+        // should be cleared by now
+        CARLA_SAFE_ASSERT(data == nullptr);
+
+        clear();
+    }
+
+    bool initialize(const uint64_t dataSize) noexcept
+    {
+        char tmpFileBase[64];
+
+        std::sprintf(tmpFileBase, PLUGIN_BRIDGE_NAMEPREFIX_CHUNK "XXXXXX");
+
+        carla_shm_t newShm(carla_shm_create_temp(tmpFileBase));
+
+        CARLA_SAFE_ASSERT_RETURN(carla_is_shm_valid(newShm), false);
+
+        void* const newData(carla_shm_map(newShm, static_cast<std::size_t>(sizeof(BridgeChunkHeader)+dataSize)));
+
+        if (newData == nullptr)
+        {
+            carla_stderr2("BridgeChunkPool::initialize(" P_UINT64 ") - failed to map shared memory", dataSize);
+            carla_shm_close(newShm);
+            return false;
+        }
+
+        clear();
+
+        filename = tmpFileBase;
+        size     = dataSize;
+        data     = (BridgeChunkHeader*)newData;
+        shm      = newShm;
+
+        data->pieceReady = 0;
+        return true;
+    }
+
+    void clear() noexcept
+    {
+        filename.clear();
+
+        if (! carla_is_shm_valid(shm))
+        {
+            CARLA_SAFE_ASSERT(data == nullptr);
+            return;
+        }
+
+        if (data != nullptr)
+        {
+            carla_shm_unmap(shm, data);
+            data = nullptr;
+        }
+
+        size = 0;
+        carla_shm_close(shm);
+        carla_shm_init(shm);
+    }
+
+    uint8_t* getData() const noexcept
+    {
+        return (uint8_t*)(data + 1);
+    }
+
+    bool isPieceReady() const noexcept
+    {
+        return __atomic_load_n(&data->pieceReady, __ATOMIC_ACQUIRE) != 0;
+    }
+
+    void setPieceReady(const bool ready) noexcept
+    {
+        __atomic_store_n(&data->pieceReady, ready ? 1U : 0U, __ATOMIC_RELEASE);
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(BridgeChunkPool)
+};
+
+static void printChunkTransferStats(const char* const what, const uint64_t size, const uint32_t pieces, const int64_t startTicks) noexcept
+{
+#ifdef DEBUG
+    const double secs(Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks));
+
+    carla_debug("CarlaPluginBridge - %s " P_UINT64 " bytes in %u piece(s), %.2f ms, %.1f MiB/s",
+                what, size, pieces, secs*1000.0, secs > 0.0 ? static_cast<double>(size)/secs/(1024.0*1024.0) : 0.0);
+#else
+    // debug builds only
+    (void)what; (void)size; (void)pieces; (void)startTicks;
+#endif
+}
+
 // -------------------------------------------------------------------------------------------------------------------
 
 struct BridgeRtClientControl : public CarlaRingBufferControl<SmallStackBuffer> {
     BridgeRtClientData* data;
+    std::size_t dataSize;
     CarlaString filename;
     bool needsSemDestroy;
+
+    // sequence of our last request, the client has replied to it once clientSeq gets there
+    uint32_t expectedSeq;
+
+    // when the last process request was sent
+    int64_t processStart;
+
+    // round-trip stats of process requests, used to tune the spin time
+    uint32_t latencyCount, latencySpinCount;
+    double latencyTotal, latencyMax;
+
     carla_shm_t shm;
 
     BridgeRtClientControl()
         : data(nullptr),
+          dataSize(0),
           filename(),
-          needsSemDestroy(false)
+          needsSemDestroy(false),
+          expectedSeq(0),
+          processStart(0),
+          latencyCount(0),
+          latencySpinCount(0),
+          latencyTotal(0.0),
+          latencyMax(0.0)
 #ifdef CARLA_PROPER_CPP11_SUPPORT
         , shm(carla_shm_t_INIT) {}
 #else
@@ -153,7 +283,8 @@ struct BridgeRtClientControl : public CarlaRingBufferControl<SmallStackBuffer> {
         clear();
     }
 
-    bool initialize() noexcept
+    // 'slots' is the number of plugins the bridge process can host, each one needs its own midi output area
+    bool initialize(const uint32_t slots = 1) noexcept
     {
         char tmpFileBase[64];
 
@@ -163,6 +294,8 @@ struct BridgeRtClientControl : public CarlaRingBufferControl<SmallStackBuffer> {
 
         CARLA_SAFE_ASSERT_RETURN(carla_is_shm_valid(shm), false);
 
+        dataSize = getBridgeRtClientDataSize(slots);
+
         if (! mapData())
         {
             carla_shm_close(shm);
@@ -219,11 +352,15 @@ struct BridgeRtClientControl : public CarlaRingBufferControl<SmallStackBuffer> {
     {
         CARLA_SAFE_ASSERT(data == nullptr);
 
-        if (carla_shm_map<BridgeRtClientData>(shm, data))
+        data = (BridgeRtClientData*)carla_shm_map(shm, dataSize);
+
+        if (data != nullptr)
         {
             carla_zeroStruct(data->sem);
+            carla_zeroStruct(data->handoff);
             carla_zeroStruct(data->timeInfo);
-            carla_zeroBytes(data->midiOut, kBridgeRtClientDataMidiOutSize);
+            expectedSeq = 0;
+            carla_zeroBytes(data->midiOut, dataSize - offsetof(BridgeRtClientData, midiOut));
             setRingBuffer(&data->ringBuffer, true);
             return true;
         }
@@ -231,6 +368,32 @@ struct BridgeRtClientControl : public CarlaRingBufferControl<SmallStackBuffer> {
         return false;
     }
 
+    // map the rt channel of a bridge group, which keeps ownership of it
+    bool attach(const char* const groupFilename, const uint32_t slots) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(data == nullptr, false);
+        CARLA_SAFE_ASSERT_RETURN(groupFilename != nullptr && groupFilename[0] != '\0', false);
+
+        shm = carla_shm_attach(groupFilename);
+
+        CARLA_SAFE_ASSERT_RETURN(carla_is_shm_valid(shm), false);
+
+        dataSize = getBridgeRtClientDataSize(slots);
+        data = (BridgeRtClientData*)carla_shm_map(shm, dataSize);
+
+        if (data == nullptr)
+        {
+            carla_shm_close(shm);
+            carla_shm_init(shm);
+            return false;
+        }
+
+        filename = groupFilename;
+        expectedSeq = __atomic_load_n(&data->handoff.serverSeq, __ATOMIC_ACQUIRE);
+        setRingBuffer(&data->ringBuffer, false);
+        return true;
+    }
+
     void unmapData() noexcept
     {
         CARLA_SAFE_ASSERT_RETURN(data != nullptr,);
@@ -242,12 +405,93 @@ struct BridgeRtClientControl : public CarlaRingBufferControl<SmallStackBuffer> {
     }
 
     bool waitForClient(const uint secs) noexcept
+    {
+        postRequest();
+
+        return waitForReply(secs);
+    }
+
+    // wakes up the client for a non-rt request, the reply is taken later with waitForReply
+    void postRequest() noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(data != nullptr,);
+
+        postServer();
+    }
+
+    bool waitForReply(const uint secs) noexcept
     {
         CARLA_SAFE_ASSERT_RETURN(data != nullptr, false);
 
-        jackbridge_sem_post(&data->sem.server);
+        return waitForClientReply(Time::getHighResolutionTicks() + Time::secondsToHighResolutionTicks(double(secs)));
+    }
+
+    // wakes up the client for a process request, the reply is taken later with waitForProcessReply
+    void wakeForProcess() noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(data != nullptr,);
+
+        processStart = Time::getHighResolutionTicks();
+
+        postServer();
+    }
+
+    // waits until 'usecs' after the process request was sent, busy-waiting up to spinTime microseconds first.
+    // records the round-trip time
+    bool waitForProcessReply(const uint usecs, const uint spinTime) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(data != nullptr, false);
+
+        const int64_t end(processStart + Time::secondsToHighResolutionTicks(double(usecs)/1000000.0));
+
+        if (spinTime > 0)
+        {
+            const int64_t start(Time::getHighResolutionTicks());
+            const int64_t spinEnd(std::min<int64_t>(end, start + Time::secondsToHighResolutionTicks(double(spinTime)/1000000.0)));
+
+            for (int64_t now = start; now < spinEnd; now = Time::getHighResolutionTicks())
+            {
+                if (! hasClientReplied())
+                    continue;
+
+                ++latencySpinCount;
+                recordLatency(processStart);
+                return true;
+            }
+        }
+
+        if (! waitForClientReply(end))
+            return false;
+
+        recordLatency(processStart);
+        return true;
+    }
+
+    // true while the client works on a request we stopped waiting for, nothing new can be sent meanwhile
+    bool isClientBusy() const noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(data != nullptr, false);
+
+        const uint32_t serverSeq(__atomic_load_n(&data->handoff.serverSeq, __ATOMIC_ACQUIRE));
+        const uint32_t clientSeq(__atomic_load_n(&data->handoff.clientSeq, __ATOMIC_ACQUIRE));
+
+        return static_cast<int32_t>(serverSeq - clientSeq) > 0;
+    }
+
+    // process round-trip times since the last call, in microseconds. returns false if nothing was measured
+    bool takeLatencyStats(uint32_t& count, uint32_t& spinCount, float& average, float& maximum) noexcept
+    {
+        if (latencyCount == 0)
+            return false;
 
-        return jackbridge_sem_timedwait(&data->sem.client, secs);
+        count     = latencyCount;
+        spinCount = latencySpinCount;
+        average   = static_cast<float>(latencyTotal/latencyCount*1000000.0);
+        maximum   = static_cast<float>(latencyMax*1000000.0);
+
+        latencyCount = latencySpinCount = 0;
+        latencyTotal = latencyMax = 0.0;
+        return true;
     }
 
     void writeOpcode(const PluginBridgeRtClientOpcode opcode) noexcept
@@ -255,6 +499,67 @@ struct BridgeRtClientControl : public CarlaRingBufferControl<SmallStackBuffer> {
         writeUInt(static_cast<uint32_t>(opcode));
     }
 
+private:
+    // The client replies once per post, so counting posts tells which reply is ours.
+    // Replies to requests that were given up on, or sent by other plugins of a group, are skipped this way.
+    void postServer() noexcept
+    {
+        expectedSeq = __atomic_add_fetch(&data->handoff.serverSeq, 1, __ATOMIC_SEQ_CST);
+        jackbridge_sem_post(&data->sem.server);
+    }
+
+    bool hasClientReplied() const noexcept
+    {
+        const uint32_t seq(__atomic_load_n(&data->handoff.clientSeq, __ATOMIC_ACQUIRE));
+
+        return static_cast<int32_t>(seq - expectedSeq) >= 0;
+    }
+
+    bool waitForClientReply(const int64_t endTicks) noexcept
+    {
+        // a collected reply might already be there while another plugin of the group waits on the semaphore,
+        // the flag below is theirs then
+        if (hasClientReplied())
+            return true;
+
+        for (;;)
+        {
+            // tell the client we're going to sleep, then check again in case it replied meanwhile
+            __atomic_store_n(&data->handoff.serverWaiting, 1, __ATOMIC_SEQ_CST);
+
+            // if we get the flag back the client did not see it, and will not post
+            if (hasClientReplied() && __atomic_exchange_n(&data->handoff.serverWaiting, 0, __ATOMIC_SEQ_CST) == 1)
+                return true;
+
+            const int64_t remaining(endTicks - Time::getHighResolutionTicks());
+            const uint usecs(remaining > 0 ? static_cast<uint>(Time::highResolutionTicksToSeconds(remaining)*1000000.0) : 0);
+
+            if (usecs == 0 || ! jackbridge_sem_timedwait_usecs(&data->sem.client, usecs))
+            {
+                __atomic_store_n(&data->handoff.serverWaiting, 0, __ATOMIC_SEQ_CST);
+
+                // a late post for this reply, if any, is skipped by the next wait
+                return hasClientReplied();
+            }
+
+            if (hasClientReplied())
+                return true;
+
+            // post for a reply we stopped waiting for earlier, keep waiting for ours
+        }
+    }
+
+    void recordLatency(const int64_t start) noexcept
+    {
+        const double latency(Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start));
+
+        ++latencyCount;
+        latencyTotal += latency;
+
+        if (latency > latencyMax)
+            latencyMax = latency;
+    }
+
     CARLA_DECLARE_NON_COPY_STRUCT(BridgeRtClientControl)
 };
 
@@ -534,11 +839,11 @@ protected:
             carla_stderr("CarlaPluginBridgeThread::run() - already running, giving up...");
         }
 
-        String name(kPlugin->getName());
-        String filename(kPlugin->getFilename());
+        // a null plugin means we are starting the shared process of a bridge group
+        const char* const stype(kPlugin != nullptr ? getPluginTypeAsString(kPlugin->getType()) : "group");
+        const int64_t uniqueId(kPlugin != nullptr ? kPlugin->getUniqueId() : 0);
 
-        if (name.isEmpty())
-            name = "(none)";
+        String filename(kPlugin != nullptr ? kPlugin->getFilename() : "(none)");
 
         if (filename.isEmpty())
             filename = "\"\"";
@@ -555,7 +860,7 @@ protected:
         arguments.add(fBinary);
 
         // plugin type
-        arguments.add(getPluginTypeAsString(kPlugin->getType()));
+        arguments.add(stype);
 
         // filename
         arguments.add(filename);
@@ -564,7 +869,7 @@ protected:
         arguments.add(fLabel);
 
         // uniqueId
-        arguments.add(String(static_cast<juce::int64>(kPlugin->getUniqueId())));
+        arguments.add(String(static_cast<juce::int64>(uniqueId)));
 
         bool started;
 
@@ -652,7 +957,7 @@ protected:
             carla_setenv("WINEDEBUG", "-all");
 
             carla_stdout("starting plugin bridge, command is:\n%s \"%s\" \"%s\" \"%s\" " P_INT64,
-                         fBinary.toRawUTF8(), getPluginTypeAsString(kPlugin->getType()), filename.toRawUTF8(), fLabel.toRawUTF8(), kPlugin->getUniqueId());
+                         fBinary.toRawUTF8(), stype, filename.toRawUTF8(), fLabel.toRawUTF8(), uniqueId);
 
             started = fProcess->start(arguments);
 
@@ -694,10 +999,14 @@ protected:
             {
                 carla_stderr("CarlaPluginBridgeThread::run() - bridge crashed");
 
-                CarlaString errorString("Plugin '" + CarlaString(kPlugin->getName()) + "' has crashed!\n"
-                                        "Saving now will lose its current settings.\n"
-                                        "Please remove this plugin, and not rely on it from this point.");
-                kEngine->callback(CarlaBackend::ENGINE_CALLBACK_ERROR, kPlugin->getId(), 0, 0, 0.0f, errorString);
+                // bridge groups report this to each of their plugins
+                if (kPlugin != nullptr)
+                {
+                    CarlaString errorString("Plugin '" + CarlaString(kPlugin->getName()) + "' has crashed!\n"
+                                            "Saving now will lose its current settings.\n"
+                                            "Please remove this plugin, and not rely on it from this point.");
+                    kEngine->callback(CarlaBackend::ENGINE_CALLBACK_ERROR, kPlugin->getId(), 0, 0, 0.0f, errorString);
+                }
             }
             else
                 carla_stderr("CarlaPluginBridgeThread::run() - bridge closed cleanly");
@@ -722,64 +1031,56 @@ private:
 
 // -------------------------------------------------------------------------------------------------------------------
 
-class CarlaPluginBridge : public CarlaPlugin
+// Several bridged plugins of the same binary type hosted by a single bridge process.
+// Each plugin keeps its own audio pool and non-rt channels, but they all share the group's rt channel,
+// so writes to it must be done while holding the group's rt lock and start by selecting the plugin slot.
+
+class CarlaPluginBridgeGroup
 {
 public:
-    CarlaPluginBridge(CarlaEngine* const engine, const uint id, const BinaryType btype, const PluginType ptype)
-        : CarlaPlugin(engine, id),
-          fBinaryType(btype),
-          fPluginType(ptype),
-          fInitiated(false),
-          fInitError(false),
-          fSaved(true),
-          fTimedOut(false),
-          fTimedError(false),
-          fLastPongTime(-1),
-          fBridgeBinary(),
-          fBridgeThread(engine, this),
+    CarlaPluginBridgeGroup(CarlaEngine* const engine, const BinaryType btype, const char* const bridgeBinary, const uint slotCount) noexcept
+        : kEngine(engine),
+          kBinaryType(btype),
+          kSlotCount(slotCount),
+          fBridgeBinary(bridgeBinary),
+          fBridgeThread(engine, nullptr),
           fShmAudioPool(),
           fShmRtClientControl(),
           fShmNonRtClientControl(),
           fShmNonRtServerControl(),
-          fInfo(),
-          fUniqueId(0),
-          fParams(nullptr)
+          fRtMutex(),
+          fRequestMutex(),
+          fNonRtServerMutex(),
+          fLastPongTime(-1),
+          fMemberCount(0),
+          fCrashReported(false)
     {
-        carla_debug("CarlaPluginBridge::CarlaPluginBridge(%p, %i, %s, %s)", engine, id, BinaryType2Str(btype), PluginType2Str(ptype));
+        carla_debug("CarlaPluginBridgeGroup::CarlaPluginBridgeGroup(%p, %s, \"%s\", %u)", engine, BinaryType2Str(btype), bridgeBinary, slotCount);
 
-        pData->hints |= PLUGIN_IS_BRIDGE;
+        carla_zeroPointers(fMembers, kPluginBridgeGroupMaxPlugins);
     }
 
-    ~CarlaPluginBridge() override
+    ~CarlaPluginBridgeGroup()
     {
-        carla_debug("CarlaPluginBridge::~CarlaPluginBridge()");
-
-        // close UI
-        if (pData->hints & PLUGIN_HAS_CUSTOM_UI)
-            pData->transientTryCounter = 0;
-
-        pData->singleMutex.lock();
-        pData->masterMutex.lock();
-
-        if (pData->client != nullptr && pData->client->isActive())
-            pData->client->deactivate();
-
-        if (pData->active)
-        {
-            deactivate();
-            pData->active = false;
-        }
+        carla_debug("CarlaPluginBridgeGroup::~CarlaPluginBridgeGroup()");
+        CARLA_SAFE_ASSERT(fMemberCount == 0);
 
         if (fBridgeThread.isThreadRunning())
         {
-            fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientQuit);
-            fShmNonRtClientControl.commitWrite();
+            {
+                const CarlaMutexLocker _cml(fShmNonRtClientControl.mutex);
+
+                fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientQuit);
+                fShmNonRtClientControl.commitWrite();
+            }
+
+            const CarlaMutexLocker _cml(fRtMutex);
 
             fShmRtClientControl.writeOpcode(kPluginBridgeRtClientQuit);
             fShmRtClientControl.commitWrite();
 
-            if (! fTimedOut)
-                waitForClient("stopping", 3);
+            if (! fShmRtClientControl.waitForClient(3))
+                carla_stderr("CarlaPluginBridgeGroup - timeout while stopping");
         }
 
         fBridgeThread.stopThread(3000);
@@ -788,34 +1089,546 @@ public:
         fShmNonRtClientControl.clear();
         fShmRtClientControl.clear();
         fShmAudioPool.clear();
-
-        clearBuffers();
-
-        fInfo.chunk.clear();
     }
 
     // -------------------------------------------------------------------
-    // Information (base)
 
-    BinaryType getBinaryType() const noexcept
-    {
-        return fBinaryType;
-    }
-
-    PluginType getType() const noexcept override
+    bool init()
     {
-        return fPluginType;
-    }
+        // the group does not process anything itself, but the bridge expects all 4 channels
+        if (! fShmAudioPool.initialize())
+        {
+            carla_stdout("Failed to initialize shared memory audio pool for bridge group");
+            return false;
+        }
 
-    PluginCategory getCategory() const noexcept override
-    {
-        return fInfo.category;
-    }
+        if (! fShmRtClientControl.initialize(kSlotCount))
+        {
+            carla_stdout("Failed to initialize RT client control for bridge group");
+            fShmAudioPool.clear();
+            return false;
+        }
 
-    int64_t getUniqueId() const noexcept override
-    {
-        return fUniqueId;
-    }
+        if (! fShmNonRtClientControl.initialize())
+        {
+            carla_stdout("Failed to initialize Non-RT client control for bridge group");
+            fShmRtClientControl.clear();
+            fShmAudioPool.clear();
+            return false;
+        }
+
+        if (! fShmNonRtServerControl.initialize())
+        {
+            carla_stdout("Failed to initialize Non-RT server control for bridge group");
+            fShmNonRtClientControl.clear();
+            fShmRtClientControl.clear();
+            fShmAudioPool.clear();
+            return false;
+        }
+
+        // initial values
+        fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientNull);
+        fShmNonRtClientControl.writeUInt(static_cast<uint32_t>(fShmRtClientControl.dataSize));
+        fShmNonRtClientControl.writeUInt(static_cast<uint32_t>(sizeof(BridgeNonRtClientData)));
+        fShmNonRtClientControl.writeUInt(static_cast<uint32_t>(sizeof(BridgeNonRtServerData)));
+
+        fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientSetBufferSize);
+        fShmNonRtClientControl.writeUInt(kEngine->getBufferSize());
+
+        fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientSetSampleRate);
+        fShmNonRtClientControl.writeDouble(kEngine->getSampleRate());
+
+        fShmNonRtClientControl.commitWrite();
+
+        // init bridge thread
+        {
+            char shmIdsStr[6*4+1];
+            carla_zeroChars(shmIdsStr, 6*4+1);
+
+            std::strncpy(shmIdsStr+6*0, &fShmAudioPool.filename[fShmAudioPool.filename.length()-6], 6);
+            std::strncpy(shmIdsStr+6*1, &fShmRtClientControl.filename[fShmRtClientControl.filename.length()-6], 6);
+            std::strncpy(shmIdsStr+6*2, &fShmNonRtClientControl.filename[fShmNonRtClientControl.filename.length()-6], 6);
+            std::strncpy(shmIdsStr+6*3, &fShmNonRtServerControl.filename[fShmNonRtServerControl.filename.length()-6], 6);
+
+            fBridgeThread.setData(fBridgeBinary, "(none)", shmIdsStr);
+            fBridgeThread.startThread();
+        }
+
+        int64_t timeoutEnd = 10000;
+#ifndef CARLA_OS_WIN
+        if (kBinaryType == BINARY_WIN32 || kBinaryType == BINARY_WIN64)
+            timeoutEnd *= 2;
+#endif
+
+        const int64_t startTime(Time::currentTimeMillis());
+
+        for (; Time::currentTimeMillis() < startTime + timeoutEnd && fBridgeThread.isThreadRunning();)
+        {
+            handleNonRtData();
+
+            if (fLastPongTime > 0)
+                return true;
+
+            carla_msleep(20);
+        }
+
+        fBridgeThread.stopThread(6000);
+        kEngine->setLastError("Timeout while waiting for a response from plugin-bridge group");
+        return false;
+    }
+
+    bool isRunning() const noexcept
+    {
+        return fBridgeThread.isThreadRunning();
+    }
+
+    uintptr_t getProcessPID() const noexcept
+    {
+        return fBridgeThread.getProcessPID();
+    }
+
+    const char* getRtClientFilename() const noexcept
+    {
+        return fShmRtClientControl.filename;
+    }
+
+    uint getSlotCount() const noexcept
+    {
+        return kSlotCount;
+    }
+
+    // -------------------------------------------------------------------
+
+    void lockRt() noexcept
+    {
+        fRtMutex.lock();
+    }
+
+    bool tryLockRt() noexcept
+    {
+        return fRtMutex.tryLock();
+    }
+
+    void unlockRt() noexcept
+    {
+        fRtMutex.unlock();
+    }
+
+    // non-rt requests wait for their reply without the rt lock, this keeps them from waiting on each other's
+    void lockRequests() noexcept
+    {
+        fRequestMutex.lock();
+    }
+
+    void unlockRequests() noexcept
+    {
+        fRequestMutex.unlock();
+    }
+
+    void addMember(const uint slot, CarlaPlugin* const plugin, const char* const filename, const char* const label, const char shmIds[6*4+1])
+    {
+        CARLA_SAFE_ASSERT_RETURN(slot < kPluginBridgeGroupMaxPlugins,);
+        CARLA_SAFE_ASSERT_RETURN(fMembers[slot] == plugin,);
+
+        const char* const name(plugin->getName());
+
+        const uint32_t filenameLen(filename != nullptr ? static_cast<uint32_t>(std::strlen(filename)) : 0);
+        const uint32_t nameLen(name != nullptr ? static_cast<uint32_t>(std::strlen(name)) : 0);
+        const uint32_t labelLen(label != nullptr ? static_cast<uint32_t>(std::strlen(label)) : 0);
+
+        const CarlaMutexLocker _cml(fShmNonRtClientControl.mutex);
+
+        fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientAddPlugin);
+        fShmNonRtClientControl.writeUInt(slot);
+        fShmNonRtClientControl.writeUInt(static_cast<uint32_t>(plugin->getType()));
+
+        fShmNonRtClientControl.writeUInt(filenameLen);
+        if (filenameLen != 0)
+            fShmNonRtClientControl.writeCustomData(filename, filenameLen);
+
+        fShmNonRtClientControl.writeUInt(nameLen);
+        if (nameLen != 0)
+            fShmNonRtClientControl.writeCustomData(name, nameLen);
+
+        fShmNonRtClientControl.writeUInt(labelLen);
+        if (labelLen != 0)
+            fShmNonRtClientControl.writeCustomData(label, labelLen);
+
+        fShmNonRtClientControl.writeLong(plugin->getUniqueId());
+        fShmNonRtClientControl.writeCustomData(shmIds, 6*4);
+        fShmNonRtClientControl.commitWrite();
+    }
+
+    void idle()
+    {
+        if (fBridgeThread.isThreadRunning())
+        {
+            {
+                const CarlaMutexLocker _cml(fShmNonRtClientControl.mutex);
+
+                fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientPing);
+                fShmNonRtClientControl.commitWrite();
+            }
+
+            const CarlaMutexTryLocker cmtl(fNonRtServerMutex);
+
+            if (cmtl.wasLocked())
+            {
+                try {
+                    handleNonRtData();
+                } CARLA_SAFE_EXCEPTION("handleNonRtData");
+            }
+        }
+        else if (fLastPongTime > 0 && ! fCrashReported)
+        {
+            fCrashReported = true;
+
+            for (uint i=0; i < kPluginBridgeGroupMaxPlugins; ++i)
+            {
+                CarlaPlugin* const plugin(fMembers[i]);
+
+                if (plugin == nullptr)
+                    continue;
+
+                CarlaString errorString("Plugin '" + CarlaString(plugin->getName()) + "' has crashed!\n"
+                                        "Saving now will lose its current settings.\n"
+                                        "Please remove this plugin, and not rely on it from this point.");
+                kEngine->callback(CarlaBackend::ENGINE_CALLBACK_ERROR, plugin->getId(), 0, 0, 0.0f, errorString);
+            }
+        }
+    }
+
+    // -------------------------------------------------------------------
+
+    // find a running group with a free slot for this plugin, or start a new one
+    static CarlaPluginBridgeGroup* acquire(CarlaPlugin* const plugin, const BinaryType btype, const char* const bridgeBinary, uint& slot)
+    {
+        CarlaEngine* const engine(plugin->getEngine());
+        const uint groupSize(carla_fixedValue(1U, kPluginBridgeGroupMaxPlugins, engine->getOptions().bridgesGroupSize));
+
+        const CarlaMutexLocker cml(sGroupsMutex);
+
+        for (LinkedList<CarlaPluginBridgeGroup*>::Itenerator it = sGroups.begin2(); it.valid(); it.next())
+        {
+            CarlaPluginBridgeGroup* const group(it.getValue(nullptr));
+            CARLA_SAFE_ASSERT_CONTINUE(group != nullptr);
+
+            if (group->kEngine != engine || group->kBinaryType != btype || group->fBridgeBinary != bridgeBinary)
+                continue;
+            if (group->fMemberCount >= std::min(groupSize, group->kSlotCount) || ! group->isRunning())
+                continue;
+
+            for (uint i=0; i < group->kSlotCount; ++i)
+            {
+                if (group->fMembers[i] != nullptr)
+                    continue;
+
+                group->fMembers[i] = plugin;
+                ++group->fMemberCount;
+                slot = i;
+                return group;
+            }
+        }
+
+        CarlaPluginBridgeGroup* const group(new CarlaPluginBridgeGroup(engine, btype, bridgeBinary, groupSize));
+
+        if (! group->init())
+        {
+            delete group;
+            return nullptr;
+        }
+
+        group->fMembers[0] = plugin;
+        group->fMemberCount = 1;
+        slot = 0;
+
+        sGroups.append(group);
+        return group;
+    }
+
+    // give back a slot, the group closes after its last plugin is gone
+    static void release(CarlaPluginBridgeGroup* const group, const uint slot)
+    {
+        CARLA_SAFE_ASSERT_RETURN(group != nullptr,);
+        CARLA_SAFE_ASSERT_RETURN(slot < kPluginBridgeGroupMaxPlugins,);
+
+        {
+            const CarlaMutexLocker cml(sGroupsMutex);
+
+            CARLA_SAFE_ASSERT_RETURN(group->fMembers[slot] != nullptr,);
+
+            group->fMembers[slot] = nullptr;
+
+            if (--group->fMemberCount != 0)
+                return;
+
+            sGroups.removeOne(group);
+        }
+
+        delete group;
+    }
+
+    // -------------------------------------------------------------------
+
+private:
+    CarlaEngine* const kEngine;
+    const BinaryType kBinaryType;
+    const uint kSlotCount;
+
+    CarlaString             fBridgeBinary;
+    CarlaPluginBridgeThread fBridgeThread;
+
+    BridgeAudioPool          fShmAudioPool;
+    BridgeRtClientControl    fShmRtClientControl;
+    BridgeNonRtClientControl fShmNonRtClientControl;
+    BridgeNonRtServerControl fShmNonRtServerControl;
+
+    CarlaMutex fRtMutex;
+    CarlaMutex fRequestMutex;
+    CarlaMutex fNonRtServerMutex; // members can idle from project loader threads
+    int64_t fLastPongTime;
+
+    CarlaPlugin* fMembers[kPluginBridgeGroupMaxPlugins];
+    uint fMemberCount;
+    bool fCrashReported;
+
+    static LinkedList<CarlaPluginBridgeGroup*> sGroups;
+    static CarlaMutex sGroupsMutex;
+
+    void handleNonRtData()
+    {
+        for (; fShmNonRtServerControl.isDataAvailableForReading();)
+        {
+            const PluginBridgeNonRtServerOpcode opcode(fShmNonRtServerControl.readOpcode());
+
+            switch (opcode)
+            {
+            case kPluginBridgeNonRtServerPong:
+                fLastPongTime = Time::currentTimeMillis();
+                break;
+
+            case kPluginBridgeNonRtServerError: {
+                // error
+                const uint32_t errorSize(fShmNonRtServerControl.readUInt());
+                char error[errorSize+1];
+                carla_zeroChars(error, errorSize+1);
+                fShmNonRtServerControl.readCustomData(error, errorSize);
+
+                carla_stderr("CarlaPluginBridgeGroup - bridge error: %s", error);
+            }   break;
+
+            default:
+                // the group process only replies to pings and reports errors
+                carla_stderr("CarlaPluginBridgeGroup - unexpected opcode %s", PluginBridgeNonRtServerOpcode2str(opcode));
+                break;
+            }
+        }
+    }
+
+    CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaPluginBridgeGroup)
+};
+
+LinkedList<CarlaPluginBridgeGroup*> CarlaPluginBridgeGroup::sGroups;
+CarlaMutex CarlaPluginBridgeGroup::sGroupsMutex;
+
+// -------------------------------------------------------------------------------------------------------------------
+
+// try-locks the rt channel of a bridge group from the audio thread, always succeeds for standalone bridges
+class ScopedBridgeGroupTryLocker
+{
+public:
+    ScopedBridgeGroupTryLocker(CarlaPluginBridgeGroup* const group) noexcept
+        : fGroup(group),
+          fLocked(group == nullptr || group->tryLockRt()) {}
+
+    ~ScopedBridgeGroupTryLocker() noexcept
+    {
+        if (fGroup != nullptr && fLocked)
+            fGroup->unlockRt();
+    }
+
+    bool wasLocked() const noexcept
+    {
+        return fLocked;
+    }
+
+private:
+    CarlaPluginBridgeGroup* const fGroup;
+    const bool fLocked;
+
+    CARLA_PREVENT_HEAP_ALLOCATION
+    CARLA_DECLARE_NON_COPY_CLASS(ScopedBridgeGroupTryLocker)
+};
+
+// a non-rt request to the rt channel of a bridge group, does nothing for standalone bridges.
+// the rt channel is locked while writing the request, then released with sent() before waiting for the reply
+class ScopedBridgeGroupRequest
+{
+public:
+    ScopedBridgeGroupRequest(CarlaPluginBridgeGroup* const group) noexcept
+        : fGroup(group),
+          fRtLocked(group != nullptr)
+    {
+        if (fGroup == nullptr)
+            return;
+
+        fGroup->lockRequests();
+        fGroup->lockRt();
+    }
+
+    ~ScopedBridgeGroupRequest() noexcept
+    {
+        if (fGroup == nullptr)
+            return;
+
+        sent();
+        fGroup->unlockRequests();
+    }
+
+    void sent() noexcept
+    {
+        if (! fRtLocked)
+            return;
+
+        fRtLocked = false;
+        fGroup->unlockRt();
+    }
+
+private:
+    CarlaPluginBridgeGroup* const fGroup;
+    bool fRtLocked;
+
+    CARLA_PREVENT_HEAP_ALLOCATION
+    CARLA_DECLARE_NON_COPY_CLASS(ScopedBridgeGroupRequest)
+};
+
+// -------------------------------------------------------------------------------------------------------------------
+
+class CarlaPluginBridge : public CarlaPlugin
+{
+public:
+    CarlaPluginBridge(CarlaEngine* const engine, const uint id, const BinaryType btype, const PluginType ptype)
+        : CarlaPlugin(engine, id),
+          fBinaryType(btype),
+          fPluginType(ptype),
+          fInitiated(false),
+          fInitError(false),
+          fSaved(true),
+          fTimedOut(false),
+          fTimedError(false),
+          fProcessKicked(false),
+          fDeadline(),
+          fLastAudioOut(nullptr),
+          fLastAudioOutFrames(0),
+          fLastPongTime(-1),
+          fBridgeBinary(),
+          fBridgeThread(engine, this),
+          fGroup(nullptr),
+          fGroupSlot(0),
+          fShmAudioPool(),
+          fShmRtClientControl(),
+          fShmNonRtClientControl(),
+          fShmNonRtServerControl(),
+          fShmChunkPool(),
+          fChunkPoolWantedSize(kPluginBridgeChunkShmMinSize),
+          fChunkRecv(),
+          fChunkRecvOffset(0),
+          fChunkRecvPieces(0),
+          fChunkRecvStartTicks(0),
+          fInfo(),
+          fUniqueId(0),
+          fParams(nullptr)
+    {
+        carla_debug("CarlaPluginBridge::CarlaPluginBridge(%p, %i, %s, %s)", engine, id, BinaryType2Str(btype), PluginType2Str(ptype));
+
+        pData->hints |= PLUGIN_IS_BRIDGE;
+    }
+
+    ~CarlaPluginBridge() override
+    {
+        carla_debug("CarlaPluginBridge::~CarlaPluginBridge()");
+
+        // close UI
+        if (pData->hints & PLUGIN_HAS_CUSTOM_UI)
+            pData->transientTryCounter = 0;
+
+        pData->singleMutex.lock();
+        pData->masterMutex.lock();
+
+        if (pData->client != nullptr && pData->client->isActive())
+            pData->client->deactivate();
+
+        if (pData->active)
+        {
+            deactivate();
+            pData->active = false;
+        }
+
+        if (isBridgeRunning())
+        {
+            fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientQuit);
+            fShmNonRtClientControl.commitWrite();
+
+            // the rt channel of a group stays open for its other plugins
+            if (fGroup == nullptr)
+            {
+                fShmRtClientControl.writeOpcode(kPluginBridgeRtClientQuit);
+                fShmRtClientControl.commitWrite();
+
+                if (! fTimedOut)
+                    waitForClient("stopping", 3);
+            }
+        }
+
+        if (fGroup == nullptr)
+            fBridgeThread.stopThread(3000);
+
+        fShmChunkPool.clear();
+        fShmNonRtServerControl.clear();
+        fShmNonRtClientControl.clear();
+        fShmRtClientControl.clear();
+        fShmAudioPool.clear();
+
+        if (fGroup != nullptr)
+        {
+            CarlaPluginBridgeGroup::release(fGroup, fGroupSlot);
+            fGroup = nullptr;
+        }
+
+        clearBuffers();
+
+        if (fLastAudioOut != nullptr)
+        {
+            delete[] fLastAudioOut;
+            fLastAudioOut = nullptr;
+        }
+
+        fInfo.chunk.clear();
+        discardChunkRecv();
+    }
+
+    // -------------------------------------------------------------------
+    // Information (base)
+
+    BinaryType getBinaryType() const noexcept
+    {
+        return fBinaryType;
+    }
+
+    PluginType getType() const noexcept override
+    {
+        return fPluginType;
+    }
+
+    PluginCategory getCategory() const noexcept override
+    {
+        return fInfo.category;
+    }
+
+    int64_t getUniqueId() const noexcept override
+    {
+        return fUniqueId;
+    }
 
     // -------------------------------------------------------------------
     // Information (count)
@@ -909,6 +1722,10 @@ public:
 
     void prepareForSave() noexcept override
     {
+        // the bridge sends the chunk back through the chunk pool
+        if (pData->options & PLUGIN_OPTION_USE_CHUNKS)
+            ensureChunkPool(fChunkPoolWantedSize);
+
         fSaved = false;
 
         {
@@ -926,13 +1743,15 @@ public:
 
         // TODO: only wait 1 minute for NI plugins
         const uint32_t timeoutEnd(Time::getMillisecondCounter() + 60*1000); // 60 secs, 1 minute
-        const bool needsEngineIdle(pData->engine->getType() != kEngineTypePlugin);
+        const bool isLoaderThread(pData->engine->isProjectLoaderThread());
+        const bool needsEngineIdle(pData->engine->getType() != kEngineTypePlugin && ! isLoaderThread);
 
         carla_stdout("CarlaPluginBridge::waitForSaved() - now waiting...");
 
-        for (; Time::getMillisecondCounter() < timeoutEnd && fBridgeThread.isThreadRunning();)
+        for (; Time::getMillisecondCounter() < timeoutEnd && isBridgeRunning();)
         {
-            pData->engine->callback(ENGINE_CALLBACK_IDLE, 0, 0, 0, 0.0f, nullptr);
+            if (! isLoaderThread)
+                pData->engine->callback(ENGINE_CALLBACK_IDLE, 0, 0, 0, 0.0f, nullptr);
 
             if (needsEngineIdle)
                 pData->engine->idle();
@@ -943,10 +1762,73 @@ public:
             carla_msleep(20);
         }
 
-        if (! fSaved)
-            carla_stderr("CarlaPluginBridge::waitForSaved() - Timeout while requesting save state");
-        else
-            carla_stdout("CarlaPluginBridge::waitForSaved() - success!");
+        if (! fSaved)
+        {
+            carla_stderr("CarlaPluginBridge::waitForSaved() - Timeout while requesting save state");
+
+            // keep the previous chunk, not a partial one
+            discardChunkRecv();
+        }
+        else
+            carla_stdout("CarlaPluginBridge::waitForSaved() - success!");
+    }
+
+    void discardChunkRecv() noexcept
+    {
+        std::vector<uint8_t>().swap(fChunkRecv);
+        fChunkRecvOffset = 0;
+    }
+
+    // makes sure the chunk pool exists and can take dataSize bytes in one piece, within the pool size limits
+    bool ensureChunkPool(uint64_t dataSize) noexcept
+    {
+        if (dataSize < kPluginBridgeChunkShmMinSize)
+            dataSize = kPluginBridgeChunkShmMinSize;
+        else if (dataSize > kPluginBridgeChunkShmMaxSize)
+            dataSize = kPluginBridgeChunkShmMaxSize;
+
+        if (fShmChunkPool.data != nullptr)
+        {
+            if (fShmChunkPool.size >= dataSize)
+                return true;
+
+            // the bridge needs to be done with the old pool first
+            if (! waitForChunkPieceTaken())
+                return false;
+        }
+
+        if (! fShmChunkPool.initialize(dataSize))
+            return false;
+
+        const uint32_t ulength(static_cast<uint32_t>(fShmChunkPool.filename.length()));
+
+        const CarlaMutexLocker _cml(fShmNonRtClientControl.mutex);
+
+        fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientSetChunkShm);
+        fShmNonRtClientControl.writeUInt(ulength);
+        fShmNonRtClientControl.writeCustomData(fShmChunkPool.filename.buffer(), ulength);
+        fShmNonRtClientControl.writeULong(fShmChunkPool.size);
+        fShmNonRtClientControl.commitWrite();
+        return true;
+    }
+
+    bool waitForChunkPieceTaken() noexcept
+    {
+        if (! fShmChunkPool.isPieceReady())
+            return true;
+
+        const uint32_t timeoutEnd(Time::getMillisecondCounter() + kPluginBridgeChunkPieceTimeout);
+
+        for (; Time::getMillisecondCounter() < timeoutEnd && isBridgeRunning();)
+        {
+            carla_msleep(1);
+
+            if (! fShmChunkPool.isPieceReady())
+                return true;
+        }
+
+        carla_stderr("CarlaPluginBridge::waitForChunkPieceTaken() - Timeout while waiting for bridge");
+        return false;
     }
 
     // -------------------------------------------------------------------
@@ -1124,37 +2006,55 @@ public:
         CARLA_SAFE_ASSERT_RETURN(data != nullptr,);
         CARLA_SAFE_ASSERT_RETURN(dataSize > 0,);
 
-        carla_stdout("Carla bridge server side, setChunkData 001");
+        // a pending save uses the chunk pool too
+        waitForSaved();
 
-        CarlaString dataBase64(CarlaString::asBase64(data, dataSize));
-        CARLA_SAFE_ASSERT_RETURN(dataBase64.length() > 0,);
+        if (ensureChunkPool(dataSize))
+        {
+            const uint8_t* const bytes(static_cast<const uint8_t*>(data));
+            const int64_t startTicks(Time::getHighResolutionTicks());
+            uint32_t pieces = 0;
+            bool sent = true;
 
-        String filePath(File::getSpecialLocation(File::tempDirectory).getFullPathName());
+            for (uint64_t offset=0; offset < dataSize; ++pieces)
+            {
+                if (! waitForChunkPieceTaken())
+                {
+                    sent = false;
+                    break;
+                }
 
-        filePath += CARLA_OS_SEP_STR ".CarlaChunk_";
-        filePath += fShmAudioPool.filename.buffer() + 18;
+                const uint32_t pieceSize(static_cast<uint32_t>(std::min<uint64_t>(dataSize-offset, fShmChunkPool.size)));
 
-        if (File(filePath).replaceWithText(dataBase64.buffer()))
-        {
-            carla_stdout("Carla bridge server side, setChunkData 002");
+                std::memcpy(fShmChunkPool.getData(), bytes+offset, pieceSize);
+                fShmChunkPool.setPieceReady(true);
 
-            const uint32_t ulength(static_cast<uint32_t>(filePath.length()));
+                {
+                    const CarlaMutexLocker _cml(fShmNonRtClientControl.mutex);
 
-            const CarlaMutexLocker _cml(fShmNonRtClientControl.mutex);
+                    fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientSetChunkData);
+                    fShmNonRtClientControl.writeULong(dataSize);
+                    fShmNonRtClientControl.writeULong(offset);
+                    fShmNonRtClientControl.writeUInt(pieceSize);
+                    fShmNonRtClientControl.commitWrite();
+                }
 
-            fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientSetChunkDataFile);
-            fShmNonRtClientControl.writeUInt(ulength);
-            fShmNonRtClientControl.writeCustomData(filePath.toRawUTF8(), ulength);
-            fShmNonRtClientControl.commitWrite();
+                offset += pieceSize;
+            }
 
-            carla_stdout("Carla bridge server side, setChunkData sent");
+            if (sent)
+                printChunkTransferStats("sent chunk of", dataSize, pieces, startTicks);
+            else
+                carla_stderr2("CarlaPluginBridge::setChunkData() - failed to send chunk, only %u piece(s) were taken", pieces);
+        }
+        else
+        {
+            carla_stderr2("CarlaPluginBridge::setChunkData() - failed to send chunk, no chunk pool");
         }
 
         // save data internally as well
         fInfo.chunk.resize(dataSize);
         std::memcpy(fInfo.chunk.data(), data, dataSize);
-
-        carla_stdout("Carla bridge server side, setChunkData saved locally too");
     }
 
     // -------------------------------------------------------------------
@@ -1183,7 +2083,22 @@ public:
 
     void idle() override
     {
-        if (fBridgeThread.isThreadRunning())
+        if (fGroup != nullptr)
+            fGroup->idle();
+
+        if (fDeadline.takeChanged())
+        {
+            const bool degraded(fDeadline.isDegraded());
+
+            if (degraded)
+                carla_stderr("Bridge '%s' keeps missing its process deadline, it is silenced until it catches up", pData->name);
+            else
+                carla_stdout("Bridge '%s' is meeting its process deadline again", pData->name);
+
+            pData->engine->callback(ENGINE_CALLBACK_PLUGIN_DEGRADED, pData->id, degraded ? 1 : 0, static_cast<int>(fDeadline.getMisses()), 0.0f, nullptr);
+        }
+
+        if (isBridgeRunning())
         {
             if (fInitiated && fTimedOut && pData->active)
                 setActive(false, true, true);
@@ -1395,35 +2310,417 @@ public:
         try {
             waitForClient("deactivate", 2);
         } CARLA_SAFE_EXCEPTION("deactivate - waitForClient");
+
+        uint32_t count, spinCount;
+        float average, maximum;
+
+        if (fShmRtClientControl.takeLatencyStats(count, spinCount, average, maximum))
+        {
+            carla_debug("Bridge '%s' process round-trip: avg %.1f us, max %.1f us, %u of %u replies without sleeping",
+                        pData->name, static_cast<double>(average), static_cast<double>(maximum), spinCount, count);
+
+            pData->engine->callback(ENGINE_CALLBACK_PLUGIN_BRIDGE_LATENCY, pData->id,
+                                    static_cast<int>(count), static_cast<int>(spinCount), average, nullptr);
+        }
     }
 
     void process(const float** const audioIn, float** const audioOut, const float** const cvIn, float** const cvOut, const uint32_t frames) override
     {
         // --------------------------------------------------------------------------------------------------------
-        // Check if active
+        // Check if active
+
+        if (fTimedOut || fTimedError || ! pData->active)
+        {
+            // disable any output sound
+            for (uint32_t i=0; i < pData->audioOut.count; ++i)
+                FloatVectorOperations::clear(audioOut[i], static_cast<int>(frames));
+            for (uint32_t i=0; i < pData->cvOut.count; ++i)
+                FloatVectorOperations::clear(cvOut[i], static_cast<int>(frames));
+            return;
+        }
+
+        // --------------------------------------------------------------------------------------------------------
+        // Run commands from the host
+
+        pData->rtCommands.runRT(this);
+
+        // --------------------------------------------------------------------------------------------------------
+        // Check if needs reset
+
+        if (pData->needsReset)
+        {
+            // TODO
+
+            pData->needsReset = false;
+        }
+
+        // --------------------------------------------------------------------------------------------------------
+        // Event Input
+
+        // a group rt channel is shared, keep it locked from the first write until the reply.
+        // never wait for it here, the block is skipped if another plugin of the group is using it
+        const ScopedBridgeGroupTryLocker sbgtl(fGroup);
+
+        if (! sbgtl.wasLocked())
+        {
+            dropEventInput();
+            processMissed(audioOut, cvOut, frames);
+            return;
+        }
+
+        // the bridge is still busy with a block we stopped waiting for
+        if (! isReadyForProcess(frames))
+        {
+            dropEventInput();
+            processMissed(audioOut, cvOut, frames);
+            return;
+        }
+
+        selectGroupSlot();
+        processEventInput();
+
+        if (! processSingle(audioIn, audioOut, cvIn, cvOut, frames))
+            return;
+
+        processEventOutput();
+    }
+
+    uint processRackChain(const uint maxCount, const float** const audioIn, float** const audioOut, float* const peaks, const uint32_t frames) override
+    {
+        if (fGroup == nullptr || maxCount < 2 || frames == 0)
+            return 0;
+        if (! canChainInGroup(fGroup) || fInfo.aIns == 0 || fInfo.aIns > 2)
+            return 0;
+        if (! pData->singleMutex.tryLock())
+            return 0;
+
+        // the regular process call takes care of a busy rt channel
+        const ScopedBridgeGroupTryLocker sbgtl(fGroup);
+
+        if (! sbgtl.wasLocked() || fShmRtClientControl.isClientBusy())
+        {
+            pData->singleMutex.unlock();
+            return 0;
+        }
+
+        // --------------------------------------------------------------------------------------------------------
+        // Collect the following plugins hosted by the same bridge process
+
+        const bool isOffline(pData->engine->isOffline());
+        const int iframes(static_cast<int>(frames));
+
+        CarlaPluginBridge* chain[kPluginBridgeGroupMaxPlugins];
+        chain[0] = this;
+
+        uint count = 1;
+
+        for (const uint maxChain = std::min(maxCount, kPluginBridgeGroupMaxPlugins); count < maxChain; ++count)
+        {
+            CarlaPlugin* const plugin(pData->engine->getPluginUnchecked(pData->id + count));
+
+            if (plugin == nullptr || (plugin->getHints() & PLUGIN_IS_BRIDGE) == 0 || ! plugin->isEnabled())
+                break;
+
+            CarlaPluginBridge* const bridge(static_cast<CarlaPluginBridge*>(plugin));
+
+            // the audio of the previous plugin goes straight into this one, skipping its post-processing and events
+            if (! chain[count-1]->canFeedNextInGroup())
+                break;
+            if (! bridge->canChainInGroup(fGroup) || bridge->fInfo.aIns != 2)
+                break;
+            if (! bridge->tryLock(isOffline))
+                break;
+
+            if (! bridge->pData->singleMutex.tryLock())
+            {
+                bridge->unlock();
+                break;
+            }
+
+            chain[count] = bridge;
+        }
+
+        if (count < 2)
+        {
+            pData->singleMutex.unlock();
+            return 0;
+        }
+
+        // --------------------------------------------------------------------------------------------------------
+        // Send everything and wake up the bridge only once
+
+        bool replied;
+
+        {
+            writeTimeInfo();
+
+            for (uint i=0; i < count; ++i)
+            {
+                CarlaPluginBridge* const bridge(chain[i]);
+
+                if (i != 0)
+                    bridge->initBuffers();
+
+                bridge->pData->needsReset = false;
+
+                bridge->selectGroupSlot();
+                bridge->processEventInput();
+
+                if (i == 0)
+                {
+                    for (uint32_t j=0; j < fInfo.aIns; ++j)
+                        FloatVectorOperations::copy(fShmAudioPool.data + (j * frames), audioIn[j], iframes);
+                }
+                else
+                {
+                    fShmRtClientControl.writeOpcode(kPluginBridgeRtClientChainAudio);
+                    fShmRtClientControl.writeUInt(chain[i-1]->fGroupSlot);
+                    fShmRtClientControl.commitWrite();
+                }
+
+                fShmRtClientControl.writeOpcode(kPluginBridgeRtClientProcess);
+                fShmRtClientControl.commitWrite();
+            }
+
+            fShmRtClientControl.wakeForProcess();
+            replied = waitForProcess("process-chain", frames);
+        }
+
+        if (! replied)
+        {
+            // a late chain is a miss for all of its plugins, only the output of the last one is heard
+            for (uint i=1; i < count; ++i)
+            {
+                if (fTimedOut)
+                    chain[i]->fTimedOut = true;
+                else
+                    chain[i]->fDeadline.miss();
+            }
+
+            chain[count-1]->processMissed(audioOut, nullptr, frames);
+            carla_zeroFloats(peaks, count*4);
+        }
+        else
+        {
+            CarlaPluginBridge* const last(chain[count-1]);
+
+            for (uint i=0; i < count; ++i)
+            {
+                CarlaPluginBridge* const bridge(chain[i]);
+                const float* const poolIn(bridge->fShmAudioPool.data);
+                const float* const poolOut(poolIn + bridge->fInfo.aIns * frames);
+
+                for (uint32_t j=0; j < 2; ++j)
+                {
+                    peaks[i*4+j]   = getBufferPeak((i == 0) ? audioIn[j] : poolIn + (j * frames), iframes);
+                    peaks[i*4+2+j] = getBufferPeak(poolOut + (j * frames), iframes);
+                }
+
+                if (bridge == last)
+                {
+                    FloatVectorOperations::copy(audioOut[0], poolOut, iframes);
+                    FloatVectorOperations::copy(audioOut[1], poolOut + frames, iframes);
+                }
+            }
+
+#ifndef BUILD_BRIDGE
+            // the dry signal of the last plugin is the raw output of the previous one
+            const float* lastIn[2] = { last->fShmAudioPool.data, last->fShmAudioPool.data + frames };
+            last->processPostProc(lastIn, audioOut, frames);
+
+            peaks[(count-1)*4+2] = getBufferPeak(audioOut[0], iframes);
+            peaks[(count-1)*4+3] = getBufferPeak(audioOut[1], iframes);
+#endif
+
+            for (uint i=0; i < count; ++i)
+            {
+                if (i != 0)
+                    chain[i]->fDeadline.met();
+
+                chain[i]->processEventOutput();
+            }
+
+            last->keepLastOutput(audioOut, frames);
+        }
+
+        for (uint i=count; --i > 0;)
+        {
+            chain[i]->pData->singleMutex.unlock();
+            chain[i]->unlock();
+        }
+
+        pData->singleMutex.unlock();
+        return count;
+    }
+
+    bool processKick(const float** const audioIn, float** const, const float** const, float** const, const uint32_t frames) override
+    {
+        CARLA_SAFE_ASSERT_RETURN(! fProcessKicked, false);
+
+        // anything unusual goes through the regular process call
+        if (fTimedOut || fTimedError || ! pData->active || frames == 0)
+            return false;
+        if (pData->audioIn.count > 0 && audioIn == nullptr)
+            return false;
+
+        // the group rt channel is only locked while sending the request.
+        // until the reply is collected the client is busy, other plugins of the group skip their blocks meanwhile
+        const ScopedBridgeGroupTryLocker sbgtl(fGroup);
+
+        if (! sbgtl.wasLocked())
+            return false;
+
+        // the regular process call handles a busy or degraded bridge without waiting
+        if (fDeadline.isDegraded() || fShmRtClientControl.isClientBusy())
+            return false;
+
+        if (pData->engine->isOffline())
+            pData->singleMutex.lock();
+        else if (! pData->singleMutex.tryLock())
+            return false;
+
+        pData->rtCommands.runRT(this);
+        pData->needsReset = false;
+
+        selectGroupSlot();
+        processEventInput();
+
+        for (uint32_t i=0; i < fInfo.aIns; ++i)
+            FloatVectorOperations::copy(fShmAudioPool.data + (i * frames), audioIn[i], static_cast<int>(frames));
+
+        writeTimeInfo();
+
+        fShmRtClientControl.writeOpcode(kPluginBridgeRtClientProcess);
+        fShmRtClientControl.commitWrite();
+
+        fShmRtClientControl.wakeForProcess();
+
+        fProcessKicked = true;
+        return true;
+    }
+
+    void processCollect(const float** const audioIn, float** const audioOut, const float** const, float** const cvOut, const uint32_t frames) override
+    {
+        CARLA_SAFE_ASSERT_RETURN(fProcessKicked,);
+
+        fProcessKicked = false;
+
+        if (waitForProcess("process", frames))
+        {
+            for (uint32_t i=0; i < fInfo.aOuts; ++i)
+                FloatVectorOperations::copy(audioOut[i], fShmAudioPool.data + ((i + fInfo.aIns) * frames), static_cast<int>(frames));
+
+#ifndef BUILD_BRIDGE
+            processPostProc(audioIn, audioOut, frames);
+#else
+            (void)audioIn;
+#endif
+            keepLastOutput(audioOut, frames);
+            processEventOutput();
+        }
+        else
+        {
+            processMissed(audioOut, cvOut, frames);
+        }
+
+        pData->singleMutex.unlock();
+    }
+
+    bool processSingle(const float** const audioIn, float** const audioOut, const float** const cvIn, float** const cvOut, const uint32_t frames)
+    {
+        CARLA_SAFE_ASSERT_RETURN(! fTimedError, false);
+        CARLA_SAFE_ASSERT_RETURN(frames > 0, false);
+
+        if (pData->audioIn.count > 0)
+        {
+            CARLA_SAFE_ASSERT_RETURN(audioIn != nullptr, false);
+        }
+        if (pData->audioOut.count > 0)
+        {
+            CARLA_SAFE_ASSERT_RETURN(audioOut != nullptr, false);
+        }
+        if (pData->cvIn.count > 0)
+        {
+            CARLA_SAFE_ASSERT_RETURN(cvIn != nullptr, false);
+        }
+        if (pData->cvOut.count > 0)
+        {
+            CARLA_SAFE_ASSERT_RETURN(cvOut != nullptr, false);
+        }
+
+        // --------------------------------------------------------------------------------------------------------
+        // Try lock, silence otherwise
+
+        if (pData->engine->isOffline())
+        {
+            pData->singleMutex.lock();
+        }
+        else if (! pData->singleMutex.tryLock())
+        {
+            for (uint32_t i=0; i < pData->audioOut.count; ++i)
+                FloatVectorOperations::clear(audioOut[i], static_cast<int>(frames));
+            for (uint32_t i=0; i < pData->cvOut.count; ++i)
+                FloatVectorOperations::clear(cvOut[i], static_cast<int>(frames));
+            return false;
+        }
+
+        // --------------------------------------------------------------------------------------------------------
+        // Reset audio buffers
+
+        for (uint32_t i=0; i < fInfo.aIns; ++i)
+            FloatVectorOperations::copy(fShmAudioPool.data + (i * frames), audioIn[i], static_cast<int>(frames));
+
+        // --------------------------------------------------------------------------------------------------------
+        // TimeInfo
+
+        writeTimeInfo();
+
+        // --------------------------------------------------------------------------------------------------------
+        // Run plugin
 
-        if (fTimedOut || fTimedError || ! pData->active)
         {
-            // disable any output sound
-            for (uint32_t i=0; i < pData->audioOut.count; ++i)
-                FloatVectorOperations::clear(audioOut[i], static_cast<int>(frames));
-            for (uint32_t i=0; i < pData->cvOut.count; ++i)
-                FloatVectorOperations::clear(cvOut[i], static_cast<int>(frames));
-            return;
+            fShmRtClientControl.writeOpcode(kPluginBridgeRtClientProcess);
+            fShmRtClientControl.commitWrite();
         }
 
-        // --------------------------------------------------------------------------------------------------------
-        // Check if needs reset
+        fShmRtClientControl.wakeForProcess();
 
-        if (pData->needsReset)
+        if (! waitForProcess("process", frames))
         {
-            // TODO
-
-            pData->needsReset = false;
+            processMissed(audioOut, cvOut, frames);
+            pData->singleMutex.unlock();
+            return false;
         }
 
+        for (uint32_t i=0; i < fInfo.aOuts; ++i)
+            FloatVectorOperations::copy(audioOut[i], fShmAudioPool.data + ((i + fInfo.aIns) * frames), static_cast<int>(frames));
+
+#ifndef BUILD_BRIDGE
+        processPostProc(audioIn, audioOut, frames);
+#endif
+        keepLastOutput(audioOut, frames);
+
         // --------------------------------------------------------------------------------------------------------
-        // Event Input
+
+        pData->singleMutex.unlock();
+        return true;
+    }
+
+    void processEventInput()
+    {
+        // notes started or stopped in skipped blocks would hang otherwise
+        if (fDeadline.eventsLost)
+        {
+            fDeadline.eventsLost = false;
+
+            for (uint8_t c=0; c < MAX_MIDI_CHANNELS; ++c)
+            {
+                fShmRtClientControl.writeOpcode(kPluginBridgeRtClientControlEventAllNotesOff);
+                fShmRtClientControl.writeUInt(0);
+                fShmRtClientControl.writeByte(c);
+                fShmRtClientControl.commitWrite();
+            }
+        }
 
         if (pData->event.portIn != nullptr)
         {
@@ -1599,7 +2896,8 @@ public:
                 case kEngineEventTypeMidi: {
                     const EngineMidiEvent& midiEvent(event.midi);
 
-                    if (midiEvent.size == 0 || midiEvent.size >= MAX_MIDI_VALUE)
+                    // longer messages don't fit the protocol
+                    if (midiEvent.size == 0 || midiEvent.size > kBridgeMidiEventMaxSize)
                         continue;
 
                     const uint8_t* const midiData(midiEvent.size > EngineMidiEvent::kDataSize ? midiEvent.dataExt : midiEvent.data);
@@ -1622,7 +2920,7 @@ public:
                     fShmRtClientControl.writeOpcode(kPluginBridgeRtClientMidiEvent);
                     fShmRtClientControl.writeUInt(event.time);
                     fShmRtClientControl.writeByte(midiEvent.port);
-                    fShmRtClientControl.writeByte(midiEvent.size);
+                    fShmRtClientControl.writeByte(static_cast<uint8_t>(midiEvent.size));
 
                     fShmRtClientControl.writeByte(uint8_t(midiData[0] | (event.channel & MIDI_CHANNEL_BIT)));
 
@@ -1642,13 +2940,10 @@ public:
             pData->postRtEvents.trySplice();
 
         } // End of Event Input
+    }
 
-        if (! processSingle(audioIn, audioOut, cvIn, cvOut, frames))
-            return;
-
-        // --------------------------------------------------------------------------------------------------------
-        // Control and MIDI Output
-
+    void processEventOutput()
+    {
         if (pData->event.portOut != nullptr)
         {
             float value;
@@ -1667,7 +2962,7 @@ public:
 
             uint8_t size;
             uint32_t time;
-            const uint8_t* midiData(fShmRtClientControl.data->midiOut);
+            const uint8_t* midiData(getBridgeRtClientMidiOut(fShmRtClientControl.data, fGroupSlot));
 
             for (std::size_t read=0; read<kBridgeRtClientDataMidiOutSize;)
             {
@@ -1686,7 +2981,7 @@ public:
                 midiData = midiData + 4;
 
                 // store midi data advancing as needed
-                uint8_t data[size];
+                uint8_t data[kBridgeMidiEventMaxSize];
 
                 for (uint8_t j=0; j<size; ++j)
                     data[j] = *midiData++;
@@ -1699,53 +2994,8 @@ public:
         } // End of Control and MIDI Output
     }
 
-    bool processSingle(const float** const audioIn, float** const audioOut, const float** const cvIn, float** const cvOut, const uint32_t frames)
+    void writeTimeInfo() noexcept
     {
-        CARLA_SAFE_ASSERT_RETURN(! fTimedError, false);
-        CARLA_SAFE_ASSERT_RETURN(frames > 0, false);
-
-        if (pData->audioIn.count > 0)
-        {
-            CARLA_SAFE_ASSERT_RETURN(audioIn != nullptr, false);
-        }
-        if (pData->audioOut.count > 0)
-        {
-            CARLA_SAFE_ASSERT_RETURN(audioOut != nullptr, false);
-        }
-        if (pData->cvIn.count > 0)
-        {
-            CARLA_SAFE_ASSERT_RETURN(cvIn != nullptr, false);
-        }
-        if (pData->cvOut.count > 0)
-        {
-            CARLA_SAFE_ASSERT_RETURN(cvOut != nullptr, false);
-        }
-
-        // --------------------------------------------------------------------------------------------------------
-        // Try lock, silence otherwise
-
-        if (pData->engine->isOffline())
-        {
-            pData->singleMutex.lock();
-        }
-        else if (! pData->singleMutex.tryLock())
-        {
-            for (uint32_t i=0; i < pData->audioOut.count; ++i)
-                FloatVectorOperations::clear(audioOut[i], static_cast<int>(frames));
-            for (uint32_t i=0; i < pData->cvOut.count; ++i)
-                FloatVectorOperations::clear(cvOut[i], static_cast<int>(frames));
-            return false;
-        }
-
-        // --------------------------------------------------------------------------------------------------------
-        // Reset audio buffers
-
-        for (uint32_t i=0; i < fInfo.aIns; ++i)
-            FloatVectorOperations::copy(fShmAudioPool.data + (i * frames), audioIn[i], static_cast<int>(frames));
-
-        // --------------------------------------------------------------------------------------------------------
-        // TimeInfo
-
         const EngineTimeInfo& timeInfo(pData->engine->getTimeInfo());
         BridgeTimeInfo& bridgeTimeInfo(fShmRtClientControl.data->timeInfo);
 
@@ -1767,98 +3017,15 @@ public:
             bridgeTimeInfo.beatsPerMinute = timeInfo.bbt.beatsPerMinute;
             bridgeTimeInfo.barStartTick   = timeInfo.bbt.barStartTick;
         }
-
-        // --------------------------------------------------------------------------------------------------------
-        // Run plugin
-
-        {
-            fShmRtClientControl.writeOpcode(kPluginBridgeRtClientProcess);
-            fShmRtClientControl.commitWrite();
-        }
-
-        waitForClient("process", 1);
-
-        if (fTimedOut)
-        {
-            pData->singleMutex.unlock();
-            return false;
-        }
-
-        for (uint32_t i=0; i < fInfo.aOuts; ++i)
-            FloatVectorOperations::copy(audioOut[i], fShmAudioPool.data + ((i + fInfo.aIns) * frames), static_cast<int>(frames));
+    }
 
 #ifndef BUILD_BRIDGE
-        // --------------------------------------------------------------------------------------------------------
-        // Post-processing (dry/wet, volume and balance)
-
-        {
-            const bool doVolume  = (pData->hints & PLUGIN_CAN_VOLUME) != 0 && carla_isNotEqual(pData->postProc.volume, 1.0f);
-            const bool doDryWet  = (pData->hints & PLUGIN_CAN_DRYWET) != 0 && carla_isNotEqual(pData->postProc.dryWet, 1.0f);
-            const bool doBalance = (pData->hints & PLUGIN_CAN_BALANCE) != 0 && ! (carla_isEqual(pData->postProc.balanceLeft, -1.0f) && carla_isEqual(pData->postProc.balanceRight, 1.0f));
-
-            bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
-
-            for (uint32_t i=0; i < pData->audioOut.count; ++i)
-            {
-                // Dry/Wet
-                if (doDryWet)
-                {
-                    for (uint32_t k=0; k < frames; ++k)
-                    {
-                        bufValue        = audioIn[(pData->audioIn.count == 1) ? 0 : i][k];
-                        audioOut[i][k] = (audioOut[i][k] * pData->postProc.dryWet) + (bufValue * (1.0f - pData->postProc.dryWet));
-                    }
-                }
-
-                // Balance
-                if (doBalance)
-                {
-                    isPair = (i % 2 == 0);
-
-                    if (isPair)
-                    {
-                        CARLA_ASSERT(i+1 < pData->audioOut.count);
-                        FloatVectorOperations::copy(oldBufLeft, audioOut[i], static_cast<int>(frames));
-                    }
-
-                    float balRangeL = (pData->postProc.balanceLeft  + 1.0f)/2.0f;
-                    float balRangeR = (pData->postProc.balanceRight + 1.0f)/2.0f;
-
-                    for (uint32_t k=0; k < frames; ++k)
-                    {
-                        if (isPair)
-                        {
-                            // left
-                            audioOut[i][k]  = oldBufLeft[k]     * (1.0f - balRangeL);
-                            audioOut[i][k] += audioOut[i+1][k] * (1.0f - balRangeR);
-                        }
-                        else
-                        {
-                            // right
-                            audioOut[i][k]  = audioOut[i][k] * balRangeR;
-                            audioOut[i][k] += oldBufLeft[k]   * balRangeL;
-                        }
-                    }
-                }
-
-                // Volume (and buffer copy)
-                if (doVolume)
-                {
-                    for (uint32_t k=0; k < frames; ++k)
-                        audioOut[i][k] *= pData->postProc.volume;
-                }
-            }
-
-        } // End of Post-processing
-
-#endif // BUILD_BRIDGE
-
-        // --------------------------------------------------------------------------------------------------------
-
-        pData->singleMutex.unlock();
-        return true;
+    // Post-processing (dry/wet, volume and balance)
+    void processPostProc(const float** const audioIn, float** const audioOut, const uint32_t frames)
+    {
+        pData->postProcessAudio(audioIn, audioOut, audioOut, frames, 0, 0);
     }
+#endif
 
     void bufferSizeChanged(const uint32_t newBufferSize) override
     {
@@ -2313,50 +3480,49 @@ public:
                 CarlaPlugin::setCustomData(type, key, value, false);
             }   break;
 
-            case kPluginBridgeNonRtServerSetChunkDataFile: {
-                // uint/size, str[] (filename)
+            case kPluginBridgeNonRtServerSetChunkData: {
+                // ulong/total, ulong/offset, uint/size
+                const uint64_t total(fShmNonRtServerControl.readULong());
+                const uint64_t offset(fShmNonRtServerControl.readULong());
+                const uint32_t pieceSize(fShmNonRtServerControl.readUInt());
 
-                // chunkFilePath
-                const uint32_t chunkFilePathSize(fShmNonRtServerControl.readUInt());
-                char chunkFilePath[chunkFilePathSize+1];
-                carla_zeroChars(chunkFilePath, chunkFilePathSize+1);
-                fShmNonRtServerControl.readCustomData(chunkFilePath, chunkFilePathSize);
+                CARLA_SAFE_ASSERT_BREAK(fShmChunkPool.data != nullptr);
 
-                String realChunkFilePath(chunkFilePath);
-                carla_stdout("chunk save path BEFORE => %s", realChunkFilePath.toRawUTF8());
-
-#ifndef CARLA_OS_WIN
-                // Using Wine, fix temp dir
-                if (fBinaryType == BINARY_WIN32 || fBinaryType == BINARY_WIN64)
+                // pieces come in order, a new transfer starts at offset 0
+                if (offset == 0)
                 {
-                    // Get WINEPREFIX
-                    String wineDir;
-                    if (const char* const WINEPREFIX = getenv("WINEPREFIX"))
-                        wineDir = String(WINEPREFIX);
-                    else
-                        wineDir = File::getSpecialLocation(File::userHomeDirectory).getFullPathName() + "/.wine";
-
-                    const StringArray driveLetterSplit(StringArray::fromTokens(realChunkFilePath, ":/", ""));
-
-                    realChunkFilePath  = wineDir;
-                    realChunkFilePath += "/drive_";
-                    realChunkFilePath += driveLetterSplit[0].toLowerCase();
-                    realChunkFilePath += "/";
-                    realChunkFilePath += driveLetterSplit[1];
-
-                    realChunkFilePath  = realChunkFilePath.replace("\\", "/");
-                    carla_stdout("chunk save path AFTER => %s", realChunkFilePath.toRawUTF8());
+                    fChunkRecv.resize(total);
+                    fChunkRecvOffset = 0;
+                    fChunkRecvPieces = 0;
+                    fChunkRecvStartTicks = Time::getHighResolutionTicks();
                 }
-#endif
 
-                File chunkFile(realChunkFilePath);
+                if (pieceSize <= fShmChunkPool.size && offset+pieceSize <= total &&
+                    offset == fChunkRecvOffset && fChunkRecv.size() == total)
+                {
+                    std::memcpy(fChunkRecv.data()+offset, fShmChunkPool.getData(), pieceSize);
+                    fChunkRecvOffset += pieceSize;
+                    ++fChunkRecvPieces;
+
+                    // only a complete chunk replaces the current one
+                    if (fChunkRecvOffset == total)
+                    {
+                        fInfo.chunk.swap(fChunkRecv);
+                        discardChunkRecv();
+
+                        printChunkTransferStats("received chunk of", total, fChunkRecvPieces, fChunkRecvStartTicks);
 
-                if (chunkFile.existsAsFile())
+                        // try to get it in one piece next time
+                        fChunkPoolWantedSize = total;
+                    }
+                }
+                else if (! fChunkRecv.empty())
                 {
-                    fInfo.chunk = carla_getChunkFromBase64String(chunkFile.loadFileAsString().toRawUTF8());
-                    chunkFile.deleteFile();
-                    carla_stderr("chunk data final");
+                    carla_stderr2("CarlaPluginBridge - chunk piece out of sequence, discarding received chunk");
+                    discardChunkRecv();
                 }
+
+                fShmChunkPool.setPieceReady(false);
             }   break;
 
             case kPluginBridgeNonRtServerSetLatency: {
@@ -2406,7 +3572,7 @@ public:
 
     uintptr_t getUiBridgeProcessId() const noexcept override
     {
-        return fBridgeThread.getProcessPID();
+        return (fGroup != nullptr) ? fGroup->getProcessPID() : fBridgeThread.getProcessPID();
     }
 
     const void* getExtraStuff() const noexcept override
@@ -2451,6 +3617,20 @@ public:
 
         std::srand(static_cast<uint>(std::time(nullptr)));
 
+        // ---------------------------------------------------------------
+        // join a bridge group, if enabled
+
+        if (pData->engine->getOptions().bridgesGroupSize > 1)
+        {
+            fGroup = CarlaPluginBridgeGroup::acquire(this, fBinaryType, bridgeBinary, fGroupSlot);
+
+            if (fGroup == nullptr)
+            {
+                carla_stdout("Failed to start plugin-bridge group");
+                return false;
+            }
+        }
+
         // ---------------------------------------------------------------
         // init sem/shm
 
@@ -2460,7 +3640,8 @@ public:
             return false;
         }
 
-        if (! fShmRtClientControl.initialize())
+        if (! (fGroup != nullptr ? fShmRtClientControl.attach(fGroup->getRtClientFilename(), fGroup->getSlotCount())
+                                 : fShmRtClientControl.initialize()))
         {
             carla_stdout("Failed to initialize RT client control");
             fShmAudioPool.clear();
@@ -2487,13 +3668,13 @@ public:
         // ---------------------------------------------------------------
 
         carla_stdout("Carla Server Info:");
-        carla_stdout("  sizeof(BridgeRtClientData):    " P_SIZE, sizeof(BridgeRtClientData));
+        carla_stdout("  sizeof(BridgeRtClientData):    " P_SIZE, fShmRtClientControl.dataSize);
         carla_stdout("  sizeof(BridgeNonRtClientData): " P_SIZE, sizeof(BridgeNonRtClientData));
         carla_stdout("  sizeof(BridgeNonRtServerData): " P_SIZE, sizeof(BridgeNonRtServerData));
 
         // initial values
         fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientNull);
-        fShmNonRtClientControl.writeUInt(static_cast<uint32_t>(sizeof(BridgeRtClientData)));
+        fShmNonRtClientControl.writeUInt(static_cast<uint32_t>(fShmRtClientControl.dataSize));
         fShmNonRtClientControl.writeUInt(static_cast<uint32_t>(sizeof(BridgeNonRtClientData)));
         fShmNonRtClientControl.writeUInt(static_cast<uint32_t>(sizeof(BridgeNonRtServerData)));
 
@@ -2515,8 +3696,15 @@ public:
             std::strncpy(shmIdsStr+6*2, &fShmNonRtClientControl.filename[fShmNonRtClientControl.filename.length()-6], 6);
             std::strncpy(shmIdsStr+6*3, &fShmNonRtServerControl.filename[fShmNonRtServerControl.filename.length()-6], 6);
 
-            fBridgeThread.setData(bridgeBinary, label, shmIdsStr);
-            fBridgeThread.startThread();
+            if (fGroup != nullptr)
+            {
+                fGroup->addMember(fGroupSlot, this, filename, label, shmIdsStr);
+            }
+            else
+            {
+                fBridgeThread.setData(bridgeBinary, label, shmIdsStr);
+                fBridgeThread.startThread();
+            }
         }
 
         fInitiated = false;
@@ -2535,11 +3723,14 @@ public:
 #endif
         sFirstInit = false;
 
-        const bool needsEngineIdle = pData->engine->getType() != kEngineTypePlugin;
+        // the engine is idled by the main thread while loading projects in the background
+        const bool isLoaderThread = pData->engine->isProjectLoaderThread();
+        const bool needsEngineIdle = pData->engine->getType() != kEngineTypePlugin && ! isLoaderThread;
 
-        for (; Time::currentTimeMillis() < fLastPongTime + timeoutEnd && fBridgeThread.isThreadRunning();)
+        for (; Time::currentTimeMillis() < fLastPongTime + timeoutEnd && isBridgeRunning();)
         {
-            pData->engine->callback(ENGINE_CALLBACK_IDLE, 0, 0, 0, 0.0f, nullptr);
+            if (! isLoaderThread)
+                pData->engine->callback(ENGINE_CALLBACK_IDLE, 0, 0, 0, 0.0f, nullptr);
 
             if (needsEngineIdle)
                 pData->engine->idle();
@@ -2556,7 +3747,8 @@ public:
 
         if (fInitError || ! fInitiated)
         {
-            fBridgeThread.stopThread(6000);
+            if (fGroup == nullptr)
+                fBridgeThread.stopThread(6000);
 
             if (! fInitError)
                 pData->engine->setLastError("Timeout while waiting for a response from plugin-bridge\n(or the plugin crashed on initialization?)");
@@ -2595,16 +3787,34 @@ private:
     bool fSaved;
     bool fTimedOut;
     bool fTimedError;
+    bool fProcessKicked; // between processKick and processCollect
+
+    BridgeProcessDeadline fDeadline;
+    float* fLastAudioOut;   // previous output, faded out on the first miss
+    uint32_t fLastAudioOutFrames; // 0 if not valid
 
     int64_t fLastPongTime;
 
     CarlaString             fBridgeBinary;
     CarlaPluginBridgeThread fBridgeThread;
 
+    // set when hosted by a shared bridge process
+    CarlaPluginBridgeGroup* fGroup;
+    uint                    fGroupSlot;
+
     BridgeAudioPool          fShmAudioPool;
     BridgeRtClientControl    fShmRtClientControl;
     BridgeNonRtClientControl fShmNonRtClientControl;
     BridgeNonRtServerControl fShmNonRtServerControl;
+    BridgeChunkPool          fShmChunkPool;
+
+    uint64_t fChunkPoolWantedSize;
+
+    // chunk being received from the bridge, moved into fInfo.chunk once complete
+    std::vector<uint8_t> fChunkRecv;
+    uint64_t fChunkRecvOffset;
+    uint32_t fChunkRecvPieces;
+    int64_t  fChunkRecvStartTicks;
 
     struct Info {
         uint32_t aIns, aOuts;
@@ -2638,30 +3848,182 @@ private:
 
     BridgeParamInfo* fParams;
 
+    // whether this plugin can be processed as part of a rack chain in a group
+    bool canChainInGroup(CarlaPluginBridgeGroup* const group) const noexcept
+    {
+        if (fGroup != group || ! fInitiated || fTimedOut || fTimedError || fDeadline.isDegraded() || ! pData->active)
+            return false;
+
+        return fInfo.aOuts == 2 && fInfo.cvIns == 0 && fInfo.cvOuts == 0;
+    }
+
+    // whether the raw outputs of this plugin can be given to the next one in the chain
+    bool canFeedNextInGroup() const noexcept
+    {
+        if (pData->event.portOut != nullptr)
+            return false;
+#ifndef BUILD_BRIDGE
+        if ((pData->hints & PLUGIN_CAN_VOLUME) != 0 && carla_isNotEqual(pData->postProc.volume, 1.0f))
+            return false;
+        if ((pData->hints & PLUGIN_CAN_DRYWET) != 0 && carla_isNotEqual(pData->postProc.dryWet, 1.0f))
+            return false;
+        if ((pData->hints & PLUGIN_CAN_BALANCE) != 0 && ! (carla_isEqual(pData->postProc.balanceLeft, -1.0f) && carla_isEqual(pData->postProc.balanceRight, 1.0f)))
+            return false;
+#endif
+        return true;
+    }
+
+    static float getBufferPeak(const float* const buffer, const int frames) noexcept
+    {
+        const juce::Range<float> range(FloatVectorOperations::findMinAndMax(buffer, frames));
+        return carla_maxLimited<float>(std::abs(range.getStart()), std::abs(range.getEnd()), 1.0f);
+    }
+
+    bool isBridgeRunning() const noexcept
+    {
+        return (fGroup != nullptr) ? fGroup->isRunning() : fBridgeThread.isThreadRunning();
+    }
+
+    // rt channel of a group must be locked
+    void selectGroupSlot() noexcept
+    {
+        if (fGroup == nullptr)
+            return;
+
+        fShmRtClientControl.writeOpcode(kPluginBridgeRtClientSetPlugin);
+        fShmRtClientControl.writeUInt(fGroupSlot);
+        fShmRtClientControl.commitWrite();
+    }
+
     void resizeAudioPool(const uint32_t bufferSize)
     {
         fShmAudioPool.resize(bufferSize, fInfo.aIns+fInfo.aOuts, fInfo.cvIns+fInfo.cvOuts);
 
+        fLastAudioOutFrames = 0;
+
+        if (fLastAudioOut != nullptr)
+        {
+            delete[] fLastAudioOut;
+            fLastAudioOut = nullptr;
+        }
+
+        if (fInfo.aOuts > 0 && bufferSize > 0)
+            fLastAudioOut = new float[fInfo.aOuts * bufferSize];
+
+        ScopedBridgeGroupRequest sbgr(fGroup);
+
+        selectGroupSlot();
+
         fShmRtClientControl.writeOpcode(kPluginBridgeRtClientSetAudioPool);
         fShmRtClientControl.writeULong(static_cast<uint64_t>(fShmAudioPool.size));
 
         fShmRtClientControl.commitWrite();
 
-        waitForClient("resize-pool");
+        waitForClient(sbgr, "resize-pool", 5);
     }
 
     void waitForClient(const char* const action, const uint secs = 5)
+    {
+        ScopedBridgeGroupRequest sbgr(fGroup);
+
+        waitForClient(sbgr, action, secs);
+    }
+
+    // Wakes up the client for what was written in the rt channel and waits for it to go through.
+    // The group rt lock is released before waiting, until the reply comes the audio thread sees the client busy
+    // and skips its blocks instead of waiting for the lock.
+    void waitForClient(ScopedBridgeGroupRequest& sbgr, const char* const action, const uint secs)
     {
         CARLA_SAFE_ASSERT_RETURN(! fTimedOut,);
         CARLA_SAFE_ASSERT_RETURN(! fTimedError,);
 
-        if (fShmRtClientControl.waitForClient(secs))
+        fShmRtClientControl.postRequest();
+        sbgr.sent();
+
+        if (fShmRtClientControl.waitForReply(secs))
             return;
 
         fTimedOut = true;
         carla_stderr("waitForClient(%s) timeout here", action);
     }
 
+    // Wait for the reply of a process request that was sent with wakeForProcess.
+    // Without a deadline a bridge that does not reply within 1 second is timed out and no longer used.
+    // With one, a late bridge only misses this block and its reply is skipped once it comes.
+    bool waitForProcess(const char* const action, const uint32_t frames)
+    {
+        CARLA_SAFE_ASSERT_RETURN(! fTimedOut, false);
+        CARLA_SAFE_ASSERT_RETURN(! fTimedError, false);
+
+        const uint deadline(pData->engine->isOffline() ? 0 : pData->engine->getOptions().bridgesDeadline);
+        const uint spinTime(pData->engine->getOptions().bridgesSpinTime);
+
+        if (deadline == 0)
+        {
+            if (fShmRtClientControl.waitForProcessReply(1000000, spinTime))
+                return true;
+
+            fTimedOut = true;
+            carla_stderr("waitForClient(%s) timeout here", action);
+            return false;
+        }
+
+        if (fShmRtClientControl.waitForProcessReply(BridgeProcessDeadline::getTimeout(frames, pData->engine->getSampleRate(), deadline), spinTime))
+        {
+            fDeadline.met();
+            return true;
+        }
+
+        fDeadline.miss();
+        return false;
+    }
+
+    // whether a process request can be sent now, while degraded only about one block per second is tried
+    bool isReadyForProcess(const uint32_t frames) noexcept
+    {
+        return fDeadline.isReady(fShmRtClientControl.isClientBusy(), static_cast<uint32_t>(pData->engine->getSampleRate()) / std::max(1U, frames));
+    }
+
+    // a block was skipped before its input events were sent
+    void dropEventInput() noexcept
+    {
+        if (pData->event.portIn != nullptr && pData->event.portIn->getEventCount() > 0)
+            fDeadline.eventsLost = true;
+    }
+
+    // output of a block without a reply, fades out the previous output if there is one, silence otherwise
+    void processMissed(float** const audioOut, float** const cvOut, const uint32_t frames) noexcept
+    {
+        const bool fadeOut(fLastAudioOutFrames == frames);
+
+        for (uint32_t i=0; i < pData->audioOut.count; ++i)
+        {
+            if (fadeOut && i < fInfo.aOuts)
+                carla_postProcGain(audioOut[i], fLastAudioOut + (i * frames), frames, 1.0f, -1.0f/static_cast<float>(frames));
+            else
+                FloatVectorOperations::clear(audioOut[i], static_cast<int>(frames));
+        }
+
+        for (uint32_t i=0; i < pData->cvOut.count; ++i)
+            FloatVectorOperations::clear(cvOut[i], static_cast<int>(frames));
+
+        fLastAudioOutFrames = 0;
+    }
+
+    void keepLastOutput(float** const audioOut, const uint32_t frames) noexcept
+    {
+        if (fLastAudioOut == nullptr || pData->engine->getOptions().bridgesDeadline == 0 || frames > pData->engine->getBufferSize())
+        {
+            fLastAudioOutFrames = 0;
+            return;
+        }
+
+        for (uint32_t i=0; i < fInfo.aOuts; ++i)
+            FloatVectorOperations::copy(fLastAudioOut + (i * frames), audioOut[i], static_cast<int>(frames));
+
+        fLastAudioOutFrames = frames;
+    }
+
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaPluginBridge)
 };
 
@@ -626,6 +626,9 @@ public:
 
         if (index >= 0 && fHandles.count() > 0)
         {
+            if ((sendGui || sendOsc || sendCallback) && pData->runInAudioThread(kPluginRtCommandMidiProgram, index, 0.0f))
+                return CarlaPlugin::setMidiProgram(index, sendGui, sendOsc, sendCallback);
+
             const uint32_t bank(pData->midiprog.data[index].bank);
             const uint32_t program(pData->midiprog.data[index].program);
 
@@ -1330,6 +1333,11 @@ public:
             return;
         }
 
+        // --------------------------------------------------------------------------------------------------------
+        // Run commands from the host
+
+        pData->rtCommands.runRT(this);
+
         ulong midiEventCount = 0;
         carla_zeroStructs(fMidiEvents, kPluginMaxMidiEvents);
 
@@ -1923,73 +1931,7 @@ public:
         // --------------------------------------------------------------------------------------------------------
         // Post-processing (dry/wet, volume and balance)
 
-        {
-            const bool doDryWet  = (pData->hints & PLUGIN_CAN_DRYWET) != 0 && carla_isNotEqual(pData->postProc.dryWet, 1.0f);
-            const bool doBalance = (pData->hints & PLUGIN_CAN_BALANCE) != 0 && ! (carla_isEqual(pData->postProc.balanceLeft, -1.0f) && carla_isEqual(pData->postProc.balanceRight, 1.0f));
-            const bool isMono    = (pData->audioIn.count == 1);
-
-            bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
-
-            for (uint32_t i=0; i < pData->audioOut.count; ++i)
-            {
-                // Dry/Wet
-                if (doDryWet)
-                {
-                    for (uint32_t k=0; k < frames; ++k)
-                    {
-#if 0 // TODO
-                        if (k < pData->latency)
-                            bufValue = pData->latencyBuffers[isMono ? 0 : i][k];
-                        else if (pData->latency < frames)
-                            bufValue = fAudioInBuffers[isMono ? 0 : i][k-pData->latency];
-                        else
-#endif
-                            bufValue = fAudioInBuffers[isMono ? 0 : i][k];
-
-                        fAudioOutBuffers[i][k] = (fAudioOutBuffers[i][k] * pData->postProc.dryWet) + (bufValue * (1.0f - pData->postProc.dryWet));
-                    }
-                }
-
-                // Balance
-                if (doBalance)
-                {
-                    isPair = (i % 2 == 0);
-
-                    if (isPair)
-                    {
-                        CARLA_ASSERT(i+1 < pData->audioOut.count);
-                        FloatVectorOperations::copy(oldBufLeft, fAudioOutBuffers[i], static_cast<int>(frames));
-                    }
-
-                    float balRangeL = (pData->postProc.balanceLeft  + 1.0f)/2.0f;
-                    float balRangeR = (pData->postProc.balanceRight + 1.0f)/2.0f;
-
-                    for (uint32_t k=0; k < frames; ++k)
-                    {
-                        if (isPair)
-                        {
-                            // left
-                            fAudioOutBuffers[i][k]  = oldBufLeft[k]            * (1.0f - balRangeL);
-                            fAudioOutBuffers[i][k] += fAudioOutBuffers[i+1][k] * (1.0f - balRangeR);
-                        }
-                        else
-                        {
-                            // right
-                            fAudioOutBuffers[i][k]  = fAudioOutBuffers[i][k] * balRangeR;
-                            fAudioOutBuffers[i][k] += oldBufLeft[k]          * balRangeL;
-                        }
-                    }
-                }
-
-                // Volume (and buffer copy)
-                {
-                    for (uint32_t k=0; k < frames; ++k)
-                        audioOut[i][k+timeOffset] = fAudioOutBuffers[i][k] * pData->postProc.volume;
-                }
-            }
-
-        } // End of Post-processing
+        pData->postProcessAudio(fAudioInBuffers, fAudioOutBuffers, audioOut, frames, 0, timeOffset);
 
 #else // BUILD_BRIDGE
         for (uint32_t i=0; i < pData->audioOut.count; ++i)
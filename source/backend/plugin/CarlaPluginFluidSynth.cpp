@@ -389,6 +389,10 @@ public:
         CARLA_SAFE_ASSERT_RETURN(parameterId < pData->param.count,);
 
         const float fixedValue(pData->param.getFixedValue(parameterId, value));
+
+        if ((sendGui || sendOsc || sendCallback) && pData->runInAudioThread(kPluginRtCommandParameterValue, static_cast<int32_t>(parameterId), fixedValue))
+            return CarlaPlugin::setParameterValue(parameterId, value, sendGui, sendOsc, sendCallback);
+
         fParamBuffers[parameterId] = fixedValue;
 
         {
@@ -1017,6 +1021,11 @@ public:
             return;
         }
 
+        // --------------------------------------------------------------------------------------------------------
+        // Run commands from the host
+
+        pData->rtCommands.runRT(this);
+
         // --------------------------------------------------------------------------------------------------------
         // Check if needs reset
 
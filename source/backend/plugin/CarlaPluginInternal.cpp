@@ -21,6 +21,8 @@
 #include "CarlaLibCounter.hpp"
 #include "CarlaMathUtils.hpp"
 
+#include <limits>
+
 CARLA_BACKEND_START_NAMESPACE
 
 // -------------------------------------------------------------------
@@ -466,6 +468,136 @@ void CarlaPlugin::ProtectedData::Latency::recreateBuffers(const uint32_t newChan
     }
 }
 
+// keep the last 'frames' samples of the input, oldest first
+void CarlaPlugin::ProtectedData::Latency::pushInput(const float* const* const inBuffers, const uint32_t inCount, const uint32_t inOffset, const uint32_t inFrames) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(buffers != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(inCount <= channels,);
+
+    for (uint32_t i=0; i < inCount; ++i)
+    {
+        const float* const in(inBuffers[i] + inOffset);
+
+        if (frames <= inFrames)
+        {
+            FloatVectorOperations::copy(buffers[i], in + (inFrames - frames), static_cast<int>(frames));
+        }
+        else
+        {
+            // push back buffer by 'inFrames' and put current input at the end
+            std::memmove(buffers[i], buffers[i] + inFrames, sizeof(float)*(frames - inFrames));
+            FloatVectorOperations::copy(buffers[i] + (frames - inFrames), in, static_cast<int>(inFrames));
+        }
+    }
+}
+
+void CarlaPlugin::ProtectedData::Latency::swapWith(Latency& other) noexcept
+{
+    const uint32_t tmpChannels(channels);
+    const uint32_t tmpFrames(frames);
+    float** const  tmpBuffers(buffers);
+
+    channels = other.channels;
+    frames   = other.frames;
+    buffers  = other.buffers;
+
+    other.channels = tmpChannels;
+    other.frames   = tmpFrames;
+    other.buffers  = tmpBuffers;
+}
+
+// -----------------------------------------------------------------------
+// ProtectedData::RtCommands
+
+// command states, only a pending command can be taken by the audio thread or cancelled by its writer
+enum {
+    kRtCommandStatePending = 0,
+    kRtCommandStateTaken,
+    kRtCommandStateDone,
+    kRtCommandStateCancelled
+};
+
+CarlaPlugin::ProtectedData::RtCommands::RtCommands() noexcept
+    : mutex(),
+      head(0),
+      tail(0)
+{
+    carla_zeroStructs(data, kPluginMaxRtCommands);
+}
+
+bool CarlaPlugin::ProtectedData::RtCommands::sendAndWait(const PluginRtCommand& command, const uint timeoutMs) noexcept
+{
+    const CarlaMutexLocker cml(mutex);
+
+    const uint32_t pos(__atomic_load_n(&head, __ATOMIC_RELAXED));
+
+    // full of cancelled commands, the audio thread is not running
+    if (pos - __atomic_load_n(&tail, __ATOMIC_ACQUIRE) >= kPluginMaxRtCommands)
+        return false;
+
+    PluginRtCommand& slot(data[pos % kPluginMaxRtCommands]);
+    slot = command;
+    slot.state = kRtCommandStatePending;
+
+    __atomic_store_n(&head, pos+1, __ATOMIC_RELEASE);
+
+    for (uint i=0; i < timeoutMs; ++i)
+    {
+        if (__atomic_load_n(&slot.state, __ATOMIC_ACQUIRE) == kRtCommandStateDone)
+            return true;
+
+        carla_msleep(1);
+    }
+
+    // take it back, unless the audio thread is already running it
+    int expected = kRtCommandStatePending;
+
+    if (__atomic_compare_exchange_n(&slot.state, &expected, kRtCommandStateCancelled, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        return false;
+
+    while (__atomic_load_n(&slot.state, __ATOMIC_ACQUIRE) != kRtCommandStateDone)
+        carla_msleep(1);
+
+    return true;
+}
+
+void CarlaPlugin::ProtectedData::RtCommands::runRT(CarlaPlugin* const plugin) noexcept
+{
+    const uint32_t end(__atomic_load_n(&head, __ATOMIC_ACQUIRE));
+
+    for (uint32_t pos = __atomic_load_n(&tail, __ATOMIC_RELAXED); pos != end; ++pos)
+    {
+        PluginRtCommand& command(data[pos % kPluginMaxRtCommands]);
+        int expected = kRtCommandStatePending;
+
+        if (__atomic_compare_exchange_n(&command.state, &expected, kRtCommandStateTaken, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            switch (command.type)
+            {
+            case kPluginRtCommandNull:
+                break;
+            case kPluginRtCommandParameterValue:
+                plugin->setParameterValue(static_cast<uint32_t>(command.index), command.value, false, false, false);
+                break;
+            case kPluginRtCommandProgram:
+                plugin->setProgram(command.index, false, false, false);
+                break;
+            case kPluginRtCommandMidiProgram:
+                plugin->setMidiProgram(command.index, false, false, false);
+                break;
+            case kPluginRtCommandSwapLatency:
+                CARLA_SAFE_ASSERT_BREAK(command.data != nullptr);
+                plugin->pData->latency.swapWith(*(Latency*)command.data);
+                break;
+            }
+
+            __atomic_store_n(&command.state, kRtCommandStateDone, __ATOMIC_RELEASE);
+        }
+
+        __atomic_store_n(&tail, pos+1, __ATOMIC_RELEASE);
+    }
+}
+
 // -----------------------------------------------------------------------
 // ProtectedData::PostRtEvents
 
@@ -529,6 +661,80 @@ void CarlaPlugin::ProtectedData::PostUiEvents::clear() noexcept
     mutex.unlock();
 }
 
+// -----------------------------------------------------------------------
+// ProtectedData::ParamChanges
+
+CarlaPlugin::ProtectedData::ParamChanges::ParamChanges() noexcept
+    : mutex(),
+      count(0),
+      values(nullptr),
+      outputValues(nullptr),
+      bits(nullptr),
+      pendingBits(nullptr),
+      pendingValues(nullptr),
+      hasChanges(false) {}
+
+CarlaPlugin::ProtectedData::ParamChanges::~ParamChanges() noexcept
+{
+    clear();
+}
+
+void CarlaPlugin::ProtectedData::ParamChanges::resize(const uint32_t newCount)
+{
+    clear();
+
+    if (newCount == 0)
+        return;
+
+    const CarlaMutexLocker cml(mutex);
+    const uint32_t words(wordCount(newCount));
+
+    values        = new float[newCount];
+    outputValues  = new float[newCount];
+    bits          = new uint32_t[words];
+    pendingBits   = new uint32_t[words];
+    pendingValues = new float[newCount];
+
+    carla_zeroFloats(values, newCount);
+    carla_zeroFloats(pendingValues, newCount);
+    carla_zeroStructs(bits, words);
+    carla_zeroStructs(pendingBits, words);
+
+    // never matches, so the first output value is always sent
+    for (uint32_t i=0; i < newCount; ++i)
+        outputValues[i] = std::numeric_limits<float>::quiet_NaN();
+
+    count = newCount;
+}
+
+void CarlaPlugin::ProtectedData::ParamChanges::clear() noexcept
+{
+    const CarlaMutexLocker cml(mutex);
+
+    delete[] values;
+    delete[] outputValues;
+    delete[] bits;
+    delete[] pendingBits;
+    delete[] pendingValues;
+
+    values        = nullptr;
+    outputValues  = nullptr;
+    bits          = nullptr;
+    pendingBits   = nullptr;
+    pendingValues = nullptr;
+    hasChanges    = false;
+    count         = 0;
+}
+
+void CarlaPlugin::ProtectedData::ParamChanges::set(const uint32_t index, const float value) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(index < count,);
+
+    values[index] = value;
+    bits[index / 32] |= 1U << (index % 32);
+    hasChanges = true;
+}
+
 #ifndef BUILD_BRIDGE
 // -----------------------------------------------------------------------
 // ProtectedData::PostProc
@@ -538,7 +744,8 @@ CarlaPlugin::ProtectedData::PostProc::PostProc() noexcept
       volume(1.0f),
       balanceLeft(-1.0f),
       balanceRight(1.0f),
-      panning(0.0f) {}
+      panning(0.0f),
+      current() {}
 #endif
 
 // -----------------------------------------------------------------------
@@ -575,8 +782,10 @@ CarlaPlugin::ProtectedData::ProtectedData(CarlaEngine* const eng, const uint idx
       stateSave(),
       extNotes(),
       latency(),
+      rtCommands(),
       postRtEvents(),
-      postUiEvents()
+      postUiEvents(),
+      paramChanges()
 #ifndef BUILD_BRIDGE
     , postProc()
 #endif
@@ -705,6 +914,28 @@ void CarlaPlugin::ProtectedData::postponeRtEvent(const PluginPostRtEventType typ
     postRtEvents.appendRT(rtEvent);
 }
 
+// -----------------------------------------------------------------------
+// RT commands
+
+bool CarlaPlugin::ProtectedData::runInAudioThread(const PluginRtCommandType type, const int32_t index, const float value, void* const data) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(type != kPluginRtCommandNull, false);
+
+    // offline processing waits for the locks, so it does not need this
+    if (! (enabled && active && client != nullptr && client->isActive()))
+        return false;
+    if (! engine->isRunning() || engine->isOffline())
+        return false;
+
+    // a few cycles should be enough, otherwise something else is keeping the plugin from running
+    const double cycleMs(static_cast<double>(engine->getBufferSize()) * 1000.0 / engine->getSampleRate());
+    const uint timeoutMs(static_cast<uint>(cycleMs * 4.0) + 50);
+
+    const PluginRtCommand command = { type, index, value, data, kRtCommandStatePending };
+
+    return rtCommands.sendAndWait(command, timeoutMs);
+}
+
 // -----------------------------------------------------------------------
 // Library functions
 
@@ -783,6 +1014,89 @@ void CarlaPlugin::ProtectedData::updateParameterValues(CarlaPlugin* const plugin
     return; (void)sendOsc;
 }
 
+void CarlaPlugin::ProtectedData::flushParameterChanges() noexcept
+{
+    ParamChanges& changes(paramChanges);
+
+    const bool batch(engine->getOptions().batchParameterChanges);
+#if defined(HAVE_LIBLO) && ! defined(BUILD_BRIDGE)
+    const bool sendOsc(engine->isOscControlRegistered());
+#endif
+    const uint32_t words(ParamChanges::wordCount(changes.count));
+    uint32_t changedCount = 0;
+
+    if (batch)
+        changes.mutex.lock();
+
+    for (uint32_t w=0; w < words; ++w)
+    {
+        for (uint32_t bits = changes.bits[w]; bits != 0; bits &= bits - 1)
+        {
+            const uint32_t index(w*32 + static_cast<uint32_t>(__builtin_ctz(bits)));
+            const float value(changes.values[index]);
+
+#if defined(HAVE_LIBLO) && ! defined(BUILD_BRIDGE)
+            // Update OSC control client
+            if (sendOsc)
+                engine->oscSend_control_set_parameter_value(id, static_cast<int32_t>(index), value);
+#endif
+            // Update Host
+            if (batch)
+                changes.pendingValues[index] = value;
+            else
+                engine->callback(ENGINE_CALLBACK_PARAMETER_VALUE_CHANGED, id, static_cast<int>(index), 0, value, nullptr);
+
+            ++changedCount;
+        }
+
+        if (batch)
+            changes.pendingBits[w] |= changes.bits[w];
+
+        changes.bits[w] = 0;
+    }
+
+    changes.hasChanges = false;
+
+    if (! batch)
+        return;
+
+    changes.mutex.unlock();
+
+    engine->callback(ENGINE_CALLBACK_PARAMETER_VALUES_CHANGED, id, static_cast<int>(changedCount), 0, 0.0f, nullptr);
+}
+
+#ifndef BUILD_BRIDGE
+void CarlaPlugin::ProtectedData::postProcessAudio(const float* const* const dryBuffers, const float* const* const wetBuffers, float* const* const outBuffers,
+                                                  const uint32_t frames, const uint32_t inOffset, const uint32_t outOffset) noexcept
+{
+    CarlaPostProcGains target;
+    target.set((hints & PLUGIN_CAN_DRYWET)  != 0 ? postProc.dryWet       :  1.0f,
+               (hints & PLUGIN_CAN_VOLUME)  != 0 ? postProc.volume       :  1.0f,
+               (hints & PLUGIN_CAN_BALANCE) != 0 ? postProc.balanceLeft  : -1.0f,
+               (hints & PLUGIN_CAN_BALANCE) != 0 ? postProc.balanceRight :  1.0f,
+               (hints & PLUGIN_CAN_PANNING) != 0 ? postProc.panning      :  0.0f);
+
+    // the dry signal is delayed by the plugin latency, older samples come from the latency buffers
+    const bool useLatency(latency.frames > 0 && latency.buffers != nullptr && latency.channels >= audioIn.count);
+
+    CarlaPostProcBuffers buf;
+    buf.dry           = dryBuffers;
+    buf.dryChannels   = (dryBuffers != nullptr) ? audioIn.count : 0;
+    buf.delayed       = useLatency ? latency.buffers : nullptr;
+    buf.delayedFrames = useLatency ? latency.frames  : 0;
+    buf.wet           = wetBuffers;
+    buf.out           = outBuffers;
+    buf.outChannels   = audioOut.count;
+    buf.inOffset      = inOffset;
+    buf.outOffset     = outOffset;
+
+    carla_postProcess(buf, postProc.current, target, frames);
+
+    if (useLatency && dryBuffers != nullptr)
+        latency.pushInput(dryBuffers, audioIn.count, inOffset, frames);
+}
+#endif
+
 // -----------------------------------------------------------------------
 
 CARLA_BACKEND_END_NAMESPACE
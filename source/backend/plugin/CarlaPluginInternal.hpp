@@ -25,6 +25,7 @@
 
 #include "CarlaMIDI.h"
 #include "CarlaMutex.hpp"
+#include "CarlaPostProcUtils.hpp"
 #include "CarlaString.hpp"
 #include "RtLinkedList.hpp"
 
@@ -48,6 +49,11 @@ CARLA_BACKEND_START_NAMESPACE
 
 const ushort kPluginMaxMidiEvents = 512;
 
+// -----------------------------------------------------------------------
+// Maximum queued commands for the audio thread, per plugin
+
+const uint32_t kPluginMaxRtCommands = 32;
+
 // -----------------------------------------------------------------------
 // Extra plugin hints, hidden from backend
 
@@ -99,6 +105,35 @@ struct PluginPostRtEvent {
 
 // -----------------------------------------------------------------------
 
+/*!
+ * RT command type.
+ * These are changes requested by the host which the audio thread applies
+ * itself at the start of its next cycle, so it never has to skip processing
+ * because another thread holds the plugin locks.
+ * @see PluginRtCommand
+ */
+enum PluginRtCommandType {
+    kPluginRtCommandNull = 0,
+    kPluginRtCommandParameterValue, // index, value
+    kPluginRtCommandProgram,        // index
+    kPluginRtCommandMidiProgram,    // index
+    kPluginRtCommandSwapLatency     // data (ProtectedData::Latency*)
+};
+
+/*!
+ * A RT command.
+ * @see PluginRtCommandType
+ */
+struct PluginRtCommand {
+    PluginRtCommandType type;
+    int32_t index;
+    float   value;
+    void*   data;
+    int     state; // atomic, see ProtectedData::RtCommands
+};
+
+// -----------------------------------------------------------------------
+
 struct ExternalMidiNote {
     int8_t  channel; // invalid if -1
     uint8_t note;    // 0 to 127
@@ -277,11 +312,30 @@ struct CarlaPlugin::ProtectedData {
         ~Latency() noexcept;
         void clearBuffers() noexcept;
         void recreateBuffers(const uint32_t newChannels, const uint32_t newFrames);
+        void swapWith(Latency& other) noexcept;
+        void pushInput(const float* const* const inBuffers, const uint32_t inCount, const uint32_t inOffset, const uint32_t inFrames) noexcept;
 
         CARLA_DECLARE_NON_COPY_STRUCT(Latency)
 
     } latency;
 
+    // Single-consumer queue, read by the audio thread at the start of process().
+    // Writers are serialized with the mutex and wait for their command to be done,
+    // the audio thread never locks.
+    struct RtCommands {
+        CarlaMutex mutex;
+        PluginRtCommand data[kPluginMaxRtCommands];
+        uint32_t head; // atomic, written under mutex
+        uint32_t tail; // atomic, written by the audio thread
+
+        RtCommands() noexcept;
+        bool sendAndWait(const PluginRtCommand& command, const uint timeoutMs) noexcept;
+        void runRT(CarlaPlugin* const plugin) noexcept;
+
+        CARLA_DECLARE_NON_COPY_STRUCT(RtCommands)
+
+    } rtCommands;
+
     struct PostRtEvents {
         CarlaMutex mutex;
         RtLinkedList<PluginPostRtEvent>::Pool dataPool;
@@ -311,6 +365,32 @@ struct CarlaPlugin::ProtectedData {
 
     } postUiEvents;
 
+    // latest value per parameter, flushed once per idle
+    struct ParamChanges {
+        CarlaMutex mutex;
+        uint32_t   count;
+        float*     values;        // latest values of this idle
+        float*     outputValues;  // last output values sent by the engine thread
+        uint32_t*  bits;          // changed during this idle
+        uint32_t*  pendingBits;   // changed and not yet taken by the frontend, mutex protected
+        float*     pendingValues; // mutex protected
+        bool       hasChanges;
+
+        ParamChanges() noexcept;
+        ~ParamChanges() noexcept;
+        void resize(const uint32_t newCount);
+        void clear() noexcept;
+        void set(const uint32_t index, const float value) noexcept;
+
+        static uint32_t wordCount(const uint32_t paramCount) noexcept
+        {
+            return (paramCount + 31) / 32;
+        }
+
+        CARLA_DECLARE_NON_COPY_STRUCT(ParamChanges)
+
+    } paramChanges;
+
 #ifndef BUILD_BRIDGE
     struct PostProc {
         float dryWet;
@@ -319,6 +399,9 @@ struct CarlaPlugin::ProtectedData {
         float balanceRight;
         float panning;
 
+        // gains used in the last cycle, ramped towards the values above
+        CarlaPostProcGains current;
+
         PostProc() noexcept;
 
         CARLA_DECLARE_NON_COPY_STRUCT(PostProc)
@@ -340,6 +423,13 @@ struct CarlaPlugin::ProtectedData {
     void postponeRtEvent(const PluginPostRtEvent& rtEvent) noexcept;
     void postponeRtEvent(const PluginPostRtEventType type, const int32_t value1, const int32_t value2, const float value3) noexcept;
 
+    // -------------------------------------------------------------------
+    // RT commands
+
+    // Have the audio thread run a command and wait for it, must not be called from the audio thread.
+    // Returns false if the plugin is not being processed right now, the caller must then lock instead.
+    bool runInAudioThread(const PluginRtCommandType type, const int32_t index, const float value, void* const data = nullptr) noexcept;
+
     // -------------------------------------------------------------------
     // Library functions
 
@@ -370,6 +460,15 @@ struct CarlaPlugin::ProtectedData {
     void tryTransient() noexcept;
 #endif
     void updateParameterValues(CarlaPlugin* const plugin, const bool sendOsc, const bool sendCallback, const bool useDefault) noexcept;
+    void flushParameterChanges() noexcept;
+
+#ifndef BUILD_BRIDGE
+    // -------------------------------------------------------------------
+    // Post-processing
+
+    void postProcessAudio(const float* const* const dryBuffers, const float* const* const wetBuffers, float* const* const outBuffers,
+                          const uint32_t frames, const uint32_t inOffset, const uint32_t outOffset) noexcept;
+#endif
 
     // -------------------------------------------------------------------
 
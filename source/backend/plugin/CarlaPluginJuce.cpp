@@ -277,6 +277,9 @@ public:
 
         if (index >= 0)
         {
+            if ((sendGui || sendOsc || sendCallback) && pData->runInAudioThread(kPluginRtCommandProgram, index, 0.0f))
+                return CarlaPlugin::setProgram(index, sendGui, sendOsc, sendCallback);
+
             const ScopedSingleProcessLocker spl(this, (sendGui || sendOsc || sendCallback));
 
             try {
@@ -687,6 +690,11 @@ public:
             return;
         }
 
+        // --------------------------------------------------------------------------------------------------------
+        // Run commands from the host
+
+        pData->rtCommands.runRT(this);
+
         // --------------------------------------------------------------------------------------------------------
         // Check if needs reset
 
@@ -923,12 +931,18 @@ public:
                     if (status == MIDI_STATUS_NOTE_ON && midiData[2] == 0)
                         status = MIDI_STATUS_NOTE_OFF;
 
-                    // put back channel in data
-                    uint8_t midiData2[midiEvent.size];
-                    midiData2[0] = uint8_t(status | (event.channel & MIDI_CHANNEL_BIT));
-                    std::memcpy(midiData2+1, midiData+1, static_cast<std::size_t>(midiEvent.size-1));
+                    // put back channel in data, long messages are system messages without one
+                    uint8_t midiData2[EngineMidiEvent::kDataSize];
+                    const uint8_t* midiDataOut(midiData);
+
+                    if (midiEvent.size <= EngineMidiEvent::kDataSize)
+                    {
+                        midiData2[0] = uint8_t(status | (event.channel & MIDI_CHANNEL_BIT));
+                        std::memcpy(midiData2+1, midiData+1, static_cast<std::size_t>(midiEvent.size-1));
+                        midiDataOut = midiData2;
+                    }
 
-                    fMidiBuffer.addEvent(midiData2, midiEvent.size, static_cast<int>(event.time));
+                    fMidiBuffer.addEvent(midiDataOut, midiEvent.size, static_cast<int>(event.time));
 
                     if (status == MIDI_STATUS_NOTE_ON)
                         pData->postponeRtEvent(kPluginPostRtEventNoteOn, event.channel, midiData[1], midiData[2]);
@@ -1031,8 +1045,9 @@ public:
                 {
                     CARLA_SAFE_ASSERT_BREAK(midiEventPosition >= 0 && midiEventPosition < static_cast<int>(frames));
                     CARLA_SAFE_ASSERT_BREAK(midiEventSize > 0);
+                    CARLA_SAFE_ASSERT_CONTINUE(midiEventSize <= EngineMidiEvent::kMaxSize);
 
-                    if (! pData->event.portOut->writeMidiEvent(static_cast<uint32_t>(midiEventPosition), static_cast<uint8_t>(midiEventSize), midiEventData))
+                    if (! pData->event.portOut->writeMidiEvent(static_cast<uint32_t>(midiEventPosition), static_cast<uint16_t>(midiEventSize), midiEventData))
                         break;
                 }
             }
@@ -916,6 +916,11 @@ public:
             return;
         }
 
+        // --------------------------------------------------------------------------------------------------------
+        // Run commands from the host
+
+        pData->rtCommands.runRT(this);
+
         // --------------------------------------------------------------------------------------------------------
         // Event Input and Processing
 
@@ -1203,73 +1208,7 @@ public:
         // --------------------------------------------------------------------------------------------------------
         // Post-processing (dry/wet, volume and balance)
 
-        {
-            const bool doDryWet  = (pData->hints & PLUGIN_CAN_DRYWET) != 0 && carla_isNotEqual(pData->postProc.dryWet, 1.0f);
-            const bool doBalance = (pData->hints & PLUGIN_CAN_BALANCE) != 0 && ! (carla_isEqual(pData->postProc.balanceLeft, -1.0f) && carla_isEqual(pData->postProc.balanceRight, 1.0f));
-            const bool isMono    = (pData->audioIn.count == 1);
-
-            bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
-
-            for (uint32_t i=0; i < pData->audioOut.count; ++i)
-            {
-                // Dry/Wet
-                if (doDryWet)
-                {
-                    const uint32_t c = isMono ? 0 : i;
-
-                    for (uint32_t k=0; k < frames; ++k)
-                    {
-                        if (k < pData->latency.frames)
-                            bufValue = pData->latency.buffers[c][k];
-                        else if (pData->latency.frames < frames)
-                            bufValue = fAudioInBuffers[c][k-pData->latency.frames];
-                        else
-                            bufValue = fAudioInBuffers[c][k];
-
-                        fAudioOutBuffers[i][k] = (fAudioOutBuffers[i][k] * pData->postProc.dryWet) + (bufValue * (1.0f - pData->postProc.dryWet));
-                    }
-                }
-
-                // Balance
-                if (doBalance)
-                {
-                    isPair = (i % 2 == 0);
-
-                    if (isPair)
-                    {
-                        CARLA_ASSERT(i+1 < pData->audioOut.count);
-                        FloatVectorOperations::copy(oldBufLeft, fAudioOutBuffers[i], iframes);
-                    }
-
-                    float balRangeL = (pData->postProc.balanceLeft  + 1.0f)/2.0f;
-                    float balRangeR = (pData->postProc.balanceRight + 1.0f)/2.0f;
-
-                    for (uint32_t k=0; k < frames; ++k)
-                    {
-                        if (isPair)
-                        {
-                            // left
-                            fAudioOutBuffers[i][k]  = oldBufLeft[k]            * (1.0f - balRangeL);
-                            fAudioOutBuffers[i][k] += fAudioOutBuffers[i+1][k] * (1.0f - balRangeR);
-                        }
-                        else
-                        {
-                            // right
-                            fAudioOutBuffers[i][k]  = fAudioOutBuffers[i][k] * balRangeR;
-                            fAudioOutBuffers[i][k] += oldBufLeft[k]          * balRangeL;
-                        }
-                    }
-                }
-
-                // Volume (and buffer copy)
-                {
-                    for (uint32_t k=0; k < frames; ++k)
-                        audioOut[i][k+timeOffset] = fAudioOutBuffers[i][k] * pData->postProc.volume;
-                }
-            }
-
-        } // End of Post-processing
+        pData->postProcessAudio(fAudioInBuffers, fAudioOutBuffers, audioOut, frames, 0, timeOffset);
 
 #else // BUILD_BRIDGE
         for (uint32_t i=0; i < pData->audioOut.count; ++i)
@@ -1279,35 +1218,6 @@ public:
         }
 #endif
 
-        // --------------------------------------------------------------------------------------------------------
-        // Save latency values for next callback
-
-        if (const uint32_t latframes = pData->latency.frames)
-        {
-            CARLA_SAFE_ASSERT(timeOffset == 0);
-
-            if (latframes <= frames)
-            {
-                for (uint32_t i=0; i < pData->audioIn.count; ++i)
-                    FloatVectorOperations::copy(pData->latency.buffers[i], audioIn[i]+(frames-latframes), static_cast<int>(latframes));
-            }
-            else
-            {
-                const uint32_t diff = pData->latency.frames-frames;
-
-                for (uint32_t i=0, k; i<pData->audioIn.count; ++i)
-                {
-                    // push back buffer by 'frames'
-                    for (k=0; k < diff; ++k)
-                        pData->latency.buffers[i][k] = pData->latency.buffers[i][k+frames];
-
-                    // put current input at the end
-                    for (uint32_t j=0; k < latframes; ++j, ++k)
-                        pData->latency.buffers[i][k] = audioIn[i][j];
-                }
-            }
-        }
-
         // --------------------------------------------------------------------------------------------------------
 
         pData->singleMutex.unlock();
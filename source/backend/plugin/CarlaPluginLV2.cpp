@@ -22,13 +22,14 @@
 #include "CarlaPluginInternal.hpp"
 #include "CarlaEngine.hpp"
 
-#include "CarlaLv2Utils.hpp"
+#include "CarlaLv2RdfCache.hpp"
 
 #include "CarlaBase64Utils.hpp"
 #include "CarlaEngineUtils.hpp"
 #include "CarlaPipeUtils.hpp"
 #include "CarlaPluginUI.hpp"
 #include "Lv2AtomRingBuffer.hpp"
+#include "Lv2UridMap.hpp"
 
 #include "../engine/CarlaEngineOsc.hpp"
 #include "../modules/lilv/config/lilv_config.h"
@@ -119,6 +120,65 @@ const uint32_t CARLA_URI_MAP_ID_CARLA_ATOM_WORKER      = 46;
 const uint32_t CARLA_URI_MAP_ID_CARLA_TRANSIENT_WIN_ID = 47;
 const uint32_t CARLA_URI_MAP_ID_COUNT                  = 48;
 
+// Pre-mapped URIs, in URID order
+static const char* const kUridMapSeed[CARLA_URI_MAP_ID_COUNT] = {
+    nullptr,
+    LV2_ATOM__Blank,
+    LV2_ATOM__Bool,
+    LV2_ATOM__Chunk,
+    LV2_ATOM__Double,
+    LV2_ATOM__Event,
+    LV2_ATOM__Float,
+    LV2_ATOM__Int,
+    LV2_ATOM__Literal,
+    LV2_ATOM__Long,
+    LV2_ATOM__Number,
+    LV2_ATOM__Object,
+    LV2_ATOM__Path,
+    LV2_ATOM__Property,
+    LV2_ATOM__Resource,
+    LV2_ATOM__Sequence,
+    LV2_ATOM__Sound,
+    LV2_ATOM__String,
+    LV2_ATOM__Tuple,
+    LV2_ATOM__URI,
+    LV2_ATOM__URID,
+    LV2_ATOM__Vector,
+    LV2_ATOM__atomTransfer,
+    LV2_ATOM__eventTransfer,
+    LV2_BUF_SIZE__maxBlockLength,
+    LV2_BUF_SIZE__minBlockLength,
+    LV2_BUF_SIZE__nominalBlockLength,
+    LV2_BUF_SIZE__sequenceSize,
+    LV2_LOG__Error,
+    LV2_LOG__Note,
+    LV2_LOG__Trace,
+    LV2_LOG__Warning,
+    LV2_TIME__Position,
+    LV2_TIME__bar,
+    LV2_TIME__barBeat,
+    LV2_TIME__beat,
+    LV2_TIME__beatUnit,
+    LV2_TIME__beatsPerBar,
+    LV2_TIME__beatsPerMinute,
+    LV2_TIME__frame,
+    LV2_TIME__framesPerSecond,
+    LV2_TIME__speed,
+    LV2_KXSTUDIO_PROPERTIES__TimePositionTicksPerBeat,
+    LV2_MIDI__MidiEvent,
+    LV2_PARAMETERS__sampleRate,
+    LV2_UI__windowTitle,
+    URI_CARLA_ATOM_WORKER,
+    LV2_KXSTUDIO_PROPERTIES__TransientWindowId
+};
+
+// URID map shared by all plugin instances, URIDs are the same for everyone
+static Lv2UridMap& getLv2UridMap()
+{
+    static Lv2UridMap uridMap(kUridMapSeed, CARLA_URI_MAP_ID_COUNT);
+    return uridMap;
+}
+
 // LV2 Feature Ids
 const uint32_t kFeatureIdBufSizeBounded   =  0;
 const uint32_t kFeatureIdBufSizeFixed     =  1;
@@ -500,6 +560,29 @@ private:
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaPipeServerLV2)
 };
 
+// -----------------------------------------------------
+// Runs LV2 worker jobs on the engine worker threads
+
+class CarlaPluginLV2Worker : public CarlaEngineWorkerClient
+{
+public:
+    CarlaPluginLV2Worker(CarlaEngine* const engine, CarlaPluginLV2* const plugin);
+
+    ~CarlaPluginLV2Worker() noexcept override
+    {
+        stopWork();
+    }
+
+protected:
+    void work(const uint32_t size, const void* const data) override;
+    void workResponse(const uint32_t size, const void* const data) override;
+
+private:
+    CarlaPluginLV2* const kPlugin;
+
+    CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaPluginLV2Worker)
+};
+
 // -----------------------------------------------------
 
 class CarlaPluginLV2 : public CarlaPlugin,
@@ -528,7 +611,9 @@ public:
           fEventsOut(),
           fLv2Options(),
           fPipeServer(engine, this),
-          fCustomURIDs(),
+          fWorker(nullptr),
+          fUridsSentToUI(CARLA_URI_MAP_ID_COUNT),
+          fUridsFromUI(getLv2UridMap()),
           fFirstActive(true),
           fLastStateChunk(nullptr),
           fLastTimeInfo(),
@@ -539,9 +624,6 @@ public:
 
         carla_zeroPointers(fFeatures, kFeatureCountAll+1);
 
-        for (uint32_t i=0; i < CARLA_URI_MAP_ID_COUNT; ++i)
-            fCustomURIDs.append(nullptr);
-
 #if defined(__clang__)
 # pragma clang diagnostic push
 # pragma clang diagnostic ignored "-Wdeprecated-declarations"
@@ -628,6 +710,12 @@ public:
             pData->active = false;
         }
 
+        if (fWorker != nullptr)
+        {
+            delete fWorker;
+            fWorker = nullptr;
+        }
+
         if (fDescriptor != nullptr)
         {
             if (fDescriptor->cleanup != nullptr)
@@ -694,16 +782,6 @@ public:
             }
         }
 
-        for (LinkedList<const char*>::Itenerator it = fCustomURIDs.begin2(); it.valid(); it.next())
-        {
-            const char* const uri(it.getValue());
-
-            if (uri != nullptr)
-                delete[] uri;
-        }
-
-        fCustomURIDs.clear();
-
         if (fLastStateChunk != nullptr)
         {
             std::free(fLastStateChunk);
@@ -1229,6 +1307,9 @@ public:
 
         if (index >= 0 && fExt.programs != nullptr && fExt.programs->select_program != nullptr)
         {
+            if ((sendGui || sendOsc || sendCallback) && pData->runInAudioThread(kPluginRtCommandMidiProgram, index, 0.0f))
+                return CarlaPlugin::setMidiProgram(index, sendGui, sendOsc, sendCallback);
+
             const uint32_t bank(pData->midiprog.data[index].bank);
             const uint32_t program(pData->midiprog.data[index].program);
 
@@ -1277,8 +1358,10 @@ public:
                     return;
                 }
 
-                for (std::size_t i=CARLA_URI_MAP_ID_COUNT, count=fCustomURIDs.count(); i < count; ++i)
-                    fPipeServer.writeLv2UridMessage(static_cast<uint32_t>(i), fCustomURIDs.getAt(i, nullptr));
+                // new UI process, knows only the pre-mapped URIDs
+                fUridsSentToUI = CARLA_URI_MAP_ID_COUNT;
+                fUridsFromUI.clear();
+                sendNewURIDsToUI();
 
                 fPipeServer.writeUiOptionsMessage(pData->engine->getSampleRate(), true, true, fLv2Options.windowTitle, frontendWinId);
 
@@ -1481,6 +1564,10 @@ public:
 
     void uiIdle() override
     {
+        // URIDs must reach the UI before any atoms using them
+        if (fUI.type == UI::TYPE_BRIDGE && fPipeServer.isPipeRunning())
+            sendNewURIDsToUI();
+
         if (fAtomBufferOut.isDataAvailableForReading())
         {
             uint8_t dumpBuf[fAtomBufferOut.getSize()];
@@ -1495,12 +1582,7 @@ public:
 
             for (; tmpRingBuffer.get(atom, portIndex);)
             {
-                if (atom->type == CARLA_URI_MAP_ID_CARLA_ATOM_WORKER)
-                {
-                    CARLA_SAFE_ASSERT_CONTINUE(fExt.worker != nullptr && fExt.worker->work != nullptr);
-                    fExt.worker->work(fHandle, carla_lv2_worker_respond, this, atom->size, LV2_ATOM_BODY_CONST(atom));
-                }
-                else if (fUI.type == UI::TYPE_BRIDGE)
+                if (fUI.type == UI::TYPE_BRIDGE)
                 {
                     if (fPipeServer.isPipeRunning())
                         fPipeServer.writeLv2AtomMessage(portIndex, atom);
@@ -2316,10 +2398,10 @@ public:
             pData->event.portOut = (CarlaEngineEventPort*)pData->client->addPort(kEnginePortTypeEvent, portName, false, 0);
         }
 
-        if (fExt.worker != nullptr || (fUI.type != UI::TYPE_NULL && fEventsIn.count > 0 && (fEventsIn.data[0].type & CARLA_EVENT_DATA_ATOM) != 0))
+        if (fUI.type != UI::TYPE_NULL && fEventsIn.count > 0 && (fEventsIn.data[0].type & CARLA_EVENT_DATA_ATOM) != 0)
             fAtomBufferIn.createBuffer(eventBufferSize);
 
-        if (fExt.worker != nullptr || (fUI.type != UI::TYPE_NULL && fEventsOut.count > 0 && (fEventsOut.data[0].type & CARLA_EVENT_DATA_ATOM) != 0))
+        if (fUI.type != UI::TYPE_NULL && fEventsOut.count > 0 && (fEventsOut.data[0].type & CARLA_EVENT_DATA_ATOM) != 0)
             fAtomBufferOut.createBuffer(eventBufferSize);
 
         if (fEventsIn.ctrl != nullptr && fEventsIn.ctrl->port == nullptr)
@@ -2643,6 +2725,17 @@ public:
             return;
         }
 
+        // --------------------------------------------------------------------------------------------------------
+        // Run commands from the host
+
+        pData->rtCommands.runRT(this);
+
+        // --------------------------------------------------------------------------------------------------------
+        // Worker responses, from jobs finished since the last cycle
+
+        if (fWorker != nullptr)
+            fWorker->processResponses();
+
         // --------------------------------------------------------------------------------------------------------
         // Event itenerators from different APIs (input)
 
@@ -2938,12 +3031,7 @@ public:
                     {
                         j = (portIndex < fEventsIn.count) ? portIndex : fEventsIn.ctrlIndex;
 
-                        if (atom->type == CARLA_URI_MAP_ID_CARLA_ATOM_WORKER)
-                        {
-                            CARLA_SAFE_ASSERT_CONTINUE(fExt.worker != nullptr && fExt.worker->work_response != nullptr);
-                            fExt.worker->work_response(fHandle, atom->size, LV2_ATOM_BODY_CONST(atom));
-                        }
-                        else if (! lv2_atom_buffer_write(&evInAtomIters[j], 0, 0, atom->type, atom->size, LV2_ATOM_BODY_CONST(atom)))
+                        if (! lv2_atom_buffer_write(&evInAtomIters[j], 0, 0, atom->type, atom->size, LV2_ATOM_BODY_CONST(atom)))
                         {
                             carla_stdout("Event input buffer full, at least 1 message lost");
                             continue;
@@ -3322,19 +3410,25 @@ public:
                     const uint32_t j     = fEventsIn.ctrlIndex;
                     const uint32_t mtime = isSampleAccurate ? startTime : event.time;
 
-                    // put back channel in data
-                    uint8_t midiData2[midiEvent.size];
-                    midiData2[0] = uint8_t(status | (event.channel & MIDI_CHANNEL_BIT));
-                    std::memcpy(midiData2+1, midiData+1, static_cast<std::size_t>(midiEvent.size-1));
+                    // put back channel in data, long messages are system messages without one
+                    uint8_t midiData2[EngineMidiEvent::kDataSize];
+                    const uint8_t* midiDataOut(midiData);
+
+                    if (midiEvent.size <= EngineMidiEvent::kDataSize)
+                    {
+                        midiData2[0] = uint8_t(status | (event.channel & MIDI_CHANNEL_BIT));
+                        std::memcpy(midiData2+1, midiData+1, static_cast<std::size_t>(midiEvent.size-1));
+                        midiDataOut = midiData2;
+                    }
 
                     if (fEventsIn.ctrl->type & CARLA_EVENT_DATA_ATOM)
-                        lv2_atom_buffer_write(&evInAtomIters[j], mtime, 0, CARLA_URI_MAP_ID_MIDI_EVENT, midiEvent.size, midiData2);
+                        lv2_atom_buffer_write(&evInAtomIters[j], mtime, 0, CARLA_URI_MAP_ID_MIDI_EVENT, midiEvent.size, midiDataOut);
 
                     else if (fEventsIn.ctrl->type & CARLA_EVENT_DATA_EVENT)
-                        lv2_event_write(&evInEventIters[j], mtime, 0, CARLA_URI_MAP_ID_MIDI_EVENT, midiEvent.size, midiData2);
+                        lv2_event_write(&evInEventIters[j], mtime, 0, CARLA_URI_MAP_ID_MIDI_EVENT, midiEvent.size, midiDataOut);
 
                     else if (fEventsIn.ctrl->type & CARLA_EVENT_DATA_MIDI_LL)
-                        lv2midi_put_event(&evInMidiStates[j], mtime, midiEvent.size, midiData2);
+                        lv2midi_put_event(&evInMidiStates[j], mtime, midiEvent.size, midiDataOut);
 
                     if (status == MIDI_STATUS_NOTE_ON)
                         pData->postponeRtEvent(kPluginPostRtEventNoteOn, event.channel, midiData[1], midiData[2]);
@@ -3419,8 +3513,8 @@ public:
                         if (fEventsOut.ctrl->port != nullptr)
                         {
                             CARLA_SAFE_ASSERT_CONTINUE(ev->time.frames >= 0);
-                            CARLA_SAFE_ASSERT_CONTINUE(ev->body.size < 0xFF);
-                            fEventsOut.ctrl->port->writeMidiEvent(static_cast<uint32_t>(ev->time.frames), static_cast<uint8_t>(ev->body.size), data);
+                            CARLA_SAFE_ASSERT_CONTINUE(ev->body.size <= EngineMidiEvent::kMaxSize);
+                            fEventsOut.ctrl->port->writeMidiEvent(static_cast<uint32_t>(ev->time.frames), static_cast<uint16_t>(ev->body.size), data);
                         }
                     }
                     else //if (ev->body.type == CARLA_URI_MAP_ID_ATOM_BLANK)
@@ -3450,8 +3544,7 @@ public:
 
                     if (ev->type == CARLA_URI_MAP_ID_MIDI_EVENT)
                     {
-                        CARLA_SAFE_ASSERT_CONTINUE(ev->size < 0xFF);
-                        fEventsOut.ctrl->port->writeMidiEvent(ev->frames, static_cast<uint8_t>(ev->size), data);
+                        fEventsOut.ctrl->port->writeMidiEvent(ev->frames, ev->size, data);
                     }
 
                     lv2_event_increment(&iter);
@@ -3475,10 +3568,10 @@ public:
                     if (eventData == nullptr || eventSize == 0)
                         break;
 
-                    CARLA_SAFE_ASSERT_CONTINUE(eventSize < 0xFF);
+                    CARLA_SAFE_ASSERT_CONTINUE(eventSize <= EngineMidiEvent::kMaxSize);
                     CARLA_SAFE_ASSERT_CONTINUE(eventTime >= 0.0);
 
-                    fEventsOut.ctrl->port->writeMidiEvent(static_cast<uint32_t>(eventTime), static_cast<uint8_t>(eventSize), eventData);
+                    fEventsOut.ctrl->port->writeMidiEvent(static_cast<uint32_t>(eventTime), static_cast<uint16_t>(eventSize), eventData);
                     lv2midi_step(&state);
                 }
             }
@@ -3622,72 +3715,7 @@ public:
         // --------------------------------------------------------------------------------------------------------
         // Post-processing (dry/wet, volume and balance)
 
-        {
-            const bool doDryWet  = (pData->hints & PLUGIN_CAN_DRYWET) != 0 && carla_isNotEqual(pData->postProc.dryWet, 1.0f);
-            const bool doBalance = (pData->hints & PLUGIN_CAN_BALANCE) != 0 && ! (carla_isEqual(pData->postProc.balanceLeft, -1.0f) && carla_isEqual(pData->postProc.balanceRight, 1.0f));
-            const bool isMono    = (pData->audioIn.count == 1);
-
-            bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
-
-            for (uint32_t i=0; i < pData->audioOut.count; ++i)
-            {
-                // Dry/Wet
-                if (doDryWet)
-                {
-                    for (uint32_t k=0; k < frames; ++k)
-                    {
-#if 0 // TODO
-                        if (k < pData->latency)
-                            bufValue = pData->latencyBuffers[isMono ? 0 : i][k];
-                        else if (pData->latency < frames)
-                            bufValue = fAudioInBuffers[isMono ? 0 : i][k-pData->latency];
-                        else
-#endif
-                            bufValue = fAudioInBuffers[isMono ? 0 : i][k];
-
-                        fAudioOutBuffers[i][k] = (fAudioOutBuffers[i][k] * pData->postProc.dryWet) + (bufValue * (1.0f - pData->postProc.dryWet));
-                    }
-                }
-
-                // Balance
-                if (doBalance)
-                {
-                    isPair = (i % 2 == 0);
-
-                    if (isPair)
-                    {
-                        CARLA_ASSERT(i+1 < pData->audioOut.count);
-                        FloatVectorOperations::copy(oldBufLeft, fAudioOutBuffers[i], static_cast<int>(frames));
-                    }
-
-                    float balRangeL = (pData->postProc.balanceLeft  + 1.0f)/2.0f;
-                    float balRangeR = (pData->postProc.balanceRight + 1.0f)/2.0f;
-
-                    for (uint32_t k=0; k < frames; ++k)
-                    {
-                        if (isPair)
-                        {
-                            // left
-                            fAudioOutBuffers[i][k]  = oldBufLeft[k]            * (1.0f - balRangeL);
-                            fAudioOutBuffers[i][k] += fAudioOutBuffers[i+1][k] * (1.0f - balRangeR);
-                        }
-                        else
-                        {
-                            // right
-                            fAudioOutBuffers[i][k]  = fAudioOutBuffers[i][k] * balRangeR;
-                            fAudioOutBuffers[i][k] += oldBufLeft[k]          * balRangeL;
-                        }
-                    }
-                }
-
-                // Volume (and buffer copy)
-                {
-                    for (uint32_t k=0; k < frames; ++k)
-                        audioOut[i][k+timeOffset] = fAudioOutBuffers[i][k] * pData->postProc.volume;
-                }
-            }
-        } // End of Post-processing
+        pData->postProcessAudio(fAudioInBuffers, fAudioOutBuffers, audioOut, frames, 0, timeOffset);
 
 #else // BUILD_BRIDGE
         for (uint32_t i=0; i < pData->audioOut.count; ++i)
@@ -4277,31 +4305,28 @@ public:
         CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', CARLA_URI_MAP_ID_NULL);
         carla_debug("CarlaPluginLV2::getCustomURID(\"%s\")", uri);
 
-        for (size_t i=0; i < fCustomURIDs.count(); ++i)
-        {
-            const char* const thisUri(fCustomURIDs.getAt(i, nullptr));
-            if (thisUri != nullptr && std::strcmp(thisUri, uri) == 0)
-                return static_cast<LV2_URID>(i);
-        }
-
-        const LV2_URID urid(static_cast<LV2_URID>(fCustomURIDs.count()));
-
-        fCustomURIDs.append(carla_strdup(uri));
-
-        if (fUI.type == UI::TYPE_BRIDGE && fPipeServer.isPipeRunning())
-            fPipeServer.writeLv2UridMessage(urid, uri);
-
-        return urid;
+        return getLv2UridMap().map(uri);
     }
 
     const char* getCustomURIDString(const LV2_URID urid) const noexcept
     {
         static const char* const sFallback = "urn:null";
         CARLA_SAFE_ASSERT_RETURN(urid != CARLA_URI_MAP_ID_NULL, sFallback);
-        CARLA_SAFE_ASSERT_RETURN(urid < fCustomURIDs.count(), sFallback);
         carla_debug("CarlaPluginLV2::getCustomURIString(%i)", urid);
 
-        return fCustomURIDs.getAt(urid, sFallback);
+        const char* const uri(getLv2UridMap().unmap(urid));
+        CARLA_SAFE_ASSERT_RETURN(uri != nullptr, sFallback);
+
+        return uri;
+    }
+
+    // send URIDs mapped since the last call, main thread only
+    void sendNewURIDsToUI()
+    {
+        const Lv2UridMap& uridMap(getLv2UridMap());
+
+        for (const uint32_t count = uridMap.getCount(); fUridsSentToUI < count; ++fUridsSentToUI)
+            fPipeServer.writeLv2UridMessage(fUridsSentToUI, uridMap.unmap(fUridsSentToUI));
     }
 
     // -------------------------------------------------------------------
@@ -4463,32 +4488,36 @@ public:
 
     LV2_Worker_Status handleWorkerSchedule(const uint32_t size, const void* const data)
     {
-        CARLA_SAFE_ASSERT_RETURN(fExt.worker != nullptr && fExt.worker->work != nullptr, LV2_WORKER_ERR_UNKNOWN);
-        CARLA_SAFE_ASSERT_RETURN(fEventsIn.ctrl != nullptr, LV2_WORKER_ERR_UNKNOWN);
+        CARLA_SAFE_ASSERT_RETURN(fWorker != nullptr, LV2_WORKER_ERR_UNKNOWN);
         carla_debug("CarlaPluginLV2::handleWorkerSchedule(%i, %p)", size, data);
 
-        if (pData->engine->isOffline())
-        {
-            fExt.worker->work(fHandle, carla_lv2_worker_respond, this, size, data);
-            return LV2_WORKER_SUCCESS;
-        }
-
-        LV2_Atom atom;
-        atom.size = size;
-        atom.type = CARLA_URI_MAP_ID_CARLA_ATOM_WORKER;
-
-        return fAtomBufferOut.putChunk(&atom, data, fEventsOut.ctrlIndex) ? LV2_WORKER_SUCCESS : LV2_WORKER_ERR_NO_SPACE;
+        return fWorker->scheduleWork(size, data) ? LV2_WORKER_SUCCESS : LV2_WORKER_ERR_NO_SPACE;
     }
 
     LV2_Worker_Status handleWorkerRespond(const uint32_t size, const void* const data)
     {
+        CARLA_SAFE_ASSERT_RETURN(fWorker != nullptr, LV2_WORKER_ERR_UNKNOWN);
         carla_debug("CarlaPluginLV2::handleWorkerRespond(%i, %p)", size, data);
 
-        LV2_Atom atom;
-        atom.size = size;
-        atom.type = CARLA_URI_MAP_ID_CARLA_ATOM_WORKER;
+        return fWorker->writeResponse(size, data) ? LV2_WORKER_SUCCESS : LV2_WORKER_ERR_NO_SPACE;
+    }
+
+    // called from an engine worker thread
+    void handleWorkerJob(const uint32_t size, const void* const data)
+    {
+        CARLA_SAFE_ASSERT_RETURN(fExt.worker != nullptr && fExt.worker->work != nullptr,);
+        carla_debug("CarlaPluginLV2::handleWorkerJob(%i, %p)", size, data);
 
-        return fAtomBufferIn.putChunk(&atom, data, fEventsIn.ctrlIndex) ? LV2_WORKER_SUCCESS : LV2_WORKER_ERR_NO_SPACE;
+        fExt.worker->work(fHandle, carla_lv2_worker_respond, this, size, data);
+    }
+
+    // called from the audio thread
+    void handleWorkerResponse(const uint32_t size, const void* const data)
+    {
+        CARLA_SAFE_ASSERT_RETURN(fExt.worker != nullptr,);
+
+        if (fExt.worker->work_response != nullptr)
+            fExt.worker->work_response(fHandle, size, data);
     }
 
     // -------------------------------------------------------------------
@@ -4713,21 +4742,33 @@ public:
         }
 
         // ---------------------------------------------------------------
-        // Init LV2 World if needed, sets LV2_PATH for lilv
+        // Init LV2 descriptor cache if needed, only uses lilv when bundles changed
 
-        Lv2WorldClass& lv2World(Lv2WorldClass::getInstance());
+        const char* LV2_PATH = pData->engine->getOptions().pathLV2;
 
-        if (pData->engine->getOptions().pathLV2 != nullptr && pData->engine->getOptions().pathLV2[0] != '\0')
-            lv2World.initIfNeeded(pData->engine->getOptions().pathLV2);
-        else if (const char* const LV2_PATH = std::getenv("LV2_PATH"))
-            lv2World.initIfNeeded(LV2_PATH);
-        else
-            lv2World.initIfNeeded(LILV_DEFAULT_LV2_PATH);
+        if (LV2_PATH == nullptr || LV2_PATH[0] == '\0')
+            LV2_PATH = std::getenv("LV2_PATH");
+        if (LV2_PATH == nullptr)
+            LV2_PATH = LILV_DEFAULT_LV2_PATH;
+
+        Lv2RdfCache& lv2Cache(Lv2RdfCache::getInstance());
+        lv2Cache.initIfNeeded(LV2_PATH);
 
         // ---------------------------------------------------------------
-        // get plugin from lv2_rdf (lilv)
+        // get plugin from cache, or lv2_rdf (lilv) if not cached
 
-        fRdfDescriptor = lv2_rdf_new(uri, true);
+        fRdfDescriptor = lv2Cache.getDescriptor(uri);
+
+        if (fRdfDescriptor != nullptr)
+        {
+            // state and presets still need the plugin bundles in lilv
+            lv2Cache.loadBundlesIfNeeded(uri);
+        }
+        else
+        {
+            Lv2WorldClass::getInstance().initIfNeeded(LV2_PATH);
+            fRdfDescriptor = lv2_rdf_new(uri, true);
+        }
 
         if (fRdfDescriptor == nullptr)
         {
@@ -5036,6 +5077,9 @@ public:
 
         recheckExtensions();
 
+        if (fExt.worker != nullptr)
+            fWorker = new CarlaPluginLV2Worker(pData->engine, this);
+
         // ---------------------------------------------------------------
         // set default options
 
@@ -5494,27 +5538,23 @@ public:
         fAtomBufferIn.put(atom, portIndex);
     }
 
+    // the UI maps new URIs on its own, its URIDs differ from ours once other plugins mapped something meanwhile
     void handleUridMap(const LV2_URID urid, const char* const uri)
     {
         CARLA_SAFE_ASSERT_RETURN(urid != CARLA_URI_MAP_ID_NULL,);
         CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0',);
-        carla_debug("CarlaPluginLV2::handleUridMap(%i v " P_SIZE ", \"%s\")", urid, fCustomURIDs.count()-1, uri);
+        carla_debug("CarlaPluginLV2::handleUridMap(%i, \"%s\")", urid, uri);
 
-        if (urid < fCustomURIDs.count())
-        {
-            const char* const ourURI(carla_lv2_urid_unmap(this, urid));
-            CARLA_SAFE_ASSERT_RETURN(ourURI != nullptr,);
+        fUridsFromUI.add(urid, getLv2UridMap().map(uri));
+    }
 
-            if (std::strcmp(ourURI, uri) != 0)
-            {
-                carla_stderr2("PLUGIN :: wrong URI '%s' vs '%s'", ourURI,  uri);
-            }
-        }
-        else
-        {
-            CARLA_SAFE_ASSERT_RETURN(urid == fCustomURIDs.count(),);
-            fCustomURIDs.append(carla_strdup(uri));
-        }
+    // rewrites the URIDs of an atom coming from the bridged UI into ours
+    bool translateUIAtom(LV2_Atom* const atom, const uint32_t size) const noexcept
+    {
+        if (fUridsFromUI.isEmpty())
+            return true;
+
+        return fUridsFromUI.translateAtom(atom, size);
     }
 
     // -------------------------------------------------------------------
@@ -5545,8 +5585,10 @@ private:
     CarlaPluginLV2EventData fEventsOut;
     CarlaPluginLV2Options   fLv2Options;
     CarlaPipeServerLV2      fPipeServer;
+    CarlaPluginLV2Worker*   fWorker;
 
-    LinkedList<const char*> fCustomURIDs;
+    uint32_t fUridsSentToUI;
+    Lv2UridTranslation fUridsFromUI;
 
     bool fFirstActive; // first process() call after activate()
     void* fLastStateChunk;
@@ -5805,113 +5847,6 @@ private:
         CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', CARLA_URI_MAP_ID_NULL);
         carla_debug("carla_lv2_urid_map(%p, \"%s\")", handle, uri);
 
-        // Atom types
-        if (std::strcmp(uri, LV2_ATOM__Blank) == 0)
-            return CARLA_URI_MAP_ID_ATOM_BLANK;
-        if (std::strcmp(uri, LV2_ATOM__Bool) == 0)
-            return CARLA_URI_MAP_ID_ATOM_BOOL;
-        if (std::strcmp(uri, LV2_ATOM__Chunk) == 0)
-            return CARLA_URI_MAP_ID_ATOM_CHUNK;
-        if (std::strcmp(uri, LV2_ATOM__Double) == 0)
-            return CARLA_URI_MAP_ID_ATOM_DOUBLE;
-        if (std::strcmp(uri, LV2_ATOM__Event) == 0)
-            return CARLA_URI_MAP_ID_ATOM_EVENT;
-        if (std::strcmp(uri, LV2_ATOM__Float) == 0)
-            return CARLA_URI_MAP_ID_ATOM_FLOAT;
-        if (std::strcmp(uri, LV2_ATOM__Int) == 0)
-            return CARLA_URI_MAP_ID_ATOM_INT;
-        if (std::strcmp(uri, LV2_ATOM__Literal) == 0)
-            return CARLA_URI_MAP_ID_ATOM_LITERAL;
-        if (std::strcmp(uri, LV2_ATOM__Long) == 0)
-            return CARLA_URI_MAP_ID_ATOM_LONG;
-        if (std::strcmp(uri, LV2_ATOM__Number) == 0)
-            return CARLA_URI_MAP_ID_ATOM_NUMBER;
-        if (std::strcmp(uri, LV2_ATOM__Object) == 0)
-            return CARLA_URI_MAP_ID_ATOM_OBJECT;
-        if (std::strcmp(uri, LV2_ATOM__Path) == 0)
-            return CARLA_URI_MAP_ID_ATOM_PATH;
-        if (std::strcmp(uri, LV2_ATOM__Property) == 0)
-            return CARLA_URI_MAP_ID_ATOM_PROPERTY;
-        if (std::strcmp(uri, LV2_ATOM__Resource) == 0)
-            return CARLA_URI_MAP_ID_ATOM_RESOURCE;
-        if (std::strcmp(uri, LV2_ATOM__Sequence) == 0)
-            return CARLA_URI_MAP_ID_ATOM_SEQUENCE;
-        if (std::strcmp(uri, LV2_ATOM__Sound) == 0)
-            return CARLA_URI_MAP_ID_ATOM_SOUND;
-        if (std::strcmp(uri, LV2_ATOM__String) == 0)
-            return CARLA_URI_MAP_ID_ATOM_STRING;
-        if (std::strcmp(uri, LV2_ATOM__Tuple) == 0)
-            return CARLA_URI_MAP_ID_ATOM_TUPLE;
-        if (std::strcmp(uri, LV2_ATOM__URI) == 0)
-            return CARLA_URI_MAP_ID_ATOM_URI;
-        if (std::strcmp(uri, LV2_ATOM__URID) == 0)
-            return CARLA_URI_MAP_ID_ATOM_URID;
-        if (std::strcmp(uri, LV2_ATOM__Vector) == 0)
-            return CARLA_URI_MAP_ID_ATOM_VECTOR;
-        if (std::strcmp(uri, LV2_ATOM__atomTransfer) == 0)
-            return CARLA_URI_MAP_ID_ATOM_TRANSFER_ATOM;
-        if (std::strcmp(uri, LV2_ATOM__eventTransfer) == 0)
-            return CARLA_URI_MAP_ID_ATOM_TRANSFER_EVENT;
-
-        // BufSize types
-        if (std::strcmp(uri, LV2_BUF_SIZE__maxBlockLength) == 0)
-            return CARLA_URI_MAP_ID_BUF_MAX_LENGTH;
-        if (std::strcmp(uri, LV2_BUF_SIZE__minBlockLength) == 0)
-            return CARLA_URI_MAP_ID_BUF_MIN_LENGTH;
-        if (std::strcmp(uri, LV2_BUF_SIZE__nominalBlockLength) == 0)
-            return CARLA_URI_MAP_ID_BUF_NOMINAL_LENGTH;
-        if (std::strcmp(uri, LV2_BUF_SIZE__sequenceSize) == 0)
-            return CARLA_URI_MAP_ID_BUF_SEQUENCE_SIZE;
-
-        // Log types
-        if (std::strcmp(uri, LV2_LOG__Error) == 0)
-            return CARLA_URI_MAP_ID_LOG_ERROR;
-        if (std::strcmp(uri, LV2_LOG__Note) == 0)
-            return CARLA_URI_MAP_ID_LOG_NOTE;
-        if (std::strcmp(uri, LV2_LOG__Trace) == 0)
-            return CARLA_URI_MAP_ID_LOG_TRACE;
-        if (std::strcmp(uri, LV2_LOG__Warning) == 0)
-            return CARLA_URI_MAP_ID_LOG_WARNING;
-
-        // Time types
-        if (std::strcmp(uri, LV2_TIME__Position) == 0)
-            return CARLA_URI_MAP_ID_TIME_POSITION;
-        if (std::strcmp(uri, LV2_TIME__bar) == 0)
-            return CARLA_URI_MAP_ID_TIME_BAR;
-        if (std::strcmp(uri, LV2_TIME__barBeat) == 0)
-            return CARLA_URI_MAP_ID_TIME_BAR_BEAT;
-        if (std::strcmp(uri, LV2_TIME__beat) == 0)
-            return CARLA_URI_MAP_ID_TIME_BEAT;
-        if (std::strcmp(uri, LV2_TIME__beatUnit) == 0)
-            return CARLA_URI_MAP_ID_TIME_BEAT_UNIT;
-        if (std::strcmp(uri, LV2_TIME__beatsPerBar) == 0)
-            return CARLA_URI_MAP_ID_TIME_BEATS_PER_BAR;
-        if (std::strcmp(uri, LV2_TIME__beatsPerMinute) == 0)
-            return CARLA_URI_MAP_ID_TIME_BEATS_PER_MINUTE;
-        if (std::strcmp(uri, LV2_TIME__frame) == 0)
-            return CARLA_URI_MAP_ID_TIME_FRAME;
-        if (std::strcmp(uri, LV2_TIME__framesPerSecond) == 0)
-            return CARLA_URI_MAP_ID_TIME_FRAMES_PER_SECOND;
-        if (std::strcmp(uri, LV2_TIME__speed) == 0)
-            return CARLA_URI_MAP_ID_TIME_SPEED;
-        if (std::strcmp(uri, LV2_KXSTUDIO_PROPERTIES__TimePositionTicksPerBeat) == 0)
-            return CARLA_URI_MAP_ID_TIME_TICKS_PER_BEAT;
-
-        // Others
-        if (std::strcmp(uri, LV2_MIDI__MidiEvent) == 0)
-            return CARLA_URI_MAP_ID_MIDI_EVENT;
-        if (std::strcmp(uri, LV2_PARAMETERS__sampleRate) == 0)
-            return CARLA_URI_MAP_ID_PARAM_SAMPLE_RATE;
-        if (std::strcmp(uri, LV2_UI__windowTitle) == 0)
-            return CARLA_URI_MAP_ID_UI_WINDOW_TITLE;
-
-        // Custom
-        if (std::strcmp(uri, LV2_KXSTUDIO_PROPERTIES__TransientWindowId) == 0)
-            return CARLA_URI_MAP_ID_CARLA_TRANSIENT_WIN_ID;
-        if (std::strcmp(uri, URI_CARLA_ATOM_WORKER) == 0)
-            return CARLA_URI_MAP_ID_CARLA_ATOM_WORKER;
-
-        // Custom types
         return ((CarlaPluginLV2*)handle)->getCustomURID(uri);
     }
 
@@ -5921,113 +5856,6 @@ private:
         CARLA_SAFE_ASSERT_RETURN(urid != CARLA_URI_MAP_ID_NULL, nullptr);
         carla_debug("carla_lv2_urid_unmap(%p, %i)", handle, urid);
 
-        // Atom types
-        if (urid == CARLA_URI_MAP_ID_ATOM_BLANK)
-            return LV2_ATOM__Blank;
-        if (urid == CARLA_URI_MAP_ID_ATOM_BOOL)
-            return LV2_ATOM__Bool;
-        if (urid == CARLA_URI_MAP_ID_ATOM_CHUNK)
-            return LV2_ATOM__Chunk;
-        if (urid == CARLA_URI_MAP_ID_ATOM_DOUBLE)
-            return LV2_ATOM__Double;
-        if (urid == CARLA_URI_MAP_ID_ATOM_EVENT)
-            return LV2_ATOM__Event;
-        if (urid == CARLA_URI_MAP_ID_ATOM_FLOAT)
-            return LV2_ATOM__Float;
-        if (urid == CARLA_URI_MAP_ID_ATOM_INT)
-            return LV2_ATOM__Int;
-        if (urid == CARLA_URI_MAP_ID_ATOM_LITERAL)
-            return LV2_ATOM__Literal;
-        if (urid == CARLA_URI_MAP_ID_ATOM_LONG)
-            return LV2_ATOM__Long;
-        if (urid == CARLA_URI_MAP_ID_ATOM_NUMBER)
-            return LV2_ATOM__Number;
-        if (urid == CARLA_URI_MAP_ID_ATOM_OBJECT)
-            return LV2_ATOM__Object;
-        if (urid == CARLA_URI_MAP_ID_ATOM_PATH)
-            return LV2_ATOM__Path;
-        if (urid == CARLA_URI_MAP_ID_ATOM_PROPERTY)
-            return LV2_ATOM__Property;
-        if (urid == CARLA_URI_MAP_ID_ATOM_RESOURCE)
-            return LV2_ATOM__Resource;
-        if (urid == CARLA_URI_MAP_ID_ATOM_SEQUENCE)
-            return LV2_ATOM__Sequence;
-        if (urid == CARLA_URI_MAP_ID_ATOM_SOUND)
-            return LV2_ATOM__Sound;
-        if (urid == CARLA_URI_MAP_ID_ATOM_STRING)
-            return LV2_ATOM__String;
-        if (urid == CARLA_URI_MAP_ID_ATOM_TUPLE)
-            return LV2_ATOM__Tuple;
-        if (urid == CARLA_URI_MAP_ID_ATOM_URI)
-            return LV2_ATOM__URI;
-        if (urid == CARLA_URI_MAP_ID_ATOM_URID)
-            return LV2_ATOM__URID;
-        if (urid == CARLA_URI_MAP_ID_ATOM_VECTOR)
-            return LV2_ATOM__Vector;
-        if (urid == CARLA_URI_MAP_ID_ATOM_TRANSFER_ATOM)
-            return LV2_ATOM__atomTransfer;
-        if (urid == CARLA_URI_MAP_ID_ATOM_TRANSFER_EVENT)
-            return LV2_ATOM__eventTransfer;
-
-        // BufSize types
-        if (urid == CARLA_URI_MAP_ID_BUF_MAX_LENGTH)
-            return LV2_BUF_SIZE__maxBlockLength;
-        if (urid == CARLA_URI_MAP_ID_BUF_MIN_LENGTH)
-            return LV2_BUF_SIZE__minBlockLength;
-        if (urid == CARLA_URI_MAP_ID_BUF_NOMINAL_LENGTH)
-            return LV2_BUF_SIZE__nominalBlockLength;
-        if (urid == CARLA_URI_MAP_ID_BUF_SEQUENCE_SIZE)
-            return LV2_BUF_SIZE__sequenceSize;
-
-        // Log types
-        if (urid == CARLA_URI_MAP_ID_LOG_ERROR)
-            return LV2_LOG__Error;
-        if (urid == CARLA_URI_MAP_ID_LOG_NOTE)
-            return LV2_LOG__Note;
-        if (urid == CARLA_URI_MAP_ID_LOG_TRACE)
-            return LV2_LOG__Trace;
-        if (urid == CARLA_URI_MAP_ID_LOG_WARNING)
-            return LV2_LOG__Warning;
-
-        // Time types
-        if (urid == CARLA_URI_MAP_ID_TIME_POSITION)
-            return LV2_TIME__Position;
-        if (urid == CARLA_URI_MAP_ID_TIME_BAR)
-            return LV2_TIME__bar;
-        if (urid == CARLA_URI_MAP_ID_TIME_BAR_BEAT)
-            return LV2_TIME__barBeat;
-        if (urid == CARLA_URI_MAP_ID_TIME_BEAT)
-            return LV2_TIME__beat;
-        if (urid == CARLA_URI_MAP_ID_TIME_BEAT_UNIT)
-            return LV2_TIME__beatUnit;
-        if (urid == CARLA_URI_MAP_ID_TIME_BEATS_PER_BAR)
-            return LV2_TIME__beatsPerBar;
-        if (urid == CARLA_URI_MAP_ID_TIME_BEATS_PER_MINUTE)
-            return LV2_TIME__beatsPerMinute;
-        if (urid == CARLA_URI_MAP_ID_TIME_FRAME)
-            return LV2_TIME__frame;
-        if (urid == CARLA_URI_MAP_ID_TIME_FRAMES_PER_SECOND)
-            return LV2_TIME__framesPerSecond;
-        if (urid == CARLA_URI_MAP_ID_TIME_SPEED)
-            return LV2_TIME__speed;
-        if (urid == CARLA_URI_MAP_ID_TIME_TICKS_PER_BEAT)
-            return LV2_KXSTUDIO_PROPERTIES__TimePositionTicksPerBeat;
-
-        // Others
-        if (urid == CARLA_URI_MAP_ID_MIDI_EVENT)
-            return LV2_MIDI__MidiEvent;
-        if (urid == CARLA_URI_MAP_ID_PARAM_SAMPLE_RATE)
-            return LV2_PARAMETERS__sampleRate;
-        if (urid == CARLA_URI_MAP_ID_UI_WINDOW_TITLE)
-            return LV2_UI__windowTitle;
-
-        // Custom
-        if (urid == CARLA_URI_MAP_ID_CARLA_ATOM_WORKER)
-            return URI_CARLA_ATOM_WORKER;
-        if (urid == CARLA_URI_MAP_ID_CARLA_TRANSIENT_WIN_ID)
-            return LV2_KXSTUDIO_PROPERTIES__TransientWindowId;
-
-        // Custom types
         return ((CarlaPluginLV2*)handle)->getCustomURIDString(urid);
     }
 
@@ -6108,10 +5936,28 @@ private:
     // -------------------------------------------------------------------
 
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaPluginLV2)
+
+    friend class CarlaPluginLV2Worker;
 };
 
 // -------------------------------------------------------------------------------------------------------------------
 
+CarlaPluginLV2Worker::CarlaPluginLV2Worker(CarlaEngine* const engine, CarlaPluginLV2* const plugin)
+    : CarlaEngineWorkerClient(engine, plugin),
+      kPlugin(plugin) {}
+
+void CarlaPluginLV2Worker::work(const uint32_t size, const void* const data)
+{
+    kPlugin->handleWorkerJob(size, data);
+}
+
+void CarlaPluginLV2Worker::workResponse(const uint32_t size, const void* const data)
+{
+    kPlugin->handleWorkerResponse(size, data);
+}
+
+// -------------------------------------------------------------------------------------------------------------------
+
 bool CarlaPipeServerLV2::msgReceived(const char* const msg) noexcept
 {
     if (std::strcmp(msg, "exiting") == 0)
@@ -6149,8 +5995,9 @@ bool CarlaPipeServerLV2::msgReceived(const char* const msg) noexcept
         delete[] base64atom;
         CARLA_SAFE_ASSERT_RETURN(chunk.size() >= sizeof(LV2_Atom), true);
 
-        const LV2_Atom* const atom((const LV2_Atom*)chunk.data());
+        LV2_Atom* const atom((LV2_Atom*)chunk.data());
         CARLA_SAFE_ASSERT_RETURN(lv2_atom_total_size(atom) == chunk.size(), true);
+        CARLA_SAFE_ASSERT_RETURN(kPlugin->translateUIAtom(atom, static_cast<uint32_t>(chunk.size())), true);
 
         try {
             kPlugin->handleUIWrite(index, lv2_atom_total_size(atom), CARLA_URI_MAP_ID_ATOM_TRANSFER_EVENT, atom);
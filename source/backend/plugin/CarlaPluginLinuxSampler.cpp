@@ -786,6 +786,11 @@ public:
             return;
         }
 
+        // --------------------------------------------------------------------------------------------------------
+        // Run commands from the host
+
+        pData->rtCommands.runRT(this);
+
         // --------------------------------------------------------------------------------------------------------
         // Check if needs reset
 
@@ -1004,7 +1009,11 @@ public:
                 case kEngineEventTypeMidi: {
                     const EngineMidiEvent& midiEvent(event.midi);
 
-                    const uint8_t* const midiData(midiEvent.size > EngineMidiEvent::kDataSize ? midiEvent.dataExt : midiEvent.data);
+                    // DispatchRaw() only takes channel messages, longer ones are system messages
+                    if (midiEvent.size > EngineMidiEvent::kDataSize)
+                        continue;
+
+                    const uint8_t* const midiData(midiEvent.data);
 
                     uint8_t status = uint8_t(MIDI_GET_STATUS_FROM_DATA(midiData));
 
@@ -1022,7 +1031,7 @@ public:
                         status = MIDI_STATUS_NOTE_OFF;
 
                     // put back channel in data
-                    uint8_t midiData2[midiEvent.size];
+                    uint8_t midiData2[EngineMidiEvent::kDataSize];
                     midiData2[0] = uint8_t(status | (event.channel & MIDI_CHANNEL_BIT));
                     std::memcpy(midiData2+1, midiData+1, static_cast<std::size_t>(midiEvent.size-1));
 
@@ -1099,49 +1108,7 @@ public:
         // --------------------------------------------------------------------------------------------------------
         // Post-processing (dry/wet, volume and balance)
 
-        {
-            const bool doVolume  = (pData->hints & PLUGIN_CAN_VOLUME) != 0 && carla_isNotEqual(pData->postProc.volume, 1.0f);
-            const bool doBalance = (pData->hints & PLUGIN_CAN_BALANCE) != 0 && ! (carla_isEqual(pData->postProc.balanceLeft, -1.0f) && carla_isEqual(pData->postProc.balanceRight, 1.0f));
-
-            float oldBufLeft[doBalance ? frames : 1];
-
-            for (uint32_t i=0; i < pData->audioOut.count; ++i)
-            {
-                // Balance
-                if (doBalance)
-                {
-                    if (i % 2 == 0)
-                        FloatVectorOperations::copy(oldBufLeft, outBuffer[i], static_cast<int>(frames));
-
-                    float balRangeL = (pData->postProc.balanceLeft  + 1.0f)/2.0f;
-                    float balRangeR = (pData->postProc.balanceRight + 1.0f)/2.0f;
-
-                    for (uint32_t k=0; k < frames; ++k)
-                    {
-                        if (i % 2 == 0)
-                        {
-                            // left
-                            outBuffer[i][k]  = oldBufLeft[k]     * (1.0f - balRangeL);
-                            outBuffer[i][k] += outBuffer[i+1][k] * (1.0f - balRangeR);
-                        }
-                        else
-                        {
-                            // right
-                            outBuffer[i][k]  = outBuffer[i][k] * balRangeR;
-                            outBuffer[i][k] += oldBufLeft[k]   * balRangeL;
-                        }
-                    }
-                }
-
-                // Volume
-                if (doVolume)
-                {
-                    for (uint32_t k=0; k < frames; ++k)
-                        outBuffer[i][k+timeOffset] *= pData->postProc.volume;
-                }
-            }
-
-        } // End of Post-processing
+        pData->postProcessAudio(nullptr, outBuffer, outBuffer, frames, timeOffset, timeOffset);
 #endif
 
         // --------------------------------------------------------------------------------------------------------
@@ -206,7 +206,7 @@ public:
 
     // ---------------------------------------------------------------------
 
-    void exec(const bool useBridge, int argc, char* argv[])
+    void exec(const bool useBridge, const bool isGroup, int argc, char* argv[])
     {
         fUsingBridge = useBridge;
 
@@ -239,7 +239,10 @@ public:
 #endif
 
         carla_set_engine_about_to_close();
-        carla_remove_plugin(0);
+
+        // group members are removed by the engine itself
+        if (! isGroup)
+            carla_remove_plugin(0);
 
         // may be unused
         return; (void)argc; (void)argv;
@@ -318,6 +321,9 @@ int main(int argc, char* argv[])
     const char*       label    = argv[3];
     const int64_t     uniqueId = (argc == 5) ? static_cast<int64_t>(std::atoll(argv[4])) : 0;
 
+    // a group bridge starts empty, plugins are added later by the host
+    const bool isGroup = (std::strcmp(stype, "group") == 0);
+
     if (filename[0] == '\0' || std::strcmp(filename, "(none)") == 0)
         filename = nullptr;
 
@@ -343,7 +349,7 @@ int main(int argc, char* argv[])
 
     CarlaBackend::PluginType itype(CarlaBackend::getPluginTypeFromString(stype));
 
-    if (itype == CarlaBackend::PLUGIN_NONE)
+    if (itype == CarlaBackend::PLUGIN_NONE && ! isGroup)
     {
         carla_stderr("Invalid plugin type '%s'", stype);
         return 1;
@@ -364,6 +370,12 @@ int main(int argc, char* argv[])
 
     const bool useBridge = (shmIds != nullptr);
 
+    if (isGroup && ! useBridge)
+    {
+        carla_stderr("Plugin bridge groups can only be started by a host");
+        return 1;
+    }
+
     // ---------------------------------------------------------------------
     // Setup bridge ids
 
@@ -402,6 +414,10 @@ int main(int argc, char* argv[])
     {
         clientName = name;
     }
+    else if (isGroup)
+    {
+        clientName = "carla-bridge-group";
+    }
     else if (itype == CarlaBackend::PLUGIN_LV2)
     {
         // LV2 requires URI
@@ -504,7 +520,12 @@ int main(int argc, char* argv[])
 
     int ret;
 
-    if (carla_add_plugin(btype, itype, filename, name, label, uniqueId, extraStuff, 0x0))
+    if (isGroup)
+    {
+        ret = 0;
+        bridge.exec(useBridge, isGroup, argc, argv);
+    }
+    else if (carla_add_plugin(btype, itype, filename, name, label, uniqueId, extraStuff, 0x0))
     {
         ret = 0;
 
@@ -524,7 +545,7 @@ int main(int argc, char* argv[])
             }
         }
 
-        bridge.exec(useBridge, argc, argv);
+        bridge.exec(useBridge, isGroup, argc, argv);
     }
     else
     {
@@ -19,7 +19,7 @@
 #include "CarlaLibUtils.hpp"
 #include "CarlaLv2Utils.hpp"
 #include "CarlaMIDI.h"
-#include "LinkedList.hpp"
+#include "Lv2UridMap.hpp"
 
 #include "juce_core.h"
 
@@ -88,6 +88,58 @@ const uint32_t CARLA_URI_MAP_ID_CARLA_ATOM_WORKER      = 46;
 const uint32_t CARLA_URI_MAP_ID_CARLA_TRANSIENT_WIN_ID = 47;
 const uint32_t CARLA_URI_MAP_ID_COUNT                  = 48;
 
+// Pre-mapped URIs, in URID order
+static const char* const kUridMapSeed[CARLA_URI_MAP_ID_COUNT] = {
+    nullptr,
+    LV2_ATOM__Blank,
+    LV2_ATOM__Bool,
+    LV2_ATOM__Chunk,
+    LV2_ATOM__Double,
+    LV2_ATOM__Event,
+    LV2_ATOM__Float,
+    LV2_ATOM__Int,
+    LV2_ATOM__Literal,
+    LV2_ATOM__Long,
+    LV2_ATOM__Number,
+    LV2_ATOM__Object,
+    LV2_ATOM__Path,
+    LV2_ATOM__Property,
+    LV2_ATOM__Resource,
+    LV2_ATOM__Sequence,
+    LV2_ATOM__Sound,
+    LV2_ATOM__String,
+    LV2_ATOM__Tuple,
+    LV2_ATOM__URI,
+    LV2_ATOM__URID,
+    LV2_ATOM__Vector,
+    LV2_ATOM__atomTransfer,
+    LV2_ATOM__eventTransfer,
+    LV2_BUF_SIZE__maxBlockLength,
+    LV2_BUF_SIZE__minBlockLength,
+    LV2_BUF_SIZE__nominalBlockLength,
+    LV2_BUF_SIZE__sequenceSize,
+    LV2_LOG__Error,
+    LV2_LOG__Note,
+    LV2_LOG__Trace,
+    LV2_LOG__Warning,
+    LV2_TIME__Position,
+    LV2_TIME__bar,
+    LV2_TIME__barBeat,
+    LV2_TIME__beat,
+    LV2_TIME__beatUnit,
+    LV2_TIME__beatsPerBar,
+    LV2_TIME__beatsPerMinute,
+    LV2_TIME__frame,
+    LV2_TIME__framesPerSecond,
+    LV2_TIME__speed,
+    LV2_KXSTUDIO_PROPERTIES__TimePositionTicksPerBeat,
+    LV2_MIDI__MidiEvent,
+    LV2_PARAMETERS__sampleRate,
+    LV2_UI__windowTitle,
+    URI_CARLA_ATOM_WORKER,
+    LV2_KXSTUDIO_PROPERTIES__TransientWindowId
+};
+
 // LV2 Feature Ids
 const uint32_t kFeatureIdLogs             =  0;
 const uint32_t kFeatureIdOptions          =  1;
@@ -223,14 +275,12 @@ public:
           fRdfUiDescriptor(nullptr),
           fLv2Options(),
           fUiOptions(),
-          fCustomURIDs(),
+          fUridMap(kUridMapSeed, CARLA_URI_MAP_ID_COUNT),
+          fUridsFromHost(fUridMap),
           fExt()
     {
         carla_zeroPointers(fFeatures, kFeatureCount+1);
 
-        for (uint32_t i=0; i < CARLA_URI_MAP_ID_COUNT; ++i)
-            fCustomURIDs.append(nullptr);
-
         // ---------------------------------------------------------------
         // initialize options
 
@@ -372,16 +422,6 @@ public:
                 fFeatures[i] = nullptr;
             }
         }
-
-        for (LinkedList<const char*>::Itenerator it = fCustomURIDs.begin2(); it.valid(); it.next())
-        {
-            const char* const uri(it.getValue(nullptr));
-
-            if (uri != nullptr)
-                delete[] uri;
-        }
-
-        fCustomURIDs.clear();
     }
 
     // ---------------------------------------------------------------------
@@ -613,15 +653,33 @@ public:
         if (fDescriptor->port_event == nullptr)
             return;
 
-        fDescriptor->port_event(fHandle, portIndex, lv2_atom_total_size(atom), CARLA_URI_MAP_ID_ATOM_TRANSFER_EVENT, atom);
+        const uint32_t atomTotalSize(lv2_atom_total_size(atom));
+
+        if (fUridsFromHost.isEmpty())
+        {
+            fDescriptor->port_event(fHandle, portIndex, atomTotalSize, CARLA_URI_MAP_ID_ATOM_TRANSFER_EVENT, atom);
+            return;
+        }
+
+        // the host uses its own URIDs, rewrite them into ours
+        std::vector<uint8_t> copy((const uint8_t*)atom, (const uint8_t*)atom + atomTotalSize);
+        CARLA_SAFE_ASSERT_RETURN(fUridsFromHost.translateAtom((LV2_Atom*)copy.data(), atomTotalSize),);
+
+        fDescriptor->port_event(fHandle, portIndex, atomTotalSize, CARLA_URI_MAP_ID_ATOM_TRANSFER_EVENT, copy.data());
     }
 
     void dspURIDReceived(const LV2_URID urid, const char* const uri)
     {
-        CARLA_SAFE_ASSERT_RETURN(urid == fCustomURIDs.count(),);
         CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0',);
 
-        fCustomURIDs.append(carla_strdup(uri));
+        // URIs mapped by other plugins of the host can get a different URID here
+        const LV2_URID ourURID(fUridMap.map(uri));
+
+        fUridsFromHost.add(urid, ourURID);
+
+        // the host needs to know ours too, for the atoms we send
+        if (ourURID != urid && isPipeRunning())
+            writeLv2UridMessage(ourURID, uri);
     }
 
     void uiOptionsChanged(const double sampleRate, const bool useTheme, const bool useThemeColors, const char* const windowTitle, uintptr_t transientWindowId) override
@@ -649,26 +707,11 @@ public:
         CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', CARLA_URI_MAP_ID_NULL);
         carla_debug("CarlaLv2Client::getCustomURID(\"%s\")", uri);
 
-        LV2_URID urid = CARLA_URI_MAP_ID_NULL;
-
-        for (uint32_t i=0, count=static_cast<uint32_t>(fCustomURIDs.count()); i<count; ++i)
-        {
-            const char* const thisUri(fCustomURIDs.getAt(i, nullptr));
-
-            if (thisUri != nullptr && std::strcmp(thisUri, uri) == 0)
-            {
-                urid = i;
-                break;
-            }
-        }
-
-        if (urid == CARLA_URI_MAP_ID_NULL)
-        {
-            urid = static_cast<LV2_URID>(fCustomURIDs.count());
-            fCustomURIDs.append(carla_strdup(uri));
-        }
+        const uint32_t oldCount(fUridMap.getCount());
+        const LV2_URID urid(fUridMap.map(uri));
 
-        if (isPipeRunning())
+        // only new URIDs need to be told to the host
+        if (urid >= oldCount && isPipeRunning())
             writeLv2UridMessage(urid, uri);
 
         return urid;
@@ -678,10 +721,12 @@ public:
     {
         static const char* const sFallback = "urn:null";
         CARLA_SAFE_ASSERT_RETURN(urid != CARLA_URI_MAP_ID_NULL, sFallback);
-        CARLA_SAFE_ASSERT_RETURN(urid < fCustomURIDs.count(), sFallback);
         carla_debug("CarlaLv2Client::getCustomURIDString(%i)", urid);
 
-        return fCustomURIDs.getAt(urid, sFallback);
+        const char* const uri(fUridMap.unmap(urid));
+        CARLA_SAFE_ASSERT_RETURN(uri != nullptr, sFallback);
+
+        return uri;
     }
 
     // ---------------------------------------------------------------------
@@ -761,7 +806,8 @@ private:
     Lv2PluginOptions          fLv2Options;
 
     Options fUiOptions;
-    LinkedList<const char*> fCustomURIDs;
+    Lv2UridMap fUridMap;
+    Lv2UridTranslation fUridsFromHost;
 
     struct Extensions {
         const LV2_Options_Interface* options;
@@ -921,113 +967,6 @@ private:
         CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', CARLA_URI_MAP_ID_NULL);
         carla_debug("carla_lv2_urid_map(%p, \"%s\")", handle, uri);
 
-        // Atom types
-        if (std::strcmp(uri, LV2_ATOM__Blank) == 0)
-            return CARLA_URI_MAP_ID_ATOM_BLANK;
-        if (std::strcmp(uri, LV2_ATOM__Bool) == 0)
-            return CARLA_URI_MAP_ID_ATOM_BOOL;
-        if (std::strcmp(uri, LV2_ATOM__Chunk) == 0)
-            return CARLA_URI_MAP_ID_ATOM_CHUNK;
-        if (std::strcmp(uri, LV2_ATOM__Double) == 0)
-            return CARLA_URI_MAP_ID_ATOM_DOUBLE;
-        if (std::strcmp(uri, LV2_ATOM__Event) == 0)
-            return CARLA_URI_MAP_ID_ATOM_EVENT;
-        if (std::strcmp(uri, LV2_ATOM__Float) == 0)
-            return CARLA_URI_MAP_ID_ATOM_FLOAT;
-        if (std::strcmp(uri, LV2_ATOM__Int) == 0)
-            return CARLA_URI_MAP_ID_ATOM_INT;
-        if (std::strcmp(uri, LV2_ATOM__Literal) == 0)
-            return CARLA_URI_MAP_ID_ATOM_LITERAL;
-        if (std::strcmp(uri, LV2_ATOM__Long) == 0)
-            return CARLA_URI_MAP_ID_ATOM_LONG;
-        if (std::strcmp(uri, LV2_ATOM__Number) == 0)
-            return CARLA_URI_MAP_ID_ATOM_NUMBER;
-        if (std::strcmp(uri, LV2_ATOM__Object) == 0)
-            return CARLA_URI_MAP_ID_ATOM_OBJECT;
-        if (std::strcmp(uri, LV2_ATOM__Path) == 0)
-            return CARLA_URI_MAP_ID_ATOM_PATH;
-        if (std::strcmp(uri, LV2_ATOM__Property) == 0)
-            return CARLA_URI_MAP_ID_ATOM_PROPERTY;
-        if (std::strcmp(uri, LV2_ATOM__Resource) == 0)
-            return CARLA_URI_MAP_ID_ATOM_RESOURCE;
-        if (std::strcmp(uri, LV2_ATOM__Sequence) == 0)
-            return CARLA_URI_MAP_ID_ATOM_SEQUENCE;
-        if (std::strcmp(uri, LV2_ATOM__Sound) == 0)
-            return CARLA_URI_MAP_ID_ATOM_SOUND;
-        if (std::strcmp(uri, LV2_ATOM__String) == 0)
-            return CARLA_URI_MAP_ID_ATOM_STRING;
-        if (std::strcmp(uri, LV2_ATOM__Tuple) == 0)
-            return CARLA_URI_MAP_ID_ATOM_TUPLE;
-        if (std::strcmp(uri, LV2_ATOM__URI) == 0)
-            return CARLA_URI_MAP_ID_ATOM_URI;
-        if (std::strcmp(uri, LV2_ATOM__URID) == 0)
-            return CARLA_URI_MAP_ID_ATOM_URID;
-        if (std::strcmp(uri, LV2_ATOM__Vector) == 0)
-            return CARLA_URI_MAP_ID_ATOM_VECTOR;
-        if (std::strcmp(uri, LV2_ATOM__atomTransfer) == 0)
-            return CARLA_URI_MAP_ID_ATOM_TRANSFER_ATOM;
-        if (std::strcmp(uri, LV2_ATOM__eventTransfer) == 0)
-            return CARLA_URI_MAP_ID_ATOM_TRANSFER_EVENT;
-
-        // BufSize types
-        if (std::strcmp(uri, LV2_BUF_SIZE__maxBlockLength) == 0)
-            return CARLA_URI_MAP_ID_BUF_MAX_LENGTH;
-        if (std::strcmp(uri, LV2_BUF_SIZE__minBlockLength) == 0)
-            return CARLA_URI_MAP_ID_BUF_MIN_LENGTH;
-        if (std::strcmp(uri, LV2_BUF_SIZE__nominalBlockLength) == 0)
-            return CARLA_URI_MAP_ID_BUF_NOMINAL_LENGTH;
-        if (std::strcmp(uri, LV2_BUF_SIZE__sequenceSize) == 0)
-            return CARLA_URI_MAP_ID_BUF_SEQUENCE_SIZE;
-
-        // Log types
-        if (std::strcmp(uri, LV2_LOG__Error) == 0)
-            return CARLA_URI_MAP_ID_LOG_ERROR;
-        if (std::strcmp(uri, LV2_LOG__Note) == 0)
-            return CARLA_URI_MAP_ID_LOG_NOTE;
-        if (std::strcmp(uri, LV2_LOG__Trace) == 0)
-            return CARLA_URI_MAP_ID_LOG_TRACE;
-        if (std::strcmp(uri, LV2_LOG__Warning) == 0)
-            return CARLA_URI_MAP_ID_LOG_WARNING;
-
-        // Time types
-        if (std::strcmp(uri, LV2_TIME__Position) == 0)
-            return CARLA_URI_MAP_ID_TIME_POSITION;
-        if (std::strcmp(uri, LV2_TIME__bar) == 0)
-            return CARLA_URI_MAP_ID_TIME_BAR;
-        if (std::strcmp(uri, LV2_TIME__barBeat) == 0)
-            return CARLA_URI_MAP_ID_TIME_BAR_BEAT;
-        if (std::strcmp(uri, LV2_TIME__beat) == 0)
-            return CARLA_URI_MAP_ID_TIME_BEAT;
-        if (std::strcmp(uri, LV2_TIME__beatUnit) == 0)
-            return CARLA_URI_MAP_ID_TIME_BEAT_UNIT;
-        if (std::strcmp(uri, LV2_TIME__beatsPerBar) == 0)
-            return CARLA_URI_MAP_ID_TIME_BEATS_PER_BAR;
-        if (std::strcmp(uri, LV2_TIME__beatsPerMinute) == 0)
-            return CARLA_URI_MAP_ID_TIME_BEATS_PER_MINUTE;
-        if (std::strcmp(uri, LV2_TIME__frame) == 0)
-            return CARLA_URI_MAP_ID_TIME_FRAME;
-        if (std::strcmp(uri, LV2_TIME__framesPerSecond) == 0)
-            return CARLA_URI_MAP_ID_TIME_FRAMES_PER_SECOND;
-        if (std::strcmp(uri, LV2_TIME__speed) == 0)
-            return CARLA_URI_MAP_ID_TIME_SPEED;
-        if (std::strcmp(uri, LV2_KXSTUDIO_PROPERTIES__TimePositionTicksPerBeat) == 0)
-            return CARLA_URI_MAP_ID_TIME_TICKS_PER_BEAT;
-
-        // Others
-        if (std::strcmp(uri, LV2_MIDI__MidiEvent) == 0)
-            return CARLA_URI_MAP_ID_MIDI_EVENT;
-        if (std::strcmp(uri, LV2_PARAMETERS__sampleRate) == 0)
-            return CARLA_URI_MAP_ID_PARAM_SAMPLE_RATE;
-        if (std::strcmp(uri, LV2_UI__windowTitle) == 0)
-            return CARLA_URI_MAP_ID_UI_WINDOW_TITLE;
-
-        // Custom
-        if (std::strcmp(uri, LV2_KXSTUDIO_PROPERTIES__TransientWindowId) == 0)
-            return CARLA_URI_MAP_ID_CARLA_TRANSIENT_WIN_ID;
-        if (std::strcmp(uri, URI_CARLA_ATOM_WORKER) == 0)
-            return CARLA_URI_MAP_ID_CARLA_ATOM_WORKER;
-
-        // Custom types
         return ((CarlaLv2Client*)handle)->getCustomURID(uri);
     }
 
@@ -1037,113 +976,6 @@ private:
         CARLA_SAFE_ASSERT_RETURN(urid != CARLA_URI_MAP_ID_NULL, nullptr);
         carla_debug("carla_lv2_urid_unmap(%p, %i)", handle, urid);
 
-        // Atom types
-        if (urid == CARLA_URI_MAP_ID_ATOM_BLANK)
-            return LV2_ATOM__Blank;
-        if (urid == CARLA_URI_MAP_ID_ATOM_BOOL)
-            return LV2_ATOM__Bool;
-        if (urid == CARLA_URI_MAP_ID_ATOM_CHUNK)
-            return LV2_ATOM__Chunk;
-        if (urid == CARLA_URI_MAP_ID_ATOM_DOUBLE)
-            return LV2_ATOM__Double;
-        if (urid == CARLA_URI_MAP_ID_ATOM_EVENT)
-            return LV2_ATOM__Event;
-        if (urid == CARLA_URI_MAP_ID_ATOM_FLOAT)
-            return LV2_ATOM__Float;
-        if (urid == CARLA_URI_MAP_ID_ATOM_INT)
-            return LV2_ATOM__Int;
-        if (urid == CARLA_URI_MAP_ID_ATOM_LITERAL)
-            return LV2_ATOM__Literal;
-        if (urid == CARLA_URI_MAP_ID_ATOM_LONG)
-            return LV2_ATOM__Long;
-        if (urid == CARLA_URI_MAP_ID_ATOM_NUMBER)
-            return LV2_ATOM__Number;
-        if (urid == CARLA_URI_MAP_ID_ATOM_OBJECT)
-            return LV2_ATOM__Object;
-        if (urid == CARLA_URI_MAP_ID_ATOM_PATH)
-            return LV2_ATOM__Path;
-        if (urid == CARLA_URI_MAP_ID_ATOM_PROPERTY)
-            return LV2_ATOM__Property;
-        if (urid == CARLA_URI_MAP_ID_ATOM_RESOURCE)
-            return LV2_ATOM__Resource;
-        if (urid == CARLA_URI_MAP_ID_ATOM_SEQUENCE)
-            return LV2_ATOM__Sequence;
-        if (urid == CARLA_URI_MAP_ID_ATOM_SOUND)
-            return LV2_ATOM__Sound;
-        if (urid == CARLA_URI_MAP_ID_ATOM_STRING)
-            return LV2_ATOM__String;
-        if (urid == CARLA_URI_MAP_ID_ATOM_TUPLE)
-            return LV2_ATOM__Tuple;
-        if (urid == CARLA_URI_MAP_ID_ATOM_URI)
-            return LV2_ATOM__URI;
-        if (urid == CARLA_URI_MAP_ID_ATOM_URID)
-            return LV2_ATOM__URID;
-        if (urid == CARLA_URI_MAP_ID_ATOM_VECTOR)
-            return LV2_ATOM__Vector;
-        if (urid == CARLA_URI_MAP_ID_ATOM_TRANSFER_ATOM)
-            return LV2_ATOM__atomTransfer;
-        if (urid == CARLA_URI_MAP_ID_ATOM_TRANSFER_EVENT)
-            return LV2_ATOM__eventTransfer;
-
-        // BufSize types
-        if (urid == CARLA_URI_MAP_ID_BUF_MAX_LENGTH)
-            return LV2_BUF_SIZE__maxBlockLength;
-        if (urid == CARLA_URI_MAP_ID_BUF_MIN_LENGTH)
-            return LV2_BUF_SIZE__minBlockLength;
-        if (urid == CARLA_URI_MAP_ID_BUF_NOMINAL_LENGTH)
-            return LV2_BUF_SIZE__nominalBlockLength;
-        if (urid == CARLA_URI_MAP_ID_BUF_SEQUENCE_SIZE)
-            return LV2_BUF_SIZE__sequenceSize;
-
-        // Log types
-        if (urid == CARLA_URI_MAP_ID_LOG_ERROR)
-            return LV2_LOG__Error;
-        if (urid == CARLA_URI_MAP_ID_LOG_NOTE)
-            return LV2_LOG__Note;
-        if (urid == CARLA_URI_MAP_ID_LOG_TRACE)
-            return LV2_LOG__Trace;
-        if (urid == CARLA_URI_MAP_ID_LOG_WARNING)
-            return LV2_LOG__Warning;
-
-        // Time types
-        if (urid == CARLA_URI_MAP_ID_TIME_POSITION)
-            return LV2_TIME__Position;
-        if (urid == CARLA_URI_MAP_ID_TIME_BAR)
-            return LV2_TIME__bar;
-        if (urid == CARLA_URI_MAP_ID_TIME_BAR_BEAT)
-            return LV2_TIME__barBeat;
-        if (urid == CARLA_URI_MAP_ID_TIME_BEAT)
-            return LV2_TIME__beat;
-        if (urid == CARLA_URI_MAP_ID_TIME_BEAT_UNIT)
-            return LV2_TIME__beatUnit;
-        if (urid == CARLA_URI_MAP_ID_TIME_BEATS_PER_BAR)
-            return LV2_TIME__beatsPerBar;
-        if (urid == CARLA_URI_MAP_ID_TIME_BEATS_PER_MINUTE)
-            return LV2_TIME__beatsPerMinute;
-        if (urid == CARLA_URI_MAP_ID_TIME_FRAME)
-            return LV2_TIME__frame;
-        if (urid == CARLA_URI_MAP_ID_TIME_FRAMES_PER_SECOND)
-            return LV2_TIME__framesPerSecond;
-        if (urid == CARLA_URI_MAP_ID_TIME_SPEED)
-            return LV2_TIME__speed;
-        if (urid == CARLA_URI_MAP_ID_TIME_TICKS_PER_BEAT)
-            return LV2_KXSTUDIO_PROPERTIES__TimePositionTicksPerBeat;
-
-        // Others
-        if (urid == CARLA_URI_MAP_ID_MIDI_EVENT)
-            return LV2_MIDI__MidiEvent;
-        if (urid == CARLA_URI_MAP_ID_PARAM_SAMPLE_RATE)
-            return LV2_PARAMETERS__sampleRate;
-        if (urid == CARLA_URI_MAP_ID_UI_WINDOW_TITLE)
-            return LV2_UI__windowTitle;
-
-        // Custom
-        if (urid == CARLA_URI_MAP_ID_CARLA_ATOM_WORKER)
-            return URI_CARLA_ATOM_WORKER;
-        if (urid == CARLA_URI_MAP_ID_CARLA_TRANSIENT_WIN_ID)
-            return LV2_KXSTUDIO_PROPERTIES__TransientWindowId;
-
-        // Custom types
         return ((CarlaLv2Client*)handle)->getCustomURIDString(urid);
     }
 
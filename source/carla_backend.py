@@ -699,6 +699,51 @@ ENGINE_CALLBACK_ERROR = 38
 # The engine has crashed or malfunctioned and will no longer work.
 ENGINE_CALLBACK_QUIT = 39
 
+# Several parameter values have changed since the last engine idle, only the latest value of each is kept.
+# Only sent instead of ENGINE_CALLBACK_PARAMETER_VALUE_CHANGED when ENGINE_OPTION_BATCH_PARAMETER_CHANGES is set.
+# @a pluginId Plugin Id
+# @a value1   Number of parameters changed during this idle
+# @see carla_get_plugin_parameter_changes()
+ENGINE_CALLBACK_PARAMETER_VALUES_CHANGED = 40
+
+# A bridged plugin missed its processing deadline too many times in a row and is now silenced,
+# or it has caught up again.
+# @a pluginId Plugin Id
+# @a value1   1 if degraded, 0 if recovered
+# @a value2   Number of consecutive missed blocks
+# @see ENGINE_OPTION_PLUGIN_BRIDGES_DEADLINE
+ENGINE_CALLBACK_PLUGIN_DEGRADED = 41
+
+# A plugin of a project was loaded, sent once all project plugins are added.
+# Only sent when ENGINE_OPTION_PROJECT_LOAD_THREADS is set.
+# @a pluginId Plugin Id
+# @a value1   Time spent creating the plugin, in microseconds
+# @a value2   Time spent restoring its state, in microseconds
+# @see ENGINE_CALLBACK_PROJECT_PLUGINS_LOADED
+ENGINE_CALLBACK_PROJECT_PLUGIN_LOADED = 42
+
+# All plugins of a project were loaded, sent after ENGINE_CALLBACK_PROJECT_PLUGIN_LOADED.
+# Only sent when ENGINE_OPTION_PROJECT_LOAD_THREADS is set.
+# @a value1 Number of plugins loaded
+# @a value2 Number of plugins in the project
+# @a value3 Time spent loading the plugins, in milliseconds
+ENGINE_CALLBACK_PROJECT_PLUGINS_LOADED = 43
+
+# The offline driver finished rendering, sent from its render thread.
+# @a value1 Number of blocks rendered
+# @a value2 Number of blocks that took longer than the buffer period
+# @a value3 Average DSP load, in percent of the buffer period
+# @see ENGINE_OPTION_OFFLINE_RENDER_FRAMES
+ENGINE_CALLBACK_OFFLINE_RENDER_FINISHED = 44
+
+# Process round-trip times of a bridged plugin since it was activated, sent when it is deactivated.
+# @a pluginId Plugin Id
+# @a value1   Number of replies measured
+# @a value2   Number of replies taken while spinning, without sleeping
+# @a value3   Average round-trip time, in microseconds
+# @see ENGINE_OPTION_PLUGIN_BRIDGES_SPIN_TIME
+ENGINE_CALLBACK_PLUGIN_BRIDGE_LATENCY = 45
+
 # ------------------------------------------------------------------------------------------------------------
 # Engine Option
 # Engine options.
@@ -782,6 +827,55 @@ ENGINE_OPTION_PREVENT_BAD_BEHAVIOUR = 16
 # Set frontend winId, used to define as parent window for plugin UIs.
 ENGINE_OPTION_FRONTEND_WIN_ID = 17
 
+# Number of extra real-time worker threads used for parallel processing.
+# Only used in patchbay mode, independent plugins will run concurrently on these threads.
+# Default is 0 (everything is processed in the audio thread).
+ENGINE_OPTION_PROCESS_WORKERS = 18
+
+# Number of pipeline stages used in rack mode.
+# Each extra stage runs a part of the rack on its own real-time thread, adding one block of latency.
+# Default is 1 (no pipelining).
+ENGINE_OPTION_RACK_PIPELINE_STAGES = 19
+
+# Time in microseconds to busy-wait for a bridged plugin to finish processing before sleeping on a semaphore.
+# Saves a kernel wakeup per block when the bridge replies quickly, at the cost of CPU time.
+# Default is 0 (always sleep).
+ENGINE_OPTION_PLUGIN_BRIDGES_SPIN_TIME = 20
+
+# Maximum number of bridged plugins of the same binary type to host inside a single bridge process.
+# Grouped plugins share one real-time channel, and contiguous rack chains run in a single round-trip.
+# Default is 1 (one process per plugin).
+ENGINE_OPTION_PLUGIN_BRIDGES_GROUP_SIZE = 21
+
+# Report parameter changes coming from plugins with a single ENGINE_CALLBACK_PARAMETER_VALUES_CHANGED per plugin and idle.
+# Changes made through the host API are still reported one by one.
+# Default is false.
+ENGINE_OPTION_BATCH_PARAMETER_CHANGES = 22
+
+# Number of threads used to load bridged plugins and restore their state when loading a project.
+# Plugins are still added in project order and activated together once all are loaded.
+# Default is 0 (load one plugin at a time).
+# @see ENGINE_CALLBACK_PROJECT_PLUGINS_LOADED
+ENGINE_OPTION_PROJECT_LOAD_THREADS = 23
+
+# Minimum size in bytes of plugin chunks and custom data values stored in the project sidecar file ('<project>.data').
+# The sidecar keeps them raw and compressed instead of base64 text inside the project.
+# Default is 0 (no sidecar, everything is stored in the project).
+ENGINE_OPTION_PROJECT_SIDECAR_MIN_SIZE = 24
+
+# Time a bridged plugin has to process a block, as a percentage of the block duration.
+# A bridge that misses it plays a fade-out of its previous output, then silence, instead of stalling the engine.
+# Its late reply is skipped, and after several misses in a row it is reported as degraded.
+# Default is 0 (no deadline, wait up to 1 second and then stop using the bridge).
+# @see ENGINE_CALLBACK_PLUGIN_DEGRADED
+ENGINE_OPTION_PLUGIN_BRIDGES_DEADLINE = 25
+
+# Number of frames the offline driver renders once transport starts playing, transport is paused afterwards.
+# Nothing is rendered nor measured while transport is stopped, so a project can be loaded first.
+# Default is 0 (render until the engine is closed).
+# @see ENGINE_CALLBACK_OFFLINE_RENDER_FINISHED
+ENGINE_OPTION_OFFLINE_RENDER_FRAMES = 26
+
 # ------------------------------------------------------------------------------------------------------------
 # Engine Process Mode
 # Engine process mode.
@@ -1133,6 +1227,74 @@ class CarlaTransportInfo(Structure):
         ("bpm", c_double)
     ]
 
+# Plugin processing time statistics, over its last processed blocks.
+# Times are in microseconds.
+# @see carla_get_plugin_dsp_stats()
+class CarlaPluginDspStats(Structure):
+    _fields_ = [
+        # Number of measured blocks.
+        ("count", c_uint32),
+
+        # Minimum processing time.
+        ("minTime", c_float),
+
+        # Average processing time.
+        ("avgTime", c_float),
+
+        # Maximum processing time.
+        ("maxTime", c_float),
+
+        # 99th percentile processing time.
+        ("p99Time", c_float),
+
+        # Average processing time relative to the buffer period, in percent.
+        ("load", c_float)
+    ]
+
+# Plugin worker statistics, for plugins that run non-realtime jobs (LV2 worker extension).
+# Times are in microseconds.
+# @see carla_get_plugin_worker_stats()
+class CarlaPluginWorkerStats(Structure):
+    _fields_ = [
+        # Number of jobs run.
+        ("jobs", c_uint32),
+
+        # Number of jobs and responses that did not fit their queue.
+        ("dropped", c_uint32),
+
+        # Number of jobs waiting to run.
+        ("queueDepth", c_uint32),
+
+        # Maximum number of jobs waiting to run.
+        ("maxQueueDepth", c_uint32),
+
+        # Average time between scheduling a job and running it.
+        ("avgLatency", c_float),
+
+        # Maximum time between scheduling a job and running it.
+        ("maxLatency", c_float),
+
+        # Average job run time.
+        ("avgJobTime", c_float),
+
+        # Maximum job run time.
+        ("maxJobTime", c_float)
+    ]
+
+# Parameter changes of a plugin, coalesced so that only the latest value of each parameter is kept.
+# @see carla_get_plugin_parameter_changes()
+class CarlaParameterChanges(Structure):
+    _fields_ = [
+        # Number of changed parameters.
+        ("count", c_uint32),
+
+        # Changed parameter indexes, in ascending order.
+        ("indexes", POINTER(c_uint32)),
+
+        # New parameter values, matching indexes.
+        ("values", POINTER(c_float))
+    ]
+
 # ------------------------------------------------------------------------------------------------------------
 # Carla Host API (Python compatible stuff)
 
@@ -1182,6 +1344,28 @@ PyCarlaTransportInfo = {
     "bpm": 0.0
 }
 
+# @see CarlaPluginDspStats
+PyCarlaPluginDspStats = {
+    "count": 0,
+    "minTime": 0.0,
+    "avgTime": 0.0,
+    "maxTime": 0.0,
+    "p99Time": 0.0,
+    "load": 0.0
+}
+
+# @see CarlaPluginWorkerStats
+PyCarlaPluginWorkerStats = {
+    "jobs": 0,
+    "dropped": 0,
+    "queueDepth": 0,
+    "maxQueueDepth": 0,
+    "avgLatency": 0.0,
+    "maxLatency": 0.0,
+    "avgJobTime": 0.0,
+    "maxJobTime": 0.0
+}
+
 # ------------------------------------------------------------------------------------------------------------
 # Set BINARY_NATIVE
 
@@ -1219,6 +1403,10 @@ class CarlaHostMeta(object):
         self.uisAlwaysOnTop      = False
         self.maxParameters       = 0
         self.uiBridgesTimeout    = 0
+        self.processWorkers      = 0
+        self.rackPipelineStages  = 1
+        self.bridgesSpinTime     = 0
+        self.bridgesGroupSize    = 1
 
         # settings
         self.pathBinaries  = ""
@@ -1636,6 +1824,40 @@ class CarlaHostMeta(object):
     def get_output_peak_value(self, pluginId, isLeft):
         raise NotImplementedError
 
+    # Get all peak values of a plugin in one call.
+    # Returns a list of 4 values: input left, input right, output left and output right.
+    # @param pluginId Plugin
+    @abstractmethod
+    def get_peak_values(self, pluginId):
+        raise NotImplementedError
+
+    # Get a plugin's average DSP load, relative to the buffer period in percent.
+    # @param pluginId Plugin
+    @abstractmethod
+    def get_plugin_cpu_load(self, pluginId):
+        raise NotImplementedError
+
+    # Get a plugin's processing time statistics.
+    # @param pluginId Plugin
+    @abstractmethod
+    def get_plugin_dsp_stats(self, pluginId):
+        raise NotImplementedError
+
+    # Get a plugin's worker statistics.
+    # All values are 0 for plugins that do not use worker jobs.
+    # @param pluginId Plugin
+    @abstractmethod
+    def get_plugin_worker_stats(self, pluginId):
+        raise NotImplementedError
+
+    # Take the parameter changes of a plugin since the last call.
+    # Only used when ENGINE_OPTION_BATCH_PARAMETER_CHANGES is enabled, call it after receiving ENGINE_CALLBACK_PARAMETER_VALUES_CHANGED.
+    # Returns a list of (index, value) tuples.
+    # @param pluginId Plugin
+    @abstractmethod
+    def get_plugin_parameter_changes(self, pluginId):
+        raise NotImplementedError
+
     # Enable a plugin's option.
     # @param pluginId Plugin
     # @param option   An option from PluginOptions
@@ -2007,6 +2229,21 @@ class CarlaHostNull(CarlaHostMeta):
     def get_output_peak_value(self, pluginId, isLeft):
         return 0.0
 
+    def get_peak_values(self, pluginId):
+        return [0.0, 0.0, 0.0, 0.0]
+
+    def get_plugin_cpu_load(self, pluginId):
+        return 0.0
+
+    def get_plugin_dsp_stats(self, pluginId):
+        return PyCarlaPluginDspStats
+
+    def get_plugin_worker_stats(self, pluginId):
+        return PyCarlaPluginWorkerStats
+
+    def get_plugin_parameter_changes(self, pluginId):
+        return []
+
     def set_option(self, pluginId, option, yesNo):
         return
 
@@ -2274,6 +2511,21 @@ class CarlaHostDLL(CarlaHostMeta):
         self.lib.carla_get_output_peak_value.argtypes = [c_uint, c_bool]
         self.lib.carla_get_output_peak_value.restype = c_float
 
+        self.lib.carla_get_peak_values.argtypes = [c_uint]
+        self.lib.carla_get_peak_values.restype = POINTER(c_float)
+
+        self.lib.carla_get_plugin_cpu_load.argtypes = [c_uint]
+        self.lib.carla_get_plugin_cpu_load.restype = c_float
+
+        self.lib.carla_get_plugin_dsp_stats.argtypes = [c_uint]
+        self.lib.carla_get_plugin_dsp_stats.restype = POINTER(CarlaPluginDspStats)
+
+        self.lib.carla_get_plugin_worker_stats.argtypes = [c_uint]
+        self.lib.carla_get_plugin_worker_stats.restype = POINTER(CarlaPluginWorkerStats)
+
+        self.lib.carla_get_plugin_parameter_changes.argtypes = [c_uint]
+        self.lib.carla_get_plugin_parameter_changes.restype = POINTER(CarlaParameterChanges)
+
         self.lib.carla_set_option.argtypes = [c_uint, c_uint, c_bool]
         self.lib.carla_set_option.restype = None
 
@@ -2542,6 +2794,22 @@ class CarlaHostDLL(CarlaHostMeta):
     def get_output_peak_value(self, pluginId, isLeft):
         return float(self.lib.carla_get_output_peak_value(pluginId, isLeft))
 
+    def get_peak_values(self, pluginId):
+        return self.lib.carla_get_peak_values(pluginId)[:4]
+
+    def get_plugin_cpu_load(self, pluginId):
+        return float(self.lib.carla_get_plugin_cpu_load(pluginId))
+
+    def get_plugin_dsp_stats(self, pluginId):
+        return structToDict(self.lib.carla_get_plugin_dsp_stats(pluginId).contents)
+
+    def get_plugin_worker_stats(self, pluginId):
+        return structToDict(self.lib.carla_get_plugin_worker_stats(pluginId).contents)
+
+    def get_plugin_parameter_changes(self, pluginId):
+        changes = self.lib.carla_get_plugin_parameter_changes(pluginId).contents
+        return list(zip(changes.indexes[:changes.count], changes.values[:changes.count]))
+
     def set_option(self, pluginId, option, yesNo):
         self.lib.carla_set_option(pluginId, option, yesNo)
 
@@ -2647,7 +2915,8 @@ class PluginStoreInfo(object):
         'midiProgramData',
         'customDataCount',
         'customData',
-        'peaks'
+        'peaks',
+        'dspStats'
     ]
 
 # ------------------------------------------------------------------------------------------------------------
@@ -2877,6 +3146,23 @@ class CarlaHostPlugin(CarlaHostMeta):
     def get_output_peak_value(self, pluginId, isLeft):
         return self.fPluginsInfo[pluginId].peaks[2 if isLeft else 3]
 
+    def get_peak_values(self, pluginId):
+        return self.fPluginsInfo[pluginId].peaks
+
+    def get_plugin_cpu_load(self, pluginId):
+        return self.fPluginsInfo[pluginId].dspStats['load']
+
+    def get_plugin_dsp_stats(self, pluginId):
+        return self.fPluginsInfo[pluginId].dspStats
+
+    # worker stats are not sent to control clients
+    def get_plugin_worker_stats(self, pluginId):
+        return PyCarlaPluginWorkerStats
+
+    # the pipe engine expands batched changes before sending them
+    def get_plugin_parameter_changes(self, pluginId):
+        return []
+
     def set_option(self, pluginId, option, yesNo):
         self.sendMsg(["set_option", pluginId, option, yesNo])
 
@@ -3009,6 +3295,7 @@ class CarlaHostPlugin(CarlaHostMeta):
         info.customDataCount = 0
         info.customData      = []
         info.peaks = [0.0, 0.0, 0.0, 0.0]
+        info.dspStats = deepcopy(PyCarlaPluginDspStats)
         self.fPluginsInfo.append(info)
 
     def _set_pluginInfo(self, pluginId, info):
@@ -3133,4 +3420,12 @@ class CarlaHostPlugin(CarlaHostMeta):
     def _set_peaks(self, pluginId, in1, in2, out1, out2):
         self.fPluginsInfo[pluginId].peaks = [in1, in2, out1, out2]
 
+    def _set_dspStats(self, pluginId, minTime, avgTime, maxTime, p99Time, load):
+        dspStats = self.fPluginsInfo[pluginId].dspStats
+        dspStats['minTime'] = minTime
+        dspStats['avgTime'] = avgTime
+        dspStats['maxTime'] = maxTime
+        dspStats['p99Time'] = p99Time
+        dspStats['load']    = load
+
 # ------------------------------------------------------------------------------------------------------------
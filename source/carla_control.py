@@ -359,6 +359,11 @@ class CarlaControlServerThread(ServerThread):
         pluginId, in1, in2, out1, out2 = args
         self.host._set_peaks(pluginId, in1, in2, out1, out2)
 
+    @make_method('/carla-control/set_dsp_stats', 'ifffff')
+    def set_dsp_stats_callback(self, path, args):
+        pluginId, minTime, avgTime, maxTime, p99Time, load = args
+        self.host._set_dspStats(pluginId, minTime, avgTime, maxTime, p99Time, load)
+
     @make_method('/carla-control/exit', '')
     def set_exit_callback(self, path, args):
         print(path, args)
@@ -289,6 +289,9 @@ def killDiscovery():
     if gDiscoveryProcess is not None:
         gDiscoveryProcess.kill()
 
+    if gCarla.utils is not None:
+        gCarla.utils.cancel_plugin_discovery()
+
 def checkPluginCached(desc, ptype):
     plugins = []
 
@@ -668,6 +671,10 @@ class SearchPluginsThread(QThread):
         LADSPA_PATH = toList(settings.value(CARLA_KEY_PATHS_LADSPA, CARLA_DEFAULT_LADSPA_PATH))
         del settings
 
+        if tool == self.fToolNative and not isWine:
+            self.fLadspaPlugins = self._checkCachedBinaries(PLUGIN_LADSPA, LADSPA_PATH)
+            return
+
         for iPATH in LADSPA_PATH:
             binaries = findBinaries(iPATH, OS)
             for binary in binaries:
@@ -702,6 +709,10 @@ class SearchPluginsThread(QThread):
         DSSI_PATH = toList(settings.value(CARLA_KEY_PATHS_DSSI, CARLA_DEFAULT_DSSI_PATH))
         del settings
 
+        if tool == self.fToolNative and not isWine:
+            self.fDssiPlugins = self._checkCachedBinaries(PLUGIN_DSSI, DSSI_PATH)
+            return
+
         for iPATH in DSSI_PATH:
             binaries = findBinaries(iPATH, OS)
             for binary in binaries:
@@ -739,6 +750,10 @@ class SearchPluginsThread(QThread):
         VST2_PATH = toList(settings.value(CARLA_KEY_PATHS_VST2, CARLA_DEFAULT_VST2_PATH))
         del settings
 
+        if tool == self.fToolNative and not isWine:
+            self.fVstPlugins = self._checkCachedBinaries(PLUGIN_VST2, VST2_PATH)
+            return
+
         for iPATH in VST2_PATH:
             if MACOS and not isWine:
                 binaries = findMacVSTBundles(iPATH, False)
@@ -779,6 +794,10 @@ class SearchPluginsThread(QThread):
         VST3_PATH = toList(settings.value(CARLA_KEY_PATHS_VST3, CARLA_DEFAULT_VST3_PATH))
         del settings
 
+        if tool == self.fToolNative and not isWine:
+            self.fVst3Plugins = self._checkCachedBinaries(PLUGIN_VST3, VST3_PATH)
+            return
+
         for iPATH in VST3_PATH:
             if MACOS and not isWine:
                 binaries = findMacVSTBundles(iPATH, True)
@@ -806,6 +825,34 @@ class SearchPluginsThread(QThread):
 
         self.fLastCheckValue += self.fCurPercentValue
 
+    def _checkCachedBinaries(self, ptype, pluginPath):
+        # native binaries are scanned in parallel by the backend, which keeps a persistent cache
+        # and only runs discovery on new or changed files
+        binaries = []
+        lastFilename = None
+
+        gCarla.utils.set_discovery_tool(self.fToolNative, 0)
+        count = gCarla.utils.get_cached_plugin_count(ptype, splitter.join(pluginPath))
+
+        for i in range(count):
+            desc = gCarla.utils.get_cached_plugin_info(ptype, i)
+
+            pinfo = checkPluginCached(desc, ptype)[0]
+            pinfo['filename'] = desc['filename']
+            pinfo['uniqueId'] = desc['uniqueId']
+
+            if desc['filename'] != lastFilename:
+                lastFilename = desc['filename']
+                binaries.append([])
+
+            binaries[-1].append(pinfo)
+
+        if count > 0:
+            self.fSomethingChanged = True
+
+        self.fLastCheckValue += self.fCurPercentValue
+        return binaries
+
     def _checkKIT(self, kitPATH, kitExtension):
         kitFiles = []
         self.fKitPlugins = []
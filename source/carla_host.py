@@ -1799,12 +1799,13 @@ class HostWindow(QMainWindow):
 
         for pluginId in self.fSelectedPlugins:
             self.fPeaksCleared = False
+            peaks = self.host.get_peak_values(pluginId)
             if self.ui.peak_in.isVisible():
-                self.ui.peak_in.displayMeter(1, self.host.get_input_peak_value(pluginId, True))
-                self.ui.peak_in.displayMeter(2, self.host.get_input_peak_value(pluginId, False))
+                self.ui.peak_in.displayMeter(1, peaks[0])
+                self.ui.peak_in.displayMeter(2, peaks[1])
             if self.ui.peak_out.isVisible():
-                self.ui.peak_out.displayMeter(1, self.host.get_output_peak_value(pluginId, True))
-                self.ui.peak_out.displayMeter(2, self.host.get_output_peak_value(pluginId, False))
+                self.ui.peak_out.displayMeter(1, peaks[2])
+                self.ui.peak_out.displayMeter(2, peaks[3])
             return
 
         if self.fPeaksCleared:
@@ -1973,6 +1974,9 @@ def engineCallback(host, action, pluginId, value1, value2, value3, valueStr):
         host.PluginUnavailableCallback.emit(pluginId, valueStr)
     elif action == ENGINE_CALLBACK_PARAMETER_VALUE_CHANGED:
         host.ParameterValueChangedCallback.emit(pluginId, value1, value3)
+    elif action == ENGINE_CALLBACK_PARAMETER_VALUES_CHANGED:
+        for index, value in host.get_plugin_parameter_changes(pluginId):
+            host.ParameterValueChangedCallback.emit(pluginId, index, value)
     elif action == ENGINE_CALLBACK_PARAMETER_DEFAULT_CHANGED:
         host.ParameterDefaultChangedCallback.emit(pluginId, value1, value3)
     elif action == ENGINE_CALLBACK_PARAMETER_MIDI_CC_CHANGED:
@@ -2179,6 +2183,26 @@ def loadHostSettings(host):
     except:
         host.uiBridgesTimeout = CARLA_DEFAULT_UI_BRIDGES_TIMEOUT
 
+    try:
+        host.processWorkers = settings.value(CARLA_KEY_ENGINE_PROCESS_WORKERS, CARLA_DEFAULT_PROCESS_WORKERS, type=int)
+    except:
+        host.processWorkers = CARLA_DEFAULT_PROCESS_WORKERS
+
+    try:
+        host.rackPipelineStages = settings.value(CARLA_KEY_ENGINE_RACK_PIPELINE_STAGES, CARLA_DEFAULT_RACK_PIPELINE_STAGES, type=int)
+    except:
+        host.rackPipelineStages = CARLA_DEFAULT_RACK_PIPELINE_STAGES
+
+    try:
+        host.bridgesSpinTime = settings.value(CARLA_KEY_ENGINE_BRIDGES_SPIN_TIME, CARLA_DEFAULT_BRIDGES_SPIN_TIME, type=int)
+    except:
+        host.bridgesSpinTime = CARLA_DEFAULT_BRIDGES_SPIN_TIME
+
+    try:
+        host.bridgesGroupSize = settings.value(CARLA_KEY_ENGINE_BRIDGES_GROUP_SIZE, CARLA_DEFAULT_BRIDGES_GROUP_SIZE, type=int)
+    except:
+        host.bridgesGroupSize = CARLA_DEFAULT_BRIDGES_GROUP_SIZE
+
     if host.isPlugin:
         return
 
@@ -2232,6 +2256,11 @@ def setHostSettings(host):
 
     host.set_engine_option(ENGINE_OPTION_PROCESS_MODE,          host.nextProcessMode,     "")
     host.set_engine_option(ENGINE_OPTION_TRANSPORT_MODE,        host.transportMode,       "")
+    host.set_engine_option(ENGINE_OPTION_PROCESS_WORKERS,       host.processWorkers,      "")
+    host.set_engine_option(ENGINE_OPTION_RACK_PIPELINE_STAGES,  host.rackPipelineStages,  "")
+    host.set_engine_option(ENGINE_OPTION_PLUGIN_BRIDGES_SPIN_TIME, host.bridgesSpinTime, "")
+    host.set_engine_option(ENGINE_OPTION_PLUGIN_BRIDGES_GROUP_SIZE, host.bridgesGroupSize, "")
+    host.set_engine_option(ENGINE_OPTION_BATCH_PARAMETER_CHANGES, True, "")
 
 # ------------------------------------------------------------------------------------------------------------
 # Set Engine settings according to carla preferences. Returns selected audio driver.
@@ -213,6 +213,10 @@ CARLA_KEY_ENGINE_PREFER_UI_BRIDGES     = "Engine/PreferUiBridges"     # bool
 CARLA_KEY_ENGINE_UIS_ALWAYS_ON_TOP     = "Engine/UIsAlwaysOnTop"      # bool
 CARLA_KEY_ENGINE_MAX_PARAMETERS        = "Engine/MaxParameters"       # int
 CARLA_KEY_ENGINE_UI_BRIDGES_TIMEOUT    = "Engine/UiBridgesTimeout"    # int
+CARLA_KEY_ENGINE_PROCESS_WORKERS       = "Engine/ProcessWorkers"      # int
+CARLA_KEY_ENGINE_RACK_PIPELINE_STAGES  = "Engine/RackPipelineStages"  # int
+CARLA_KEY_ENGINE_BRIDGES_SPIN_TIME     = "Engine/BridgesSpinTime"     # int
+CARLA_KEY_ENGINE_BRIDGES_GROUP_SIZE    = "Engine/BridgesGroupSize"    # int
 
 CARLA_KEY_PATHS_LADSPA = "Paths/LADSPA"
 CARLA_KEY_PATHS_DSSI   = "Paths/DSSI"
@@ -256,6 +260,10 @@ CARLA_DEFAULT_PREFER_UI_BRIDGES     = bool(not WINDOWS)
 CARLA_DEFAULT_UIS_ALWAYS_ON_TOP     = False
 CARLA_DEFAULT_MAX_PARAMETERS        = MAX_DEFAULT_PARAMETERS
 CARLA_DEFAULT_UI_BRIDGES_TIMEOUT    = 4000
+CARLA_DEFAULT_PROCESS_WORKERS       = 0
+CARLA_DEFAULT_RACK_PIPELINE_STAGES  = 1
+CARLA_DEFAULT_BRIDGES_SPIN_TIME     = 0
+CARLA_DEFAULT_BRIDGES_GROUP_SIZE    = 1
 
 CARLA_DEFAULT_AUDIO_NUM_PERIODS     = 2
 CARLA_DEFAULT_AUDIO_BUFFER_SIZE     = 512
@@ -841,11 +841,16 @@ class AbstractPluginSlot(QFrame, PluginEditParentMeta):
     #------------------------------------------------------------------
 
     def idleFast(self):
+        if self.fPeaksInputCount == 0 and self.fPeaksOutputCount == 0:
+            return
+
+        peaks = self.host.get_peak_values(self.fPluginId)
+
         # Input peaks
         if self.fPeaksInputCount > 0:
             if self.fPeaksInputCount > 1:
-                peak1 = self.host.get_input_peak_value(self.fPluginId, True)
-                peak2 = self.host.get_input_peak_value(self.fPluginId, False)
+                peak1 = peaks[0]
+                peak2 = peaks[1]
                 ledState = bool(peak1 != 0.0 or peak2 != 0.0)
 
                 if self.peak_in is not None:
@@ -853,7 +858,7 @@ class AbstractPluginSlot(QFrame, PluginEditParentMeta):
                     self.peak_in.displayMeter(2, peak2)
 
             else:
-                peak = self.host.get_input_peak_value(self.fPluginId, True)
+                peak = peaks[0]
                 ledState = bool(peak != 0.0)
 
                 if self.peak_in is not None:
@@ -866,8 +871,8 @@ class AbstractPluginSlot(QFrame, PluginEditParentMeta):
         # Output peaks
         if self.fPeaksOutputCount > 0:
             if self.fPeaksOutputCount > 1:
-                peak1 = self.host.get_output_peak_value(self.fPluginId, True)
-                peak2 = self.host.get_output_peak_value(self.fPluginId, False)
+                peak1 = peaks[2]
+                peak2 = peaks[3]
                 ledState = bool(peak1 != 0.0 or peak2 != 0.0)
 
                 if self.peak_out is not None:
@@ -875,7 +880,7 @@ class AbstractPluginSlot(QFrame, PluginEditParentMeta):
                     self.peak_out.displayMeter(2, peak2)
 
             else:
-                peak = self.host.get_output_peak_value(self.fPluginId, True)
+                peak = peaks[2]
                 ledState = bool(peak != 0.0)
 
                 if self.peak_out is not None:
@@ -133,7 +133,15 @@ class CarlaCachedPluginInfo(Structure):
         ("maker", c_char_p),
 
         # Plugin copyright/license.
-        ("copyright", c_char_p)
+        ("copyright", c_char_p),
+
+        # Plugin binary filename.
+        # Only set for binary plugin formats (LADSPA, DSSI, VST2 and VST3).
+        ("filename", c_char_p),
+
+        # Plugin unique Id.
+        # Only set for binary plugin formats (LADSPA, DSSI, VST2 and VST3).
+        ("uniqueId", c_int64)
     ]
 
 # ------------------------------------------------------------------------------------------------------------
@@ -152,7 +160,9 @@ PyCarlaCachedPluginInfo = {
     'name':  "",
     'label': "",
     'maker': "",
-    'copyright': ""
+    'copyright': "",
+    'filename': "",
+    'uniqueId': 0
 }
 
 # ------------------------------------------------------------------------------------------------------------
@@ -182,6 +192,12 @@ class CarlaUtils(object):
         self.lib.carla_set_process_name.argtypes = [c_char_p]
         self.lib.carla_set_process_name.restype = None
 
+        self.lib.carla_set_discovery_tool.argtypes = [c_char_p, c_uint]
+        self.lib.carla_set_discovery_tool.restype = None
+
+        self.lib.carla_cancel_plugin_discovery.argtypes = None
+        self.lib.carla_cancel_plugin_discovery.restype = None
+
         self.lib.carla_pipe_client_new.argtypes = [POINTER(c_char_p), CarlaPipeCallbackFunc, c_void_p]
         self.lib.carla_pipe_client_new.restype = CarlaPipeClientHandle
 
@@ -273,6 +289,16 @@ class CarlaUtils(object):
     def set_process_name(self, name):
         self.lib.carla_set_process_name(name.encode("utf-8"))
 
+    # Set the discovery tool used to scan binary plugins in get_cached_plugin_count().
+    # Up to maxWorkers binaries are scanned in parallel, 0 means one worker per CPU core.
+    # None or an empty tool disables scanning.
+    def set_discovery_tool(self, tool, maxWorkers):
+        self.lib.carla_set_discovery_tool(tool.encode("utf-8") if tool else None, maxWorkers)
+
+    # Cancel a running binary plugin scan.
+    def cancel_plugin_discovery(self):
+        self.lib.carla_cancel_plugin_discovery()
+
     def pipe_client_new(self, func):
         argc      = len(argv)
         cagrvtype = c_char_p * argc
@@ -398,11 +398,13 @@ JACKBRIDGE_API bool jackbridge_sem_init(void* sem) noexcept;
 JACKBRIDGE_API void jackbridge_sem_destroy(void* sem) noexcept;
 JACKBRIDGE_API void jackbridge_sem_post(void* sem) noexcept;
 JACKBRIDGE_API bool jackbridge_sem_timedwait(void* sem, uint secs) noexcept;
+JACKBRIDGE_API bool jackbridge_sem_timedwait_usecs(void* sem, uint usecs) noexcept;
 
 JACKBRIDGE_API bool  jackbridge_shm_is_valid(const void* shm) noexcept;
 JACKBRIDGE_API void  jackbridge_shm_init(void* shm) noexcept;
 JACKBRIDGE_API void  jackbridge_shm_attach(void* shm, const char* name) noexcept;
 JACKBRIDGE_API void  jackbridge_shm_close(void* shm) noexcept;
 JACKBRIDGE_API void* jackbridge_shm_map(void* shm, uint64_t size) noexcept;
+JACKBRIDGE_API void  jackbridge_shm_unmap(void* shm, void* ptr) noexcept;
 
 #endif // JACKBRIDGE_HPP_INCLUDED
@@ -29,7 +29,10 @@ bool jackbridge_sem_init(void* sem) noexcept
 {
     CARLA_SAFE_ASSERT_RETURN(sem != nullptr, false);
 
-#ifndef JACKBRIDGE_DUMMY
+#if defined(JACKBRIDGE_DUMMY) || defined(CARLA_OS_MAC)
+    // these live in shared memory, macOS semaphores cannot be shared between processes
+    return false;
+#else
     return carla_sem_create2(*(carla_sem_t*)sem);
 #endif
 }
@@ -63,6 +66,17 @@ bool jackbridge_sem_timedwait(void* sem, uint secs) noexcept
 #endif
 }
 
+bool jackbridge_sem_timedwait_usecs(void* sem, uint usecs) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(sem != nullptr, false);
+
+#ifdef JACKBRIDGE_DUMMY
+    return false;
+#else
+    return carla_sem_timedwait_usecs(*(carla_sem_t*)sem, usecs);
+#endif
+}
+
 // -----------------------------------------------------------------------------
 
 bool jackbridge_shm_is_valid(const void* shm) noexcept
@@ -114,4 +128,13 @@ void* jackbridge_shm_map(void* shm, uint64_t size) noexcept
 #endif
 }
 
+void jackbridge_shm_unmap(void* shm, void* ptr) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(shm != nullptr,);
+
+#ifndef JACKBRIDGE_DUMMY
+    carla_shm_unmap(*(carla_shm_t*)shm, ptr);
+#endif
+}
+
 // -----------------------------------------------------------------------------
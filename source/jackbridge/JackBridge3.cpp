@@ -130,11 +130,13 @@ const JackBridgeExportedFunctions* JACKBRIDGE_API jackbridge_get_exported_functi
     funcs.sem_destroy_ptr                      = jackbridge_sem_destroy;
     funcs.sem_post_ptr                         = jackbridge_sem_post;
     funcs.sem_timedwait_ptr                    = jackbridge_sem_timedwait;
+    funcs.sem_timedwait_usecs_ptr              = jackbridge_sem_timedwait_usecs;
     funcs.shm_is_valid_ptr                     = jackbridge_shm_is_valid;
     funcs.shm_init_ptr                         = jackbridge_shm_init;
     funcs.shm_attach_ptr                       = jackbridge_shm_attach;
     funcs.shm_close_ptr                        = jackbridge_shm_close;
     funcs.shm_map_ptr                          = jackbridge_shm_map;
+    funcs.shm_unmap_ptr                        = jackbridge_shm_unmap;
 
     funcs.unique1 = funcs.unique2 = funcs.unique3 = 0xdeadf00d;
 
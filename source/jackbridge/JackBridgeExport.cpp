@@ -553,6 +553,11 @@ bool jackbridge_sem_timedwait(void* sem, uint secs) noexcept
     return getBridgeInstance().sem_timedwait_ptr(sem, secs);
 }
 
+bool jackbridge_sem_timedwait_usecs(void* sem, uint usecs) noexcept
+{
+    return getBridgeInstance().sem_timedwait_usecs_ptr(sem, usecs);
+}
+
 bool jackbridge_shm_is_valid(const void* shm) noexcept
 {
     return getBridgeInstance().shm_is_valid_ptr(shm);
@@ -578,4 +583,9 @@ void* jackbridge_shm_map(void* shm, uint64_t size) noexcept
     return getBridgeInstance().shm_map_ptr(shm, size);
 }
 
+void jackbridge_shm_unmap(void* shm, void* ptr) noexcept
+{
+    return getBridgeInstance().shm_unmap_ptr(shm, ptr);
+}
+
 // -----------------------------------------------------------------------------
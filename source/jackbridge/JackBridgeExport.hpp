@@ -113,11 +113,13 @@ typedef bool (JACKBRIDGE_API *jackbridgesym_sem_init)(void*);
 typedef void (JACKBRIDGE_API *jackbridgesym_sem_destroy)(void*);
 typedef void (JACKBRIDGE_API *jackbridgesym_sem_post)(void*);
 typedef bool (JACKBRIDGE_API *jackbridgesym_sem_timedwait)(void*, uint);
+typedef bool (JACKBRIDGE_API *jackbridgesym_sem_timedwait_usecs)(void*, uint);
 typedef bool (JACKBRIDGE_API *jackbridgesym_shm_is_valid)(const void*);
 typedef void (JACKBRIDGE_API *jackbridgesym_shm_init)(void*);
 typedef void (JACKBRIDGE_API *jackbridgesym_shm_attach)(void*, const char*);
 typedef void (JACKBRIDGE_API *jackbridgesym_shm_close)(void*);
 typedef void* (JACKBRIDGE_API *jackbridgesym_shm_map)(void*, uint64_t);
+typedef void (JACKBRIDGE_API *jackbridgesym_shm_unmap)(void*, void*);
 
 // -----------------------------------------------------------------------------
 
@@ -217,11 +219,13 @@ struct _JackBridgeExportedFunctions {
     jackbridgesym_sem_destroy sem_destroy_ptr;
     jackbridgesym_sem_post sem_post_ptr;
     jackbridgesym_sem_timedwait sem_timedwait_ptr;
+    jackbridgesym_sem_timedwait_usecs sem_timedwait_usecs_ptr;
     jackbridgesym_shm_is_valid shm_is_valid_ptr;
     jackbridgesym_shm_init shm_init_ptr;
     jackbridgesym_shm_attach shm_attach_ptr;
     jackbridgesym_shm_close shm_close_ptr;
     jackbridgesym_shm_map shm_map_ptr;
+    jackbridgesym_shm_unmap shm_unmap_ptr;
     ulong unique3;
 };
 
@@ -0,0 +1,312 @@
+/*
+ * Carla Native Plugins
+ * Copyright (C) 2012-2015 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#ifndef AUDIO_BASE_HPP_INCLUDED
+#define AUDIO_BASE_HPP_INCLUDED
+
+#include "CarlaMathUtils.hpp"
+#include "CarlaThread.hpp"
+
+#include "juce_audio_formats.h"
+
+// -----------------------------------------------------------------------
+// Streams an audio file from disk into a ring buffer.
+//
+// A background thread decodes the file ahead of the play position, the
+// audio thread only copies from the ring buffer and never blocks.
+// Relocations are requested by the audio thread and picked up by the disk
+// thread on its next cycle, the start of the file is kept in memory so that
+// jumps to the beginning (transport rewind) play without a gap.
+
+class AudioFileStream : private CarlaThread
+{
+public:
+    static const int  kChunkFrames   = 4096;
+    static const uint kRingSeconds   = 4;
+    static const uint kHeadSeconds   = 1;
+    static const uint kIdleSleepTime = 5; // ms
+
+    AudioFileStream(juce::AudioFormatReader* const reader, const double sampleRate, const bool loopMode)
+        : CarlaThread("AudioFileStream"),
+          fReader(reader),
+          fLength(reader->lengthInSamples),
+          fHead(),
+          fHeadFrames(0),
+          fRing(),
+          fRingFrames(0),
+          fChunk(2, kChunkFrames),
+          fReadCount(0),
+          fWriteCount(0),
+          fRequestPos(0),
+          fRequestLoop(loopMode),
+          fRequestGen(1),
+          fWriteGen(0),
+          fUnderruns(0),
+          fExpectedPos(0),
+          fRingPos(0),
+          fLoopMode(loopMode)
+    {
+        fRingFrames = carla_nextPowerOf2(static_cast<uint32_t>(sampleRate * kRingSeconds));
+        fRing.setSize(2, static_cast<int>(fRingFrames));
+        fRing.clear();
+
+        fHeadFrames = static_cast<int>(std::min<int64_t>(fLength, static_cast<int64_t>(sampleRate * kHeadSeconds)));
+
+        if (fHeadFrames > 0)
+        {
+            fHead.setSize(2, fHeadFrames);
+            fReader->read(&fHead, 0, fHeadFrames, 0, true, true);
+        }
+
+        startThread();
+    }
+
+    ~AudioFileStream() override
+    {
+        stopThread(-1);
+    }
+
+    int64_t getLength() const noexcept
+    {
+        return fLength;
+    }
+
+    uint32_t getUnderrunCount() const noexcept
+    {
+        return __atomic_load_n(&fUnderruns, __ATOMIC_RELAXED);
+    }
+
+    // -------------------------------------------------------------------
+    // audio thread calls
+
+    // let the disk thread prefetch around a position without playing it
+    void setNextReadPosition(const int64_t pos, const bool loopMode) noexcept
+    {
+        if (pos != fExpectedPos || loopMode != fLoopMode)
+            _relocate(pos, loopMode);
+    }
+
+    void read(float* const out1, float* const out2, const int64_t pos, const uint32_t frames, const bool loopMode) noexcept
+    {
+        setNextReadPosition(pos, loopMode);
+
+        fExpectedPos = pos + frames;
+
+        if (loopMode)
+            fExpectedPos %= fLength;
+
+        // past the end of the file
+        if (! loopMode && pos >= fLength)
+        {
+            juce::FloatVectorOperations::clear(out1, static_cast<int>(frames));
+            juce::FloatVectorOperations::clear(out2, static_cast<int>(frames));
+            return;
+        }
+
+        const uint32_t wanted(loopMode ? frames : static_cast<uint32_t>(std::min<int64_t>(frames, fLength - pos)));
+
+        if (! _readFromRing(out1, out2, pos, wanted) && ! _readFromHead(out1, out2, pos, wanted))
+        {
+            __atomic_add_fetch(&fUnderruns, 1, __ATOMIC_RELAXED);
+            juce::FloatVectorOperations::clear(out1, static_cast<int>(wanted));
+            juce::FloatVectorOperations::clear(out2, static_cast<int>(wanted));
+        }
+
+        if (wanted < frames)
+        {
+            juce::FloatVectorOperations::clear(out1 + wanted, static_cast<int>(frames - wanted));
+            juce::FloatVectorOperations::clear(out2 + wanted, static_cast<int>(frames - wanted));
+        }
+    }
+
+protected:
+    // -------------------------------------------------------------------
+    // disk thread
+
+    void run() override
+    {
+        uint32_t gen        = 0;
+        uint64_t writeCount = 0;
+        int64_t  filePos    = 0;
+        bool     loopMode   = false;
+
+        for (; ! shouldThreadExit();)
+        {
+            // restart from the requested position
+            const uint32_t requestGen(__atomic_load_n(&fRequestGen, __ATOMIC_ACQUIRE));
+
+            if (requestGen != gen)
+            {
+                gen        = requestGen;
+                filePos    = __atomic_load_n(&fRequestPos, __ATOMIC_RELAXED);
+                loopMode   = __atomic_load_n(&fRequestLoop, __ATOMIC_RELAXED);
+                writeCount = __atomic_load_n(&fReadCount, __ATOMIC_ACQUIRE);
+
+                __atomic_store_n(&fWriteCount, writeCount, __ATOMIC_RELAXED);
+                __atomic_store_n(&fWriteGen, gen, __ATOMIC_RELEASE);
+            }
+
+            const uint64_t readCount(__atomic_load_n(&fReadCount, __ATOMIC_ACQUIRE));
+
+            if ((! loopMode && filePos >= fLength) || writeCount - readCount + kChunkFrames > fRingFrames)
+            {
+                carla_msleep(kIdleSleepTime);
+                continue;
+            }
+
+            const int frames(static_cast<int>(std::min<int64_t>(kChunkFrames, fLength - filePos)));
+
+            fReader->read(&fChunk, 0, frames, filePos, true, true);
+
+            const uint32_t offset(static_cast<uint32_t>(writeCount & (fRingFrames-1)));
+            const int      first(static_cast<int>(std::min<uint32_t>(static_cast<uint32_t>(frames), fRingFrames - offset)));
+
+            for (int c=0; c < 2; ++c)
+            {
+                fRing.copyFrom(c, static_cast<int>(offset), fChunk, c, 0, first);
+
+                if (first < frames)
+                    fRing.copyFrom(c, 0, fChunk, c, first, frames - first);
+            }
+
+            writeCount += static_cast<uint64_t>(frames);
+            filePos    += frames;
+
+            if (loopMode && filePos >= fLength)
+                filePos = 0;
+
+            __atomic_store_n(&fWriteCount, writeCount, __ATOMIC_RELEASE);
+        }
+    }
+
+private:
+    const juce::ScopedPointer<juce::AudioFormatReader> fReader;
+    const int64_t fLength;
+
+    juce::AudioSampleBuffer fHead;
+    int fHeadFrames;
+
+    juce::AudioSampleBuffer fRing;
+    uint32_t fRingFrames;
+
+    // disk thread only
+    juce::AudioSampleBuffer fChunk;
+
+    // shared, read count is written by the audio thread and write count by the disk thread
+    uint64_t fReadCount;
+    uint64_t fWriteCount;
+
+    // shared, a new request generation makes the disk thread restart at the requested position
+    int64_t  fRequestPos;
+    bool     fRequestLoop;
+    uint32_t fRequestGen;
+    uint32_t fWriteGen;
+
+    uint32_t fUnderruns;
+
+    // audio thread only
+    int64_t fExpectedPos; // position we expect on the next cycle, anything else is a relocation
+    int64_t fRingPos;     // file position of the frame at fReadCount
+    bool    fLoopMode;
+
+    void _relocate(const int64_t pos, const bool loopMode) noexcept
+    {
+        fExpectedPos = pos;
+        fRingPos     = pos;
+        fLoopMode    = loopMode;
+
+        __atomic_store_n(&fRequestPos, pos, __ATOMIC_RELAXED);
+        __atomic_store_n(&fRequestLoop, loopMode, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&fRequestGen, 1, __ATOMIC_RELEASE);
+    }
+
+    void _advanceRingPos(const int64_t frames) noexcept
+    {
+        fRingPos += frames;
+
+        if (fLoopMode)
+            fRingPos %= fLength;
+    }
+
+    bool _readFromRing(float* const out1, float* const out2, const int64_t pos, const uint32_t frames) noexcept
+    {
+        // disk thread has not caught up with the last relocation yet
+        if (__atomic_load_n(&fWriteGen, __ATOMIC_ACQUIRE) != __atomic_load_n(&fRequestGen, __ATOMIC_RELAXED))
+            return false;
+
+        uint64_t readCount(fReadCount);
+        uint64_t available(__atomic_load_n(&fWriteCount, __ATOMIC_ACQUIRE) - readCount);
+
+        // skip what was played from the head cache while the disk thread was busy
+        int64_t skip(pos - fRingPos);
+
+        if (skip < 0 && fLoopMode)
+            skip += fLength;
+
+        CARLA_SAFE_ASSERT_RETURN(skip >= 0, false);
+
+        if (skip > 0)
+        {
+            const uint64_t skipped(std::min<uint64_t>(static_cast<uint64_t>(skip), available));
+
+            readCount += skipped;
+            available -= skipped;
+            _advanceRingPos(static_cast<int64_t>(skipped));
+
+            __atomic_store_n(&fReadCount, readCount, __ATOMIC_RELEASE);
+
+            if (static_cast<int64_t>(skipped) != skip)
+                return false;
+        }
+
+        if (available < frames)
+            return false;
+
+        const uint32_t offset(static_cast<uint32_t>(readCount & (fRingFrames-1)));
+        const uint32_t first(std::min(frames, fRingFrames - offset));
+
+        juce::FloatVectorOperations::copy(out1, fRing.getReadPointer(0, static_cast<int>(offset)), static_cast<int>(first));
+        juce::FloatVectorOperations::copy(out2, fRing.getReadPointer(1, static_cast<int>(offset)), static_cast<int>(first));
+
+        if (first < frames)
+        {
+            juce::FloatVectorOperations::copy(out1 + first, fRing.getReadPointer(0), static_cast<int>(frames - first));
+            juce::FloatVectorOperations::copy(out2 + first, fRing.getReadPointer(1), static_cast<int>(frames - first));
+        }
+
+        _advanceRingPos(frames);
+
+        __atomic_store_n(&fReadCount, readCount + frames, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    bool _readFromHead(float* const out1, float* const out2, const int64_t pos, const uint32_t frames) const noexcept
+    {
+        if (pos + frames > fHeadFrames)
+            return false;
+
+        juce::FloatVectorOperations::copy(out1, fHead.getReadPointer(0, static_cast<int>(pos)), static_cast<int>(frames));
+        juce::FloatVectorOperations::copy(out2, fHead.getReadPointer(1, static_cast<int>(pos)), static_cast<int>(frames));
+        return true;
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(AudioFileStream)
+};
+
+// -----------------------------------------------------------------------
+
+#endif // AUDIO_BASE_HPP_INCLUDED
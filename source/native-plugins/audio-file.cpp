@@ -20,7 +20,7 @@
 #include "CarlaMutex.hpp"
 #include "CarlaString.hpp"
 
-#include "juce_audio_formats.h"
+#include "audio-base.hpp"
 
 using namespace juce;
 
@@ -43,20 +43,19 @@ public:
           fLoopMode(false),
           fDoProcess(false),
           fLength(0),
-          //fThread("AudioFilePluginThread"),
+          fUnderruns(0),
           fReaderBuffer(),
           fReaderMutex(),
           fReader(),
-          fReaderSource()
+          fStream()
     {
         fReaderBuffer.setSize(2, static_cast<int>(getBufferSize()));
     }
 
     ~AudioFilePlugin() override
     {
-        //fThread.stopThread(-1);
-        fReader       = nullptr;
-        fReaderSource = nullptr;
+        fReader = nullptr;
+        fStream = nullptr;
     }
 
 protected:
@@ -65,37 +64,55 @@ protected:
 
     uint32_t getParameterCount() const override
     {
-        return 1;
+        return 2;
     }
 
     const NativeParameter* getParameterInfo(const uint32_t index) const override
     {
-        if (index != 0)
+        if (index > 1)
             return nullptr;
 
         static NativeParameter param;
 
-        param.name  = "Loop Mode";
         param.unit  = nullptr;
-        param.hints = static_cast<NativeParameterHints>(NATIVE_PARAMETER_IS_ENABLED|NATIVE_PARAMETER_IS_BOOLEAN);
-        param.ranges.def = 1.0f;
-        param.ranges.min = 0.0f;
-        param.ranges.max = 1.0f;
         param.ranges.step = 1.0f;
         param.ranges.stepSmall = 1.0f;
         param.ranges.stepLarge = 1.0f;
         param.scalePointCount = 0;
         param.scalePoints     = nullptr;
 
+        switch (index)
+        {
+        case 0:
+            param.name  = "Loop Mode";
+            param.hints = static_cast<NativeParameterHints>(NATIVE_PARAMETER_IS_ENABLED|NATIVE_PARAMETER_IS_BOOLEAN);
+            param.ranges.def = 1.0f;
+            param.ranges.min = 0.0f;
+            param.ranges.max = 1.0f;
+            break;
+        case 1:
+            param.name  = "Underruns";
+            param.hints = static_cast<NativeParameterHints>(NATIVE_PARAMETER_IS_ENABLED|NATIVE_PARAMETER_IS_INTEGER|NATIVE_PARAMETER_IS_OUTPUT);
+            param.ranges.def = 0.0f;
+            param.ranges.min = 0.0f;
+            param.ranges.max = 1000000.0f;
+            break;
+        }
+
         return &param;
     }
 
     float getParameterValue(const uint32_t index) const override
     {
-        if (index != 0)
+        switch (index)
+        {
+        case 0:
+            return fLoopMode ? 1.0f : 0.0f;
+        case 1:
+            return static_cast<float>(fUnderruns);
+        default:
             return 0.0f;
-
-        return fLoopMode ? 1.0f : 0.0f;
+        }
     }
 
     // -------------------------------------------------------------------
@@ -112,11 +129,6 @@ protected:
             return;
 
         fLoopMode = loopMode;
-
-        const CarlaMutexLocker cml(fReaderMutex);
-
-        if (fReaderSource != nullptr)
-            fReaderSource->setLooping(loopMode);
     }
 
     void setCustomData(const char* const key, const char* const value) override
@@ -149,27 +161,30 @@ protected:
             return;
         }
 
-        const int64_t nextReadPos(fLoopMode ? (static_cast<int64_t>(timePos->frame) % fLength) : static_cast<int64_t>(timePos->frame));
+        const bool    loopMode(fLoopMode);
+        const int64_t nextReadPos(loopMode ? (static_cast<int64_t>(timePos->frame) % fLength) : static_cast<int64_t>(timePos->frame));
+
+        // never wait for the file to be (re)loaded
+        const CarlaMutexTryLocker cmtl(fReaderMutex);
 
-        // not playing
-        if (! timePos->playing)
+        if (cmtl.wasNotLocked() || ! timePos->playing)
         {
-            //carla_stderr("P: not playing");
             FloatVectorOperations::clear(out1, iframes);
             FloatVectorOperations::clear(out2, iframes);
 
-            const CarlaMutexLocker cml(fReaderMutex);
-
-            if (fReaderSource != nullptr)
-                fReaderSource->setNextReadPosition(nextReadPos);
+            // let the disk thread prefetch from where we will start playing
+            if (cmtl.wasLocked() && fStream != nullptr)
+                fStream->setNextReadPosition(nextReadPos, loopMode);
 
             return;
         }
 
-        const CarlaMutexLocker cml(fReaderMutex);
-
-        if (fReaderSource != nullptr)
-            fReaderSource->setNextReadPosition(nextReadPos);
+        if (fStream != nullptr)
+        {
+            fStream->read(out1, out2, nextReadPos, frames, loopMode);
+            fUnderruns = fStream->getUnderrunCount();
+            return;
+        }
 
         if (fReader == nullptr)
             return;
@@ -206,14 +221,14 @@ private:
     bool fLoopMode;
     bool fDoProcess;
     int64_t fLength;
-
-    //TimeSliceThread fThread;
+    uint32_t fUnderruns;
 
     AudioSampleBuffer fReaderBuffer;
     CarlaMutex        fReaderMutex;
 
-    ScopedPointer<AudioFormatReader>       fReader;
-    ScopedPointer<AudioFormatReaderSource> fReaderSource;
+    // memory mapped files are read directly, everything else is streamed from disk
+    ScopedPointer<AudioFormatReader> fReader;
+    ScopedPointer<AudioFileStream>   fStream;
 
     void _loadAudioFile(const char* const filename)
     {
@@ -221,16 +236,15 @@ private:
 
         fDoProcess = false;
         fLength    = 0;
-
-        //fThread.stopThread(-1);
+        fUnderruns = 0;
 
         {
             fReaderMutex.lock();
-            AudioFormatReader*       const reader(fReader.release());
-            AudioFormatReaderSource* const readerSource(fReaderSource.release());
+            AudioFormatReader* const reader(fReader.release());
+            AudioFileStream*   const stream(fStream.release());
             fReaderMutex.unlock();
 
-            delete readerSource;
+            delete stream;
             delete reader;
         }
 
@@ -248,7 +262,10 @@ private:
         if (MemoryMappedAudioFormatReader* const memReader = format->createMemoryMappedReader(file))
         {
             memReader->mapEntireFile();
+
+            const CarlaMutexLocker cml(fReaderMutex);
             fReader = memReader;
+            fLength = memReader->lengthInSamples;
 
             carla_stdout("Using memory mapped read file");
         }
@@ -257,22 +274,22 @@ private:
             AudioFormatReader* const reader(afm.createReaderFor(file));
             CARLA_SAFE_ASSERT_RETURN(reader != nullptr,);
 
-            // this code can be used for very large files
-            //fThread.startThread();
-            //BufferingAudioReader* const bufferingReader(new BufferingAudioReader(reader, fThread, getSampleRate()*2));
-            //bufferingReader->setReadTimeout(50);
+            if (reader->lengthInSamples <= 0)
+            {
+                delete reader;
+                return;
+            }
 
-            AudioFormatReaderSource* const readerSource(new AudioFormatReaderSource(/*bufferingReader*/reader, false));
-            readerSource->setLooping(fLoopMode);
+            AudioFileStream* const stream(new AudioFileStream(reader, getSampleRate(), fLoopMode));
 
-            fReaderSource = readerSource;
-            fReader       = reader;
+            const CarlaMutexLocker cml(fReaderMutex);
+            fStream = stream;
+            fLength = stream->getLength();
 
-            carla_stdout("Using regular read file");
+            carla_stdout("Using disk streaming read file");
         }
 
-        fLength    = fReader->lengthInSamples;
-        fDoProcess = true;
+        fDoProcess = fLength > 0;
     }
 
     PluginClassEND(AudioFilePlugin)
@@ -291,7 +308,7 @@ static const NativePluginDescriptor audiofileDesc = {
     /* midiIns   */ 0,
     /* midiOuts  */ 0,
     /* paramIns  */ 1,
-    /* paramOuts */ 0,
+    /* paramOuts */ 1,
     /* name      */ "Audio File",
     /* label     */ "audiofile",
     /* maker     */ "falkTX",
@@ -20,11 +20,13 @@
 
 #include "CarlaMIDI.h"
 #include "CarlaMutex.hpp"
-#include "LinkedList.hpp"
 
 #include "CarlaJuceUtils.hpp"
 #include "CarlaMathUtils.hpp"
 
+#include <algorithm>
+#include <vector>
+
 // -----------------------------------------------------------------------
 
 #define MAX_EVENT_DATA_SIZE          4
@@ -39,6 +41,44 @@ struct RawMidiEvent {
     uint8_t  data[MAX_EVENT_DATA_SIZE];
 };
 
+static inline
+bool operator<(const RawMidiEvent& event, const uint64_t time) noexcept
+{
+    return event.time < time;
+}
+
+static inline
+bool operator<(const uint64_t time, const RawMidiEvent& event) noexcept
+{
+    return time < event.time;
+}
+
+// -----------------------------------------------------------------------
+// Immutable time-sorted copy of the pattern events, as used by the audio thread.
+// All events live in a single contiguous allocation.
+
+struct RawMidiEventList {
+    RawMidiEvent*     events;
+    std::size_t       count;
+    RawMidiEventList* next; // used when waiting to be deleted
+
+    RawMidiEventList(const std::vector<RawMidiEvent>& data)
+        : events(data.size() > 0 ? new RawMidiEvent[data.size()] : nullptr),
+          count(data.size()),
+          next(nullptr)
+    {
+        if (count > 0)
+            carla_copyStructs(events, &data[0], count);
+    }
+
+    ~RawMidiEventList() noexcept
+    {
+        delete[] events;
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(RawMidiEventList)
+};
+
 // -----------------------------------------------------------------------
 
 class AbstractMidiPlayer
@@ -58,14 +98,22 @@ public:
           fMidiPort(0),
           fStartTime(0),
           fMutex(),
-          fData()
+          fData(),
+          fBatchDepth(0),
+          fPending(nullptr),
+          fGarbage(nullptr),
+          fActive(nullptr),
+          fCursor(0),
+          fCursorTime(-1.0)
     {
         CARLA_SAFE_ASSERT(kPlayer != nullptr);
     }
 
     ~MidiPattern() noexcept
     {
-        clear();
+        delete fActive;
+        delete __atomic_exchange_n(&fPending, (RawMidiEventList*)nullptr, __ATOMIC_ACQ_REL);
+        _deleteGarbage();
     }
 
     // -------------------------------------------------------------------
@@ -73,83 +121,96 @@ public:
 
     void addControl(const uint64_t time, const uint8_t channel, const uint8_t control, const uint8_t value)
     {
-        RawMidiEvent* const ctrlEvent(new RawMidiEvent());
-        ctrlEvent->time    = time;
-        ctrlEvent->size    = 3;
-        ctrlEvent->data[0] = uint8_t(MIDI_STATUS_CONTROL_CHANGE | (channel & MIDI_CHANNEL_BIT));
-        ctrlEvent->data[1] = control;
-        ctrlEvent->data[2] = value;
+        RawMidiEvent ctrlEvent;
+        ctrlEvent.time    = time;
+        ctrlEvent.size    = 3;
+        ctrlEvent.data[0] = uint8_t(MIDI_STATUS_CONTROL_CHANGE | (channel & MIDI_CHANNEL_BIT));
+        ctrlEvent.data[1] = control;
+        ctrlEvent.data[2] = value;
+        ctrlEvent.data[3] = 0;
 
         appendSorted(ctrlEvent);
     }
 
     void addChannelPressure(const uint64_t time, const uint8_t channel, const uint8_t pressure)
     {
-        RawMidiEvent* const pressureEvent(new RawMidiEvent());
-        pressureEvent->time    = time;
-        pressureEvent->size    = 2;
-        pressureEvent->data[0] = uint8_t(MIDI_STATUS_CHANNEL_PRESSURE | (channel & MIDI_CHANNEL_BIT));
-        pressureEvent->data[1] = pressure;
+        RawMidiEvent pressureEvent;
+        pressureEvent.time    = time;
+        pressureEvent.size    = 2;
+        pressureEvent.data[0] = uint8_t(MIDI_STATUS_CHANNEL_PRESSURE | (channel & MIDI_CHANNEL_BIT));
+        pressureEvent.data[1] = pressure;
+        pressureEvent.data[2] = 0;
+        pressureEvent.data[3] = 0;
 
         appendSorted(pressureEvent);
     }
 
     void addNote(const uint64_t time, const uint8_t channel, const uint8_t pitch, const uint8_t velocity, const uint32_t duration)
     {
+        const ScopedBatch sb(*this);
+
         addNoteOn(time, channel, pitch, velocity);
         addNoteOff(time+duration, channel, pitch, velocity);
     }
 
     void addNoteOn(const uint64_t time, const uint8_t channel, const uint8_t pitch, const uint8_t velocity)
     {
-        RawMidiEvent* const noteOnEvent(new RawMidiEvent());
-        noteOnEvent->time    = time;
-        noteOnEvent->size    = 3;
-        noteOnEvent->data[0] = uint8_t(MIDI_STATUS_NOTE_ON | (channel & MIDI_CHANNEL_BIT));
-        noteOnEvent->data[1] = pitch;
-        noteOnEvent->data[2] = velocity;
+        RawMidiEvent noteOnEvent;
+        noteOnEvent.time    = time;
+        noteOnEvent.size    = 3;
+        noteOnEvent.data[0] = uint8_t(MIDI_STATUS_NOTE_ON | (channel & MIDI_CHANNEL_BIT));
+        noteOnEvent.data[1] = pitch;
+        noteOnEvent.data[2] = velocity;
+        noteOnEvent.data[3] = 0;
 
         appendSorted(noteOnEvent);
     }
 
     void addNoteOff(const uint64_t time, const uint8_t channel, const uint8_t pitch, const uint8_t velocity = 0)
     {
-        RawMidiEvent* const noteOffEvent(new RawMidiEvent());
-        noteOffEvent->time    = time;
-        noteOffEvent->size    = 3;
-        noteOffEvent->data[0] = uint8_t(MIDI_STATUS_NOTE_OFF | (channel & MIDI_CHANNEL_BIT));
-        noteOffEvent->data[1] = pitch;
-        noteOffEvent->data[2] = velocity;
+        RawMidiEvent noteOffEvent;
+        noteOffEvent.time    = time;
+        noteOffEvent.size    = 3;
+        noteOffEvent.data[0] = uint8_t(MIDI_STATUS_NOTE_OFF | (channel & MIDI_CHANNEL_BIT));
+        noteOffEvent.data[1] = pitch;
+        noteOffEvent.data[2] = velocity;
+        noteOffEvent.data[3] = 0;
 
         appendSorted(noteOffEvent);
     }
 
     void addNoteAftertouch(const uint64_t time, const uint8_t channel, const uint8_t pitch, const uint8_t pressure)
     {
-        RawMidiEvent* const noteAfterEvent(new RawMidiEvent());
-        noteAfterEvent->time    = time;
-        noteAfterEvent->size    = 3;
-        noteAfterEvent->data[0] = uint8_t(MIDI_STATUS_POLYPHONIC_AFTERTOUCH | (channel & MIDI_CHANNEL_BIT));
-        noteAfterEvent->data[1] = pitch;
-        noteAfterEvent->data[2] = pressure;
+        RawMidiEvent noteAfterEvent;
+        noteAfterEvent.time    = time;
+        noteAfterEvent.size    = 3;
+        noteAfterEvent.data[0] = uint8_t(MIDI_STATUS_POLYPHONIC_AFTERTOUCH | (channel & MIDI_CHANNEL_BIT));
+        noteAfterEvent.data[1] = pitch;
+        noteAfterEvent.data[2] = pressure;
+        noteAfterEvent.data[3] = 0;
 
         appendSorted(noteAfterEvent);
     }
 
     void addProgram(const uint64_t time, const uint8_t channel, const uint8_t bank, const uint8_t program)
     {
-        RawMidiEvent* const bankEvent(new RawMidiEvent());
-        bankEvent->time    = time;
-        bankEvent->size    = 3;
-        bankEvent->data[0] = uint8_t(MIDI_STATUS_CONTROL_CHANGE | (channel & MIDI_CHANNEL_BIT));
-        bankEvent->data[1] = MIDI_CONTROL_BANK_SELECT;
-        bankEvent->data[2] = bank;
-
-        RawMidiEvent* const programEvent(new RawMidiEvent());
-        programEvent->time    = time;
-        programEvent->size    = 2;
-        programEvent->data[0] = uint8_t(MIDI_STATUS_PROGRAM_CHANGE | (channel & MIDI_CHANNEL_BIT));
-        programEvent->data[1] = program;
+        RawMidiEvent bankEvent;
+        bankEvent.time    = time;
+        bankEvent.size    = 3;
+        bankEvent.data[0] = uint8_t(MIDI_STATUS_CONTROL_CHANGE | (channel & MIDI_CHANNEL_BIT));
+        bankEvent.data[1] = MIDI_CONTROL_BANK_SELECT;
+        bankEvent.data[2] = bank;
+        bankEvent.data[3] = 0;
+
+        RawMidiEvent programEvent;
+        programEvent.time    = time;
+        programEvent.size    = 2;
+        programEvent.data[0] = uint8_t(MIDI_STATUS_PROGRAM_CHANGE | (channel & MIDI_CHANNEL_BIT));
+        programEvent.data[1] = program;
+        programEvent.data[2] = 0;
+        programEvent.data[3] = 0;
+
+        const ScopedBatch sb(*this);
 
         appendSorted(bankEvent);
         appendSorted(programEvent);
@@ -157,23 +218,27 @@ public:
 
     void addPitchbend(const uint64_t time, const uint8_t channel, const uint8_t lsb, const uint8_t msb)
     {
-        RawMidiEvent* const pressureEvent(new RawMidiEvent());
-        pressureEvent->time    = time;
-        pressureEvent->size    = 3;
-        pressureEvent->data[0] = uint8_t(MIDI_STATUS_PITCH_WHEEL_CONTROL | (channel & MIDI_CHANNEL_BIT));
-        pressureEvent->data[1] = lsb;
-        pressureEvent->data[2] = msb;
+        RawMidiEvent pressureEvent;
+        pressureEvent.time    = time;
+        pressureEvent.size    = 3;
+        pressureEvent.data[0] = uint8_t(MIDI_STATUS_PITCH_WHEEL_CONTROL | (channel & MIDI_CHANNEL_BIT));
+        pressureEvent.data[1] = lsb;
+        pressureEvent.data[2] = msb;
+        pressureEvent.data[3] = 0;
 
         appendSorted(pressureEvent);
     }
 
     void addRaw(const uint64_t time, const uint8_t* const data, const uint8_t size)
     {
-        RawMidiEvent* const rawEvent(new RawMidiEvent());
-        rawEvent->time = time;
-        rawEvent->size = size;
+        CARLA_SAFE_ASSERT_RETURN(size > 0 && size <= MAX_EVENT_DATA_SIZE,);
 
-        carla_copy<uint8_t>(rawEvent->data, data, size);
+        RawMidiEvent rawEvent;
+        carla_zeroStruct(rawEvent);
+        rawEvent.time = time;
+        rawEvent.size = size;
+
+        carla_copy<uint8_t>(rawEvent.data, data, size);
 
         appendSorted(rawEvent);
     }
@@ -185,21 +250,19 @@ public:
     {
         const CarlaMutexLocker sl(fMutex);
 
-        for (LinkedList<const RawMidiEvent*>::Itenerator it = fData.begin2(); it.valid(); it.next())
+        const std::pair<std::vector<RawMidiEvent>::iterator, std::vector<RawMidiEvent>::iterator> range(std::equal_range(fData.begin(), fData.end(), time));
+
+        for (std::vector<RawMidiEvent>::iterator it = range.first; it != range.second; ++it)
         {
-            const RawMidiEvent* const rawMidiEvent(it.getValue(nullptr));
-            CARLA_SAFE_ASSERT_CONTINUE(rawMidiEvent != nullptr);
+            const RawMidiEvent& rawMidiEvent(*it);
 
-            if (rawMidiEvent->time != time)
+            if (rawMidiEvent.size != size)
                 continue;
-            if (rawMidiEvent->size != size)
+            if (std::memcmp(rawMidiEvent.data, data, size) != 0)
                 continue;
-            if (std::memcmp(rawMidiEvent->data, data, size) != 0)
-                continue;
-
-            delete rawMidiEvent;
-            fData.remove(it);
 
+            fData.erase(it);
+            _publishIfNeeded();
             return;
         }
 
@@ -209,18 +272,44 @@ public:
     // -------------------------------------------------------------------
     // clear
 
-    void clear() noexcept
+    void clear()
     {
         const CarlaMutexLocker sl(fMutex);
 
-        for (LinkedList<const RawMidiEvent*>::Itenerator it = fData.begin2(); it.valid(); it.next())
-            delete it.getValue(nullptr);
-
         fData.clear();
+        _publishIfNeeded();
     }
 
     // -------------------------------------------------------------------
-    // play on time
+    // group several edits into a single update of the playing events
+
+    class ScopedBatch
+    {
+    public:
+        ScopedBatch(MidiPattern& pattern)
+            : fPattern(pattern)
+        {
+            const CarlaMutexLocker sl(fPattern.fMutex);
+            ++fPattern.fBatchDepth;
+        }
+
+        ~ScopedBatch()
+        {
+            const CarlaMutexLocker sl(fPattern.fMutex);
+
+            if (--fPattern.fBatchDepth == 0)
+                fPattern._publishIfNeeded();
+        }
+
+    private:
+        MidiPattern& fPattern;
+
+        CARLA_PREVENT_HEAP_ALLOCATION
+        CARLA_DECLARE_NON_COPY_CLASS(ScopedBatch)
+    };
+
+    // -------------------------------------------------------------------
+    // play on time, must only be called from the audio thread
 
     void play(const uint64_t timePosFrame, const uint32_t frames)
     {
@@ -229,26 +318,36 @@ public:
 
     void play(long double timePosFrame, const double frames)
     {
-        if (! fMutex.tryLock())
+        _adoptPendingData();
+
+        const RawMidiEventList* const list(fActive);
+
+        if (list == nullptr || list->count == 0)
             return;
 
         if (fStartTime != 0)
             timePosFrame += static_cast<long double>(fStartTime);
 
-        for (LinkedList<const RawMidiEvent*>::Itenerator it = fData.begin2(); it.valid(); it.next())
+        // continue from where the last block ended, otherwise find the first event in range
+        if (timePosFrame != fCursorTime || fCursor > list->count)
         {
-            const RawMidiEvent* const rawMidiEvent(it.getValue(nullptr));
-            CARLA_SAFE_ASSERT_CONTINUE(rawMidiEvent != nullptr);
+            const uint64_t startTime(static_cast<uint64_t>(std::ceil(timePosFrame)));
+            fCursor = static_cast<std::size_t>(std::lower_bound(list->events, list->events + list->count, startTime) - list->events);
+        }
 
-            if (timePosFrame > rawMidiEvent->time)
-                continue;
-            if (timePosFrame + frames <= rawMidiEvent->time)
-                continue;
+        const long double endTime(timePosFrame + frames);
 
-            kPlayer->writeMidiEvent(fMidiPort, static_cast<long double>(rawMidiEvent->time)-timePosFrame, rawMidiEvent);
+        for (; fCursor < list->count; ++fCursor)
+        {
+            const RawMidiEvent& rawMidiEvent(list->events[fCursor]);
+
+            if (endTime <= rawMidiEvent.time)
+                break;
+
+            kPlayer->writeMidiEvent(fMidiPort, static_cast<long double>(rawMidiEvent.time)-timePosFrame, &rawMidiEvent);
         }
 
-        fMutex.unlock();
+        fCursorTime = endTime;
     }
 
     // -------------------------------------------------------------------
@@ -272,9 +371,10 @@ public:
         return fMutex;
     }
 
-    LinkedList<const RawMidiEvent*>::Itenerator iteneratorBegin() const noexcept
+    // must be called with the lock held
+    const std::vector<RawMidiEvent>& getEvents() const noexcept
     {
-        return fData.begin2();
+        return fData;
     }
 
     // -------------------------------------------------------------------
@@ -288,31 +388,30 @@ public:
 
         const CarlaMutexLocker sl(fMutex);
 
-        if (fData.count() == 0)
+        if (fData.size() == 0)
             return nullptr;
 
-        char* const data((char*)std::calloc(1, fData.count()*maxMsgSize));
+        char* const data((char*)std::calloc(1, fData.size()*maxMsgSize));
         CARLA_SAFE_ASSERT_RETURN(data != nullptr, nullptr);
 
         char* dataWrtn = data;
         int wrtn;
 
-        for (LinkedList<const RawMidiEvent*>::Itenerator it = fData.begin2(); it.valid(); it.next())
+        for (std::vector<RawMidiEvent>::const_iterator it = fData.begin(), end = fData.end(); it != end; ++it)
         {
-            const RawMidiEvent* const rawMidiEvent(it.getValue(nullptr));
-            CARLA_SAFE_ASSERT_CONTINUE(rawMidiEvent != nullptr);
+            const RawMidiEvent& rawMidiEvent(*it);
 
-            wrtn = std::snprintf(dataWrtn, maxTimeSize+4, P_INT64 ":%i:", rawMidiEvent->time, rawMidiEvent->size);
+            wrtn = std::snprintf(dataWrtn, maxTimeSize+4, P_INT64 ":%i:", rawMidiEvent.time, rawMidiEvent.size);
             CARLA_SAFE_ASSERT_BREAK(wrtn > 0);
             dataWrtn += wrtn;
 
-            wrtn = std::snprintf(dataWrtn, 5, "0x%02X", rawMidiEvent->data[0]);
+            wrtn = std::snprintf(dataWrtn, 5, "0x%02X", rawMidiEvent.data[0]);
             CARLA_SAFE_ASSERT_BREAK(wrtn > 0);
             dataWrtn += wrtn;
 
-            for (uint8_t i=1, size=rawMidiEvent->size; i<size; ++i)
+            for (uint8_t i=1, size=rawMidiEvent.size; i<size; ++i)
             {
-                wrtn = std::snprintf(dataWrtn, 5, ":%03u", rawMidiEvent->data[i]);
+                wrtn = std::snprintf(dataWrtn, 5, ":%03u", rawMidiEvent.data[i]);
                 CARLA_SAFE_ASSERT_BREAK(wrtn > 0);
                 dataWrtn += wrtn;
             }
@@ -335,6 +434,8 @@ public:
         char    tmpBuf[24];
         ssize_t tmpSize;
 
+        const ScopedBatch sb(*this);
+
         clear();
 
         const CarlaMutexLocker sl(fMutex);
@@ -407,9 +508,7 @@ public:
             for (int i=size; i<MAX_EVENT_DATA_SIZE; ++i)
                 midiEvent.data[i] = 0;
 
-            RawMidiEvent* const event(new RawMidiEvent());
-            carla_copyStruct(*event, midiEvent);
-            fData.append(event);
+            fData.insert(std::upper_bound(fData.begin(), fData.end(), midiEvent.time), midiEvent);
         }
     }
 
@@ -421,32 +520,73 @@ private:
     uint8_t  fMidiPort;
     uint64_t fStartTime;
 
+    // editing side, protected by the mutex
     CarlaMutex fMutex;
-    LinkedList<const RawMidiEvent*> fData;
+    std::vector<RawMidiEvent> fData;
+    uint fBatchDepth;
+
+    // lists handed over to the audio thread, and the ones it is done with
+    RawMidiEventList* fPending;
+    RawMidiEventList* fGarbage;
 
-    void appendSorted(const RawMidiEvent* const event)
+    // audio thread only
+    RawMidiEventList* fActive;
+    std::size_t fCursor;
+    long double fCursorTime;
+
+    void appendSorted(const RawMidiEvent& event)
     {
         const CarlaMutexLocker sl(fMutex);
 
-        if (fData.isEmpty())
-        {
-            fData.append(event);
+        // after any events with the same time
+        fData.insert(std::upper_bound(fData.begin(), fData.end(), event.time), event);
+        _publishIfNeeded();
+    }
+
+    // copy-on-write update of the playing events, must be called with the lock held
+    void _publishIfNeeded()
+    {
+        if (fBatchDepth != 0)
             return;
-        }
 
-        for (LinkedList<const RawMidiEvent*>::Itenerator it = fData.begin2(); it.valid(); it.next())
+        _deleteGarbage();
+
+        RawMidiEventList* const list(new RawMidiEventList(fData));
+
+        // a list that was never picked up by the audio thread can be deleted right away
+        delete __atomic_exchange_n(&fPending, list, __ATOMIC_ACQ_REL);
+    }
+
+    void _deleteGarbage() noexcept
+    {
+        for (RawMidiEventList* list = __atomic_exchange_n(&fGarbage, (RawMidiEventList*)nullptr, __ATOMIC_ACQUIRE); list != nullptr;)
         {
-            const RawMidiEvent* const oldEvent(it.getValue(nullptr));
-            CARLA_SAFE_ASSERT_CONTINUE(oldEvent != nullptr);
+            RawMidiEventList* const next(list->next);
+            delete list;
+            list = next;
+        }
+    }
 
-            if (event->time >= oldEvent->time)
-                continue;
+    void _adoptPendingData() noexcept
+    {
+        RawMidiEventList* const list(__atomic_exchange_n(&fPending, (RawMidiEventList*)nullptr, __ATOMIC_ACQ_REL));
 
-            fData.insertAt(event, it);
+        if (list == nullptr)
             return;
+
+        // hand the old list back to the editing side, it gets deleted on the next edit
+        if (RawMidiEventList* const old = fActive)
+        {
+            RawMidiEventList* head(__atomic_load_n(&fGarbage, __ATOMIC_RELAXED));
+
+            do {
+                old->next = head;
+            } while (! __atomic_compare_exchange_n(&fGarbage, &head, old, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
         }
 
-        fData.append(event);
+        fActive     = list;
+        fCursor     = 0;
+        fCursorTime = -1.0;
     }
 
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiPattern)
@@ -139,6 +139,8 @@ private:
 
     void _loadMidiFile(const char* const filename)
     {
+        const MidiPattern::ScopedBatch sb(fMidiOut);
+
         fMidiOut.clear();
 
         using namespace juce;
@@ -441,22 +441,23 @@ private:
 
         writeMessage("midi-clear-all\n", 15);
 
-        for (LinkedList<const RawMidiEvent*>::Itenerator it = fMidiOut.iteneratorBegin(); it.valid(); it.next())
+        const std::vector<RawMidiEvent>& events(fMidiOut.getEvents());
+
+        for (std::vector<RawMidiEvent>::const_iterator it = events.begin(), end = events.end(); it != end; ++it)
         {
-            const RawMidiEvent* const rawMidiEvent(it.getValue(nullptr));
-            CARLA_SAFE_ASSERT_CONTINUE(rawMidiEvent != nullptr);
+            const RawMidiEvent& rawMidiEvent(*it);
 
             writeMessage("midievent-add\n", 14);
 
-            std::snprintf(strBuf, 0xff, P_INT64 "\n", rawMidiEvent->time);
+            std::snprintf(strBuf, 0xff, P_INT64 "\n", rawMidiEvent.time);
             writeMessage(strBuf);
 
-            std::snprintf(strBuf, 0xff, "%i\n", rawMidiEvent->size);
+            std::snprintf(strBuf, 0xff, "%i\n", rawMidiEvent.size);
             writeMessage(strBuf);
 
-            for (uint8_t i=0, size=rawMidiEvent->size; i<size; ++i)
+            for (uint8_t i=0, size=rawMidiEvent.size; i<size; ++i)
             {
-                std::snprintf(strBuf, 0xff, "%i\n", rawMidiEvent->data[i]);
+                std::snprintf(strBuf, 0xff, "%i\n", rawMidiEvent.data[i]);
                 writeMessage(strBuf);
             }
         }
@@ -0,0 +1,194 @@
+/*
+ * Carla Tests
+ * Copyright (C) 2015 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#include "CarlaBase64Utils.hpp"
+#include "CarlaString.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+// -----------------------------------------------------------------------
+// RFC 4648 test vectors
+
+static const char* const kVectors[][2] = {
+    { "",       ""         },
+    { "f",      "Zg=="     },
+    { "fo",     "Zm8="     },
+    { "foo",    "Zm9v"     },
+    { "foob",   "Zm9vYg==" },
+    { "fooba",  "Zm9vYmE=" },
+    { "foobar", "Zm9vYmFy" }
+};
+
+static const std::size_t kVectorCount = sizeof(kVectors)/sizeof(kVectors[0]);
+
+static double getSeconds() noexcept
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec)/1000000000.0;
+}
+
+static void testVectors()
+{
+    char text[16];
+    uint8_t data[16];
+
+    for (std::size_t i=0; i < kVectorCount; ++i)
+    {
+        const std::size_t dataSize(std::strlen(kVectors[i][0]));
+        const std::size_t textSize(std::strlen(kVectors[i][1]));
+
+        assert(carla_base64EncodedSize(dataSize) == textSize);
+        assert(carla_base64Encode(kVectors[i][0], dataSize, text) == textSize);
+        assert(std::strncmp(text, kVectors[i][1], textSize) == 0);
+
+        assert(carla_base64Decode(kVectors[i][1], textSize, data) == dataSize);
+        assert(std::memcmp(data, kVectors[i][0], dataSize) == 0);
+
+        const CarlaString str(CarlaString::asBase64(kVectors[i][0], dataSize));
+        assert(str == kVectors[i][1]);
+    }
+
+    // whitespace is skipped, padding and null end the data
+    const char* const spaced = " Zm9v\nYmFy\r\n\tZg== Zm9v";
+    assert(carla_base64Decode(spaced, std::strlen(spaced), data) == 7);
+    assert(std::memcmp(data, "foobarf", 7) == 0);
+
+    const std::vector<uint8_t> chunk(carla_getChunkFromBase64String("Zm9vYmE"));
+    assert(chunk.size() == 5);
+    assert(std::memcmp(chunk.data(), "fooba", 5) == 0);
+
+    // invalid characters are flagged
+    CarlaBase64Decoder decoder;
+    assert(decoder.decode("Zm9v", 4, data) == 3);
+    assert(! decoder.hasError());
+    assert(decoder.decode("Y*mFy", 5, data) == 3);
+    assert(decoder.hasError());
+    assert(std::memcmp(data, "bar", 3) == 0);
+}
+
+// -----------------------------------------------------------------------
+// random data in random pieces must match the one-shot calls
+
+static void testStreaming()
+{
+    std::srand(1);
+
+    for (uint i=0; i < 200; ++i)
+    {
+        const std::size_t dataSize(static_cast<std::size_t>(std::rand() % 5000));
+        const std::size_t textSize(carla_base64EncodedSize(dataSize));
+
+        std::vector<uint8_t> data(dataSize+1), decoded(dataSize+3);
+        std::vector<char> text(textSize+1), streamed(textSize+8);
+
+        for (std::size_t j=0; j < dataSize; ++j)
+            data[j] = static_cast<uint8_t>(std::rand());
+
+        assert(carla_base64Encode(data.data(), dataSize, text.data()) == textSize);
+
+        CarlaBase64Encoder encoder;
+        std::size_t pos = 0;
+
+        for (std::size_t offset=0; offset < dataSize;)
+        {
+            const std::size_t size(std::min<std::size_t>(dataSize - offset, static_cast<std::size_t>(std::rand() % 70)));
+            pos += encoder.encode(data.data() + offset, size, streamed.data() + pos);
+            offset += size;
+        }
+
+        pos += encoder.finish(streamed.data() + pos);
+
+        assert(pos == textSize);
+        assert(std::memcmp(text.data(), streamed.data(), textSize) == 0);
+
+        CarlaBase64Decoder decoder;
+        pos = 0;
+
+        for (std::size_t offset=0; offset < textSize;)
+        {
+            const std::size_t size(std::min<std::size_t>(textSize - offset, static_cast<std::size_t>(std::rand() % 70)));
+            pos += decoder.decode(text.data() + offset, size, decoded.data() + pos);
+            offset += size;
+        }
+
+        pos += decoder.finish(decoded.data() + pos);
+
+        assert(! decoder.hasError());
+        assert(pos == dataSize);
+        assert(std::memcmp(data.data(), decoded.data(), dataSize) == 0);
+    }
+}
+
+// -----------------------------------------------------------------------
+// throughput, size in MiB can be given as argument
+
+static void benchmark(const std::size_t dataSize)
+{
+    const std::size_t textSize(carla_base64EncodedSize(dataSize));
+
+    std::vector<uint8_t> data(dataSize), decoded(carla_base64DecodedMaxSize(textSize));
+    std::vector<char> text(textSize+1);
+
+    for (std::size_t i=0; i < dataSize; ++i)
+        data[i] = static_cast<uint8_t>(i * 7 + (i >> 8));
+
+    const double mib(static_cast<double>(dataSize)/(1024.0*1024.0));
+
+    double start(getSeconds());
+    const std::size_t encodedSize(carla_base64Encode(data.data(), dataSize, text.data()));
+    const double encodeTime(getSeconds() - start);
+
+    start = getSeconds();
+    const std::size_t decodedSize(carla_base64Decode(text.data(), encodedSize, decoded.data()));
+    const double decodeTime(getSeconds() - start);
+
+    assert(decodedSize == dataSize);
+    assert(std::memcmp(data.data(), decoded.data(), dataSize) == 0);
+
+    text[textSize] = '\0';
+
+    start = getSeconds();
+    const std::vector<uint8_t> chunk(carla_getChunkFromBase64String(text.data()));
+    const double chunkTime(getSeconds() - start);
+
+    start = getSeconds();
+    const CarlaString str(CarlaString::asBase64(data.data(), dataSize));
+    const double stringTime(getSeconds() - start);
+
+    assert(chunk.size() == dataSize);
+    assert(str.length() == textSize);
+
+    std::printf("base64 %.1f MiB:\n", mib);
+    std::printf("  encode                         %8.1f MiB/s\n", mib/encodeTime);
+    std::printf("  decode                         %8.1f MiB/s\n", mib/decodeTime);
+    std::printf("  carla_getChunkFromBase64String %8.1f MiB/s\n", mib/chunkTime);
+    std::printf("  CarlaString::asBase64          %8.1f MiB/s\n", mib/stringTime);
+}
+
+int main(int argc, char* argv[])
+{
+    testVectors();
+    testStreaming();
+
+    const int mib((argc > 1) ? std::atoi(argv[1]) : 16);
+    benchmark(static_cast<std::size_t>(mib > 0 ? mib : 16)*1024*1024);
+
+    return 0;
+}
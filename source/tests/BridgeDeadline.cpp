@@ -0,0 +1,128 @@
+/*
+ * Carla Bridge process deadline Tests
+ * Copyright (C) 2013-2014 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#undef NDEBUG
+#include "CarlaBridgeUtils.hpp"
+#include "CarlaSemUtils.hpp"
+
+#include <cassert>
+
+// -----------------------------------------------------------------------
+
+static uint64_t getTimeInUsecs()
+{
+    timespec now;
+    ::clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000 + static_cast<uint64_t>(now.tv_nsec) / 1000;
+}
+
+static void testTimeout()
+{
+    // 50% of 256 frames at 48kHz
+    assert(BridgeProcessDeadline::getTimeout(256, 48000.0, 50) == 2666);
+    assert(BridgeProcessDeadline::getTimeout(512, 44100.0, 100) == 11609);
+
+    // never a zero wait, unless there is no deadline
+    assert(BridgeProcessDeadline::getTimeout(1, 192000.0, 1) == 1);
+    assert(BridgeProcessDeadline::getTimeout(256, 48000.0, 0) == 0);
+    assert(BridgeProcessDeadline::getTimeout(0, 48000.0, 50) == 0);
+}
+
+static void testSemaphoreWait()
+{
+    carla_sem_t sem;
+    assert(carla_sem_create2(sem));
+
+    // no reply, the wait ends at the deadline and not a second later
+    const uint64_t start(getTimeInUsecs());
+    assert(! carla_sem_timedwait_usecs(sem, 2000));
+    const uint64_t elapsed(getTimeInUsecs() - start);
+    assert(elapsed >= 1900);
+    assert(elapsed < 500000);
+
+    // a reply that is already there is taken right away
+    carla_sem_post(sem);
+    assert(carla_sem_timedwait_usecs(sem, 2000));
+
+    carla_sem_destroy2(sem);
+}
+
+static void testDegrade()
+{
+    static const uint32_t kRetryBlocks = 4;
+
+    BridgeProcessDeadline deadline;
+    assert(! deadline.isDegraded());
+    assert(! deadline.takeChanged());
+
+    // single misses are not enough
+    for (uint32_t i=1; i < BridgeProcessDeadline::kMaxMisses; ++i)
+        deadline.miss();
+
+    assert(! deadline.isDegraded());
+    assert(! deadline.takeChanged());
+
+    // a met deadline resets the count
+    deadline.met();
+    assert(deadline.getMisses() == 0);
+    assert(! deadline.takeChanged());
+
+    // a busy client counts as a miss too
+    for (uint32_t i=0; i < BridgeProcessDeadline::kMaxMisses; ++i)
+        assert(! deadline.isReady(true, kRetryBlocks));
+
+    assert(deadline.isDegraded());
+    assert(deadline.getMisses() == BridgeProcessDeadline::kMaxMisses);
+
+    // reported once
+    assert(deadline.takeChanged());
+    assert(! deadline.takeChanged());
+
+    // while degraded, only one block in kRetryBlocks+1 is tried
+    assert(deadline.isReady(false, kRetryBlocks));
+
+    for (uint32_t i=0; i < kRetryBlocks; ++i)
+        assert(! deadline.isReady(false, kRetryBlocks));
+
+    assert(deadline.isReady(false, kRetryBlocks));
+
+    // still late, stays degraded and is not reported again
+    deadline.miss();
+    assert(deadline.isDegraded());
+    assert(! deadline.takeChanged());
+
+    // catching up recovers right away
+    deadline.met();
+    assert(! deadline.isDegraded());
+    assert(deadline.getMisses() == 0);
+    assert(deadline.takeChanged());
+    assert(! deadline.takeChanged());
+    assert(deadline.isReady(false, kRetryBlocks));
+    assert(deadline.isReady(false, kRetryBlocks));
+}
+
+// -----------------------------------------------------------------------
+
+int main()
+{
+    testTimeout();
+    testSemaphoreWait();
+    testDegrade();
+    return 0;
+}
+
+// -----------------------------------------------------------------------
@@ -0,0 +1,110 @@
+/*
+ * Carla Tests
+ * Copyright (C) 2013-2015 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#include "CarlaHost.h"
+#include "CarlaUtils.hpp"
+
+#include <cstdlib>
+
+CARLA_BACKEND_USE_NAMESPACE
+
+// -----------------------------------------------------------------------
+
+struct RenderResult {
+    volatile bool finished;
+    int   blocks;
+    int   xruns;
+    float load;
+};
+
+static void engineCallback(void* ptr, EngineCallbackOpcode action, uint, int value1, int value2, float value3, const char*)
+{
+    if (action != ENGINE_CALLBACK_OFFLINE_RENDER_FINISHED)
+        return;
+
+    RenderResult* const result((RenderResult*)ptr);
+    result->blocks   = value1;
+    result->xruns    = value2;
+    result->load     = value3;
+    result->finished = true;
+}
+
+// -----------------------------------------------------------------------
+// Renders a project offline with the "Offline" driver, the engine prints a report once done.
+// Rendering starts after the project is loaded and stops after exactly 'seconds' of audio.
+// Fails if more than 'max-xruns' blocks missed their deadline or the average DSP load is above 'max-load' percent.
+// usage: EngineBenchmark [project.carxp] [buffer-size] [sample-rate] [seconds] [max-xruns] [max-load] [output.wav]
+
+int main(int argc, char* argv[])
+{
+    const char* const project    = (argc > 1) ? argv[1] : nullptr;
+    const int         bufferSize = (argc > 2) ? std::atoi(argv[2]) : 512;
+    const int         sampleRate = (argc > 3) ? std::atoi(argv[3]) : 44100;
+    const int         seconds    = (argc > 4) ? std::atoi(argv[4]) : 5;
+    const int         maxXruns   = (argc > 5) ? std::atoi(argv[5]) : 0;
+    const double      maxLoad    = (argc > 6) ? std::atof(argv[6]) : 100.0;
+    const char* const output     = (argc > 7) ? argv[7] : nullptr;
+
+    CARLA_SAFE_ASSERT_RETURN(bufferSize > 0 && sampleRate > 0 && seconds > 0, 1);
+    CARLA_SAFE_ASSERT_RETURN(maxXruns >= 0 && maxLoad > 0.0, 1);
+
+    RenderResult result = { false, 0, 0, 0.0f };
+
+    carla_set_engine_callback(engineCallback, &result);
+
+    carla_set_engine_option(ENGINE_OPTION_PROCESS_MODE,          ENGINE_PROCESS_MODE_CONTINUOUS_RACK, nullptr);
+    carla_set_engine_option(ENGINE_OPTION_TRANSPORT_MODE,        ENGINE_TRANSPORT_MODE_INTERNAL,      nullptr);
+    carla_set_engine_option(ENGINE_OPTION_AUDIO_BUFFER_SIZE,     bufferSize,                          nullptr);
+    carla_set_engine_option(ENGINE_OPTION_AUDIO_SAMPLE_RATE,     sampleRate,                          nullptr);
+    carla_set_engine_option(ENGINE_OPTION_OFFLINE_RENDER_FRAMES, seconds * sampleRate,                nullptr);
+
+    if (output != nullptr)
+        carla_set_engine_option(ENGINE_OPTION_AUDIO_DEVICE, 0, output);
+
+    if (! carla_engine_init("Offline", "Carla-Benchmark"))
+    {
+        carla_stderr2("Engine failed to initialize: %s", carla_get_last_error());
+        return 1;
+    }
+
+    if (project != nullptr && ! carla_load_project(project))
+    {
+        carla_stderr2("Failed to load project: %s", carla_get_last_error());
+        carla_engine_close();
+        return 1;
+    }
+
+    carla_transport_play();
+
+    while (! result.finished)
+    {
+        carla_engine_idle();
+        carla_msleep(10);
+    }
+
+    if (! carla_engine_close())
+        return 1;
+
+    if (result.xruns > maxXruns || result.load > maxLoad)
+    {
+        carla_stderr2("Benchmark failed: %i of %i blocks missed their deadline (max %i), average DSP load %.1f%% (max %.1f%%)",
+                      result.xruns, result.blocks, maxXruns, static_cast<double>(result.load), maxLoad);
+        return 1;
+    }
+
+    return 0;
+}
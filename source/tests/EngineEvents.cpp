@@ -15,10 +15,12 @@
  * For a full copy of the GNU General Public License see the doc/GPL.txt file.
  */
 
-#include "CarlaEngine.hpp"
+#include "CarlaEngineUtils.hpp"
 #include "CarlaMIDI.h"
 #include "CarlaUtils.hpp"
 
+#include <ctime>
+
 CARLA_BACKEND_USE_NAMESPACE
 
 void testControlEventDump()
@@ -246,9 +248,106 @@ void testEventMidiFill()
     assert(e.ctrl.value == 0.0f);
 }
 
+void testEventDataArena()
+{
+    EngineEventDataArena arena;
+    assert(arena.create(16));
+
+    uint8_t data[12] = { 0xF0, 0x41, 0x10, 0x42, 0x12, 0x40, 0x00, 0x7F, 0x00, 0x41, 0x00, 0xF7 };
+
+    // long messages are copied
+    EngineEvent e;
+    assert(arena.fillFromMidiData(e, 12, data, 0));
+    assert(e.type == kEngineEventTypeMidi);
+    assert(e.midi.size == 12);
+    assert(e.midi.dataExt != nullptr && e.midi.dataExt != data);
+    assert(std::memcmp(e.midi.dataExt, data, 12) == 0);
+
+    // arena full
+    assert(! arena.fillFromMidiData(e, 12, data, 0));
+    assert(arena.copy(data, 5) == nullptr);
+
+    // short messages don't use the arena
+    assert(arena.fillFromMidiData(e, 3, data, 0));
+    assert(e.midi.dataExt == nullptr);
+
+    // reset releases everything
+    arena.reset();
+    assert(arena.copy(data, 12) == arena.buffer);
+
+    // messages longer than 255 bytes, bounded by the arena size
+    EngineEventDataArena bigArena;
+    assert(bigArena.create(2048));
+
+    uint8_t bigData[1500];
+    bigData[0] = 0xF0;
+    for (uint i=1; i < 1499; ++i)
+        bigData[i] = static_cast<uint8_t>(i & 0x7F);
+    bigData[1499] = 0xF7;
+
+    assert(bigArena.fillFromMidiData(e, 1500, bigData, 0));
+    assert(e.type == kEngineEventTypeMidi);
+    assert(e.midi.size == 1500);
+    assert(std::memcmp(e.midi.dataExt, bigData, 1500) == 0);
+
+    assert(! bigArena.fillFromMidiData(e, 1500, bigData, 0));
+}
+
+void benchEventBuffer()
+{
+    static const uint kCycles = 20000;
+    static const uint kEventsPerCycle = 64;
+
+    EngineEvent eventsIn[kMaxEngineEventInternalCount];
+    EngineEvent eventsOut[kMaxEngineEventInternalCount];
+    carla_zeroStructs(eventsIn, kMaxEngineEventInternalCount);
+    carla_zeroStructs(eventsOut, kMaxEngineEventInternalCount);
+
+    uint8_t data[3] = { MIDI_STATUS_NOTE_ON, 60, 100 };
+    uint64_t total = 0;
+
+    const std::clock_t start(std::clock());
+
+    for (uint i=0; i < kCycles; ++i)
+    {
+        // same steps as an engine cycle: reset, append, count, pass along
+        clearEngineEvents(eventsIn);
+
+        for (uint j=0; j < kEventsPerCycle; ++j)
+        {
+            EngineEvent& event(eventsIn[j]);
+            terminateEngineEvents(eventsIn, j+1);
+
+            data[1] = uint8_t(j & 0x7F);
+            event.time = j;
+            event.fillFromMidiData(3, data, 0);
+        }
+
+        const ushort count(getEngineEventCount(eventsIn));
+        assert(count == kEventsPerCycle);
+
+        copyEngineEvents(eventsOut, eventsIn);
+        assert(getEngineEventCount(eventsOut) == kEventsPerCycle);
+
+        total += count;
+    }
+
+    const double secs(double(std::clock() - start) / CLOCKS_PER_SEC);
+
+    // stale events after the terminator must not be counted
+    clearEngineEvents(eventsIn);
+    assert(getEngineEventCount(eventsIn) == 0);
+    assert(eventsIn[1].type == kEngineEventTypeMidi);
+
+    carla_stdout("event buffer: %llu events in %f secs, %f events/sec",
+                 static_cast<unsigned long long>(total), secs, secs > 0.0 ? double(total)/secs : 0.0);
+}
+
 int main()
 {
     testControlEventDump();
     testEventMidiFill();
+    testEventDataArena();
+    benchEventBuffer();
     return 0;
 }
@@ -0,0 +1,175 @@
+/*
+ * Carla Tests
+ * Copyright (C) 2015 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#include "Lv2UridMap.hpp"
+#include "CarlaThread.hpp"
+
+#include <cstdio>
+
+static const char* const kSeed[] = {
+    nullptr,
+    "urn:seed:one",
+    "urn:seed:two",
+    "urn:seed:three",
+    LV2_ATOM__Object,
+    LV2_ATOM__Sequence,
+    LV2_ATOM__URID,
+    LV2_ATOM__Int
+};
+
+static const uint32_t kSeedCount = sizeof(kSeed)/sizeof(const char*);
+static const uint32_t kThreadURIs = 3000;
+
+static bool gStartMapping = false;
+
+// -----------------------------------------------------------------------
+// maps the same URIs as other threads, results must agree
+
+class MapThread : public CarlaThread
+{
+public:
+    MapThread(Lv2UridMap& map)
+        : CarlaThread("MapThread"),
+          fMap(map),
+          fURIDs() {}
+
+    LV2_URID getURID(const uint32_t i) const noexcept
+    {
+        return fURIDs[i];
+    }
+
+protected:
+    void run() override
+    {
+        // start all threads at once
+        for (; ! __atomic_load_n(&gStartMapping, __ATOMIC_ACQUIRE);)
+            carla_msleep(1);
+
+        char uri[32];
+
+        for (uint32_t i=0; i < kThreadURIs; ++i)
+        {
+            std::snprintf(uri, 32, "urn:thread:%u", i);
+            fURIDs[i] = fMap.map(uri);
+        }
+    }
+
+private:
+    Lv2UridMap& fMap;
+    LV2_URID fURIDs[kThreadURIs];
+};
+
+int main()
+{
+    Lv2UridMap map(kSeed, kSeedCount);
+
+    // seed is pre-mapped in order
+    assert(map.getCount() == kSeedCount);
+    assert(map.map("urn:seed:one") == 1);
+    assert(map.map("urn:seed:three") == 3);
+    assert(std::strcmp(map.unmap(2), "urn:seed:two") == 0);
+
+    // invalid
+    assert(map.unmap(0) == nullptr);
+    assert(map.unmap(kSeedCount) == nullptr);
+
+    // new URIs get the next URID, mapping again is stable
+    assert(map.map("urn:new:a") == kSeedCount);
+    assert(map.map("urn:new:b") == kSeedCount+1);
+    assert(map.map("urn:new:a") == kSeedCount);
+    assert(map.getCount() == kSeedCount+2);
+    assert(std::strcmp(map.unmap(kSeedCount+1), "urn:new:b") == 0);
+
+    // concurrent mapping, crossing several table resizes and string chunks
+    MapThread t1(map), t2(map), t3(map);
+    t1.startThread(); t2.startThread(); t3.startThread();
+    __atomic_store_n(&gStartMapping, true, __ATOMIC_RELEASE);
+    t1.stopThread(-1); t2.stopThread(-1); t3.stopThread(-1);
+
+    assert(map.getCount() == kSeedCount+2+kThreadURIs);
+
+    char uri[32];
+
+    for (uint32_t i=0; i < kThreadURIs; ++i)
+    {
+        const LV2_URID urid(t1.getURID(i));
+
+        assert(urid == t2.getURID(i));
+        assert(urid == t3.getURID(i));
+
+        std::snprintf(uri, 32, "urn:thread:%u", i);
+        assert(std::strcmp(map.unmap(urid), uri) == 0);
+        assert(map.map(uri) == urid);
+    }
+
+    // another process mapped urn:new:b before urn:new:a
+    Lv2UridMap theirMap(kSeed, kSeedCount);
+    const LV2_URID theirB(theirMap.map("urn:new:b"));
+    const LV2_URID theirA(theirMap.map("urn:new:a"));
+    assert(theirB == map.map("urn:new:a"));
+
+    Lv2UridTranslation translation(map);
+    assert(translation.isEmpty());
+
+    translation.add(theirA, map.map("urn:new:a"));
+    translation.add(theirB, map.map("urn:new:b"));
+    assert(! translation.isEmpty());
+    assert(translation.translate(theirA) == map.map("urn:new:a"));
+    assert(translation.translate(theirB) == map.map("urn:new:b"));
+    assert(translation.translate(1) == 1);
+
+    // sequence with an object event, whose property values are an URID and an int
+    struct {
+        LV2_Atom_Sequence seq;
+        LV2_Atom_Event event;
+        LV2_Atom_Object_Body obody;
+        LV2_Atom_Property_Body prop1;
+        LV2_URID prop1Value, prop1Pad;
+        LV2_Atom_Property_Body prop2;
+        int32_t prop2Value, prop2Pad;
+    } msg;
+
+    carla_zeroStruct(msg);
+    msg.seq.atom.type = map.map(LV2_ATOM__Sequence);
+    msg.seq.atom.size = sizeof(msg) - sizeof(LV2_Atom);
+    msg.event.body.type = map.map(LV2_ATOM__Object);
+    msg.event.body.size = sizeof(msg) - sizeof(LV2_Atom_Sequence) - sizeof(LV2_Atom_Event);
+    msg.obody.otype = theirA;
+    msg.prop1.key = theirB;
+    msg.prop1.value.type = map.map(LV2_ATOM__URID);
+    msg.prop1.value.size = sizeof(LV2_URID);
+    msg.prop1Value = theirA;
+    msg.prop2.key = theirA;
+    msg.prop2.value.type = map.map(LV2_ATOM__Int);
+    msg.prop2.value.size = sizeof(int32_t);
+    msg.prop2Value = static_cast<int32_t>(theirB);
+
+    assert(translation.translateAtom(&msg.seq.atom, sizeof(msg)));
+    assert(msg.obody.otype == map.map("urn:new:a"));
+    assert(msg.prop1.key == map.map("urn:new:b"));
+    assert(msg.prop1Value == map.map("urn:new:a"));
+    assert(msg.prop2.key == map.map("urn:new:a"));
+    assert(msg.prop2Value == static_cast<int32_t>(theirB));
+
+    // sizes that go past the buffer are refused
+    msg.event.body.size += 64;
+    assert(! translation.translateAtom(&msg.seq.atom, sizeof(msg)));
+    msg.seq.atom.size += 64;
+    assert(! translation.translateAtom(&msg.seq.atom, sizeof(msg)));
+
+    return 0;
+}
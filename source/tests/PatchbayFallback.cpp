@@ -0,0 +1,99 @@
+/*
+ * Carla Patchbay render fallback Tests
+ * Copyright (C) 2013-2014 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#undef NDEBUG
+#include "CarlaEngineUtils.hpp"
+
+#include <cassert>
+
+CARLA_BACKEND_USE_NAMESPACE
+
+// -----------------------------------------------------------------------
+
+static void testRenderMode()
+{
+    // nothing the plan is needed for, the JUCE graph is used
+    assert(getPatchbayRenderMode(true,  false, 0) == kPatchbayRenderGraph);
+    assert(getPatchbayRenderMode(false, false, 0) == kPatchbayRenderGraph);
+
+    // workers or bridges
+    assert(getPatchbayRenderMode(true, true, 0) == kPatchbayRenderPlan);
+
+    // latency compensation, with or without workers
+    assert(getPatchbayRenderMode(true, false, 64)  == kPatchbayRenderPlan);
+    assert(getPatchbayRenderMode(true, true,  512) == kPatchbayRenderPlan);
+
+    // plan busy or being rebuilt, the uncompensated graph is never used then
+    assert(getPatchbayRenderMode(false, false, 64) == kPatchbayRenderSilence);
+    assert(getPatchbayRenderMode(false, false, 1)  == kPatchbayRenderSilence);
+}
+
+static void testSilentBlock()
+{
+    const int numFrames = 256;
+
+    juce::AudioSampleBuffer audio(3, numFrames);
+    juce::MidiBuffer midi;
+
+    for (int i=0; i<audio.getNumChannels(); ++i)
+    {
+        for (int j=0; j<numFrames; ++j)
+            audio.setSample(i, j, 0.5f);
+    }
+
+    const uint8_t noteOn[3] = { 0x90, 60, 100 };
+    midi.addEvent(noteOn, 3, 0);
+    midi.addEvent(noteOn, 3, numFrames-1);
+
+    // the graph input is still in the buffers when the plan can't be used
+    if (getPatchbayRenderMode(false, true, 128) == kPatchbayRenderSilence)
+        clearPatchbayBlock(audio, midi, numFrames);
+
+    for (int i=0; i<audio.getNumChannels(); ++i)
+    {
+        for (int j=0; j<numFrames; ++j)
+            assert(audio.getSample(i, j) == 0.0f);
+    }
+
+    assert(midi.isEmpty());
+
+    // only the block frames are touched
+    juce::AudioSampleBuffer bigger(1, numFrames*2);
+    juce::MidiBuffer none;
+
+    for (int j=0; j<numFrames*2; ++j)
+        bigger.setSample(0, j, 1.0f);
+
+    clearPatchbayBlock(bigger, none, numFrames);
+
+    assert(bigger.getSample(0, 0) == 0.0f);
+    assert(bigger.getSample(0, numFrames-1) == 0.0f);
+    assert(bigger.getSample(0, numFrames) == 1.0f);
+    assert(bigger.getSample(0, numFrames*2-1) == 1.0f);
+}
+
+// -----------------------------------------------------------------------
+
+int main()
+{
+    testRenderMode();
+    testSilentBlock();
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------
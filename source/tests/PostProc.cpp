@@ -0,0 +1,311 @@
+/*
+ * Carla Tests
+ * Copyright (C) 2015 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#include "CarlaPostProcUtils.hpp"
+
+#include <cmath>
+#include <ctime>
+
+static const uint32_t kFrames = 512;
+
+// -----------------------------------------------------------------------
+
+static double getSeconds() noexcept
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec)/1000000000.0;
+}
+
+static bool isClose(const float v1, const float v2) noexcept
+{
+    return std::abs(v1-v2) < 1e-5f;
+}
+
+static void fillNoise(float* const buffer, const uint32_t frames)
+{
+    for (uint32_t k=0; k < frames; ++k)
+        buffer[k] = static_cast<float>(std::rand())/static_cast<float>(RAND_MAX)*2.0f - 1.0f;
+}
+
+// -----------------------------------------------------------------------
+// the per-sample stereo post-processing the plugins used to have, used as reference
+
+static void referencePostProc(const float* const dry[2], const float* const wet[2], float* const out[2], const uint32_t frames,
+                              const float dryWet, const float volume, const float balanceLeft, const float balanceRight)
+{
+    const float balRangeL = (balanceLeft  + 1.0f)/2.0f;
+    const float balRangeR = (balanceRight + 1.0f)/2.0f;
+
+    for (uint32_t k=0; k < frames; ++k)
+    {
+        const float l = (wet[0][k] * dryWet) + (dry[0][k] * (1.0f - dryWet));
+        const float r = (wet[1][k] * dryWet) + (dry[1][k] * (1.0f - dryWet));
+
+        out[0][k] = (l * (1.0f - balRangeL) + r * (1.0f - balRangeR)) * volume;
+        out[1][k] = (r * balRangeR + l * balRangeL) * volume;
+    }
+}
+
+static CarlaPostProcBuffers makeBuffers(const float* const* const dry, const float* const* const wet, float* const* const out)
+{
+    CarlaPostProcBuffers buf;
+    buf.dry           = dry;
+    buf.dryChannels   = 2;
+    buf.delayed       = nullptr;
+    buf.delayedFrames = 0;
+    buf.wet           = wet;
+    buf.out           = out;
+    buf.outChannels   = 2;
+    buf.inOffset      = 0;
+    buf.outOffset     = 0;
+    return buf;
+}
+
+// -----------------------------------------------------------------------
+// steady values match the reference, the first block ramps into them
+
+static void testSteady()
+{
+    float dryL[kFrames], dryR[kFrames], wetL[kFrames], wetR[kFrames];
+    float outL[kFrames], outR[kFrames], refL[kFrames], refR[kFrames];
+
+    fillNoise(dryL, kFrames);
+    fillNoise(dryR, kFrames);
+    fillNoise(wetL, kFrames);
+    fillNoise(wetR, kFrames);
+
+    const float* const dry[2] = { dryL, dryR };
+    const float* const wet[2] = { wetL, wetR };
+    float* const out[2] = { outL, outR };
+    float* const ref[2] = { refL, refR };
+
+    const CarlaPostProcBuffers buf(makeBuffers(dry, wet, out));
+
+    CarlaPostProcGains current, target;
+    target.set(0.3f, 0.7f, -0.5f, 0.25f, 0.0f);
+
+    // ramp block starts at the neutral gains
+    carla_postProcess(buf, current, target, kFrames);
+    assert(isClose(outL[0], wetL[0]));
+    assert(isClose(outR[0], wetR[0]));
+
+    // then it stays at the target
+    carla_postProcess(buf, current, target, kFrames);
+    referencePostProc(dry, wet, ref, kFrames, 0.3f, 0.7f, -0.5f, 0.25f);
+
+    for (uint32_t k=0; k < kFrames; ++k)
+    {
+        assert(isClose(outL[k], refL[k]));
+        assert(isClose(outR[k], refR[k]));
+    }
+
+    // odd frame count goes through the scalar tail
+    carla_postProcess(buf, current, target, 13);
+
+    for (uint32_t k=0; k < 13; ++k)
+    {
+        assert(isClose(outL[k], refL[k]));
+        assert(isClose(outR[k], refR[k]));
+    }
+}
+
+// -----------------------------------------------------------------------
+// gain changes are linear over one block, without jumps
+
+static void testRamp()
+{
+    float ones[kFrames], zeros[kFrames], outL[kFrames], outR[kFrames];
+
+    for (uint32_t k=0; k < kFrames; ++k)
+    {
+        ones[k]  = 1.0f;
+        zeros[k] = 0.0f;
+    }
+
+    const float* const dry[2] = { zeros, zeros };
+    const float* const wet[2] = { ones, ones };
+    float* const out[2] = { outL, outR };
+
+    const CarlaPostProcBuffers buf(makeBuffers(dry, wet, out));
+
+    CarlaPostProcGains current, target;
+    target.set(1.0f, 0.0f, -1.0f, 1.0f, 0.0f);
+
+    carla_postProcess(buf, current, target, kFrames);
+
+    for (uint32_t k=0; k < kFrames; ++k)
+    {
+        const float expected = 1.0f - static_cast<float>(k)/static_cast<float>(kFrames);
+        assert(isClose(outL[k], expected));
+        assert(isClose(outR[k], expected));
+    }
+
+    // and go back from where it stopped
+    target.set(1.0f, 1.0f, -1.0f, 1.0f, 0.0f);
+    carla_postProcess(buf, current, target, kFrames);
+    assert(isClose(outL[0], 0.0f));
+    assert(isClose(outL[kFrames-1], 1.0f - 1.0f/static_cast<float>(kFrames)));
+}
+
+// -----------------------------------------------------------------------
+// dry signal older than the block comes from the delayed buffers
+
+static void testLatency()
+{
+    const uint32_t latency = 100;
+
+    float in[kFrames], delayed[latency], silence[kFrames], out[kFrames];
+
+    for (uint32_t k=0; k < kFrames; ++k)
+    {
+        in[k]      = static_cast<float>(k);
+        silence[k] = 0.0f;
+    }
+
+    for (uint32_t k=0; k < latency; ++k)
+        delayed[k] = -static_cast<float>(k);
+
+    const float* const dry[1]     = { in };
+    const float* const dryOld[1]  = { delayed };
+    const float* const wet[1]     = { silence };
+    float* const outBufs[1]       = { out };
+
+    CarlaPostProcBuffers buf;
+    buf.dry           = dry;
+    buf.dryChannels   = 1;
+    buf.delayed       = dryOld;
+    buf.delayedFrames = latency;
+    buf.wet           = wet;
+    buf.out           = outBufs;
+    buf.outChannels   = 1;
+    buf.inOffset      = 0;
+    buf.outOffset     = 0;
+
+    CarlaPostProcGains current, target;
+    current.set(0.0f, 1.0f, -1.0f, 1.0f, 0.0f);
+    target.set(0.0f, 1.0f, -1.0f, 1.0f, 0.0f);
+
+    carla_postProcess(buf, current, target, kFrames);
+
+    for (uint32_t k=0; k < latency; ++k)
+        assert(isClose(out[k], delayed[k]));
+
+    for (uint32_t k=latency; k < kFrames; ++k)
+        assert(isClose(out[k], in[k-latency]));
+}
+
+// -----------------------------------------------------------------------
+// neutral values only copy, or do nothing when in-place
+
+static void testNeutral()
+{
+    float in[kFrames], out[kFrames];
+
+    fillNoise(in, kFrames);
+
+    const float* const wet[1] = { in };
+    float* const outBufs[1] = { out };
+    float* const inPlace[1] = { in };
+
+    CarlaPostProcBuffers buf(makeBuffers(nullptr, wet, outBufs));
+    buf.dryChannels = 0;
+    buf.outChannels = 1;
+
+    CarlaPostProcGains current, target;
+    carla_postProcess(buf, current, target, kFrames);
+    assert(std::memcmp(in, out, sizeof(float)*kFrames) == 0);
+
+    buf.out = inPlace;
+    carla_postProcess(buf, current, target, kFrames);
+    assert(std::memcmp(in, out, sizeof(float)*kFrames) == 0);
+}
+
+// -----------------------------------------------------------------------
+// cycles for a stereo plugin, iterations can be given as argument
+
+static void benchmark(const uint iterations)
+{
+    float dryL[kFrames], dryR[kFrames], wetL[kFrames], wetR[kFrames], outL[kFrames], outR[kFrames];
+
+    fillNoise(dryL, kFrames);
+    fillNoise(dryR, kFrames);
+    fillNoise(wetL, kFrames);
+    fillNoise(wetR, kFrames);
+
+    const float* const dry[2] = { dryL, dryR };
+    const float* const wet[2] = { wetL, wetR };
+    float* const out[2] = { outL, outR };
+
+    const CarlaPostProcBuffers buf(makeBuffers(dry, wet, out));
+
+    double start = getSeconds();
+
+    for (uint i=0; i < iterations; ++i)
+        referencePostProc(dry, wet, out, kFrames, 0.5f, 0.8f, -0.5f, 0.5f);
+
+    const double refTime = getSeconds() - start;
+
+    CarlaPostProcGains current, target;
+    target.set(0.5f, 0.8f, -0.5f, 0.5f, 0.0f);
+    start = getSeconds();
+
+    for (uint i=0; i < iterations; ++i)
+        carla_postProcess(buf, current, target, kFrames);
+
+    const double steadyTime = getSeconds() - start;
+    start = getSeconds();
+
+    for (uint i=0; i < iterations; ++i)
+    {
+        target.set(0.5f, (i % 2 == 0) ? 0.8f : 0.6f, -0.5f, 0.5f, 0.0f);
+        carla_postProcess(buf, current, target, kFrames);
+    }
+
+    const double rampTime = getSeconds() - start;
+
+    CarlaPostProcGains neutral;
+    start = getSeconds();
+
+    for (uint i=0; i < iterations; ++i)
+        carla_postProcess(buf, neutral, neutral, kFrames);
+
+    const double neutralTime = getSeconds() - start;
+
+    const double blocks = static_cast<double>(iterations);
+
+    std::printf("post-processing, stereo %u frames, %u blocks:\n", kFrames, iterations);
+    std::printf("  per-sample reference %8.1f ns/block\n", refTime*1e9/blocks);
+    std::printf("  steady               %8.1f ns/block\n", steadyTime*1e9/blocks);
+    std::printf("  ramping              %8.1f ns/block\n", rampTime*1e9/blocks);
+    std::printf("  neutral              %8.1f ns/block\n", neutralTime*1e9/blocks);
+}
+
+int main(int argc, char* argv[])
+{
+    std::srand(1);
+
+    testSteady();
+    testRamp();
+    testLatency();
+    testNeutral();
+
+    const int iterations((argc > 1) ? std::atoi(argv[1]) : 200000);
+    benchmark(static_cast<uint>(iterations > 0 ? iterations : 200000));
+
+    return 0;
+}
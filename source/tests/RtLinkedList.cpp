@@ -20,6 +20,12 @@
 #include "CarlaString.hpp"
 #include "CarlaMutex.hpp"
 
+extern "C" {
+#include "rtmempool/rtmempool.h"
+}
+
+#include <ctime>
+
 const unsigned short MIN_RT_EVENTS = 5;
 const unsigned short MAX_RT_EVENTS = 10;
 
@@ -34,8 +40,8 @@ struct PostRtEvents {
     RtLinkedList<MyData> data;
     RtLinkedList<MyData> dataPendingRT;
 
-    PostRtEvents() noexcept
-        : dataPool(MIN_RT_EVENTS, MAX_RT_EVENTS),
+    PostRtEvents(const std::size_t minPreallocated = MIN_RT_EVENTS, const std::size_t maxPreallocated = MAX_RT_EVENTS) noexcept
+        : dataPool(minPreallocated, maxPreallocated),
           data(dataPool),
           dataPendingRT(dataPool) {}
 
@@ -104,7 +110,263 @@ void run5Tests()
     }
 }
 
-int main()
+// -----------------------------------------------------------------------
+// one thread allocates like an audio thread, another one frees like the main thread
+
+static double getSeconds() noexcept
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec)/1000000000.0;
+}
+
+class RtProducerThread : public CarlaThread
+{
+public:
+    RtProducerThread(PostRtEvents& events, const int count, const int maxPending, const int& received) noexcept
+        : CarlaThread("RtProducerThread"),
+          fEvents(events),
+          fCount(count),
+          fMaxPending(maxPending),
+          fReceived(received),
+          fSent(0),
+          fFailed(0) {}
+
+    int getSentCount() const noexcept
+    {
+        return __atomic_load_n(&fSent, __ATOMIC_ACQUIRE);
+    }
+
+    int getFailedCount() const noexcept
+    {
+        return __atomic_load_n(&fFailed, __ATOMIC_ACQUIRE);
+    }
+
+protected:
+    void run() override
+    {
+        MyData my;
+        std::strcpy(my.str, "rt");
+
+        for (int i=0; i < fCount; ++i)
+        {
+            my.id = i;
+
+            // like an audio thread, never have more events pending than the pool was sized for
+            while (getSentCount() - __atomic_load_n(&fReceived, __ATOMIC_ACQUIRE) >= fMaxPending)
+            {
+                fEvents.trySplice();
+                sched_yield();
+            }
+
+            // a failed append is a lost event, not retried
+            if (fEvents.dataPendingRT.append(my))
+                __atomic_add_fetch(&fSent, 1, __ATOMIC_RELEASE);
+            else
+                __atomic_add_fetch(&fFailed, 1, __ATOMIC_RELEASE);
+
+            fEvents.trySplice();
+
+            if (i % 64 == 0)
+                sched_yield();
+        }
+
+        while (fEvents.dataPendingRT.count() > 0)
+        {
+            fEvents.trySplice();
+            sched_yield();
+        }
+    }
+
+private:
+    PostRtEvents& fEvents;
+    const int fCount;
+    const int fMaxPending;
+    const int& fReceived;
+    int fSent;
+    int fFailed;
+};
+
+static void testPostRtStress()
+{
+    const int kCount = 100000;
+
+    // the producer may also hold a full thread cache of blocks besides its pending events
+    const int kMaxPending = 128;
+    const std::size_t kPoolSize = kMaxPending + CarlaRtMemPool::kCacheSize*2;
+
+    PostRtEvents events(kPoolSize, kPoolSize);
+    int received = 0;
+
+    RtProducerThread producer(events, kCount, kMaxPending, received);
+    producer.startThread();
+
+    for (int expected = 0; received + producer.getFailedCount() < kCount;)
+    {
+        events.mutex.lock();
+
+        for (RtLinkedList<MyData>::Itenerator it = events.data.begin2(); it.valid(); it.next())
+        {
+            const MyData& my(it.getValue());
+            assert(my.id >= expected);
+            expected = my.id + 1;
+            __atomic_add_fetch(&received, 1, __ATOMIC_RELEASE);
+        }
+
+        events.data.clear();
+        events.mutex.unlock();
+
+        sched_yield();
+    }
+
+    producer.stopThread(-1);
+
+    // the pool was big enough, no event may have been lost
+    assert(producer.getFailedCount() == 0);
+    assert(events.dataPool.getMemPool().getFailedCount() == 0);
+
+    assert(producer.getSentCount() == kCount);
+    assert(events.dataPendingRT.count() == 0);
+
+    carla_stdout("Post-Rt stress: %i events, pool grew to %u blocks, %u failed allocations",
+                 received, events.dataPool.getMemPool().getTotalCount(), events.dataPool.getMemPool().getFailedCount());
+}
+
+// -----------------------------------------------------------------------
+// several threads allocating and freeing at once, blocks must never be handed out twice
+
+class PoolStressThread : public CarlaThread
+{
+public:
+    PoolStressThread(CarlaRtMemPool& pool, const int id) noexcept
+        : CarlaThread("PoolStressThread"),
+          fPool(pool),
+          fId(id) {}
+
+protected:
+    void run() override
+    {
+        int* blocks[16];
+        carla_zeroPointers(blocks, 16);
+
+        for (int i=0; i < 200000; ++i)
+        {
+            int*& block(blocks[(i * 7 + fId) % 16]);
+
+            if (block != nullptr)
+            {
+                assert(block[0] == fId && block[1] == -fId);
+                fPool.deallocate(block);
+                block = nullptr;
+            }
+            else if ((block = (int*)fPool.allocate_atomic()) != nullptr)
+            {
+                block[0] = fId;
+                block[1] = -fId;
+            }
+        }
+
+        for (int i=0; i < 16; ++i)
+        {
+            if (blocks[i] != nullptr)
+                fPool.deallocate(blocks[i]);
+        }
+
+        // odd threads leave their cache behind, the pool flushes it
+        if (fId % 2 == 0)
+            fPool.releaseThreadCache();
+    }
+
+private:
+    CarlaRtMemPool& fPool;
+    const int fId;
+};
+
+static void testPoolStress()
+{
+    CarlaRtMemPool pool(sizeof(int)*2, 32, 32);
+
+    PoolStressThread* threads[6];
+
+    // more threads than caches, so some use the shared stack directly
+    for (int i=0; i < 6; ++i)
+    {
+        threads[i] = new PoolStressThread(pool, i+1);
+        threads[i]->startThread();
+    }
+
+    for (int i=0; i < 6; ++i)
+    {
+        threads[i]->stopThread(-1);
+        delete threads[i];
+    }
+
+    carla_stdout("Pool stress: %u blocks, %u free, %u failed allocations",
+                 pool.getTotalCount(), pool.getFreeCount(), pool.getFailedCount());
+
+    // all blocks are back, either shared or in caches of finished threads
+    assert(pool.getFreeCount() <= pool.getTotalCount());
+
+    pool.flushCaches();
+    assert(pool.getFreeCount() == pool.getTotalCount());
+
+    // released caches can be claimed again and give their blocks back too
+    void* const block(pool.allocate_atomic());
+    assert(block != nullptr);
+    pool.deallocate(block);
+    assert(pool.getFreeCount() < pool.getTotalCount());
+
+    pool.releaseThreadCache();
+    assert(pool.getFreeCount() == pool.getTotalCount());
+}
+
+// -----------------------------------------------------------------------
+// allocation speed against the old pool, iteration count can be given as argument
+
+static void benchmark(const int count)
+{
+    const std::size_t dataSize(sizeof(MyData) + sizeof(void*)*2);
+    void* ptrs[8];
+
+    RtMemPool_Handle oldPool = nullptr;
+    rtsafe_memory_pool_create(&oldPool, nullptr, dataSize, 128, 128);
+    assert(oldPool != nullptr);
+
+    double start(getSeconds());
+
+    for (int i=0; i < count; ++i)
+    {
+        for (int j=0; j < 8; ++j)
+            ptrs[j] = rtsafe_memory_pool_allocate_atomic(oldPool);
+        for (int j=0; j < 8; ++j)
+            rtsafe_memory_pool_deallocate(oldPool, ptrs[j]);
+    }
+
+    const double oldTime(getSeconds() - start);
+    rtsafe_memory_pool_destroy(oldPool);
+
+    CarlaRtMemPool newPool(dataSize, 128, 128);
+
+    start = getSeconds();
+
+    for (int i=0; i < count; ++i)
+    {
+        for (int j=0; j < 8; ++j)
+            ptrs[j] = newPool.allocate_atomic();
+        for (int j=0; j < 8; ++j)
+            newPool.deallocate(ptrs[j]);
+    }
+
+    const double newTime(getSeconds() - start);
+
+    const double ops(static_cast<double>(count) * 16.0 / 1000000.0);
+
+    std::printf("memory pool, %i x 8 allocations and deallocations:\n", count);
+    std::printf("  rtmempool      %8.1f Mops/s\n", ops/oldTime);
+    std::printf("  CarlaRtMemPool %8.1f Mops/s\n", ops/newTime);
+}
+
+int main(int argc, char* argv[])
 {
     MyData m1; m1.id = 1; std::strcpy(m1.str, "1");
     MyData m2; m2.id = 2; std::strcpy(m2.str, "2");
@@ -192,5 +454,11 @@ int main()
     evIns.clear();
     evOuts.clear();
 
+    testPostRtStress();
+    testPoolStress();
+
+    const int count((argc > 1) ? std::atoi(argv[1]) : 100000);
+    benchmark(count > 0 ? count : 100000);
+
     return 0;
 }
@@ -0,0 +1,263 @@
+/*
+ * Carla State save/restore Tests
+ * Copyright (C) 2013-2014 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#undef NDEBUG
+#include "CarlaStateUtils.cpp"
+
+CARLA_BACKEND_USE_NAMESPACE
+
+// -----------------------------------------------------------------------
+
+static const std::size_t kChunkSize = 64*1024;
+static const std::size_t kValueSize = 3000;
+
+static void fillState(CarlaStateSave& state)
+{
+    state.type     = carla_strdup("LV2");
+    state.name     = carla_strdup("Test <&> plugin");
+    state.label    = carla_strdup("urn:carla:test");
+    state.active   = true;
+    state.volume   = 0.5f;
+    state.ctrlChannel = 2;
+
+    // compressible chunk
+    uint8_t* const chunk(new uint8_t[kChunkSize]);
+    for (std::size_t i=0; i < kChunkSize; ++i)
+        chunk[i] = static_cast<uint8_t>((i / 7) % 13);
+
+    state.chunk     = chunk;
+    state.chunkSize = kChunkSize;
+
+    // big value, random enough to be stored raw
+    char* const bigValue(new char[kValueSize+1]);
+    juce::Random random(1234);
+    for (std::size_t i=0; i < kValueSize; ++i)
+        bigValue[i] = static_cast<char>('a' + random.nextInt(26));
+    bigValue[kValueSize] = '\0';
+
+    CarlaStateSave::CustomData* const bigData(new CarlaStateSave::CustomData());
+    bigData->type  = carla_strdup(CUSTOM_DATA_TYPE_STRING);
+    bigData->key   = carla_strdup("big");
+    bigData->value = bigValue;
+    state.customData.append(bigData);
+
+    CarlaStateSave::CustomData* const smallData(new CarlaStateSave::CustomData());
+    smallData->type  = carla_strdup(CUSTOM_DATA_TYPE_STRING);
+    smallData->key   = carla_strdup("small");
+    smallData->value = carla_strdup("x & y");
+    state.customData.append(smallData);
+}
+
+static juce::String dumpState(const CarlaStateSave& state, CarlaStateSidecarWriter* const sidecar)
+{
+    MemoryOutputStream out;
+    out << "<Plugin>\n";
+    state.dumpToStream(out, sidecar);
+    out << "</Plugin>\n";
+    return out.toUTF8();
+}
+
+static bool readState(const juce::String& xml, CarlaStateSave& state, const CarlaStateSidecarReader* const sidecar)
+{
+    CarlaXmlReader reader(xml.toRawUTF8(), xml.getNumBytesAsUTF8());
+    assert(reader.nextChild());
+    assert(reader.isName("plugin"));
+    return state.fillFromXmlReader(reader, sidecar);
+}
+
+static const char* getValue(const CarlaStateSave& state, const char* const key)
+{
+    for (CarlaStateSave::CustomDataItenerator it = state.customData.begin2(); it.valid(); it.next())
+    {
+        const CarlaStateSave::CustomData* const data(it.getValue(nullptr));
+        assert(data != nullptr);
+
+        if (std::strcmp(data->key, key) == 0)
+            return data->value;
+    }
+
+    return nullptr;
+}
+
+static void checkState(const CarlaStateSave& a, const CarlaStateSave& b)
+{
+    assert(std::strcmp(a.type, b.type) == 0);
+    assert(std::strcmp(a.name, b.name) == 0);
+    assert(std::strcmp(a.label, b.label) == 0);
+    assert(a.active == b.active);
+    assert(carla_isEqual(a.volume, b.volume));
+    assert(a.ctrlChannel == b.ctrlChannel);
+
+    assert(b.chunk != nullptr);
+    assert(a.chunkSize == b.chunkSize);
+    assert(std::memcmp(a.chunk, b.chunk, a.chunkSize) == 0);
+
+    assert(b.customData.count() == 2);
+    assert(std::strcmp(getValue(b, "big"), getValue(a, "big")) == 0);
+    assert(std::strcmp(getValue(b, "small"), "x & y") == 0);
+}
+
+// -----------------------------------------------------------------------
+
+int main()
+{
+    const File dir(File::getSpecialLocation(File::tempDirectory).getNonexistentChildFile("carla-state-test", ""));
+    assert(dir.createDirectory());
+
+    const File projectFile(dir.getChildFile("test.carxp"));
+
+    CarlaStateSave state;
+    fillState(state);
+
+    // everything in the XML
+    {
+        const juce::String xml(dumpState(state, nullptr));
+        assert(! xml.contains("Ref>"));
+
+        CarlaStateSave loaded;
+        assert(readState(xml, loaded, nullptr));
+        checkState(state, loaded);
+    }
+
+    // nothing big enough for the sidecar
+    {
+        CarlaStateSidecarWriter writer(projectFile, 1024*1024);
+        dumpState(state, &writer);
+        assert(writer.isEmpty());
+    }
+
+    // big data in the sidecar
+    juce::String xml, id;
+    File sidecarFile;
+
+    {
+        CarlaStateSidecarWriter writer(projectFile, 1024);
+        xml = dumpState(state, &writer);
+        assert(! writer.isEmpty());
+        assert(writer.finish());
+
+        id          = writer.getId();
+        sidecarFile = writer.getFile();
+    }
+
+    assert(sidecarFile.existsAsFile());
+    assert(xml.contains("<ChunkRef>"));
+    assert(xml.contains("<ValueRef>"));
+    assert(xml.contains("<Value>x &amp; y</Value>"));
+
+    // chunk was compressed, value was not
+    assert(sidecarFile.getSize() < static_cast<juce::int64>(kChunkSize));
+
+    {
+        CarlaStateSidecarReader reader(sidecarFile, id);
+        assert(reader.isValid());
+
+        CarlaStateSave loaded;
+        assert(readState(xml, loaded, &reader));
+        checkState(state, loaded);
+    }
+
+    // sidecar of another save
+    {
+        CarlaStateSidecarReader reader(sidecarFile, juce::Uuid().toString());
+        assert(! reader.isValid());
+
+        CarlaStateSave loaded;
+        assert(! readState(xml, loaded, &reader));
+        assert(loaded.chunk == nullptr);
+        assert(std::strcmp(getValue(loaded, "small"), "x & y") == 0);
+    }
+
+    // missing sidecar
+    {
+        CarlaStateSave loaded;
+        assert(! readState(xml, loaded, nullptr));
+    }
+
+    // corrupt data, size is still valid so only the hash catches it
+    {
+        const File corruptFile(dir.getChildFile("corrupt.data"));
+        assert(sidecarFile.copyFileTo(corruptFile));
+
+        juce::MemoryBlock data;
+        assert(corruptFile.loadFileAsData(data));
+
+        const int valuePos(xml.indexOf("<ValueRef>") + 10);
+        const juce::int64 valueRef(xml.substring(valuePos).getLargeIntValue());
+        static_cast<char*>(data.getData())[valueRef + 32 + 100] ^= 0x1;
+        assert(corruptFile.replaceWithData(data.getData(), data.getSize()));
+
+        CarlaStateSidecarReader reader(corruptFile, id);
+        assert(reader.isValid());
+
+        CarlaStateSave loaded;
+        assert(! readState(xml, loaded, &reader));
+        assert(getValue(loaded, "big") == nullptr);
+        assert(loaded.chunk != nullptr && loaded.chunkSize == kChunkSize);
+    }
+
+    // sizes that do not fit the stored data are refused, no allocation is attempted
+    {
+        const File corruptFile(dir.getChildFile("size.data"));
+        assert(sidecarFile.copyFileTo(corruptFile));
+
+        juce::MemoryBlock data;
+        assert(corruptFile.loadFileAsData(data));
+
+        const int chunkPos(xml.indexOf("<ChunkRef>") + 10);
+        const juce::int64 chunkRef(xml.substring(chunkPos).getLargeIntValue());
+        uint8_t* const blob(static_cast<uint8_t*>(data.getData()) + chunkRef);
+        std::memset(blob + 8, 0x7f, 8);
+        assert(corruptFile.replaceWithData(data.getData(), data.getSize()));
+
+        CarlaStateSidecarReader reader(corruptFile, id);
+        assert(reader.isValid());
+        assert(reader.getSize(static_cast<uint64_t>(chunkRef)) == 0);
+
+        CarlaStateSave loaded;
+        assert(! readState(xml, loaded, &reader));
+        assert(loaded.chunk == nullptr);
+    }
+
+    // truncated XML
+    {
+        CarlaStateSave loaded;
+        assert(! readState(xml.substring(0, xml.length()/2), loaded, nullptr));
+    }
+
+    // only sidecars of this project, other than the kept one, are removed
+    {
+        const File oldFile(getStateSidecarFile(projectFile, juce::Uuid().toString()));
+        const File otherFile(dir.getChildFile("other.carxp." + juce::Uuid().toString() + ".data"));
+        const File userFile(dir.getChildFile("test.carxp.notes.data"));
+        assert(oldFile.create().wasOk());
+        assert(otherFile.create().wasOk());
+        assert(userFile.create().wasOk());
+
+        removeOldStateSidecarFiles(projectFile, sidecarFile);
+
+        assert(! oldFile.existsAsFile());
+        assert(sidecarFile.existsAsFile());
+        assert(otherFile.existsAsFile());
+        assert(userFile.existsAsFile());
+    }
+
+    assert(dir.deleteRecursively());
+    return 0;
+}
+
+// -----------------------------------------------------------------------
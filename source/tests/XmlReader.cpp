@@ -0,0 +1,257 @@
+/*
+ * Carla Tests
+ * Copyright (C) 2015 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#include "CarlaXmlUtils.hpp"
+
+#include <cstdio>
+#include <ctime>
+
+// -----------------------------------------------------------------------
+
+static double getSeconds() noexcept
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec)/1000000000.0;
+}
+
+struct StringStream {
+    std::string data;
+
+    void write(const void* const ptr, const std::size_t size)
+    {
+        data.append(static_cast<const char*>(ptr), size);
+    }
+};
+
+// -----------------------------------------------------------------------
+// elements, text, entities and things to skip
+
+static void testDocument()
+{
+    static const char kDoc[] =
+        "<?xml version='1.0' encoding='UTF-8'?>\n"
+        "<!DOCTYPE CARLA-PROJECT>\n"
+        "<CARLA-PROJECT VERSION='2.0'>\n"
+        " <!-- a <comment> -->\n"
+        " <Info a=\"1>2\">\n"
+        "  <Name> A &amp; B &lt;&#65;&#x42;&gt; </Name>\n"
+        "  <Empty/>\n"
+        "  <Label><![CDATA[x<y]]></Label>\n"
+        "  <Mixed>one <b>two</b> three</Mixed>\n"
+        " </Info>\n"
+        " <Data><Chunk>\n  YWJj\n  ZGVm\n </Chunk><Skip><a><b/></a></Skip></Data>\n"
+        "</CARLA-PROJECT>\n";
+
+    CarlaXmlReader reader(kDoc, sizeof(kDoc)-1);
+    std::string text;
+
+    assert(reader.nextChild());
+    assert(reader.isName("carla-project"));
+
+    assert(reader.nextChild());
+    assert(reader.isName("info"));
+
+    assert(reader.nextChild());
+    assert(reader.isName("Name"));
+    assert(reader.readText(text));
+    assert(text == "A & B <AB>");
+
+    assert(reader.nextChild());
+    assert(reader.isName("empty"));
+    assert(reader.readText(text));
+    assert(text.empty());
+
+    assert(reader.nextChild());
+    assert(reader.isName("label"));
+    assert(reader.readText(text));
+    assert(text == "x<y");
+
+    assert(reader.nextChild());
+    assert(reader.isName("mixed"));
+    assert(reader.readText(text));
+    assert(text == "one two three");
+
+    assert(! reader.nextChild());
+
+    assert(reader.nextChild());
+    assert(reader.isName("data"));
+
+    const char* raw;
+    std::size_t rawSize;
+
+    assert(reader.nextChild());
+    assert(reader.isName("chunk"));
+    assert(reader.readRawText(raw, rawSize));
+    assert(std::string(raw, rawSize) == "\n  YWJj\n  ZGVm\n ");
+
+    assert(reader.nextChild());
+    assert(reader.isName("skip"));
+    assert(reader.skipElement());
+
+    assert(! reader.nextChild());
+    assert(! reader.nextChild());
+    assert(! reader.nextChild());
+    assert(! reader.hasError());
+}
+
+// -----------------------------------------------------------------------
+// raw text is refused when it needs decoding, and nothing is read
+
+static void testRawText()
+{
+    static const char kDoc[] = "<a><b>x&amp;y</b><c><d/></c></a>";
+
+    CarlaXmlReader reader(kDoc, sizeof(kDoc)-1);
+    std::string text;
+    const char* raw;
+    std::size_t rawSize;
+
+    assert(reader.nextChild());
+
+    assert(reader.nextChild());
+    assert(! reader.readRawText(raw, rawSize));
+    assert(reader.readText(text));
+    assert(text == "x&y");
+
+    assert(reader.nextChild());
+    assert(! reader.readRawText(raw, rawSize));
+    assert(reader.skipElement());
+
+    assert(! reader.nextChild());
+    assert(! reader.hasError());
+}
+
+// -----------------------------------------------------------------------
+// truncated documents stop with an error
+
+static void testErrors()
+{
+    static const char kDoc[] = "<a><b>text</b><c>more";
+
+    CarlaXmlReader reader(kDoc, sizeof(kDoc)-1);
+    std::string text;
+
+    assert(reader.nextChild());
+    assert(reader.nextChild());
+    assert(reader.readText(text));
+    assert(reader.nextChild());
+    assert(! reader.readText(text));
+    assert(reader.hasError());
+    assert(! reader.nextChild());
+}
+
+// -----------------------------------------------------------------------
+// escaped text reads back the same
+
+static void testEscaping()
+{
+    static const char kText[] = "<tag attr=\"v\">'&amp;' stays & unicode \xc3\xa9";
+
+    StringStream stream;
+    stream.data = "<v>";
+    carla_xmlWriteEscaped(stream, kText);
+    stream.data += "</v>";
+
+    assert(stream.data.find('"') == std::string::npos);
+    assert(stream.data.find('\'') == std::string::npos);
+
+    CarlaXmlReader reader(stream.data.c_str(), stream.data.size());
+    std::string text;
+
+    assert(reader.nextChild());
+    assert(reader.readText(text));
+    assert(text == kText);
+}
+
+// -----------------------------------------------------------------------
+// a project-like document with big chunks, size in MiB can be given as argument
+
+static void benchmark(const uint sizeInMiB)
+{
+    std::string doc("<?xml version='1.0' encoding='UTF-8'?>\n<CARLA-PROJECT VERSION='2.0'>\n");
+    std::string line(120, 'A');
+    line += '\n';
+
+    const std::size_t target(static_cast<std::size_t>(sizeInMiB) * 1024 * 1024);
+    uint plugins = 0;
+
+    for (; doc.size() < target; ++plugins)
+    {
+        doc += " <Plugin>\n  <Info>\n   <Type>VST2</Type>\n   <Name>Sampler &amp; Co</Name>\n  </Info>\n  <Data>\n";
+
+        for (int i=0; i < 64; ++i)
+            doc += "   <Parameter>\n    <Index>1</Index>\n    <Name>Gain</Name>\n    <Value>0.5</Value>\n   </Parameter>\n";
+
+        doc += "   <Chunk>\n";
+
+        for (int i=0; i < 4096; ++i)
+            doc += line;
+
+        doc += "   </Chunk>\n  </Data>\n </Plugin>\n";
+    }
+
+    doc += "</CARLA-PROJECT>\n";
+
+    const double start = getSeconds();
+
+    CarlaXmlReader reader(doc.c_str(), doc.size());
+    std::string text;
+    std::size_t chunkBytes = 0;
+    uint elements = 0;
+
+    assert(reader.nextChild());
+
+    for (; reader.nextChild(); ++elements)
+    {
+        for (; reader.nextChild(); ++elements)
+        {
+            for (; reader.nextChild(); ++elements)
+            {
+                const char* raw;
+                std::size_t rawSize;
+
+                if (reader.isName("chunk") && reader.readRawText(raw, rawSize))
+                    chunkBytes += rawSize;
+                else
+                    reader.readText(text);
+            }
+        }
+    }
+
+    const double elapsed = getSeconds() - start;
+
+    assert(! reader.hasError());
+    assert(chunkBytes > 0);
+
+    std::printf("xml reader, %u plugins, %u elements:\n", plugins, elements);
+    std::printf("  %.1f MiB in %.2f ms, %.0f MiB/s\n",
+                static_cast<double>(doc.size())/1048576.0, elapsed*1000.0, static_cast<double>(doc.size())/1048576.0/elapsed);
+}
+
+int main(int argc, char* argv[])
+{
+    testDocument();
+    testRawText();
+    testErrors();
+    testEscaping();
+
+    const int size((argc > 1) ? std::atoi(argv[1]) : 64);
+    benchmark(static_cast<uint>(size > 0 ? size : 64));
+
+    return 0;
+}
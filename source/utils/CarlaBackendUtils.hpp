@@ -280,6 +280,18 @@ const char* EngineCallbackOpcode2Str(const EngineCallbackOpcode opcode) noexcept
         return "ENGINE_CALLBACK_ERROR";
     case ENGINE_CALLBACK_QUIT:
         return "ENGINE_CALLBACK_QUIT";
+    case ENGINE_CALLBACK_PARAMETER_VALUES_CHANGED:
+        return "ENGINE_CALLBACK_PARAMETER_VALUES_CHANGED";
+    case ENGINE_CALLBACK_PLUGIN_DEGRADED:
+        return "ENGINE_CALLBACK_PLUGIN_DEGRADED";
+    case ENGINE_CALLBACK_PROJECT_PLUGIN_LOADED:
+        return "ENGINE_CALLBACK_PROJECT_PLUGIN_LOADED";
+    case ENGINE_CALLBACK_PROJECT_PLUGINS_LOADED:
+        return "ENGINE_CALLBACK_PROJECT_PLUGINS_LOADED";
+    case ENGINE_CALLBACK_OFFLINE_RENDER_FINISHED:
+        return "ENGINE_CALLBACK_OFFLINE_RENDER_FINISHED";
+    case ENGINE_CALLBACK_PLUGIN_BRIDGE_LATENCY:
+        return "ENGINE_CALLBACK_PLUGIN_BRIDGE_LATENCY";
     }
 
     carla_stderr("CarlaBackend::EngineCallbackOpcode2Str(%i) - invalid opcode", opcode);
@@ -327,6 +339,24 @@ const char* EngineOption2Str(const EngineOption option) noexcept
         return "ENGINE_OPTION_PREVENT_BAD_BEHAVIOUR";
     case ENGINE_OPTION_FRONTEND_WIN_ID:
         return "ENGINE_OPTION_FRONTEND_WIN_ID";
+    case ENGINE_OPTION_PROCESS_WORKERS:
+        return "ENGINE_OPTION_PROCESS_WORKERS";
+    case ENGINE_OPTION_RACK_PIPELINE_STAGES:
+        return "ENGINE_OPTION_RACK_PIPELINE_STAGES";
+    case ENGINE_OPTION_PLUGIN_BRIDGES_SPIN_TIME:
+        return "ENGINE_OPTION_PLUGIN_BRIDGES_SPIN_TIME";
+    case ENGINE_OPTION_PLUGIN_BRIDGES_GROUP_SIZE:
+        return "ENGINE_OPTION_PLUGIN_BRIDGES_GROUP_SIZE";
+    case ENGINE_OPTION_BATCH_PARAMETER_CHANGES:
+        return "ENGINE_OPTION_BATCH_PARAMETER_CHANGES";
+    case ENGINE_OPTION_PROJECT_LOAD_THREADS:
+        return "ENGINE_OPTION_PROJECT_LOAD_THREADS";
+    case ENGINE_OPTION_PROJECT_SIDECAR_MIN_SIZE:
+        return "ENGINE_OPTION_PROJECT_SIDECAR_MIN_SIZE";
+    case ENGINE_OPTION_PLUGIN_BRIDGES_DEADLINE:
+        return "ENGINE_OPTION_PLUGIN_BRIDGES_DEADLINE";
+    case ENGINE_OPTION_OFFLINE_RENDER_FRAMES:
+        return "ENGINE_OPTION_OFFLINE_RENDER_FRAMES";
     }
 
     carla_stderr("CarlaBackend::EngineOption2Str(%i) - invalid option", option);
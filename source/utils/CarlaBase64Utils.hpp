@@ -1,7 +1,6 @@
 /*
- * Carla base64 utils, based on http://www.adp-gmbh.ch/cpp/common/base64.html
- * Copyright (C) 2004-2008 René Nyffenegger
- * Copyright (C) 2014 Filipe Coelho <falktx@falktx.com>
+ * Carla base64 utils
+ * Copyright (C) 2014-2015 Filipe Coelho <falktx@falktx.com>
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License as
@@ -21,7 +20,6 @@
 
 #include "CarlaUtils.hpp"
 
-#include <cctype>
 #include <vector>
 
 // -----------------------------------------------------------------------
@@ -29,92 +27,337 @@
 
 namespace CarlaBase64Helpers {
 
-static const char* const kBase64Chars =
+static const char kBase64Chars[] =
     "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
     "abcdefghijklmnopqrstuvwxyz"
     "0123456789+/";
 
+// decode table values that are not a 6-bit value, all have the top 2 bits set
+static const uint8_t kX = 0xff; // invalid
+static const uint8_t kS = 0xfe; // skipped (whitespace)
+static const uint8_t kP = 0xfd; // padding, ends the data
+
+static const uint8_t kBase64Values[256] = {
+    kX, kX, kX, kX, kX, kX, kX, kX, kX, kS, kS, kX, kX, kS, kX, kX,
+    kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX,
+    kS, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, 62, kX, kX, kX, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, kX, kX, kX, kP, kX, kX,
+    kX,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, kX, kX, kX, kX, kX,
+    kX, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, kX, kX, kX, kX, kX,
+    kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX,
+    kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX,
+    kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX,
+    kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX,
+    kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX,
+    kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX,
+    kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX,
+    kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX, kX
+};
+
 static inline
-uint8_t findBase64CharIndex(const char c)
+void encodeTriple(const uint8_t* const in, char* const out) noexcept
 {
-    static const uint8_t kBase64CharsLen(static_cast<uint8_t>(std::strlen(kBase64Chars)));
+    const uint32_t v((static_cast<uint32_t>(in[0]) << 16) | (static_cast<uint32_t>(in[1]) << 8) | in[2]);
+
+    out[0] = kBase64Chars[ v >> 18        ];
+    out[1] = kBase64Chars[(v >> 12) & 0x3f];
+    out[2] = kBase64Chars[(v >>  6) & 0x3f];
+    out[3] = kBase64Chars[ v        & 0x3f];
+}
 
-    for (uint8_t i=0; i<kBase64CharsLen; ++i)
+// encodes all complete triples, returns number of input bytes used
+static inline
+std::size_t encodeBlocks(const uint8_t* in, const std::size_t size, char* out) noexcept
+{
+    const uint8_t* const start(in);
+    const uint8_t* const end(in + size - size % 3);
+
+    // 12 bytes at a time, no dependencies between triples
+    for (; end - in >= 12; in += 12, out += 16)
     {
-        if (kBase64Chars[i] == c)
-            return i;
+        encodeTriple(in,   out);
+        encodeTriple(in+3, out+4);
+        encodeTriple(in+6, out+8);
+        encodeTriple(in+9, out+12);
     }
 
-    carla_stderr2("findBase64CharIndex('%c') - failed", c);
-    return 0;
+    for (; in != end; in += 3, out += 4)
+        encodeTriple(in, out);
+
+    return static_cast<std::size_t>(in - start);
 }
 
+} // namespace CarlaBase64Helpers
+
+// -----------------------------------------------------------------------
+
+/*
+ * Number of characters needed to encode @a dataSize bytes, padding included.
+ */
 static inline
-bool isBase64Char(const char c)
+std::size_t carla_base64EncodedSize(const std::size_t dataSize) noexcept
 {
-    return (std::isalnum(c) || (c == '+') || (c == '/'));
+    return (dataSize + 2) / 3 * 4;
 }
 
-} // namespace CarlaBase64Helpers
+/*
+ * Maximum number of bytes that @a length base64 characters can decode to.
+ */
+static inline
+std::size_t carla_base64DecodedMaxSize(const std::size_t length) noexcept
+{
+    return (length + 3) / 4 * 3;
+}
 
 // -----------------------------------------------------------------------
+// Streaming encoder, data can be given in pieces of any size.
 
-static inline
-std::vector<uint8_t> carla_getChunkFromBase64String(const char* const base64string)
+class CarlaBase64Encoder
 {
-    CARLA_SAFE_ASSERT_RETURN(base64string != nullptr, std::vector<uint8_t>());
+public:
+    CarlaBase64Encoder() noexcept
+        : fPendingSize(0)
+    {
+        fPending[0] = fPending[1] = fPending[2] = 0;
+    }
+
+    /*
+     * Encode @a size bytes into @a out, without null terminator.
+     * @a out must have room for carla_base64EncodedSize(size + 2) characters.
+     * Returns the number of characters written.
+     */
+    std::size_t encode(const void* const data, std::size_t size, char* out) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(data != nullptr || size == 0, 0);
+        CARLA_SAFE_ASSERT_RETURN(out != nullptr, 0);
+
+        const uint8_t* in(static_cast<const uint8_t*>(data));
+        char* const outStart(out);
+
+        // complete the triple left from last time
+        if (fPendingSize != 0)
+        {
+            for (; fPendingSize < 3 && size > 0; --size)
+                fPending[fPendingSize++] = *in++;
+
+            if (fPendingSize < 3)
+                return 0;
+
+            CarlaBase64Helpers::encodeTriple(fPending, out);
+            out += 4;
+            fPendingSize = 0;
+        }
 
-    uint i=0, j=0;
-    uint charArray3[3], charArray4[4];
+        const std::size_t used(CarlaBase64Helpers::encodeBlocks(in, size, out));
+        out += used / 3 * 4;
 
-    std::vector<uint8_t> ret;
-    ret.reserve(std::strlen(base64string)*3/4 + 4);
+        for (std::size_t i=used; i < size; ++i)
+            fPending[fPendingSize++] = in[i];
 
-    for (std::size_t l=0, len=std::strlen(base64string); l<len; ++l)
+        return static_cast<std::size_t>(out - outStart);
+    }
+
+    /*
+     * Write the remaining bytes and padding into @a out, up to 4 characters.
+     * Returns the number of characters written, the encoder can be used again afterwards.
+     */
+    std::size_t finish(char* const out) noexcept
     {
-        const char c = base64string[l];
+        CARLA_SAFE_ASSERT_RETURN(out != nullptr, 0);
+
+        if (fPendingSize == 0)
+            return 0;
+
+        const uint8_t last[3] = { fPending[0], fPendingSize > 1 ? fPending[1] : uint8_t(0), 0 };
+        CarlaBase64Helpers::encodeTriple(last, out);
+
+        out[3] = '=';
+
+        if (fPendingSize == 1)
+            out[2] = '=';
+
+        fPendingSize = 0;
+        return 4;
+    }
+
+private:
+    uint8_t fPending[3];
+    uint fPendingSize;
+
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaBase64Encoder)
+};
+
+// -----------------------------------------------------------------------
+// Streaming decoder, text can be given in pieces of any size.
+// Whitespace is skipped, padding or a null character ends the data.
+// Invalid characters are skipped and flagged, see hasError().
+
+class CarlaBase64Decoder
+{
+public:
+    CarlaBase64Decoder() noexcept
+        : fBits(0),
+          fBitsCount(0),
+          fDone(false),
+          fError(false) {}
 
-        if (c == '\0' || c == '=')
-            break;
-        if (c == ' ' || c == '\n')
-            continue;
+    /*
+     * Decode up to @a length characters into @a out.
+     * @a out must have room for carla_base64DecodedMaxSize(length) bytes.
+     * Returns the number of bytes written.
+     */
+    std::size_t decode(const char* const text, const std::size_t length, uint8_t* out) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(text != nullptr || length == 0, 0);
+        CARLA_SAFE_ASSERT_RETURN(out != nullptr, 0);
 
-         CARLA_SAFE_ASSERT_CONTINUE(CarlaBase64Helpers::isBase64Char(c));
+        using CarlaBase64Helpers::kBase64Values;
 
-        charArray4[i++] = static_cast<uint>(c);
+        const uint8_t* in((const uint8_t*)text);
+        const uint8_t* const end(in + length);
+        uint8_t* const outStart(out);
 
-        if (i == 4)
+        for (; ! fDone && in != end;)
         {
-            for (i=0; i<4; ++i)
-                charArray4[i] = CarlaBase64Helpers::findBase64CharIndex(static_cast<char>(charArray4[i]));
+            // fast path, 4 valid characters at once
+            if (fBitsCount == 0)
+            {
+                for (; end - in >= 4; in += 4, out += 3)
+                {
+                    const uint32_t a(kBase64Values[in[0]]), b(kBase64Values[in[1]]),
+                                   c(kBase64Values[in[2]]), d(kBase64Values[in[3]]);
+
+                    if ((a|b|c|d) & 0xc0)
+                        break;
+
+                    const uint32_t v((a << 18) | (b << 12) | (c << 6) | d);
 
-            charArray3[0] =  (charArray4[0] << 2)        + ((charArray4[1] & 0x30) >> 4);
-            charArray3[1] = ((charArray4[1] & 0xf) << 4) + ((charArray4[2] & 0x3c) >> 2);
-            charArray3[2] = ((charArray4[2] & 0x3) << 6) +   charArray4[3];
+                    out[0] = static_cast<uint8_t>(v >> 16);
+                    out[1] = static_cast<uint8_t>(v >> 8);
+                    out[2] = static_cast<uint8_t>(v);
+                }
 
-            for (i=0; i<3; ++i)
-                ret.push_back(static_cast<uint8_t>(charArray3[i]));
+                if (in == end)
+                    break;
+            }
 
-            i = 0;
+            // slow path, one character at a time until the next quad boundary
+            const uint8_t value(kBase64Values[*in++]);
+
+            if (value < 0x40)
+            {
+                fBits = (fBits << 6) | value;
+
+                if (++fBitsCount == 4)
+                {
+                    out[0] = static_cast<uint8_t>(fBits >> 16);
+                    out[1] = static_cast<uint8_t>(fBits >> 8);
+                    out[2] = static_cast<uint8_t>(fBits);
+                    out += 3;
+
+                    fBits = 0;
+                    fBitsCount = 0;
+                }
+            }
+            else if (value == CarlaBase64Helpers::kP || in[-1] == '\0')
+            {
+                fDone = true;
+            }
+            else if (value != CarlaBase64Helpers::kS)
+            {
+                fError = true;
+            }
         }
+
+        return static_cast<std::size_t>(out - outStart);
     }
 
-    if (i != 0)
+    /*
+     * Write the bytes of an unpadded or incomplete last quad into @a out, up to 2 bytes.
+     * Returns the number of bytes written, the decoder can be used again afterwards.
+     */
+    std::size_t finish(uint8_t* const out) noexcept
     {
-        for (j=0; j<i && j<4; ++j)
-            charArray4[j] = CarlaBase64Helpers::findBase64CharIndex(static_cast<char>(charArray4[j]));
+        CARLA_SAFE_ASSERT_RETURN(out != nullptr, 0);
+
+        std::size_t ret = 0;
 
-        for (j=i; j<4; ++j)
-            charArray4[j] = 0;
+        if (fBitsCount == 2)
+        {
+            out[0] = static_cast<uint8_t>(fBits >> 4);
+            ret = 1;
+        }
+        else if (fBitsCount == 3)
+        {
+            out[0] = static_cast<uint8_t>(fBits >> 10);
+            out[1] = static_cast<uint8_t>(fBits >> 2);
+            ret = 2;
+        }
 
-        charArray3[0] =  (charArray4[0] << 2)        + ((charArray4[1] & 0x30) >> 4);
-        charArray3[1] = ((charArray4[1] & 0xf) << 4) + ((charArray4[2] & 0x3c) >> 2);
-        charArray3[2] = ((charArray4[2] & 0x3) << 6) +   charArray4[3];
+        fBits = 0;
+        fBitsCount = 0;
+        fDone = false;
+        return ret;
+    }
 
-        for (j=0; i>0 && j<i-1; j++)
-            ret.push_back(static_cast<uint8_t>(charArray3[j]));
+    bool hasError() const noexcept
+    {
+        return fError;
     }
 
+private:
+    uint32_t fBits;
+    uint fBitsCount;
+    bool fDone;
+    bool fError;
+
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaBase64Decoder)
+};
+
+// -----------------------------------------------------------------------
+
+/*
+ * Encode @a dataSize bytes into @a out, which must have room for carla_base64EncodedSize(dataSize) characters.
+ * No null terminator is written. Returns the number of characters written.
+ */
+static inline
+std::size_t carla_base64Encode(const void* const data, const std::size_t dataSize, char* const out) noexcept
+{
+    CarlaBase64Encoder encoder;
+
+    const std::size_t ret(encoder.encode(data, dataSize, out));
+    return ret + encoder.finish(out + ret);
+}
+
+/*
+ * Decode @a length characters into @a out, which must have room for carla_base64DecodedMaxSize(length) bytes.
+ * Returns the number of bytes written.
+ */
+static inline
+std::size_t carla_base64Decode(const char* const text, const std::size_t length, uint8_t* const out) noexcept
+{
+    CarlaBase64Decoder decoder;
+
+    const std::size_t ret(decoder.decode(text, length, out));
+    CARLA_SAFE_ASSERT(! decoder.hasError());
+
+    return ret + decoder.finish(out + ret);
+}
+
+static inline
+std::vector<uint8_t> carla_getChunkFromBase64String(const char* const base64string)
+{
+    CARLA_SAFE_ASSERT_RETURN(base64string != nullptr, std::vector<uint8_t>());
+
+    const std::size_t length(std::strlen(base64string));
+
+    std::vector<uint8_t> ret(carla_base64DecodedMaxSize(length));
+
+    if (ret.size() != 0)
+        ret.resize(carla_base64Decode(base64string, length, ret.data()));
+
     return ret;
 }
 
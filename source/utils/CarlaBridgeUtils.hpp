@@ -25,11 +25,13 @@
 # define PLUGIN_BRIDGE_NAMEPREFIX_RT_CLIENT     "Global\\carla-bridge_shm_rtC_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_NON_RT_CLIENT "Global\\carla-bridge_shm_nonrtC_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_NON_RT_SERVER "Global\\carla-bridge_shm_nonrtS_"
+# define PLUGIN_BRIDGE_NAMEPREFIX_CHUNK         "Global\\carla-bridge_shm_chunk_"
 #else
 # define PLUGIN_BRIDGE_NAMEPREFIX_AUDIO_POOL    "/carla-bridge_shm_ap_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_RT_CLIENT     "/carla-bridge_shm_rtC_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_NON_RT_CLIENT "/carla-bridge_shm_nonrtC_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_NON_RT_SERVER "/carla-bridge_shm_nonrtS_"
+# define PLUGIN_BRIDGE_NAMEPREFIX_CHUNK         "/carla-bridge_shm_chunk_"
 #endif
 
 // -----------------------------------------------------------------------
@@ -45,7 +47,9 @@ enum PluginBridgeRtClientOpcode {
     kPluginBridgeRtClientControlEventAllNotesOff, // uint/frame, byte/chan
     kPluginBridgeRtClientMidiEvent,               // uint/frame, byte/port, byte/size, byte[]/data
     kPluginBridgeRtClientProcess,
-    kPluginBridgeRtClientQuit
+    kPluginBridgeRtClientQuit,
+    kPluginBridgeRtClientSetPlugin,               // uint/index
+    kPluginBridgeRtClientChainAudio               // uint/index
 };
 
 // Server sends these to client during non-RT
@@ -65,7 +69,8 @@ enum PluginBridgeNonRtClientOpcode {
     kPluginBridgeNonRtClientSetProgram,              // int
     kPluginBridgeNonRtClientSetMidiProgram,          // int
     kPluginBridgeNonRtClientSetCustomData,           // uint/size, str[], uint/size, str[], uint/size, str[]
-    kPluginBridgeNonRtClientSetChunkDataFile,        // uint/size, str[] (filename, base64 content)
+    kPluginBridgeNonRtClientSetChunkShm,             // uint/size, str[] (shm filename), ulong/size (data size)
+    kPluginBridgeNonRtClientSetChunkData,            // ulong/total, ulong/offset, uint/size (piece in chunk shm)
     kPluginBridgeNonRtClientSetCtrlChannel,          // short
     kPluginBridgeNonRtClientSetOption,               // uint/option, bool
     kPluginBridgeNonRtClientPrepareForSave,
@@ -76,7 +81,8 @@ enum PluginBridgeNonRtClientOpcode {
     kPluginBridgeNonRtClientUiMidiProgramChange,     // uint
     kPluginBridgeNonRtClientUiNoteOn,                // byte, byte, byte
     kPluginBridgeNonRtClientUiNoteOff,               // byte, byte
-    kPluginBridgeNonRtClientQuit
+    kPluginBridgeNonRtClientQuit,
+    kPluginBridgeNonRtClientAddPlugin                // uint/index, uint/type, uint/size, str[] (filename), uint/size, str[] (name), uint/size, str[] (label), long/uniqueId, str[24] (shm ids)
 };
 
 // Client sends these to server during non-RT
@@ -101,7 +107,7 @@ enum PluginBridgeNonRtServerOpcode {
     kPluginBridgeNonRtServerProgramName,        // uint/index, uint/size, str[] (name)
     kPluginBridgeNonRtServerMidiProgramData,    // uint/index, uint/bank, uint/program, uint/size, str[] (name)
     kPluginBridgeNonRtServerSetCustomData,      // uint/size, str[], uint/size, str[], uint/size, str[]
-    kPluginBridgeNonRtServerSetChunkDataFile,   // uint/size, str[] (filename, base64 content)
+    kPluginBridgeNonRtServerSetChunkData,       // ulong/total, ulong/offset, uint/size (piece in chunk shm)
     kPluginBridgeNonRtServerSetLatency,         // uint
     kPluginBridgeNonRtServerReady,
     kPluginBridgeNonRtServerSaved,
@@ -122,6 +128,34 @@ struct BridgeSemaphore {
     };
 };
 
+// Lock-free client reply, the server can busy-wait on clientSeq instead of sleeping on sem.client.
+// The client only posts sem.client if the server has set serverWaiting.
+// serverSeq counts the server posts and is only used by the server, the client is still busy while it is ahead of clientSeq.
+struct BridgeRtHandoff {
+    union {
+        uint32_t clientSeq;
+        char _padClientSeq[64];
+    };
+    union {
+        uint32_t serverWaiting;
+        char _padServerWaiting[64];
+    };
+    union {
+        uint32_t serverSeq;
+        char _padServerSeq[64];
+    };
+};
+
+// Start of the chunk shared memory, the chunk data follows right after.
+// The writer sets pieceReady after copying a piece in, the reader clears it once done with that piece.
+// Writers must wait for it to be cleared before reusing the data area.
+struct BridgeChunkHeader {
+    union {
+        uint32_t pieceReady;
+        char _padPieceReady[64];
+    };
+};
+
 // needs to be 64bit aligned
 struct BridgeTimeInfo {
     uint64_t playing;
@@ -136,13 +170,125 @@ struct BridgeTimeInfo {
 
 // -----------------------------------------------------------------------
 
+// Process deadline bookkeeping of a bridged plugin, see ENGINE_OPTION_PLUGIN_BRIDGES_DEADLINE.
+// Everything is updated by the audio thread, the idle thread only reads the degraded state after taking 'changed'.
+struct BridgeProcessDeadline {
+    // consecutive missed deadlines after which a bridge is degraded
+    static const uint32_t kMaxMisses = 8;
+
+    uint32_t misses;    // in a row
+    uint32_t skip;      // blocks to skip before trying again while degraded
+    bool degraded;
+    bool changed;       // degraded state changed since the last takeChanged()
+    bool eventsLost;    // input events were dropped, the next request starts with all notes off
+
+    BridgeProcessDeadline() noexcept
+        : misses(0),
+          skip(0),
+          degraded(false),
+          changed(false),
+          eventsLost(false) {}
+
+    // time a bridge may take for a block, in microseconds, 0 means no deadline
+    static uint32_t getTimeout(const uint32_t frames, const double sampleRate, const uint32_t percentage) noexcept
+    {
+        if (percentage == 0 || frames == 0 || sampleRate <= 0.0)
+            return 0;
+
+        const double usecs(double(frames) * 10000.0 * double(percentage) / sampleRate);
+        return usecs < 1.0 ? 1 : static_cast<uint32_t>(usecs);
+    }
+
+    bool isDegraded() const noexcept
+    {
+        return __atomic_load_n(&degraded, __ATOMIC_ACQUIRE);
+    }
+
+    uint32_t getMisses() const noexcept
+    {
+        return __atomic_load_n(&misses, __ATOMIC_RELAXED);
+    }
+
+    // whether a request can be sent now, while degraded only one block in @a retryBlocks is tried
+    bool isReady(const bool clientBusy, const uint32_t retryBlocks) noexcept
+    {
+        if (clientBusy)
+        {
+            miss();
+            return false;
+        }
+
+        if (! degraded)
+            return true;
+
+        if (skip > 0)
+        {
+            --skip;
+            return false;
+        }
+
+        skip = retryBlocks;
+        return true;
+    }
+
+    void miss() noexcept
+    {
+        if (misses < UINT32_MAX)
+            __atomic_store_n(&misses, misses+1, __ATOMIC_RELAXED);
+
+        if (! degraded && misses >= kMaxMisses)
+            setDegraded(true);
+    }
+
+    void met() noexcept
+    {
+        __atomic_store_n(&misses, 0, __ATOMIC_RELAXED);
+
+        if (degraded)
+        {
+            skip = 0;
+            setDegraded(false);
+        }
+    }
+
+    // returns true once for each change of the degraded state
+    bool takeChanged() noexcept
+    {
+        return __atomic_exchange_n(&changed, false, __ATOMIC_ACQ_REL);
+    }
+
+private:
+    void setDegraded(const bool yesNo) noexcept
+    {
+        __atomic_store_n(&degraded, yesNo, __ATOMIC_RELEASE);
+        __atomic_store_n(&changed, true, __ATOMIC_RELEASE);
+    }
+};
+
+// -----------------------------------------------------------------------
+
 static const std::size_t kBridgeRtClientDataMidiOutSize = 512*4;
 
+// MIDI events are sent with a single size byte, see kPluginBridgeRtClientMidiEvent
+static const uint16_t kBridgeMidiEventMaxSize = 0xFF;
+
+// Maximum number of plugins a single bridge process can host, see kPluginBridgeNonRtClientAddPlugin
+static const uint32_t kPluginBridgeGroupMaxPlugins = 16;
+
+// Chunk shared memory data size, bigger chunks are sent in several pieces
+static const uint64_t kPluginBridgeChunkShmMinSize = 1024*1024;
+static const uint64_t kPluginBridgeChunkShmMaxSize = 64*1024*1024;
+
+// Time to wait for the other side to take a chunk piece, in milliseconds
+static const uint32_t kPluginBridgeChunkPieceTimeout = 10*1000;
+
 // Server => Client RT
 struct BridgeRtClientData {
     BridgeSemaphore sem;
+    BridgeRtHandoff handoff;
     BridgeTimeInfo timeInfo;
     SmallStackBuffer ringBuffer;
+    // one area per plugin slot, a bridge group maps the extra ones right after this, see getBridgeRtClientDataSize
     uint8_t midiOut[kBridgeRtClientDataMidiOutSize];
 };
 
@@ -158,6 +304,22 @@ struct BridgeNonRtServerData {
 
 // -----------------------------------------------------------------------
 
+// Size of the rt client shared memory of a bridge process hosting 'slots' plugins
+static inline
+std::size_t getBridgeRtClientDataSize(const uint32_t slots) noexcept
+{
+    return sizeof(BridgeRtClientData) + (slots > 1 ? slots - 1 : 0) * kBridgeRtClientDataMidiOutSize;
+}
+
+// MIDI output area of a plugin slot
+static inline
+uint8_t* getBridgeRtClientMidiOut(BridgeRtClientData* const data, const uint32_t slot) noexcept
+{
+    return data->midiOut + slot * kBridgeRtClientDataMidiOutSize;
+}
+
+// -----------------------------------------------------------------------
+
 static inline
 const char* PluginBridgeRtClientOpcode2str(const PluginBridgeRtClientOpcode opcode) noexcept
 {
@@ -183,6 +345,10 @@ const char* PluginBridgeRtClientOpcode2str(const PluginBridgeRtClientOpcode opco
         return "kPluginBridgeRtClientProcess";
     case kPluginBridgeRtClientQuit:
         return "kPluginBridgeRtClientQuit";
+    case kPluginBridgeRtClientSetPlugin:
+        return "kPluginBridgeRtClientSetPlugin";
+    case kPluginBridgeRtClientChainAudio:
+        return "kPluginBridgeRtClientChainAudio";
     }
 
     carla_stderr("CarlaBackend::PluginBridgeRtClientOpcode2str(%i) - invalid opcode", opcode);
@@ -224,8 +390,10 @@ const char* PluginBridgeNonRtClientOpcode2str(const PluginBridgeNonRtClientOpcod
         return "kPluginBridgeNonRtClientSetMidiProgram";
     case kPluginBridgeNonRtClientSetCustomData:
         return "kPluginBridgeNonRtClientSetCustomData";
-    case kPluginBridgeNonRtClientSetChunkDataFile:
-        return "kPluginBridgeNonRtClientSetChunkDataFile";
+    case kPluginBridgeNonRtClientSetChunkShm:
+        return "kPluginBridgeNonRtClientSetChunkShm";
+    case kPluginBridgeNonRtClientSetChunkData:
+        return "kPluginBridgeNonRtClientSetChunkData";
     case kPluginBridgeNonRtClientSetCtrlChannel:
         return "kPluginBridgeNonRtClientSetCtrlChannel";
     case kPluginBridgeNonRtClientSetOption:
@@ -248,6 +416,8 @@ const char* PluginBridgeNonRtClientOpcode2str(const PluginBridgeNonRtClientOpcod
         return "kPluginBridgeNonRtClientUiNoteOff";
     case kPluginBridgeNonRtClientQuit:
         return "kPluginBridgeNonRtClientQuit";
+    case kPluginBridgeNonRtClientAddPlugin:
+        return "kPluginBridgeNonRtClientAddPlugin";
     }
 
     carla_stderr("CarlaBackend::PluginBridgeNonRtClientOpcode2str(%i) - invalid opcode", opcode);
@@ -299,8 +469,8 @@ const char* PluginBridgeNonRtServerOpcode2str(const PluginBridgeNonRtServerOpcod
         return "kPluginBridgeNonRtServerMidiProgramData";
     case kPluginBridgeNonRtServerSetCustomData:
         return "kPluginBridgeNonRtServerSetCustomData";
-    case kPluginBridgeNonRtServerSetChunkDataFile:
-        return "kPluginBridgeNonRtServerSetChunkDataFile";
+    case kPluginBridgeNonRtServerSetChunkData:
+        return "kPluginBridgeNonRtServerSetChunkData";
     case kPluginBridgeNonRtServerSetLatency:
         return "kPluginBridgeNonRtServerSetLatency";
     case kPluginBridgeNonRtServerReady:
@@ -32,6 +32,12 @@ CARLA_BACKEND_START_NAMESPACE
 
 const ushort kMaxEngineEventInternalCount = 512;
 
+// -----------------------------------------------------------------------
+// Maximum internal pre-allocated data for long MIDI events (dataExt), shared by in and out.
+// Enough for all events at 255 bytes, a single message can take all of it.
+
+const uint kMaxEngineEventInternalDataSize = kMaxEngineEventInternalCount * 0xFF * 2;
+
 // -----------------------------------------------------------------------
 
 static inline
@@ -51,6 +57,8 @@ const char* EngineType2Str(const EngineType type) noexcept
         return "kEngineTypePlugin";
     case kEngineTypeBridge:
         return "kEngineTypeBridge";
+    case kEngineTypeDummy:
+        return "kEngineTypeDummy";
     }
 
     carla_stderr("CarlaBackend::EngineType2Str(%i) - invalid type", type);
@@ -117,36 +125,187 @@ const char* EngineControlEventType2Str(const EngineControlEventType type) noexce
 }
 
 // -----------------------------------------------------------------------
+// Internal event buffers hold up to kMaxEngineEventInternalCount events, the first null event marks the end.
+// Writers always keep the slot after their last event null, so a buffer is cleared by resetting its first event.
 
 static inline
-void fillEngineEventsFromJuceMidiBuffer(EngineEvent engineEvents[kMaxEngineEventInternalCount], const juce::MidiBuffer& midiBuffer)
+void clearEngineEvents(EngineEvent engineEvents[kMaxEngineEventInternalCount]) noexcept
 {
-    const uint8_t* midiData;
-    int numBytes, sampleNumber;
-    ushort engineEventIndex = 0;
+    engineEvents[0].type = kEngineEventTypeNull;
+}
 
-    for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
+static inline
+void terminateEngineEvents(EngineEvent engineEvents[kMaxEngineEventInternalCount], const uint32_t count) noexcept
+{
+    if (count < kMaxEngineEventInternalCount)
+        engineEvents[count].type = kEngineEventTypeNull;
+}
+
+static inline
+ushort getEngineEventCount(const EngineEvent engineEvents[kMaxEngineEventInternalCount]) noexcept
+{
+    ushort i=0;
+
+    for (; i < kMaxEngineEventInternalCount; ++i)
     {
-        const EngineEvent& engineEvent(engineEvents[i]);
+        if (engineEvents[i].type == kEngineEventTypeNull)
+            break;
+    }
 
-        if (engineEvent.type != kEngineEventTypeNull)
-            continue;
+    return i;
+}
 
-        engineEventIndex = i;
-        break;
+static inline
+void copyEngineEvents(EngineEvent dstEvents[kMaxEngineEventInternalCount], const EngineEvent srcEvents[kMaxEngineEventInternalCount]) noexcept
+{
+    const ushort count(getEngineEventCount(srcEvents));
+
+    carla_copyStructs(dstEvents, srcEvents, count);
+    terminateEngineEvents(dstEvents, count);
+}
+
+// -----------------------------------------------------------------------
+// Storage for MIDI events bigger than EngineMidiEvent::kDataSize.
+// Memory is allocated once, then handed out in real-time by a lock-free bump pointer and released all at once per cycle.
+
+struct EngineEventDataArena {
+    uint8_t* buffer;
+    uint size;
+    juce::Atomic<int> used;
+
+    EngineEventDataArena() noexcept
+        : buffer(nullptr),
+          size(0),
+          used(0) {}
+
+    ~EngineEventDataArena() noexcept
+    {
+        destroy();
+    }
+
+    bool create(const uint newSize) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(buffer == nullptr, false);
+        CARLA_SAFE_ASSERT_RETURN(newSize > 0, false);
+
+        try {
+            buffer = new uint8_t[newSize];
+        } CARLA_SAFE_EXCEPTION_RETURN("EngineEventDataArena::create", false);
+
+        size = newSize;
+        used = 0;
+        return true;
+    }
+
+    void destroy() noexcept
+    {
+        if (buffer != nullptr)
+        {
+            delete[] buffer;
+            buffer = nullptr;
+        }
+
+        size = 0;
+        used = 0;
+    }
+
+    // release everything, all dataExt pointers from this arena become invalid
+    void reset() noexcept
+    {
+        used = 0;
     }
 
+    // returns null if full
+    const uint8_t* copy(const uint8_t* const data, const uint16_t dataSize) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(data != nullptr && dataSize > 0, nullptr);
+
+        if (buffer == nullptr)
+            return nullptr;
+
+        const int end(used += static_cast<int>(dataSize));
+
+        if (end > static_cast<int>(size))
+            return nullptr;
+
+        uint8_t* const ptr(buffer + (end - dataSize));
+        std::memcpy(ptr, data, dataSize);
+        return ptr;
+    }
+
+    // same as EngineEvent::fillFromMidiData, but long messages are copied into this arena
+    // returns false if the message doesn't fit
+    bool fillFromMidiData(EngineEvent& event, const uint16_t dataSize, const uint8_t* data, const uint8_t midiPortOffset) noexcept
+    {
+        if (dataSize > EngineMidiEvent::kDataSize && data != nullptr && data[0] >= MIDI_STATUS_NOTE_OFF)
+        {
+            data = copy(data, dataSize);
+
+            if (data == nullptr)
+                return false;
+        }
+
+        event.fillFromMidiData(dataSize, data, midiPortOffset);
+        return true;
+    }
+
+    // move long message data of @a engineEvents into this arena, dropping what doesn't fit
+    void takeEvents(EngineEvent engineEvents[kMaxEngineEventInternalCount]) noexcept
+    {
+        for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
+        {
+            EngineEvent& engineEvent(engineEvents[i]);
+
+            if (engineEvent.type == kEngineEventTypeNull)
+                break;
+            if (engineEvent.type != kEngineEventTypeMidi || engineEvent.midi.dataExt == nullptr)
+                continue;
+
+            if (const uint8_t* const data = copy(engineEvent.midi.dataExt, engineEvent.midi.size))
+            {
+                engineEvent.midi.dataExt = data;
+            }
+            else
+            {
+                // can't remove events in the middle of the buffer, turn it into a null control event instead
+                engineEvent.type       = kEngineEventTypeControl;
+                engineEvent.ctrl.type  = kEngineControlEventTypeNull;
+                engineEvent.ctrl.param = 0;
+                engineEvent.ctrl.value = 0.0f;
+            }
+        }
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(EngineEventDataArena)
+};
+
+// -----------------------------------------------------------------------
+
+static inline
+ushort fillEngineEventsFromJuceMidiBuffer(EngineEvent engineEvents[kMaxEngineEventInternalCount], const juce::MidiBuffer& midiBuffer, EngineEventDataArena& dataArena)
+{
+    const uint8_t* midiData;
+    int numBytes, sampleNumber;
+    ushort engineEventIndex(getEngineEventCount(engineEvents));
+
     for (juce::MidiBuffer::Iterator midiBufferIterator(midiBuffer); midiBufferIterator.getNextEvent(midiData, numBytes, sampleNumber) && engineEventIndex < kMaxEngineEventInternalCount;)
     {
         CARLA_SAFE_ASSERT_CONTINUE(numBytes > 0);
         CARLA_SAFE_ASSERT_CONTINUE(sampleNumber >= 0);
-        CARLA_SAFE_ASSERT_CONTINUE(numBytes < 0xFF /* uint8_t max */);
+        CARLA_SAFE_ASSERT_CONTINUE(numBytes <= EngineMidiEvent::kMaxSize);
+
+        EngineEvent& engineEvent(engineEvents[engineEventIndex]);
 
-        EngineEvent& engineEvent(engineEvents[engineEventIndex++]);
+        // the midi buffer is reused during the cycle, keep our own copy of long messages
+        if (! dataArena.fillFromMidiData(engineEvent, static_cast<uint16_t>(numBytes), midiData, 0))
+            continue;
 
         engineEvent.time = static_cast<uint32_t>(sampleNumber);
-        engineEvent.fillFromMidiData(static_cast<uint8_t>(numBytes), midiData, 0);
+        ++engineEventIndex;
     }
+
+    terminateEngineEvents(engineEvents, engineEventIndex);
+    return engineEventIndex;
 }
 
 // -----------------------------------------------------------------------
@@ -154,7 +313,8 @@ void fillEngineEventsFromJuceMidiBuffer(EngineEvent engineEvents[kMaxEngineEvent
 static inline
 void fillJuceMidiBufferFromEngineEvents(juce::MidiBuffer& midiBuffer, const EngineEvent engineEvents[kMaxEngineEventInternalCount])
 {
-    uint8_t        size     = 0;
+    uint16_t       size     = 0;
+    uint8_t        ctrlSize = 0;
     uint8_t        mdata[3] = { 0, 0, 0 };
     const uint8_t* mdataPtr = mdata;
     uint8_t        mdataTmp[EngineMidiEvent::kDataSize];
@@ -171,7 +331,8 @@ void fillJuceMidiBufferFromEngineEvents(juce::MidiBuffer& midiBuffer, const Engi
         {
             const EngineControlEvent& ctrlEvent(engineEvent.ctrl);
 
-            ctrlEvent.convertToMidiData(engineEvent.channel, size, mdata);
+            ctrlEvent.convertToMidiData(engineEvent.channel, ctrlSize, mdata);
+            size     = ctrlSize;
             mdataPtr = mdata;
         }
         else if (engineEvent.type == kEngineEventTypeMidi)
@@ -204,6 +365,39 @@ void fillJuceMidiBufferFromEngineEvents(juce::MidiBuffer& midiBuffer, const Engi
     }
 }
 
+// -----------------------------------------------------------------------
+// Patchbay rendering
+
+enum PatchbayRenderMode {
+    kPatchbayRenderGraph = 0, // the JUCE graph, serial and without latency compensation
+    kPatchbayRenderPlan,      // the render plan
+    kPatchbayRenderSilence    // the plan is needed but can't be used for this block
+};
+
+/*
+ * Choose how to render a patchbay block.
+ * The plan is only used for workers, bridges to run at the same time, or latency compensation.
+ * Once the plan compensates latency, the JUCE graph would output audio that is not delayed like the blocks around it,
+ * so the block is silent instead.
+ */
+static inline
+PatchbayRenderMode getPatchbayRenderMode(const bool planAvailable, const bool planParallel, const uint32_t latency) noexcept
+{
+    if (latency > 0)
+        return planAvailable ? kPatchbayRenderPlan : kPatchbayRenderSilence;
+
+    return (planAvailable && planParallel) ? kPatchbayRenderPlan : kPatchbayRenderGraph;
+}
+
+static inline
+void clearPatchbayBlock(juce::AudioSampleBuffer& audio, juce::MidiBuffer& midi, const int numFrames) noexcept
+{
+    for (int i=0, count=audio.getNumChannels(); i<count; ++i)
+        juce::FloatVectorOperations::clear(audio.getWritePointer(i), numFrames);
+
+    midi.clear();
+}
+
 // -------------------------------------------------------------------
 // Helper classes
 
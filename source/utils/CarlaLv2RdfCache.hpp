@@ -0,0 +1,1064 @@
+/*
+ * Carla LV2 descriptor cache
+ * Copyright (C) 2011-2015 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#ifndef CARLA_LV2_RDF_CACHE_HPP_INCLUDED
+#define CARLA_LV2_RDF_CACHE_HPP_INCLUDED
+
+#include "CarlaLv2Utils.hpp"
+#include "CarlaMutex.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <set>
+#include <vector>
+
+// -----------------------------------------------------------------------
+// On-disk cache of LV2_RDF_Descriptor data
+//
+// Every plugin found in LV2_PATH is stored as a flat binary blob, the file is memory-mapped and
+// descriptors are rebuilt from it on request, without touching lilv.
+// Bundles are validated by the modification time of their folder and top-level turtle files,
+// lilv is only used (and only parses plugin data) when a bundle changed, was added or removed.
+//
+// File layout, all values in native byte order:
+//   header:  magic, version, bundle count, plugin count
+//   bundles: path string, modification time (int64)
+//   plugins: uri string, data offset, data size, dependency count, dependencies (bundle indexes)
+//   data:    serialized descriptors
+// Strings are a uint32 length (0xffffffff for null) followed by the characters and a null byte.
+
+class Lv2RdfCache
+{
+public:
+    static const uint32_t kMagic   = 0x3256414c; // "LAV2"
+    static const uint32_t kVersion = 1;
+
+    static Lv2RdfCache& getInstance()
+    {
+        static Lv2RdfCache cache;
+        return cache;
+    }
+
+    // check bundles in LV2_PATH against the cache, refresh it if needed, only done once per process
+    void initIfNeeded(const char* const LV2_PATH)
+    {
+        CARLA_SAFE_ASSERT_RETURN(LV2_PATH != nullptr,);
+
+        const CarlaMutexLocker cml(fMutex);
+
+        if (! fNeedsInit)
+            return;
+
+        fNeedsInit = false;
+        _update(LV2_PATH);
+    }
+
+    uint getPluginCount() const noexcept
+    {
+        return static_cast<uint>(fPlugins.size());
+    }
+
+    const char* getPluginURI(const uint index) const noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(index < fPlugins.size(), nullptr);
+
+        return fPlugins[index].uri;
+    }
+
+    // create a new descriptor from the cache, returns null if the plugin is not cached
+    const LV2_RDF_Descriptor* getDescriptor(const LV2_URI uri) const
+    {
+        CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', nullptr);
+
+        const CarlaMutexLocker cml(fMutex);
+
+        const PluginEntry* const entry(_findPlugin(uri));
+
+        if (entry == nullptr)
+            return nullptr;
+
+        Reader reader(entry->data, entry->size);
+        LV2_RDF_Descriptor* const desc(new LV2_RDF_Descriptor());
+
+        if (! _readDescriptor(reader, desc))
+        {
+            carla_stderr2("Lv2RdfCache: corrupted cache data for '%s'", uri);
+            delete desc;
+            return nullptr;
+        }
+
+        return desc;
+    }
+
+    // load the bundles of a cached plugin (its own, UIs and presets) into lilv, needed for state and presets
+    void loadBundlesIfNeeded(const LV2_URI uri)
+    {
+        CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0',);
+
+        const CarlaMutexLocker cml(fMutex);
+
+        const PluginEntry* const entry(_findPlugin(uri));
+
+        if (entry == nullptr)
+            return;
+
+        Lv2WorldClass& lv2World(Lv2WorldClass::getInstance());
+
+        // a full discovery loaded everything already
+        if (! lv2World.needsInit)
+            return;
+
+        for (std::vector<uint32_t>::const_iterator it=entry->deps.begin(), end=entry->deps.end(); it != end; ++it)
+        {
+            CARLA_SAFE_ASSERT_CONTINUE(*it < fBundles.size());
+
+            const juce::String& bundle(fBundles[*it].path);
+
+            if (fLoadedBundles.insert(bundle).second)
+                lv2World.loadSingleBundle(bundle.toRawUTF8());
+        }
+    }
+
+private:
+    struct BundleEntry {
+        juce::String path;
+        int64_t modTime;
+    };
+
+    struct PluginEntry {
+        const char* uri; // points into the cache data
+        const uint8_t* data;
+        uint32_t size;
+        std::vector<uint32_t> deps;
+    };
+
+    struct PluginEntrySorter {
+        bool operator()(const PluginEntry& a, const PluginEntry& b) const noexcept
+        {
+            return std::strcmp(a.uri, b.uri) < 0;
+        }
+    };
+
+    // -------------------------------------------------------------------
+    // Binary reader with bounds checking, any read past the end sets the error flag
+
+    struct Reader {
+        const uint8_t* const data;
+        const size_t size;
+        size_t pos;
+        bool error;
+
+        Reader(const uint8_t* const d, const size_t s) noexcept
+            : data(d),
+              size(s),
+              pos(0),
+              error(false) {}
+
+        const uint8_t* skip(const size_t bytes) noexcept
+        {
+            if (error || bytes > size - pos)
+            {
+                error = true;
+                return nullptr;
+            }
+
+            const uint8_t* const ret(data + pos);
+            pos += bytes;
+            return ret;
+        }
+
+        uint32_t readUInt() noexcept
+        {
+            uint32_t value = 0;
+
+            if (const uint8_t* const ptr = skip(sizeof(uint32_t)))
+                std::memcpy(&value, ptr, sizeof(uint32_t));
+
+            return value;
+        }
+
+        int64_t readInt64() noexcept
+        {
+            int64_t value = 0;
+
+            if (const uint8_t* const ptr = skip(sizeof(int64_t)))
+                std::memcpy(&value, ptr, sizeof(int64_t));
+
+            return value;
+        }
+
+        float readFloat() noexcept
+        {
+            float value = 0.0f;
+
+            if (const uint8_t* const ptr = skip(sizeof(float)))
+                std::memcpy(&value, ptr, sizeof(float));
+
+            return value;
+        }
+
+        // returns a pointer into the data, valid while the cache is
+        const char* readString() noexcept
+        {
+            const uint32_t len(readUInt());
+
+            if (len == 0xffffffff)
+                return nullptr;
+
+            const uint8_t* const ptr(skip(static_cast<size_t>(len) + 1));
+
+            if (ptr == nullptr || ptr[len] != '\0')
+            {
+                error = true;
+                return nullptr;
+            }
+
+            return reinterpret_cast<const char*>(ptr);
+        }
+
+        const char* readStringDup()
+        {
+            const char* const str(readString());
+            return (str != nullptr) ? carla_strdup(str) : nullptr;
+        }
+    };
+
+    // -------------------------------------------------------------------
+    // Binary writer
+
+    struct Writer {
+        juce::MemoryOutputStream& out;
+
+        Writer(juce::MemoryOutputStream& o) noexcept
+            : out(o) {}
+
+        void writeUInt(const uint32_t value)
+        {
+            out.write(&value, sizeof(uint32_t));
+        }
+
+        void writeInt64(const int64_t value)
+        {
+            out.write(&value, sizeof(int64_t));
+        }
+
+        void writeFloat(const float value)
+        {
+            out.write(&value, sizeof(float));
+        }
+
+        void writeString(const char* const str)
+        {
+            if (str == nullptr)
+            {
+                writeUInt(0xffffffff);
+                return;
+            }
+
+            const size_t len(std::strlen(str));
+            writeUInt(static_cast<uint32_t>(len));
+            out.write(str, len + 1);
+        }
+    };
+
+    // -------------------------------------------------------------------
+
+    CarlaMutex fMutex;
+    bool fNeedsInit;
+
+    juce::ScopedPointer<juce::MemoryMappedFile> fMappedFile;
+    juce::MemoryBlock fOwnedData; // used if the cache file could not be written
+    const uint8_t* fData;
+    size_t fSize;
+
+    std::vector<BundleEntry> fBundles;
+    std::vector<PluginEntry> fPlugins; // sorted by URI
+    std::set<juce::String> fLoadedBundles;
+
+    Lv2RdfCache()
+        : fMutex(),
+          fNeedsInit(true),
+          fMappedFile(),
+          fOwnedData(),
+          fData(nullptr),
+          fSize(0),
+          fBundles(),
+          fPlugins(),
+          fLoadedBundles() {}
+
+    // -------------------------------------------------------------------
+
+    static juce::File _getCacheFile()
+    {
+#if defined(CARLA_OS_WIN) || defined(CARLA_OS_MAC)
+        const juce::File dir(juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory).getChildFile("falkTX"));
+#else
+        const char* const xdgConfig(std::getenv("XDG_CONFIG_HOME"));
+        const juce::File dir((xdgConfig != nullptr && xdgConfig[0] != '\0')
+                             ? juce::File(xdgConfig).getChildFile("falkTX")
+                             : juce::File::getSpecialLocation(juce::File::userHomeDirectory).getChildFile(".config/falkTX"));
+#endif
+        return dir.getChildFile("CarlaLv2Cache.bin");
+    }
+
+    // a bundle changes when files are added or removed, or when its turtle files are edited
+    static int64_t _getBundleModTime(const juce::File& bundle)
+    {
+        int64_t modTime(bundle.getLastModificationTime().toMilliseconds());
+
+        juce::Array<juce::File> files;
+        bundle.findChildFiles(files, juce::File::findFiles, false, "*.ttl");
+
+        for (juce::File *it=files.begin(), *end=files.end(); it != end; ++it)
+            modTime = std::max<int64_t>(modTime, it->getLastModificationTime().toMilliseconds());
+
+        return modTime;
+    }
+
+    static void _findBundles(const char* const LV2_PATH, std::map<juce::String, int64_t>& bundles)
+    {
+#ifdef CARLA_OS_WIN
+        const juce::StringArray paths(juce::StringArray::fromTokens(LV2_PATH, ";", ""));
+#else
+        const juce::StringArray paths(juce::StringArray::fromTokens(LV2_PATH, ":", ""));
+#endif
+
+        for (const juce::String *it=paths.begin(), *end=paths.end(); it != end; ++it)
+        {
+            const juce::String path(it->trim());
+
+            if (! juce::File::isAbsolutePath(path))
+                continue;
+
+            const juce::File dir(path);
+
+            if (! dir.isDirectory())
+                continue;
+
+            juce::Array<juce::File> subdirs;
+            dir.findChildFiles(subdirs, juce::File::findDirectories, false);
+
+            for (juce::File *sit=subdirs.begin(), *send=subdirs.end(); sit != send; ++sit)
+            {
+                if (! sit->getChildFile("manifest.ttl").existsAsFile())
+                    continue;
+
+                const juce::String bundlePath(sit->getFullPathName());
+
+                // first path wins, same as lilv
+                if (bundles.find(bundlePath) == bundles.end())
+                    bundles[bundlePath] = _getBundleModTime(*sit);
+            }
+        }
+    }
+
+    static juce::String _bundlePathFromURI(const char* const uri)
+    {
+        if (uri == nullptr)
+            return juce::String();
+
+        char* const path(lilv_file_uri_parse(uri, nullptr));
+
+        if (path == nullptr)
+            return juce::String();
+
+        const juce::String ret(juce::File(path).getFullPathName());
+        std::free(path);
+        return ret;
+    }
+
+    const PluginEntry* _findPlugin(const char* const uri) const noexcept
+    {
+        PluginEntry key;
+        key.uri = uri;
+
+        std::vector<PluginEntry>::const_iterator it(std::lower_bound(fPlugins.begin(), fPlugins.end(), key, PluginEntrySorter()));
+
+        if (it == fPlugins.end() || std::strcmp(it->uri, uri) != 0)
+            return nullptr;
+
+        return &(*it);
+    }
+
+    // -------------------------------------------------------------------
+
+    bool _parse(const uint8_t* const data, const size_t size)
+    {
+        fBundles.clear();
+        fPlugins.clear();
+
+        Reader reader(data, size);
+
+        if (reader.readUInt() != kMagic || reader.readUInt() != kVersion)
+            return false;
+
+        const uint32_t bundleCount(reader.readUInt());
+        const uint32_t pluginCount(reader.readUInt());
+
+        if (reader.error)
+            return false;
+
+        for (uint32_t i=0; i < bundleCount && ! reader.error; ++i)
+        {
+            BundleEntry entry;
+            entry.path    = juce::String::fromUTF8(reader.readString());
+            entry.modTime = reader.readInt64();
+            fBundles.push_back(entry);
+        }
+
+        for (uint32_t i=0; i < pluginCount && ! reader.error; ++i)
+        {
+            PluginEntry entry;
+            entry.uri = reader.readString();
+
+            const uint32_t offset(reader.readUInt());
+            entry.size = reader.readUInt();
+
+            const uint32_t depCount(reader.readUInt());
+
+            for (uint32_t j=0; j < depCount && ! reader.error; ++j)
+            {
+                const uint32_t dep(reader.readUInt());
+
+                if (dep < bundleCount)
+                    entry.deps.push_back(dep);
+            }
+
+            if (entry.uri == nullptr || static_cast<size_t>(offset) + entry.size > size)
+                reader.error = true;
+            if (reader.error)
+                break;
+
+            entry.data = data + offset;
+            fPlugins.push_back(entry);
+        }
+
+        if (reader.error)
+        {
+            fBundles.clear();
+            fPlugins.clear();
+            return false;
+        }
+
+        std::sort(fPlugins.begin(), fPlugins.end(), PluginEntrySorter());
+        return true;
+    }
+
+    void _update(const char* const LV2_PATH)
+    {
+        const juce::File cacheFile(_getCacheFile());
+
+        // map existing cache
+        if (cacheFile.existsAsFile())
+        {
+            fMappedFile = new juce::MemoryMappedFile(cacheFile, juce::MemoryMappedFile::readOnly);
+
+            if (fMappedFile->getData() != nullptr && _parse(static_cast<const uint8_t*>(fMappedFile->getData()), fMappedFile->getSize()))
+            {
+                fData = static_cast<const uint8_t*>(fMappedFile->getData());
+                fSize = fMappedFile->getSize();
+            }
+            else
+            {
+                carla_stderr("Lv2RdfCache: ignoring invalid cache file '%s'", cacheFile.getFullPathName().toRawUTF8());
+                fMappedFile = nullptr;
+            }
+        }
+
+        // compare bundles
+        std::map<juce::String, int64_t> bundles;
+        _findBundles(LV2_PATH, bundles);
+
+        std::set<juce::String> changed;
+        std::set<juce::String> oldPaths;
+
+        for (std::vector<BundleEntry>::const_iterator it=fBundles.begin(), end=fBundles.end(); it != end; ++it)
+        {
+            oldPaths.insert(it->path);
+
+            std::map<juce::String, int64_t>::const_iterator bit(bundles.find(it->path));
+
+            // removed or changed
+            if (bit == bundles.end() || bit->second != it->modTime)
+                changed.insert(it->path);
+        }
+
+        for (std::map<juce::String, int64_t>::const_iterator it=bundles.begin(), end=bundles.end(); it != end; ++it)
+        {
+            // added
+            if (oldPaths.find(it->first) == oldPaths.end())
+                changed.insert(it->first);
+        }
+
+        if (fData != nullptr && changed.size() == 0)
+        {
+            carla_debug("Lv2RdfCache: %u plugins loaded from cache", getPluginCount());
+            return;
+        }
+
+        carla_stdout("Lv2RdfCache: %u LV2 bundles changed, updating cache", static_cast<uint>(changed.size()));
+
+        _rebuild(LV2_PATH, bundles, changed);
+    }
+
+    void _rebuild(const char* const LV2_PATH, const std::map<juce::String, int64_t>& bundles, const std::set<juce::String>& changed)
+    {
+        // lilv only reads manifests here, plugin data is parsed just for plugins we regenerate
+        Lv2WorldClass& lv2World(Lv2WorldClass::getInstance());
+        lv2World.initIfNeeded(LV2_PATH);
+
+        // new bundle table and lookup
+        std::vector<BundleEntry> newBundles;
+        std::map<juce::String, uint32_t> bundleIndexes;
+
+        for (std::map<juce::String, int64_t>::const_iterator it=bundles.begin(), end=bundles.end(); it != end; ++it)
+        {
+            BundleEntry entry;
+            entry.path    = it->first;
+            entry.modTime = it->second;
+
+            bundleIndexes[entry.path] = static_cast<uint32_t>(newBundles.size());
+            newBundles.push_back(entry);
+        }
+
+        // plugins that need new data
+        std::set<juce::String> stale;
+
+        // cached plugins depending on a changed bundle
+        for (std::vector<PluginEntry>::const_iterator it=fPlugins.begin(), end=fPlugins.end(); it != end; ++it)
+        {
+            for (std::vector<uint32_t>::const_iterator dit=it->deps.begin(), dend=it->deps.end(); dit != dend; ++dit)
+            {
+                if (changed.find(fBundles[*dit].path) != changed.end())
+                {
+                    stale.insert(juce::String::fromUTF8(it->uri));
+                    break;
+                }
+            }
+        }
+
+        // plugins inside changed bundles
+        const LilvPlugins* const cPlugins(lilv_world_get_all_plugins(lv2World.me));
+
+        LILV_FOREACH(plugins, it, cPlugins)
+        {
+            const LilvPlugin* const cPlugin(lilv_plugins_get(cPlugins, it));
+
+            const juce::String bundle(_bundlePathFromURI(lilv_node_as_uri(lilv_plugin_get_bundle_uri(cPlugin))));
+
+            if (changed.find(bundle) != changed.end())
+                stale.insert(juce::String::fromUTF8(lilv_node_as_uri(lilv_plugin_get_uri(cPlugin))));
+        }
+
+        // plugins with presets inside changed bundles
+        {
+            Lilv::Node seeAlsoNode(lv2World.new_uri(NS_rdfs "seeAlso"));
+            Lilv::Node appliesToNode(lv2World.new_uri(LV2_CORE__appliesTo));
+
+            LilvNodes* const presetNodes(lilv_world_find_nodes(lv2World.me, nullptr, lv2World.rdf_type.me, lv2World.preset_preset.me));
+
+            LILV_FOREACH(nodes, it, presetNodes)
+            {
+                const LilvNode* const presetNode(lilv_nodes_get(presetNodes, it));
+
+                LilvNode* const fileNode(lilv_world_get(lv2World.me, presetNode, seeAlsoNode.me, nullptr));
+
+                if (fileNode == nullptr)
+                    continue;
+
+                const juce::String bundle(_bundlePathFromURI(lilv_node_as_uri(fileNode)));
+                lilv_node_free(fileNode);
+
+                if (changed.find(juce::File(bundle).getParentDirectory().getFullPathName()) == changed.end())
+                    continue;
+
+                if (LilvNode* const pluginNode = lilv_world_get(lv2World.me, presetNode, appliesToNode.me, nullptr))
+                {
+                    if (lilv_node_is_uri(pluginNode))
+                        stale.insert(juce::String::fromUTF8(lilv_node_as_uri(pluginNode)));
+                    lilv_node_free(pluginNode);
+                }
+            }
+
+            lilv_nodes_free(presetNodes);
+        }
+
+        // write the new cache, data blobs first
+        std::vector<juce::String> uris;
+        std::vector<std::vector<uint32_t> > deps;
+        std::vector<std::pair<uint32_t, uint32_t> > blobs;
+        juce::MemoryOutputStream data;
+
+        const std::set<juce::String> staleCopy(stale);
+
+        // unchanged plugins keep their data
+        for (std::vector<PluginEntry>::const_iterator it=fPlugins.begin(), end=fPlugins.end(); it != end; ++it)
+        {
+            const juce::String uri(juce::String::fromUTF8(it->uri));
+
+            if (staleCopy.find(uri) != staleCopy.end())
+                continue;
+
+            std::vector<uint32_t> newDeps;
+            bool valid = true;
+
+            for (std::vector<uint32_t>::const_iterator dit=it->deps.begin(), dend=it->deps.end(); dit != dend; ++dit)
+            {
+                std::map<juce::String, uint32_t>::const_iterator bit(bundleIndexes.find(fBundles[*dit].path));
+
+                if (bit == bundleIndexes.end())
+                {
+                    valid = false;
+                    break;
+                }
+
+                newDeps.push_back(bit->second);
+            }
+
+            if (! valid)
+                continue;
+
+            uris.push_back(uri);
+            deps.push_back(newDeps);
+            blobs.push_back(std::make_pair(static_cast<uint32_t>(data.getDataSize()), it->size));
+            data.write(it->data, it->size);
+        }
+
+        // regenerated plugins
+        uint regenerated = 0;
+
+        for (std::set<juce::String>::const_iterator it=stale.begin(), end=stale.end(); it != end; ++it)
+        {
+            // plugin was removed
+            {
+                Lilv::Node uriNode(lv2World.new_uri(it->toRawUTF8()));
+
+                if (lilv_plugins_get_by_uri(cPlugins, uriNode.me) == nullptr)
+                    continue;
+            }
+
+            const juce::ScopedPointer<const LV2_RDF_Descriptor> desc(lv2_rdf_new(it->toRawUTF8(), true));
+
+            if (desc == nullptr)
+                continue;
+
+            std::vector<uint32_t> newDeps;
+            _collectDeps(lv2World, desc, bundleIndexes, newDeps);
+
+            const uint32_t offset(static_cast<uint32_t>(data.getDataSize()));
+
+            Writer writer(data);
+            _writeDescriptor(writer, desc);
+
+            uris.push_back(*it);
+            deps.push_back(newDeps);
+            blobs.push_back(std::make_pair(offset, static_cast<uint32_t>(data.getDataSize()) - offset));
+            ++regenerated;
+        }
+
+        // header and tables
+        juce::MemoryOutputStream out;
+
+        {
+            Writer writer(out);
+            writer.writeUInt(kMagic);
+            writer.writeUInt(kVersion);
+            writer.writeUInt(static_cast<uint32_t>(newBundles.size()));
+            writer.writeUInt(static_cast<uint32_t>(uris.size()));
+
+            for (std::vector<BundleEntry>::const_iterator it=newBundles.begin(), end=newBundles.end(); it != end; ++it)
+            {
+                writer.writeString(it->path.toRawUTF8());
+                writer.writeInt64(it->modTime);
+            }
+
+            // data offsets are relative to the end of the tables, compute table size first
+            size_t tableSize = 0;
+
+            for (size_t i=0; i < uris.size(); ++i)
+                tableSize += sizeof(uint32_t) + std::strlen(uris[i].toRawUTF8()) + 1 + sizeof(uint32_t)*3 + sizeof(uint32_t)*deps[i].size();
+
+            const uint32_t dataStart(static_cast<uint32_t>(out.getDataSize() + tableSize));
+
+            for (size_t i=0; i < uris.size(); ++i)
+            {
+                writer.writeString(uris[i].toRawUTF8());
+                writer.writeUInt(dataStart + blobs[i].first);
+                writer.writeUInt(blobs[i].second);
+                writer.writeUInt(static_cast<uint32_t>(deps[i].size()));
+
+                for (std::vector<uint32_t>::const_iterator dit=deps[i].begin(), dend=deps[i].end(); dit != dend; ++dit)
+                    writer.writeUInt(*dit);
+            }
+
+            CARLA_SAFE_ASSERT(out.getDataSize() == dataStart);
+
+            out.write(data.getData(), data.getDataSize());
+        }
+
+        // save and map the new file, keep it in memory if that fails
+        fMappedFile = nullptr;
+        fData = nullptr;
+        fSize = 0;
+
+        const juce::File cacheFile(_getCacheFile());
+        cacheFile.getParentDirectory().createDirectory();
+
+        {
+            const juce::TemporaryFile tmpFile(cacheFile);
+
+            if (tmpFile.getFile().replaceWithData(out.getData(), out.getDataSize()) && tmpFile.overwriteTargetFileWithTemporary())
+            {
+                fMappedFile = new juce::MemoryMappedFile(cacheFile, juce::MemoryMappedFile::readOnly);
+
+                if (fMappedFile->getData() != nullptr && _parse(static_cast<const uint8_t*>(fMappedFile->getData()), fMappedFile->getSize()))
+                {
+                    fData = static_cast<const uint8_t*>(fMappedFile->getData());
+                    fSize = fMappedFile->getSize();
+                }
+                else
+                {
+                    fMappedFile = nullptr;
+                }
+            }
+        }
+
+        if (fData == nullptr)
+        {
+            carla_stderr("Lv2RdfCache: failed to write cache file '%s'", cacheFile.getFullPathName().toRawUTF8());
+
+            fOwnedData = out.getMemoryBlock();
+
+            if (_parse(static_cast<const uint8_t*>(fOwnedData.getData()), fOwnedData.getSize()))
+            {
+                fData = static_cast<const uint8_t*>(fOwnedData.getData());
+                fSize = fOwnedData.getSize();
+            }
+        }
+
+        carla_stdout("Lv2RdfCache: %u plugins cached, %u regenerated", getPluginCount(), regenerated);
+    }
+
+    static void _addDep(const std::map<juce::String, uint32_t>& bundleIndexes, const juce::String& path, std::set<uint32_t>& indexes)
+    {
+        std::map<juce::String, uint32_t>::const_iterator it(bundleIndexes.find(path));
+
+        if (it != bundleIndexes.end())
+            indexes.insert(it->second);
+    }
+
+    // bundles a plugin depends on, the plugin's own, its UIs and its presets
+    static void _collectDeps(Lv2WorldClass& lv2World, const LV2_RDF_Descriptor* const desc,
+                             const std::map<juce::String, uint32_t>& bundleIndexes, std::vector<uint32_t>& deps)
+    {
+        std::set<uint32_t> indexes;
+
+        if (desc->Bundle != nullptr)
+            _addDep(bundleIndexes, juce::File(desc->Bundle).getFullPathName(), indexes);
+
+        for (uint32_t i=0; i < desc->UICount; ++i)
+        {
+            if (desc->UIs[i].Bundle != nullptr)
+                _addDep(bundleIndexes, juce::File(desc->UIs[i].Bundle).getFullPathName(), indexes);
+        }
+
+        Lilv::Node seeAlsoNode(lv2World.new_uri(NS_rdfs "seeAlso"));
+
+        for (uint32_t i=0; i < desc->PresetCount; ++i)
+        {
+            if (desc->Presets[i].URI == nullptr)
+                continue;
+
+            LilvNode* const presetNode(lilv_new_uri(lv2World.me, desc->Presets[i].URI));
+            CARLA_SAFE_ASSERT_CONTINUE(presetNode != nullptr);
+
+            if (LilvNode* const fileNode = lilv_world_get(lv2World.me, presetNode, seeAlsoNode.me, nullptr))
+            {
+                _addDep(bundleIndexes, juce::File(_bundlePathFromURI(lilv_node_as_uri(fileNode))).getParentDirectory().getFullPathName(), indexes);
+                lilv_node_free(fileNode);
+            }
+
+            lilv_node_free(presetNode);
+        }
+
+        deps.assign(indexes.begin(), indexes.end());
+    }
+
+    // -------------------------------------------------------------------
+    // Descriptor serialization
+
+    static void _writeFeatures(Writer& writer, const uint32_t count, const LV2_RDF_Feature* const features)
+    {
+        writer.writeUInt(count);
+
+        for (uint32_t i=0; i < count; ++i)
+        {
+            writer.writeUInt(features[i].Required ? 1 : 0);
+            writer.writeString(features[i].URI);
+        }
+    }
+
+    static void _writeExtensions(Writer& writer, const uint32_t count, const LV2_URI* const extensions)
+    {
+        writer.writeUInt(count);
+
+        for (uint32_t i=0; i < count; ++i)
+            writer.writeString(extensions[i]);
+    }
+
+    static void _writeDescriptor(Writer& writer, const LV2_RDF_Descriptor* const desc)
+    {
+        writer.writeUInt(desc->Type[0]);
+        writer.writeUInt(desc->Type[1]);
+        writer.writeString(desc->URI);
+        writer.writeString(desc->Name);
+        writer.writeString(desc->Author);
+        writer.writeString(desc->License);
+        writer.writeString(desc->Binary);
+        writer.writeString(desc->Bundle);
+        writer.writeInt64(static_cast<int64_t>(desc->UniqueID));
+
+        writer.writeUInt(desc->PortCount);
+
+        for (uint32_t i=0; i < desc->PortCount; ++i)
+        {
+            const LV2_RDF_Port& port(desc->Ports[i]);
+
+            writer.writeUInt(port.Types);
+            writer.writeUInt(port.Properties);
+            writer.writeUInt(port.Designation);
+            writer.writeString(port.Name);
+            writer.writeString(port.Symbol);
+
+            writer.writeUInt(port.MidiMap.Type);
+            writer.writeUInt(port.MidiMap.Number);
+
+            writer.writeUInt(port.Points.Hints);
+            writer.writeFloat(port.Points.Default);
+            writer.writeFloat(port.Points.Minimum);
+            writer.writeFloat(port.Points.Maximum);
+
+            writer.writeUInt(port.Unit.Hints);
+            writer.writeString(port.Unit.Name);
+            writer.writeString(port.Unit.Render);
+            writer.writeString(port.Unit.Symbol);
+            writer.writeUInt(port.Unit.Unit);
+
+            writer.writeUInt(port.MinimumSize);
+
+            writer.writeUInt(port.ScalePointCount);
+
+            for (uint32_t j=0; j < port.ScalePointCount; ++j)
+            {
+                writer.writeString(port.ScalePoints[j].Label);
+                writer.writeFloat(port.ScalePoints[j].Value);
+            }
+        }
+
+        writer.writeUInt(desc->PresetCount);
+
+        for (uint32_t i=0; i < desc->PresetCount; ++i)
+        {
+            writer.writeString(desc->Presets[i].URI);
+            writer.writeString(desc->Presets[i].Label);
+        }
+
+        _writeFeatures(writer, desc->FeatureCount, desc->Features);
+        _writeExtensions(writer, desc->ExtensionCount, desc->Extensions);
+
+        writer.writeUInt(desc->UICount);
+
+        for (uint32_t i=0; i < desc->UICount; ++i)
+        {
+            const LV2_RDF_UI& ui(desc->UIs[i]);
+
+            writer.writeUInt(ui.Type);
+            writer.writeString(ui.URI);
+            writer.writeString(ui.Binary);
+            writer.writeString(ui.Bundle);
+
+            _writeFeatures(writer, ui.FeatureCount, ui.Features);
+            _writeExtensions(writer, ui.ExtensionCount, ui.Extensions);
+        }
+    }
+
+    // counts are checked against the remaining data before allocating, so corrupted files cannot cause huge allocations
+    static bool _readCount(Reader& reader, const size_t minItemSize, uint32_t& count) noexcept
+    {
+        count = reader.readUInt();
+
+        if (reader.error || static_cast<size_t>(count) * minItemSize > reader.size - reader.pos)
+        {
+            reader.error = true;
+            count = 0;
+            return false;
+        }
+
+        return true;
+    }
+
+    static bool _readFeatures(Reader& reader, uint32_t& count, LV2_RDF_Feature*& features)
+    {
+        if (! _readCount(reader, sizeof(uint32_t)*2, count))
+            return false;
+
+        if (count == 0)
+            return true;
+
+        features = new LV2_RDF_Feature[count];
+
+        for (uint32_t i=0; i < count; ++i)
+        {
+            features[i].Required = reader.readUInt() != 0;
+            features[i].URI      = reader.readStringDup();
+        }
+
+        return ! reader.error;
+    }
+
+    static bool _readExtensions(Reader& reader, uint32_t& count, LV2_URI*& extensions)
+    {
+        if (! _readCount(reader, sizeof(uint32_t), count))
+            return false;
+
+        if (count == 0)
+            return true;
+
+        extensions = new LV2_URI[count];
+
+        for (uint32_t i=0; i < count; ++i)
+            extensions[i] = reader.readStringDup();
+
+        return ! reader.error;
+    }
+
+    static bool _readDescriptor(Reader& reader, LV2_RDF_Descriptor* const desc)
+    {
+        desc->Type[0]  = reader.readUInt();
+        desc->Type[1]  = reader.readUInt();
+        desc->URI      = reader.readStringDup();
+        desc->Name     = reader.readStringDup();
+        desc->Author   = reader.readStringDup();
+        desc->License  = reader.readStringDup();
+        desc->Binary   = reader.readStringDup();
+        desc->Bundle   = reader.readStringDup();
+        desc->UniqueID = static_cast<ulong>(reader.readInt64());
+
+        if (! _readCount(reader, sizeof(uint32_t)*16, desc->PortCount))
+            return false;
+
+        if (desc->PortCount > 0)
+        {
+            desc->Ports = new LV2_RDF_Port[desc->PortCount];
+
+            for (uint32_t i=0; i < desc->PortCount; ++i)
+            {
+                LV2_RDF_Port& port(desc->Ports[i]);
+
+                port.Types       = reader.readUInt();
+                port.Properties  = reader.readUInt();
+                port.Designation = reader.readUInt();
+                port.Name        = reader.readStringDup();
+                port.Symbol      = reader.readStringDup();
+
+                port.MidiMap.Type   = reader.readUInt();
+                port.MidiMap.Number = reader.readUInt();
+
+                port.Points.Hints   = reader.readUInt();
+                port.Points.Default = reader.readFloat();
+                port.Points.Minimum = reader.readFloat();
+                port.Points.Maximum = reader.readFloat();
+
+                port.Unit.Hints  = reader.readUInt();
+                port.Unit.Name   = reader.readStringDup();
+                port.Unit.Render = reader.readStringDup();
+                port.Unit.Symbol = reader.readStringDup();
+                port.Unit.Unit   = reader.readUInt();
+
+                port.MinimumSize = reader.readUInt();
+
+                if (! _readCount(reader, sizeof(uint32_t)*2, port.ScalePointCount))
+                    return false;
+
+                if (port.ScalePointCount > 0)
+                {
+                    port.ScalePoints = new LV2_RDF_PortScalePoint[port.ScalePointCount];
+
+                    for (uint32_t j=0; j < port.ScalePointCount; ++j)
+                    {
+                        port.ScalePoints[j].Label = reader.readStringDup();
+                        port.ScalePoints[j].Value = reader.readFloat();
+                    }
+                }
+
+                if (reader.error)
+                    return false;
+            }
+        }
+
+        if (! _readCount(reader, sizeof(uint32_t)*2, desc->PresetCount))
+            return false;
+
+        if (desc->PresetCount > 0)
+        {
+            desc->Presets = new LV2_RDF_Preset[desc->PresetCount];
+
+            for (uint32_t i=0; i < desc->PresetCount; ++i)
+            {
+                desc->Presets[i].URI   = reader.readStringDup();
+                desc->Presets[i].Label = reader.readStringDup();
+            }
+        }
+
+        if (! _readFeatures(reader, desc->FeatureCount, desc->Features))
+            return false;
+        if (! _readExtensions(reader, desc->ExtensionCount, desc->Extensions))
+            return false;
+
+        if (! _readCount(reader, sizeof(uint32_t)*6, desc->UICount))
+            return false;
+
+        if (desc->UICount > 0)
+        {
+            desc->UIs = new LV2_RDF_UI[desc->UICount];
+
+            for (uint32_t i=0; i < desc->UICount; ++i)
+            {
+                LV2_RDF_UI& ui(desc->UIs[i]);
+
+                ui.Type   = reader.readUInt();
+                ui.URI    = reader.readStringDup();
+                ui.Binary = reader.readStringDup();
+                ui.Bundle = reader.readStringDup();
+
+                if (! _readFeatures(reader, ui.FeatureCount, ui.Features))
+                    return false;
+                if (! _readExtensions(reader, ui.ExtensionCount, ui.Extensions))
+                    return false;
+            }
+        }
+
+        return ! reader.error;
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(Lv2RdfCache)
+};
+
+// -----------------------------------------------------------------------
+
+#endif // CARLA_LV2_RDF_CACHE_HPP_INCLUDED
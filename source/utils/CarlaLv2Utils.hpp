@@ -246,6 +246,7 @@ public:
     Lilv::Node rdfs_label;
 
     bool needsInit;
+    bool hasBundles; // single bundles were loaded, see loadSingleBundle()
 
     // -------------------------------------------------------------------
 
@@ -364,7 +365,8 @@ public:
           rdf_type           (new_uri(NS_rdf "type")),
           rdfs_label         (new_uri(NS_rdfs "label")),
 
-          needsInit(true)    {}
+          needsInit(true),
+          hasBundles(false)  {}
 
     static Lv2WorldClass& getInstance()
     {
@@ -392,6 +394,25 @@ public:
         Lilv::World::load_bundle(Lilv::Node(new_uri(bundle)));
     }
 
+    // load a single bundle from its path, without a full LV2_PATH discovery
+    void loadSingleBundle(const char* const bundlePath)
+    {
+        CARLA_SAFE_ASSERT_RETURN(bundlePath != nullptr && bundlePath[0] != '\0',);
+
+        CarlaString sBundle(bundlePath);
+
+        if (! sBundle.endsWith(CARLA_OS_SEP))
+            sBundle += CARLA_OS_SEP_STR;
+
+        LilvNode* const bundleNode(lilv_new_file_uri(this->me, nullptr, sBundle));
+        CARLA_SAFE_ASSERT_RETURN(bundleNode != nullptr,);
+
+        lilv_world_load_bundle(this->me, bundleNode);
+        lilv_node_free(bundleNode);
+
+        hasBundles = true;
+    }
+
     uint getPluginCount() const
     {
         CARLA_SAFE_ASSERT_RETURN(! needsInit, 0);
@@ -424,7 +445,7 @@ public:
     const LilvPlugin* getPluginFromURI(const LV2_URI uri) const
     {
         CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', nullptr);
-        CARLA_SAFE_ASSERT_RETURN(! needsInit, nullptr);
+        CARLA_SAFE_ASSERT_RETURN(! needsInit || hasBundles, nullptr);
 
         const LilvPlugins* const cPlugins(lilv_world_get_all_plugins(this->me));
         CARLA_SAFE_ASSERT_RETURN(cPlugins != nullptr, nullptr);
@@ -442,11 +463,14 @@ public:
     {
         CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', nullptr);
         CARLA_SAFE_ASSERT_RETURN(uridMap != nullptr, nullptr);
-        CARLA_SAFE_ASSERT_RETURN(! needsInit, nullptr);
+        CARLA_SAFE_ASSERT_RETURN(! needsInit || hasBundles, nullptr);
 
         LilvNode* const uriNode(lilv_new_uri(this->me, uri));
         CARLA_SAFE_ASSERT_RETURN(uriNode != nullptr, nullptr);
 
+        // presets are only declared in manifests, their data needs to be loaded first
+        lilv_world_load_resource(this->me, uriNode);
+
         LilvState* const cState(lilv_state_new_from_world(this->me, uridMap, uriNode));
         lilv_node_free(uriNode);
 
@@ -963,7 +963,6 @@ void CarlaPipeCommon::writeLv2AtomMessage(const uint32_t index, const LV2_Atom*
     tmpBuf[0xff] = '\0';
 
     const uint32_t atomTotalSize(lv2_atom_total_size(atom));
-    CarlaString base64atom(CarlaString::asBase64(atom, atomTotalSize));
 
     const CarlaMutexLocker cml(pData->writeLock);
 
@@ -976,7 +975,19 @@ void CarlaPipeCommon::writeLv2AtomMessage(const uint32_t index, const LV2_Atom*
         std::snprintf(tmpBuf, 0xff, "%i\n", atomTotalSize);
         _writeMsgBuffer(tmpBuf, std::strlen(tmpBuf));
 
-        writeAndFixMessage(base64atom.buffer());
+        // base64 has no newlines, so it can be encoded straight into the pipe
+        CarlaBase64Encoder encoder;
+        const uint8_t* const atomBytes((const uint8_t*)atom);
+
+        for (uint32_t offset=0; offset < atomTotalSize; offset += 0x80)
+        {
+            const uint32_t size(std::min<uint32_t>(atomTotalSize - offset, 0x80));
+            _writeMsgBuffer(tmpBuf, encoder.encode(atomBytes + offset, size, tmpBuf));
+        }
+
+        const std::size_t lastSize(encoder.finish(tmpBuf));
+        tmpBuf[lastSize] = '\n';
+        _writeMsgBuffer(tmpBuf, lastSize+1);
     }
 
     flushMessages();
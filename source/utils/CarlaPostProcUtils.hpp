@@ -0,0 +1,287 @@
+/*
+ * Carla plugin post-processing utils
+ * Copyright (C) 2015 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#ifndef CARLA_POST_PROC_UTILS_HPP_INCLUDED
+#define CARLA_POST_PROC_UTILS_HPP_INCLUDED
+
+#include "CarlaMathUtils.hpp"
+
+#include <algorithm>
+
+#ifdef __SSE2_MATH__
+# include <xmmintrin.h>
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+// Gains applied by the post-processing stage (dry/wet, volume, balance and panning).
+//
+// Volume, balance and panning are folded into a 2x2 matrix applied to each output pair:
+//   left  = L * ll + R * rl
+//   right = L * lr + R * rr
+// An output without a pair (the last of an odd count) only gets volume.
+// Between two blocks every gain is linearly ramped from its previous value, which avoids zipper noise.
+
+struct CarlaPostProcGains {
+    float dryWet; // 1.0 means fully wet
+    float ll, rl, lr, rr;
+    float single;
+
+    CarlaPostProcGains() noexcept
+        : dryWet(1.0f),
+          ll(1.0f),
+          rl(0.0f),
+          lr(0.0f),
+          rr(1.0f),
+          single(1.0f) {}
+
+    void set(const float newDryWet, const float volume, const float balanceLeft, const float balanceRight, const float panning) noexcept
+    {
+        const float balRangeL = (balanceLeft  + 1.0f)/2.0f;
+        const float balRangeR = (balanceRight + 1.0f)/2.0f;
+        const float volL = (panning > 0.0f) ? volume * (1.0f - panning) : volume;
+        const float volR = (panning < 0.0f) ? volume * (1.0f + panning) : volume;
+
+        dryWet = newDryWet;
+        ll     = volL * (1.0f - balRangeL);
+        rl     = volL * (1.0f - balRangeR);
+        lr     = volR * balRangeL;
+        rr     = volR * balRangeR;
+        single = volume;
+    }
+
+    bool isDryWetNeutral() const noexcept
+    {
+        return carla_isEqual(dryWet, 1.0f);
+    }
+
+    bool isMatrixNeutral() const noexcept
+    {
+        return carla_isEqual(ll, 1.0f) && carla_isZero(rl) && carla_isZero(lr) && carla_isEqual(rr, 1.0f) && carla_isEqual(single, 1.0f);
+    }
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+// kernels, gains go linearly from 'gain' with 'step' increments per frame, output may alias the inputs
+
+/*
+ * out = dry + (wet - dry) * gain
+ */
+static inline
+void carla_postProcDryWet(float* const out, const float* const wet, const float* const dry,
+                          const uint32_t frames, const float gain, const float step) noexcept
+{
+    uint32_t k = 0;
+
+#ifdef __SSE2_MATH__
+    __m128 g(_mm_set_ps(gain + 3.0f*step, gain + 2.0f*step, gain + step, gain));
+    const __m128 s(_mm_set1_ps(4.0f*step));
+
+    for (; k+4 <= frames; k += 4)
+    {
+        const __m128 d(_mm_loadu_ps(dry+k));
+        const __m128 w(_mm_loadu_ps(wet+k));
+        _mm_storeu_ps(out+k, _mm_add_ps(d, _mm_mul_ps(_mm_sub_ps(w, d), g)));
+        g = _mm_add_ps(g, s);
+    }
+#endif
+
+    for (; k < frames; ++k)
+        out[k] = dry[k] + (wet[k] - dry[k]) * (gain + static_cast<float>(k) * step);
+}
+
+/*
+ * out = in * gain
+ */
+static inline
+void carla_postProcGain(float* const out, const float* const in,
+                        const uint32_t frames, const float gain, const float step) noexcept
+{
+    uint32_t k = 0;
+
+#ifdef __SSE2_MATH__
+    __m128 g(_mm_set_ps(gain + 3.0f*step, gain + 2.0f*step, gain + step, gain));
+    const __m128 s(_mm_set1_ps(4.0f*step));
+
+    for (; k+4 <= frames; k += 4)
+    {
+        _mm_storeu_ps(out+k, _mm_mul_ps(_mm_loadu_ps(in+k), g));
+        g = _mm_add_ps(g, s);
+    }
+#endif
+
+    for (; k < frames; ++k)
+        out[k] = in[k] * (gain + static_cast<float>(k) * step);
+}
+
+/*
+ * Stereo matrix, from the gains in 'start' to the ones in 'end' (excluded).
+ */
+static inline
+void carla_postProcMatrix(float* const outL, float* const outR, const float* const inL, const float* const inR,
+                          const uint32_t frames, const CarlaPostProcGains& start, const CarlaPostProcGains& end) noexcept
+{
+    const float fframes = static_cast<float>(frames);
+    const float sll = (end.ll - start.ll) / fframes;
+    const float srl = (end.rl - start.rl) / fframes;
+    const float slr = (end.lr - start.lr) / fframes;
+    const float srr = (end.rr - start.rr) / fframes;
+
+    uint32_t k = 0;
+
+#ifdef __SSE2_MATH__
+    __m128 ll(_mm_set_ps(start.ll + 3.0f*sll, start.ll + 2.0f*sll, start.ll + sll, start.ll));
+    __m128 rl(_mm_set_ps(start.rl + 3.0f*srl, start.rl + 2.0f*srl, start.rl + srl, start.rl));
+    __m128 lr(_mm_set_ps(start.lr + 3.0f*slr, start.lr + 2.0f*slr, start.lr + slr, start.lr));
+    __m128 rr(_mm_set_ps(start.rr + 3.0f*srr, start.rr + 2.0f*srr, start.rr + srr, start.rr));
+    const __m128 s4ll(_mm_set1_ps(4.0f*sll));
+    const __m128 s4rl(_mm_set1_ps(4.0f*srl));
+    const __m128 s4lr(_mm_set1_ps(4.0f*slr));
+    const __m128 s4rr(_mm_set1_ps(4.0f*srr));
+
+    for (; k+4 <= frames; k += 4)
+    {
+        const __m128 l(_mm_loadu_ps(inL+k));
+        const __m128 r(_mm_loadu_ps(inR+k));
+        _mm_storeu_ps(outL+k, _mm_add_ps(_mm_mul_ps(l, ll), _mm_mul_ps(r, rl)));
+        _mm_storeu_ps(outR+k, _mm_add_ps(_mm_mul_ps(l, lr), _mm_mul_ps(r, rr)));
+        ll = _mm_add_ps(ll, s4ll);
+        rl = _mm_add_ps(rl, s4rl);
+        lr = _mm_add_ps(lr, s4lr);
+        rr = _mm_add_ps(rr, s4rr);
+    }
+#endif
+
+    for (; k < frames; ++k)
+    {
+        const float fk = static_cast<float>(k);
+        const float l  = inL[k];
+        const float r  = inR[k];
+        outL[k] = l * (start.ll + fk*sll) + r * (start.rl + fk*srl);
+        outR[k] = l * (start.lr + fk*slr) + r * (start.rr + fk*srr);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// full post-processing stage
+
+struct CarlaPostProcBuffers {
+    // dry signal, may be null. one channel means it is shared by all outputs
+    const float* const* dry;
+    uint32_t dryChannels;
+
+    // older dry signal to play before 'dry', for plugins with latency. may be null
+    const float* const* delayed;
+    uint32_t delayedFrames;
+
+    // plugin output and final destination, may be the same buffers
+    const float* const* wet;
+    float* const* out;
+    uint32_t outChannels;
+
+    // offsets for 'dry' and 'wet', and for 'out'
+    uint32_t inOffset;
+    uint32_t outOffset;
+};
+
+/*
+ * Run the post-processing stage over 'frames', ramping from 'current' to 'target'.
+ * 'current' is updated to 'target' afterwards.
+ * When both are neutral this becomes a copy, or nothing at all if the output is processed in-place.
+ */
+static inline
+void carla_postProcess(const CarlaPostProcBuffers& buf, CarlaPostProcGains& current, const CarlaPostProcGains& target,
+                       const uint32_t frames) noexcept
+{
+    if (frames == 0)
+        return;
+
+    const bool doDryWet = !(current.isDryWetNeutral() && target.isDryWetNeutral());
+    const bool doMatrix = !(current.isMatrixNeutral() && target.isMatrixNeutral());
+    const float fframes = static_cast<float>(frames);
+
+    // Dry/Wet, writes into 'out'
+    if (doDryWet)
+    {
+        const float dryWetStep = (target.dryWet - current.dryWet) / fframes;
+
+        for (uint32_t i=0; i < buf.outChannels; ++i)
+        {
+            const float* const wet(buf.wet[i] + buf.inOffset);
+            float* const out(buf.out[i] + buf.outOffset);
+            const uint32_t c = (buf.dryChannels == 1) ? 0 : i;
+
+            if (buf.dry == nullptr || c >= buf.dryChannels)
+            {
+                carla_postProcGain(out, wet, frames, current.dryWet, dryWetStep);
+                continue;
+            }
+
+            uint32_t k = 0;
+
+            if (buf.delayed != nullptr && buf.delayedFrames > 0)
+            {
+                k = std::min(buf.delayedFrames, frames);
+                carla_postProcDryWet(out, wet, buf.delayed[c], k, current.dryWet, dryWetStep);
+            }
+
+            if (k < frames)
+                carla_postProcDryWet(out+k, wet+k, buf.dry[c] + buf.inOffset, frames-k,
+                                     current.dryWet + static_cast<float>(k)*dryWetStep, dryWetStep);
+        }
+    }
+
+    // Volume, balance and panning, reads from 'out' if dry/wet was done
+    if (doMatrix)
+    {
+        const float singleStep = (target.single - current.single) / fframes;
+        const uint32_t inOffset = doDryWet ? buf.outOffset : buf.inOffset;
+
+        for (uint32_t i=0; i < buf.outChannels; i += 2)
+        {
+            const float* const inL((doDryWet ? buf.out[i] : buf.wet[i]) + inOffset);
+            float* const outL(buf.out[i] + buf.outOffset);
+
+            if (i+1 == buf.outChannels)
+            {
+                carla_postProcGain(outL, inL, frames, current.single, singleStep);
+                break;
+            }
+
+            const float* const inR((doDryWet ? buf.out[i+1] : buf.wet[i+1]) + inOffset);
+            float* const outR(buf.out[i+1] + buf.outOffset);
+
+            carla_postProcMatrix(outL, outR, inL, inR, frames, current, target);
+        }
+    }
+    else if (! doDryWet)
+    {
+        for (uint32_t i=0; i < buf.outChannels; ++i)
+        {
+            const float* const wet(buf.wet[i] + buf.inOffset);
+            float* const out(buf.out[i] + buf.outOffset);
+
+            if (wet != out)
+                std::memcpy(out, wet, sizeof(float)*frames);
+        }
+    }
+
+    current = target;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+#endif // CARLA_POST_PROC_UTILS_HPP_INCLUDED
@@ -0,0 +1,576 @@
+/*
+ * Carla lock-free real-time memory pool
+ * Copyright (C) 2015 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#ifndef CARLA_RT_MEM_POOL_HPP_INCLUDED
+#define CARLA_RT_MEM_POOL_HPP_INCLUDED
+
+#include "CarlaSemUtils.hpp"
+#include "CarlaThread.hpp"
+#include "LinkedList.hpp"
+
+// -----------------------------------------------------------------------
+// Fixed-size block pool, safe to allocate and deallocate from any thread.
+//
+// Free blocks live in a lock-free stack, addressed by 32-bit block indexes so that the head can
+// carry a change counter against ABA. Blocks are carved out of slabs that never move or shrink
+// until the pool is resized or destroyed, so stale indexes always point to valid memory.
+//
+// The first threads to allocate without sleeping (usually audio threads) get a private cache,
+// filled from and flushed to the shared stack in batches of several blocks per atomic operation.
+// A thread gives its caches back with releaseThreadCache() or releaseAllThreadCaches(), which must
+// be done before it exits, otherwise the cache and the blocks in it stay claimed until the pool is
+// destroyed or resized.
+// When the shared stack runs low a non-RT thread adds a new slab, so real-time allocations do not
+// fail as long as the refill keeps up. The sleepy variant adds a slab itself if needed.
+//
+// minPreallocated is the number of blocks available after creation, maxPreallocated the number
+// of blocks added on each refill (rounded up to a power of 2).
+
+class CarlaRtMemPool
+{
+public:
+    static const uint32_t kMaxSlabs   = 64;
+    static const uint32_t kMaxCaches  = 4;
+    static const uint32_t kCacheSize  = 32;
+    static const uint32_t kHeaderSize = 16;
+
+    CarlaRtMemPool(const std::size_t dataSize, const std::size_t minPreallocated, const std::size_t maxPreallocated) noexcept
+        : fSlabMutex(),
+          fDataSize(dataSize),
+          fBlockSize(0),
+          fSlabShift(0),
+          fBatchSize(1),
+          fLowWater(0),
+          fHead(0),
+          fFreeCount(0),
+          fSlabCount(0),
+          fFailedCount(0),
+          fRefillRequested(false)
+    {
+        carla_zeroPointers(fSlabs, kMaxSlabs);
+        carla_zeroStructs(fCaches, kMaxCaches);
+
+        _init(minPreallocated, maxPreallocated);
+
+        Refiller::getInstance().registerPool(this);
+    }
+
+    ~CarlaRtMemPool() noexcept
+    {
+        Refiller::getInstance().unregisterPool(this);
+
+        const CarlaMutexLocker cml(fSlabMutex);
+        _clear();
+    }
+
+    // -------------------------------------------------------------------
+
+    // will not sleep, returns null if no block is available
+    void* allocate_atomic() noexcept
+    {
+        uint32_t index = 0;
+
+        if (Cache* const cache = _getCache(true))
+        {
+            if (cache->count == 0)
+                cache->count = _pop(cache->blocks, fBatchSize);
+
+            if (cache->count != 0)
+                index = cache->blocks[--cache->count];
+        }
+        else
+        {
+            _pop(&index, 1);
+        }
+
+        if (__atomic_load_n(&fFreeCount, __ATOMIC_RELAXED) < fLowWater)
+            _requestRefill();
+
+        if (index == 0)
+        {
+            __atomic_add_fetch(&fFailedCount, 1, __ATOMIC_RELAXED);
+            return nullptr;
+        }
+
+        return _getHeader(index) + kHeaderSize;
+    }
+
+    // may sleep, only fails if memory is exhausted or the pool reached its maximum size
+    void* allocate_sleepy() noexcept
+    {
+        uint32_t index = 0;
+
+        if (_pop(&index, 1) == 0)
+        {
+            {
+                const CarlaMutexLocker cml(fSlabMutex);
+
+                if (__atomic_load_n(&fFreeCount, __ATOMIC_ACQUIRE) == 0)
+                    _addSlab();
+            }
+
+            if (_pop(&index, 1) == 0)
+                return nullptr;
+        }
+
+        return _getHeader(index) + kHeaderSize;
+    }
+
+    // will not sleep
+    void deallocate(void* const dataPtr) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(dataPtr != nullptr,);
+
+        const uint32_t index(((BlockHeader*)((uint8_t*)dataPtr - kHeaderSize))->index);
+        CARLA_SAFE_ASSERT_RETURN(index != 0,);
+
+        if (Cache* const cache = _getCache(false))
+        {
+            // keep the most recently used blocks, give the oldest back
+            if (cache->count == kCacheSize)
+            {
+                _push(cache->blocks, fBatchSize);
+
+                cache->count -= fBatchSize;
+                std::memmove(cache->blocks, cache->blocks + fBatchSize, sizeof(uint32_t)*cache->count);
+            }
+
+            cache->blocks[cache->count++] = index;
+            return;
+        }
+
+        _push(&index, 1);
+    }
+
+    // will not sleep, gives the calling thread cache back to the shared stack and frees it for other threads
+    void releaseThreadCache() noexcept
+    {
+        if (Cache* const cache = _getCache(false))
+            _releaseCache(*cache);
+    }
+
+    // gives back the caches of all threads, must not be used while other threads use the pool
+    void flushCaches() noexcept
+    {
+        for (uint32_t i=0; i < kMaxCaches; ++i)
+        {
+            if (__atomic_load_n(&fCaches[i].owner, __ATOMIC_ACQUIRE) != nullptr)
+                _releaseCache(fCaches[i]);
+        }
+    }
+
+    // non-RT, releases the calling thread cache of every pool, to be called by threads that are about to exit
+    static void releaseAllThreadCaches() noexcept
+    {
+        Refiller::getInstance().releaseThreadCaches();
+    }
+
+    // must not be used while blocks are allocated or other threads use the pool
+    void resize(const std::size_t minPreallocated, const std::size_t maxPreallocated) noexcept
+    {
+        const CarlaMutexLocker cml(fSlabMutex);
+
+        _clear();
+        _init(minPreallocated, maxPreallocated);
+    }
+
+    // -------------------------------------------------------------------
+
+    // blocks in the shared stack, not counting thread caches
+    uint32_t getFreeCount() const noexcept
+    {
+        return __atomic_load_n(&fFreeCount, __ATOMIC_RELAXED);
+    }
+
+    uint32_t getTotalCount() const noexcept
+    {
+        return __atomic_load_n(&fSlabCount, __ATOMIC_RELAXED) << fSlabShift;
+    }
+
+    // number of non-sleepy allocations that found no free block
+    uint32_t getFailedCount() const noexcept
+    {
+        return __atomic_load_n(&fFailedCount, __ATOMIC_RELAXED);
+    }
+
+    // -------------------------------------------------------------------
+
+private:
+    struct BlockHeader {
+        uint32_t next;  // next free block, only valid while in the shared stack
+        uint32_t index; // this block, 1-based
+    };
+
+    struct Cache {
+        const void* owner;
+        uint32_t count;
+        uint32_t blocks[kCacheSize];
+    };
+
+    // non-RT thread that refills all pools running low
+    class Refiller : public CarlaThread
+    {
+    public:
+        static Refiller& getInstance()
+        {
+            static Refiller sRefiller;
+            return sRefiller;
+        }
+
+        void registerPool(CarlaRtMemPool* const pool) noexcept
+        {
+            const CarlaMutexLocker cml1(fThreadMutex);
+
+            {
+                const CarlaMutexLocker cml2(fPoolsMutex);
+                fPools.append(pool);
+            }
+
+            if (! isThreadRunning())
+                startThread();
+        }
+
+        void unregisterPool(CarlaRtMemPool* const pool) noexcept
+        {
+            const CarlaMutexLocker cml1(fThreadMutex);
+            bool isEmpty;
+
+            {
+                const CarlaMutexLocker cml2(fPoolsMutex);
+                fPools.removeOne(pool);
+                isEmpty = fPools.isEmpty();
+            }
+
+            if (isEmpty)
+                _stop();
+        }
+
+        void releaseThreadCaches() noexcept
+        {
+            const CarlaMutexLocker cml(fPoolsMutex);
+
+            for (LinkedList<CarlaRtMemPool*>::Itenerator it = fPools.begin2(); it.valid(); it.next())
+            {
+                CarlaRtMemPool* const pool(it.getValue(nullptr));
+                CARLA_SAFE_ASSERT_CONTINUE(pool != nullptr);
+
+                pool->releaseThreadCache();
+            }
+        }
+
+        void wake() noexcept
+        {
+            if (fSemValid)
+                carla_sem_post(fSem);
+        }
+
+    protected:
+        void run() override
+        {
+            for (; ! shouldThreadExit();)
+            {
+#ifdef CARLA_OS_MAC
+                carla_msleep(5);
+#else
+                if (fSemValid)
+                    carla_sem_timedwait(fSem, 1);
+                else
+                    carla_msleep(5);
+#endif
+                const CarlaMutexLocker cml(fPoolsMutex);
+
+                for (LinkedList<CarlaRtMemPool*>::Itenerator it = fPools.begin2(); it.valid(); it.next())
+                {
+                    CarlaRtMemPool* const pool(it.getValue(nullptr));
+                    CARLA_SAFE_ASSERT_CONTINUE(pool != nullptr);
+
+                    pool->_refill();
+                }
+            }
+        }
+
+    private:
+        CarlaMutex fThreadMutex;
+        CarlaMutex fPoolsMutex;
+        LinkedList<CarlaRtMemPool*> fPools;
+        carla_sem_t fSem;
+        bool fSemValid;
+
+        Refiller() noexcept
+            : CarlaThread("CarlaRtMemPoolRefiller"),
+              fThreadMutex(),
+              fPoolsMutex(),
+              fPools(),
+              fSem(),
+              fSemValid(carla_sem_create2(fSem)) {}
+
+        ~Refiller() noexcept override
+        {
+            _stop();
+
+            if (fSemValid)
+                carla_sem_destroy2(fSem);
+        }
+
+        void _stop() noexcept
+        {
+            if (! isThreadRunning())
+                return;
+
+            signalThreadShouldExit();
+            wake();
+            stopThread(-1);
+        }
+
+        CARLA_DECLARE_NON_COPY_CLASS(Refiller)
+    };
+
+    CarlaMutex fSlabMutex;
+
+    const std::size_t fDataSize;
+    uint32_t fBlockSize;
+    uint32_t fSlabShift;
+    uint32_t fBatchSize;
+    uint32_t fLowWater;
+
+    uint64_t fHead; // change counter in the high 32 bits, first free block index in the low
+    uint32_t fFreeCount;
+    uint32_t fSlabCount;
+    uint32_t fFailedCount;
+    bool fRefillRequested;
+
+    uint8_t* fSlabs[kMaxSlabs];
+    Cache fCaches[kMaxCaches];
+
+    // -------------------------------------------------------------------
+
+    static const void* _getThreadMarker() noexcept
+    {
+        static __thread char sMarker;
+        return &sMarker;
+    }
+
+    uint8_t* _getHeader(const uint32_t index) const noexcept
+    {
+        const uint32_t block(index - 1);
+        return fSlabs[block >> fSlabShift] + (block & ((1U << fSlabShift) - 1)) * fBlockSize;
+    }
+
+    uint32_t _getNext(const uint32_t index) const noexcept
+    {
+        return __atomic_load_n(&((BlockHeader*)_getHeader(index))->next, __ATOMIC_RELAXED);
+    }
+
+    void _setNext(const uint32_t index, const uint32_t next) noexcept
+    {
+        __atomic_store_n(&((BlockHeader*)_getHeader(index))->next, next, __ATOMIC_RELAXED);
+    }
+
+    // returns the calling thread cache, optionally claiming a free one
+    Cache* _getCache(const bool claim) noexcept
+    {
+        const void* const marker(_getThreadMarker());
+
+        for (uint32_t i=0; i < kMaxCaches; ++i)
+        {
+            if (__atomic_load_n(&fCaches[i].owner, __ATOMIC_RELAXED) == marker)
+                return &fCaches[i];
+        }
+
+        if (! claim)
+            return nullptr;
+
+        for (uint32_t i=0; i < kMaxCaches; ++i)
+        {
+            const void* owner = nullptr;
+
+            if (__atomic_compare_exchange_n(&fCaches[i].owner, &owner, marker, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+                return &fCaches[i];
+        }
+
+        return nullptr;
+    }
+
+    void _releaseCache(Cache& cache) noexcept
+    {
+        if (cache.count != 0)
+        {
+            _push(cache.blocks, cache.count);
+            cache.count = 0;
+        }
+
+        __atomic_store_n(&cache.owner, nullptr, __ATOMIC_RELEASE);
+    }
+
+    // take up to maxCount blocks from the shared stack with a single exchange
+    uint32_t _pop(uint32_t* const indexes, const uint32_t maxCount) noexcept
+    {
+        uint64_t head(__atomic_load_n(&fHead, __ATOMIC_ACQUIRE));
+
+        for (;;)
+        {
+            uint32_t index(static_cast<uint32_t>(head));
+            uint32_t count = 0;
+
+            if (index == 0)
+                return 0;
+
+            // the links can change under us, but then so does the head counter and the exchange fails
+            for (; index != 0 && count < maxCount; ++count)
+            {
+                indexes[count] = index;
+                index = _getNext(index);
+            }
+
+            const uint64_t newHead(((head >> 32) + 1) << 32 | index);
+
+            if (__atomic_compare_exchange_n(&fHead, &head, newHead, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            {
+                __atomic_sub_fetch(&fFreeCount, count, __ATOMIC_RELAXED);
+                return count;
+            }
+        }
+    }
+
+    // give count blocks back to the shared stack with a single exchange
+    void _push(const uint32_t* const indexes, const uint32_t count) noexcept
+    {
+        for (uint32_t i=1; i < count; ++i)
+            _setNext(indexes[i-1], indexes[i]);
+
+        _pushChain(indexes[0], indexes[count-1], count);
+    }
+
+    void _pushChain(const uint32_t first, const uint32_t last, const uint32_t count) noexcept
+    {
+        uint64_t head(__atomic_load_n(&fHead, __ATOMIC_RELAXED));
+
+        for (;;)
+        {
+            _setNext(last, static_cast<uint32_t>(head));
+
+            const uint64_t newHead(((head >> 32) + 1) << 32 | first);
+
+            if (__atomic_compare_exchange_n(&fHead, &head, newHead, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+                break;
+        }
+
+        __atomic_add_fetch(&fFreeCount, count, __ATOMIC_RELAXED);
+    }
+
+    void _requestRefill() noexcept
+    {
+        if (__atomic_exchange_n(&fRefillRequested, true, __ATOMIC_ACQ_REL))
+            return;
+
+        Refiller::getInstance().wake();
+    }
+
+    // -------------------------------------------------------------------
+    // non-RT
+
+    void _init(const std::size_t minPreallocated, const std::size_t maxPreallocated) noexcept
+    {
+        fBlockSize = static_cast<uint32_t>((kHeaderSize + fDataSize + kHeaderSize - 1) / kHeaderSize * kHeaderSize);
+
+        fSlabShift = 4;
+        while (fSlabShift < 16 && (1U << fSlabShift) < maxPreallocated)
+            ++fSlabShift;
+
+        const uint32_t slabBlocks(1U << fSlabShift);
+
+        fLowWater  = slabBlocks / 2;
+        fBatchSize = carla_fixedValue<uint32_t>(1U, kCacheSize/2, slabBlocks/8);
+
+        do {
+            if (! _addSlab())
+                break;
+        } while (getTotalCount() < minPreallocated);
+    }
+
+    void _clear() noexcept
+    {
+        for (uint32_t i=0; i < kMaxSlabs; ++i)
+        {
+            if (fSlabs[i] == nullptr)
+                continue;
+
+            delete[] fSlabs[i];
+            fSlabs[i] = nullptr;
+        }
+
+        carla_zeroStructs(fCaches, kMaxCaches);
+
+        fHead        = 0;
+        fFreeCount   = 0;
+        fSlabCount   = 0;
+        fFailedCount = 0;
+        fRefillRequested = false;
+    }
+
+    // fSlabMutex must be locked
+    bool _addSlab() noexcept
+    {
+        const uint32_t slabIndex(fSlabCount);
+        CARLA_SAFE_ASSERT_RETURN(slabIndex < kMaxSlabs, false);
+
+        const uint32_t slabBlocks(1U << fSlabShift);
+        uint8_t* slab;
+
+        try {
+            slab = new uint8_t[slabBlocks * fBlockSize];
+        } CARLA_SAFE_EXCEPTION_RETURN("CarlaRtMemPool::_addSlab", false);
+
+        const uint32_t first((slabIndex << fSlabShift) + 1);
+
+        for (uint32_t i=0; i < slabBlocks; ++i)
+        {
+            BlockHeader* const header((BlockHeader*)(slab + i*fBlockSize));
+            header->index = first + i;
+            header->next  = (i+1 < slabBlocks) ? first + i + 1 : 0;
+        }
+
+        fSlabs[slabIndex] = slab;
+        __atomic_store_n(&fSlabCount, slabIndex + 1, __ATOMIC_RELEASE);
+
+        _pushChain(first, first + slabBlocks - 1, slabBlocks);
+        return true;
+    }
+
+    void _refill() noexcept
+    {
+        if (! __atomic_load_n(&fRefillRequested, __ATOMIC_ACQUIRE))
+            return;
+
+        const CarlaMutexLocker cml(fSlabMutex);
+
+        while (__atomic_load_n(&fFreeCount, __ATOMIC_RELAXED) < fLowWater)
+        {
+            if (! _addSlab())
+                break;
+        }
+
+        __atomic_store_n(&fRefillRequested, false, __ATOMIC_RELEASE);
+    }
+
+    CARLA_PREVENT_HEAP_ALLOCATION
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaRtMemPool)
+};
+
+// -----------------------------------------------------------------------
+
+#endif // CARLA_RT_MEM_POOL_HPP_INCLUDED
@@ -25,8 +25,9 @@
 #ifdef CARLA_OS_WIN
 struct carla_sem_t { HANDLE handle; };
 #elif defined(CARLA_OS_MAC)
-// TODO
-struct carla_sem_t { char dummy; };
+// Mach semaphores, these only work within the process that created them
+# include <mach/mach.h>
+struct carla_sem_t { semaphore_t sem; };
 #else
 # include <sys/time.h>
 # include <sys/types.h>
@@ -50,7 +51,7 @@ bool carla_sem_create2(carla_sem_t& sem) noexcept
 
     return (sem.handle != INVALID_HANDLE_VALUE);
 #elif defined(CARLA_OS_MAC)
-    return false; // TODO
+    return (::semaphore_create(::mach_task_self(), &sem.sem, SYNC_POLICY_FIFO, 0) == KERN_SUCCESS);
 #else
     return (::sem_init(&sem.sem, 1, 0) == 0);
 #endif
@@ -82,7 +83,7 @@ void carla_sem_destroy2(carla_sem_t& sem) noexcept
 #if defined(CARLA_OS_WIN)
     ::CloseHandle(sem.handle);
 #elif defined(CARLA_OS_MAC)
-    // TODO
+    ::semaphore_destroy(::mach_task_self(), sem.sem);
 #else
     ::sem_destroy(&sem.sem);
 #endif
@@ -109,7 +110,7 @@ void carla_sem_post(carla_sem_t& sem) noexcept
 #ifdef CARLA_OS_WIN
     ::ReleaseSemaphore(sem.handle, 1, nullptr);
 #elif defined(CARLA_OS_MAC)
-    // TODO
+    ::semaphore_signal(sem.sem);
 #else
     ::sem_post(&sem.sem);
 #endif
@@ -126,7 +127,11 @@ bool carla_sem_timedwait(carla_sem_t& sem, const uint secs) noexcept
 #if defined(CARLA_OS_WIN)
     return (::WaitForSingleObject(sem.handle, secs*1000) == WAIT_OBJECT_0);
 #elif defined(CARLA_OS_MAC)
-    // TODO
+    mach_timespec_t timeout;
+    timeout.tv_sec  = secs;
+    timeout.tv_nsec = 0;
+
+    return (::semaphore_timedwait(sem.sem, timeout) == KERN_SUCCESS);
 #else
     timespec timeout;
 # ifdef CARLA_OS_LINUX
@@ -145,6 +150,47 @@ bool carla_sem_timedwait(carla_sem_t& sem, const uint secs) noexcept
 #endif
 }
 
+/*
+ * Wait for a semaphore (lock), with a timeout in microseconds.
+ */
+static inline
+bool carla_sem_timedwait_usecs(carla_sem_t& sem, const uint usecs) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(usecs > 0, false);
+
+#if defined(CARLA_OS_WIN)
+    return (::WaitForSingleObject(sem.handle, (usecs+999)/1000) == WAIT_OBJECT_0);
+#elif defined(CARLA_OS_MAC)
+    mach_timespec_t timeout;
+    timeout.tv_sec  = usecs / 1000000;
+    timeout.tv_nsec = static_cast<clock_res_t>(usecs % 1000000) * 1000;
+
+    return (::semaphore_timedwait(sem.sem, timeout) == KERN_SUCCESS);
+#else
+    timespec timeout;
+# ifdef CARLA_OS_LINUX
+    ::clock_gettime(CLOCK_REALTIME, &timeout);
+# else
+    timeval now;
+    ::gettimeofday(&now, nullptr);
+    timeout.tv_sec  = now.tv_sec;
+    timeout.tv_nsec = now.tv_usec * 1000;
+# endif
+    timeout.tv_sec  += static_cast<time_t>(usecs / 1000000);
+    timeout.tv_nsec += static_cast<long>(usecs % 1000000) * 1000;
+
+    if (timeout.tv_nsec >= 1000000000)
+    {
+        timeout.tv_sec  += 1;
+        timeout.tv_nsec -= 1000000000;
+    }
+
+    try {
+        return (::sem_timedwait(&sem.sem, &timeout) == 0);
+    } CARLA_SAFE_EXCEPTION_RETURN("sem_timedwait", false);
+#endif
+}
+
 // -----------------------------------------------------------------------
 
 #endif // CARLA_SEM_UTILS_HPP_INCLUDED
@@ -18,97 +18,48 @@
 #include "CarlaStateUtils.hpp"
 
 #include "CarlaBackendUtils.hpp"
+#include "CarlaBase64Utils.hpp"
 #include "CarlaMathUtils.hpp"
 #include "CarlaMIDI.h"
-
-#include <string>
-
+#include "CarlaXmlUtils.hpp"
+
+using juce::File;
+using juce::FileOutputStream;
+using juce::GZIPCompressorOutputStream;
+using juce::GZIPDecompressorInputStream;
+using juce::MemoryInputStream;
+using juce::MemoryMappedFile;
 using juce::MemoryOutputStream;
+using juce::OutputStream;
 using juce::String;
-using juce::XmlElement;
+using juce::TemporaryFile;
 
 CARLA_BACKEND_START_NAMESPACE
 
 // -----------------------------------------------------------------------
-// getNewLineSplittedString
+// helpers
 
-static void getNewLineSplittedString(MemoryOutputStream& stream, const String& string)
+static String getJuceString(const std::string& text)
 {
-    static const int kLineWidth = 120;
-
-    int i = 0;
-    const int length = string.length();
-    const char* const raw = string.toUTF8();
-
-    stream.preallocate(static_cast<std::size_t>(length + length/kLineWidth + 3));
-
-    for (; i+kLineWidth < length; i += kLineWidth)
-    {
-        stream.write(raw+i, kLineWidth);
-        stream.writeByte('\n');
-    }
-
-    stream << (raw+i);
+    return String(juce::CharPointer_UTF8(text.c_str()));
 }
 
-// -----------------------------------------------------------------------
-// xmlSafeStringFast
-
-/* Based on some code by James Kanze from stackoverflow
- * https://stackoverflow.com/questions/7724011/in-c-whats-the-fastest-way-to-replace-all-occurrences-of-a-substring-within */
-
-static std::string replaceStdString(const std::string& original, const std::string& before, const std::string& after)
+static void writeBase64Lines(OutputStream& stream, const uint8_t* const data, const std::size_t size)
 {
-    std::string::const_iterator current = original.begin(), end = original.end(), next;
-    std::string retval;
+    // 90 bytes give exactly 120 characters per line
+    static const std::size_t kBytesPerLine = 90;
 
-    for (; (next = std::search(current, end, before.begin(), before.end())) != end;)
-    {
-        retval.append(current, next);
-        retval.append(after);
-        current = next + static_cast<ssize_t>(before.size());
-    }
-    retval.append(current, next);
-    return retval;
-}
+    char line[128];
 
-static std::string xmlSafeStringFast(const char* const cstring, const bool toXml)
-{
-    std::string string(cstring);
-
-    if (toXml)
+    for (std::size_t i=0; i < size; i += kBytesPerLine)
     {
-        string = replaceStdString(string, "&","&amp;");
-        string = replaceStdString(string, "<","&lt;");
-        string = replaceStdString(string, ">","&gt;");
-        string = replaceStdString(string, "'","&apos;");
-        string = replaceStdString(string, "\"","&quot;");
-    }
-    else
-    {
-        string = replaceStdString(string, "&lt;","<");
-        string = replaceStdString(string, "&gt;",">");
-        string = replaceStdString(string, "&apos;","'");
-        string = replaceStdString(string, "&quot;","\"");
-        string = replaceStdString(string, "&amp;","&");
-    }
+        const std::size_t lineSize(carla_base64Encode(data+i, std::min(kBytesPerLine, size-i), line));
 
-    return string;
-}
+        if (i != 0)
+            stream.writeByte('\n');
 
-// -----------------------------------------------------------------------
-// xmlSafeStringCharDup
-
-/*
-static const char* xmlSafeStringCharDup(const char* const cstring, const bool toXml)
-{
-    return carla_strdup(xmlSafeString(cstring, toXml).toRawUTF8());
-}
-*/
-
-static const char* xmlSafeStringCharDup(const String& string, const bool toXml)
-{
-    return carla_strdup(xmlSafeString(string, toXml).toRawUTF8());
+        stream.write(line, lineSize);
+    }
 }
 
 // -----------------------------------------------------------------------
@@ -200,6 +151,7 @@ CarlaStateSave::CarlaStateSave() noexcept
       currentMidiBank(-1),
       currentMidiProgram(-1),
       chunk(nullptr),
+      chunkSize(0),
       parameters(),
       customData() {}
 
@@ -241,6 +193,8 @@ void CarlaStateSave::clear() noexcept
         chunk = nullptr;
     }
 
+    chunkSize = 0;
+
     uniqueId = 0;
     options  = 0x0;
 
@@ -275,169 +229,144 @@ void CarlaStateSave::clear() noexcept
 }
 
 // -----------------------------------------------------------------------
-// fillFromXmlElement
+// fillFromXmlReader
 
-bool CarlaStateSave::fillFromXmlElement(const XmlElement* const xmlElement)
+// decode base64 text of a chunk, the text is not copied unless it has entities or markup
+static bool readChunk(CarlaXmlReader& reader, uint8_t*& chunk, std::size_t& chunkSize)
 {
-    CARLA_SAFE_ASSERT_RETURN(xmlElement != nullptr, false);
+    const char* text;
+    std::size_t length;
+    std::string copy;
 
-    clear();
+    if (! reader.readRawText(text, length))
+    {
+        if (reader.hasError() || ! reader.readText(copy))
+            return false;
+
+        text   = copy.c_str();
+        length = copy.size();
+    }
+
+    if (length == 0)
+        return true;
+
+    uint8_t* const data(new uint8_t[carla_base64DecodedMaxSize(length)]);
+    const std::size_t size(carla_base64Decode(text, length, data));
+
+    if (size == 0)
+    {
+        delete[] data;
+        return true;
+    }
+
+    delete[] chunk;
+    chunk     = data;
+    chunkSize = size;
+    return true;
+}
+
+// get data stored in the sidecar, referenced by the offset in the current element
+static std::size_t readSidecarRef(CarlaXmlReader& reader, const CarlaStateSidecarReader* const sidecar, std::string& text, uint64_t& offset)
+{
+    if (! reader.readText(text))
+        return 0;
 
-    for (XmlElement* elem = xmlElement->getFirstChildElement(); elem != nullptr; elem = elem->getNextElement())
+    if (sidecar == nullptr || ! sidecar->isValid())
     {
-        const String& tagName(elem->getTagName());
+        carla_stderr("Project data references a missing sidecar file");
+        return 0;
+    }
+
+    offset = static_cast<uint64_t>(getJuceString(text).getLargeIntValue());
+
+    const std::size_t size(sidecar->getSize(offset));
+
+    if (size == 0)
+        carla_stderr("Project sidecar file has no valid data at offset " P_UINT64, offset);
+
+    return size;
+}
+
+bool CarlaStateSave::fillFromXmlReader(CarlaXmlReader& reader, const CarlaStateSidecarReader* const sidecar)
+{
+    clear();
+
+    std::string text;
+    bool sidecarFailed = false;
 
+    for (; reader.nextChild();)
+    {
         // ---------------------------------------------------------------
         // Info
 
-        if (tagName.equalsIgnoreCase("info"))
+        if (reader.isName("info"))
         {
-            for (XmlElement* xmlInfo = elem->getFirstChildElement(); xmlInfo != nullptr; xmlInfo = xmlInfo->getNextElement())
+            for (; reader.nextChild();)
             {
-                const String& tag(xmlInfo->getTagName());
-                const String  text(xmlInfo->getAllSubText().trim());
-
-                if (tag.equalsIgnoreCase("type"))
-                    type = xmlSafeStringCharDup(text, false);
-                else if (tag.equalsIgnoreCase("name"))
-                    name = xmlSafeStringCharDup(text, false);
-                else if (tag.equalsIgnoreCase("label") || tag.equalsIgnoreCase("identifier") || tag.equalsIgnoreCase("uri"))
-                    label = xmlSafeStringCharDup(text, false);
-                else if (tag.equalsIgnoreCase("binary") || tag.equalsIgnoreCase("bundle") || tag.equalsIgnoreCase("filename"))
-                    binary = xmlSafeStringCharDup(text, false);
-                else if (tag.equalsIgnoreCase("uniqueid"))
-                    uniqueId = text.getLargeIntValue();
+                if (! reader.readText(text))
+                    break;
+
+                if (reader.isName("type"))
+                    type = carla_strdup(text.c_str());
+                else if (reader.isName("name"))
+                    name = carla_strdup(text.c_str());
+                else if (reader.isName("label") || reader.isName("identifier") || reader.isName("uri"))
+                    label = carla_strdup(text.c_str());
+                else if (reader.isName("binary") || reader.isName("bundle") || reader.isName("filename"))
+                    binary = carla_strdup(text.c_str());
+                else if (reader.isName("uniqueid"))
+                    uniqueId = getJuceString(text).getLargeIntValue();
             }
         }
 
         // ---------------------------------------------------------------
         // Data
 
-        else if (tagName.equalsIgnoreCase("data"))
+        else if (reader.isName("data"))
         {
-            for (XmlElement* xmlData = elem->getFirstChildElement(); xmlData != nullptr; xmlData = xmlData->getNextElement())
+            for (; reader.nextChild();)
             {
-                const String& tag(xmlData->getTagName());
-                const String  text(xmlData->getAllSubText().trim());
-
-#ifndef BUILD_BRIDGE
-                // -------------------------------------------------------
-                // Internal Data
-
-                if (tag.equalsIgnoreCase("active"))
-                {
-                    active = (text.equalsIgnoreCase("yes") || text.equalsIgnoreCase("true"));
-                }
-                else if (tag.equalsIgnoreCase("drywet"))
-                {
-                    dryWet = carla_fixedValue(0.0f, 1.0f, text.getFloatValue());
-                }
-                else if (tag.equalsIgnoreCase("volume"))
-                {
-                    volume = carla_fixedValue(0.0f, 1.27f, text.getFloatValue());
-                }
-                else if (tag.equalsIgnoreCase("balanceleft") || tag.equalsIgnoreCase("balance-left"))
-                {
-                    balanceLeft = carla_fixedValue(-1.0f, 1.0f, text.getFloatValue());
-                }
-                else if (tag.equalsIgnoreCase("balanceright") || tag.equalsIgnoreCase("balance-right"))
-                {
-                    balanceRight = carla_fixedValue(-1.0f, 1.0f, text.getFloatValue());
-                }
-                else if (tag.equalsIgnoreCase("panning"))
-                {
-                    panning = carla_fixedValue(-1.0f, 1.0f, text.getFloatValue());
-                }
-                else if (tag.equalsIgnoreCase("controlchannel") || tag.equalsIgnoreCase("control-channel"))
-                {
-                    if (! text.startsWithIgnoreCase("n"))
-                    {
-                        const int value(text.getIntValue());
-                        if (value >= 1 && value <= MAX_MIDI_CHANNELS)
-                            ctrlChannel = static_cast<int8_t>(value-1);
-                    }
-                }
-                else if (tag.equalsIgnoreCase("options"))
-                {
-                    const int value(text.getHexValue32());
-                    if (value > 0)
-                        options = static_cast<uint>(value);
-                }
-#else
-                if (false) {}
-#endif
-
-                // -------------------------------------------------------
-                // Program (current)
-
-                else if (tag.equalsIgnoreCase("currentprogramindex") || tag.equalsIgnoreCase("current-program-index"))
-                {
-                    const int value(text.getIntValue());
-                    if (value >= 1)
-                        currentProgramIndex = value-1;
-                }
-                else if (tag.equalsIgnoreCase("currentprogramname") || tag.equalsIgnoreCase("current-program-name"))
-                {
-                    currentProgramName = xmlSafeStringCharDup(text, false);
-                }
-
-                // -------------------------------------------------------
-                // Midi Program (current)
-
-                else if (tag.equalsIgnoreCase("currentmidibank") || tag.equalsIgnoreCase("current-midi-bank"))
-                {
-                    const int value(text.getIntValue());
-                    if (value >= 1)
-                        currentMidiBank = value-1;
-                }
-                else if (tag.equalsIgnoreCase("currentmidiprogram") || tag.equalsIgnoreCase("current-midi-program"))
-                {
-                    const int value(text.getIntValue());
-                    if (value >= 1)
-                        currentMidiProgram = value-1;
-                }
-
                 // -------------------------------------------------------
                 // Parameters
 
-                else if (tag.equalsIgnoreCase("parameter"))
+                if (reader.isName("parameter"))
                 {
                     Parameter* const stateParameter(new Parameter());
 
-                    for (XmlElement* xmlSubData = xmlData->getFirstChildElement(); xmlSubData != nullptr; xmlSubData = xmlSubData->getNextElement())
+                    for (; reader.nextChild();)
                     {
-                        const String& pTag(xmlSubData->getTagName());
-                        const String  pText(xmlSubData->getAllSubText().trim());
+                        if (! reader.readText(text))
+                            break;
 
-                        if (pTag.equalsIgnoreCase("index"))
+                        if (reader.isName("index"))
                         {
-                            const int index(pText.getIntValue());
+                            const int index(getJuceString(text).getIntValue());
                             if (index >= 0)
                                 stateParameter->index = index;
                         }
-                        else if (pTag.equalsIgnoreCase("name"))
+                        else if (reader.isName("name"))
                         {
-                            stateParameter->name = xmlSafeStringCharDup(pText, false);
+                            stateParameter->name = carla_strdup(text.c_str());
                         }
-                        else if (pTag.equalsIgnoreCase("symbol"))
+                        else if (reader.isName("symbol"))
                         {
-                            stateParameter->symbol = xmlSafeStringCharDup(pText, false);
+                            stateParameter->symbol = carla_strdup(text.c_str());
                         }
-                        else if (pTag.equalsIgnoreCase("value"))
+                        else if (reader.isName("value"))
                         {
                             stateParameter->dummy = false;
-                            stateParameter->value = pText.getFloatValue();
+                            stateParameter->value = getJuceString(text).getFloatValue();
                         }
 #ifndef BUILD_BRIDGE
-                        else if (pTag.equalsIgnoreCase("midichannel") || pTag.equalsIgnoreCase("midi-channel"))
+                        else if (reader.isName("midichannel") || reader.isName("midi-channel"))
                         {
-                            const int channel(pText.getIntValue());
+                            const int channel(getJuceString(text).getIntValue());
                             if (channel >= 1 && channel <= MAX_MIDI_CHANNELS)
                                 stateParameter->midiChannel = static_cast<uint8_t>(channel-1);
                         }
-                        else if (pTag.equalsIgnoreCase("midicc") || pTag.equalsIgnoreCase("midi-cc"))
+                        else if (reader.isName("midicc") || reader.isName("midi-cc"))
                         {
-                            const int cc(pText.getIntValue());
+                            const int cc(getJuceString(text).getIntValue());
                             if (cc >= -1 && cc < MAX_MIDI_CONTROL)
                                 stateParameter->midiCC = static_cast<int16_t>(cc);
                         }
@@ -445,133 +374,273 @@ bool CarlaStateSave::fillFromXmlElement(const XmlElement* const xmlElement)
                     }
 
                     parameters.append(stateParameter);
+                    continue;
                 }
 
                 // -------------------------------------------------------
                 // Custom Data
 
-                else if (tag.equalsIgnoreCase("customdata") || tag.equalsIgnoreCase("custom-data"))
+                if (reader.isName("customdata") || reader.isName("custom-data"))
                 {
                     CustomData* const stateCustomData(new CustomData());
 
-                    for (XmlElement* xmlSubData = xmlData->getFirstChildElement(); xmlSubData != nullptr; xmlSubData = xmlSubData->getNextElement())
+                    for (; reader.nextChild();)
                     {
-                        const String& cTag(xmlSubData->getTagName());
-                        const String  cText(xmlSubData->getAllSubText().trim());
-
-                        if (cTag.equalsIgnoreCase("type"))
-                            stateCustomData->type = xmlSafeStringCharDup(cText, false);
-                        else if (cTag.equalsIgnoreCase("key"))
-                            stateCustomData->key = xmlSafeStringCharDup(cText, false);
-                        else if (cTag.equalsIgnoreCase("value"))
-                            stateCustomData->value = carla_strdup(cText.toRawUTF8()); //xmlSafeStringCharDup(cText, false);
+                        if (reader.isName("valueref"))
+                        {
+                            uint64_t offset = 0;
+                            const std::size_t size(readSidecarRef(reader, sidecar, text, offset));
+
+                            if (size == 0)
+                            {
+                                sidecarFailed = true;
+                                continue;
+                            }
+
+                            char* const value(new char[size+1]);
+
+                            if (sidecar->read(offset, value))
+                            {
+                                value[size] = '\0';
+                                delete[] stateCustomData->value;
+                                stateCustomData->value = value;
+                            }
+                            else
+                            {
+                                delete[] value;
+                                sidecarFailed = true;
+                            }
+                            continue;
+                        }
+
+                        if (! reader.readText(text))
+                            break;
+
+                        if (reader.isName("type"))
+                            stateCustomData->type = carla_strdup(text.c_str());
+                        else if (reader.isName("key"))
+                            stateCustomData->key = carla_strdup(text.c_str());
+                        else if (reader.isName("value"))
+                            stateCustomData->value = carla_strdup(text.c_str());
                     }
 
                     if (stateCustomData->isValid())
+                    {
                         customData.append(stateCustomData);
+                    }
                     else
+                    {
                         carla_stderr("Reading CustomData property failed, missing data");
+                        delete stateCustomData;
+                    }
+                    continue;
                 }
 
                 // -------------------------------------------------------
                 // Chunk
 
-                else if (tag.equalsIgnoreCase("chunk"))
+                if (reader.isName("chunk"))
                 {
-                    chunk = carla_strdup(text.toRawUTF8());
+                    if (! readChunk(reader, chunk, chunkSize))
+                        break;
+                    continue;
                 }
-            }
-        }
-    }
-
-    return true;
-}
 
-// -----------------------------------------------------------------------
-// fillXmlStringFromStateSave
+                if (reader.isName("chunkref"))
+                {
+                    uint64_t offset = 0;
+                    const std::size_t size(readSidecarRef(reader, sidecar, text, offset));
 
-void CarlaStateSave::dumpToMemoryStream(MemoryOutputStream& content) const
-{
-    {
-        MemoryOutputStream infoXml;
+                    if (size == 0)
+                    {
+                        sidecarFailed = true;
+                        continue;
+                    }
 
-        infoXml << "  <Info>\n";
-        infoXml << "   <Type>" << String(type != nullptr ? type : "") << "</Type>\n";
-        infoXml << "   <Name>" << xmlSafeString(name, true) << "</Name>\n";
+                    uint8_t* const data(new uint8_t[size]);
 
-        switch (getPluginTypeFromString(type))
-        {
-        case PLUGIN_NONE:
-            break;
-        case PLUGIN_INTERNAL:
-            infoXml << "   <Label>"    << xmlSafeString(label, true)  << "</Label>\n";
-            break;
-        case PLUGIN_LADSPA:
-            infoXml << "   <Binary>"   << xmlSafeString(binary, true) << "</Binary>\n";
-            infoXml << "   <Label>"    << xmlSafeString(label, true)  << "</Label>\n";
-            infoXml << "   <UniqueID>" << juce::int64(uniqueId)       << "</UniqueID>\n";
-            break;
-        case PLUGIN_DSSI:
-            infoXml << "   <Binary>"   << xmlSafeString(binary, true) << "</Binary>\n";
-            infoXml << "   <Label>"    << xmlSafeString(label, true)  << "</Label>\n";
-            break;
-        case PLUGIN_LV2:
-            infoXml << "   <URI>"      << xmlSafeString(label, true)  << "</URI>\n";
-            break;
-        case PLUGIN_VST2:
-            infoXml << "   <Binary>"   << xmlSafeString(binary, true) << "</Binary>\n";
-            infoXml << "   <UniqueID>" << juce::int64(uniqueId)       << "</UniqueID>\n";
-            break;
-        case PLUGIN_VST3:
-            infoXml << "   <Binary>"   << xmlSafeString(binary, true) << "</Binary>\n";
-            infoXml << "   <Label>"    << xmlSafeString(label, true)  << "</Label>\n";
-            break;
-        case PLUGIN_AU:
-            infoXml << "   <Identifier>" << xmlSafeString(label, true) << "</Identifier>\n";
-            break;
-        case PLUGIN_GIG:
-        case PLUGIN_SF2:
-            infoXml << "   <Filename>"   << xmlSafeString(binary, true) << "</Filename>\n";
-            infoXml << "   <Label>"      << xmlSafeString(label, true)  << "</Label>\n";
-            break;
-        case PLUGIN_SFZ:
-            infoXml << "   <Filename>"   << xmlSafeString(binary, true) << "</Filename>\n";
-            break;
-        }
+                    if (sidecar->read(offset, data))
+                    {
+                        delete[] chunk;
+                        chunk     = data;
+                        chunkSize = size;
+                    }
+                    else
+                    {
+                        delete[] data;
+                        sidecarFailed = true;
+                    }
+                    continue;
+                }
 
-        infoXml << "  </Info>\n\n";
+                // -------------------------------------------------------
+                // single values
 
-        content << infoXml;
-    }
+                if (! reader.readText(text))
+                    break;
 
-    content << "  <Data>\n";
+                const String value(getJuceString(text));
 
 #ifndef BUILD_BRIDGE
-    {
-        MemoryOutputStream dataXml;
+                // -------------------------------------------------------
+                // Internal Data
+
+                if (reader.isName("active"))
+                {
+                    active = (value.equalsIgnoreCase("yes") || value.equalsIgnoreCase("true"));
+                }
+                else if (reader.isName("drywet"))
+                {
+                    dryWet = carla_fixedValue(0.0f, 1.0f, value.getFloatValue());
+                }
+                else if (reader.isName("volume"))
+                {
+                    volume = carla_fixedValue(0.0f, 1.27f, value.getFloatValue());
+                }
+                else if (reader.isName("balanceleft") || reader.isName("balance-left"))
+                {
+                    balanceLeft = carla_fixedValue(-1.0f, 1.0f, value.getFloatValue());
+                }
+                else if (reader.isName("balanceright") || reader.isName("balance-right"))
+                {
+                    balanceRight = carla_fixedValue(-1.0f, 1.0f, value.getFloatValue());
+                }
+                else if (reader.isName("panning"))
+                {
+                    panning = carla_fixedValue(-1.0f, 1.0f, value.getFloatValue());
+                }
+                else if (reader.isName("controlchannel") || reader.isName("control-channel"))
+                {
+                    if (! value.startsWithIgnoreCase("n"))
+                    {
+                        const int channel(value.getIntValue());
+                        if (channel >= 1 && channel <= MAX_MIDI_CHANNELS)
+                            ctrlChannel = static_cast<int8_t>(channel-1);
+                    }
+                }
+                else if (reader.isName("options"))
+                {
+                    const int hexValue(value.getHexValue32());
+                    if (hexValue > 0)
+                        options = static_cast<uint>(hexValue);
+                }
+#else
+                if (false) {}
+#endif
 
-        dataXml << "   <Active>" << (active ? "Yes" : "No") << "</Active>\n";
+                // -------------------------------------------------------
+                // Program (current)
 
-        if (carla_isNotEqual(dryWet, 1.0f))
-            dataXml << "   <DryWet>"        << String(dryWet, 7)       << "</DryWet>\n";
-        if (carla_isNotEqual(volume, 1.0f))
-            dataXml << "   <Volume>"        << String(volume, 7)       << "</Volume>\n";
-        if (carla_isNotEqual(balanceLeft, -1.0f))
-            dataXml << "   <Balance-Left>"  << String(balanceLeft, 7)  << "</Balance-Left>\n";
-        if (carla_isNotEqual(balanceRight, 1.0f))
-            dataXml << "   <Balance-Right>" << String(balanceRight, 7) << "</Balance-Right>\n";
-        if (carla_isNotEqual(panning, 0.0f))
-            dataXml << "   <Panning>"       << String(panning, 7)      << "</Panning>\n";
+                else if (reader.isName("currentprogramindex") || reader.isName("current-program-index"))
+                {
+                    const int index(value.getIntValue());
+                    if (index >= 1)
+                        currentProgramIndex = index-1;
+                }
+                else if (reader.isName("currentprogramname") || reader.isName("current-program-name"))
+                {
+                    currentProgramName = carla_strdup(text.c_str());
+                }
+
+                // -------------------------------------------------------
+                // Midi Program (current)
+
+                else if (reader.isName("currentmidibank") || reader.isName("current-midi-bank"))
+                {
+                    const int bank(value.getIntValue());
+                    if (bank >= 1)
+                        currentMidiBank = bank-1;
+                }
+                else if (reader.isName("currentmidiprogram") || reader.isName("current-midi-program"))
+                {
+                    const int program(value.getIntValue());
+                    if (program >= 1)
+                        currentMidiProgram = program-1;
+                }
+            }
+        }
 
-        if (ctrlChannel < 0)
-            dataXml << "   <ControlChannel>N</ControlChannel>\n";
         else
-            dataXml << "   <ControlChannel>" << int(ctrlChannel+1) << "</ControlChannel>\n";
+        {
+            reader.skipElement();
+        }
+    }
+
+    return !(reader.hasError() || sidecarFailed);
+}
 
-        dataXml << "   <Options>0x" << String::toHexString(static_cast<int>(options)) << "</Options>\n";
+// -----------------------------------------------------------------------
+// dumpToStream
 
-        content << dataXml;
+void CarlaStateSave::dumpToStream(OutputStream& content, CarlaStateSidecarWriter* const sidecar) const
+{
+    content << "  <Info>\n";
+    carla_xmlWriteTag(content, "   ", "Type", type != nullptr ? type : "");
+    carla_xmlWriteTag(content, "   ", "Name", name);
+
+    switch (getPluginTypeFromString(type))
+    {
+    case PLUGIN_NONE:
+        break;
+    case PLUGIN_INTERNAL:
+        carla_xmlWriteTag(content, "   ", "Label", label);
+        break;
+    case PLUGIN_LADSPA:
+        carla_xmlWriteTag(content, "   ", "Binary", binary);
+        carla_xmlWriteTag(content, "   ", "Label", label);
+        content << "   <UniqueID>" << juce::int64(uniqueId) << "</UniqueID>\n";
+        break;
+    case PLUGIN_DSSI:
+        carla_xmlWriteTag(content, "   ", "Binary", binary);
+        carla_xmlWriteTag(content, "   ", "Label", label);
+        break;
+    case PLUGIN_LV2:
+        carla_xmlWriteTag(content, "   ", "URI", label);
+        break;
+    case PLUGIN_VST2:
+        carla_xmlWriteTag(content, "   ", "Binary", binary);
+        content << "   <UniqueID>" << juce::int64(uniqueId) << "</UniqueID>\n";
+        break;
+    case PLUGIN_VST3:
+        carla_xmlWriteTag(content, "   ", "Binary", binary);
+        carla_xmlWriteTag(content, "   ", "Label", label);
+        break;
+    case PLUGIN_AU:
+        carla_xmlWriteTag(content, "   ", "Identifier", label);
+        break;
+    case PLUGIN_GIG:
+    case PLUGIN_SF2:
+        carla_xmlWriteTag(content, "   ", "Filename", binary);
+        carla_xmlWriteTag(content, "   ", "Label", label);
+        break;
+    case PLUGIN_SFZ:
+        carla_xmlWriteTag(content, "   ", "Filename", binary);
+        break;
     }
+
+    content << "  </Info>\n\n";
+    content << "  <Data>\n";
+
+#ifndef BUILD_BRIDGE
+    content << "   <Active>" << (active ? "Yes" : "No") << "</Active>\n";
+
+    if (carla_isNotEqual(dryWet, 1.0f))
+        content << "   <DryWet>"        << String(dryWet, 7)       << "</DryWet>\n";
+    if (carla_isNotEqual(volume, 1.0f))
+        content << "   <Volume>"        << String(volume, 7)       << "</Volume>\n";
+    if (carla_isNotEqual(balanceLeft, -1.0f))
+        content << "   <Balance-Left>"  << String(balanceLeft, 7)  << "</Balance-Left>\n";
+    if (carla_isNotEqual(balanceRight, 1.0f))
+        content << "   <Balance-Right>" << String(balanceRight, 7) << "</Balance-Right>\n";
+    if (carla_isNotEqual(panning, 0.0f))
+        content << "   <Panning>"       << String(panning, 7)      << "</Panning>\n";
+
+    if (ctrlChannel < 0)
+        content << "   <ControlChannel>N</ControlChannel>\n";
+    else
+        content << "   <ControlChannel>" << int(ctrlChannel+1) << "</ControlChannel>\n";
+
+    content << "   <Options>0x" << String::toHexString(static_cast<int>(options)) << "</Options>\n";
 #endif
 
     for (ParameterItenerator it = parameters.begin2(); it.valid(); it.next())
@@ -579,30 +648,26 @@ void CarlaStateSave::dumpToMemoryStream(MemoryOutputStream& content) const
         Parameter* const stateParameter(it.getValue(nullptr));
         CARLA_SAFE_ASSERT_CONTINUE(stateParameter != nullptr);
 
-        MemoryOutputStream parameterXml;
-
-        parameterXml << "\n";
-        parameterXml << "   <Parameter>\n";
-        parameterXml << "    <Index>" << String(stateParameter->index)             << "</Index>\n";
-        parameterXml << "    <Name>"  << xmlSafeString(stateParameter->name, true) << "</Name>\n";
+        content << "\n";
+        content << "   <Parameter>\n";
+        content << "    <Index>" << String(stateParameter->index) << "</Index>\n";
+        carla_xmlWriteTag(content, "    ", "Name", stateParameter->name);
 
         if (stateParameter->symbol != nullptr && stateParameter->symbol[0] != '\0')
-            parameterXml << "    <Symbol>" << xmlSafeString(stateParameter->symbol, true) << "</Symbol>\n";
+            carla_xmlWriteTag(content, "    ", "Symbol", stateParameter->symbol);
 
 #ifndef BUILD_BRIDGE
         if (stateParameter->midiCC > 0)
         {
-            parameterXml << "    <MidiCC>"      << stateParameter->midiCC        << "</MidiCC>\n";
-            parameterXml << "    <MidiChannel>" << stateParameter->midiChannel+1 << "</MidiChannel>\n";
+            content << "    <MidiCC>"      << stateParameter->midiCC        << "</MidiCC>\n";
+            content << "    <MidiChannel>" << stateParameter->midiChannel+1 << "</MidiChannel>\n";
         }
 #endif
 
         if (! stateParameter->dummy)
-            parameterXml << "    <Value>" << String(stateParameter->value, 15) << "</Value>\n";
-
-        parameterXml << "   </Parameter>\n";
+            content << "    <Value>" << String(stateParameter->value, 15) << "</Value>\n";
 
-        content << parameterXml;
+        content << "   </Parameter>\n";
     }
 
     if (currentProgramIndex >= 0 && currentProgramName != nullptr && currentProgramName[0] != '\0')
@@ -610,25 +675,17 @@ void CarlaStateSave::dumpToMemoryStream(MemoryOutputStream& content) const
         // ignore 'default' program
         if (currentProgramIndex > 0 || ! String(currentProgramName).equalsIgnoreCase("default"))
         {
-            MemoryOutputStream programXml;
-
-            programXml << "\n";
-            programXml << "   <CurrentProgramIndex>" << currentProgramIndex+1                   << "</CurrentProgramIndex>\n";
-            programXml << "   <CurrentProgramName>"  << xmlSafeString(currentProgramName, true) << "</CurrentProgramName>\n";
-
-            content << programXml;
+            content << "\n";
+            content << "   <CurrentProgramIndex>" << currentProgramIndex+1 << "</CurrentProgramIndex>\n";
+            carla_xmlWriteTag(content, "   ", "CurrentProgramName", currentProgramName);
         }
     }
 
     if (currentMidiBank >= 0 && currentMidiProgram >= 0)
     {
-        MemoryOutputStream midiProgramXml;
-
-        midiProgramXml << "\n";
-        midiProgramXml << "   <CurrentMidiBank>"    << currentMidiBank+1    << "</CurrentMidiBank>\n";
-        midiProgramXml << "   <CurrentMidiProgram>" << currentMidiProgram+1 << "</CurrentMidiProgram>\n";
-
-        content << midiProgramXml;
+        content << "\n";
+        content << "   <CurrentMidiBank>"    << currentMidiBank+1    << "</CurrentMidiBank>\n";
+        content << "   <CurrentMidiProgram>" << currentMidiProgram+1 << "</CurrentMidiProgram>\n";
     }
 
     for (CustomDataItenerator it = customData.begin2(); it.valid(); it.next())
@@ -637,44 +694,377 @@ void CarlaStateSave::dumpToMemoryStream(MemoryOutputStream& content) const
         CARLA_SAFE_ASSERT_CONTINUE(stateCustomData != nullptr);
         CARLA_SAFE_ASSERT_CONTINUE(stateCustomData->isValid());
 
-        MemoryOutputStream customDataXml;
+        content << "\n";
+        content << "   <CustomData>\n";
+        carla_xmlWriteTag(content, "    ", "Type", stateCustomData->type);
+        carla_xmlWriteTag(content, "    ", "Key",  stateCustomData->key);
 
-        customDataXml << "\n";
-        customDataXml << "   <CustomData>\n";
-        customDataXml << "    <Type>" << xmlSafeString(stateCustomData->type, true) << "</Type>\n";
-        customDataXml << "    <Key>"  << xmlSafeString(stateCustomData->key, true)  << "</Key>\n";
+        const std::size_t valueSize(std::strlen(stateCustomData->value));
+        const uint64_t valueRef((sidecar != nullptr && valueSize > 0 && valueSize >= sidecar->getMinSize())
+                                ? sidecar->write(stateCustomData->value, valueSize) : 0);
 
-        if (std::strcmp(stateCustomData->type, CUSTOM_DATA_TYPE_CHUNK) == 0 || std::strlen(stateCustomData->value) >= 128)
+        if (valueRef != 0)
+        {
+            content << "    <ValueRef>" << juce::int64(valueRef) << "</ValueRef>\n";
+        }
+        else if (std::strcmp(stateCustomData->type, CUSTOM_DATA_TYPE_CHUNK) == 0 || valueSize >= 128)
         {
-            customDataXml << "    <Value>\n";
-            customDataXml << xmlSafeStringFast(stateCustomData->value, true);
-            customDataXml << "\n    </Value>\n";
+            content << "    <Value>\n";
+            carla_xmlWriteEscaped(content, stateCustomData->value);
+            content << "\n    </Value>\n";
         }
         else
         {
-            customDataXml << "    <Value>";
-            customDataXml << xmlSafeStringFast(stateCustomData->value, true);
-            customDataXml << "</Value>\n";
+            content << "    <Value>";
+            carla_xmlWriteEscaped(content, stateCustomData->value);
+            content << "</Value>\n";
         }
 
-        customDataXml << "   </CustomData>\n";
+        content << "   </CustomData>\n";
+    }
+
+    if (chunk != nullptr && chunkSize > 0)
+    {
+        const uint64_t chunkRef((sidecar != nullptr && chunkSize >= sidecar->getMinSize())
+                                ? sidecar->write(chunk, chunkSize) : 0);
 
-        content << customDataXml;
+        if (chunkRef != 0)
+        {
+            content << "\n   <ChunkRef>" << juce::int64(chunkRef) << "</ChunkRef>\n";
+        }
+        else
+        {
+            content << "\n   <Chunk>\n";
+            writeBase64Lines(content, chunk, chunkSize);
+            content << "\n   </Chunk>\n";
+        }
     }
 
-    if (chunk != nullptr && chunk[0] != '\0')
+    content << "  </Data>\n";
+}
+
+// -----------------------------------------------------------------------
+// CarlaStateSidecarWriter
+
+static const char     kSidecarMagic[8]    = { 'C', 'a', 'r', 'l', 'a', 'D', 'a', 't' };
+static const uint32_t kSidecarVersion     = 2;
+static const uint32_t kSidecarCompressed  = 0x1;
+static const std::size_t kSidecarIdSize   = 32;
+static const std::size_t kSidecarHeaderSize = 16 + kSidecarIdSize;
+static const std::size_t kSidecarBlobHeaderSize = 32;
+
+// compressing small data is not worth it
+static const std::size_t kSidecarMinCompressSize = 4096;
+
+// bigger data stays in the XML, also limits what a broken file can make us allocate
+static const std::size_t kSidecarMaxRawSize = 0x40000000;
+
+// best zlib ratio is a bit above 1000:1
+static const std::size_t kSidecarMaxCompressRatio = 1032;
+
+// FNV-1a, only meant to detect corrupt or mismatched data
+static uint64_t getSidecarHash(const uint8_t* const data, const std::size_t size) noexcept
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (std::size_t i=0; i < size; ++i)
     {
-        MemoryOutputStream chunkXml, chunkSplt;
-        getNewLineSplittedString(chunkSplt, chunk);
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
 
-        chunkXml << "\n   <Chunk>\n";
-        chunkXml << chunkSplt;
-        chunkXml << "\n   </Chunk>\n";
+    return hash;
+}
 
-        content << chunkXml;
+CarlaStateSidecarWriter::CarlaStateSidecarWriter(const File& projectFile, const uint minSize)
+    : fId(juce::Uuid().toString()),
+      fFile(getStateSidecarFile(projectFile, fId)),
+      fMinSize(minSize),
+      fTempFile(),
+      fStream(),
+      fFailed(false) {}
+
+CarlaStateSidecarWriter::~CarlaStateSidecarWriter()
+{
+    // temporary file is deleted if not used
+    fStream   = nullptr;
+    fTempFile = nullptr;
+}
+
+uint CarlaStateSidecarWriter::getMinSize() const noexcept
+{
+    return fMinSize;
+}
+
+const String& CarlaStateSidecarWriter::getId() const noexcept
+{
+    return fId;
+}
+
+const File& CarlaStateSidecarWriter::getFile() const noexcept
+{
+    return fFile;
+}
+
+bool CarlaStateSidecarWriter::isEmpty() const noexcept
+{
+    return fStream == nullptr && ! fFailed;
+}
+
+bool CarlaStateSidecarWriter::open()
+{
+    if (fStream != nullptr)
+        return true;
+    if (fFailed)
+        return false;
+
+    fTempFile = new TemporaryFile(fFile);
+    fStream   = fTempFile->getFile().createOutputStream();
+
+    if (fStream == nullptr || fStream->failedToOpen())
+    {
+        carla_stderr2("Failed to create project sidecar file");
+        fStream = nullptr;
+        fFailed = true;
+        return false;
     }
 
-    content << "  </Data>\n";
+    CARLA_SAFE_ASSERT(fId.getNumBytesAsUTF8() == kSidecarIdSize);
+
+    fStream->write(kSidecarMagic, sizeof(kSidecarMagic));
+    fStream->writeInt(static_cast<int>(kSidecarVersion));
+    fStream->writeInt(0);
+    fStream->write(fId.toRawUTF8(), kSidecarIdSize);
+    return true;
+}
+
+uint64_t CarlaStateSidecarWriter::write(const void* const data, const std::size_t size)
+{
+    CARLA_SAFE_ASSERT_RETURN(data != nullptr && size > 0, 0);
+
+    if (size > kSidecarMaxRawSize || ! open())
+        return 0;
+
+    MemoryOutputStream compressed;
+
+    if (size >= kSidecarMinCompressSize)
+    {
+        GZIPCompressorOutputStream gzip(&compressed, 1);
+        gzip.write(data, size);
+        gzip.flush();
+    }
+
+    const bool useCompressed(compressed.getDataSize() > 0 && compressed.getDataSize() < size);
+    const void* const storedData(useCompressed ? compressed.getData() : data);
+    const std::size_t storedSize(useCompressed ? compressed.getDataSize() : size);
+
+    const uint64_t offset(static_cast<uint64_t>(fStream->getPosition()));
+
+    fStream->writeInt(static_cast<int>(useCompressed ? kSidecarCompressed : 0x0));
+    fStream->writeInt(0);
+    fStream->writeInt64(static_cast<juce::int64>(size));
+    fStream->writeInt64(static_cast<juce::int64>(storedSize));
+    fStream->writeInt64(static_cast<juce::int64>(getSidecarHash(static_cast<const uint8_t*>(data), size)));
+
+    if (! fStream->write(storedData, storedSize))
+    {
+        carla_stderr2("Failed to write project sidecar file");
+        fFailed = true;
+        return 0;
+    }
+
+    if (const std::size_t padding = (8 - storedSize % 8) % 8)
+        fStream->writeRepeatedByte(0, padding);
+
+    return offset;
+}
+
+bool CarlaStateSidecarWriter::finish()
+{
+    if (! open())
+        return false;
+
+    fStream->flush();
+
+    const bool ok(fStream->getStatus().wasOk());
+    fStream = nullptr;
+
+    if (ok && fTempFile->overwriteTargetFileWithTemporary())
+        return true;
+
+    carla_stderr2("Failed to write project sidecar file");
+    fFailed = true;
+    return false;
+}
+
+void CarlaStateSidecarWriter::discard()
+{
+    fStream   = nullptr;
+    fTempFile = nullptr;
+
+    if (fFile.existsAsFile())
+        fFile.deleteFile();
+}
+
+// -----------------------------------------------------------------------
+// CarlaStateSidecarReader
+
+CarlaStateSidecarReader::CarlaStateSidecarReader(const File& file, const String& id)
+    : fFile()
+{
+    if (! file.existsAsFile())
+        return;
+
+    fFile = new MemoryMappedFile(file, MemoryMappedFile::readOnly);
+
+    const uint8_t* const data(static_cast<const uint8_t*>(fFile->getData()));
+
+    if (data == nullptr || fFile->getSize() < kSidecarHeaderSize ||
+        std::memcmp(data, kSidecarMagic, sizeof(kSidecarMagic)) != 0 ||
+        juce::ByteOrder::littleEndianInt(data + 8) != kSidecarVersion)
+    {
+        carla_stderr2("Project sidecar file '%s' is invalid", file.getFullPathName().toRawUTF8());
+        fFile = nullptr;
+        return;
+    }
+
+    if (id.getNumBytesAsUTF8() != kSidecarIdSize || std::memcmp(data + 16, id.toRawUTF8(), kSidecarIdSize) != 0)
+    {
+        carla_stderr2("Project sidecar file '%s' does not belong to this project", file.getFullPathName().toRawUTF8());
+        fFile = nullptr;
+    }
+}
+
+bool CarlaStateSidecarReader::isValid() const noexcept
+{
+    return fFile != nullptr;
+}
+
+const uint8_t* CarlaStateSidecarReader::getBlob(const uint64_t offset) const noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(fFile != nullptr, nullptr);
+
+    const uint64_t fileSize(static_cast<uint64_t>(fFile->getSize()));
+
+    if (offset < kSidecarHeaderSize || offset > fileSize || fileSize - offset < kSidecarBlobHeaderSize)
+        return nullptr;
+
+    const uint8_t* const blob(static_cast<const uint8_t*>(fFile->getData()) + offset);
+
+    const uint32_t flags(juce::ByteOrder::littleEndianInt(blob));
+    const uint64_t rawSize(juce::ByteOrder::littleEndianInt64(blob + 8));
+    const uint64_t storedSize(juce::ByteOrder::littleEndianInt64(blob + 16));
+
+    if (storedSize > fileSize - offset - kSidecarBlobHeaderSize)
+        return nullptr;
+
+    // size is used for allocations, do not trust it beyond what the stored data can hold
+    if (rawSize == 0 || rawSize > kSidecarMaxRawSize)
+        return nullptr;
+
+    if ((flags & kSidecarCompressed) != 0)
+    {
+        if (rawSize / kSidecarMaxCompressRatio > storedSize)
+            return nullptr;
+    }
+    else if (rawSize != storedSize)
+    {
+        return nullptr;
+    }
+
+    return blob;
+}
+
+std::size_t CarlaStateSidecarReader::getSize(const uint64_t offset) const noexcept
+{
+    const uint8_t* const blob(getBlob(offset));
+
+    if (blob == nullptr)
+        return 0;
+
+    return static_cast<std::size_t>(juce::ByteOrder::littleEndianInt64(blob + 8));
+}
+
+bool CarlaStateSidecarReader::read(const uint64_t offset, void* const buffer) const
+{
+    CARLA_SAFE_ASSERT_RETURN(buffer != nullptr, false);
+
+    const uint8_t* const blob(getBlob(offset));
+    CARLA_SAFE_ASSERT_RETURN(blob != nullptr, false);
+
+    const uint32_t    flags(juce::ByteOrder::littleEndianInt(blob));
+    const std::size_t rawSize(static_cast<std::size_t>(juce::ByteOrder::littleEndianInt64(blob + 8)));
+    const std::size_t storedSize(static_cast<std::size_t>(juce::ByteOrder::littleEndianInt64(blob + 16)));
+    const uint64_t    hash(juce::ByteOrder::littleEndianInt64(blob + 24));
+    const uint8_t* const storedData(blob + kSidecarBlobHeaderSize);
+
+    uint8_t* const data(static_cast<uint8_t*>(buffer));
+
+    if ((flags & kSidecarCompressed) == 0)
+    {
+        std::memcpy(data, storedData, rawSize);
+    }
+    else
+    {
+        MemoryInputStream compressed(storedData, storedSize, false);
+        GZIPDecompressorInputStream gzip(compressed);
+
+        for (std::size_t done = 0; done < rawSize;)
+        {
+            const int numRead(gzip.read(data + done, static_cast<int>(rawSize - done)));
+
+            if (numRead <= 0)
+            {
+                carla_stderr2("Failed to decompress project sidecar data at offset " P_UINT64, offset);
+                return false;
+            }
+
+            done += static_cast<std::size_t>(numRead);
+        }
+    }
+
+    if (getSidecarHash(data, rawSize) != hash)
+    {
+        carla_stderr2("Project sidecar data at offset " P_UINT64 " is corrupt", offset);
+        return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+static bool isStateSidecarId(const String& id) noexcept
+{
+    if (id.length() != static_cast<int>(kSidecarIdSize))
+        return false;
+
+    return id.containsOnly("0123456789abcdefABCDEF");
+}
+
+void removeOldStateSidecarFiles(const File& projectFile, const File& keep)
+{
+    const String prefix(projectFile.getFileName() + ".");
+
+    juce::Array<File> files;
+    projectFile.getParentDirectory().findChildFiles(files, File::findFiles, false, prefix + "*.data");
+
+    for (int i=0, count=files.size(); i < count; ++i)
+    {
+        const File& file(files.getReference(i));
+
+        if (file == keep)
+            continue;
+
+        const String name(file.getFileName());
+
+        if (! name.startsWith(prefix))
+            continue;
+        if (! isStateSidecarId(name.substring(prefix.length()).dropLastCharacters(5)))
+            continue;
+
+        file.deleteFile();
+    }
 }
 
 // -----------------------------------------------------------------------
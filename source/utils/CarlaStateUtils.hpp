@@ -23,8 +23,13 @@
 
 #include "juce_core.h"
 
+class CarlaXmlReader;
+
 CARLA_BACKEND_START_NAMESPACE
 
+class CarlaStateSidecarReader;
+class CarlaStateSidecarWriter;
+
 // -----------------------------------------------------------------------
 
 struct CarlaStateSave {
@@ -84,7 +89,8 @@ struct CarlaStateSave {
     const char* currentProgramName;
     int32_t     currentMidiBank;
     int32_t     currentMidiProgram;
-    const char* chunk;
+    uint8_t*    chunk;
+    std::size_t chunkSize;
 
     ParameterList parameters;
     CustomDataList customData;
@@ -93,8 +99,12 @@ struct CarlaStateSave {
     ~CarlaStateSave() noexcept;
     void clear() noexcept;
 
-    bool fillFromXmlElement(const juce::XmlElement* const xmlElement);
-    void dumpToMemoryStream(juce::MemoryOutputStream& stream) const;
+    // reads the children of the current element of 'reader', big data might be stored in 'sidecar'.
+    // returns false on parse errors or missing/corrupt sidecar data, whatever could be read is kept
+    bool fillFromXmlReader(CarlaXmlReader& reader, const CarlaStateSidecarReader* const sidecar = nullptr);
+
+    // writes the state as XML, big data goes into 'sidecar' if not null
+    void dumpToStream(juce::OutputStream& stream, CarlaStateSidecarWriter* const sidecar = nullptr) const;
 
     CARLA_DECLARE_NON_COPY_STRUCT(CarlaStateSave)
 };
@@ -121,6 +131,92 @@ juce::String xmlSafeString(const juce::String& string, const bool toXml)
         return newString.replace("&lt;","<").replace("&gt;",">").replace("&apos;","'").replace("&quot;","\"").replace("&amp;","&");
 }
 
+// -----------------------------------------------------------------------
+// Binary sidecar for projects, stored next to them as '<project>.<id>.data'.
+// Plugin chunks and big custom data values go there raw (zlib compressed if it makes them smaller),
+// the XML only keeps their offsets. The file is memory mapped when loading.
+//
+// Every save writes a new sidecar with a new id, the XML keeps its name and id (<DataFile>).
+// The old one is only removed once the new XML is in place, so a failed save never leaves
+// a project pointing to data it does not match.
+//
+// Layout, all values in little endian:
+//  file header: "CarlaDat", uint32 version, uint32 reserved, 32 characters id
+//  per blob:    uint32 flags, uint32 reserved, uint64 raw size, uint64 stored size, uint64 raw data hash,
+//               stored data padded to 8 bytes
+
+class CarlaStateSidecarWriter
+{
+public:
+    // data smaller than 'minSize' bytes should be kept in the XML
+    CarlaStateSidecarWriter(const juce::File& projectFile, const uint minSize);
+    ~CarlaStateSidecarWriter();
+
+    uint getMinSize() const noexcept;
+
+    // id of this save, to be stored in the XML
+    const juce::String& getId() const noexcept;
+
+    // final file, to be referenced by the XML
+    const juce::File& getFile() const noexcept;
+
+    // true if nothing was stored, no file is needed then
+    bool isEmpty() const noexcept;
+
+    // store data, returns its offset or 0 on failure
+    uint64_t write(const void* const data, const std::size_t size);
+
+    // write the final file, must be called before the XML is put in place
+    bool finish();
+
+    // remove the final file, if the XML could not be put in place after finish()
+    void discard();
+
+private:
+    const juce::String fId;
+    const juce::File fFile;
+    const uint fMinSize;
+    juce::ScopedPointer<juce::TemporaryFile> fTempFile;
+    juce::ScopedPointer<juce::FileOutputStream> fStream;
+    bool fFailed;
+
+    bool open();
+
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaStateSidecarWriter)
+};
+
+class CarlaStateSidecarReader
+{
+public:
+    // invalid unless 'file' is a sidecar written with 'id'
+    CarlaStateSidecarReader(const juce::File& file, const juce::String& id);
+
+    bool isValid() const noexcept;
+
+    // size of the data stored at 'offset', 0 if invalid
+    std::size_t getSize(const uint64_t offset) const noexcept;
+
+    // read the data stored at 'offset' into 'buffer', which must have getSize(offset) bytes.
+    // fails if the data does not match its hash
+    bool read(const uint64_t offset, void* const buffer) const;
+
+private:
+    juce::ScopedPointer<juce::MemoryMappedFile> fFile;
+
+    const uint8_t* getBlob(const uint64_t offset) const noexcept;
+
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaStateSidecarReader)
+};
+
+static inline
+juce::File getStateSidecarFile(const juce::File& projectFile, const juce::String& id)
+{
+    return projectFile.getSiblingFile(projectFile.getFileName() + "." + id + ".data");
+}
+
+// remove sidecars of previous saves of 'projectFile', except 'keep'
+void removeOldStateSidecarFiles(const juce::File& projectFile, const juce::File& keep);
+
 // -----------------------------------------------------------------------
 
 CARLA_BACKEND_END_NAMESPACE
@@ -0,0 +1,611 @@
+/*
+ * Carla XML utils
+ * Copyright (C) 2015 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#ifndef CARLA_XML_UTILS_HPP_INCLUDED
+#define CARLA_XML_UTILS_HPP_INCLUDED
+
+#include "CarlaUtils.hpp"
+
+#include <algorithm>
+#include <string>
+
+// -----------------------------------------------------------------------
+// Helpers
+
+namespace CarlaXmlHelpers {
+
+static inline
+bool isSpace(const char c) noexcept
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline
+bool isNameEnd(const char c) noexcept
+{
+    return isSpace(c) || c == '>' || c == '/';
+}
+
+static inline
+char toLower(const char c) noexcept
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+static inline
+void appendUtf8(std::string& out, const uint32_t c)
+{
+    if (c < 0x80)
+    {
+        out += static_cast<char>(c);
+    }
+    else if (c < 0x800)
+    {
+        out += static_cast<char>(0xc0 | (c >> 6));
+        out += static_cast<char>(0x80 | (c & 0x3f));
+    }
+    else if (c < 0x10000)
+    {
+        out += static_cast<char>(0xe0 | (c >> 12));
+        out += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (c & 0x3f));
+    }
+    else if (c < 0x110000)
+    {
+        out += static_cast<char>(0xf0 | (c >> 18));
+        out += static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (c & 0x3f));
+    }
+}
+
+// decodes the entity at 'text' (starting with '&') into 'out', returns its length or 0 if unknown
+static inline
+std::size_t appendEntity(std::string& out, const char* const text, const std::size_t length)
+{
+    const char* const semicolon((const char*)std::memchr(text, ';', std::min<std::size_t>(length, 12)));
+
+    if (semicolon == nullptr)
+        return 0;
+
+    const std::size_t size(static_cast<std::size_t>(semicolon - text) + 1);
+
+    if (text[1] == '#')
+    {
+        const bool hex(text[2] == 'x' || text[2] == 'X');
+        uint32_t c = 0;
+
+        for (const char* s = text + (hex ? 3 : 2); s != semicolon; ++s)
+        {
+            /**/ if (*s >= '0' && *s <= '9')
+                c = c * (hex ? 16 : 10) + static_cast<uint32_t>(*s - '0');
+            else if (hex && toLower(*s) >= 'a' && toLower(*s) <= 'f')
+                c = c * 16 + static_cast<uint32_t>(toLower(*s) - 'a' + 10);
+            else
+                return 0;
+        }
+
+        appendUtf8(out, c);
+        return size;
+    }
+
+    /**/ if (size == 4 && std::strncmp(text, "&lt;",   4) == 0) out += '<';
+    else if (size == 4 && std::strncmp(text, "&gt;",   4) == 0) out += '>';
+    else if (size == 5 && std::strncmp(text, "&amp;",  5) == 0) out += '&';
+    else if (size == 6 && std::strncmp(text, "&apos;", 6) == 0) out += '\'';
+    else if (size == 6 && std::strncmp(text, "&quot;", 6) == 0) out += '"';
+    else return 0;
+
+    return size;
+}
+
+} // namespace CarlaXmlHelpers
+
+// -----------------------------------------------------------------------
+
+/*
+ * Write @a text into @a stream with XML special characters escaped, in a single pass.
+ * @a stream needs a write(const void*, std::size_t) method, such as juce::OutputStream.
+ */
+template<class Stream>
+static inline
+void carla_xmlWriteEscaped(Stream& stream, const char* const text)
+{
+    if (text == nullptr)
+        return;
+
+    const char* run(text);
+
+    for (const char* s = text; *s != '\0'; ++s)
+    {
+        const char* entity;
+
+        switch (*s)
+        {
+        case '&':  entity = "&amp;";  break;
+        case '<':  entity = "&lt;";   break;
+        case '>':  entity = "&gt;";   break;
+        case '\'': entity = "&apos;"; break;
+        case '"':  entity = "&quot;"; break;
+        default: continue;
+        }
+
+        if (s != run)
+            stream.write(run, static_cast<std::size_t>(s - run));
+
+        stream.write(entity, std::strlen(entity));
+        run = s + 1;
+    }
+
+    if (*run != '\0')
+        stream.write(run, std::strlen(run));
+}
+
+/*
+ * Write a whole element with text content, like "<indent><tag>value</tag>\n", with @a value escaped.
+ */
+template<class Stream>
+static inline
+void carla_xmlWriteTag(Stream& stream, const char* const indent, const char* const tag, const char* const value)
+{
+    stream.write(indent, std::strlen(indent));
+    stream.write("<", 1);
+    stream.write(tag, std::strlen(tag));
+    stream.write(">", 1);
+    carla_xmlWriteEscaped(stream, value);
+    stream.write("</", 2);
+    stream.write(tag, std::strlen(tag));
+    stream.write(">\n", 2);
+}
+
+/*
+ * Append @a length characters of XML text into @a out, with entities decoded in a single pass.
+ * Unknown entities are kept as-is.
+ */
+static inline
+void carla_xmlAppendUnescaped(std::string& out, const char* const text, const std::size_t length)
+{
+    const char* s(text);
+    const char* const end(text + length);
+
+    for (; s != end;)
+    {
+        const char* const amp((const char*)std::memchr(s, '&', static_cast<std::size_t>(end - s)));
+
+        if (amp == nullptr)
+        {
+            out.append(s, static_cast<std::size_t>(end - s));
+            break;
+        }
+
+        out.append(s, static_cast<std::size_t>(amp - s));
+
+        const std::size_t entitySize(CarlaXmlHelpers::appendEntity(out, amp, static_cast<std::size_t>(end - amp)));
+
+        if (entitySize == 0)
+        {
+            out += '&';
+            s = amp + 1;
+        }
+        else
+        {
+            s = amp + entitySize;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+// Streaming XML reader, no document tree is ever built.
+//
+// Works on a complete document in memory (usually a memory mapped file), and moves forward through its elements.
+// Only what Carla files need is supported: elements, text, CDATA, comments and processing instructions.
+// Attributes and DTDs are skipped.
+//
+// nextChild() goes to the next child element of the current one, which then becomes current.
+// Once it returns false the current element has ended and its parent is current again.
+// A child element must be fully read before moving to the next one, with readText(), skipElement() or more nextChild() calls.
+
+class CarlaXmlReader
+{
+public:
+    CarlaXmlReader(const char* const data, const std::size_t size) noexcept
+        : fData(data),
+          fEnd(data + size),
+          fPos(data),
+          fName(),
+          fDepth(0),
+          fEmpty(false),
+          fError(false) {}
+
+    /*
+     * Move to the next child element of the current one.
+     * Call this once to get the document root.
+     * Returns false when the current element ends, at the end of the document or on error.
+     */
+    bool nextChild()
+    {
+        if (fError)
+            return false;
+
+        if (fEmpty)
+        {
+            fEmpty = false;
+            --fDepth;
+            return false;
+        }
+
+        for (;;)
+        {
+            if (! skipTo('<'))
+            {
+                // only the prolog and trailing spaces can be outside elements
+                if (fDepth != 0)
+                    fError = true;
+                return false;
+            }
+
+            if (skipMarkup())
+                continue;
+            if (fError)
+                return false;
+
+            if (fPos[1] == '/')
+            {
+                if (fDepth == 0 || ! skipPast('>'))
+                {
+                    fError = true;
+                    return false;
+                }
+
+                --fDepth;
+                return false;
+            }
+
+            return readStartTag();
+        }
+    }
+
+    /*
+     * Read all text of the current element with entities decoded and surrounding spaces removed.
+     * Text of nested elements is included. The current element ends, its parent becomes current.
+     */
+    bool readText(std::string& out)
+    {
+        out.clear();
+        return readContent(&out);
+    }
+
+    /*
+     * Get the text of the current element without copying it, only if it is plain text without entities or markup.
+     * Returns false and reads nothing otherwise, readText() can be used then.
+     */
+    bool readRawText(const char*& text, std::size_t& size)
+    {
+        if (fError)
+            return false;
+
+        if (fEmpty)
+        {
+            fEmpty = false;
+            --fDepth;
+            text = fPos;
+            size = 0;
+            return true;
+        }
+
+        const char* const lt((const char*)std::memchr(fPos, '<', static_cast<std::size_t>(fEnd - fPos)));
+
+        if (lt == nullptr || lt+1 == fEnd || lt[1] != '/')
+            return false;
+        if (std::memchr(fPos, '&', static_cast<std::size_t>(lt - fPos)) != nullptr)
+            return false;
+
+        text = fPos;
+        size = static_cast<std::size_t>(lt - fPos);
+
+        fPos = lt;
+
+        if (! skipPast('>'))
+        {
+            fError = true;
+            return false;
+        }
+
+        --fDepth;
+        return true;
+    }
+
+    /*
+     * Skip the rest of the current element, its parent becomes current.
+     */
+    bool skipElement()
+    {
+        return readContent(nullptr);
+    }
+
+    /*
+     * Name of the current element.
+     */
+    const char* getName() const noexcept
+    {
+        return fName.c_str();
+    }
+
+    /*
+     * Compare the name of the current element, ignoring case.
+     */
+    bool isName(const char* const name) const noexcept
+    {
+        const char* s(fName.c_str());
+
+        for (const char* n = name; *n != '\0'; ++n, ++s)
+        {
+            if (CarlaXmlHelpers::toLower(*s) != CarlaXmlHelpers::toLower(*n))
+                return false;
+        }
+
+        return *s == '\0';
+    }
+
+    bool hasError() const noexcept
+    {
+        return fError;
+    }
+
+    /*
+     * Current line, for error messages.
+     */
+    uint getLine() const noexcept
+    {
+        uint line = 1;
+
+        for (const char* s = fData; s != fPos; ++s)
+        {
+            if (*s == '\n')
+                ++line;
+        }
+
+        return line;
+    }
+
+private:
+    const char* const fData;
+    const char* const fEnd;
+    const char* fPos;
+
+    std::string fName;
+    uint fDepth;
+    bool fEmpty; // current element is '<name/>'
+    bool fError;
+
+    bool skipTo(const char c) noexcept
+    {
+        const char* const found((const char*)std::memchr(fPos, c, static_cast<std::size_t>(fEnd - fPos)));
+
+        if (found == nullptr)
+        {
+            fPos = fEnd;
+            return false;
+        }
+
+        fPos = found;
+        return true;
+    }
+
+    bool skipPast(const char c) noexcept
+    {
+        if (! skipTo(c))
+            return false;
+
+        ++fPos;
+        return true;
+    }
+
+    bool skipPastString(const char* const str, const std::size_t length) noexcept
+    {
+        for (; skipTo(str[0]);)
+        {
+            if (static_cast<std::size_t>(fEnd - fPos) < length)
+                break;
+
+            if (std::strncmp(fPos, str, length) == 0)
+            {
+                fPos += length;
+                return true;
+            }
+
+            ++fPos;
+        }
+
+        fError = true;
+        return false;
+    }
+
+    bool startsWith(const char* const str, const std::size_t length) const noexcept
+    {
+        return static_cast<std::size_t>(fEnd - fPos) >= length && std::strncmp(fPos, str, length) == 0;
+    }
+
+    // skips comments, processing instructions and DTDs at '<', returns false if something else
+    bool skipMarkup() noexcept
+    {
+        if (fPos+1 == fEnd)
+        {
+            fError = true;
+            return false;
+        }
+
+        if (startsWith("<!--", 4))
+            return skipPastString("-->", 3);
+        if (startsWith("<?", 2))
+            return skipPastString("?>", 2);
+
+        if (fPos[1] == '!' && ! startsWith("<![CDATA[", 9))
+        {
+            // DTD, might have an internal subset
+            for (int depth = 0; ++fPos != fEnd;)
+            {
+                /**/ if (*fPos == '[')
+                    ++depth;
+                else if (*fPos == ']')
+                    --depth;
+                else if (*fPos == '>' && depth <= 0)
+                {
+                    ++fPos;
+                    return true;
+                }
+            }
+
+            fError = true;
+            return false;
+        }
+
+        return false;
+    }
+
+    bool readStartTag()
+    {
+        const char* const nameStart(++fPos);
+
+        for (; fPos != fEnd && ! CarlaXmlHelpers::isNameEnd(*fPos); ++fPos) {}
+
+        if (fPos == fEnd || fPos == nameStart)
+        {
+            fError = true;
+            return false;
+        }
+
+        fName.assign(nameStart, static_cast<std::size_t>(fPos - nameStart));
+
+        // skip attributes, '>' might appear in quoted values
+        for (char quote = '\0'; fPos != fEnd; ++fPos)
+        {
+            if (quote != '\0')
+            {
+                if (*fPos == quote)
+                    quote = '\0';
+            }
+            else if (*fPos == '"' || *fPos == '\'')
+            {
+                quote = *fPos;
+            }
+            else if (*fPos == '>')
+            {
+                fEmpty = (fPos[-1] == '/');
+                ++fPos;
+                ++fDepth;
+                return true;
+            }
+        }
+
+        fError = true;
+        return false;
+    }
+
+    // reads or skips everything until the end of the current element
+    bool readContent(std::string* const out)
+    {
+        if (fError)
+            return false;
+
+        if (fEmpty)
+        {
+            fEmpty = false;
+            --fDepth;
+            return true;
+        }
+
+        for (uint depth = 0;;)
+        {
+            const char* const textStart(fPos);
+
+            if (! skipTo('<'))
+            {
+                fError = true;
+                return false;
+            }
+
+            if (out != nullptr && fPos != textStart)
+                carla_xmlAppendUnescaped(*out, textStart, static_cast<std::size_t>(fPos - textStart));
+
+            if (startsWith("<![CDATA[", 9))
+            {
+                const char* const cdataStart(fPos + 9);
+
+                if (! skipPastString("]]>", 3))
+                    return false;
+
+                if (out != nullptr)
+                    out->append(cdataStart, static_cast<std::size_t>(fPos - 3 - cdataStart));
+                continue;
+            }
+
+            if (skipMarkup())
+                continue;
+            if (fError)
+                return false;
+
+            if (fPos[1] == '/')
+            {
+                if (! skipPast('>'))
+                {
+                    fError = true;
+                    return false;
+                }
+
+                if (depth-- == 0)
+                    break;
+                continue;
+            }
+
+            // nested element
+            for (; fPos != fEnd && *fPos != '>'; ++fPos) {}
+
+            if (fPos == fEnd)
+            {
+                fError = true;
+                return false;
+            }
+
+            if (fPos[-1] != '/')
+                ++depth;
+
+            ++fPos;
+        }
+
+        --fDepth;
+
+        if (out != nullptr)
+        {
+            std::size_t start = 0, end = out->size();
+
+            for (; start < end && CarlaXmlHelpers::isSpace((*out)[start]); ++start) {}
+            for (; end > start && CarlaXmlHelpers::isSpace((*out)[end-1]); --end) {}
+
+            if (start != 0 || end != out->size())
+                *out = out->substr(start, end - start);
+        }
+
+        return true;
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaXmlReader)
+};
+
+// -----------------------------------------------------------------------
+
+#endif // CARLA_XML_UTILS_HPP_INCLUDED
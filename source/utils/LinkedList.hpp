@@ -168,7 +168,7 @@ public:
     class AutoItenerator {
     public:
         AutoItenerator(const ListHead* entry, bool* usingItenerator) noexcept
-            : fEntry(entry),
+            : fEntry(const_cast<ListHead*>(entry)),
               fEntry2(entry != nullptr ? entry->next : nullptr),
               fUsingItenerator(usingItenerator)
         {
@@ -0,0 +1,437 @@
+/*
+ * Carla process-wide LV2 URID map
+ * Copyright (C) 2015 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#ifndef LV2_URID_MAP_HPP_INCLUDED
+#define LV2_URID_MAP_HPP_INCLUDED
+
+#include "CarlaMutex.hpp"
+
+#include "lv2/atom.h"
+#include "lv2/urid.h"
+
+#include <cstring>
+#include <vector>
+
+// -----------------------------------------------------------------------
+// Interned URI <-> URID table, shared by all plugin instances.
+//
+// Lookups of already mapped URIs are lock-free, they probe an open-addressing hash table whose
+// slots are only ever filled, never changed or removed.
+// New URIs are added under a lock, when the table gets too full a bigger copy is published and
+// the old one is kept alive until destruction so that concurrent readers stay valid.
+// Unmapping is a direct index into chunked string storage, chunks never move once allocated.
+// URID 0 is reserved, the first URIDs are the seed given to the constructor in order.
+
+class Lv2UridMap
+{
+public:
+    static const uint32_t kChunkSize  = 1024;
+    static const uint32_t kMaxChunks  = 256;
+    static const uint32_t kMaxCount   = kChunkSize * kMaxChunks;
+    static const uint32_t kMinSlots   = 256;
+
+    // seed[0] is ignored, it corresponds to the reserved null URID
+    Lv2UridMap(const char* const* const seed, const uint32_t seedCount)
+        : fMutex(),
+          fTable(nullptr),
+          fCount(1)
+    {
+        carla_zeroPointers(fChunks, kMaxChunks);
+
+        fChunks[0] = new const char*[kChunkSize];
+        fChunks[0][0] = nullptr;
+
+        fTable = new Table(kMinSlots, nullptr);
+
+        for (uint32_t i=1; i < seedCount; ++i)
+        {
+            CARLA_SAFE_ASSERT_CONTINUE(seed[i] != nullptr && seed[i][0] != '\0');
+
+            const LV2_URID urid(map(seed[i]));
+            CARLA_SAFE_ASSERT(urid == i);
+        }
+    }
+
+    ~Lv2UridMap()
+    {
+        for (uint32_t i=1; i < fCount; ++i)
+            delete[] _getString(i);
+
+        for (uint32_t i=0; i < kMaxChunks && fChunks[i] != nullptr; ++i)
+            delete[] fChunks[i];
+
+        for (Table* table = fTable; table != nullptr;)
+        {
+            Table* const prev(table->prev);
+            delete table;
+            table = prev;
+        }
+    }
+
+    // number of URIDs in use, including the reserved null one
+    uint32_t getCount() const noexcept
+    {
+        return __atomic_load_n(&fCount, __ATOMIC_ACQUIRE);
+    }
+
+    LV2_URID map(const char* const uri)
+    {
+        CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', 0);
+
+        const uint32_t hash(_hash(uri));
+
+        // lock-free fast path
+        if (const LV2_URID urid = _find(__atomic_load_n(&fTable, __ATOMIC_ACQUIRE), uri, hash))
+            return urid;
+
+        const CarlaMutexLocker cml(fMutex);
+
+        // someone else might have added it meanwhile
+        if (const LV2_URID urid = _find(fTable, uri, hash))
+            return urid;
+
+        const LV2_URID urid(fCount);
+        CARLA_SAFE_ASSERT_RETURN(urid < kMaxCount, 0);
+
+        const uint32_t chunk(urid / kChunkSize);
+
+        if (fChunks[chunk] == nullptr)
+            fChunks[chunk] = new const char*[kChunkSize];
+
+        const char* const uriCopy(carla_strdup(uri));
+        fChunks[chunk][urid % kChunkSize] = uriCopy;
+
+        // keep the load factor below 1/2
+        if ((urid + 1) * 2 > fTable->mask + 1)
+        {
+            Table* const newTable(new Table((fTable->mask + 1) * 2, fTable));
+
+            for (uint32_t i=1; i < urid; ++i)
+            {
+                const char* const oldUri(_getString(i));
+                newTable->insert(oldUri, _hash(oldUri), i);
+            }
+
+            newTable->insert(uriCopy, hash, urid);
+            __atomic_store_n(&fTable, newTable, __ATOMIC_RELEASE);
+        }
+        else
+        {
+            fTable->insert(uriCopy, hash, urid);
+        }
+
+        __atomic_store_n(&fCount, urid + 1, __ATOMIC_RELEASE);
+        return urid;
+    }
+
+    // returns null for unknown URIDs
+    const char* unmap(const LV2_URID urid) const noexcept
+    {
+        if (urid == 0 || urid >= __atomic_load_n(&fCount, __ATOMIC_ACQUIRE))
+            return nullptr;
+
+        return _getString(urid);
+    }
+
+private:
+    struct Slot {
+        const char* uri; // set last, null means empty
+        uint32_t hash;
+        LV2_URID urid;
+    };
+
+    struct Table {
+        const uint32_t mask;
+        Slot* const slots;
+        Table* const prev;
+
+        Table(const uint32_t size, Table* const p)
+            : mask(size - 1),
+              slots(new Slot[size]),
+              prev(p)
+        {
+            carla_zeroStructs(slots, size);
+        }
+
+        ~Table()
+        {
+            delete[] slots;
+        }
+
+        void insert(const char* const uri, const uint32_t hash, const LV2_URID urid) noexcept
+        {
+            for (uint32_t i = hash & mask;; i = (i + 1) & mask)
+            {
+                Slot& slot(slots[i]);
+
+                if (slot.uri != nullptr)
+                    continue;
+
+                slot.hash = hash;
+                slot.urid = urid;
+                __atomic_store_n(&slot.uri, uri, __ATOMIC_RELEASE);
+                return;
+            }
+        }
+
+        CARLA_DECLARE_NON_COPY_STRUCT(Table)
+    };
+
+    CarlaMutex fMutex;
+    Table* fTable;
+    const char** fChunks[kMaxChunks];
+    uint32_t fCount;
+
+    const char* _getString(const LV2_URID urid) const noexcept
+    {
+        return fChunks[urid / kChunkSize][urid % kChunkSize];
+    }
+
+    static LV2_URID _find(const Table* const table, const char* const uri, const uint32_t hash) noexcept
+    {
+        for (uint32_t i = hash & table->mask;; i = (i + 1) & table->mask)
+        {
+            const Slot& slot(table->slots[i]);
+            const char* const slotUri(__atomic_load_n(&slot.uri, __ATOMIC_ACQUIRE));
+
+            if (slotUri == nullptr)
+                return 0;
+
+            if (slot.hash == hash && std::strcmp(slotUri, uri) == 0)
+                return slot.urid;
+        }
+    }
+
+    // FNV-1a
+    static uint32_t _hash(const char* uri) noexcept
+    {
+        uint32_t hash = 2166136261U;
+
+        for (; *uri != '\0'; ++uri)
+        {
+            hash ^= static_cast<uint8_t>(*uri);
+            hash *= 16777619U;
+        }
+
+        return hash;
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(Lv2UridMap)
+};
+
+// -----------------------------------------------------------------------
+// URIDs received from another process (like a bridged UI) into ours.
+//
+// Both sides start from the same seed but map new URIs on their own, so the same URI can get
+// different URIDs on each side. Every "urid" message received is added here, and the atoms
+// received afterwards are rewritten in place before use.
+// URIDs never told about are assumed to be the same on both sides.
+// Not thread-safe, meant to be used from the thread reading the messages.
+
+class Lv2UridTranslation
+{
+public:
+    Lv2UridTranslation(Lv2UridMap& map)
+        : fTable(),
+          fAtomObject(map.map(LV2_ATOM__Object)),
+          fAtomBlank(map.map(LV2_ATOM__Blank)),
+          fAtomResource(map.map(LV2_ATOM__Resource)),
+          fAtomProperty(map.map(LV2_ATOM__Property)),
+          fAtomSequence(map.map(LV2_ATOM__Sequence)),
+          fAtomTuple(map.map(LV2_ATOM__Tuple)),
+          fAtomURID(map.map(LV2_ATOM__URID)),
+          fAtomVector(map.map(LV2_ATOM__Vector)) {}
+
+    bool isEmpty() const noexcept
+    {
+        return fTable.empty();
+    }
+
+    void clear() noexcept
+    {
+        fTable.clear();
+    }
+
+    // 'theirs' is the URID used by the other side for a URI that is 'ours' here
+    void add(const LV2_URID theirs, const LV2_URID ours)
+    {
+        CARLA_SAFE_ASSERT_RETURN(theirs != 0 && theirs < Lv2UridMap::kMaxCount,);
+
+        if (theirs == ours && theirs >= fTable.size())
+            return;
+
+        if (theirs >= fTable.size())
+            fTable.resize(theirs + 1, 0);
+
+        fTable[theirs] = ours;
+    }
+
+    LV2_URID translate(const LV2_URID urid) const noexcept
+    {
+        if (urid < fTable.size() && fTable[urid] != 0)
+            return fTable[urid];
+
+        return urid;
+    }
+
+    // rewrites all URIDs of an atom, including types, keys and values of containers.
+    // returns false if the atom is malformed, it might be partially translated then
+    bool translateAtom(LV2_Atom* const atom, const uint32_t maxSize) const noexcept
+    {
+        if (maxSize < sizeof(LV2_Atom) || atom->size > maxSize - sizeof(LV2_Atom))
+            return false;
+
+        atom->type = translate(atom->type);
+
+        uint8_t* const body((uint8_t*)(atom + 1));
+        const uint32_t size(atom->size);
+
+        if (atom->type == fAtomURID)
+        {
+            if (size < sizeof(LV2_URID))
+                return false;
+
+            ((LV2_Atom_URID*)atom)->body = translate(((LV2_Atom_URID*)atom)->body);
+            return true;
+        }
+
+        if (atom->type == fAtomObject || atom->type == fAtomBlank || atom->type == fAtomResource)
+        {
+            if (size < sizeof(LV2_Atom_Object_Body))
+                return false;
+
+            LV2_Atom_Object_Body* const obody((LV2_Atom_Object_Body*)body);
+
+            if (obody->id != 0 && atom->type != fAtomBlank)
+                obody->id = translate(obody->id);
+
+            obody->otype = translate(obody->otype);
+
+            for (uint32_t offset = sizeof(LV2_Atom_Object_Body); offset < size;)
+            {
+                if (size - offset < sizeof(LV2_Atom_Property_Body))
+                    return false;
+
+                LV2_Atom_Property_Body* const prop((LV2_Atom_Property_Body*)(body + offset));
+
+                if (! _translatePropertyBody(prop, size - offset))
+                    return false;
+
+                offset += _padSize(static_cast<uint32_t>(sizeof(LV2_Atom_Property_Body)) + prop->value.size);
+            }
+
+            return true;
+        }
+
+        if (atom->type == fAtomProperty)
+            return _translatePropertyBody((LV2_Atom_Property_Body*)body, size);
+
+        if (atom->type == fAtomSequence)
+        {
+            if (size < sizeof(LV2_Atom_Sequence_Body))
+                return false;
+
+            LV2_Atom_Sequence_Body* const sbody((LV2_Atom_Sequence_Body*)body);
+
+            if (sbody->unit != 0)
+                sbody->unit = translate(sbody->unit);
+
+            for (uint32_t offset = sizeof(LV2_Atom_Sequence_Body); offset < size;)
+            {
+                if (size - offset < sizeof(LV2_Atom_Event))
+                    return false;
+
+                LV2_Atom_Event* const event((LV2_Atom_Event*)(body + offset));
+
+                if (! translateAtom(&event->body, size - offset - static_cast<uint32_t>(sizeof(event->time))))
+                    return false;
+
+                offset += _padSize(static_cast<uint32_t>(sizeof(LV2_Atom_Event)) + event->body.size);
+            }
+
+            return true;
+        }
+
+        if (atom->type == fAtomTuple)
+        {
+            for (uint32_t offset = 0; offset < size;)
+            {
+                LV2_Atom* const child((LV2_Atom*)(body + offset));
+
+                if (! translateAtom(child, size - offset))
+                    return false;
+
+                offset += _padSize(static_cast<uint32_t>(sizeof(LV2_Atom)) + child->size);
+            }
+
+            return true;
+        }
+
+        if (atom->type == fAtomVector)
+        {
+            if (size < sizeof(LV2_Atom_Vector_Body))
+                return false;
+
+            LV2_Atom_Vector_Body* const vbody((LV2_Atom_Vector_Body*)body);
+
+            vbody->child_type = translate(vbody->child_type);
+
+            if (vbody->child_type == fAtomURID && vbody->child_size == sizeof(LV2_URID))
+            {
+                LV2_URID* const urids((LV2_URID*)(vbody + 1));
+
+                for (uint32_t i=0, count=(size - sizeof(LV2_Atom_Vector_Body)) / sizeof(LV2_URID); i < count; ++i)
+                    urids[i] = translate(urids[i]);
+            }
+
+            return true;
+        }
+
+        return true;
+    }
+
+private:
+    std::vector<LV2_URID> fTable;
+
+    const LV2_URID fAtomObject, fAtomBlank, fAtomResource, fAtomProperty;
+    const LV2_URID fAtomSequence, fAtomTuple, fAtomURID, fAtomVector;
+
+    bool _translatePropertyBody(LV2_Atom_Property_Body* const prop, const uint32_t maxSize) const noexcept
+    {
+        if (maxSize < sizeof(LV2_Atom_Property_Body))
+            return false;
+
+        prop->key = translate(prop->key);
+
+        if (prop->context != 0)
+            prop->context = translate(prop->context);
+
+        return translateAtom(&prop->value, maxSize - static_cast<uint32_t>(sizeof(LV2_Atom_Property_Body) - sizeof(LV2_Atom)));
+    }
+
+    // atoms in containers are 64-bit aligned
+    static uint32_t _padSize(const uint32_t size) noexcept
+    {
+        return (size + 7U) & ~7U;
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(Lv2UridTranslation)
+};
+
+// -----------------------------------------------------------------------
+
+#endif // LV2_URID_MAP_HPP_INCLUDED
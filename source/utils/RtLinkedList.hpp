@@ -18,11 +18,7 @@
 #ifndef RT_LINKED_LIST_HPP_INCLUDED
 #define RT_LINKED_LIST_HPP_INCLUDED
 
-#include "LinkedList.hpp"
-
-extern "C" {
-#include "rtmempool/rtmempool.h"
-}
+#include "CarlaRtMemPool.hpp"
 
 // -----------------------------------------------------------------------
 // Realtime safe linkedlist
@@ -32,70 +28,53 @@ class RtLinkedList : public AbstractLinkedList<T>
 {
 public:
     // -------------------------------------------------------------------
-    // RtMemPool C++ class
+    // Memory pool for the list data, shared between lists that move data between each other
 
     class Pool
     {
     public:
         Pool(const std::size_t minPreallocated, const std::size_t maxPreallocated) noexcept
-            : kDataSize(sizeof(typename AbstractLinkedList<T>::Data)),
-              fHandle(nullptr)
-        {
-            resize(minPreallocated, maxPreallocated);
-        }
-
-        ~Pool() noexcept
-        {
-            if (fHandle != nullptr)
-            {
-                rtsafe_memory_pool_destroy(fHandle);
-                fHandle = nullptr;
-            }
-        }
+            : fMemPool(sizeof(typename AbstractLinkedList<T>::Data), minPreallocated, maxPreallocated) {}
 
         void* allocate_atomic() const noexcept
         {
-            return rtsafe_memory_pool_allocate_atomic(fHandle);
+            return fMemPool.allocate_atomic();
         }
 
         void* allocate_sleepy() const noexcept
         {
-            return rtsafe_memory_pool_allocate_sleepy(fHandle);
+            return fMemPool.allocate_sleepy();
         }
 
         void deallocate(void* const dataPtr) const noexcept
         {
             CARLA_SAFE_ASSERT_RETURN(dataPtr != nullptr,);
 
-            rtsafe_memory_pool_deallocate(fHandle, dataPtr);
+            fMemPool.deallocate(dataPtr);
         }
 
         void resize(const std::size_t minPreallocated, const std::size_t maxPreallocated) noexcept
         {
-            if (fHandle != nullptr)
-            {
-                rtsafe_memory_pool_destroy(fHandle);
-                fHandle = nullptr;
-            }
-
-            rtsafe_memory_pool_create(&fHandle, nullptr, kDataSize, minPreallocated, maxPreallocated);
-            CARLA_SAFE_ASSERT(fHandle != nullptr);
+            fMemPool.resize(minPreallocated, maxPreallocated);
+        }
+
+        const CarlaRtMemPool& getMemPool() const noexcept
+        {
+            return fMemPool;
         }
 
         bool operator==(const Pool& pool) const noexcept
         {
-            return (fHandle == pool.fHandle && kDataSize == pool.kDataSize);
+            return (this == &pool);
         }
 
         bool operator!=(const Pool& pool) const noexcept
         {
-            return (fHandle != pool.fHandle || kDataSize != pool.kDataSize);
+            return (this != &pool);
         }
 
     private:
-        const std::size_t kDataSize;
-
-        mutable RtMemPool_Handle fHandle;
+        mutable CarlaRtMemPool fMemPool;
 
         CARLA_PREVENT_HEAP_ALLOCATION
         CARLA_DECLARE_NON_COPY_CLASS(Pool)